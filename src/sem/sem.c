@@ -4,6 +4,11 @@
 #include "sircore_vm.h"
 #include "sem_hosted.h"
 #include "sir_jsonl.h"
+#include "sem_check.h"
+#include "sem_trace_bin.h"
+#ifdef SEM_HAVE_JIT
+#include "sem_jit.h"
+#endif
 #include "zi_tape.h"
 #include "zcl1.h"
 
@@ -38,7 +43,7 @@ typedef enum sem_list_format {
 } sem_list_format_t;
 
 static void sem_print_help(FILE* out) {
-  fprintf(out,
+  fputs(
           "sem — SIR emulator host frontend (MVP)\n"
           "\n"
           "Usage:\n"
@@ -51,13 +56,21 @@ static void sem_print_help(FILE* out) {
           "      [--fs-root PATH]\n"
           "      [--tape-out PATH] [--tape-in PATH] [--tape-lax]\n"
           "  sem --list <input.sir.jsonl|dir>... [--format text|json]\n"
-          "  sem --check <input.sir.jsonl|dir>... [--check-run] [--format text|json] [--diagnostics text|json] [--all]\n"
+          "  sem --check <input.sir.jsonl|dir>... [--check-run] [-j N] [--format text|json] [--diagnostics text|json] [--all]\n"
           "  sem --cat GUEST_PATH --fs-root PATH\n"
           "  sem --sir-hello\n"
           "  sem --sir-module-hello\n"
-          "  sem --run FILE.sir.jsonl [--trace-jsonl-out PATH] [--coverage-jsonl-out PATH] [--diagnostics text|json] [--fs-root PATH] [--cap ...]\n"
+          "  sem --run FILE.sir.jsonl [--trace-jsonl-out PATH] [--trace-bin-out PATH] [--coverage-jsonl-out PATH] [--diagnostics text|json] [--fs-root PATH] [--cap ...]\n"
+          "  sem --run FILE.sir.jsonl --profile-out PATH [--profile-funcs-out PATH] [--profile-period N]\n",
+        out);
+  fputs("  sem --run FILE.sir.jsonl --profile-blocks-out PATH\n", out);
+  fputs(
+          "  sem --trace-bin-to-jsonl TRACE.bin\n"
           "  sem --verify FILE.sir.jsonl [--diagnostics text|json]\n"
-          "\n"
+          "  sem --jit FILE.sir.jsonl [--diagnostics text|json] [--fs-root PATH] [--cap ...] [--tape-out PATH] [--tape-in PATH]\n"
+          "\n",
+        out);
+  fputs(
           "Options:\n"
           "  --help        Show this help message\n"
           "  --version     Show version information (from ./VERSION)\n"
@@ -66,20 +79,36 @@ static void sem_print_help(FILE* out) {
           "  --list        List `*.sir.jsonl` inputs without running\n"
           "  --check       Batch-verify one or more inputs (files or dirs)\n"
           "  --check-run   For --check, run cases (not just verify)\n"
+          "  -j, --jobs N  For --check, run N cases at a time (0 = one per CPU); results stay in input order\n"
           "  --format      For --check, emit results as: text (default) or json (JSON is written to stderr)\n"
           "  --cat PATH    Read PATH via file/aio and write to stdout\n"
           "  --sir-hello   Run a tiny built-in sircore VM smoke program\n"
           "  --sir-module-hello  Run a tiny built-in sircore module smoke program\n"
           "  --run FILE    Run a small supported SIR subset (MVP)\n"
           "  --verify FILE Validate + lower (no execution)\n"
+          "  --jit FILE    Compile FILE to native code in-process (LLVM ORC) and run it\n"
+          "                against the same hosted zABI runtime as --run\n"
           "  --trace-jsonl-out PATH  Write execution trace JSONL to PATH (for --run)\n"
+          "  --trace-bin-out PATH  Write a compact binary execution trace to PATH (for --run)\n"
+          "  --trace-bin-to-jsonl PATH  Convert a binary trace to trace JSONL on stdout\n"
           "  --coverage-jsonl-out PATH  Write execution coverage JSONL to PATH (for --run)\n"
-          "  --trace-func NAME  For --trace-jsonl-out, only emit events in function NAME\n"
-          "  --trace-op OP      For --trace-jsonl-out, only emit step events matching OP (e.g. i32.add, term.cbr)\n"
+          "  --profile-out PATH  Sample the guest call stack and write folded stacks (flamegraph input) to PATH (for --run)\n"
+          "  --profile-funcs-out PATH  Write per-function self/total instruction estimates as JSONL to PATH (for --run)\n"
+          "  --profile-period N  Instructions between samples (default 997)\n",
+        out);
+  fputs("  --profile-blocks-out PATH  Write CFG block, edge and branch counts as JSONL to PATH (for --run)\n", out);
+  fputs(
+          "  --trace-func NAME  For --trace-jsonl-out/--trace-bin-out, only emit events in functions matching NAME\n"
+          "                     (a comma list of globs, e.g. main,util_*; repeatable)\n"
+          "  --trace-op OP      For --trace-jsonl-out/--trace-bin-out, only emit step events matching OP\n"
+          "                     (a comma list of globs or classes, e.g. i32.add,term.*,@mem; repeatable)\n"
+          "                     Classes: @const @int @float @cmp @ptr @load @store @mem @vec @call @branch @term\n"
           "  --json        Emit --caps output as JSON (stdout)\n"
           "  --diagnostics Emit --run/--verify diagnostics as: text (default) or json\n"
           "  --all         For --run/--verify, try to emit multiple diagnostics (best-effort)\n"
-          "\n"
+          "\n",
+        out);
+  fputs(
           "  --cap KIND:NAME[:FLAGS]\n"
           "      Add a capability entry. FLAGS is a comma-list of:\n"
           "        open (ZI_CAP_CAN_OPEN), pure (ZI_CAP_PURE), block (ZI_CAP_MAY_BLOCK)\n"
@@ -95,13 +124,16 @@ static void sem_print_help(FILE* out) {
           "\n"
           "  --cap-sys-info      Sugar for --cap sys:info:pure\n"
           "  --fs-root PATH      Sandbox root for file/aio (sets ZI_FS_ROOT)\n"
-          "\n"
+          "\n",
+        out);
+  fputs(
           "  --tape-out PATH  Record all zi_ctl requests/responses to a tape file\n"
           "  --tape-in PATH   Replay zi_ctl from a tape file (no real host)\n"
           "  --tape-lax       Do not require request bytes to match tape (unsafe)\n"
           "\n"
           "License: GPLv3+\n"
-          "© 2026 Frogfish — Author: Alexander Croft\n");
+          "© 2026 Frogfish — Author: Alexander Croft\n",
+        out);
 }
 
 static void sem_print_version(FILE* out) {
@@ -185,7 +217,20 @@ static int sem_do_list_one(const char* path, sem_list_format_t fmt) {
   return 0;
 }
 
-static void sem_emit_check_case(sem_check_format_t fmt, const char* mode, const char* path, bool ok, int tool_rc, int prog_rc) {
+static void sem_json_write_path(FILE* out, const char* path) {
+  for (const char* p = path; p && *p; p++) {
+    const unsigned char ch = (unsigned char)*p;
+    if (ch == '\\' || ch == '"') {
+      fputc('\\', out);
+      fputc((int)ch, out);
+    } else if (ch >= 0x20) {
+      fputc((int)ch, out);
+    }
+  }
+}
+
+static void sem_emit_check_case(sem_check_format_t fmt, const char* mode, const char* path, bool ok, int tool_rc, int prog_rc,
+                                double ms) {
   FILE* out = (fmt == SEM_CHECK_JSON) ? stderr : stdout;
   if (fmt != SEM_CHECK_JSON) {
     if (mode && strcmp(mode, "run") == 0) {
@@ -199,76 +244,135 @@ static void sem_emit_check_case(sem_check_format_t fmt, const char* mode, const
       else
         fprintf(out, "FAIL %s\n", path);
     }
+    (void)fflush(out);
     return;
   }
 
   // JSONL; one record per case. Keep it small and stable for CI.
   fprintf(out, "{\"tool\":\"sem\",\"k\":\"check_case\",\"mode\":\"%s\",\"path\":\"", mode ? mode : "verify");
-  for (const char* p = path; p && *p; p++) {
-    const unsigned char ch = (unsigned char)*p;
-    if (ch == '\\' || ch == '"') {
-      fputc('\\', out);
-      fputc((int)ch, out);
-    } else if (ch >= 0x20) {
-      fputc((int)ch, out);
-    }
-  }
+  sem_json_write_path(out, path);
   fprintf(out, "\",\"ok\":%s", ok ? "true" : "false");
   if (!ok) fprintf(out, ",\"tool_rc\":%d", tool_rc);
   if (mode && strcmp(mode, "run") == 0) {
     if (ok) fprintf(out, ",\"rc\":%d", prog_rc);
   }
-  fprintf(out, "}\n");
+  fprintf(out, ",\"ms\":%.3f}\n", ms);
+  (void)fflush(out);
 }
 
-static int sem_do_check_one(const char* path, bool do_run, sem_run_host_cfg_t host_cfg, sem_check_format_t check_format,
-                            sem_diag_format_t diag_format, bool diag_all) {
-  if (do_run) {
-    int prog_rc = 0;
-    const int tool_rc = sem_run_sir_jsonl_capture_host_ex(path, host_cfg, diag_format, diag_all, &prog_rc);
-    sem_emit_check_case(check_format, "run", path, tool_rc == 0, tool_rc, prog_rc);
-    return tool_rc;
-  }
+// Cases collected from the --check paths; each path is owned by the list.
+typedef struct sem_check_list {
+  sem_check_case_t* cases;
+  uint32_t count;
+  uint32_t cap;
+} sem_check_list_t;
+
+static bool sem_check_list_add(sem_check_list_t* l, const char* path) {
+  if (l->count == l->cap) {
+    const uint32_t cap = l->cap ? l->cap * 2u : 64u;
+    sem_check_case_t* v = (sem_check_case_t*)realloc(l->cases, (size_t)cap * sizeof(*v));
+    if (!v) return false;
+    l->cases = v;
+    l->cap = cap;
+  }
+  const size_t n = strlen(path);
+  char* dup = (char*)malloc(n + 1u);
+  if (!dup) return false;
+  memcpy(dup, path, n + 1u);
+  memset(&l->cases[l->count], 0, sizeof(l->cases[l->count]));
+  l->cases[l->count++].path = dup;
+  return true;
+}
 
-  const int rc = sem_verify_sir_jsonl_ex(path, diag_format, diag_all);
-  sem_emit_check_case(check_format, "verify", path, rc == 0, rc, 0);
-  return rc;
+static void sem_check_list_free(sem_check_list_t* l) {
+  for (uint32_t i = 0; i < l->count; i++) free((char*)l->cases[i].path);
+  free(l->cases);
+  memset(l, 0, sizeof(*l));
 }
 
-static int sem_do_check_dir(const char* dir, bool do_run, sem_run_host_cfg_t host_cfg, sem_check_format_t check_format,
-                            sem_diag_format_t diag_format, bool diag_all, uint32_t* inout_ok, uint32_t* inout_fail) {
-  if (!dir || !inout_ok || !inout_fail) return 2;
+static int sem_cmp_names(const void* a, const void* b) {
+  return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+// Adds the `*.sir.jsonl` files of dir in name order, so reports do not
+// depend on readdir order.
+static int sem_collect_check_dir(const char* dir, sem_check_list_t* l) {
+  if (!dir || !l) return 2;
   DIR* d = opendir(dir);
   if (!d) {
     fprintf(stderr, "sem: --check: failed to open dir: %s\n", dir);
     return 2;
   }
 
+  char** names = NULL;
+  uint32_t name_count = 0, name_cap = 0;
+  int rc = 0;
   struct dirent* ent = NULL;
   while ((ent = readdir(d)) != NULL) {
     const char* nm = ent->d_name;
     if (!nm || nm[0] == '\0') continue;
     if (strcmp(nm, ".") == 0 || strcmp(nm, "..") == 0) continue;
     if (!sem_is_sir_jsonl_path(nm)) continue;
+    if (name_count == name_cap) {
+      const uint32_t cap = name_cap ? name_cap * 2u : 64u;
+      char** v = (char**)realloc(names, (size_t)cap * sizeof(*v));
+      if (!v) {
+        rc = 2;
+        break;
+      }
+      names = v;
+      name_cap = cap;
+    }
+    const size_t n = strlen(nm);
+    names[name_count] = (char*)malloc(n + 1u);
+    if (!names[name_count]) {
+      rc = 2;
+      break;
+    }
+    memcpy(names[name_count++], nm, n + 1u);
+  }
+  closedir(d);
+  if (rc != 0) fprintf(stderr, "sem: --check: out of memory\n");
+  if (name_count) qsort(names, name_count, sizeof(*names), sem_cmp_names);
 
+  for (uint32_t i = 0; rc == 0 && i < name_count; i++) {
     char full[1024];
-    const int n = snprintf(full, sizeof(full), "%s/%s", dir, nm);
+    const int n = snprintf(full, sizeof(full), "%s/%s", dir, names[i]);
     if (n <= 0 || (size_t)n >= sizeof(full)) {
-      fprintf(stderr, "sem: --check: path too long: %s/%s\n", dir, nm);
-      closedir(d);
-      return 2;
+      fprintf(stderr, "sem: --check: path too long: %s/%s\n", dir, names[i]);
+      rc = 2;
+      break;
     }
     if (!sem_path_is_file(full)) continue;
-
-    const int rc = sem_do_check_one(full, do_run, host_cfg, check_format, diag_format, diag_all);
-    if (rc == 0)
-      (*inout_ok)++;
-    else
-      (*inout_fail)++;
+    if (!sem_check_list_add(l, full)) {
+      fprintf(stderr, "sem: --check: out of memory\n");
+      rc = 2;
+    }
   }
+  for (uint32_t i = 0; i < name_count; i++) free(names[i]);
+  free(names);
+  return rc;
+}
 
-  closedir(d);
-  return 0;
+typedef struct sem_check_tally {
+  sem_check_format_t format;
+  bool do_run;
+  uint32_t ok;
+  uint32_t fail;
+  uint64_t case_ns;
+  const sem_check_case_t* slowest;
+} sem_check_tally_t;
+
+static void sem_check_on_case(void* user, const sem_check_case_t* c) {
+  sem_check_tally_t* t = (sem_check_tally_t*)user;
+  const bool ok = c->tool_rc == 0;
+  sem_emit_check_case(t->format, t->do_run ? "run" : "verify", c->path, ok, c->tool_rc, c->prog_rc, (double)c->ns / 1e6);
+  if (ok)
+    t->ok++;
+  else
+    t->fail++;
+  t->case_ns += c->ns;
+  if (!t->slowest || c->ns > t->slowest->ns) t->slowest = c;
 }
 
 static void sem_print_support(FILE* out, bool json) {
@@ -1261,6 +1365,7 @@ int main(int argc, char** argv) {
   bool sir_module_hello = false;
   const char* run_path = NULL;
   const char* verify_path = NULL;
+  const char* jit_path = NULL;
   const char* check_paths_buf[256];
   const char** check_paths = NULL;
   uint32_t check_path_count = 0;
@@ -1275,13 +1380,22 @@ int main(int argc, char** argv) {
   const char* tape_in = NULL;
   bool tape_strict = true;
   bool check_run = false;
+  uint32_t check_jobs = 1;
   sem_check_format_t check_format = SEM_CHECK_TEXT;
   sem_list_format_t list_format = SEM_LIST_TEXT;
   const char* format_opt = NULL;
   const char* trace_jsonl_out = NULL;
+  const char* trace_bin_out = NULL;
+  const char* trace_bin_in = NULL;
   const char* coverage_jsonl_out = NULL;
+  const char* profile_out = NULL;
+  const char* profile_funcs_out = NULL;
+  uint32_t profile_period = 0;
+  const char* profile_blocks_out = NULL;
   const char* trace_func = NULL;
   const char* trace_op = NULL;
+  char trace_func_buf[1024] = {0};
+  char trace_op_buf[1024] = {0};
 
   dyn_cap_t dyn_caps[64];
   uint32_t dyn_n = 0;
@@ -1336,6 +1450,21 @@ int main(int argc, char** argv) {
       check_mode = true;
       continue;
     }
+    if (strcmp(a, "-j") == 0 || strcmp(a, "--jobs") == 0 || strncmp(a, "-j", 2) == 0) {
+      // -j N, --jobs N or -jN
+      const char* v = a[1] == 'j' && a[2] != '\0' ? a + 2 : (i + 1 < argc ? argv[++i] : "");
+      char* end = NULL;
+      const unsigned long n = strtoul(v, &end, 10);
+      if (!end || end == v || *end != '\0' || n > 1024ul) {
+        fprintf(stderr, "sem: bad -j value (expected 0..1024)\n");
+        sem_free_caps(dyn_caps, dyn_n);
+        sem_free_argv(guest_argv, guest_argc);
+        sem_free_env(env_buf, env_n);
+        return 2;
+      }
+      check_jobs = n ? (uint32_t)n : sem_check_cpu_count();
+      continue;
+    }
     if (strcmp(a, "--format") == 0 && i + 1 < argc) {
       format_opt = argv[++i];
       continue;
@@ -1360,6 +1489,10 @@ int main(int argc, char** argv) {
       verify_path = argv[++i];
       continue;
     }
+    if (strcmp(a, "--jit") == 0 && i + 1 < argc) {
+      jit_path = argv[++i];
+      continue;
+    }
     if (strcmp(a, "--diagnostics") == 0 && i + 1 < argc) {
       const char* f = argv[++i];
       if (strcmp(f, "text") == 0) diag_format = SEM_DIAG_TEXT;
@@ -1405,16 +1538,59 @@ int main(int argc, char** argv) {
       trace_jsonl_out = argv[++i];
       continue;
     }
-    if (strcmp(a, "--coverage-jsonl-out") == 0 && i + 1 < argc) {
-      coverage_jsonl_out = argv[++i];
+    if (strcmp(a, "--trace-bin-out") == 0 && i + 1 < argc) {
+      trace_bin_out = argv[++i];
+      continue;
+    }
+    if (strcmp(a, "--trace-bin-to-jsonl") == 0 && i + 1 < argc) {
+      trace_bin_in = argv[++i];
+      continue;
+    }
+    if (strcmp(a, "--profile-out") == 0 && i + 1 < argc) {
+      profile_out = argv[++i];
+      continue;
+    }
+    if (strcmp(a, "--profile-funcs-out") == 0 && i + 1 < argc) {
+      profile_funcs_out = argv[++i];
+      continue;
+    }
+    if (strcmp(a, "--profile-blocks-out") == 0 && i + 1 < argc) {
+      profile_blocks_out = argv[++i];
+      continue;
+    }
+    if (strcmp(a, "--profile-period") == 0 && i + 1 < argc) {
+      const char* v = argv[++i];
+      char* end = NULL;
+      const unsigned long n = strtoul(v, &end, 10);
+      if (!v[0] || !end || *end != '\0' || n == 0 || n > UINT32_MAX) {
+        fprintf(stderr, "sem: bad --profile-period value (expected a positive instruction count)\n");
+        sem_free_caps(dyn_caps, dyn_n);
+        sem_free_argv(guest_argv, guest_argc);
+        sem_free_env(env_buf, env_n);
+        return 2;
+      }
+      profile_period = (uint32_t)n;
       continue;
     }
-    if (strcmp(a, "--trace-func") == 0 && i + 1 < argc) {
-      trace_func = argv[++i];
+    if (strcmp(a, "--coverage-jsonl-out") == 0 && i + 1 < argc) {
+      coverage_jsonl_out = argv[++i];
       continue;
     }
-    if (strcmp(a, "--trace-op") == 0 && i + 1 < argc) {
-      trace_op = argv[++i];
+    if ((strcmp(a, "--trace-func") == 0 || strcmp(a, "--trace-op") == 0) && i + 1 < argc) {
+      // Repeated filters accumulate into one comma-separated list.
+      const bool is_func = strcmp(a, "--trace-func") == 0;
+      char* buf = is_func ? trace_func_buf : trace_op_buf;
+      const size_t used = strlen(buf);
+      const int n = snprintf(buf + used, sizeof(trace_func_buf) - used, "%s%s", used ? "," : "", argv[++i]);
+      if (n < 0 || (size_t)n >= sizeof(trace_func_buf) - used) {
+        fprintf(stderr, "sem: %s: filter list too long\n", a);
+        sem_free_caps(dyn_caps, dyn_n);
+        sem_free_argv(guest_argv, guest_argc);
+        sem_free_env(env_buf, env_n);
+        return 2;
+      }
+      if (is_func) trace_func = buf;
+      else trace_op = buf;
       continue;
     }
 
@@ -1627,9 +1803,17 @@ int main(int argc, char** argv) {
     sem_free_env(env_buf, env_n);
     return 0;
   }
+  if (trace_bin_in) {
+    const bool ok = sem_tbin_to_jsonl(trace_bin_in, stdout);
+    if (!ok) fprintf(stderr, "sem: bad or truncated binary trace: %s\n", trace_bin_in);
+    sem_free_caps(dyn_caps, dyn_n);
+    sem_free_argv(guest_argv, guest_argc);
+    sem_free_env(env_buf, env_n);
+    return ok ? 0 : 2;
+  }
 
-  if (run_path && verify_path) {
-    fprintf(stderr, "sem: choose either --run or --verify\n");
+  if ((run_path != NULL) + (verify_path != NULL) + (jit_path != NULL) > 1) {
+    fprintf(stderr, "sem: choose one of --run, --verify or --jit\n");
     sem_free_caps(dyn_caps, dyn_n);
     sem_free_argv(guest_argv, guest_argc);
     sem_free_env(env_buf, env_n);
@@ -1658,7 +1842,7 @@ int main(int argc, char** argv) {
     return 2;
   }
 
-  if (!want_caps && !cat_path && !sir_hello && !sir_module_hello && !run_path && !verify_path && !check_path_count && !list_path_count) {
+  if (!want_caps && !cat_path && !sir_hello && !sir_module_hello && !run_path && !verify_path && !jit_path && !check_path_count && !list_path_count) {
     sem_print_help(stdout);
     sem_free_caps(dyn_caps, dyn_n);
     sem_free_argv(guest_argv, guest_argc);
@@ -1763,8 +1947,46 @@ int main(int argc, char** argv) {
     sem_free_env(env_buf, env_n);
     return sem_do_sir_module_hello();
   }
+  if (run_path && (profile_out || profile_funcs_out)) {
+    int rc = 2;
+    if (trace_jsonl_out || trace_bin_out || coverage_jsonl_out || profile_blocks_out) {
+      // Those instrument every step; the profile would measure them too.
+      fprintf(stderr, "sem: --profile-out cannot be combined with trace, coverage or block profile outputs\n");
+    } else {
+      rc = sem_run_sir_jsonl_profile_host_ex(run_path, host_cfg, diag_format, diag_all, profile_out, profile_funcs_out, profile_period);
+    }
+    sem_free_caps(dyn_caps, dyn_n);
+    sem_free_argv(guest_argv, guest_argc);
+    sem_free_env(env_buf, env_n);
+    return rc;
+  }
+  if (run_path && profile_blocks_out) {
+    int rc = 2;
+    if (trace_jsonl_out || trace_bin_out || coverage_jsonl_out) {
+      fprintf(stderr, "sem: --profile-blocks-out cannot be combined with trace or coverage outputs\n");
+    } else {
+      rc = sem_run_sir_jsonl_block_profile_host_ex(run_path, host_cfg, diag_format, diag_all, profile_blocks_out);
+    }
+    sem_free_caps(dyn_caps, dyn_n);
+    sem_free_argv(guest_argv, guest_argc);
+    sem_free_env(env_buf, env_n);
+    return rc;
+  }
   if (run_path) {
-    const int rc = sem_run_sir_jsonl_events_host_ex(run_path, host_cfg, diag_format, diag_all, trace_jsonl_out, coverage_jsonl_out, trace_func, trace_op);
+    const int rc = sem_run_sir_jsonl_events_bin_host_ex(run_path, host_cfg, diag_format, diag_all, trace_jsonl_out, trace_bin_out, coverage_jsonl_out,
+                                                        trace_func, trace_op);
+    sem_free_caps(dyn_caps, dyn_n);
+    sem_free_argv(guest_argv, guest_argc);
+    sem_free_env(env_buf, env_n);
+    return rc;
+  }
+  if (jit_path) {
+#ifdef SEM_HAVE_JIT
+    const int rc = sem_jit_run_sir_jsonl(jit_path, host_cfg, diag_format, tape_out, tape_in, tape_strict);
+#else
+    fprintf(stderr, "sem: --jit: this build has no LLVM JIT support\n");
+    const int rc = 2;
+#endif
     sem_free_caps(dyn_caps, dyn_n);
     sem_free_argv(guest_argv, guest_argc);
     sem_free_env(env_buf, env_n);
@@ -1778,36 +2000,57 @@ int main(int argc, char** argv) {
     return rc;
   }
   if (check_path_count) {
-    uint32_t ok = 0, fail = 0;
+    sem_check_list_t list;
+    memset(&list, 0, sizeof(list));
     int tool_rc = 0;
 
     for (uint32_t i = 0; i < check_path_count; i++) {
       const char* p = check_paths[i];
       if (!p || p[0] == '\0') continue;
       if (sem_path_is_dir(p)) {
-        const int rc = sem_do_check_dir(p, check_run, host_cfg, check_format, diag_format, diag_all, &ok, &fail);
+        const int rc = sem_collect_check_dir(p, &list);
         if (rc != 0) tool_rc = rc;
       } else if (sem_path_is_file(p)) {
         if (!sem_is_sir_jsonl_path(p)) {
           fprintf(stderr, "sem: --check: skipping non-.sir.jsonl file: %s\n", p);
           continue;
         }
-        const int rc = sem_do_check_one(p, check_run, host_cfg, check_format, diag_format, diag_all);
-        if (rc == 0)
-          ok++;
-        else
-          fail++;
+        if (!sem_check_list_add(&list, p)) {
+          fprintf(stderr, "sem: --check: out of memory\n");
+          tool_rc = 2;
+        }
       } else {
         fprintf(stderr, "sem: --check: not a file/dir: %s\n", p);
         tool_rc = 2;
       }
     }
 
+    sem_check_tally_t tally = {.format = check_format, .do_run = check_run};
+    const sem_check_cfg_t cfg = {
+        .do_run = check_run,
+        .host_cfg = host_cfg,
+        .diag_format = diag_format,
+        .diag_all = diag_all,
+        .jobs = check_jobs,
+        .on_case = sem_check_on_case,
+        .user = &tally,
+    };
+    const double wall_ms = (double)sem_check_run(list.cases, list.count, &cfg) / 1e6;
+    const uint32_t ok = tally.ok, fail = tally.fail;
+
     if (check_format == SEM_CHECK_JSON) {
-      fprintf(stderr, "{\"tool\":\"sem\",\"k\":\"check_summary\",\"ok\":%u,\"fail\":%u}\n", (unsigned)ok, (unsigned)fail);
+      fprintf(stderr, "{\"tool\":\"sem\",\"k\":\"check_summary\",\"ok\":%u,\"fail\":%u,\"jobs\":%u,\"wall_ms\":%.3f,\"case_ms\":%.3f",
+              (unsigned)ok, (unsigned)fail, (unsigned)check_jobs, wall_ms, (double)tally.case_ns / 1e6);
+      if (tally.slowest) {
+        fprintf(stderr, ",\"slowest\":{\"path\":\"");
+        sem_json_write_path(stderr, tally.slowest->path);
+        fprintf(stderr, "\",\"ms\":%.3f}", (double)tally.slowest->ns / 1e6);
+      }
+      fprintf(stderr, "}\n");
     } else {
       fprintf(stdout, "sem: --check: ok=%u fail=%u\n", (unsigned)ok, (unsigned)fail);
     }
+    sem_check_list_free(&list);
     sem_free_caps(dyn_caps, dyn_n);
     sem_free_argv(guest_argv, guest_argc);
     sem_free_env(env_buf, env_n);
@@ -0,0 +1,165 @@
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // open_memstream/clock_gettime under -std=c11
+#endif
+
+#include "sem_check.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return 0;
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint32_t sem_check_cpu_count(void) {
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n < 1) return 1;
+  return n > 1024 ? 1024u : (uint32_t)n;
+}
+
+static void run_case(const sem_check_cfg_t* cfg, sem_check_case_t* c, bool capture) {
+  c->tool_rc = 0;
+  c->prog_rc = 0;
+  c->diag = NULL;
+  c->diag_len = 0;
+  c->out = NULL;
+  c->out_len = 0;
+
+  // Concurrent cases buffer their diagnostics and guest output; both are
+  // printed in input order.
+  FILE* diag = capture ? open_memstream(&c->diag, &c->diag_len) : NULL;
+  FILE* out = capture && cfg->do_run ? open_memstream(&c->out, &c->out_len) : NULL;
+  if (diag) sem_set_diag_out(diag);
+
+  const uint64_t t0 = now_ns();
+  if (cfg->do_run) {
+    sem_run_host_cfg_t host_cfg = cfg->host_cfg;
+    if (out) host_cfg.std_out = out;
+    if (diag) host_cfg.std_err = diag;
+    c->tool_rc = sem_run_sir_jsonl_capture_host_ex(c->path, host_cfg, cfg->diag_format, cfg->diag_all, &c->prog_rc);
+  } else {
+    c->tool_rc = sem_verify_sir_jsonl_ex(c->path, cfg->diag_format, cfg->diag_all);
+  }
+  c->ns = now_ns() - t0;
+
+  if (out) (void)fclose(out);
+  if (diag) {
+    sem_set_diag_out(NULL);
+    (void)fclose(diag);
+  }
+}
+
+static void report_case(const sem_check_cfg_t* cfg, sem_check_case_t* c) {
+  if (c->out && c->out_len) {
+    (void)fwrite(c->out, 1, c->out_len, stdout);
+    (void)fflush(stdout);
+  }
+  if (c->diag && c->diag_len) {
+    (void)fwrite(c->diag, 1, c->diag_len, stderr);
+    (void)fflush(stderr);
+  }
+  if (cfg->on_case) cfg->on_case(cfg->user, c);
+  free(c->out);
+  free(c->diag);
+  c->out = NULL;
+  c->out_len = 0;
+  c->diag = NULL;
+  c->diag_len = 0;
+}
+
+typedef struct sem_check_pool {
+  sem_check_case_t* cases;
+  uint32_t count;
+  const sem_check_cfg_t* cfg;
+  bool* done;
+
+  pthread_mutex_t mu;
+  pthread_cond_t cv;  // signalled when a case finishes
+  uint32_t next;      // next case to claim
+  uint32_t reported;  // cases [0, reported) went to on_case
+} sem_check_pool_t;
+
+static void* pool_worker(void* arg) {
+  sem_check_pool_t* p = (sem_check_pool_t*)arg;
+  (void)pthread_mutex_lock(&p->mu);
+  while (p->next < p->count) {
+    const uint32_t i = p->next++;
+    (void)pthread_mutex_unlock(&p->mu);
+    run_case(p->cfg, &p->cases[i], true);
+    (void)pthread_mutex_lock(&p->mu);
+    p->done[i] = true;
+    (void)pthread_cond_signal(&p->cv);
+  }
+  (void)pthread_mutex_unlock(&p->mu);
+  return NULL;
+}
+
+// Reports the finished prefix of the case list. Only the calling thread
+// reports; the lock is dropped around callbacks so workers keep going.
+static void pool_flush(sem_check_pool_t* p) {
+  while (p->reported < p->count && p->done[p->reported]) {
+    sem_check_case_t* c = &p->cases[p->reported++];
+    (void)pthread_mutex_unlock(&p->mu);
+    report_case(p->cfg, c);
+    (void)pthread_mutex_lock(&p->mu);
+  }
+}
+
+uint64_t sem_check_run(sem_check_case_t* cases, uint32_t count, const sem_check_cfg_t* cfg) {
+  if (!cases || !cfg) return 0;
+  const uint64_t t0 = now_ns();
+  uint32_t jobs = cfg->jobs ? cfg->jobs : 1u;
+  if (jobs > count) jobs = count;
+
+  bool* done = jobs > 1 ? (bool*)calloc(count, sizeof(*done)) : NULL;
+  pthread_t* tids = jobs > 1 ? (pthread_t*)calloc(jobs, sizeof(*tids)) : NULL;
+  bool* started = jobs > 1 ? (bool*)calloc(jobs, sizeof(*started)) : NULL;
+  if (!done || !tids || !started) {
+    free(done);
+    free(tids);
+    free(started);
+    for (uint32_t i = 0; i < count; i++) {
+      run_case(cfg, &cases[i], false);
+      report_case(cfg, &cases[i]);
+    }
+    return now_ns() - t0;
+  }
+
+  sem_check_pool_t p = {.cases = cases, .count = count, .cfg = cfg, .done = done};
+  (void)pthread_mutex_init(&p.mu, NULL);
+  (void)pthread_cond_init(&p.cv, NULL);
+
+  // The calling thread is worker 0: it claims cases like the others and
+  // reports whatever prefix has finished in between.
+  for (uint32_t t = 1; t < jobs; t++) started[t] = pthread_create(&tids[t], NULL, pool_worker, &p) == 0;
+
+  (void)pthread_mutex_lock(&p.mu);
+  while (p.next < count) {
+    const uint32_t i = p.next++;
+    (void)pthread_mutex_unlock(&p.mu);
+    run_case(cfg, &cases[i], true);
+    (void)pthread_mutex_lock(&p.mu);
+    done[i] = true;
+    pool_flush(&p);
+  }
+  while (p.reported < count) {
+    pool_flush(&p);
+    if (p.reported < count) (void)pthread_cond_wait(&p.cv, &p.mu);
+  }
+  (void)pthread_mutex_unlock(&p.mu);
+
+  for (uint32_t t = 1; t < jobs; t++) {
+    if (started[t]) (void)pthread_join(tids[t], NULL);
+  }
+  (void)pthread_cond_destroy(&p.cv);
+  (void)pthread_mutex_destroy(&p.mu);
+  free(done);
+  free(tids);
+  free(started);
+  return now_ns() - t0;
+}
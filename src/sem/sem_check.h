@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sir_jsonl.h"
+
+// One `sem --check` case and, once run, its result.
+typedef struct sem_check_case {
+  const char* path;
+  int tool_rc;   // 0 ok, else 1/2 as returned by sem_verify/sem_run
+  int prog_rc;   // program exit code (run mode, tool_rc == 0)
+  uint64_t ns;   // wall time spent on this case
+  char* diag;    // diagnostics and guest stderr captured while running concurrently
+  size_t diag_len;
+  char* out;     // guest stdout captured while running concurrently
+  size_t out_len;
+} sem_check_case_t;
+
+typedef struct sem_check_cfg {
+  bool do_run;
+  sem_run_host_cfg_t host_cfg;
+  sem_diag_format_t diag_format;
+  bool diag_all;
+  uint32_t jobs; // 0 or 1 runs the cases one by one on the calling thread
+
+  // Called on the calling thread, in input order, after the case's guest
+  // output and diagnostics have been written to stdout/stderr.
+  void (*on_case)(void* user, const sem_check_case_t* c);
+  void* user;
+} sem_check_cfg_t;
+
+// Runs every case, up to cfg->jobs at a time. Each case gets its own module,
+// guest memory and handle table, so results match a serial run. Returns the
+// wall time taken, in nanoseconds.
+uint64_t sem_check_run(sem_check_case_t* cases, uint32_t count, const sem_check_cfg_t* cfg);
+
+// Number of online CPUs (at least 1); used for `-j 0`.
+uint32_t sem_check_cpu_count(void);
@@ -0,0 +1,273 @@
+#include "sem_jit.h"
+
+#include "compiler.h"
+#include "guest_mem.h"
+#include "hosted_zabi.h"
+#include "zcl1.h"
+#include "zi_tape.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Native code calls the trampolines without a context argument, so they reach
+// the runtime through g_jit (one JIT run at a time per process).
+typedef struct sem_jit {
+  sem_guest_mem_t mem;
+  sir_hosted_zabi_t hz;
+  sir_zi_ctl_fn ctl; // hosted, recording or replaying
+  void* ctl_user;
+} sem_jit_t;
+
+static sem_jit_t* g_jit;
+
+// A native buffer passed to the hosted runtime. Guest memory is identity-mapped
+// (sem_guest_mem_init_native), so pointers into it pass straight through;
+// anything else (globals, native stack) is staged through a scratch guest block.
+typedef struct jit_buf {
+  zi_ptr_t guest;
+  uint8_t* host;
+  bool staged;
+} jit_buf_t;
+
+static bool jit_buf_in(jit_buf_t* b, uint64_t p, uint32_t len, bool copy_in) {
+  sem_guest_mem_t* m = &g_jit->mem;
+  const uint8_t* r = NULL;
+  b->guest = (zi_ptr_t)p;
+  b->host = (uint8_t*)(uintptr_t)p;
+  b->staged = false;
+  if (p == 0 || sem_guest_mem_map_ro(m, (zi_ptr_t)p, len, &r)) return true;
+
+  b->guest = sem_guest_alloc(m, len ? len : 1u, 16);
+  if (!b->guest) return false;
+  b->staged = true;
+  uint8_t* w = NULL;
+  if (copy_in && len && sem_guest_mem_map_rw(m, b->guest, len, &w)) memcpy(w, b->host, len);
+  return true;
+}
+
+// Copies `n` bytes back to a staged buffer and releases the scratch block.
+static void jit_buf_out(jit_buf_t* b, int32_t n) {
+  if (!b->staged) return;
+  const uint8_t* r = NULL;
+  if (n > 0 && sem_guest_mem_map_ro(&g_jit->mem, b->guest, (zi_size32_t)n, &r)) memcpy(b->host, r, (size_t)n);
+  (void)sem_guest_free(&g_jit->mem, b->guest);
+}
+
+static int32_t jit_ctl_host(void* user, const uint8_t* req, uint32_t req_len, uint8_t* resp, uint32_t resp_cap) {
+  sem_jit_t* j = (sem_jit_t*)user;
+  jit_buf_t rq, rs;
+  if (!jit_buf_in(&rq, (uint64_t)(uintptr_t)req, req_len, true)) return -8;
+  if (!jit_buf_in(&rs, (uint64_t)(uintptr_t)resp, resp_cap, false)) {
+    jit_buf_out(&rq, 0);
+    return -8;
+  }
+  const int32_t rc = sir_zi_ctl(&j->hz, rq.guest, req_len, rs.guest, resp_cap);
+  jit_buf_out(&rs, rc > (int32_t)resp_cap ? (int32_t)resp_cap : rc);
+  jit_buf_out(&rq, 0);
+  return rc;
+}
+
+// --- zi_* trampolines (zABI 2.5 native signatures) ---
+
+static uint32_t jit_zi_abi_version(void) { return sir_zi_abi_version(&g_jit->hz); }
+
+static int32_t jit_zi_ctl(uint64_t req, uint32_t req_len, uint64_t resp, uint32_t resp_cap) {
+  if ((!req && req_len) || (!resp && resp_cap)) return -2;
+  return g_jit->ctl(g_jit->ctl_user, (const uint8_t*)(uintptr_t)req, req_len, (uint8_t*)(uintptr_t)resp, resp_cap);
+}
+
+static int32_t jit_zi_read(int32_t h, uint64_t dst, uint32_t cap) {
+  jit_buf_t b;
+  if (!jit_buf_in(&b, dst, cap, false)) return -8;
+  const int32_t rc = sir_zi_read(&g_jit->hz, h, b.guest, cap);
+  jit_buf_out(&b, rc);
+  return rc;
+}
+
+static int32_t jit_zi_write(int32_t h, uint64_t src, uint32_t len) {
+  jit_buf_t b;
+  if (!jit_buf_in(&b, src, len, true)) return -8;
+  const int32_t rc = sir_zi_write(&g_jit->hz, h, b.guest, len);
+  jit_buf_out(&b, 0);
+  return rc;
+}
+
+static int32_t jit_zi_end(int32_t h) { return sir_zi_end(&g_jit->hz, h); }
+static uint64_t jit_zi_alloc(uint32_t size) { return sir_zi_alloc(&g_jit->hz, size); }
+static int32_t jit_zi_free(uint64_t p) { return sir_zi_free(&g_jit->hz, p); }
+
+static int32_t jit_zi_telemetry(uint64_t topic, uint32_t topic_len, uint64_t msg, uint32_t msg_len) {
+  jit_buf_t t, m;
+  if (!jit_buf_in(&t, topic, topic_len, true)) return -8;
+  if (!jit_buf_in(&m, msg, msg_len, true)) {
+    jit_buf_out(&t, 0);
+    return -8;
+  }
+  const int32_t rc = sir_zi_telemetry(&g_jit->hz, t.guest, topic_len, m.guest, msg_len);
+  jit_buf_out(&m, 0);
+  jit_buf_out(&t, 0);
+  return rc;
+}
+
+static int32_t jit_zi_cap_count(void) { return sir_zi_cap_count(&g_jit->hz); }
+static int32_t jit_zi_cap_get_size(int32_t i) { return sir_zi_cap_get_size(&g_jit->hz, i); }
+
+static int32_t jit_zi_cap_get(int32_t i, uint64_t out, uint32_t cap) {
+  jit_buf_t b;
+  if (!jit_buf_in(&b, out, cap, false)) return -8;
+  const int32_t rc = sir_zi_cap_get(&g_jit->hz, i, b.guest, cap);
+  jit_buf_out(&b, rc);
+  return rc;
+}
+
+static uint64_t jit_read_u64le(const uint8_t* p) { return (uint64_t)zcl1_read_u32le(p) | ((uint64_t)zcl1_read_u32le(p + 4) << 32); }
+
+static void jit_write_u64le(uint8_t* p, uint64_t v) {
+  zcl1_write_u32le(p, (uint32_t)v);
+  zcl1_write_u32le(p + 4, (uint32_t)(v >> 32));
+}
+
+// The open request embeds kind/name/params pointers; each is staged on its own
+// and the request is rebuilt in guest memory around the guest copies.
+static int32_t jit_zi_cap_open(uint64_t req_ptr) {
+  if (!req_ptr) return -2;
+  const uint8_t* req = (const uint8_t*)(uintptr_t)req_ptr;
+  const uint32_t kind_len = zcl1_read_u32le(req + 8);
+  const uint32_t name_len = zcl1_read_u32le(req + 20);
+  const uint32_t params_len = zcl1_read_u32le(req + 36);
+
+  jit_buf_t kind, name, params, rq;
+  if (!jit_buf_in(&kind, jit_read_u64le(req + 0), kind_len, true)) return -8;
+  if (!jit_buf_in(&name, jit_read_u64le(req + 12), name_len, true)) {
+    jit_buf_out(&kind, 0);
+    return -8;
+  }
+  if (!jit_buf_in(&params, jit_read_u64le(req + 28), params_len, true)) {
+    jit_buf_out(&name, 0);
+    jit_buf_out(&kind, 0);
+    return -8;
+  }
+  int32_t rc = -8;
+  uint8_t* w = NULL;
+  if (jit_buf_in(&rq, req_ptr, 40u, true)) {
+    if (sem_guest_mem_map_rw(&g_jit->mem, rq.guest, 40u, &w)) {
+      jit_write_u64le(w + 0, kind.guest);
+      jit_write_u64le(w + 12, name.guest);
+      jit_write_u64le(w + 28, params.guest);
+      rc = sir_zi_cap_open(&g_jit->hz, rq.guest);
+    }
+    // Restore the caller's request if it lived in guest memory.
+    if (!rq.staged && w) {
+      jit_write_u64le(w + 0, (uint64_t)(uintptr_t)kind.host);
+      jit_write_u64le(w + 12, (uint64_t)(uintptr_t)name.host);
+      jit_write_u64le(w + 28, (uint64_t)(uintptr_t)params.host);
+    }
+    jit_buf_out(&rq, 0);
+  }
+  jit_buf_out(&params, 0);
+  jit_buf_out(&name, 0);
+  jit_buf_out(&kind, 0);
+  return rc;
+}
+
+static uint32_t jit_zi_handle_hflags(int32_t h) { return sir_zi_handle_hflags(&g_jit->hz, h); }
+
+#define JIT_SYM(n, f) {.name = n, .addr = (uint64_t)(uintptr_t)(f)}
+
+static const SirccJitSymbol jit_imports[] = {
+    JIT_SYM("zi_abi_version", jit_zi_abi_version),
+    JIT_SYM("zi_ctl", jit_zi_ctl),
+    JIT_SYM("zi_read", jit_zi_read),
+    JIT_SYM("zi_write", jit_zi_write),
+    JIT_SYM("zi_end", jit_zi_end),
+    JIT_SYM("zi_alloc", jit_zi_alloc),
+    JIT_SYM("zi_free", jit_zi_free),
+    JIT_SYM("zi_telemetry", jit_zi_telemetry),
+    JIT_SYM("zi_cap_count", jit_zi_cap_count),
+    JIT_SYM("zi_cap_get_size", jit_zi_cap_get_size),
+    JIT_SYM("zi_cap_get", jit_zi_cap_get),
+    JIT_SYM("zi_cap_open", jit_zi_cap_open),
+    JIT_SYM("zi_handle_hflags", jit_zi_handle_hflags),
+    // LLVM lowers mem.copy/mem.fill intrinsics to these.
+    JIT_SYM("memcpy", memcpy),
+    JIT_SYM("memmove", memmove),
+    JIT_SYM("memset", memset),
+};
+
+int sem_jit_run_sir_jsonl(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, const char* tape_out,
+                          const char* tape_in, bool tape_strict) {
+  if (!path) return 2;
+  if (g_jit) {
+    fprintf(stderr, "sem: --jit: a JIT run is already active\n");
+    return 2;
+  }
+
+  sem_jit_t j;
+  memset(&j, 0, sizeof(j));
+  if (!sem_guest_mem_init_native(&j.mem, 16u * 1024u * 1024u) ||
+      !sir_hosted_zabi_init_with_mem(&j.hz, &j.mem,
+                                     (sir_hosted_zabi_cfg_t){.abi_version = 0x00020005u,
+                                                             .caps = host_cfg.caps,
+                                                             .cap_count = host_cfg.cap_count,
+                                                             .argv_enabled = host_cfg.argv_enabled,
+                                                             .argv = host_cfg.argv,
+                                                             .argv_count = host_cfg.argv_count,
+                                                             .env_enabled = host_cfg.env_enabled,
+                                                             .env = host_cfg.env,
+                                                             .env_count = host_cfg.env_count,
+                                                             .fs_root = host_cfg.fs_root})) {
+    sem_guest_mem_dispose(&j.mem);
+    fprintf(stderr, "sem: failed to init runtime\n");
+    return 1;
+  }
+
+  zi_tape_writer_t* tw = NULL;
+  zi_tape_reader_t* tr = NULL;
+  zi_ctl_record_ctx_t rec = {0};
+  zi_ctl_replay_ctx_t rep = {0};
+  j.ctl = jit_ctl_host;
+  j.ctl_user = &j;
+  if (tape_in) {
+    tr = zi_tape_reader_open(tape_in);
+    if (!tr) {
+      fprintf(stderr, "sem: failed to open tape for replay: %s\n", tape_in);
+      sir_hosted_zabi_dispose(&j.hz);
+      sem_guest_mem_dispose(&j.mem);
+      return 1;
+    }
+    rep = (zi_ctl_replay_ctx_t){.tape = tr, .strict_match = tape_strict};
+    j.ctl = zi_ctl_replay;
+    j.ctl_user = &rep;
+  } else if (tape_out) {
+    tw = zi_tape_writer_open(tape_out);
+    if (!tw) {
+      fprintf(stderr, "sem: failed to open tape for record: %s\n", tape_out);
+      sir_hosted_zabi_dispose(&j.hz);
+      sem_guest_mem_dispose(&j.mem);
+      return 1;
+    }
+    rec = (zi_ctl_record_ctx_t){.inner = jit_ctl_host, .inner_user = &j, .tape = tw};
+    j.ctl = zi_ctl_record;
+    j.ctl_user = &rec;
+  }
+
+  const SirccOptions opt = {
+      .argv0 = "sem",
+      .input_path = path,
+      .diagnostics = diag_format == SEM_DIAG_JSON ? SIRCC_DIAG_JSON : SIRCC_DIAG_TEXT,
+      .color = SIRCC_COLOR_NEVER,
+  };
+  int64_t ret = 0;
+  g_jit = &j;
+  const int crc = sircc_jit_run(&opt, jit_imports, sizeof(jit_imports) / sizeof(jit_imports[0]), &ret);
+  g_jit = NULL;
+
+  if (tw) zi_tape_writer_close(tw);
+  if (tr) zi_tape_reader_close(tr);
+  sir_hosted_zabi_dispose(&j.hz);
+  sem_guest_mem_dispose(&j.mem);
+
+  if (crc != SIRCC_EXIT_OK) return crc == SIRCC_EXIT_ERROR ? 1 : 2;
+  return (int)ret;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "sir_jsonl.h"
+
+// Runs FILE.sir.jsonl as native code: sircc lowers it to LLVM IR and ORC LLJIT
+// compiles it in-process. `zi_*` imports bind to the hosted zABI runtime over a
+// single guest memory arena, so the capability set and zi_ctl tape
+// record/replay behave as under --run.
+// Returns the program's exit code, or 1/2 for tool errors.
+int sem_jit_run_sir_jsonl(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, const char* tape_out,
+                          const char* tape_in, bool tape_strict);
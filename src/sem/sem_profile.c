@@ -0,0 +1,261 @@
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // open_memstream under -std=c11
+#endif
+
+#include "sem_profile.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One distinct sampled stack; its fids live in sem_profile::pool.
+typedef struct prof_stack {
+  uint64_t hash;
+  uint32_t off;
+  uint32_t depth;
+  uint64_t count;
+} prof_stack_t;
+
+struct sem_profile {
+  uint32_t period;
+  uint64_t samples;
+  bool oom; // some samples could not be recorded
+
+  prof_stack_t* stacks;
+  uint32_t stack_count;
+  uint32_t stack_cap;
+  uint32_t* slots; // open addressing: stack index + 1, 0 = empty
+  uint32_t slot_cap;
+
+  sir_func_id_t* pool;
+  size_t pool_len;
+  size_t pool_cap;
+};
+
+sem_profile_t* sem_profile_new(uint32_t period) {
+  if (period == 0) return NULL;
+  sem_profile_t* p = (sem_profile_t*)calloc(1, sizeof(*p));
+  if (!p) return NULL;
+  p->period = period;
+  return p;
+}
+
+void sem_profile_free(sem_profile_t* p) {
+  if (!p) return;
+  free(p->stacks);
+  free(p->slots);
+  free(p->pool);
+  free(p);
+}
+
+uint64_t sem_profile_samples(const sem_profile_t* p) { return p ? p->samples : 0; }
+
+static uint64_t prof_hash(const sir_func_id_t* stack, uint32_t depth) {
+  uint64_t h = 1469598103934665603ull ^ depth;
+  for (uint32_t i = 0; i < depth; i++) h = (h ^ stack[i]) * 1099511628211ull;
+  return h;
+}
+
+static bool prof_rehash(sem_profile_t* p) {
+  const uint32_t cap = p->slot_cap ? p->slot_cap * 2u : 256u;
+  uint32_t* slots = (uint32_t*)calloc(cap, sizeof(*slots));
+  if (!slots) return false;
+  for (uint32_t i = 0; i < p->stack_count; i++) {
+    uint32_t h = (uint32_t)p->stacks[i].hash & (cap - 1u);
+    while (slots[h]) h = (h + 1u) & (cap - 1u);
+    slots[h] = i + 1u;
+  }
+  free(p->slots);
+  p->slots = slots;
+  p->slot_cap = cap;
+  return true;
+}
+
+static bool prof_add_stack(sem_profile_t* p, const sir_func_id_t* stack, uint32_t depth, uint64_t hash, uint32_t slot) {
+  if (p->stack_count == p->stack_cap) {
+    const uint32_t cap = p->stack_cap ? p->stack_cap * 2u : 64u;
+    prof_stack_t* v = (prof_stack_t*)realloc(p->stacks, (size_t)cap * sizeof(*v));
+    if (!v) return false;
+    p->stacks = v;
+    p->stack_cap = cap;
+  }
+  if (p->pool_cap - p->pool_len < depth) {
+    size_t cap = p->pool_cap ? p->pool_cap * 2u : 1024u;
+    while (cap - p->pool_len < depth) cap *= 2u;
+    sir_func_id_t* v = (sir_func_id_t*)realloc(p->pool, cap * sizeof(*v));
+    if (!v) return false;
+    p->pool = v;
+    p->pool_cap = cap;
+  }
+  if (depth) memcpy(p->pool + p->pool_len, stack, (size_t)depth * sizeof(*stack));
+  p->stacks[p->stack_count] = (prof_stack_t){.hash = hash, .off = (uint32_t)p->pool_len, .depth = depth, .count = 1};
+  p->pool_len += depth;
+  p->slots[slot] = ++p->stack_count;
+  return true;
+}
+
+static void prof_on_sample(void* user, const sir_module_t* m, const sir_func_id_t* stack, uint32_t depth, uint32_t ip) {
+  (void)m;
+  (void)ip;
+  sem_profile_t* p = (sem_profile_t*)user;
+  p->samples++;
+  if ((p->stack_count + 1u) * 2u > p->slot_cap && !prof_rehash(p)) {
+    p->oom = true;
+    return;
+  }
+  const uint64_t hash = prof_hash(stack, depth);
+  uint32_t h = (uint32_t)hash & (p->slot_cap - 1u);
+  for (; p->slots[h]; h = (h + 1u) & (p->slot_cap - 1u)) {
+    prof_stack_t* s = &p->stacks[p->slots[h] - 1u];
+    if (s->hash == hash && s->depth == depth && memcmp(p->pool + s->off, stack, (size_t)depth * sizeof(*stack)) == 0) {
+      s->count++;
+      return;
+    }
+  }
+  if (!prof_add_stack(p, stack, depth, hash, h)) p->oom = true;
+}
+
+sir_exec_sampler_t sem_profile_sampler(sem_profile_t* p) {
+  sir_exec_sampler_t s;
+  memset(&s, 0, sizeof(s));
+  s.user = p;
+  s.period = p ? p->period : 0;
+  s.on_sample = p ? prof_on_sample : NULL;
+  return s;
+}
+
+static const char* prof_func_name(const sir_module_t* m, sir_func_id_t fid) {
+  if (!m || fid == 0 || fid > m->func_count || !m->funcs[fid - 1].name) return NULL;
+  return m->funcs[fid - 1].name;
+}
+
+// Folded-stack frames are separated by ';' and end at the last space, so
+// those (and line breaks) cannot appear in a frame name.
+static void prof_write_frame(FILE* out, const sir_module_t* m, sir_func_id_t fid) {
+  const char* name = prof_func_name(m, fid);
+  if (!name || !name[0]) {
+    fprintf(out, "fn#%u", (unsigned)fid);
+    return;
+  }
+  for (const char* c = name; *c; c++) fputc((*c == ';' || *c == ' ' || *c == '\t' || *c == '\n' || *c == '\r') ? '_' : *c, out);
+}
+
+typedef struct prof_line {
+  char* text;
+  size_t len;
+  uint64_t count;
+} prof_line_t;
+
+static int prof_line_cmp(const void* a, const void* b) {
+  const prof_line_t* x = (const prof_line_t*)a;
+  const prof_line_t* y = (const prof_line_t*)b;
+  const size_t n = x->len < y->len ? x->len : y->len;
+  const int c = memcmp(x->text, y->text, n);
+  if (c) return c;
+  return (x->len > y->len) - (x->len < y->len);
+}
+
+bool sem_profile_write_folded(const sem_profile_t* p, const sir_module_t* m, FILE* out) {
+  if (!p || !out) return false;
+  // Render every stack first so the output can be sorted by its text.
+  prof_line_t* lines = (prof_line_t*)calloc(p->stack_count ? p->stack_count : 1u, sizeof(*lines));
+  if (!lines) return false;
+  bool ok = true;
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < p->stack_count && ok; i++) {
+    const prof_stack_t* s = &p->stacks[i];
+    FILE* f = open_memstream(&lines[n].text, &lines[n].len);
+    if (!f) {
+      ok = false;
+      break;
+    }
+    for (uint32_t d = 0; d < s->depth; d++) {
+      if (d) fputc(';', f);
+      prof_write_frame(f, m, p->pool[s->off + d]);
+    }
+    if (s->depth == 0) fputs("[vm]", f);
+    if (fclose(f) != 0) ok = false;
+    lines[n].count = s->count;
+    n++;
+  }
+  if (ok) {
+    qsort(lines, n, sizeof(*lines), prof_line_cmp);
+    for (uint32_t i = 0; i < n; i++) {
+      // Stacks that differ only in sanitized names print as one line.
+      uint64_t count = lines[i].count;
+      while (i + 1u < n && prof_line_cmp(&lines[i], &lines[i + 1u]) == 0) count += lines[++i].count;
+      fwrite(lines[i].text, 1, lines[i].len, out);
+      fprintf(out, " %" PRIu64 "\n", count * p->period);
+    }
+  }
+  for (uint32_t i = 0; i < n; i++) free(lines[i].text);
+  free(lines);
+  return ok && !p->oom && !ferror(out);
+}
+
+static void prof_write_escaped(FILE* out, const char* s) {
+  for (const unsigned char* c = (const unsigned char*)s; *c; c++) {
+    if (*c == '\\' || *c == '"') {
+      fputc('\\', out);
+      fputc((int)*c, out);
+    } else if (*c == '\n') {
+      fputs("\\n", out);
+    } else if (*c == '\r') {
+      fputs("\\r", out);
+    } else if (*c == '\t') {
+      fputs("\\t", out);
+    } else if (*c < 0x20) {
+      fprintf(out, "\\u%04x", (unsigned)*c);
+    } else {
+      fputc((int)*c, out);
+    }
+  }
+}
+
+typedef struct prof_func {
+  sir_func_id_t fid;
+  uint64_t self;
+  uint64_t total;
+  uint64_t seen; // stack index + 1 that last counted total (recursion counts once)
+} prof_func_t;
+
+static int prof_func_cmp(const void* a, const void* b) {
+  const prof_func_t* x = (const prof_func_t*)a;
+  const prof_func_t* y = (const prof_func_t*)b;
+  if (x->self != y->self) return x->self < y->self ? 1 : -1;
+  if (x->total != y->total) return x->total < y->total ? 1 : -1;
+  return (x->fid > y->fid) - (x->fid < y->fid);
+}
+
+bool sem_profile_write_funcs_jsonl(const sem_profile_t* p, const sir_module_t* m, FILE* out) {
+  if (!p || !m || !out) return false;
+  prof_func_t* fs = (prof_func_t*)calloc(m->func_count ? m->func_count : 1u, sizeof(*fs));
+  if (!fs) return false;
+  for (uint32_t i = 0; i < m->func_count; i++) fs[i].fid = i + 1u;
+  for (uint32_t i = 0; i < p->stack_count; i++) {
+    const prof_stack_t* s = &p->stacks[i];
+    for (uint32_t d = 0; d < s->depth; d++) {
+      const sir_func_id_t fid = p->pool[s->off + d];
+      if (fid == 0 || fid > m->func_count) continue;
+      prof_func_t* f = &fs[fid - 1];
+      if (f->seen != i + 1u) {
+        f->seen = i + 1u;
+        f->total += s->count;
+      }
+      if (d + 1u == s->depth) f->self += s->count;
+    }
+  }
+  qsort(fs, m->func_count, sizeof(*fs), prof_func_cmp);
+  for (uint32_t i = 0; i < m->func_count && fs[i].total; i++) {
+    const char* name = prof_func_name(m, fs[i].fid);
+    fprintf(out, "{\"tool\":\"sem\",\"k\":\"profile_func\",\"fid\":%u,\"func\":\"", (unsigned)fs[i].fid);
+    prof_write_escaped(out, name ? name : "");
+    fprintf(out, "\",\"self\":%" PRIu64 ",\"total\":%" PRIu64 ",\"self_samples\":%" PRIu64 ",\"total_samples\":%" PRIu64 "}\n",
+            fs[i].self * p->period, fs[i].total * p->period, fs[i].self, fs[i].total);
+  }
+  fprintf(out,
+          "{\"tool\":\"sem\",\"k\":\"profile_summary\",\"period\":%u,\"samples\":%" PRIu64 ",\"insts\":%" PRIu64 ",\"stacks\":%u,\"complete\":%s}\n",
+          (unsigned)p->period, p->samples, p->samples * p->period, (unsigned)p->stack_count, p->oom ? "false" : "true");
+  free(fs);
+  return !p->oom && !ferror(out);
+}
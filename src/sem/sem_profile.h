@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sir_module.h"
+
+// Sampling profile of a guest run (`sem --run --profile-out PATH`).
+//
+// sircore samples the guest call stack every `period` instructions (see
+// sir_exec_sampler_t); this aggregates the samples by stack. A sample stands
+// for the `period` instructions before it, so instruction counts below are
+// estimates in steps of `period`.
+
+typedef struct sem_profile sem_profile_t;
+
+sem_profile_t* sem_profile_new(uint32_t period);
+void sem_profile_free(sem_profile_t* p);
+
+// A sampler feeding p; valid while p is.
+sir_exec_sampler_t sem_profile_sampler(sem_profile_t* p);
+
+uint64_t sem_profile_samples(const sem_profile_t* p);
+
+// Folded stacks for flamegraph tools: one `outer;...;leaf COUNT` line per
+// distinct stack, sorted, with COUNT in estimated instructions.
+bool sem_profile_write_folded(const sem_profile_t* p, const sir_module_t* m, FILE* out);
+
+// Per-function JSONL: a profile_func record per sampled function (self =
+// instructions in the function itself, total = including its callees) and
+// a closing profile_summary.
+bool sem_profile_write_funcs_jsonl(const sem_profile_t* p, const sir_module_t* m, FILE* out);
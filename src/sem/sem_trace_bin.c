@@ -0,0 +1,556 @@
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // nanosleep under -std=c11
+#endif
+
+#include "sem_trace_bin.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+  TB_FUNC = 0x01,
+  TB_OP = 0x02,
+  TB_CALLEE = 0x03,
+  TB_STEP = 0x10,
+  TB_STEP_FID = 0x11,
+  TB_MEM = 0x20,
+  TB_MEM_FID = 0x21,
+  TB_HOST = 0x30,
+  TB_HOST_FID = 0x31,
+};
+
+static const char tb_magic[8] = {'S', 'E', 'M', 'T', 'R', 'A', 'C', 'E'};
+
+#define TB_RING_BYTES (4u << 20)
+#define TB_STAGE_BYTES 8192u
+#define TB_EVENT_MAX 48u // largest fixed-size record
+
+// ---- writer ----
+
+struct sem_tbin_writer {
+  FILE* f;
+
+  // Single-producer/single-consumer byte ring. head and tail only grow;
+  // the VM thread advances head, the writer thread advances tail.
+  uint8_t* ring;
+  _Atomic size_t head;
+  _Atomic size_t tail;
+  _Atomic bool closing;
+  bool threaded;
+  bool io_error; // owned by the writer thread until it is joined
+  pthread_t thread;
+
+  // Records are built here and moved to the ring in batches.
+  uint8_t stage[TB_STAGE_BYTES];
+  uint32_t stage_len;
+
+  // Encoder state.
+  sir_func_id_t fid;
+  uint32_t ip;
+  uint64_t addr;
+  const sir_module_t* m;
+  uint8_t* func_defined; // by fid, for m
+  uint32_t func_defined_len;
+  bool op_defined[SIR_INST_KIND_COUNT];
+  const char** callees; // open addressing by pointer; index + 1 is the id
+  uint32_t callee_cap;
+  uint32_t callee_count;
+  uint32_t* callee_ids;
+};
+
+static void tb_pause(void) {
+  const struct timespec ts = {.tv_sec = 0, .tv_nsec = 50000};
+  (void)nanosleep(&ts, NULL);
+}
+
+static void* tb_writer_main(void* arg) {
+  sem_tbin_writer_t* w = (sem_tbin_writer_t*)arg;
+  for (;;) {
+    const size_t head = atomic_load_explicit(&w->head, memory_order_acquire);
+    const size_t tail = atomic_load_explicit(&w->tail, memory_order_relaxed);
+    if (head == tail) {
+      if (atomic_load_explicit(&w->closing, memory_order_acquire) && atomic_load_explicit(&w->head, memory_order_acquire) == tail) break;
+      tb_pause();
+      continue;
+    }
+    const size_t at = tail & (TB_RING_BYTES - 1u);
+    size_t n = head - tail;
+    if (n > TB_RING_BYTES - at) n = TB_RING_BYTES - at;
+    if (!w->io_error && fwrite(w->ring + at, 1, n, w->f) != n) w->io_error = true;
+    atomic_store_explicit(&w->tail, tail + n, memory_order_release);
+  }
+  return NULL;
+}
+
+static void tb_ring_put(sem_tbin_writer_t* w, const uint8_t* src, size_t n) {
+  if (!w->threaded) {
+    if (fwrite(src, 1, n, w->f) != n) w->io_error = true;
+    return;
+  }
+  while (n) {
+    const size_t head = atomic_load_explicit(&w->head, memory_order_relaxed);
+    const size_t used = head - atomic_load_explicit(&w->tail, memory_order_acquire);
+    size_t room = TB_RING_BYTES - used;
+    if (room == 0) {
+      // The writer is behind; tracing slows down rather than dropping events.
+      sched_yield();
+      continue;
+    }
+    const size_t at = head & (TB_RING_BYTES - 1u);
+    if (room > TB_RING_BYTES - at) room = TB_RING_BYTES - at;
+    if (room > n) room = n;
+    memcpy(w->ring + at, src, room);
+    atomic_store_explicit(&w->head, head + room, memory_order_release);
+    src += room;
+    n -= room;
+  }
+}
+
+static void tb_flush(sem_tbin_writer_t* w) {
+  if (!w->stage_len) return;
+  tb_ring_put(w, w->stage, w->stage_len);
+  w->stage_len = 0;
+}
+
+static uint8_t* tb_reserve(sem_tbin_writer_t* w, uint32_t n) {
+  if (w->stage_len + n > TB_STAGE_BYTES) tb_flush(w);
+  return w->stage + w->stage_len;
+}
+
+static void tb_commit(sem_tbin_writer_t* w, const uint8_t* end) {
+  w->stage_len = (uint32_t)(end - w->stage);
+}
+
+static uint8_t* tb_put_varint(uint8_t* p, uint64_t v) {
+  while (v >= 0x80u) {
+    *p++ = (uint8_t)(v | 0x80u);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+static uint64_t tb_zigzag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static void tb_varint(sem_tbin_writer_t* w, uint64_t v) {
+  tb_commit(w, tb_put_varint(tb_reserve(w, 10), v));
+}
+
+static void tb_name(sem_tbin_writer_t* w, const char* s) {
+  const size_t n = s ? strlen(s) : 0;
+  tb_varint(w, n);
+  for (size_t off = 0; off < n;) {
+    size_t chunk = n - off;
+    if (chunk > TB_STAGE_BYTES / 2u) chunk = TB_STAGE_BYTES / 2u;
+    memcpy(tb_reserve(w, (uint32_t)chunk), s + off, chunk);
+    w->stage_len += (uint32_t)chunk;
+    off += chunk;
+  }
+}
+
+sem_tbin_writer_t* sem_tbin_writer_open(const char* path) {
+  if (!path) return NULL;
+  sem_tbin_writer_t* w = (sem_tbin_writer_t*)calloc(1, sizeof(*w));
+  if (!w) return NULL;
+  w->f = fopen(path, "wb");
+  w->ring = (uint8_t*)malloc(TB_RING_BYTES);
+  if (!w->f || !w->ring) {
+    if (w->f) fclose(w->f);
+    free(w->ring);
+    free(w);
+    return NULL;
+  }
+  atomic_init(&w->head, 0);
+  atomic_init(&w->tail, 0);
+  atomic_init(&w->closing, false);
+  // Without a thread the trace is still written, just synchronously.
+  w->threaded = pthread_create(&w->thread, NULL, tb_writer_main, w) == 0;
+
+  memcpy(tb_reserve(w, sizeof(tb_magic)), tb_magic, sizeof(tb_magic));
+  w->stage_len += (uint32_t)sizeof(tb_magic);
+  tb_varint(w, SEM_TRACE_BIN_VERSION);
+  return w;
+}
+
+bool sem_tbin_writer_close(sem_tbin_writer_t* w) {
+  if (!w) return false;
+  tb_flush(w);
+  if (w->threaded) {
+    atomic_store_explicit(&w->closing, true, memory_order_release);
+    (void)pthread_join(w->thread, NULL);
+  }
+  bool ok = !w->io_error;
+  if (fclose(w->f) != 0) ok = false;
+  free(w->ring);
+  free(w->func_defined);
+  free(w->callees);
+  free(w->callee_ids);
+  free(w);
+  return ok;
+}
+
+// Emits the definition of fid the first time it shows up.
+static void tb_define_func(sem_tbin_writer_t* w, const sir_module_t* m, sir_func_id_t fid) {
+  if (!m || fid == 0 || fid > m->func_count) return;
+  if (m != w->m) {
+    free(w->func_defined);
+    w->func_defined = (uint8_t*)calloc((size_t)m->func_count + 1u, 1);
+    w->func_defined_len = w->func_defined ? m->func_count + 1u : 0;
+    w->m = m;
+  }
+  if (fid >= w->func_defined_len || w->func_defined[fid]) return;
+  w->func_defined[fid] = 1;
+
+  const sir_func_t* f = &m->funcs[fid - 1];
+  *tb_reserve(w, 1) = TB_FUNC;
+  w->stage_len++;
+  tb_varint(w, fid);
+  tb_name(w, f->name);
+  tb_varint(w, f->inst_count);
+  uint32_t node = 0, line = 0;
+  for (uint32_t i = 0; i < f->inst_count; i++) {
+    uint8_t* p = tb_reserve(w, 20);
+    p = tb_put_varint(p, tb_zigzag((int64_t)f->insts[i].src_node_id - (int64_t)node));
+    p = tb_put_varint(p, tb_zigzag((int64_t)f->insts[i].src_line - (int64_t)line));
+    tb_commit(w, p);
+    node = f->insts[i].src_node_id;
+    line = f->insts[i].src_line;
+  }
+}
+
+static void tb_define_op(sem_tbin_writer_t* w, sir_inst_kind_t k) {
+  if ((uint32_t)k < SIR_INST_KIND_COUNT) {
+    if (w->op_defined[k]) return;
+    w->op_defined[k] = true;
+  }
+  *tb_reserve(w, 1) = TB_OP;
+  w->stage_len++;
+  tb_varint(w, (uint64_t)k);
+  tb_name(w, sir_inst_kind_name(k));
+}
+
+static uint32_t tb_callee_id(sem_tbin_writer_t* w, const char* callee) {
+  if (!callee) callee = "";
+  if (w->callee_count * 2u >= w->callee_cap) {
+    const uint32_t cap = w->callee_cap ? w->callee_cap * 2u : 64u;
+    const char** keys = (const char**)calloc(cap, sizeof(*keys));
+    uint32_t* ids = (uint32_t*)calloc(cap, sizeof(*ids));
+    if (!keys || !ids) {
+      free(keys);
+      free(ids);
+      return 0;
+    }
+    for (uint32_t i = 0; i < w->callee_cap; i++) {
+      if (!w->callees[i]) continue;
+      uint32_t h = (uint32_t)(((uintptr_t)w->callees[i] >> 3) * 0x9E3779B1u) & (cap - 1u);
+      while (keys[h]) h = (h + 1u) & (cap - 1u);
+      keys[h] = w->callees[i];
+      ids[h] = w->callee_ids[i];
+    }
+    free(w->callees);
+    free(w->callee_ids);
+    w->callees = keys;
+    w->callee_ids = ids;
+    w->callee_cap = cap;
+  }
+  uint32_t h = (uint32_t)(((uintptr_t)callee >> 3) * 0x9E3779B1u) & (w->callee_cap - 1u);
+  while (w->callees[h]) {
+    if (w->callees[h] == callee) return w->callee_ids[h];
+    h = (h + 1u) & (w->callee_cap - 1u);
+  }
+  w->callees[h] = callee;
+  w->callee_ids[h] = ++w->callee_count;
+  *tb_reserve(w, 1) = TB_CALLEE;
+  w->stage_len++;
+  tb_varint(w, w->callee_count);
+  tb_name(w, callee);
+  return w->callee_count;
+}
+
+// Writes the record tag and position; the tag's low bit says fid follows.
+static uint8_t* tb_put_pos(sem_tbin_writer_t* w, uint8_t* p, uint8_t tag, sir_func_id_t fid, uint32_t ip) {
+  if (fid == w->fid) {
+    *p++ = tag;
+  } else {
+    *p++ = (uint8_t)(tag | 1u);
+    p = tb_put_varint(p, fid);
+    w->fid = fid;
+  }
+  p = tb_put_varint(p, tb_zigzag((int64_t)ip - (int64_t)w->ip));
+  w->ip = ip;
+  return p;
+}
+
+void sem_tbin_step(sem_tbin_writer_t* w, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_inst_kind_t k) {
+  if (!w) return;
+  tb_define_func(w, m, fid);
+  if ((uint32_t)k >= SIR_INST_KIND_COUNT || !w->op_defined[k]) tb_define_op(w, k);
+  uint8_t* p = tb_put_pos(w, tb_reserve(w, TB_EVENT_MAX), TB_STEP, fid, ip);
+  tb_commit(w, tb_put_varint(p, (uint64_t)k));
+}
+
+void sem_tbin_mem(sem_tbin_writer_t* w, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_mem_event_kind_t k, zi_ptr_t addr,
+                  uint32_t size) {
+  if (!w) return;
+  tb_define_func(w, m, fid);
+  uint8_t* p = tb_put_pos(w, tb_reserve(w, TB_EVENT_MAX), TB_MEM, fid, ip);
+  *p++ = (k == SIR_MEM_WRITE) ? 1u : 0u;
+  p = tb_put_varint(p, tb_zigzag((int64_t)((uint64_t)addr - w->addr)));
+  w->addr = (uint64_t)addr;
+  tb_commit(w, tb_put_varint(p, size));
+}
+
+void sem_tbin_hostcall(sem_tbin_writer_t* w, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, const char* callee, int32_t rc) {
+  if (!w) return;
+  tb_define_func(w, m, fid);
+  const uint32_t id = tb_callee_id(w, callee);
+  uint8_t* p = tb_put_pos(w, tb_reserve(w, TB_EVENT_MAX), TB_HOST, fid, ip);
+  p = tb_put_varint(p, id);
+  tb_commit(w, tb_put_varint(p, tb_zigzag(rc)));
+}
+
+// ---- converter ----
+
+typedef struct tb_reader {
+  FILE* f;
+  bool bad;
+} tb_reader_t;
+
+static uint64_t tb_get_varint(tb_reader_t* r) {
+  uint64_t v = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7) {
+    const int ch = fgetc(r->f);
+    if (ch == EOF) break;
+    v |= (uint64_t)(ch & 0x7f) << shift;
+    if ((ch & 0x80) == 0) return v;
+  }
+  r->bad = true;
+  return 0;
+}
+
+static int64_t tb_get_zigzag(tb_reader_t* r) {
+  const uint64_t v = tb_get_varint(r);
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1u);
+}
+
+static char* tb_get_name(tb_reader_t* r) {
+  const uint64_t n = tb_get_varint(r);
+  if (r->bad || n > (1u << 24)) {
+    r->bad = true;
+    return NULL;
+  }
+  char* s = (char*)malloc((size_t)n + 1u);
+  if (!s || fread(s, 1, (size_t)n, r->f) != (size_t)n) {
+    free(s);
+    r->bad = true;
+    return NULL;
+  }
+  s[n] = '\0';
+  return s;
+}
+
+typedef struct tb_func {
+  char* name;
+  uint32_t inst_count;
+  uint32_t* node;
+  uint32_t* line;
+} tb_func_t;
+
+// A grow-on-demand table of names by id.
+typedef struct tb_names {
+  char** v;
+  uint32_t len;
+} tb_names_t;
+
+static bool tb_names_set(tb_names_t* t, uint64_t id, char* s) {
+  if (id > (1u << 24)) return false;
+  if (id >= t->len) {
+    const uint32_t len = (uint32_t)id + 64u;
+    char** v = (char**)realloc(t->v, (size_t)len * sizeof(*v));
+    if (!v) return false;
+    memset(v + t->len, 0, (size_t)(len - t->len) * sizeof(*v));
+    t->v = v;
+    t->len = len;
+  }
+  free(t->v[id]);
+  t->v[id] = s;
+  return true;
+}
+
+static const char* tb_names_get(const tb_names_t* t, uint64_t id) {
+  return (id < t->len && t->v[id]) ? t->v[id] : "";
+}
+
+static void tb_names_free(tb_names_t* t) {
+  for (uint32_t i = 0; i < t->len; i++) free(t->v[i]);
+  free(t->v);
+}
+
+static void tb_write_escaped(FILE* out, const char* s) {
+  for (const unsigned char* p = (const unsigned char*)s; *p; p++) {
+    const unsigned char ch = *p;
+    if (ch == '\\' || ch == '"') {
+      fputc('\\', out);
+      fputc((int)ch, out);
+    } else if (ch == '\n') {
+      fputs("\\n", out);
+    } else if (ch == '\r') {
+      fputs("\\r", out);
+    } else if (ch == '\t') {
+      fputs("\\t", out);
+    } else if (ch < 0x20) {
+      fprintf(out, "\\u%04x", (unsigned)ch);
+    } else {
+      fputc((int)ch, out);
+    }
+  }
+}
+
+static void tb_write_head(FILE* out, const char* k, uint32_t fid, const tb_func_t* f, uint32_t ip) {
+  fprintf(out, "{\"tool\":\"sem\",\"k\":\"%s\",\"fid\":%u,\"func\":\"", k, (unsigned)fid);
+  tb_write_escaped(out, (f && f->name) ? f->name : "");
+  fprintf(out, "\",\"ip\":%u", (unsigned)ip);
+}
+
+static void tb_write_src(FILE* out, const tb_func_t* f, uint32_t ip) {
+  if (!f || ip >= f->inst_count) return;
+  if (!f->node[ip] && !f->line[ip]) return;
+  fprintf(out, ",\"node\":%u,\"line\":%u", (unsigned)f->node[ip], (unsigned)f->line[ip]);
+}
+
+bool sem_tbin_to_jsonl(const char* in_path, FILE* out) {
+  if (!in_path || !out) return false;
+  tb_reader_t r = {.f = fopen(in_path, "rb")};
+  if (!r.f) return false;
+  char magic[sizeof(tb_magic)];
+  if (fread(magic, 1, sizeof(magic), r.f) != sizeof(magic) || memcmp(magic, tb_magic, sizeof(magic)) != 0 ||
+      tb_get_varint(&r) != SEM_TRACE_BIN_VERSION) {
+    fclose(r.f);
+    return false;
+  }
+
+  tb_func_t* funcs = NULL;
+  uint32_t func_len = 0;
+  tb_names_t ops = {0};
+  tb_names_t callees = {0};
+  uint32_t fid = 0, ip = 0;
+  uint64_t addr = 0;
+
+  int tag;
+  while (!r.bad && (tag = fgetc(r.f)) != EOF) {
+    switch (tag) {
+      case TB_FUNC: {
+        const uint64_t id = tb_get_varint(&r);
+        char* name = tb_get_name(&r);
+        const uint64_t n = tb_get_varint(&r);
+        if (r.bad || id == 0 || id > (1u << 24) || n > (1u << 28)) {
+          free(name);
+          r.bad = true;
+          break;
+        }
+        if (id >= func_len) {
+          const uint32_t len = (uint32_t)id + 64u;
+          tb_func_t* v = (tb_func_t*)realloc(funcs, (size_t)len * sizeof(*v));
+          if (!v) {
+            free(name);
+            r.bad = true;
+            break;
+          }
+          memset(v + func_len, 0, (size_t)(len - func_len) * sizeof(*v));
+          funcs = v;
+          func_len = len;
+        }
+        tb_func_t* f = &funcs[id];
+        free(f->name);
+        free(f->node);
+        free(f->line);
+        f->name = name;
+        f->inst_count = (uint32_t)n;
+        f->node = (uint32_t*)calloc(n ? (size_t)n : 1u, sizeof(uint32_t));
+        f->line = (uint32_t*)calloc(n ? (size_t)n : 1u, sizeof(uint32_t));
+        if (!f->node || !f->line) {
+          f->inst_count = 0;
+          r.bad = true;
+          break;
+        }
+        int64_t node = 0, line = 0;
+        for (uint32_t i = 0; i < f->inst_count && !r.bad; i++) {
+          node += tb_get_zigzag(&r);
+          line += tb_get_zigzag(&r);
+          f->node[i] = (uint32_t)node;
+          f->line[i] = (uint32_t)line;
+        }
+        break;
+      }
+      case TB_OP:
+      case TB_CALLEE: {
+        const uint64_t id = tb_get_varint(&r);
+        char* name = tb_get_name(&r);
+        if (r.bad || !tb_names_set(tag == TB_OP ? &ops : &callees, id, name)) {
+          free(name);
+          r.bad = true;
+        }
+        break;
+      }
+      case TB_STEP:
+      case TB_STEP_FID:
+      case TB_MEM:
+      case TB_MEM_FID:
+      case TB_HOST:
+      case TB_HOST_FID: {
+        if (tag & 1) fid = (uint32_t)tb_get_varint(&r);
+        ip = (uint32_t)((int64_t)ip + tb_get_zigzag(&r));
+        const tb_func_t* f = (fid < func_len && funcs[fid].name) ? &funcs[fid] : NULL;
+        if ((tag & ~1) == TB_STEP) {
+          const uint64_t k = tb_get_varint(&r);
+          if (r.bad) break;
+          tb_write_head(out, "trace_step", fid, f, ip);
+          fprintf(out, ",\"op\":\"%s\"", tb_names_get(&ops, k));
+        } else if ((tag & ~1) == TB_MEM) {
+          const int kind = fgetc(r.f);
+          addr += (uint64_t)tb_get_zigzag(&r);
+          const uint64_t size = tb_get_varint(&r);
+          if (r.bad || kind == EOF) {
+            r.bad = true;
+            break;
+          }
+          tb_write_head(out, "trace_mem", fid, f, ip);
+          fprintf(out, ",\"kind\":\"%s\",\"addr\":%" PRIu64 ",\"size\":%u", kind == 1 ? "w" : "r", addr, (unsigned)size);
+        } else {
+          const uint64_t id = tb_get_varint(&r);
+          const int64_t rc = tb_get_zigzag(&r);
+          if (r.bad) break;
+          tb_write_head(out, "trace_hostcall", fid, f, ip);
+          fprintf(out, ",\"callee\":\"");
+          tb_write_escaped(out, tb_names_get(&callees, id));
+          fprintf(out, "\",\"rc\":%d", (int)rc);
+        }
+        tb_write_src(out, f, ip);
+        fprintf(out, "}\n");
+        break;
+      }
+      default:
+        r.bad = true;
+        break;
+    }
+  }
+
+  const bool ok = !r.bad && !ferror(r.f);
+  fclose(r.f);
+  for (uint32_t i = 0; i < func_len; i++) {
+    free(funcs[i].name);
+    free(funcs[i].node);
+    free(funcs[i].line);
+  }
+  free(funcs);
+  tb_names_free(&ops);
+  tb_names_free(&callees);
+  return ok;
+}
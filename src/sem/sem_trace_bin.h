@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sir_module.h"
+
+// Binary execution trace (`sem --run --trace-bin-out PATH`).
+//
+// Events are encoded on the VM thread into a few bytes each (varint deltas;
+// function, op and callee names are defined once and then referred to by
+// id) and handed to a background thread through a lock-free ring. The
+// trace converts offline into the `--trace-jsonl-out` records.
+//
+// Stream: "SEMTRACE", varint version, then tagged records. Integers are
+// LEB128 varints; signed deltas are zigzag-encoded. The ip and addr
+// deltas are relative to the previous event of any kind.
+//   0x01 func    fid, name, inst count, per inst: node delta, line delta
+//   0x02 op      kind, name
+//   0x03 callee  id, name
+//   0x10 step    ip delta, kind            (same fid as the previous event)
+//   0x11 step    fid, ip delta, kind
+//   0x20 mem     ip delta, r/w, addr delta, size
+//   0x21 mem     fid, ip delta, r/w, addr delta, size
+//   0x30 host    ip delta, callee id, rc
+//   0x31 host    fid, ip delta, callee id, rc
+// Names are a varint length followed by the bytes.
+
+#define SEM_TRACE_BIN_VERSION 1u
+
+typedef struct sem_tbin_writer sem_tbin_writer_t;
+
+// Creates path and starts the writer thread. Returns NULL if path cannot be
+// opened.
+sem_tbin_writer_t* sem_tbin_writer_open(const char* path);
+
+// Drains everything recorded, stops the writer and closes the file.
+// Returns false if any write failed.
+bool sem_tbin_writer_close(sem_tbin_writer_t* w);
+
+// Event recorders; call from the thread running the module. Callee names are
+// interned by address, so they must stay put until close (module-owned names do).
+void sem_tbin_step(sem_tbin_writer_t* w, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_inst_kind_t k);
+void sem_tbin_mem(sem_tbin_writer_t* w, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_mem_event_kind_t k, zi_ptr_t addr,
+                  uint32_t size);
+void sem_tbin_hostcall(sem_tbin_writer_t* w, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, const char* callee, int32_t rc);
+
+// Writes the binary trace at in_path to out as trace_step/trace_mem/
+// trace_hostcall JSONL records. Returns false on a bad or truncated trace
+// (records before the damage are still written).
+bool sem_tbin_to_jsonl(const char* in_path, FILE* out);
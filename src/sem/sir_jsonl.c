@@ -1,6 +1,12 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // mmap/madvise under -std=c11
+#endif
+
 #include "sir_jsonl.h"
 
 #include "sem_hosted.h"
+#include "sem_profile.h"
+#include "sem_trace_bin.h"
 #include "sir_module.h"
 
 #include "json.h"
@@ -13,8 +19,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// parse_file maps its input and may parse large files on worker threads.
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SIRJ_LOAD_MMAP 1
+#endif
+
 typedef struct type_info {
   bool present;
   bool is_fn;
@@ -117,6 +139,9 @@ typedef struct sirj_idmap {
 
 typedef struct sirj_ctx {
   Arena arena;
+  // Worker arenas from a parallel parse_file; they own those records' DOMs.
+  Arena* parse_arenas;
+  uint32_t parse_arena_count;
 
   // Global id interning for record ids and {"t":"ref","id":...} payloads.
   // SIR ids are per-kind, but refs do not always carry an explicit kind; interning globally
@@ -321,6 +346,17 @@ static void sem_json_write_escaped(FILE* out, const char* s) {
   }
 }
 
+// Diagnostics stream of the calling thread (stderr unless redirected).
+static _Thread_local FILE* sem_diag_stream = NULL;
+
+static FILE* sem_diag_out(void) {
+  return sem_diag_stream ? sem_diag_stream : stderr;
+}
+
+void sem_set_diag_out(FILE* f) {
+  sem_diag_stream = f;
+}
+
 static void sem_print_one_diag(sem_diag_format_t fmt, const char* code, const char* msg, const char* path, uint32_t line, uint32_t node,
                                const char* tag, uint32_t fid, uint32_t ip, const char* op) {
   if (!code) code = "sem.error";
@@ -328,48 +364,49 @@ static void sem_print_one_diag(sem_diag_format_t fmt, const char* code, const ch
   if (!path) path = "";
   if (!tag) tag = "";
   if (!op) op = "";
+  FILE* out = sem_diag_out();
 
   if (fmt == SEM_DIAG_JSON) {
-    fprintf(stderr, "{\"tool\":\"sem\",\"code\":\"");
-    sem_json_write_escaped(stderr, code);
-    fprintf(stderr, "\",\"message\":\"");
-    sem_json_write_escaped(stderr, msg);
-    fprintf(stderr, "\"");
+    fprintf(out, "{\"tool\":\"sem\",\"code\":\"");
+    sem_json_write_escaped(out, code);
+    fprintf(out, "\",\"message\":\"");
+    sem_json_write_escaped(out, msg);
+    fprintf(out, "\"");
     if (path[0]) {
-      fprintf(stderr, ",\"path\":\"");
-      sem_json_write_escaped(stderr, path);
-      fprintf(stderr, "\"");
-    }
-    if (line) fprintf(stderr, ",\"line\":%u", (unsigned)line);
-    if (node) fprintf(stderr, ",\"node\":%u", (unsigned)node);
-    if (fid) fprintf(stderr, ",\"fid\":%u", (unsigned)fid);
-    if (fid) fprintf(stderr, ",\"ip\":%u", (unsigned)ip);
+      fprintf(out, ",\"path\":\"");
+      sem_json_write_escaped(out, path);
+      fprintf(out, "\"");
+    }
+    if (line) fprintf(out, ",\"line\":%u", (unsigned)line);
+    if (node) fprintf(out, ",\"node\":%u", (unsigned)node);
+    if (fid) fprintf(out, ",\"fid\":%u", (unsigned)fid);
+    if (fid) fprintf(out, ",\"ip\":%u", (unsigned)ip);
     if (op[0]) {
-      fprintf(stderr, ",\"op\":\"");
-      sem_json_write_escaped(stderr, op);
-      fprintf(stderr, "\"");
+      fprintf(out, ",\"op\":\"");
+      sem_json_write_escaped(out, op);
+      fprintf(out, "\"");
     }
     if (tag[0]) {
-      fprintf(stderr, ",\"tag\":\"");
-      sem_json_write_escaped(stderr, tag);
-      fprintf(stderr, "\"");
+      fprintf(out, ",\"tag\":\"");
+      sem_json_write_escaped(out, tag);
+      fprintf(out, "\"");
     }
-    fprintf(stderr, "}\n");
+    fprintf(out, "}\n");
     return;
   }
 
   if (path[0] && line) {
-    fprintf(stderr, "sem: %s: %s (%s:%u)\n", code, msg, path, (unsigned)line);
+    fprintf(out, "sem: %s: %s (%s:%u)\n", code, msg, path, (unsigned)line);
   } else if (path[0]) {
-    fprintf(stderr, "sem: %s: %s (%s)\n", code, msg, path);
+    fprintf(out, "sem: %s: %s (%s)\n", code, msg, path);
   } else {
-    fprintf(stderr, "sem: %s: %s\n", code, msg);
+    fprintf(out, "sem: %s: %s\n", code, msg);
   }
   if (node || tag[0]) {
-    fprintf(stderr, "sem:   at node=%u tag=%s\n", (unsigned)node, tag);
+    fprintf(out, "sem:   at node=%u tag=%s\n", (unsigned)node, tag);
   }
   if (fid) {
-    fprintf(stderr, "sem:   at fid=%u ip=%u op=%s\n", (unsigned)fid, (unsigned)ip, op[0] ? op : "?");
+    fprintf(out, "sem:   at fid=%u ip=%u op=%s\n", (unsigned)fid, (unsigned)ip, op[0] ? op : "?");
   }
 }
 
@@ -446,6 +483,8 @@ static void ctx_dispose(sirj_ctx_t* c) {
   free(c->val_by_node);
   free(c->kind_by_node);
   free(c->func_by_node);
+  for (uint32_t i = 0; i < c->parse_arena_count; i++) arena_free(&c->parse_arenas[i]);
+  free(c->parse_arenas);
   arena_free(&c->arena);
   memset(c, 0, sizeof(*c));
 }
@@ -542,6 +581,16 @@ static bool sirj_ids_grow(sirj_idmap_t* m) {
   return true;
 }
 
+// Grows m so that n more ids intern without a rehash.
+static bool sirj_ids_reserve(sirj_idmap_t* m, uint32_t n) {
+  if (!m) return false;
+  const uint64_t want = (uint64_t)m->len + n + 1u;
+  while (want * 10u >= (uint64_t)m->cap * 7u) {
+    if (m->cap > UINT32_MAX / 2u || !sirj_ids_grow(m)) return false;
+  }
+  return true;
+}
+
 static bool sirj_ids_raw_ensure(sirj_idmap_t* m, uint32_t need_id_inclusive) {
   if (!m) return false;
   // need_id_inclusive is the maximum interned id we need to store (>=1).
@@ -3073,15 +3122,23 @@ static bool eval_vec_splat(sirj_ctx_t* c, uint32_t node_id, const node_info_t* n
   sir_mb_set_src(c->mb, node_id, n->loc_line);
   if (!sir_mb_emit_alloca(c->mb, c->fn, vec_ptr, vec_size, vec_align ? vec_align : 1)) return false;
 
-  for (uint32_t i = 0; i < lanes; i++) {
-    const sir_val_id_t idx = alloc_slot(c, VK_I32);
-    if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
-    sir_val_id_t lane_ptr = 0;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, vec_ptr, idx, lane_size, &lane_ptr)) return false;
-    if (lane_k == VK_I32) {
-      if (!sir_mb_emit_store_i32(c->mb, c->fn, lane_ptr, x_slot, lane_align ? lane_align : 4)) return false;
-    } else {
-      if (!emit_vec_store_lane_bool_as_i8(c, node_id, n->loc_line, lane_ptr, lane_align ? lane_align : 1, x_slot)) return false;
+  // One vector instruction when the lanes have the layout sircore's vec ops
+  // expect; otherwise lower lane by lane.
+  if (lane_k == VK_I32 && lane_size == 4) {
+    if (!sir_mb_emit_vec_splat_i32(c->mb, c->fn, vec_ptr, x_slot, lanes)) return false;
+  } else if (lane_k == VK_BOOL && lane_size == 1) {
+    if (!sir_mb_emit_vec_splat_bool(c->mb, c->fn, vec_ptr, x_slot, lanes)) return false;
+  } else {
+    for (uint32_t i = 0; i < lanes; i++) {
+      const sir_val_id_t idx = alloc_slot(c, VK_I32);
+      if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
+      sir_val_id_t lane_ptr = 0;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, vec_ptr, idx, lane_size, &lane_ptr)) return false;
+      if (lane_k == VK_I32) {
+        if (!sir_mb_emit_store_i32(c->mb, c->fn, lane_ptr, x_slot, lane_align ? lane_align : 4)) return false;
+      } else {
+        if (!emit_vec_store_lane_bool_as_i8(c, node_id, n->loc_line, lane_ptr, lane_align ? lane_align : 1, x_slot)) return false;
+      }
     }
   }
   sir_mb_clear_src(c->mb);
@@ -3121,20 +3178,24 @@ static bool eval_vec_add_i32(sirj_ctx_t* c, uint32_t node_id, const node_info_t*
   sir_mb_set_src(c->mb, node_id, n->loc_line);
   if (!sir_mb_emit_alloca(c->mb, c->fn, out_ptr, vec_size, vec_align ? vec_align : 1)) return false;
 
-  for (uint32_t i = 0; i < lanes; i++) {
-    const sir_val_id_t idx = alloc_slot(c, VK_I32);
-    if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
-    sir_val_id_t ap = 0, bp = 0, op = 0;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, lane_size, &ap)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, lane_size, &bp)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
-    const sir_val_id_t av = alloc_slot(c, VK_I32);
-    const sir_val_id_t bv = alloc_slot(c, VK_I32);
-    const sir_val_id_t rv = alloc_slot(c, VK_I32);
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, lane_align ? lane_align : 4)) return false;
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, lane_align ? lane_align : 4)) return false;
-    if (!sir_mb_emit_i32_add(c->mb, c->fn, rv, av, bv)) return false;
-    if (!sir_mb_emit_store_i32(c->mb, c->fn, op, rv, lane_align ? lane_align : 4)) return false;
+  if (lane_size == 4) {
+    if (!sir_mb_emit_vec_i32_add(c->mb, c->fn, out_ptr, a_slot, b_slot, lanes)) return false;
+  } else {
+    for (uint32_t i = 0; i < lanes; i++) {
+      const sir_val_id_t idx = alloc_slot(c, VK_I32);
+      if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
+      sir_val_id_t ap = 0, bp = 0, op = 0;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, lane_size, &ap)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, lane_size, &bp)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
+      const sir_val_id_t av = alloc_slot(c, VK_I32);
+      const sir_val_id_t bv = alloc_slot(c, VK_I32);
+      const sir_val_id_t rv = alloc_slot(c, VK_I32);
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, lane_align ? lane_align : 4)) return false;
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, lane_align ? lane_align : 4)) return false;
+      if (!sir_mb_emit_i32_add(c->mb, c->fn, rv, av, bv)) return false;
+      if (!sir_mb_emit_store_i32(c->mb, c->fn, op, rv, lane_align ? lane_align : 4)) return false;
+    }
   }
   sir_mb_clear_src(c->mb);
 
@@ -3319,20 +3380,24 @@ static bool eval_vec_cmp_eq_i32(sirj_ctx_t* c, uint32_t node_id, const node_info
   sir_mb_set_src(c->mb, node_id, n->loc_line);
   if (!sir_mb_emit_alloca(c->mb, c->fn, out_ptr, vec_size, vec_align ? vec_align : 1)) return false;
 
-  for (uint32_t i = 0; i < lanes; i++) {
-    const sir_val_id_t idx = alloc_slot(c, VK_I32);
-    if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
-    sir_val_id_t ap = 0, bp = 0, op = 0;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, a_lane_size, &ap)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, b_lane_size, &bp)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
-    const sir_val_id_t av = alloc_slot(c, VK_I32);
-    const sir_val_id_t bv = alloc_slot(c, VK_I32);
-    const sir_val_id_t eq = alloc_slot(c, VK_BOOL);
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, a_lane_align ? a_lane_align : 4)) return false;
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, b_lane_align ? b_lane_align : 4)) return false;
-    if (!sir_mb_emit_i32_cmp_eq(c->mb, c->fn, eq, av, bv)) return false;
-    if (!emit_vec_store_lane_bool_as_i8(c, node_id, n->loc_line, op, lane_align ? lane_align : 1, eq)) return false;
+  if (a_lane_size == 4 && b_lane_size == 4 && lane_size == 1) {
+    if (!sir_mb_emit_vec_i32_cmp_eq(c->mb, c->fn, out_ptr, a_slot, b_slot, lanes)) return false;
+  } else {
+    for (uint32_t i = 0; i < lanes; i++) {
+      const sir_val_id_t idx = alloc_slot(c, VK_I32);
+      if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
+      sir_val_id_t ap = 0, bp = 0, op = 0;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, a_lane_size, &ap)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, b_lane_size, &bp)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
+      const sir_val_id_t av = alloc_slot(c, VK_I32);
+      const sir_val_id_t bv = alloc_slot(c, VK_I32);
+      const sir_val_id_t eq = alloc_slot(c, VK_BOOL);
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, a_lane_align ? a_lane_align : 4)) return false;
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, b_lane_align ? b_lane_align : 4)) return false;
+      if (!sir_mb_emit_i32_cmp_eq(c->mb, c->fn, eq, av, bv)) return false;
+      if (!emit_vec_store_lane_bool_as_i8(c, node_id, n->loc_line, op, lane_align ? lane_align : 1, eq)) return false;
+    }
   }
   sir_mb_clear_src(c->mb);
 
@@ -3385,20 +3450,24 @@ static bool eval_vec_cmp_lt_i32(sirj_ctx_t* c, uint32_t node_id, const node_info
   sir_mb_set_src(c->mb, node_id, n->loc_line);
   if (!sir_mb_emit_alloca(c->mb, c->fn, out_ptr, vec_size, vec_align ? vec_align : 1)) return false;
 
-  for (uint32_t i = 0; i < lanes; i++) {
-    const sir_val_id_t idx = alloc_slot(c, VK_I32);
-    if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
-    sir_val_id_t ap = 0, bp = 0, op = 0;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, a_lane_size, &ap)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, b_lane_size, &bp)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
-    const sir_val_id_t av = alloc_slot(c, VK_I32);
-    const sir_val_id_t bv = alloc_slot(c, VK_I32);
-    const sir_val_id_t lt = alloc_slot(c, VK_BOOL);
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, a_lane_align ? a_lane_align : 4)) return false;
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, b_lane_align ? b_lane_align : 4)) return false;
-    if (!sir_mb_emit_i32_cmp_slt(c->mb, c->fn, lt, av, bv)) return false;
-    if (!emit_vec_store_lane_bool_as_i8(c, node_id, n->loc_line, op, lane_align ? lane_align : 1, lt)) return false;
+  if (a_lane_size == 4 && b_lane_size == 4 && lane_size == 1) {
+    if (!sir_mb_emit_vec_i32_cmp_slt(c->mb, c->fn, out_ptr, a_slot, b_slot, lanes)) return false;
+  } else {
+    for (uint32_t i = 0; i < lanes; i++) {
+      const sir_val_id_t idx = alloc_slot(c, VK_I32);
+      if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
+      sir_val_id_t ap = 0, bp = 0, op = 0;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, a_lane_size, &ap)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, b_lane_size, &bp)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
+      const sir_val_id_t av = alloc_slot(c, VK_I32);
+      const sir_val_id_t bv = alloc_slot(c, VK_I32);
+      const sir_val_id_t lt = alloc_slot(c, VK_BOOL);
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, a_lane_align ? a_lane_align : 4)) return false;
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, b_lane_align ? b_lane_align : 4)) return false;
+      if (!sir_mb_emit_i32_cmp_slt(c->mb, c->fn, lt, av, bv)) return false;
+      if (!emit_vec_store_lane_bool_as_i8(c, node_id, n->loc_line, op, lane_align ? lane_align : 1, lt)) return false;
+    }
   }
   sir_mb_clear_src(c->mb);
 
@@ -3457,25 +3526,29 @@ static bool eval_vec_select_mask_i32(sirj_ctx_t* c, uint32_t node_id, const node
   sir_mb_set_src(c->mb, node_id, n->loc_line);
   if (!sir_mb_emit_alloca(c->mb, c->fn, out_ptr, vec_size, vec_align ? vec_align : 1)) return false;
 
-  for (uint32_t i = 0; i < lanes; i++) {
-    const sir_val_id_t idx = alloc_slot(c, VK_I32);
-    if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
-    sir_val_id_t mp = 0, ap = 0, bp = 0, op = 0;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, m_slot, idx, m_lane_size, &mp)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, a_lane_size, &ap)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, b_lane_size, &bp)) return false;
-    if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
-
-    sir_val_id_t cond = 0;
-    if (!emit_vec_load_lane_bool(c, node_id, n->loc_line, mp, m_lane_align ? m_lane_align : 1, &cond)) return false;
-
-    const sir_val_id_t av = alloc_slot(c, VK_I32);
-    const sir_val_id_t bv = alloc_slot(c, VK_I32);
-    const sir_val_id_t rv = alloc_slot(c, VK_I32);
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, a_lane_align ? a_lane_align : 4)) return false;
-    if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, b_lane_align ? b_lane_align : 4)) return false;
-    if (!sir_mb_emit_select(c->mb, c->fn, rv, cond, av, bv)) return false;
-    if (!sir_mb_emit_store_i32(c->mb, c->fn, op, rv, lane_align ? lane_align : 4)) return false;
+  if (m_lane_size == 1 && a_lane_size == 4 && b_lane_size == 4 && lane_size == 4) {
+    if (!sir_mb_emit_vec_select_i32(c->mb, c->fn, out_ptr, m_slot, a_slot, b_slot, lanes)) return false;
+  } else {
+    for (uint32_t i = 0; i < lanes; i++) {
+      const sir_val_id_t idx = alloc_slot(c, VK_I32);
+      if (!sir_mb_emit_const_i32(c->mb, c->fn, idx, (int32_t)i)) return false;
+      sir_val_id_t mp = 0, ap = 0, bp = 0, op = 0;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, m_slot, idx, m_lane_size, &mp)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, a_slot, idx, a_lane_size, &ap)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, b_slot, idx, b_lane_size, &bp)) return false;
+      if (!emit_vec_lane_ptr(c, node_id, n->loc_line, out_ptr, idx, lane_size, &op)) return false;
+
+      sir_val_id_t cond = 0;
+      if (!emit_vec_load_lane_bool(c, node_id, n->loc_line, mp, m_lane_align ? m_lane_align : 1, &cond)) return false;
+
+      const sir_val_id_t av = alloc_slot(c, VK_I32);
+      const sir_val_id_t bv = alloc_slot(c, VK_I32);
+      const sir_val_id_t rv = alloc_slot(c, VK_I32);
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, av, ap, a_lane_align ? a_lane_align : 4)) return false;
+      if (!sir_mb_emit_load_i32(c->mb, c->fn, bv, bp, b_lane_align ? b_lane_align : 4)) return false;
+      if (!sir_mb_emit_select(c->mb, c->fn, rv, cond, av, bv)) return false;
+      if (!sir_mb_emit_store_i32(c->mb, c->fn, op, rv, lane_align ? lane_align : 4)) return false;
+    }
   }
   sir_mb_clear_src(c->mb);
 
@@ -4118,6 +4191,328 @@ static bool eval_f64_cmp_olt(sirj_ctx_t* c, uint32_t node_id, const node_info_t*
   return true;
 }
 
+// i64/f32/f64 binary ops and compares: args [a, b] of kind ak, result of kind rk.
+static bool eval_num_bin_mnemonic(sirj_ctx_t* c, uint32_t node_id, const node_info_t* n, sir_inst_kind_t k, val_kind_t ak_want,
+                                  val_kind_t rk, sir_val_id_t* out_slot, val_kind_t* out_kind) {
+  if (!c || !n || !out_slot || !out_kind) return false;
+  if (!n->fields_obj || n->fields_obj->type != JSON_OBJECT) {
+    sirj_diag_setf(c, "sem.parse.num.bin.fields", c->cur_path, n->loc_line, node_id, n->tag, "%s missing/invalid fields object", n->tag);
+    return false;
+  }
+  const JsonValue* av = json_obj_get(n->fields_obj, "args");
+  if (!json_is_array(av) || av->v.arr.len != 2) {
+    sirj_diag_setf(c, "sem.parse.num.bin.args", c->cur_path, n->loc_line, node_id, n->tag, "%s args must be [a, b]", n->tag);
+    return false;
+  }
+  uint32_t a_id = 0, b_id = 0;
+  if (!parse_ref_id(c, av->v.arr.items[0], &a_id)) {
+    sirj_diag_setf(c, "sem.parse.num.bin.arg", c->cur_path, n->loc_line, node_id, n->tag, "%s arg 0 must be a ref", n->tag);
+    return false;
+  }
+  if (!parse_ref_id(c, av->v.arr.items[1], &b_id)) {
+    sirj_diag_setf(c, "sem.parse.num.bin.arg", c->cur_path, n->loc_line, node_id, n->tag, "%s arg 1 must be a ref", n->tag);
+    return false;
+  }
+  sir_val_id_t a_slot = 0, b_slot = 0;
+  val_kind_t ak = VK_INVALID, bk = VK_INVALID;
+  if (!eval_node(c, a_id, &a_slot, &ak)) return false;
+  if (!eval_node(c, b_id, &b_slot, &bk)) return false;
+  if (ak != ak_want || bk != ak_want) {
+    // Every mnemonic here is spelled <ty>.<op>, so the tag names the arg type.
+    sirj_diag_setf(c, "sem.num.bin.arg_type", c->cur_path, n->loc_line, node_id, n->tag, "%s args must be %.3s", n->tag, n->tag);
+    return false;
+  }
+  const sir_val_id_t dst = alloc_slot(c, rk);
+  bool ok = false;
+  sir_mb_set_src(c->mb, node_id, n->loc_line);
+  switch (k) {
+    case SIR_INST_I64_ADD:
+      ok = sir_mb_emit_i64_add(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_SUB:
+      ok = sir_mb_emit_i64_sub(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_MUL:
+      ok = sir_mb_emit_i64_mul(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_AND:
+      ok = sir_mb_emit_i64_and(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_OR:
+      ok = sir_mb_emit_i64_or(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_XOR:
+      ok = sir_mb_emit_i64_xor(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_SHL:
+      ok = sir_mb_emit_i64_shl(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_SHR_S:
+      ok = sir_mb_emit_i64_shr_s(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_SHR_U:
+      ok = sir_mb_emit_i64_shr_u(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_DIV_S_SAT:
+      ok = sir_mb_emit_i64_div_s_sat(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_DIV_S_TRAP:
+      ok = sir_mb_emit_i64_div_s_trap(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_DIV_U_SAT:
+      ok = sir_mb_emit_i64_div_u_sat(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_REM_S_SAT:
+      ok = sir_mb_emit_i64_rem_s_sat(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_REM_U_SAT:
+      ok = sir_mb_emit_i64_rem_u_sat(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_EQ:
+      ok = sir_mb_emit_i64_cmp_eq(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_NE:
+      ok = sir_mb_emit_i64_cmp_ne(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_SLT:
+      ok = sir_mb_emit_i64_cmp_slt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_SLE:
+      ok = sir_mb_emit_i64_cmp_sle(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_SGT:
+      ok = sir_mb_emit_i64_cmp_sgt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_SGE:
+      ok = sir_mb_emit_i64_cmp_sge(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_ULT:
+      ok = sir_mb_emit_i64_cmp_ult(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_ULE:
+      ok = sir_mb_emit_i64_cmp_ule(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_UGT:
+      ok = sir_mb_emit_i64_cmp_ugt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_I64_CMP_UGE:
+      ok = sir_mb_emit_i64_cmp_uge(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_ADD:
+      ok = sir_mb_emit_f32_add(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_SUB:
+      ok = sir_mb_emit_f32_sub(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_MUL:
+      ok = sir_mb_emit_f32_mul(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_DIV:
+      ok = sir_mb_emit_f32_div(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_ADD:
+      ok = sir_mb_emit_f64_add(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_SUB:
+      ok = sir_mb_emit_f64_sub(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_MUL:
+      ok = sir_mb_emit_f64_mul(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_DIV:
+      ok = sir_mb_emit_f64_div(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_OEQ:
+      ok = sir_mb_emit_f32_cmp_oeq(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_ONE:
+      ok = sir_mb_emit_f32_cmp_one(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_OLT:
+      ok = sir_mb_emit_f32_cmp_olt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_OLE:
+      ok = sir_mb_emit_f32_cmp_ole(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_OGT:
+      ok = sir_mb_emit_f32_cmp_ogt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_OGE:
+      ok = sir_mb_emit_f32_cmp_oge(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_UEQ:
+      ok = sir_mb_emit_f32_cmp_ueq(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_UNE:
+      ok = sir_mb_emit_f32_cmp_une(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_ULT:
+      ok = sir_mb_emit_f32_cmp_ult(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_ULE:
+      ok = sir_mb_emit_f32_cmp_ule(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_UGT:
+      ok = sir_mb_emit_f32_cmp_ugt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F32_CMP_UGE:
+      ok = sir_mb_emit_f32_cmp_uge(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_OEQ:
+      ok = sir_mb_emit_f64_cmp_oeq(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_ONE:
+      ok = sir_mb_emit_f64_cmp_one(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_OLT:
+      ok = sir_mb_emit_f64_cmp_olt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_OLE:
+      ok = sir_mb_emit_f64_cmp_ole(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_OGT:
+      ok = sir_mb_emit_f64_cmp_ogt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_OGE:
+      ok = sir_mb_emit_f64_cmp_oge(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_UEQ:
+      ok = sir_mb_emit_f64_cmp_ueq(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_UNE:
+      ok = sir_mb_emit_f64_cmp_une(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_ULT:
+      ok = sir_mb_emit_f64_cmp_ult(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_ULE:
+      ok = sir_mb_emit_f64_cmp_ule(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_UGT:
+      ok = sir_mb_emit_f64_cmp_ugt(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    case SIR_INST_F64_CMP_UGE:
+      ok = sir_mb_emit_f64_cmp_uge(c->mb, c->fn, dst, a_slot, b_slot);
+      break;
+    default:
+      return false;
+  }
+  if (!ok) return false;
+  if (!set_node_val(c, node_id, dst, rk)) return false;
+  *out_slot = dst;
+  *out_kind = rk;
+  return true;
+}
+
+// i64/f32/f64 unary ops and conversions: args [x] of kind xk_want (named
+// xty in diagnostics), result of kind rk.
+static bool eval_num_un_mnemonic(sirj_ctx_t* c, uint32_t node_id, const node_info_t* n, sir_inst_kind_t k, val_kind_t xk_want,
+                                 const char* xty, val_kind_t rk, sir_val_id_t* out_slot, val_kind_t* out_kind) {
+  if (!c || !n || !out_slot || !out_kind) return false;
+  if (!n->fields_obj || n->fields_obj->type != JSON_OBJECT) {
+    sirj_diag_setf(c, "sem.parse.num.un.fields", c->cur_path, n->loc_line, node_id, n->tag, "%s missing/invalid fields object", n->tag);
+    return false;
+  }
+  const JsonValue* av = json_obj_get(n->fields_obj, "args");
+  if (!json_is_array(av) || av->v.arr.len != 1) {
+    sirj_diag_setf(c, "sem.parse.num.un.args", c->cur_path, n->loc_line, node_id, n->tag, "%s args must be [x]", n->tag);
+    return false;
+  }
+  uint32_t x_id = 0;
+  if (!parse_ref_id(c, av->v.arr.items[0], &x_id)) {
+    sirj_diag_setf(c, "sem.parse.num.un.arg", c->cur_path, n->loc_line, node_id, n->tag, "%s arg 0 must be a ref", n->tag);
+    return false;
+  }
+  sir_val_id_t x_slot = 0;
+  val_kind_t xk = VK_INVALID;
+  if (!eval_node(c, x_id, &x_slot, &xk)) return false;
+  if (xk != xk_want) {
+    sirj_diag_setf(c, "sem.num.un.arg_type", c->cur_path, n->loc_line, node_id, n->tag, "%s arg must be %s", n->tag, xty);
+    return false;
+  }
+  const sir_val_id_t dst = alloc_slot(c, rk);
+  bool ok = false;
+  sir_mb_set_src(c->mb, node_id, n->loc_line);
+  switch (k) {
+    case SIR_INST_I64_NOT:
+      ok = sir_mb_emit_i64_not(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I64_NEG:
+      ok = sir_mb_emit_i64_neg(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F32_NEG:
+      ok = sir_mb_emit_f32_neg(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F64_NEG:
+      ok = sir_mb_emit_f64_neg(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I64_SEXT_I32:
+      ok = sir_mb_emit_i64_sext_i32(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F32_FROM_I32_S:
+      ok = sir_mb_emit_f32_from_i32_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F32_FROM_I32_U:
+      ok = sir_mb_emit_f32_from_i32_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F32_FROM_I64_S:
+      ok = sir_mb_emit_f32_from_i64_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F32_FROM_I64_U:
+      ok = sir_mb_emit_f32_from_i64_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F64_FROM_I32_S:
+      ok = sir_mb_emit_f64_from_i32_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F64_FROM_I32_U:
+      ok = sir_mb_emit_f64_from_i32_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F64_FROM_I64_S:
+      ok = sir_mb_emit_f64_from_i64_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F64_FROM_I64_U:
+      ok = sir_mb_emit_f64_from_i64_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I32_TRUNC_SAT_F32_S:
+      ok = sir_mb_emit_i32_trunc_sat_f32_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I32_TRUNC_SAT_F32_U:
+      ok = sir_mb_emit_i32_trunc_sat_f32_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I32_TRUNC_SAT_F64_S:
+      ok = sir_mb_emit_i32_trunc_sat_f64_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I32_TRUNC_SAT_F64_U:
+      ok = sir_mb_emit_i32_trunc_sat_f64_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I64_TRUNC_SAT_F32_S:
+      ok = sir_mb_emit_i64_trunc_sat_f32_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I64_TRUNC_SAT_F32_U:
+      ok = sir_mb_emit_i64_trunc_sat_f32_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I64_TRUNC_SAT_F64_S:
+      ok = sir_mb_emit_i64_trunc_sat_f64_s(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_I64_TRUNC_SAT_F64_U:
+      ok = sir_mb_emit_i64_trunc_sat_f64_u(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F64_PROMOTE_F32:
+      ok = sir_mb_emit_f64_promote_f32(c->mb, c->fn, dst, x_slot);
+      break;
+    case SIR_INST_F32_DEMOTE_F64:
+      ok = sir_mb_emit_f32_demote_f64(c->mb, c->fn, dst, x_slot);
+      break;
+    default:
+      return false;
+  }
+  if (!ok) return false;
+  if (!set_node_val(c, node_id, dst, rk)) return false;
+  *out_slot = dst;
+  *out_kind = rk;
+  return true;
+}
+
 static bool eval_ptr_size_alignof(sirj_ctx_t* c, uint32_t node_id, const node_info_t* n, bool want_sizeof, sir_val_id_t* out_slot,
                                   val_kind_t* out_kind) {
   if (!c || !n || !out_slot || !out_kind) return false;
@@ -6616,6 +7011,83 @@ static bool eval_node(sirj_ctx_t* c, uint32_t node_id, sir_val_id_t* out_slot, v
   if (strcmp(n->tag, "i32.cmp.uge") == 0) return eval_i32_cmp(c, node_id, n, SIR_INST_I32_CMP_UGE, out_slot, out_kind);
   if (strcmp(n->tag, "f32.cmp.ueq") == 0) return eval_f32_cmp_ueq(c, node_id, n, out_slot, out_kind);
   if (strcmp(n->tag, "f64.cmp.olt") == 0) return eval_f64_cmp_olt(c, node_id, n, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.add") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_ADD, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.sub") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_SUB, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.mul") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_MUL, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.and") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_AND, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.or") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_OR, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.xor") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_XOR, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.shl") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_SHL, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.shr.s") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_SHR_S, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.shr.u") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_SHR_U, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.div.s.sat") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_DIV_S_SAT, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.div.s.trap") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_DIV_S_TRAP, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.div.u.sat") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_DIV_U_SAT, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.rem.s.sat") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_REM_S_SAT, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.rem.u.sat") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_REM_U_SAT, VK_I64, VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.eq") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_EQ, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.ne") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_NE, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.slt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_SLT, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.sle") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_SLE, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.sgt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_SGT, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.sge") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_SGE, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.ult") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_ULT, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.ule") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_ULE, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.ugt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_UGT, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.cmp.uge") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_I64_CMP_UGE, VK_I64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.add") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_ADD, VK_F32, VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.sub") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_SUB, VK_F32, VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.mul") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_MUL, VK_F32, VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.div") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_DIV, VK_F32, VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.add") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_ADD, VK_F64, VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.sub") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_SUB, VK_F64, VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.mul") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_MUL, VK_F64, VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.div") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_DIV, VK_F64, VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.oeq") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_OEQ, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.one") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_ONE, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.olt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_OLT, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.ole") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_OLE, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.ogt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_OGT, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.oge") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_OGE, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.une") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_UNE, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.ult") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_ULT, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.ule") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_ULE, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.ugt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_UGT, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.cmp.uge") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F32_CMP_UGE, VK_F32, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.oeq") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_OEQ, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.one") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_ONE, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.ole") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_OLE, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.ogt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_OGT, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.oge") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_OGE, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.ueq") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_UEQ, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.une") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_UNE, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.ult") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_ULT, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.ule") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_ULE, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.ugt") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_UGT, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.cmp.uge") == 0) return eval_num_bin_mnemonic(c, node_id, n, SIR_INST_F64_CMP_UGE, VK_F64, VK_BOOL, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.not") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I64_NOT, VK_I64, "i64", VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.neg") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I64_NEG, VK_I64, "i64", VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.neg") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F32_NEG, VK_F32, "f32", VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.neg") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F64_NEG, VK_F64, "f64", VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.sext.i32") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I64_SEXT_I32, VK_I32, "i32", VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.from_i32.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F32_FROM_I32_S, VK_I32, "i32", VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.from_i32.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F32_FROM_I32_U, VK_I32, "i32", VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.from_i64.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F32_FROM_I64_S, VK_I64, "i64", VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.from_i64.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F32_FROM_I64_U, VK_I64, "i64", VK_F32, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.from_i32.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F64_FROM_I32_S, VK_I32, "i32", VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.from_i32.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F64_FROM_I32_U, VK_I32, "i32", VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.from_i64.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F64_FROM_I64_S, VK_I64, "i64", VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.from_i64.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F64_FROM_I64_U, VK_I64, "i64", VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "i32.trunc_sat_f32.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I32_TRUNC_SAT_F32_S, VK_F32, "f32", VK_I32, out_slot, out_kind);
+  if (strcmp(n->tag, "i32.trunc_sat_f32.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I32_TRUNC_SAT_F32_U, VK_F32, "f32", VK_I32, out_slot, out_kind);
+  if (strcmp(n->tag, "i32.trunc_sat_f64.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I32_TRUNC_SAT_F64_S, VK_F64, "f64", VK_I32, out_slot, out_kind);
+  if (strcmp(n->tag, "i32.trunc_sat_f64.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I32_TRUNC_SAT_F64_U, VK_F64, "f64", VK_I32, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.trunc_sat_f32.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I64_TRUNC_SAT_F32_S, VK_F32, "f32", VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.trunc_sat_f32.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I64_TRUNC_SAT_F32_U, VK_F32, "f32", VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.trunc_sat_f64.s") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I64_TRUNC_SAT_F64_S, VK_F64, "f64", VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "i64.trunc_sat_f64.u") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_I64_TRUNC_SAT_F64_U, VK_F64, "f64", VK_I64, out_slot, out_kind);
+  if (strcmp(n->tag, "f64.promote_f32") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F64_PROMOTE_F32, VK_F32, "f32", VK_F64, out_slot, out_kind);
+  if (strcmp(n->tag, "f32.demote_f64") == 0) return eval_num_un_mnemonic(c, node_id, n, SIR_INST_F32_DEMOTE_F64, VK_F64, "f64", VK_F32, out_slot, out_kind);
   if (strcmp(n->tag, "binop.add") == 0) return eval_binop_add(c, node_id, n, out_slot, out_kind);
   if (strcmp(n->tag, "alloca") == 0) return eval_alloca(c, node_id, n, out_slot, out_kind);
   if (strcmp(n->tag, "alloca.i8") == 0) return eval_alloca_mnemonic(c, node_id, n, 1, 1, out_slot, out_kind);
@@ -7248,6 +7720,9 @@ static bool lower_fn_body(sirj_ctx_t* c, uint32_t fn_node_id, bool is_entry) {
     uint32_t* block_ip = (uint32_t*)arena_alloc(&c->arena, (size_t)c->node_cap * sizeof(uint32_t));
     if (!block_ip) return false;
     for (uint32_t i = 0; i < c->node_cap; i++) block_ip[i] = 0xFFFFFFFFu;
+    // Block table for block/edge profiles, in emission (ip) order.
+    sir_block_t* fblocks = (sir_block_t*)arena_alloc(&c->arena, blks->len * sizeof(sir_block_t));
+    if (!fblocks) return false;
 
     patch_rec_t patches[512];
     uint32_t patch_n = 0;
@@ -7272,6 +7747,7 @@ static bool lower_fn_body(sirj_ctx_t* c, uint32_t fn_node_id, bool is_entry) {
       if (!bn->fields_obj || bn->fields_obj->type != JSON_OBJECT) return false;
 
       block_ip[bid] = sir_mb_func_ip(c->mb, c->fn);
+      fblocks[bi] = (sir_block_t){.ip = block_ip[bid], .node_id = bid};
 
       // Let bindings are block-scoped in CFG form.
       c->let_count = 0;
@@ -7483,6 +7959,9 @@ static bool lower_fn_body(sirj_ctx_t* c, uint32_t fn_node_id, bool is_entry) {
               }
             }
 
+            // Argument lowering moved the source context; the branch and its
+            // stubs belong to the terminator.
+            sir_mb_set_src(c->mb, sid, c->nodes[sid].loc_line);
             uint32_t ip_cbr = 0;
             if (!sir_mb_emit_cbr(c->mb, c->fn, term.cond_slot, 0, 0, &ip_cbr)) return false;
 
@@ -7593,6 +8072,7 @@ static bool lower_fn_body(sirj_ctx_t* c, uint32_t fn_node_id, bool is_entry) {
       }
     }
 
+    if (!sir_mb_func_set_blocks(c->mb, c->fn, fblocks, (uint32_t)blks->len)) return false;
     c->in_cfg = false;
     return true;
   }
@@ -7662,418 +8142,542 @@ static uint32_t loc_line_from_root(const JsonValue* root, uint32_t fallback) {
   return ln ? ln : fallback;
 }
 
-static bool parse_file(sirj_ctx_t* c, const char* path) {
-  if (!c || !path) return false;
-  FILE* f = fopen(path, "rb");
-  if (!f) return false;
-
-  char* line = NULL;
-  size_t cap = 0;
-  size_t len = 0;
-  int ch = 0;
-  uint32_t rec_no = 0;
+// Applies one parsed record (type/sym/node) to c; other kinds are ignored.
+static bool apply_record(sirj_ctx_t* c, const char* diag_path, uint32_t rec_no, JsonValue* root) {
+  const char* k = json_get_string(json_obj_get(root, "k"));
+  if (!k) return true;
 
-  const char* diag_path = path;
+  if (strcmp(k, "type") == 0) {
+    const uint32_t loc_line = loc_line_from_root(root, rec_no);
+    uint32_t id = 0;
+    if (!sirj_intern_id(c, json_obj_get(root, "id"), &id) || id == 0) {
+      sirj_diag_setf(c, "sem.parse.type.id", diag_path, loc_line, 0, NULL, "type.id missing/invalid");
+      return false;
+    }
+    if (!ensure_type_cap(c, id)) {
+      sirj_diag_setf(c, "sem.oom", diag_path, loc_line, 0, NULL, "out of memory");
+      return false;
+    }
+    const char* kind = json_get_string(json_obj_get(root, "kind"));
+    if (!kind) {
+      sirj_diag_setf(c, "sem.parse.type.kind", diag_path, loc_line, 0, NULL, "type.kind missing");
+      return false;
+    }
 
-  // Minimal line reader (no reliance on POSIX getline).
-  for (;;) {
-    ch = fgetc(f);
-    if (ch == EOF) {
-      if (len == 0) break;
-      ch = '\n';
-    }
-    if (cap < len + 2) {
-      const size_t ncap = cap ? cap * 2 : 4096;
-      char* np = (char*)realloc(line, ncap);
-      if (!np) {
-        free(line);
-        fclose(f);
+    type_info_t ti = {0};
+    ti.present = true;
+    ti.loc_line = loc_line;
+    if (strcmp(kind, "prim") == 0) {
+      const char* prim = json_get_string(json_obj_get(root, "prim"));
+      ti.prim = prim_from_string(prim);
+      if (ti.prim == SIR_PRIM_INVALID) {
+        sirj_diag_setf(c, "sem.unsupported.prim", diag_path, loc_line, 0, NULL, "unsupported prim: %s", prim ? prim : "(null)");
         return false;
       }
-      line = np;
-      cap = ncap;
-    }
-    line[len++] = (char)ch;
-    if (ch == '\n') {
-      line[len] = '\0';
-      // skip empty/whitespace lines
-      const char* p = line;
-      while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
-      if (*p == '\0') {
-        len = 0;
-        continue;
+    } else if (strcmp(kind, "fn") == 0) {
+      ti.is_fn = true;
+      const JsonValue* pv = obj_req(root, "params");
+      if (!parse_u32_array(c, pv, &ti.params, &ti.param_count, &c->arena)) {
+        sirj_diag_setf(c, "sem.parse.type.fn.params", diag_path, loc_line, 0, NULL, "bad fn params array");
+        return false;
       }
-
-      rec_no++;
-      JsonValue* root = NULL;
-      JsonError err = {0};
-      if (!json_parse(&c->arena, line, &root, &err) || !root) {
-        sirj_diag_setf(c, "sem.parse.json", diag_path, rec_no, 0, NULL, "json parse error at offset %u: %s", (unsigned)err.offset,
-                       err.msg ? err.msg : "error");
-        free(line);
-        fclose(f);
+      if (!sirj_intern_id(c, json_obj_get(root, "ret"), &ti.ret)) {
+        sirj_diag_setf(c, "sem.parse.type.fn.ret", diag_path, loc_line, 0, NULL, "bad fn ret");
         return false;
       }
-      if (!json_is_object(root)) {
-        sirj_diag_setf(c, "sem.parse.record", diag_path, rec_no, 0, NULL, "record is not an object");
-        free(line);
-        fclose(f);
+    } else if (strcmp(kind, "fun") == 0) {
+      ti.is_fun = true;
+      uint32_t sig = 0;
+      if (!sirj_intern_id(c, json_obj_get(root, "sig"), &sig)) {
+        sirj_diag_setf(c, "sem.parse.type.fun.sig", diag_path, loc_line, 0, NULL, "bad fun.sig");
         return false;
       }
-
-      const char* k = json_get_string(json_obj_get(root, "k"));
-      if (!k) {
-        len = 0;
-        if (ch == EOF) break;
-        continue;
+      ti.fun_sig = sig;
+    } else if (strcmp(kind, "closure") == 0) {
+      ti.is_closure = true;
+      uint32_t call_sig = 0;
+      uint32_t env = 0;
+      if (!sirj_intern_id(c, json_obj_get(root, "callSig"), &call_sig)) {
+        sirj_diag_setf(c, "sem.parse.type.closure.callSig", diag_path, loc_line, 0, NULL, "bad closure.callSig");
+        return false;
       }
-
-      if (strcmp(k, "type") == 0) {
-        const uint32_t loc_line = loc_line_from_root(root, rec_no);
-        uint32_t id = 0;
-        if (!sirj_intern_id(c, json_obj_get(root, "id"), &id) || id == 0) {
-          sirj_diag_setf(c, "sem.parse.type.id", diag_path, loc_line, 0, NULL, "type.id missing/invalid");
-          free(line);
-          fclose(f);
-          return false;
-        }
-        if (!ensure_type_cap(c, id)) {
+      if (!sirj_intern_id(c, json_obj_get(root, "env"), &env)) {
+        sirj_diag_setf(c, "sem.parse.type.closure.env", diag_path, loc_line, 0, NULL, "bad closure.env");
+        return false;
+      }
+      ti.closure_call_sig = call_sig;
+      ti.closure_env = env;
+    } else if (strcmp(kind, "sum") == 0) {
+      ti.is_sum = true;
+      const JsonValue* vv = json_obj_get(root, "variants");
+      if (!json_is_array(vv)) {
+        sirj_diag_setf(c, "sem.parse.type.sum.variants", diag_path, loc_line, 0, NULL, "bad sum.variants array");
+        return false;
+      }
+      const JsonArray* va = &vv->v.arr;
+      const uint32_t nvar = (uint32_t)va->len;
+      if (nvar != va->len) {
+        sirj_diag_setf(c, "sem.parse.type.sum.variants", diag_path, loc_line, 0, NULL, "sum.variants too large");
+        return false;
+      }
+      ti.sum_variant_count = nvar;
+      if (nvar) {
+        ti.sum_payload_types = (uint32_t*)arena_alloc(&c->arena, (size_t)nvar * sizeof(uint32_t));
+        if (!ti.sum_payload_types) {
           sirj_diag_setf(c, "sem.oom", diag_path, loc_line, 0, NULL, "out of memory");
-          free(line);
-          fclose(f);
           return false;
         }
-        const char* kind = json_get_string(json_obj_get(root, "kind"));
-        if (!kind) {
-          sirj_diag_setf(c, "sem.parse.type.kind", diag_path, loc_line, 0, NULL, "type.kind missing");
-          free(line);
-          fclose(f);
+        memset(ti.sum_payload_types, 0, (size_t)nvar * sizeof(uint32_t));
+      }
+      for (uint32_t vi = 0; vi < nvar; vi++) {
+        const JsonValue* vobj = va->items[vi];
+        if (!json_is_object(vobj)) {
+          sirj_diag_setf(c, "sem.parse.type.sum.variant", diag_path, loc_line, 0, NULL, "sum.variants[%u] must be an object", (unsigned)vi);
           return false;
         }
-
-        type_info_t ti = {0};
-        ti.present = true;
-        ti.loc_line = loc_line;
-        if (strcmp(kind, "prim") == 0) {
-          const char* prim = json_get_string(json_obj_get(root, "prim"));
-          ti.prim = prim_from_string(prim);
-          if (ti.prim == SIR_PRIM_INVALID) {
-            sirj_diag_setf(c, "sem.unsupported.prim", diag_path, loc_line, 0, NULL, "unsupported prim: %s", prim ? prim : "(null)");
-            free(line);
-            fclose(f);
-            return false;
-          }
-        } else if (strcmp(kind, "fn") == 0) {
-          ti.is_fn = true;
-          const JsonValue* pv = obj_req(root, "params");
-          if (!parse_u32_array(c, pv, &ti.params, &ti.param_count, &c->arena)) {
-            sirj_diag_setf(c, "sem.parse.type.fn.params", diag_path, loc_line, 0, NULL, "bad fn params array");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          if (!sirj_intern_id(c, json_obj_get(root, "ret"), &ti.ret)) {
-            sirj_diag_setf(c, "sem.parse.type.fn.ret", diag_path, loc_line, 0, NULL, "bad fn ret");
-            free(line);
-            fclose(f);
-            return false;
-          }
-        } else if (strcmp(kind, "fun") == 0) {
-          ti.is_fun = true;
-          uint32_t sig = 0;
-          if (!sirj_intern_id(c, json_obj_get(root, "sig"), &sig)) {
-            sirj_diag_setf(c, "sem.parse.type.fun.sig", diag_path, loc_line, 0, NULL, "bad fun.sig");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          ti.fun_sig = sig;
-        } else if (strcmp(kind, "closure") == 0) {
-          ti.is_closure = true;
-          uint32_t call_sig = 0;
-          uint32_t env = 0;
-          if (!sirj_intern_id(c, json_obj_get(root, "callSig"), &call_sig)) {
-            sirj_diag_setf(c, "sem.parse.type.closure.callSig", diag_path, loc_line, 0, NULL, "bad closure.callSig");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          if (!sirj_intern_id(c, json_obj_get(root, "env"), &env)) {
-            sirj_diag_setf(c, "sem.parse.type.closure.env", diag_path, loc_line, 0, NULL, "bad closure.env");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          ti.closure_call_sig = call_sig;
-          ti.closure_env = env;
-        } else if (strcmp(kind, "sum") == 0) {
-          ti.is_sum = true;
-          const JsonValue* vv = json_obj_get(root, "variants");
-          if (!json_is_array(vv)) {
-            sirj_diag_setf(c, "sem.parse.type.sum.variants", diag_path, loc_line, 0, NULL, "bad sum.variants array");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          const JsonArray* va = &vv->v.arr;
-          const uint32_t nvar = (uint32_t)va->len;
-          if (nvar != va->len) {
-            sirj_diag_setf(c, "sem.parse.type.sum.variants", diag_path, loc_line, 0, NULL, "sum.variants too large");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          ti.sum_variant_count = nvar;
-          if (nvar) {
-            ti.sum_payload_types = (uint32_t*)arena_alloc(&c->arena, (size_t)nvar * sizeof(uint32_t));
-            if (!ti.sum_payload_types) {
-              sirj_diag_setf(c, "sem.oom", diag_path, loc_line, 0, NULL, "out of memory");
-              free(line);
-              fclose(f);
-              return false;
-            }
-            memset(ti.sum_payload_types, 0, (size_t)nvar * sizeof(uint32_t));
-          }
-          for (uint32_t vi = 0; vi < nvar; vi++) {
-            const JsonValue* vobj = va->items[vi];
-            if (!json_is_object(vobj)) {
-              sirj_diag_setf(c, "sem.parse.type.sum.variant", diag_path, loc_line, 0, NULL, "sum.variants[%u] must be an object", (unsigned)vi);
-              free(line);
-              fclose(f);
-              return false;
-            }
-            uint32_t pty = 0;
-            // payload type is optional.
-            const JsonValue* tyv = json_obj_get((JsonValue*)vobj, "ty");
-            if (tyv) {
-              if (!sirj_intern_id(c, tyv, &pty)) {
-                sirj_diag_setf(c, "sem.parse.type.sum.variant", diag_path, loc_line, 0, NULL, "sum.variants[%u].ty invalid", (unsigned)vi);
-                free(line);
-                fclose(f);
-                return false;
-              }
-            }
-            ti.sum_payload_types[vi] = pty;
-          }
-        } else if (strcmp(kind, "array") == 0) {
-          ti.is_array = true;
-          if (!sirj_intern_id(c, json_obj_get(root, "of"), &ti.array_of)) {
-            sirj_diag_setf(c, "sem.parse.type.array.of", diag_path, loc_line, 0, NULL, "bad array.of");
-            free(line);
-            fclose(f);
+        uint32_t pty = 0;
+        // payload type is optional.
+        const JsonValue* tyv = json_obj_get((JsonValue*)vobj, "ty");
+        if (tyv) {
+          if (!sirj_intern_id(c, tyv, &pty)) {
+            sirj_diag_setf(c, "sem.parse.type.sum.variant", diag_path, loc_line, 0, NULL, "sum.variants[%u].ty invalid", (unsigned)vi);
             return false;
           }
-          if (!json_get_u32(json_obj_get(root, "len"), &ti.array_len)) {
-            sirj_diag_setf(c, "sem.parse.type.array.len", diag_path, loc_line, 0, NULL, "bad array.len");
-            free(line);
-            fclose(f);
+        }
+        ti.sum_payload_types[vi] = pty;
+      }
+    } else if (strcmp(kind, "array") == 0) {
+      ti.is_array = true;
+      if (!sirj_intern_id(c, json_obj_get(root, "of"), &ti.array_of)) {
+        sirj_diag_setf(c, "sem.parse.type.array.of", diag_path, loc_line, 0, NULL, "bad array.of");
+        return false;
+      }
+      if (!json_get_u32(json_obj_get(root, "len"), &ti.array_len)) {
+        sirj_diag_setf(c, "sem.parse.type.array.len", diag_path, loc_line, 0, NULL, "bad array.len");
+        return false;
+      }
+    } else if (strcmp(kind, "vec") == 0) {
+      ti.is_vec = true;
+      if (!sirj_intern_id(c, json_obj_get(root, "lane"), &ti.vec_lane) || ti.vec_lane == 0) {
+        sirj_diag_setf(c, "sem.parse.type.vec.lane", diag_path, loc_line, 0, NULL, "bad vec.lane");
+        return false;
+      }
+      if (!json_get_u32(json_obj_get(root, "lanes"), &ti.vec_lanes) || ti.vec_lanes == 0) {
+        sirj_diag_setf(c, "sem.parse.type.vec.lanes", diag_path, loc_line, 0, NULL, "bad vec.lanes");
+        return false;
+      }
+    } else if (strcmp(kind, "ptr") == 0) {
+      ti.is_ptr = true;
+      ti.prim = SIR_PRIM_PTR;
+      const JsonValue* ofv = json_obj_get(root, "of");
+      if (ofv) (void)sirj_intern_id(c, ofv, &ti.ptr_of);
+    } else if (strcmp(kind, "struct") == 0) {
+      ti.is_struct = true;
+      const JsonValue* fv = json_obj_get(root, "fields");
+      if (!json_is_array(fv)) {
+        sirj_diag_setf(c, "sem.parse.type.struct.fields", diag_path, loc_line, 0, NULL, "bad struct.fields array");
+        return false;
+      }
+      const JsonArray* fa = &fv->v.arr;
+      const uint32_t nfield = (uint32_t)fa->len;
+      if (nfield != fa->len) {
+        sirj_diag_setf(c, "sem.parse.type.struct.fields", diag_path, loc_line, 0, NULL, "struct.fields too large");
+        return false;
+      }
+      ti.struct_field_count = nfield;
+      if (nfield) {
+        ti.struct_fields = (uint32_t*)arena_alloc(&c->arena, (size_t)nfield * sizeof(uint32_t));
+        ti.struct_field_align = (uint32_t*)arena_alloc(&c->arena, (size_t)nfield * sizeof(uint32_t));
+        if (!ti.struct_fields || !ti.struct_field_align) {
+          sirj_diag_setf(c, "sem.oom", diag_path, loc_line, 0, NULL, "out of memory");
+          return false;
+        }
+      }
+      for (uint32_t fi = 0; fi < nfield; fi++) {
+        const JsonValue* fobj = fa->items[fi];
+        if (!json_is_object(fobj)) {
+          sirj_diag_setf(c, "sem.parse.type.struct.field", diag_path, loc_line, 0, NULL, "struct field must be an object");
+          return false;
+        }
+        uint32_t ty = 0;
+        if (!sirj_intern_id(c, json_obj_get(fobj, "type_ref"), &ty)) {
+          const JsonValue* tyv = json_obj_get(fobj, "ty");
+          if (!parse_ref_id(c, tyv, &ty)) {
+            sirj_diag_setf(c, "sem.parse.type.struct.field", diag_path, loc_line, 0, NULL, "struct field missing/invalid type_ref");
             return false;
           }
-        } else if (strcmp(kind, "vec") == 0) {
-          ti.is_vec = true;
-          if (!sirj_intern_id(c, json_obj_get(root, "lane"), &ti.vec_lane) || ti.vec_lane == 0) {
-            sirj_diag_setf(c, "sem.parse.type.vec.lane", diag_path, loc_line, 0, NULL, "bad vec.lane");
-            free(line);
-            fclose(f);
+        }
+        if (ty == 0) {
+          sirj_diag_setf(c, "sem.parse.type.struct.field", diag_path, loc_line, 0, NULL, "struct field type_ref must be non-zero");
+          return false;
+        }
+        ti.struct_fields[fi] = ty;
+
+        uint32_t falign = 0;
+        const JsonValue* av = json_obj_get(fobj, "align");
+        if (av) {
+          if (!json_get_u32(av, &falign) || falign == 0 || !is_pow2_u32(falign)) {
+            sirj_diag_setf(c, "sem.parse.type.struct.field.align", diag_path, loc_line, 0, NULL,
+                           "struct field align must be a positive power of two");
             return false;
           }
-          if (!json_get_u32(json_obj_get(root, "lanes"), &ti.vec_lanes) || ti.vec_lanes == 0) {
-            sirj_diag_setf(c, "sem.parse.type.vec.lanes", diag_path, loc_line, 0, NULL, "bad vec.lanes");
-            free(line);
-            fclose(f);
-            return false;
-          }
-        } else if (strcmp(kind, "ptr") == 0) {
-          ti.is_ptr = true;
-          ti.prim = SIR_PRIM_PTR;
-          const JsonValue* ofv = json_obj_get(root, "of");
-          if (ofv) (void)sirj_intern_id(c, ofv, &ti.ptr_of);
-        } else if (strcmp(kind, "struct") == 0) {
-          ti.is_struct = true;
-          const JsonValue* fv = json_obj_get(root, "fields");
-          if (!json_is_array(fv)) {
-            sirj_diag_setf(c, "sem.parse.type.struct.fields", diag_path, loc_line, 0, NULL, "bad struct.fields array");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          const JsonArray* fa = &fv->v.arr;
-          const uint32_t nfield = (uint32_t)fa->len;
-          if (nfield != fa->len) {
-            sirj_diag_setf(c, "sem.parse.type.struct.fields", diag_path, loc_line, 0, NULL, "struct.fields too large");
-            free(line);
-            fclose(f);
-            return false;
-          }
-          ti.struct_field_count = nfield;
-          if (nfield) {
-            ti.struct_fields = (uint32_t*)arena_alloc(&c->arena, (size_t)nfield * sizeof(uint32_t));
-            ti.struct_field_align = (uint32_t*)arena_alloc(&c->arena, (size_t)nfield * sizeof(uint32_t));
-            if (!ti.struct_fields || !ti.struct_field_align) {
-              sirj_diag_setf(c, "sem.oom", diag_path, loc_line, 0, NULL, "out of memory");
-              free(line);
-              fclose(f);
-              return false;
-            }
-          }
-          for (uint32_t fi = 0; fi < nfield; fi++) {
-            const JsonValue* fobj = fa->items[fi];
-            if (!json_is_object(fobj)) {
-              sirj_diag_setf(c, "sem.parse.type.struct.field", diag_path, loc_line, 0, NULL, "struct field must be an object");
-              free(line);
-              fclose(f);
-              return false;
-            }
-            uint32_t ty = 0;
-            if (!sirj_intern_id(c, json_obj_get(fobj, "type_ref"), &ty)) {
-              const JsonValue* tyv = json_obj_get(fobj, "ty");
-              if (!parse_ref_id(c, tyv, &ty)) {
-                sirj_diag_setf(c, "sem.parse.type.struct.field", diag_path, loc_line, 0, NULL, "struct field missing/invalid type_ref");
-                free(line);
-                fclose(f);
-                return false;
-              }
-            }
-            if (ty == 0) {
-              sirj_diag_setf(c, "sem.parse.type.struct.field", diag_path, loc_line, 0, NULL, "struct field type_ref must be non-zero");
-              free(line);
-              fclose(f);
-              return false;
-            }
-            ti.struct_fields[fi] = ty;
-
-            uint32_t falign = 0;
-            const JsonValue* av = json_obj_get(fobj, "align");
-            if (av) {
-              if (!json_get_u32(av, &falign) || falign == 0 || !is_pow2_u32(falign)) {
-                sirj_diag_setf(c, "sem.parse.type.struct.field.align", diag_path, loc_line, 0, NULL,
-                               "struct field align must be a positive power of two");
-                free(line);
-                fclose(f);
-                return false;
-              }
-            }
-            ti.struct_field_align[fi] = falign;
-          }
-
-          bool packed = false;
-          const JsonValue* pv = json_obj_get(root, "packed");
-          if (pv) {
-            if (!json_get_bool(pv, &packed)) {
-              sirj_diag_setf(c, "sem.parse.type.struct.packed", diag_path, loc_line, 0, NULL, "struct.packed must be boolean");
-              free(line);
-              fclose(f);
-              return false;
-            }
-          }
-          ti.struct_packed = packed;
-
-          uint32_t salign = 0;
-          const JsonValue* av = json_obj_get(root, "align");
-          if (av) {
-            if (!json_get_u32(av, &salign) || salign == 0 || !is_pow2_u32(salign)) {
-              sirj_diag_setf(c, "sem.parse.type.struct.align", diag_path, loc_line, 0, NULL, "struct.align must be a positive power of two");
-              free(line);
-              fclose(f);
-              return false;
-            }
-          }
-          ti.struct_align_override = salign;
-        } else {
-          // ignore other kinds for now
-          memset(&ti, 0, sizeof(ti));
-          ti.present = true;
-          ti.loc_line = loc_line;
-        }
-        c->types[id] = ti;
-      } else if (strcmp(k, "sym") == 0) {
-        const uint32_t loc_line = loc_line_from_root(root, rec_no);
-        uint32_t id = 0;
-        if (!sirj_intern_id(c, json_obj_get(root, "id"), &id) || id == 0) {
-          sirj_diag_setf(c, "sem.parse.sym.id", diag_path, loc_line, 0, NULL, "sym.id missing/invalid");
-          free(line);
-          fclose(f);
-          return false;
         }
-        if (!ensure_symrec_cap(c, id)) {
-          sirj_diag_setf(c, "sem.oom", diag_path, loc_line, id, NULL, "out of memory");
-          free(line);
-          fclose(f);
+        ti.struct_field_align[fi] = falign;
+      }
+
+      bool packed = false;
+      const JsonValue* pv = json_obj_get(root, "packed");
+      if (pv) {
+        if (!json_get_bool(pv, &packed)) {
+          sirj_diag_setf(c, "sem.parse.type.struct.packed", diag_path, loc_line, 0, NULL, "struct.packed must be boolean");
           return false;
         }
+      }
+      ti.struct_packed = packed;
 
-        sym_info_t si = {0};
-        si.present = true;
-        si.loc_line = loc_line;
-        si.name = json_get_string(json_obj_get(root, "name"));
-        si.kind = json_get_string(json_obj_get(root, "kind"));
-        const JsonValue* trv = json_obj_get(root, "type_ref");
-        if (trv) (void)sirj_intern_id(c, trv, &si.type_ref);
-        si.init_kind = SYM_INIT_NONE;
-
-        const JsonValue* vv = json_obj_get(root, "value");
-        if (vv && vv->type == JSON_OBJECT) {
-          const char* t = json_get_string(json_obj_get(vv, "t"));
-          if (t && strcmp(t, "num") == 0) {
-            int64_t v = 0;
-            if (!json_get_i64(json_obj_get(vv, "v"), &v)) {
-              sirj_diag_setf(c, "sem.parse.sym.value", diag_path, loc_line, id, "sym", "sym.value num missing/invalid");
-              free(line);
-              fclose(f);
-              return false;
-            }
-            si.init_kind = SYM_INIT_NUM;
-            si.init_num = v;
-          } else if (t && strcmp(t, "ref") == 0) {
-            uint32_t rid = 0;
-            if (!parse_ref_id(c, vv, &rid)) {
-              sirj_diag_setf(c, "sem.parse.sym.value", diag_path, loc_line, id, "sym", "sym.value ref missing/invalid");
-              free(line);
-              fclose(f);
-              return false;
-            }
-            si.init_kind = SYM_INIT_NODE;
-            si.init_node = rid;
-          }
+      uint32_t salign = 0;
+      const JsonValue* av = json_obj_get(root, "align");
+      if (av) {
+        if (!json_get_u32(av, &salign) || salign == 0 || !is_pow2_u32(salign)) {
+          sirj_diag_setf(c, "sem.parse.type.struct.align", diag_path, loc_line, 0, NULL, "struct.align must be a positive power of two");
+          return false;
         }
+      }
+      ti.struct_align_override = salign;
+    } else {
+      // ignore other kinds for now
+      memset(&ti, 0, sizeof(ti));
+      ti.present = true;
+      ti.loc_line = loc_line;
+    }
+    c->types[id] = ti;
+  } else if (strcmp(k, "sym") == 0) {
+    const uint32_t loc_line = loc_line_from_root(root, rec_no);
+    uint32_t id = 0;
+    if (!sirj_intern_id(c, json_obj_get(root, "id"), &id) || id == 0) {
+      sirj_diag_setf(c, "sem.parse.sym.id", diag_path, loc_line, 0, NULL, "sym.id missing/invalid");
+      return false;
+    }
+    if (!ensure_symrec_cap(c, id)) {
+      sirj_diag_setf(c, "sem.oom", diag_path, loc_line, id, NULL, "out of memory");
+      return false;
+    }
 
-        c->syms[id] = si;
-      } else if (strcmp(k, "node") == 0) {
-        const uint32_t loc_line = loc_line_from_root(root, rec_no);
-        uint32_t id = 0;
-        if (!sirj_intern_id(c, json_obj_get(root, "id"), &id) || id == 0) {
-          sirj_diag_setf(c, "sem.parse.node.id", diag_path, loc_line, 0, NULL, "node.id missing/invalid");
-          free(line);
-          fclose(f);
+    sym_info_t si = {0};
+    si.present = true;
+    si.loc_line = loc_line;
+    si.name = json_get_string(json_obj_get(root, "name"));
+    si.kind = json_get_string(json_obj_get(root, "kind"));
+    const JsonValue* trv = json_obj_get(root, "type_ref");
+    if (trv) (void)sirj_intern_id(c, trv, &si.type_ref);
+    si.init_kind = SYM_INIT_NONE;
+
+    const JsonValue* vv = json_obj_get(root, "value");
+    if (vv && vv->type == JSON_OBJECT) {
+      const char* t = json_get_string(json_obj_get(vv, "t"));
+      if (t && strcmp(t, "num") == 0) {
+        int64_t v = 0;
+        if (!json_get_i64(json_obj_get(vv, "v"), &v)) {
+          sirj_diag_setf(c, "sem.parse.sym.value", diag_path, loc_line, id, "sym", "sym.value num missing/invalid");
           return false;
         }
-        if (!ensure_node_cap(c, id)) {
-          sirj_diag_setf(c, "sem.oom", diag_path, loc_line, id, NULL, "out of memory");
-          free(line);
-          fclose(f);
+        si.init_kind = SYM_INIT_NUM;
+        si.init_num = v;
+      } else if (t && strcmp(t, "ref") == 0) {
+        uint32_t rid = 0;
+        if (!parse_ref_id(c, vv, &rid)) {
+          sirj_diag_setf(c, "sem.parse.sym.value", diag_path, loc_line, id, "sym", "sym.value ref missing/invalid");
           return false;
         }
-        node_info_t ni = {0};
-        ni.present = true;
-        ni.tag = json_get_string(json_obj_get(root, "tag"));
-        const JsonValue* trv = json_obj_get(root, "type_ref");
-        if (trv) (void)sirj_intern_id(c, trv, &ni.type_ref);
-        const JsonValue* fv = json_obj_get(root, "fields");
-        if (fv && json_is_object(fv)) ni.fields_obj = (JsonValue*)fv;
-        ni.loc_line = loc_line;
-        c->nodes[id] = ni;
+        si.init_kind = SYM_INIT_NODE;
+        si.init_node = rid;
       }
+    }
 
-      len = 0;
-      if (ch == EOF) break;
+    c->syms[id] = si;
+  } else if (strcmp(k, "node") == 0) {
+    const uint32_t loc_line = loc_line_from_root(root, rec_no);
+    uint32_t id = 0;
+    if (!sirj_intern_id(c, json_obj_get(root, "id"), &id) || id == 0) {
+      sirj_diag_setf(c, "sem.parse.node.id", diag_path, loc_line, 0, NULL, "node.id missing/invalid");
+      return false;
     }
+    if (!ensure_node_cap(c, id)) {
+      sirj_diag_setf(c, "sem.oom", diag_path, loc_line, id, NULL, "out of memory");
+      return false;
+    }
+    node_info_t ni = {0};
+    ni.present = true;
+    ni.tag = json_get_string(json_obj_get(root, "tag"));
+    const JsonValue* trv = json_obj_get(root, "type_ref");
+    if (trv) (void)sirj_intern_id(c, trv, &ni.type_ref);
+    const JsonValue* fv = json_obj_get(root, "fields");
+    if (fv && json_is_object(fv)) ni.fields_obj = (JsonValue*)fv;
+    ni.loc_line = loc_line;
+    c->nodes[id] = ni;
   }
+  return true;
+}
 
-  free(line);
+// One non-blank input line; root/err are filled in by parse_records.
+typedef struct sirj_rec {
+  const char* text; // not NUL-terminated
+  size_t len;
+  uint32_t rec_no;
+  JsonValue* root;
+  JsonError err;
+} sirj_rec_t;
+
+// Whole input: a read-only file mapping, or a heap copy when the file cannot
+// be mapped (pipes, empty files, non-POSIX hosts).
+typedef struct sirj_input {
+  const char* data;
+  size_t len;
+  void* map;
+  char* heap;
+} sirj_input_t;
+
+static bool input_open(const char* path, sirj_input_t* in) {
+  memset(in, 0, sizeof(*in));
+#ifdef SIRJ_LOAD_MMAP
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && (uint64_t)st.st_size <= (uint64_t)SIZE_MAX) {
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      (void)madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+      close(fd);
+      in->map = p;
+      in->data = (const char*)p;
+      in->len = (size_t)st.st_size;
+      return true;
+    }
+  }
+  close(fd);
+#endif
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  size_t cap = 0;
+  size_t len = 0;
+  char* buf = NULL;
+  for (;;) {
+    if (len == cap) {
+      const size_t ncap = cap ? cap * 2 : 65536;
+      char* nb = (char*)realloc(buf, ncap);
+      if (!nb) {
+        free(buf);
+        fclose(f);
+        return false;
+      }
+      buf = nb;
+      cap = ncap;
+    }
+    const size_t n = fread(buf + len, 1, cap - len, f);
+    len += n;
+    if (n == 0) break;
+  }
+  const bool ok = !ferror(f);
   fclose(f);
+  if (!ok) {
+    free(buf);
+    return false;
+  }
+  in->heap = buf;
+  in->data = buf;
+  in->len = len;
+  return true;
+}
+
+static void input_close(sirj_input_t* in) {
+#ifdef SIRJ_LOAD_MMAP
+  if (in->map) munmap(in->map, in->len);
+#endif
+  free(in->heap);
+  memset(in, 0, sizeof(*in));
+}
+
+typedef struct sirj_rec_list {
+  sirj_rec_t* recs;
+  uint32_t len;
+  uint32_t cap;
+} sirj_rec_list_t;
+
+// Records line [b, e) unless it is blank.
+static bool rec_list_add(sirj_rec_list_t* l, const char* s, size_t b, size_t e) {
+  size_t i = b;
+  while (i < e && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r')) i++;
+  if (i == e) return true;
+  if (l->len == l->cap) {
+    if (l->cap > UINT32_MAX / 2u) return false;
+    const uint32_t ncap = l->cap ? l->cap * 2u : 1024u;
+    sirj_rec_t* nr = (sirj_rec_t*)realloc(l->recs, (size_t)ncap * sizeof(*nr));
+    if (!nr) return false;
+    l->recs = nr;
+    l->cap = ncap;
+  }
+  sirj_rec_t* r = &l->recs[l->len++];
+  memset(r, 0, sizeof(*r));
+  r->text = s + b;
+  r->len = e - b;
+  r->rec_no = l->len;
   return true;
 }
 
+// Splits the input into records. The SSE2 path tests 16 bytes per compare and
+// walks the newline bitmask, so short records cost no per-line call.
+static bool index_records(const sirj_input_t* in, sirj_rec_list_t* l) {
+  const char* s = in->data;
+  const size_t n = in->len;
+  size_t line = 0;
+  size_t i = 0;
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+  const __m128i nl = _mm_set1_epi8('\n');
+  for (; i + 16u <= n; i += 16u) {
+    unsigned bits = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(const void*)(s + i)), nl));
+    while (bits) {
+      const size_t at = i + (size_t)__builtin_ctz(bits);
+      if (!rec_list_add(l, s, line, at)) return false;
+      line = at + 1u;
+      bits &= bits - 1u;
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    if (s[i] != '\n') continue;
+    if (!rec_list_add(l, s, line, i)) return false;
+    line = i + 1u;
+  }
+  return line >= n || rec_list_add(l, s, line, n);
+}
+
+static void parse_records(sirj_rec_t* recs, uint32_t begin, uint32_t end, Arena* arena) {
+  for (uint32_t i = begin; i < end; i++) {
+    sirj_rec_t* r = &recs[i];
+    if (!json_parse_n(arena, r->text, r->len, &r->root, &r->err)) r->root = NULL;
+  }
+}
+
+#ifdef SIRJ_LOAD_MMAP
+// Inputs at least this large are parsed on worker threads (SEM_PARSE_THREADS
+// overrides the count); records are still applied in file order.
+#define SIRJ_PARALLEL_MIN_BYTES (4u << 20)
+#define SIRJ_PARSE_THREADS_MAX 8u
+
+typedef struct sirj_parse_job {
+  sirj_rec_t* recs;
+  uint32_t begin;
+  uint32_t end;
+  Arena* arena;
+} sirj_parse_job_t;
+
+static void* parse_worker(void* arg) {
+  sirj_parse_job_t* j = (sirj_parse_job_t*)arg;
+  parse_records(j->recs, j->begin, j->end, j->arena);
+  return NULL;
+}
+
+static uint32_t parse_thread_count(size_t bytes, uint32_t rec_count) {
+  long want = 1;
+  char env[32];
+  if (sir_hosted_zabi_getenv("SEM_PARSE_THREADS", env, sizeof(env)) && *env) {
+    want = strtol(env, NULL, 10);
+  } else if (bytes >= SIRJ_PARALLEL_MIN_BYTES) {
+    want = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (want < 1) want = 1;
+  if (want > (long)SIRJ_PARSE_THREADS_MAX) want = (long)SIRJ_PARSE_THREADS_MAX;
+  if ((uint32_t)want > rec_count) want = rec_count ? (long)rec_count : 1;
+  return (uint32_t)want;
+}
+
+// Parses every record across n threads, each into its own arena; the arenas
+// move to c so the DOMs live as long as the nodes that point into them.
+static bool parse_records_parallel(sirj_ctx_t* c, sirj_rec_t* recs, uint32_t count, uint32_t n) {
+  Arena* arenas = (Arena*)calloc(n, sizeof(Arena));
+  sirj_parse_job_t* jobs = (sirj_parse_job_t*)calloc(n, sizeof(*jobs));
+  pthread_t* tids = (pthread_t*)calloc(n, sizeof(*tids));
+  bool* started = (bool*)calloc(n, sizeof(*started));
+  if (!arenas || !jobs || !tids || !started) {
+    free(arenas);
+    free(jobs);
+    free(tids);
+    free(started);
+    return false;
+  }
+  // Split by bytes rather than record count: node records vary a lot in size.
+  size_t total = 0;
+  for (uint32_t i = 0; i < count; i++) total += recs[i].len;
+  uint32_t at = 0;
+  size_t seen = 0;
+  for (uint32_t t = 0; t < n; t++) {
+    arena_init(&arenas[t]);
+    const size_t goal = total / n * (t + 1u);
+    jobs[t] = (sirj_parse_job_t){.recs = recs, .begin = at, .arena = &arenas[t]};
+    while (at < count && (t + 1u == n || seen < goal)) seen += recs[at++].len;
+    jobs[t].end = at;
+  }
+  // Job 0 runs here; a job whose thread fails to start runs here too.
+  for (uint32_t t = 1; t < n; t++) started[t] = pthread_create(&tids[t], NULL, parse_worker, &jobs[t]) == 0;
+  parse_records(recs, jobs[0].begin, jobs[0].end, jobs[0].arena);
+  for (uint32_t t = 1; t < n; t++) {
+    if (started[t]) (void)pthread_join(tids[t], NULL);
+    else parse_records(recs, jobs[t].begin, jobs[t].end, jobs[t].arena);
+  }
+  free(jobs);
+  free(tids);
+  free(started);
+  c->parse_arenas = arenas;
+  c->parse_arena_count = n;
+  return true;
+}
+#endif
+
+static bool parse_input(sirj_ctx_t* c, const char* path, const sirj_input_t* in) {
+  if (!c || !path || !in) return false;
+  sirj_rec_list_t l = {0};
+  if (!index_records(in, &l)) {
+    free(l.recs);
+    return false;
+  }
+
+  const char* diag_path = path;
+  bool parsed = false;
+#ifdef SIRJ_LOAD_MMAP
+  const uint32_t threads = parse_thread_count(in->len, l.len);
+  if (threads > 1u) parsed = parse_records_parallel(c, l.recs, l.len, threads);
+#endif
+
+  // Most records define one id; size the id map for them up front.
+  (void)sirj_ids_reserve(&c->ids, l.len);
+  bool ok = true;
+  for (uint32_t i = 0; ok && i < l.len; i++) {
+    sirj_rec_t* r = &l.recs[i];
+    if (!parsed) parse_records(l.recs, i, i + 1u, &c->arena);
+    if (!r->root) {
+      sirj_diag_setf(c, "sem.parse.json", diag_path, r->rec_no, 0, NULL, "json parse error at offset %u: %s", (unsigned)r->err.offset,
+                     r->err.msg ? r->err.msg : "error");
+      ok = false;
+    } else if (!json_is_object(r->root)) {
+      sirj_diag_setf(c, "sem.parse.record", diag_path, r->rec_no, 0, NULL, "record is not an object");
+      ok = false;
+    } else {
+      ok = apply_record(c, diag_path, r->rec_no, r->root);
+    }
+  }
+
+  free(l.recs);
+  return ok;
+}
+
+static bool parse_file(sirj_ctx_t* c, const char* path) {
+  sirj_input_t in;
+  if (!path || !input_open(path, &in)) return false;
+  const bool ok = parse_input(c, path, &in);
+  input_close(&in);
+  return ok;
+}
+
 static bool find_entry_fn(const sirj_ctx_t* c, uint32_t* out_fn_node_id) {
   if (!c || !out_fn_node_id) return false;
   uint32_t best = 0;
@@ -8308,148 +8912,236 @@ static const char* sem_zi_err_name(int32_t rc) {
   }
 }
 
-static int sem_run_or_verify_sir_jsonl_impl(const char* path, sem_run_host_cfg_t host_cfg,
-                                           sem_diag_format_t diag_format, bool diag_all, bool do_run, int* out_prog_rc,
-                                           const sir_exec_event_sink_t* sink, void (*post_run)(void* user, const sir_module_t* m, int32_t exec_rc),
-                                           void* post_user) {
-  if (!path) return 2;
+// Compiled-module cache. When SEM_CACHE_DIR is set, a module that passed
+// validation is stored there as a sircore module image, named by a hash of the
+// input bytes and of what else decides lowering (sem version and build, the
+// lowering revision, image layout). Runs of an unchanged input then map the
+// image and skip parsing, lowering and validation. A missing, stale or damaged
+// entry just means a normal build.
+#ifndef SIR_VERSION
+#define SIR_VERSION "0.0.0"
+#endif
+// Commit sem was built from; set by the build when git is available.
+#ifndef SEM_BUILD_ID
+#define SEM_BUILD_ID ""
+#endif
+// Bump whenever lowering changes what it emits for the same input, so that
+// builds without SEM_BUILD_ID don't map entries from an older lowering.
+#define SEM_LOWERING_REV 1u
+
+typedef struct sem_cache_key {
+  char path[4096];
+} sem_cache_key_t;
+
+static uint64_t sem_cache_rotl(uint64_t x, unsigned r) { return (x << r) | (x >> (64u - r)); }
+
+// Two independent 64-bit hashes over `salt` then the input, mixed a word at a time.
+static void sem_cache_hash(const char* salt, const uint8_t* p, size_t n, uint64_t out[2]) {
+  uint64_t h1 = 1469598103934665603ull;
+  uint64_t h2 = 0x9e3779b97f4a7c15ull;
+  for (int part = 0; part < 2; part++) {
+    const uint8_t* b = part ? p : (const uint8_t*)salt;
+    const size_t len = part ? n : strlen(salt);
+    size_t i = 0;
+    for (; i + 8u <= len; i += 8u) {
+      uint64_t w;
+      memcpy(&w, b + i, sizeof(w));
+      h1 = (h1 ^ w) * 1099511628211ull;
+      h1 ^= h1 >> 32;
+      h2 = sem_cache_rotl(h2 + w * 0x9e3779b97f4a7c15ull, 27) * 0xc2b2ae3d27d4eb4full;
+    }
+    uint64_t w = (uint64_t)len << 56;
+    if (i < len) memcpy(&w, b + i, len - i);
+    h1 = (h1 ^ w) * 1099511628211ull;
+    h1 ^= h1 >> 32;
+    h2 = sem_cache_rotl(h2 + w * 0x9e3779b97f4a7c15ull, 27) * 0xc2b2ae3d27d4eb4full;
+  }
+  out[0] = h1;
+  out[1] = h2 ^ (h2 >> 29);
+}
+
+// Fills `key` for the input; false when caching is off.
+static bool sem_cache_key(const sirj_input_t* in, sem_cache_key_t* key) {
+#ifdef SIRJ_LOAD_MMAP
+  char dir[sizeof(key->path)];
+  if (!sir_hosted_zabi_getenv("SEM_CACHE_DIR", dir, sizeof(dir)) || !*dir) return false;
+  char salt[192];
+  (void)snprintf(salt, sizeof(salt), "sem %s build %s lowering %u image %u ptr %u", SIR_VERSION, SEM_BUILD_ID, SEM_LOWERING_REV,
+                 (unsigned)SIR_MODULE_IMAGE_VERSION, (unsigned)sizeof(void*));
+  uint64_t h[2];
+  sem_cache_hash(salt, (const uint8_t*)in->data, in->len, h);
+  const int n = snprintf(key->path, sizeof(key->path), "%s/%016" PRIx64 "%016" PRIx64 ".sirm", dir, h[0], h[1]);
+  return n > 0 && (size_t)n < sizeof(key->path);
+#else
+  (void)in;
+  (void)key;
+  return false;
+#endif
+}
 
-  sirj_ctx_t c;
-  memset(&c, 0, sizeof(c));
-  arena_init(&c.arena);
-  c.diag_format = diag_format;
-  c.cur_path = path;
-  c.diag_all = diag_all;
+#ifdef SIRJ_LOAD_MMAP
+static void sem_cache_unmap(void* image, size_t len) { (void)munmap(image, len); }
 
-  if (!parse_file(&c, path)) {
-    if (!c.diag.set) sirj_diag_setf(&c, "sem.parse", path, 0, 0, NULL, "failed to parse: %s", path);
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+// Maps the entry copy-on-write: relocation only dirties the pages it touches.
+static sir_module_t* sem_cache_load(const sem_cache_key_t* key) {
+  const int fd = open(key->path, O_RDONLY);
+  if (fd < 0) return NULL;
+  struct stat st;
+  void* p = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && (uint64_t)st.st_size <= (uint64_t)SIZE_MAX) {
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (p == MAP_FAILED) return NULL;
+  sir_module_t* m = sir_module_image_load(p, (size_t)st.st_size, sem_cache_unmap);
+  if (!m) (void)munmap(p, (size_t)st.st_size);
+  return m;
+}
+
+// Best-effort: written under a temporary name, then renamed into place so
+// concurrent runs never see a partial entry. The name is unique per process
+// and per store, so threads of one process never share a temporary either.
+static _Atomic(uint32_t) sem_cache_tmp_seq;
+
+static void sem_cache_store(const sem_cache_key_t* key, const sir_module_t* m) {
+  uint8_t* img = NULL;
+  size_t len = 0;
+  if (!sir_module_image_build(m, &img, &len)) return;
+  const char* slash = strrchr(key->path, '/');
+  if (slash) {
+    char dir[sizeof(key->path)];
+    memcpy(dir, key->path, (size_t)(slash - key->path));
+    dir[slash - key->path] = '\0';
+    (void)mkdir(dir, 0777);
+  }
+  char tmp[sizeof(key->path) + 48];
+  const uint32_t seq = atomic_fetch_add_explicit(&sem_cache_tmp_seq, 1u, memory_order_relaxed);
+  (void)snprintf(tmp, sizeof(tmp), "%s.%ld.%" PRIu32 ".tmp", key->path, (long)getpid(), seq);
+  FILE* f = fopen(tmp, "wb");
+  bool ok = f != NULL;
+  if (f) {
+    ok = fwrite(img, 1, len, f) == len;
+    ok = (fclose(f) == 0) && ok;
+  }
+  free(img);
+  if (!ok || rename(tmp, key->path) != 0) (void)remove(tmp);
+}
+#else
+static sir_module_t* sem_cache_load(const sem_cache_key_t* key) {
+  (void)key;
+  return NULL;
+}
+
+static void sem_cache_store(const sem_cache_key_t* key, const sir_module_t* m) {
+  (void)key;
+  (void)m;
+}
+#endif
+
+// Parses, lowers and validates the input. On failure returns NULL with the
+// diagnostic left in c->diag.
+static sir_module_t* sem_build_module(sirj_ctx_t* c, const char* path, const sirj_input_t* in) {
+  if (!parse_input(c, path, in)) {
+    if (!c->diag.set) sirj_diag_setf(c, "sem.parse", path, 0, 0, NULL, "failed to parse: %s", path);
+    return NULL;
   }
 
   uint32_t entry_fn_node_id = 0;
-  if (!find_entry_fn(&c, &entry_fn_node_id)) {
-    sirj_diag_setf(&c, "sem.no_entry_fn", path, 0, 0, NULL, "no entry fn (expected fn name zir_main or main)");
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+  if (!find_entry_fn(c, &entry_fn_node_id)) {
+    sirj_diag_setf(c, "sem.no_entry_fn", path, 0, 0, NULL, "no entry fn (expected fn name zir_main or main)");
+    return NULL;
   }
 
-  c.mb = sir_mb_new();
-  if (!c.mb) {
-    sirj_diag_setf(&c, "sem.oom", path, 0, 0, NULL, "out of memory");
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+  c->mb = sir_mb_new();
+  if (!c->mb) {
+    sirj_diag_setf(c, "sem.oom", path, 0, 0, NULL, "out of memory");
+    return NULL;
   }
-  if (!ensure_prim_types(&c)) {
-    sirj_diag_setf(&c, "sem.oom", path, 0, 0, NULL, "out of memory");
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+  if (!ensure_prim_types(c)) {
+    sirj_diag_setf(c, "sem.oom", path, 0, 0, NULL, "out of memory");
+    return NULL;
   }
 
-  if (!lower_globals(&c)) {
-    if (!c.diag.set) sirj_diag_setf(&c, "sem.global", path, 0, 0, NULL, "failed to lower globals");
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+  if (!lower_globals(c)) {
+    if (!c->diag.set) sirj_diag_setf(c, "sem.global", path, 0, 0, NULL, "failed to lower globals");
+    return NULL;
   }
 
   // Create module funcs for all SIR fn nodes so ptr.sym can resolve them.
   uint32_t entry_fid = 0;
-  for (uint32_t i = 0; i < c.node_cap; i++) {
-    if (!c.nodes[i].present) continue;
-    if (!c.nodes[i].tag || strcmp(c.nodes[i].tag, "fn") != 0) continue;
-    if (!c.nodes[i].fields_obj || c.nodes[i].fields_obj->type != JSON_OBJECT) continue;
-    const char* nm = json_get_string(json_obj_get(c.nodes[i].fields_obj, "name"));
+  for (uint32_t i = 0; i < c->node_cap; i++) {
+    if (!c->nodes[i].present) continue;
+    if (!c->nodes[i].tag || strcmp(c->nodes[i].tag, "fn") != 0) continue;
+    if (!c->nodes[i].fields_obj || c->nodes[i].fields_obj->type != JSON_OBJECT) continue;
+    const char* nm = json_get_string(json_obj_get(c->nodes[i].fields_obj, "name"));
     if (!nm) continue;
-    const sir_func_id_t fid = sir_mb_func_begin(c.mb, nm);
+    const sir_func_id_t fid = sir_mb_func_begin(c->mb, nm);
     if (!fid) {
-      sirj_diag_setf(&c, "sem.oom", path, c.nodes[i].loc_line, i, "fn", "out of memory");
-      sem_print_diag(&c);
-      ctx_dispose(&c);
-      return 1;
+      sirj_diag_setf(c, "sem.oom", path, c->nodes[i].loc_line, i, "fn", "out of memory");
+      return NULL;
     }
-    c.func_by_node[i] = fid;
+    c->func_by_node[i] = fid;
 
-    uint32_t fty = c.nodes[i].type_ref;
+    uint32_t fty = c->nodes[i].type_ref;
     sir_sig_t sig = {0};
-    if (fty && build_fn_sig(&c, fty, &sig)) {
+    if (fty && build_fn_sig(c, fty, &sig)) {
       if (i == entry_fn_node_id) {
         // `sir_module_run` executes the entry function as a process, not as a callable,
         // so it does not accept a return-value contract. Entry should EXIT/EXIT_VAL.
         sig.results = NULL;
         sig.result_count = 0;
       }
-      if (!sir_mb_func_set_sig(c.mb, fid, sig)) {
-        sirj_diag_setf(&c, "sem.oom", path, c.nodes[i].loc_line, i, "fn", "out of memory");
-        sem_print_diag(&c);
-        ctx_dispose(&c);
-        return 1;
+      if (!sir_mb_func_set_sig(c->mb, fid, sig)) {
+        sirj_diag_setf(c, "sem.oom", path, c->nodes[i].loc_line, i, "fn", "out of memory");
+        return NULL;
       }
     }
 
     if (i == entry_fn_node_id) entry_fid = fid;
   }
   if (!entry_fid) {
-    sirj_diag_setf(&c, "sem.internal", path, 0, 0, NULL, "failed to map entry function");
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+    sirj_diag_setf(c, "sem.internal", path, 0, 0, NULL, "failed to map entry function");
+    return NULL;
   }
-  if (!sir_mb_func_set_entry(c.mb, entry_fid)) {
-    sirj_diag_setf(&c, "sem.internal", path, 0, 0, NULL, "failed to init module func");
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+  if (!sir_mb_func_set_entry(c->mb, entry_fid)) {
+    sirj_diag_setf(c, "sem.internal", path, 0, 0, NULL, "failed to init module func");
+    return NULL;
   }
 
   // Lower each function body.
-  for (uint32_t i = 0; i < c.node_cap; i++) {
-    const sir_func_id_t fid = (i < c.func_by_node_cap) ? c.func_by_node[i] : 0;
+  for (uint32_t i = 0; i < c->node_cap; i++) {
+    const sir_func_id_t fid = (i < c->func_by_node_cap) ? c->func_by_node[i] : 0;
     if (!fid) continue;
-    const node_info_t* fnn = &c.nodes[i];
+    const node_info_t* fnn = &c->nodes[i];
     if (!fnn->fields_obj || fnn->fields_obj->type != JSON_OBJECT) {
-      sirj_diag_setf(&c, "sem.internal", path, fnn->loc_line, i, "fn", "fn fields malformed");
-      sem_print_diag(&c);
-      ctx_dispose(&c);
-      return 1;
+      sirj_diag_setf(c, "sem.internal", path, fnn->loc_line, i, "fn", "fn fields malformed");
+      return NULL;
     }
     const uint32_t fty = fnn->type_ref;
 
-    if (!init_params_for_fn(&c, i, fty)) {
-      sirj_diag_setf(&c, "sem.unsupported.fn_params", path, fnn->loc_line, i, "fn", "unsupported fn params");
-      sem_print_diag(&c);
-      ctx_dispose(&c);
-      return 1;
+    if (!init_params_for_fn(c, i, fty)) {
+      sirj_diag_setf(c, "sem.unsupported.fn_params", path, fnn->loc_line, i, "fn", "unsupported fn params");
+      return NULL;
     }
-    c.fn = fid;
+    c->fn = fid;
     const bool is_entry = (fid == entry_fid);
-    if (!lower_fn_body(&c, i, is_entry)) {
-      if (!c.diag.set) {
+    if (!lower_fn_body(c, i, is_entry)) {
+      if (!c->diag.set) {
         const char* nm = json_get_string(json_obj_get(fnn->fields_obj, "name"));
-        sirj_diag_setf(&c, "sem.unsupported", path, fnn->loc_line, i, "fn", "unsupported SIR subset in fn=%s", nm ? nm : "?");
+        sirj_diag_setf(c, "sem.unsupported", path, fnn->loc_line, i, "fn", "unsupported SIR subset in fn=%s", nm ? nm : "?");
       }
-      sem_print_diag(&c);
-      ctx_dispose(&c);
-      return 1;
+      return NULL;
     }
-    if (!sir_mb_func_set_value_count(c.mb, fid, c.next_slot)) {
-      sirj_diag_setf(&c, "sem.internal", path, fnn->loc_line, i, "fn", "failed to set value count");
-      sem_print_diag(&c);
-      ctx_dispose(&c);
-      return 1;
+    if (!sir_mb_func_set_value_count(c->mb, fid, c->next_slot)) {
+      sirj_diag_setf(c, "sem.internal", path, fnn->loc_line, i, "fn", "failed to set value count");
+      return NULL;
     }
   }
 
-  sir_module_t* m = sir_mb_finalize(c.mb);
+  sir_module_t* m = sir_mb_finalize(c->mb);
   if (!m) {
-    sirj_diag_setf(&c, "sem.internal", path, 0, 0, NULL, "failed to finalize module");
-    sem_print_diag(&c);
-    ctx_dispose(&c);
-    return 1;
+    sirj_diag_setf(c, "sem.internal", path, 0, 0, NULL, "failed to finalize module");
+    return NULL;
   }
 
   sir_validate_diag_t vd = {0};
@@ -8459,12 +9151,51 @@ static int sem_run_or_verify_sir_jsonl_impl(const char* path, sem_run_host_cfg_t
     const uint32_t diag_node = vd.src_node_id ? vd.src_node_id : 0;
     if (vd.fid && vd.op != SIR_INST_INVALID) {
       const char* op = sir_inst_kind_name(vd.op);
-      sirj_diag_setf_ex(&c, vd.code ? vd.code : "sem.validate", path, diag_line, diag_node, NULL, (uint32_t)vd.fid, (uint32_t)vd.ip, op,
+      sirj_diag_setf_ex(c, vd.code ? vd.code : "sem.validate", path, diag_line, diag_node, NULL, (uint32_t)vd.fid, (uint32_t)vd.ip, op,
                         "module validate failed: %s", vd.message[0] ? vd.message : "invalid");
     } else {
-      sirj_diag_setf(&c, vd.code ? vd.code : "sem.validate", path, diag_line, diag_node, NULL, "module validate failed: %s",
+      sirj_diag_setf(c, vd.code ? vd.code : "sem.validate", path, diag_line, diag_node, NULL, "module validate failed: %s",
                      vd.message[0] ? vd.message : "invalid");
     }
+    return NULL;
+  }
+
+  return m;
+}
+
+static int sem_run_or_verify_sir_jsonl_impl(const char* path, sem_run_host_cfg_t host_cfg,
+                                           sem_diag_format_t diag_format, bool diag_all, bool do_run, int* out_prog_rc,
+                                           const sir_exec_event_sink_t* sink, const sir_exec_sampler_t* sampler,
+                                           void (*pre_run)(void* user, const sir_module_t* m),
+                                           void (*post_run)(void* user, const sir_module_t* m, int32_t exec_rc, sirj_ctx_t* c),
+                                           void* hook_user) {
+  if (!path) return 2;
+
+  sirj_ctx_t c;
+  memset(&c, 0, sizeof(c));
+  arena_init(&c.arena);
+  c.diag_format = diag_format;
+  c.cur_path = path;
+  c.diag_all = diag_all;
+
+  sirj_input_t in;
+  if (!input_open(path, &in)) {
+    sirj_diag_setf(&c, "sem.parse", path, 0, 0, NULL, "failed to parse: %s", path);
+    sem_print_diag(&c);
+    ctx_dispose(&c);
+    return 1;
+  }
+  sem_cache_key_t key;
+  const bool use_cache = sem_cache_key(&in, &key);
+  sir_module_t* m = use_cache ? sem_cache_load(&key) : NULL;
+  const bool cached = m != NULL;
+  if (!m) {
+    m = sem_build_module(&c, path, &in);
+    if (m && use_cache) sem_cache_store(&key, m);
+  }
+  input_close(&in);
+  if (!m) {
+    if (!c.diag.set) sirj_diag_setf(&c, "sem.internal", path, 0, 0, NULL, "failed to build module");
     sem_print_diag(&c);
     ctx_dispose(&c);
     return 1;
@@ -8490,7 +9221,10 @@ static int sem_run_or_verify_sir_jsonl_impl(const char* path, sem_run_host_cfg_t
                                        .env_enabled = host_cfg.env_enabled,
                                        .env = host_cfg.env,
                                        .env_count = host_cfg.env_count,
-                                       .fs_root = host_cfg.fs_root})) {
+                                       .fs_root = host_cfg.fs_root,
+                                       .std_in = host_cfg.std_in,
+                                       .std_out = host_cfg.std_out,
+                                       .std_err = host_cfg.std_err})) {
     sir_module_free(m);
     sirj_diag_setf(&c, "sem.runtime_init", path, 0, 0, NULL, "failed to init runtime");
     sem_print_diag(&c);
@@ -8499,50 +9233,57 @@ static int sem_run_or_verify_sir_jsonl_impl(const char* path, sem_run_host_cfg_t
   }
 
   const sir_host_t host = sem_hosted_make_host(&hz);
+  if (pre_run) pre_run(hook_user, m);
   sem_wrap_sink_t wrap = {.inner = sink};
+  // JSON diagnostics name the last step, so they need every function's events.
   const sir_exec_event_sink_t wrap_sink = {
       .user = &wrap,
       .on_step = sem_wrap_on_step,
       .on_mem = sem_wrap_on_mem,
       .on_hostcall = sem_wrap_on_hostcall,
+      .func_mask = (sink && diag_format != SEM_DIAG_JSON) ? sink->func_mask : NULL,
   };
   const sir_exec_event_sink_t* sink2 = (sink || diag_format == SEM_DIAG_JSON) ? &wrap_sink : NULL;
-  const int32_t rc = sir_module_run_ex(m, hz.mem, host, sink2);
-  if (post_run) post_run(post_user, m, rc);
+  const sir_exec_opts_t opts = {.engine = SIR_EXEC_ENGINE_DEFAULT, .sampler = sampler};
+  const int32_t rc = sir_module_run_opts(m, hz.mem, host, sink2, sampler ? &opts : NULL);
+  if (post_run) post_run(hook_user, m, rc, &c);
 
   sir_hosted_zabi_dispose(&hz);
   sir_module_free(m);
 
   if (rc < 0) {
+    // A cached module skipped parsing; node ids are named from the source.
+    if (cached && sink2 && wrap.last.node_id) (void)parse_file(&c, path);
     // Execution errors come from sircore (ZI_E_*).
+    FILE* out = sem_diag_out();
     if (diag_format == SEM_DIAG_JSON) {
-      fprintf(stderr, "{\"tool\":\"sem\",\"code\":\"sem.exec\",\"message\":\"execution failed\",\"rc\":%d,\"rc_name\":\"%s\"", (int)rc,
+      fprintf(out, "{\"tool\":\"sem\",\"code\":\"sem.exec\",\"message\":\"execution failed\",\"rc\":%d,\"rc_name\":\"%s\"", (int)rc,
               sem_zi_err_name(rc));
       if (sink2) {
-        if (wrap.last.node_id) sem_emit_node_field_json(stderr, &c, wrap.last.node_id);
-        if (wrap.last.line) fprintf(stderr, ",\"line\":%u", (unsigned)wrap.last.line);
+        if (wrap.last.node_id) sem_emit_node_field_json(out, &c, wrap.last.node_id);
+        if (wrap.last.line) fprintf(out, ",\"line\":%u", (unsigned)wrap.last.line);
         if (wrap.last.fid) {
-          fprintf(stderr, ",\"fid\":%u", (unsigned)wrap.last.fid);
-          fprintf(stderr, ",\"ip\":%u", (unsigned)wrap.last.ip);
-          fprintf(stderr, ",\"op\":\"%s\"", sir_inst_kind_name(wrap.last.op));
+          fprintf(out, ",\"fid\":%u", (unsigned)wrap.last.fid);
+          fprintf(out, ",\"ip\":%u", (unsigned)wrap.last.ip);
+          fprintf(out, ",\"op\":\"%s\"", sir_inst_kind_name(wrap.last.op));
         }
       }
-      fprintf(stderr, "}\n");
+      fprintf(out, "}\n");
     } else {
-      fprintf(stderr, "sem: execution failed: %s (%d)\n", sem_zi_err_name(rc), (int)rc);
+      fprintf(out, "sem: execution failed: %s (%d)\n", sem_zi_err_name(rc), (int)rc);
       if (sink2 && wrap.last.fid) {
-        fprintf(stderr, "sem:   at fid=%u ip=%u op=%s\n", (unsigned)wrap.last.fid, (unsigned)wrap.last.ip, sir_inst_kind_name(wrap.last.op));
+        fprintf(out, "sem:   at fid=%u ip=%u op=%s\n", (unsigned)wrap.last.fid, (unsigned)wrap.last.ip, sir_inst_kind_name(wrap.last.op));
       }
       if (sink2 && (wrap.last.node_id || wrap.last.line)) {
         bool is_num = false;
         uint32_t num = 0;
         const char* str = NULL;
         if (wrap.last.node_id && sirj_unintern_id(&c, wrap.last.node_id, &is_num, &num, &str)) {
-          if (is_num) fprintf(stderr, "sem:   at node=%u", (unsigned)num);
-          else fprintf(stderr, "sem:   at node=\"%s\"", str ? str : "");
-          fprintf(stderr, " (intern=%u) line=%u\n", (unsigned)wrap.last.node_id, (unsigned)wrap.last.line);
+          if (is_num) fprintf(out, "sem:   at node=%u", (unsigned)num);
+          else fprintf(out, "sem:   at node=\"%s\"", str ? str : "");
+          fprintf(out, " (intern=%u) line=%u\n", (unsigned)wrap.last.node_id, (unsigned)wrap.last.line);
         } else {
-          fprintf(stderr, "sem:   at node=%u line=%u\n", (unsigned)wrap.last.node_id, (unsigned)wrap.last.line);
+          fprintf(out, "sem:   at node=%u line=%u\n", (unsigned)wrap.last.node_id, (unsigned)wrap.last.line);
         }
       }
     }
@@ -8567,7 +9308,7 @@ int sem_run_sir_jsonl(const char* path, const sem_cap_t* caps, uint32_t cap_coun
       .env = NULL,
       .env_count = 0,
   };
-  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, SEM_DIAG_TEXT, false, true, &prog_rc, NULL, NULL, NULL);
+  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, SEM_DIAG_TEXT, false, true, &prog_rc, NULL, NULL, NULL, NULL, NULL);
   if (tool_rc != 0) return tool_rc;
   return prog_rc;
 }
@@ -8586,7 +9327,7 @@ int sem_run_sir_jsonl_ex(const char* path, const sem_cap_t* caps, uint32_t cap_c
       .env = NULL,
       .env_count = 0,
   };
-  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, NULL, NULL, NULL);
+  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, NULL, NULL, NULL, NULL, NULL);
   if (tool_rc != 0) return tool_rc;
   return prog_rc;
 }
@@ -8605,7 +9346,7 @@ int sem_run_sir_jsonl_capture_ex(const char* path, const sem_cap_t* caps, uint32
       .env = NULL,
       .env_count = 0,
   };
-  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, NULL, NULL, NULL);
+  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, NULL, NULL, NULL, NULL, NULL);
   if (tool_rc != 0) return tool_rc;
   if (out_prog_rc) *out_prog_rc = prog_rc;
   return 0;
@@ -8614,7 +9355,7 @@ int sem_run_sir_jsonl_capture_ex(const char* path, const sem_cap_t* caps, uint32
 int sem_run_sir_jsonl_capture_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
                                       int* out_prog_rc) {
   int prog_rc = 0;
-  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, NULL, NULL, NULL);
+  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, NULL, NULL, NULL, NULL, NULL);
   if (tool_rc != 0) return tool_rc;
   if (out_prog_rc) *out_prog_rc = prog_rc;
   return 0;
@@ -8622,8 +9363,16 @@ int sem_run_sir_jsonl_capture_host_ex(const char* path, sem_run_host_cfg_t host_
 
 typedef struct sem_trace_ctx {
   FILE* out;
-  const char* func_filter; // exact match on function name when non-NULL
-  const char* op_filter;   // exact match on sir_inst_kind_name when non-NULL (step records only)
+  sem_tbin_writer_t* bin;  // binary trace; filtered the same way as out
+  const char* func_filter; // comma-separated function name globs when non-NULL
+  const char* op_filter;   // comma-separated op name globs or @classes when non-NULL (step records only)
+
+  // Filters resolved against the running module (see sem_trace_compile).
+  const sir_module_t* m;
+  bool func_all;
+  uint8_t* func_on; // by fid - 1
+  bool op_all;
+  bool op_on[SIR_INST_KIND_COUNT];
 } sem_trace_ctx_t;
 
 typedef struct sem_cov_ctx {
@@ -8639,6 +9388,7 @@ typedef struct sem_events_ctx {
   sem_trace_ctx_t* trace;
   sem_cov_ctx_t* cov;
   bool cov_inited;
+  sir_exec_event_sink_t* sink;
 } sem_events_ctx_t;
 
 static const char* sem_trace_func_name(const sir_module_t* m, sir_func_id_t fid) {
@@ -8647,6 +9397,79 @@ static const char* sem_trace_func_name(const sir_module_t* m, sir_func_id_t fid)
   return f->name ? f->name : "";
 }
 
+// Op classes for `--trace-op @NAME`, as op name globs.
+static const struct {
+  const char* name;
+  const char* globs;
+} sem_trace_op_classes[] = {
+    {"const", "const.*"},
+    {"int", "i32.*,i64.*"},
+    {"float", "f32.*,f64.*"},
+    {"cmp", "*.cmp.*"},
+    {"ptr", "ptr.*,global.addr"},
+    {"load", "load.*"},
+    {"store", "store.*"},
+    {"mem", "load.*,store.*,mem.*,atomic.*,alloca"},
+    {"vec", "vec.*"},
+    {"call", "call.*"},
+    {"branch", "term.br,term.cbr,term.switch"},
+    {"term", "term.*"},
+};
+
+// True if name matches an entry of the comma-separated glob list. With
+// op_classes, `@NAME` entries match the ops of that class.
+static bool sem_trace_match_list(const char* list, const char* name, bool op_classes) {
+  char pat[256];
+  for (const char* p = list; *p;) {
+    const char* comma = strchr(p, ',');
+    const size_t n = comma ? (size_t)(comma - p) : strlen(p);
+    if (n && n < sizeof(pat)) {
+      memcpy(pat, p, n);
+      pat[n] = '\0';
+      if (op_classes && pat[0] == '@') {
+        for (size_t i = 0; i < sizeof(sem_trace_op_classes) / sizeof(sem_trace_op_classes[0]); i++) {
+          if (strcmp(pat + 1, sem_trace_op_classes[i].name) == 0 && sem_trace_match_list(sem_trace_op_classes[i].globs, name, false)) return true;
+        }
+      } else if (fnmatch(pat, name, 0) == 0) {
+        return true;
+      }
+    }
+    p += n;
+    if (*p == ',') p++;
+  }
+  return false;
+}
+
+// Resolves the function and op filters for m once, so events are filtered
+// by table lookups instead of name compares.
+static void sem_trace_compile(sem_trace_ctx_t* t, const sir_module_t* m) {
+  t->m = m;
+  free(t->func_on);
+  t->func_on = NULL;
+  t->func_all = !t->func_filter || !t->func_filter[0];
+  if (!t->func_all && m) {
+    t->func_on = (uint8_t*)calloc(m->func_count ? m->func_count : 1u, 1);
+    for (uint32_t i = 0; t->func_on && i < m->func_count; i++) {
+      t->func_on[i] = sem_trace_match_list(t->func_filter, m->funcs[i].name ? m->funcs[i].name : "", false);
+    }
+  }
+  t->op_all = !t->op_filter || !t->op_filter[0];
+  if (!t->op_all) {
+    bool any = false;
+    for (uint32_t k = 0; k < SIR_INST_KIND_COUNT; k++) {
+      t->op_on[k] = sem_trace_match_list(t->op_filter, sir_inst_kind_name((sir_inst_kind_t)k), true);
+      any |= t->op_on[k];
+    }
+    if (!any) fprintf(stderr, "sem: --trace-op matches no op: %s\n", t->op_filter);
+  }
+}
+
+static bool sem_trace_func_on(sem_trace_ctx_t* t, const sir_module_t* m, sir_func_id_t fid) {
+  if (m != t->m) sem_trace_compile(t, m);
+  if (t->func_all) return true;
+  return t->func_on && fid != 0 && fid <= m->func_count && t->func_on[fid - 1];
+}
+
 static void sem_trace_write_src(FILE* out, const sir_module_t* m, sir_func_id_t fid, uint32_t ip) {
   if (!out || !m || fid == 0 || fid > m->func_count) return;
   const sir_func_t* f = &m->funcs[fid - 1];
@@ -8659,10 +9482,12 @@ static void sem_trace_write_src(FILE* out, const sir_module_t* m, sir_func_id_t
 
 static void sem_trace_on_step(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_inst_kind_t k) {
   sem_trace_ctx_t* t = (sem_trace_ctx_t*)user;
-  if (!t || !t->out) return;
+  if (!t || (!t->out && !t->bin)) return;
+  if (!sem_trace_func_on(t, m, fid)) return;
+  if (!t->op_all && ((uint32_t)k >= SIR_INST_KIND_COUNT || !t->op_on[k])) return;
+  if (t->bin) sem_tbin_step(t->bin, m, fid, ip, k);
+  if (!t->out) return;
   const char* fn = sem_trace_func_name(m, fid);
-  if (t->func_filter && t->func_filter[0] && strcmp(fn, t->func_filter) != 0) return;
-  if (t->op_filter && t->op_filter[0] && strcmp(sir_inst_kind_name(k), t->op_filter) != 0) return;
   fprintf(t->out, "{\"tool\":\"sem\",\"k\":\"trace_step\",\"fid\":%u,\"func\":\"", (unsigned)fid);
   sem_json_write_escaped(t->out, fn);
   fprintf(t->out, "\",\"ip\":%u,\"op\":\"%s\"", (unsigned)ip, sir_inst_kind_name(k));
@@ -8689,9 +9514,11 @@ static void sem_cov_on_step(void* user, const sir_module_t* m, sir_func_id_t fid
 static void sem_trace_on_mem(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_mem_event_kind_t k, zi_ptr_t addr,
                              uint32_t size) {
   sem_trace_ctx_t* t = (sem_trace_ctx_t*)user;
-  if (!t || !t->out) return;
+  if (!t || (!t->out && !t->bin)) return;
+  if (!sem_trace_func_on(t, m, fid)) return;
+  if (t->bin) sem_tbin_mem(t->bin, m, fid, ip, k, addr, size);
+  if (!t->out) return;
   const char* fn = sem_trace_func_name(m, fid);
-  if (t->func_filter && t->func_filter[0] && strcmp(fn, t->func_filter) != 0) return;
   fprintf(t->out, "{\"tool\":\"sem\",\"k\":\"trace_mem\",\"fid\":%u,\"func\":\"", (unsigned)fid);
   sem_json_write_escaped(t->out, fn);
   fprintf(t->out, "\",\"ip\":%u,\"kind\":\"%s\",\"addr\":%" PRIu64 ",\"size\":%u", (unsigned)ip, (k == SIR_MEM_WRITE) ? "w" : "r",
@@ -8702,9 +9529,11 @@ static void sem_trace_on_mem(void* user, const sir_module_t* m, sir_func_id_t fi
 
 static void sem_trace_on_hostcall(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, const char* callee, int32_t rc) {
   sem_trace_ctx_t* t = (sem_trace_ctx_t*)user;
-  if (!t || !t->out) return;
+  if (!t || (!t->out && !t->bin)) return;
+  if (!sem_trace_func_on(t, m, fid)) return;
+  if (t->bin) sem_tbin_hostcall(t->bin, m, fid, ip, callee, rc);
+  if (!t->out) return;
   const char* fn = sem_trace_func_name(m, fid);
-  if (t->func_filter && t->func_filter[0] && strcmp(fn, t->func_filter) != 0) return;
   fprintf(t->out, "{\"tool\":\"sem\",\"k\":\"trace_hostcall\",\"fid\":%u,\"func\":\"", (unsigned)fid);
   sem_json_write_escaped(t->out, fn);
   fprintf(t->out, "\",\"ip\":%u,\"callee\":\"", (unsigned)ip);
@@ -8760,7 +9589,17 @@ static void sem_events_on_hostcall(void* user, const sir_module_t* m, sir_func_i
   if (e->trace) sem_trace_on_hostcall(e->trace, m, fid, ip, callee, rc);
 }
 
-static void sem_events_post_run(void* user, const sir_module_t* m, int32_t exec_rc) {
+// Compiles the trace filters for m. When only the trace listens, functions
+// it filters out are masked from the sink and run uninstrumented.
+static void sem_events_pre_run(void* user, const sir_module_t* m) {
+  sem_events_ctx_t* e = (sem_events_ctx_t*)user;
+  if (!e || !e->trace) return;
+  sem_trace_compile(e->trace, m);
+  if (!e->cov && e->sink && !e->trace->func_all && e->trace->func_on) e->sink->func_mask = e->trace->func_on;
+}
+
+static void sem_events_post_run(void* user, const sir_module_t* m, int32_t exec_rc, sirj_ctx_t* c) {
+  (void)c;
   sem_events_ctx_t* e = (sem_events_ctx_t*)user;
   if (!e || !e->cov || !e->cov->out || !e->cov_inited || !m) return;
 
@@ -8788,11 +9627,12 @@ static void sem_events_post_run(void* user, const sir_module_t* m, int32_t exec_
           (uint64_t)e->cov->total_steps);
 }
 
-int sem_run_sir_jsonl_events_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
-                                     const char* trace_jsonl_out_path, const char* coverage_jsonl_out_path, const char* trace_func_filter,
-                                     const char* trace_op_filter) {
+int sem_run_sir_jsonl_events_bin_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
+                                         const char* trace_jsonl_out_path, const char* trace_bin_out_path, const char* coverage_jsonl_out_path,
+                                         const char* trace_func_filter, const char* trace_op_filter) {
   FILE* trace_out = NULL;
   FILE* cov_out = NULL;
+  sem_tbin_writer_t* trace_bin = NULL;
 
   if (trace_jsonl_out_path && trace_jsonl_out_path[0]) {
     trace_out = fopen(trace_jsonl_out_path, "wb");
@@ -8809,32 +9649,415 @@ int sem_run_sir_jsonl_events_host_ex(const char* path, sem_run_host_cfg_t host_c
       return 2;
     }
   }
+  if (trace_bin_out_path && trace_bin_out_path[0]) {
+    trace_bin = sem_tbin_writer_open(trace_bin_out_path);
+    if (!trace_bin) {
+      if (trace_out) fclose(trace_out);
+      if (cov_out) fclose(cov_out);
+      fprintf(stderr, "sem: failed to open binary trace output: %s\n", trace_bin_out_path);
+      return 2;
+    }
+  }
 
-  sem_trace_ctx_t t = {.out = trace_out, .func_filter = trace_func_filter, .op_filter = trace_op_filter};
+  sem_trace_ctx_t t = {.out = trace_out, .bin = trace_bin, .func_filter = trace_func_filter, .op_filter = trace_op_filter};
   sem_cov_ctx_t cov = {.out = cov_out};
 
-  sem_events_ctx_t ev = {.trace = trace_out ? &t : NULL, .cov = cov_out ? &cov : NULL, .cov_inited = false};
+  sem_events_ctx_t ev = {.trace = (trace_out || trace_bin) ? &t : NULL, .cov = cov_out ? &cov : NULL, .cov_inited = false};
 
-  const sir_exec_event_sink_t sink = {
+  sir_exec_event_sink_t sink = {
       .user = &ev,
       .on_step = sem_events_on_step,
       .on_mem = sem_events_on_mem,
       .on_hostcall = sem_events_on_hostcall,
   };
+  ev.sink = &sink;
 
   int prog_rc = 0;
   const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc,
-                                                       (trace_out || cov_out) ? &sink : NULL, cov_out ? sem_events_post_run : NULL, &ev);
+                                                       (trace_out || trace_bin || cov_out) ? &sink : NULL, NULL, sem_events_pre_run,
+                                                       cov_out ? sem_events_post_run : NULL, &ev);
 
   if (trace_out) fclose(trace_out);
   if (cov_out) fclose(cov_out);
   free(cov.offsets);
   free(cov.counts);
+  free(t.func_on);
+  if (trace_bin && !sem_tbin_writer_close(trace_bin)) {
+    fprintf(stderr, "sem: failed to write binary trace output: %s\n", trace_bin_out_path);
+    if (tool_rc == 0) return 2;
+  }
 
   if (tool_rc != 0) return tool_rc;
   return prog_rc;
 }
 
+int sem_run_sir_jsonl_events_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
+                                     const char* trace_jsonl_out_path, const char* coverage_jsonl_out_path, const char* trace_func_filter,
+                                     const char* trace_op_filter) {
+  return sem_run_sir_jsonl_events_bin_host_ex(path, host_cfg, diag_format, diag_all, trace_jsonl_out_path, NULL, coverage_jsonl_out_path,
+                                              trace_func_filter, trace_op_filter);
+}
+
+typedef struct sem_profile_ctx {
+  sem_profile_t* prof;
+  FILE* folded;
+  FILE* funcs;
+  bool ok;
+} sem_profile_ctx_t;
+
+static void sem_profile_post_run(void* user, const sir_module_t* m, int32_t exec_rc, sirj_ctx_t* c) {
+  (void)exec_rc;
+  (void)c;
+  sem_profile_ctx_t* p = (sem_profile_ctx_t*)user;
+  if (p->folded && !sem_profile_write_folded(p->prof, m, p->folded)) p->ok = false;
+  if (p->funcs && !sem_profile_write_funcs_jsonl(p->prof, m, p->funcs)) p->ok = false;
+}
+
+int sem_run_sir_jsonl_profile_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
+                                      const char* profile_out_path, const char* profile_funcs_out_path, uint32_t period) {
+  if (period == 0) period = SEM_PROFILE_DEFAULT_PERIOD;
+  sem_profile_ctx_t p = {.prof = sem_profile_new(period), .ok = true};
+  if (!p.prof) {
+    fprintf(stderr, "sem: out of memory\n");
+    return 2;
+  }
+  if (profile_out_path && profile_out_path[0]) {
+    p.folded = fopen(profile_out_path, "wb");
+    if (!p.folded) {
+      sem_profile_free(p.prof);
+      fprintf(stderr, "sem: failed to open profile output: %s\n", profile_out_path);
+      return 2;
+    }
+  }
+  if (profile_funcs_out_path && profile_funcs_out_path[0]) {
+    p.funcs = fopen(profile_funcs_out_path, "wb");
+    if (!p.funcs) {
+      if (p.folded) fclose(p.folded);
+      sem_profile_free(p.prof);
+      fprintf(stderr, "sem: failed to open profile output: %s\n", profile_funcs_out_path);
+      return 2;
+    }
+  }
+
+  const sir_exec_sampler_t sampler = sem_profile_sampler(p.prof);
+  int prog_rc = 0;
+  const int tool_rc =
+      sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, NULL, &sampler, NULL, sem_profile_post_run, &p);
+
+  if (p.folded && fclose(p.folded) != 0) p.ok = false;
+  if (p.funcs && fclose(p.funcs) != 0) p.ok = false;
+  sem_profile_free(p.prof);
+  if (!p.ok) {
+    fprintf(stderr, "sem: failed to write profile output\n");
+    if (tool_rc == 0) return 2;
+  }
+  if (tool_rc != 0) return tool_rc;
+  return prog_rc;
+}
+
+// Block/edge profile (`sem --run --profile-blocks-out`): entries per CFG
+// block, taken edges between blocks, and the arms taken by each term.cbr and
+// term.switch, keyed by SIR node ids. See docs/block_profile.md.
+//
+// A branch's target is always the next step of the same frame, so each step
+// resolves the branch before it. A term.cbr lowers to a cbr plus one br stub
+// per arm; both lie in the source block, so the edge still runs from it.
+#define SEM_BPROF_NONE 0xFFFFFFFFu
+
+typedef struct sem_bprof_edge {
+  uint32_t from; // block index
+  uint32_t to;
+  uint64_t count;
+} sem_bprof_edge_t;
+
+typedef struct sem_bprof_ctx {
+  FILE* out;
+  bool ok;
+  const sir_module_t* m;
+  uint32_t* func_off; // by fid - 1: slot of the function's first instruction
+  uint32_t* func_blk; // by fid - 1: index of the function's first block
+  uint32_t* slot_blk; // by slot: block holding the instruction, or NONE
+  uint32_t* slot_arm; // by slot: first arm counter of a cbr/switch, or NONE
+  uint64_t* blk_count;
+  uint64_t* arm_count; // cbr: then, else; switch: cases..., default
+  uint32_t block_total;
+  uint32_t arm_total;
+
+  sem_bprof_edge_t* edges;
+  uint32_t edge_count;
+  uint32_t edge_cap;
+  uint32_t* edge_slots; // open addressing: edge index + 1, 0 = empty
+  uint32_t edge_slot_cap;
+
+  // The previous step, when it was a branch.
+  uint32_t pend_slot;
+  uint32_t pend_ip;
+  uint32_t pend_blk;
+} sem_bprof_ctx_t;
+
+static void sem_bprof_dispose(sem_bprof_ctx_t* b) {
+  free(b->func_off);
+  free(b->func_blk);
+  free(b->slot_blk);
+  free(b->slot_arm);
+  free(b->blk_count);
+  free(b->arm_count);
+  free(b->edges);
+  free(b->edge_slots);
+}
+
+static bool sem_bprof_is_branch(sir_inst_kind_t k) { return k == SIR_INST_BR || k == SIR_INST_CBR || k == SIR_INST_SWITCH; }
+
+// Sizes the tables for m: one slot per instruction, one counter per block
+// and branch arm.
+static void sem_bprof_pre_run(void* user, const sir_module_t* m) {
+  sem_bprof_ctx_t* b = (sem_bprof_ctx_t*)user;
+  b->m = m;
+  b->pend_slot = SEM_BPROF_NONE;
+  b->pend_blk = SEM_BPROF_NONE;
+  const uint32_t fn = m->func_count;
+  b->func_off = (uint32_t*)calloc(fn ? fn : 1u, sizeof(uint32_t));
+  b->func_blk = (uint32_t*)calloc(fn ? fn : 1u, sizeof(uint32_t));
+  if (!b->func_off || !b->func_blk) {
+    b->ok = false;
+    return;
+  }
+  uint64_t slots = 0, blocks = 0, arms = 0;
+  for (uint32_t i = 0; i < fn; i++) {
+    const sir_func_t* f = &m->funcs[i];
+    b->func_off[i] = (uint32_t)slots;
+    b->func_blk[i] = (uint32_t)blocks;
+    slots += f->inst_count;
+    blocks += f->block_count;
+    for (uint32_t ip = 0; f->block_count && ip < f->inst_count; ip++) {
+      if (f->insts[ip].k == SIR_INST_CBR) arms += 2u;
+      if (f->insts[ip].k == SIR_INST_SWITCH) arms += (uint64_t)f->insts[ip].u.sw.case_count + 1u;
+    }
+    if (slots >= SEM_BPROF_NONE || blocks >= SEM_BPROF_NONE || arms >= SEM_BPROF_NONE) {
+      b->ok = false;
+      return;
+    }
+  }
+  b->slot_blk = (uint32_t*)malloc((size_t)(slots ? slots : 1u) * sizeof(uint32_t));
+  b->slot_arm = (uint32_t*)malloc((size_t)(slots ? slots : 1u) * sizeof(uint32_t));
+  b->blk_count = (uint64_t*)calloc((size_t)(blocks ? blocks : 1u), sizeof(uint64_t));
+  b->arm_count = (uint64_t*)calloc((size_t)(arms ? arms : 1u), sizeof(uint64_t));
+  if (!b->slot_blk || !b->slot_arm || !b->blk_count || !b->arm_count) {
+    b->ok = false;
+    return;
+  }
+  b->block_total = (uint32_t)blocks;
+  b->arm_total = (uint32_t)arms;
+  uint32_t arm = 0;
+  for (uint32_t i = 0; i < fn; i++) {
+    const sir_func_t* f = &m->funcs[i];
+    uint32_t bi = 0;
+    for (uint32_t ip = 0; ip < f->inst_count; ip++) {
+      const uint32_t slot = b->func_off[i] + ip;
+      while (bi < f->block_count && f->blocks[bi].ip <= ip) bi++;
+      b->slot_blk[slot] = bi ? b->func_blk[i] + bi - 1u : SEM_BPROF_NONE;
+      b->slot_arm[slot] = SEM_BPROF_NONE;
+      if (!f->block_count) continue;
+      if (f->insts[ip].k == SIR_INST_CBR) {
+        b->slot_arm[slot] = arm;
+        arm += 2u;
+      } else if (f->insts[ip].k == SIR_INST_SWITCH) {
+        b->slot_arm[slot] = arm;
+        arm += f->insts[ip].u.sw.case_count + 1u;
+      }
+    }
+  }
+}
+
+static uint64_t sem_bprof_edge_hash(uint32_t from, uint32_t to) { return (((uint64_t)from << 32) | to) * 0x9e3779b97f4a7c15ull; }
+
+static bool sem_bprof_edge_rehash(sem_bprof_ctx_t* b) {
+  const uint32_t cap = b->edge_slot_cap ? b->edge_slot_cap * 2u : 64u;
+  uint32_t* slots = (uint32_t*)calloc(cap, sizeof(uint32_t));
+  if (!slots) return false;
+  for (uint32_t i = 0; i < b->edge_count; i++) {
+    uint32_t h = (uint32_t)(sem_bprof_edge_hash(b->edges[i].from, b->edges[i].to) >> 32) & (cap - 1u);
+    while (slots[h]) h = (h + 1u) & (cap - 1u);
+    slots[h] = i + 1u;
+  }
+  free(b->edge_slots);
+  b->edge_slots = slots;
+  b->edge_slot_cap = cap;
+  return true;
+}
+
+static void sem_bprof_edge(sem_bprof_ctx_t* b, uint32_t from, uint32_t to) {
+  if ((b->edge_count + 1u) * 2u > b->edge_slot_cap && !sem_bprof_edge_rehash(b)) {
+    b->ok = false;
+    return;
+  }
+  uint32_t h = (uint32_t)(sem_bprof_edge_hash(from, to) >> 32) & (b->edge_slot_cap - 1u);
+  for (; b->edge_slots[h]; h = (h + 1u) & (b->edge_slot_cap - 1u)) {
+    sem_bprof_edge_t* e = &b->edges[b->edge_slots[h] - 1u];
+    if (e->from == from && e->to == to) {
+      e->count++;
+      return;
+    }
+  }
+  if (b->edge_count == b->edge_cap) {
+    const uint32_t cap = b->edge_cap ? b->edge_cap * 2u : 32u;
+    sem_bprof_edge_t* v = (sem_bprof_edge_t*)realloc(b->edges, (size_t)cap * sizeof(*v));
+    if (!v) {
+      b->ok = false;
+      return;
+    }
+    b->edges = v;
+    b->edge_cap = cap;
+  }
+  b->edges[b->edge_count] = (sem_bprof_edge_t){.from = from, .to = to, .count = 1};
+  b->edge_slots[h] = ++b->edge_count;
+}
+
+static void sem_bprof_on_step(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_inst_kind_t k) {
+  sem_bprof_ctx_t* b = (sem_bprof_ctx_t*)user;
+  if (!b->ok || m != b->m || fid == 0 || fid > m->func_count || ip >= m->funcs[fid - 1].inst_count) {
+    b->pend_slot = SEM_BPROF_NONE;
+    b->pend_blk = SEM_BPROF_NONE;
+    return;
+  }
+  const sir_func_t* f = &m->funcs[fid - 1];
+  const uint32_t slot = b->func_off[fid - 1] + ip;
+  const uint32_t blk = b->slot_blk[slot];
+
+  // Which arm did the previous branch take?
+  const uint32_t arm = b->pend_slot != SEM_BPROF_NONE ? b->slot_arm[b->pend_slot] : SEM_BPROF_NONE;
+  if (arm != SEM_BPROF_NONE) {
+    const sir_inst_t* br = &f->insts[b->pend_ip];
+    if (br->k == SIR_INST_CBR) {
+      b->arm_count[arm + (ip == br->u.cbr.then_ip ? 0u : 1u)]++;
+    } else {
+      // Cases sharing a target count on the first of them.
+      uint32_t ci = 0;
+      while (ci < br->u.sw.case_count && br->u.sw.case_target[ci] != ip) ci++;
+      b->arm_count[arm + ci]++;
+    }
+  }
+  if (blk != SEM_BPROF_NONE && f->blocks[blk - b->func_blk[fid - 1]].ip == ip) {
+    b->blk_count[blk]++;
+    if (b->pend_blk != SEM_BPROF_NONE) sem_bprof_edge(b, b->pend_blk, blk);
+  }
+
+  const bool branch = sem_bprof_is_branch(k);
+  b->pend_slot = branch ? slot : SEM_BPROF_NONE;
+  b->pend_ip = ip;
+  b->pend_blk = branch ? blk : SEM_BPROF_NONE;
+}
+
+// Writes `,"key":ID` with the node's source id (a number or a string).
+static void sem_write_src_id(FILE* out, const sirj_ctx_t* c, const char* key, uint32_t intern_id) {
+  bool is_num = false;
+  uint32_t num = 0;
+  const char* str = NULL;
+  if (!sirj_unintern_id(c, intern_id, &is_num, &num, &str)) {
+    fprintf(out, ",\"%s\":null", key);
+  } else if (is_num || !str) {
+    fprintf(out, ",\"%s\":%u", key, (unsigned)num);
+  } else {
+    fprintf(out, ",\"%s\":\"", key);
+    sem_json_write_escaped(out, str);
+    fputc('"', out);
+  }
+}
+
+static void sem_bprof_write_head(FILE* out, const char* k, const char* func) {
+  fprintf(out, "{\"tool\":\"sem\",\"k\":\"%s\",\"func\":\"", k);
+  sem_json_write_escaped(out, func);
+  fputc('"', out);
+}
+
+static int sem_bprof_edge_cmp(const void* a, const void* b) {
+  const sem_bprof_edge_t* x = (const sem_bprof_edge_t*)a;
+  const sem_bprof_edge_t* y = (const sem_bprof_edge_t*)b;
+  if (x->from != y->from) return x->from < y->from ? -1 : 1;
+  return (x->to > y->to) - (x->to < y->to);
+}
+
+static void sem_bprof_post_run(void* user, const sir_module_t* m, int32_t exec_rc, sirj_ctx_t* c) {
+  sem_bprof_ctx_t* b = (sem_bprof_ctx_t*)user;
+  if (!b->ok || !b->blk_count) {
+    b->ok = false;
+    return;
+  }
+  // A cached module skipped parsing; source ids come from the input.
+  if (c->ids.len == 0) (void)parse_file(c, c->cur_path);
+  if (b->edge_count) qsort(b->edges, b->edge_count, sizeof(*b->edges), sem_bprof_edge_cmp);
+
+  FILE* out = b->out;
+  fprintf(out, "{\"tool\":\"sem\",\"k\":\"block_profile\",\"format\":\"sir-cfg\",\"version\":1,\"exec_rc\":%d}\n", (int)exec_rc);
+  uint64_t entries = 0;
+  uint32_t branches = 0, e = 0;
+  for (uint32_t i = 0; i < m->func_count; i++) {
+    const sir_func_t* f = &m->funcs[i];
+    if (!f->block_count) continue;
+    const char* fn = f->name ? f->name : "";
+    const uint32_t first = b->func_blk[i];
+    for (uint32_t bi = 0; bi < f->block_count; bi++) {
+      sem_bprof_write_head(out, "bprof_block", fn);
+      sem_write_src_id(out, c, "block", f->blocks[bi].node_id);
+      fprintf(out, ",\"count\":%" PRIu64 "}\n", b->blk_count[first + bi]);
+      entries += b->blk_count[first + bi];
+    }
+    for (; e < b->edge_count && b->edges[e].from < first + f->block_count; e++) {
+      sem_bprof_write_head(out, "bprof_edge", fn);
+      sem_write_src_id(out, c, "from", f->blocks[b->edges[e].from - first].node_id);
+      sem_write_src_id(out, c, "to", f->blocks[b->edges[e].to - first].node_id);
+      fprintf(out, ",\"count\":%" PRIu64 "}\n", b->edges[e].count);
+    }
+    for (uint32_t ip = 0; ip < f->inst_count; ip++) {
+      const uint32_t slot = b->func_off[i] + ip;
+      const uint32_t arm = b->slot_arm[slot];
+      if (arm == SEM_BPROF_NONE || b->slot_blk[slot] == SEM_BPROF_NONE) continue;
+      const sir_inst_t* in = &f->insts[ip];
+      sem_bprof_write_head(out, in->k == SIR_INST_CBR ? "bprof_branch" : "bprof_switch", fn);
+      sem_write_src_id(out, c, "node", in->src_node_id);
+      sem_write_src_id(out, c, "block", f->blocks[b->slot_blk[slot] - first].node_id);
+      if (in->k == SIR_INST_CBR) {
+        fprintf(out, ",\"then\":%" PRIu64 ",\"else\":%" PRIu64 "}\n", b->arm_count[arm], b->arm_count[arm + 1u]);
+      } else {
+        fputs(",\"cases\":[", out);
+        for (uint32_t ci = 0; ci < in->u.sw.case_count; ci++) fprintf(out, "%s%" PRIu64, ci ? "," : "", b->arm_count[arm + ci]);
+        fprintf(out, "],\"default\":%" PRIu64 "}\n", b->arm_count[arm + in->u.sw.case_count]);
+      }
+      branches++;
+    }
+  }
+  fprintf(out, "{\"tool\":\"sem\",\"k\":\"bprof_summary\",\"blocks\":%u,\"edges\":%u,\"branches\":%u,\"block_entries\":%" PRIu64 "}\n",
+          (unsigned)b->block_total, (unsigned)b->edge_count, (unsigned)branches, entries);
+}
+
+int sem_run_sir_jsonl_block_profile_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
+                                            const char* profile_blocks_out_path) {
+  if (!profile_blocks_out_path || !profile_blocks_out_path[0]) {
+    fprintf(stderr, "sem: missing --profile-blocks-out path\n");
+    return 2;
+  }
+  sem_bprof_ctx_t b;
+  memset(&b, 0, sizeof(b));
+  b.ok = true;
+  b.out = fopen(profile_blocks_out_path, "wb");
+  if (!b.out) {
+    fprintf(stderr, "sem: failed to open block profile output: %s\n", profile_blocks_out_path);
+    return 2;
+  }
+  const sir_exec_event_sink_t sink = {.user = &b, .on_step = sem_bprof_on_step};
+  int prog_rc = 0;
+  const int tool_rc = sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, true, &prog_rc, &sink, NULL, sem_bprof_pre_run,
+                                                       sem_bprof_post_run, &b);
+  if (fclose(b.out) != 0) b.ok = false;
+  sem_bprof_dispose(&b);
+  if (tool_rc != 0) return tool_rc;
+  if (!b.ok) {
+    fprintf(stderr, "sem: failed to write block profile output: %s\n", profile_blocks_out_path);
+    return 2;
+  }
+  return prog_rc;
+}
+
 int sem_run_sir_jsonl_events_ex(const char* path, const sem_cap_t* caps, uint32_t cap_count, const char* fs_root, sem_diag_format_t diag_format,
                                 bool diag_all, const char* trace_jsonl_out_path, const char* coverage_jsonl_out_path, const char* trace_func_filter,
                                 const char* trace_op_filter) {
@@ -8887,5 +10110,5 @@ int sem_verify_sir_jsonl_ex(const char* path, sem_diag_format_t diag_format, boo
       .env = NULL,
       .env_count = 0,
   };
-  return sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, false, NULL, NULL, NULL, NULL);
+  return sem_run_or_verify_sir_jsonl_impl(path, host_cfg, diag_format, diag_all, false, NULL, NULL, NULL, NULL, NULL, NULL);
 }
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "sem_host.h"
 
@@ -22,8 +23,17 @@ typedef struct sem_run_host_cfg {
   bool env_enabled;
   const sem_env_kv_t* env;
   uint32_t env_count;
+
+  // Guest stdio streams; NULL uses the process streams.
+  FILE* std_in;
+  FILE* std_out;
+  FILE* std_err;
 } sem_run_host_cfg_t;
 
+// Redirects diagnostics printed by the calling thread to `f`; NULL restores
+// stderr. Lets concurrent runs collect their diagnostics separately.
+void sem_set_diag_out(FILE* f);
+
 // Parse a small SIR JSONL subset and run it under the hosted zABI runtime.
 // Returns process exit code (0..255-ish), or 1/2 for tool errors.
 int sem_run_sir_jsonl(const char* path, const sem_cap_t* caps, uint32_t cap_count, const char* fs_root);
@@ -59,6 +69,27 @@ int sem_run_sir_jsonl_events_host_ex(const char* path, sem_run_host_cfg_t host_c
                                     const char* trace_jsonl_out_path, const char* coverage_jsonl_out_path, const char* trace_func_filter,
                                     const char* trace_op_filter);
 
+// Like sem_run_sir_jsonl_events_host_ex, but can also record the trace in the
+// binary format (see sem_trace_bin.h) at trace_bin_out_path.
+int sem_run_sir_jsonl_events_bin_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
+                                         const char* trace_jsonl_out_path, const char* trace_bin_out_path, const char* coverage_jsonl_out_path,
+                                         const char* trace_func_filter, const char* trace_op_filter);
+
+// Instructions between call-stack samples when the caller passes 0.
+#define SEM_PROFILE_DEFAULT_PERIOD 997u
+
+// Run under the sampling profiler (see sem_profile.h). Writes folded stacks
+// to profile_out_path and/or per-function JSONL to profile_funcs_out_path
+// (NULL skips either). One sample is taken every `period` instructions.
+int sem_run_sir_jsonl_profile_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
+                                      const char* profile_out_path, const char* profile_funcs_out_path, uint32_t period);
+
+// Run and write the block/edge profile of the CFG-form functions (entries per
+// block, taken edges, term.cbr/term.switch arms) as JSONL; the format is
+// described in docs/block_profile.md.
+int sem_run_sir_jsonl_block_profile_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all,
+                                            const char* profile_blocks_out_path);
+
 // Like sem_run_sir_jsonl_capture_ex, but also configures argv/env snapshots.
 int sem_run_sir_jsonl_capture_host_ex(const char* path, sem_run_host_cfg_t host_cfg, sem_diag_format_t diag_format, bool diag_all, int* out_prog_rc);
 
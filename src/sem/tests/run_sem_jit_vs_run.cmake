@@ -0,0 +1,32 @@
+if(NOT DEFINED SEM OR SEM STREQUAL "")
+  message(FATAL_ERROR "run_sem_jit_vs_run: missing -DSEM")
+endif()
+if(NOT DEFINED INPUT OR INPUT STREQUAL "")
+  message(FATAL_ERROR "run_sem_jit_vs_run: missing -DINPUT")
+endif()
+
+execute_process(
+  COMMAND ${SEM} --run ${INPUT}
+  RESULT_VARIABLE rc_run
+  OUTPUT_VARIABLE out_run
+  ERROR_VARIABLE err_run
+)
+
+execute_process(
+  COMMAND ${SEM} --jit ${INPUT}
+  RESULT_VARIABLE rc_jit
+  OUTPUT_VARIABLE out_jit
+  ERROR_VARIABLE err_jit
+)
+
+if(NOT rc_run STREQUAL rc_jit)
+  message(STATUS "--run stderr:\n${err_run}")
+  message(STATUS "--jit stderr:\n${err_jit}")
+  message(FATAL_ERROR "exit codes differ: --run rc=${rc_run}, --jit rc=${rc_jit}")
+endif()
+
+if(NOT out_run STREQUAL out_jit)
+  message(STATUS "--run stdout:\n${out_run}")
+  message(STATUS "--jit stdout:\n${out_jit}")
+  message(FATAL_ERROR "stdout differs between --run and --jit")
+endif()
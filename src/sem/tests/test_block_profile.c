@@ -0,0 +1,94 @@
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // mkdtemp/setenv under -std=c11
+#endif
+
+#include "sir_jsonl.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#define FIXTURES SEM_SOURCE_DIR "/src/sem/tests/fixtures/"
+#define EXAMPLES SEM_SOURCE_DIR "/src/sircc/examples/"
+
+static char out_path[] = "/tmp/sem_block_profile_XXXXXX";
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+static bool read_file(const char* path, char* buf, size_t cap) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  const size_t n = fread(buf, 1, cap - 1, f);
+  fclose(f);
+  buf[n] = '\0';
+  return true;
+}
+
+static int run(const char* path, int want_rc, char* buf, size_t cap) {
+  const sem_run_host_cfg_t host = {0};
+  const int rc = sem_run_sir_jsonl_block_profile_host_ex(path, host, SEM_DIAG_TEXT, false, out_path);
+  if (rc != want_rc) {
+    fprintf(stderr, "sem_unit: %s: expected rc=%d got %d\n", path, want_rc, rc);
+    return 1;
+  }
+  return read_file(out_path, buf, cap) ? 0 : fail("failed to read the block profile");
+}
+
+static bool same(const char* got, const char* want) {
+  if (strcmp(got, want) == 0) return true;
+  fprintf(stderr, "sem_unit: block profile:\n%s\nwant:\n%s\n", got, want);
+  return false;
+}
+
+static char got[8192];
+static char first[8192];
+
+int main(void) {
+  const int fd = mkstemp(out_path);
+  if (fd < 0) return fail("mkstemp failed");
+  close(fd);
+
+  // i = 0; while (i < 5) i++; return i;
+  const char* loop = FIXTURES "cfg_loop_count.sir.jsonl";
+  int rc = run(loop, 5, got, sizeof(got));
+  if (!rc && !same(got,
+                   "{\"tool\":\"sem\",\"k\":\"block_profile\",\"format\":\"sir-cfg\",\"version\":1,\"exec_rc\":5}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_block\",\"func\":\"main\",\"block\":100,\"count\":1}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_block\",\"func\":\"main\",\"block\":101,\"count\":6}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_block\",\"func\":\"main\",\"block\":102,\"count\":5}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_block\",\"func\":\"main\",\"block\":103,\"count\":1}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_edge\",\"func\":\"main\",\"from\":100,\"to\":101,\"count\":1}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_edge\",\"func\":\"main\",\"from\":101,\"to\":102,\"count\":5}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_edge\",\"func\":\"main\",\"from\":101,\"to\":103,\"count\":1}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_edge\",\"func\":\"main\",\"from\":102,\"to\":101,\"count\":5}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_branch\",\"func\":\"main\",\"node\":32,\"block\":101,\"then\":5,\"else\":1}\n"
+                   "{\"tool\":\"sem\",\"k\":\"bprof_summary\",\"blocks\":4,\"edges\":4,\"branches\":1,\"block_entries\":13}\n")) {
+    rc = fail("unexpected loop profile");
+  }
+  if (!rc) memcpy(first, got, sizeof(got));
+
+  // Switch arms; blocks never entered are listed with a zero count.
+  if (!rc) rc = run(EXAMPLES "cfg_switch.sir.jsonl", 10, got, sizeof(got));
+  if (!rc && (!strstr(got, "{\"tool\":\"sem\",\"k\":\"bprof_switch\",\"func\":\"main\",\"node\":30,\"block\":200,\"cases\":[1,0],\"default\":0}\n") ||
+              !strstr(got, "\"block\":203,\"count\":0}\n"))) {
+    rc = fail("unexpected switch profile");
+  }
+
+  // A cached module keeps its block table and the source ids.
+  char dir[] = "/tmp/sem_block_profile_cache_XXXXXX";
+  if (!rc && (!mkdtemp(dir) || setenv("SEM_CACHE_DIR", dir, 1) != 0)) rc = fail("cache dir setup failed");
+  for (int i = 0; i < 2 && !rc; i++) {
+    rc = run(loop, 5, got, sizeof(got));
+    if (!rc && !same(got, first)) rc = fail("cached run changed the profile");
+  }
+  unsetenv("SEM_CACHE_DIR");
+
+  unlink(out_path);
+  return rc;
+}
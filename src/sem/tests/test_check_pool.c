@@ -0,0 +1,82 @@
+#include "sem_check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define EXAMPLES SEM_SOURCE_DIR "/src/sircc/examples/"
+#define FIXTURES SEM_SOURCE_DIR "/src/sem/tests/fixtures/"
+
+enum { ROUNDS = 4, KINDS = 5, CASES = ROUNDS * KINDS };
+
+static const char* const paths[KINDS] = {
+    FIXTURES "num_i64_f32_f64.sir.jsonl",
+    FIXTURES "call_direct_internal.sir.jsonl",
+    EXAMPLES "bad_cfg_br_args_mismatch.sir.jsonl",
+    EXAMPLES "fun_sym_call.sir.jsonl",
+    EXAMPLES "hello_zabi25_write.sir.jsonl",
+};
+static const int want_tool[KINDS] = {0, 0, 1, 0, 0};
+static const int want_prog[KINDS] = {42, 12, 0, 7, 0};
+static const char* const want_out[KINDS] = {"", "", "", "", "hello from zABI25\n"};
+
+typedef struct seen {
+  const sem_check_case_t* base;
+  uint32_t count;
+  uint32_t order[CASES];
+  bool diag[CASES];
+  bool out_ok[CASES];
+} seen_t;
+
+static void on_case(void* user, const sem_check_case_t* c) {
+  seen_t* s = (seen_t*)user;
+  const uint32_t i = (uint32_t)(c - s->base);
+  if (s->count < CASES) {
+    s->order[s->count] = i;
+    s->diag[s->count] = c->diag_len != 0;
+    const char* want = want_out[i % KINDS];
+    s->out_ok[s->count] = c->out_len == strlen(want) && (c->out_len == 0 || memcmp(c->out, want, c->out_len) == 0);
+  }
+  s->count++;
+}
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+static int check(bool do_run, uint32_t jobs) {
+  sem_check_case_t cases[CASES];
+  memset(cases, 0, sizeof(cases));
+  for (uint32_t i = 0; i < CASES; i++) cases[i].path = paths[i % KINDS];
+
+  seen_t s = {.base = cases};
+  const sem_check_cfg_t cfg = {
+      .do_run = do_run,
+      .diag_format = SEM_DIAG_JSON,
+      .jobs = jobs,
+      .on_case = on_case,
+      .user = &s,
+  };
+  (void)sem_check_run(cases, CASES, &cfg);
+
+  if (s.count != CASES) return fail("expected one report per case");
+  for (uint32_t i = 0; i < CASES; i++) {
+    const uint32_t k = i % KINDS;
+    if (s.order[i] != i) return fail("cases reported out of input order");
+    if (cases[i].tool_rc != want_tool[k]) return fail("unexpected tool rc");
+    if (do_run && want_tool[k] == 0 && cases[i].prog_rc != want_prog[k]) return fail("unexpected program rc");
+    if (cases[i].diag) return fail("captured diagnostics were not released");
+    // Concurrent runs hand their diagnostics over with the report.
+    if (jobs > 1 && s.diag[i] != (want_tool[k] != 0)) return fail("diagnostics not captured with their case");
+    if (jobs > 1 && do_run && !s.out_ok[i]) return fail("guest stdout not captured with its case");
+  }
+  return 0;
+}
+
+int main(void) {
+  if (check(true, 1)) return 1;
+  if (check(true, 4)) return 1;
+  if (check(false, 3)) return 1;
+  if (check(true, 64)) return 1;
+  return 0;
+}
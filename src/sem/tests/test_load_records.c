@@ -0,0 +1,120 @@
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // mkstemp/setenv under -std=c11
+#endif
+
+#include "sir_jsonl.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+// f64_cmp_olt_to_i32 with CRLF endings, blank lines and no final newline.
+static const char k_good[] =
+    "{\"ir\":\"sir-v1.0\",\"k\":\"meta\",\"producer\":\"sem-unit\",\"unit\":\"load_records\"}\r\n"
+    "\r\n"
+    "  \t\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"type\",\"id\":1,\"kind\":\"prim\",\"prim\":\"i32\"}\r\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"type\",\"id\":2,\"kind\":\"prim\",\"prim\":\"bool\"}\r\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"type\",\"id\":3,\"kind\":\"prim\",\"prim\":\"f64\"}\r\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"type\",\"id\":4,\"kind\":\"fn\",\"params\":[],\"ret\":1}\r\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":10,\"tag\":\"const.f64\",\"type_ref\":3,\"fields\":{\"bits\":\"0x3ff0000000000000\"}}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":11,\"tag\":\"const.f64\",\"type_ref\":3,\"fields\":{\"bits\":\"0x4000000000000000\"}}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":12,\"tag\":\"f64.cmp.olt\",\"type_ref\":2,\"fields\":{\"args\":[{\"t\":\"ref\",\"id\":10},{\"t\":\"ref\",\"id\":11}]}}\n"
+    "\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":13,\"tag\":\"const.i32\",\"type_ref\":1,\"fields\":{\"value\":1}}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":14,\"tag\":\"const.i32\",\"type_ref\":1,\"fields\":{\"value\":0}}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":15,\"tag\":\"select\",\"type_ref\":1,\"fields\":{\"args\":[{\"t\":\"ref\",\"id\":12},{\"t\":\"ref\",\"id\":13},{\"t\":\"ref\",\"id\":14}]}}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":16,\"tag\":\"term.ret\",\"fields\":{\"value\":{\"t\":\"ref\",\"id\":15}}}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":17,\"tag\":\"block\",\"fields\":{\"stmts\":[{\"t\":\"ref\",\"id\":16}]}}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"node\",\"id\":18,\"tag\":\"fn\",\"type_ref\":4,\"fields\":{\"name\":\"main\",\"params\":[],\"body\":{\"t\":\"ref\",\"id\":17}}}";
+
+// The third record is truncated; records after it parse fine.
+static const char k_bad[] =
+    "{\"ir\":\"sir-v1.0\",\"k\":\"meta\",\"producer\":\"sem-unit\",\"unit\":\"load_records_bad\"}\n"
+    "\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"type\",\"id\":1,\"kind\":\"prim\",\"prim\":\"i32\"}\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"type\",\"id\":2,\"kind\":\n"
+    "{\"ir\":\"sir-v1.0\",\"k\":\"type\",\"id\":3,\"kind\":\"prim\",\"prim\":\"f64\"}\n";
+
+static bool write_tmp(char* path, const char* text) {
+  const int fd = mkstemp(path);
+  if (fd < 0) return false;
+  const size_t n = strlen(text);
+  const bool ok = write(fd, text, n) == (ssize_t)n;
+  close(fd);
+  return ok;
+}
+
+static bool file_read_line(const char* path, char* buf, size_t cap) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  const bool ok = (fgets(buf, (int)cap, f) != NULL);
+  fclose(f);
+  return ok;
+}
+
+// Verifies k_bad with diagnostics redirected to a file; returns the first line.
+static bool verify_bad(const char* input, char* line, size_t cap) {
+  char diag_path[] = "/tmp/sem_load_records_diag_XXXXXX";
+  const int dfd = mkstemp(diag_path);
+  if (dfd < 0) return false;
+  const int saved_stderr = dup(STDERR_FILENO);
+  if (saved_stderr < 0 || dup2(dfd, STDERR_FILENO) < 0) {
+    if (saved_stderr >= 0) close(saved_stderr);
+    close(dfd);
+    unlink(diag_path);
+    return false;
+  }
+  close(dfd);
+  const int rc = sem_verify_sir_jsonl_ex(input, SEM_DIAG_JSON, false);
+  fflush(stderr);
+  (void)dup2(saved_stderr, STDERR_FILENO);
+  close(saved_stderr);
+  const bool ok = rc == 1 && file_read_line(diag_path, line, cap);
+  unlink(diag_path);
+  return ok;
+}
+
+int main(void) {
+  char good[] = "/tmp/sem_load_records_good_XXXXXX";
+  char bad[] = "/tmp/sem_load_records_bad_XXXXXX";
+  if (!write_tmp(good, k_good) || !write_tmp(bad, k_bad)) return fail("failed to write inputs");
+
+  // Serial, then forced onto worker threads: same program, same result.
+  const char* const threads[] = {"1", "3"};
+  for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+    setenv("SEM_PARSE_THREADS", threads[i], 1);
+    const int rc = sem_run_sir_jsonl(good, NULL, 0, NULL);
+    if (rc != 1) {
+      fprintf(stderr, "sem_unit: SEM_PARSE_THREADS=%s expected rc=1 got rc=%d\n", threads[i], rc);
+      unlink(good);
+      unlink(bad);
+      return fail("unexpected return code");
+    }
+
+    // The parse error names the first bad record (blank lines do not count).
+    char line[4096];
+    if (!verify_bad(bad, line, sizeof(line))) {
+      unlink(good);
+      unlink(bad);
+      return fail("expected verify to fail with a diagnostic");
+    }
+    if (strstr(line, "\"code\":\"sem.parse.json\"") == NULL || strstr(line, "\"line\":3") == NULL) {
+      fprintf(stderr, "sem_unit: got diag %s", line);
+      unlink(good);
+      unlink(bad);
+      return fail("expected sem.parse.json at record 3");
+    }
+  }
+  unlink(good);
+  unlink(bad);
+  return 0;
+}
@@ -0,0 +1,97 @@
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // mkdtemp/setenv under -std=c11
+#endif
+
+#include "sir_jsonl.h"
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#define FIXTURES SEM_SOURCE_DIR "/src/sem/tests/fixtures/"
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+// Finds the one cache entry in dir other than `skip` (may be NULL).
+static bool find_entry(const char* dir, const char* skip, char* out, size_t cap) {
+  DIR* d = opendir(dir);
+  if (!d) return false;
+  uint32_t n = 0;
+  struct dirent* e;
+  while ((e = readdir(d)) != NULL) {
+    const size_t len = strlen(e->d_name);
+    if (len < 5 || strcmp(e->d_name + len - 5, ".sirm") != 0) continue;
+    if (skip && strcmp(e->d_name, skip) == 0) continue;
+    (void)snprintf(out, cap, "%s", e->d_name);
+    n++;
+  }
+  closedir(d);
+  return n == 1;
+}
+
+static bool copy_file(const char* from, const char* to) {
+  FILE* in = fopen(from, "rb");
+  FILE* out = in ? fopen(to, "wb") : NULL;
+  bool ok = in && out;
+  char buf[4096];
+  size_t n;
+  while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0) ok = fwrite(buf, 1, n, out) == n;
+  if (in) fclose(in);
+  if (out) ok = (fclose(out) == 0) && ok;
+  return ok;
+}
+
+int main(void) {
+  char root[] = "/tmp/sem_cache_XXXXXX";
+  if (!mkdtemp(root)) return fail("mkdtemp failed");
+  char dir[64];
+  (void)snprintf(dir, sizeof(dir), "%s/cache", root);
+  if (setenv("SEM_CACHE_DIR", dir, 1) != 0) return fail("setenv failed");
+
+  // A miss builds the module and stores it (creating the directory); a hit
+  // gives the same result.
+  int rc = sem_run_sir_jsonl(FIXTURES "num_i64_f32_f64.sir.jsonl", NULL, 0, NULL);
+  if (rc != 42) return fail("first run: expected rc=42");
+  char a[128];
+  if (!find_entry(dir, NULL, a, sizeof(a))) return fail("expected one cache entry after the first run");
+  rc = sem_run_sir_jsonl(FIXTURES "num_i64_f32_f64.sir.jsonl", NULL, 0, NULL);
+  if (rc != 42) return fail("cached run: expected rc=42");
+  if (sem_verify_sir_jsonl(FIXTURES "num_i64_f32_f64.sir.jsonl", SEM_DIAG_TEXT) != 0) return fail("cached verify failed");
+
+  // A second input gets its own entry.
+  rc = sem_run_sir_jsonl(SEM_SOURCE_DIR "/src/sircc/examples/fun_sym_call.sir.jsonl", NULL, 0, NULL);
+  if (rc != 7) return fail("second input: expected rc=7");
+  char b[128];
+  if (!find_entry(dir, a, b, sizeof(b))) return fail("expected a second cache entry");
+
+  // Hits really come from the cache: with b's image under a's name, running
+  // the first input runs the second module.
+  char pa[256];
+  char pb[256];
+  (void)snprintf(pa, sizeof(pa), "%s/%s", dir, a);
+  (void)snprintf(pb, sizeof(pb), "%s/%s", dir, b);
+  if (!copy_file(pb, pa)) return fail("copy failed");
+  rc = sem_run_sir_jsonl(FIXTURES "num_i64_f32_f64.sir.jsonl", NULL, 0, NULL);
+  if (rc != 7) return fail("swapped entry: expected the cached module to run");
+
+  // A damaged entry is ignored and rewritten.
+  FILE* f = fopen(pa, "wb");
+  if (!f || fputs("not a module image", f) < 0 || fclose(f) != 0) return fail("failed to damage entry");
+  rc = sem_run_sir_jsonl(FIXTURES "num_i64_f32_f64.sir.jsonl", NULL, 0, NULL);
+  if (rc != 42) return fail("damaged entry: expected a rebuild with rc=42");
+  rc = sem_run_sir_jsonl(FIXTURES "num_i64_f32_f64.sir.jsonl", NULL, 0, NULL);
+  if (rc != 42) return fail("rewritten entry: expected rc=42");
+
+  (void)unlink(pa);
+  (void)unlink(pb);
+  (void)rmdir(dir);
+  (void)rmdir(root);
+  return 0;
+}
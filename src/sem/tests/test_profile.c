@@ -0,0 +1,91 @@
+#include "sir_jsonl.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#define FIXTURES SEM_SOURCE_DIR "/src/sem/tests/fixtures/"
+#define EXAMPLES SEM_SOURCE_DIR "/src/sircc/examples/"
+
+static char folded_path[] = "/tmp/sem_profile_folded_XXXXXX";
+static char funcs_path[] = "/tmp/sem_profile_funcs_XXXXXX";
+static char trace_path[] = "/tmp/sem_profile_trace_XXXXXX";
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+static bool make_tmp(char* path) {
+  const int fd = mkstemp(path);
+  if (fd < 0) return false;
+  close(fd);
+  return true;
+}
+
+static bool file_is(const char* path, const char* want) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char buf[4096];
+  const size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+  fclose(f);
+  buf[n] = '\0';
+  if (strcmp(buf, want) == 0) return true;
+  fprintf(stderr, "sem_unit: %s:\n%s\nwant:\n%s\n", path, buf, want);
+  return false;
+}
+
+static unsigned count_lines(const char* path, const char* needle) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return 0;
+  char line[512];
+  unsigned n = 0;
+  while (fgets(line, sizeof(line), f) != NULL) n += strstr(line, needle) != NULL;
+  fclose(f);
+  return n;
+}
+
+static int run(const char* path, uint32_t period, int want_rc) {
+  const sem_run_host_cfg_t host = {0};
+  const int rc = sem_run_sir_jsonl_profile_host_ex(path, host, SEM_DIAG_TEXT, false, folded_path, funcs_path, period);
+  if (rc == want_rc) return 0;
+  fprintf(stderr, "sem_unit: %s: expected rc=%d got %d\n", path, want_rc, rc);
+  return 1;
+}
+
+int main(void) {
+  if (!make_tmp(folded_path) || !make_tmp(funcs_path) || !make_tmp(trace_path)) return fail("mkstemp failed");
+
+  int rc = 0;
+  // Sampling every instruction gives exact counts.
+  if (!rc) rc = run(FIXTURES "call_direct_internal.sir.jsonl", 1, 12);
+  if (!rc && !file_is(folded_path, "main 4\nmain;add 2\n")) rc = fail("unexpected folded stacks");
+  if (!rc && !file_is(funcs_path,
+                      "{\"tool\":\"sem\",\"k\":\"profile_func\",\"fid\":2,\"func\":\"main\",\"self\":4,\"total\":6,\"self_samples\":4,\"total_samples\":6}\n"
+                      "{\"tool\":\"sem\",\"k\":\"profile_func\",\"fid\":1,\"func\":\"add\",\"self\":2,\"total\":2,\"self_samples\":2,\"total_samples\":2}\n"
+                      "{\"tool\":\"sem\",\"k\":\"profile_summary\",\"period\":1,\"samples\":6,\"insts\":6,\"stacks\":2,\"complete\":true}\n")) {
+    rc = fail("unexpected per-function profile");
+  }
+
+  // Samples land every `period` traced steps.
+  const char* loop = EXAMPLES "sem_while_global_counter.sir.jsonl";
+  const sem_run_host_cfg_t host = {0};
+  if (!rc && sem_run_sir_jsonl_events_host_ex(loop, host, SEM_DIAG_TEXT, false, trace_path, NULL, NULL, NULL) != 3) rc = fail("trace run failed");
+  const unsigned steps = rc ? 0 : count_lines(trace_path, "\"k\":\"trace_step\"");
+  if (!rc && steps < 20) rc = fail("expected a longer loop");
+  if (!rc) rc = run(loop, 5, 3);
+  if (!rc) {
+    char want[128];
+    (void)snprintf(want, sizeof(want), "\"samples\":%u,\"insts\":%u,", steps / 5u, steps / 5u * 5u);
+    if (count_lines(funcs_path, want) != 1) rc = fail("sample count does not match the step count");
+  }
+  if (!rc && count_lines(folded_path, "main;") < 2) rc = fail("callee stacks missing");
+
+  unlink(folded_path);
+  unlink(funcs_path);
+  unlink(trace_path);
+  return rc;
+}
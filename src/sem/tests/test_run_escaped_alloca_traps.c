@@ -0,0 +1,20 @@
+#include "sir_jsonl.h"
+
+#include <stdio.h>
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+int main(void) {
+  // `leak` returns the address of its own alloca. Its frame's stack space is
+  // reclaimed on return, so main's load through it fails with ZI_E_BOUNDS
+  // (a tool failure) instead of reading back the stale 42.
+  const int rc = sem_run_sir_jsonl(SEM_SOURCE_DIR "/src/sem/tests/fixtures/escaped_alloca_traps.sir.jsonl", NULL, 0, NULL);
+  if (rc != 1) {
+    fprintf(stderr, "sem_unit: expected rc=1 got rc=%d\n", rc);
+    return fail("unexpected return code");
+  }
+  return 0;
+}
@@ -0,0 +1,18 @@
+#include "sir_jsonl.h"
+
+#include <stdio.h>
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+int main(void) {
+  const int rc = sem_run_sir_jsonl(SEM_SOURCE_DIR "/src/sem/tests/fixtures/num_i64_f32_f64.sir.jsonl", NULL, 0, NULL);
+  if (rc != 42) {
+    fprintf(stderr, "sem_unit: expected rc=42 got rc=%d\n", rc);
+    return fail("unexpected return code");
+  }
+  return 0;
+}
+
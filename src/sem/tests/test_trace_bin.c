@@ -0,0 +1,186 @@
+#include "sem_trace_bin.h"
+#include "sir_jsonl.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#define EXAMPLES SEM_SOURCE_DIR "/src/sircc/examples/"
+#define FIXTURES SEM_SOURCE_DIR "/src/sem/tests/fixtures/"
+
+static char jsonl_path[] = "/tmp/sem_trace_bin_jsonl_XXXXXX";
+static char bin_path[] = "/tmp/sem_trace_bin_bin_XXXXXX";
+static char conv_path[] = "/tmp/sem_trace_bin_conv_XXXXXX";
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+static bool make_tmp(char* path) {
+  const int fd = mkstemp(path);
+  if (fd < 0) return false;
+  close(fd);
+  return true;
+}
+
+static char* slurp(const char* path, size_t* out_len) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return NULL;
+  char* buf = NULL;
+  size_t len = 0, cap = 0;
+  for (;;) {
+    if (len == cap) {
+      cap = cap ? cap * 2 : 4096;
+      char* nb = (char*)realloc(buf, cap);
+      if (!nb) break;
+      buf = nb;
+    }
+    const size_t n = fread(buf + len, 1, cap - len, f);
+    if (n == 0) break;
+    len += n;
+  }
+  fclose(f);
+  *out_len = len;
+  return buf;
+}
+
+// Converts bin_path (optionally cut to keep bytes) into conv_path.
+static bool convert(size_t keep) {
+  const char* in = bin_path;
+  char cut_path[] = "/tmp/sem_trace_bin_cut_XXXXXX";
+  if (keep) {
+    size_t len = 0;
+    char* bytes = slurp(bin_path, &len);
+    if (!bytes || !make_tmp(cut_path)) {
+      free(bytes);
+      return false;
+    }
+    FILE* f = fopen(cut_path, "wb");
+    if (f) {
+      (void)fwrite(bytes, 1, keep < len ? keep : len, f);
+      fclose(f);
+    }
+    free(bytes);
+    in = cut_path;
+  }
+  FILE* out = fopen(conv_path, "wb");
+  if (!out) return false;
+  const bool ok = sem_tbin_to_jsonl(in, out);
+  fclose(out);
+  if (keep) unlink(cut_path);
+  return ok;
+}
+
+static int check(const char* path, const char* func, const char* op, int want_rc, bool want_events) {
+  const sem_run_host_cfg_t host = {0};
+  const int rc_json = sem_run_sir_jsonl_events_host_ex(path, host, SEM_DIAG_TEXT, false, jsonl_path, NULL, func, op);
+  const int rc_bin = sem_run_sir_jsonl_events_bin_host_ex(path, host, SEM_DIAG_TEXT, false, NULL, bin_path, NULL, func, op);
+  if (rc_json != want_rc || rc_bin != want_rc) {
+    fprintf(stderr, "sem_unit: %s: expected rc=%d got %d/%d\n", path, want_rc, rc_json, rc_bin);
+    return fail("unexpected return code");
+  }
+  if (!convert(0)) return fail("binary trace did not convert");
+
+  size_t want_len = 0, got_len = 0, bin_len = 0;
+  char* want = slurp(jsonl_path, &want_len);
+  char* got = slurp(conv_path, &got_len);
+  char* bin = slurp(bin_path, &bin_len);
+  int rc = 0;
+  if (!want || !got || !bin) {
+    rc = fail("failed to read trace outputs");
+  } else if (want_events != (want_len != 0)) {
+    rc = fail("unexpected trace volume");
+  } else if (want_len != got_len || memcmp(want, got, want_len) != 0) {
+    fprintf(stderr, "sem_unit: %s: converted trace differs from --trace-jsonl-out\n", path);
+    rc = 1;
+  } else if (want_len && bin_len >= want_len) {
+    rc = fail("binary trace is not compact");
+  } else if (want_len && convert(bin_len - 1)) {
+    // Every record is at least three bytes, so dropping one always cuts one.
+    rc = fail("truncated trace converted without error");
+  } else if (want_len) {
+    size_t part_len = 0;
+    char* part = slurp(conv_path, &part_len);
+    if (!part || part_len >= want_len || memcmp(part, want, part_len) != 0) rc = fail("truncated trace lost earlier records");
+    free(part);
+  }
+  free(want);
+  free(got);
+  free(bin);
+  return rc;
+}
+
+// Pushes enough events through the writer to wrap its ring several times.
+static int stress(void) {
+  enum { EVENTS = 3000000 };
+  sem_tbin_writer_t* w = sem_tbin_writer_open(bin_path);
+  if (!w) return fail("failed to open binary trace");
+  for (uint32_t i = 0; i < EVENTS; i++) {
+    const uint32_t ip = (i * 7u) % 1000u;
+    if (i % 3u == 0) {
+      sem_tbin_step(w, NULL, 1u + (i % 5u), ip, (sir_inst_kind_t)(i % SIR_INST_KIND_COUNT));
+    } else if (i % 3u == 1) {
+      sem_tbin_mem(w, NULL, 1, ip, (i & 4u) ? SIR_MEM_WRITE : SIR_MEM_READ, (zi_ptr_t)i * 4099u, i % 9u);
+    } else {
+      sem_tbin_hostcall(w, NULL, 2, ip, (i & 8u) ? "zi_write" : "zi_read", (int32_t)(i % 7u) - 3);
+    }
+  }
+  if (!sem_tbin_writer_close(w)) return fail("binary trace write failed");
+  if (!convert(0)) return fail("stress trace did not convert");
+
+  FILE* f = fopen(conv_path, "rb");
+  if (!f) return fail("failed to open converted trace");
+  char line[256];
+  char want[256];
+  uint32_t i = 0;
+  for (; fgets(line, sizeof(line), f) != NULL; i++) {
+    const uint32_t ip = (i * 7u) % 1000u;
+    if (i % 3u == 0) {
+      (void)snprintf(want, sizeof(want), "{\"tool\":\"sem\",\"k\":\"trace_step\",\"fid\":%u,\"func\":\"\",\"ip\":%u,\"op\":\"%s\"}\n",
+                     1u + (i % 5u), ip, sir_inst_kind_name((sir_inst_kind_t)(i % SIR_INST_KIND_COUNT)));
+    } else if (i % 3u == 1) {
+      (void)snprintf(want, sizeof(want), "{\"tool\":\"sem\",\"k\":\"trace_mem\",\"fid\":1,\"func\":\"\",\"ip\":%u,\"kind\":\"%s\",\"addr\":%llu,\"size\":%u}\n",
+                     ip, (i & 4u) ? "w" : "r", (unsigned long long)i * 4099u, i % 9u);
+    } else {
+      (void)snprintf(want, sizeof(want), "{\"tool\":\"sem\",\"k\":\"trace_hostcall\",\"fid\":2,\"func\":\"\",\"ip\":%u,\"callee\":\"%s\",\"rc\":%d}\n", ip,
+                     (i & 8u) ? "zi_write" : "zi_read", (int)(i % 7u) - 3);
+    }
+    if (strcmp(line, want) != 0) break;
+  }
+  fclose(f);
+  if (i != EVENTS) {
+    fprintf(stderr, "sem_unit: stress trace diverged at event %u\n", (unsigned)i);
+    return 1;
+  }
+  return 0;
+}
+
+int main(void) {
+  if (!make_tmp(jsonl_path) || !make_tmp(bin_path) || !make_tmp(conv_path)) return fail("mkstemp failed");
+
+  int rc = 0;
+  if (!rc) rc = check(EXAMPLES "cfg_if.sir.jsonl", NULL, NULL, 111, true);
+  if (!rc) rc = check(EXAMPLES "mem_copy_fill.sir.jsonl", NULL, NULL, 42, true);
+  if (!rc) rc = check(EXAMPLES "hello_zabi25_write.sir.jsonl", NULL, NULL, 0, true);
+  if (!rc) rc = check(FIXTURES "call_direct_internal.sir.jsonl", NULL, NULL, 12, true);
+  if (!rc) rc = check(FIXTURES "call_direct_internal.sir.jsonl", "main", NULL, 12, true);
+  if (!rc) rc = check(EXAMPLES "cfg_if.sir.jsonl", NULL, "term.cbr", 111, true);
+  if (!rc) rc = check(EXAMPLES "cfg_if.sir.jsonl", "no_such_func", NULL, 111, false);
+  if (!rc) rc = stress();
+
+  FILE* f = fopen(bin_path, "wb");
+  if (f) {
+    fputs("NOTATRACE", f);
+    fclose(f);
+  }
+  if (!rc && convert(0)) rc = fail("garbage converted without error");
+
+  unlink(jsonl_path);
+  unlink(bin_path);
+  unlink(conv_path);
+  return rc;
+}
@@ -0,0 +1,109 @@
+#include "sir_jsonl.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#define FIXTURES SEM_SOURCE_DIR "/src/sem/tests/fixtures/"
+#define EXAMPLES SEM_SOURCE_DIR "/src/sircc/examples/"
+
+static char trace_path[] = "/tmp/sem_trace_filter_XXXXXX";
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sem_unit: %s\n", msg);
+  return 1;
+}
+
+typedef struct trace {
+  char lines[512][256];
+  uint32_t count;
+} trace_t;
+
+static bool run(const char* path, const char* func, const char* op, sem_diag_format_t diag, int want_rc, trace_t* out) {
+  const sem_run_host_cfg_t host = {0};
+  const int rc = sem_run_sir_jsonl_events_host_ex(path, host, diag, false, trace_path, NULL, func, op);
+  if (rc != want_rc) {
+    fprintf(stderr, "sem_unit: %s: expected rc=%d got %d\n", path, want_rc, rc);
+    return false;
+  }
+  FILE* f = fopen(trace_path, "rb");
+  if (!f) return false;
+  out->count = 0;
+  while (out->count < 512 && fgets(out->lines[out->count], sizeof(out->lines[0]), f) != NULL) out->count++;
+  fclose(f);
+  return true;
+}
+
+static bool same(const trace_t* a, const trace_t* b) {
+  if (a->count != b->count) return false;
+  for (uint32_t i = 0; i < a->count; i++) {
+    if (strcmp(a->lines[i], b->lines[i]) != 0) return false;
+  }
+  return true;
+}
+
+// Lines of `all` that contain any of the needles, in order.
+static void select_lines(const trace_t* all, const char* const* needles, uint32_t n, trace_t* out) {
+  out->count = 0;
+  for (uint32_t i = 0; i < all->count; i++) {
+    for (uint32_t j = 0; j < n; j++) {
+      if (strstr(all->lines[i], needles[j])) {
+        memcpy(out->lines[out->count++], all->lines[i], sizeof(all->lines[i]));
+        break;
+      }
+    }
+  }
+}
+
+static trace_t all, got, want;
+
+int main(void) {
+  const int fd = mkstemp(trace_path);
+  if (fd < 0) return fail("mkstemp failed");
+  close(fd);
+
+  const char* calls = FIXTURES "call_direct_internal.sir.jsonl";
+  int rc = 0;
+  if (!run(calls, NULL, NULL, SEM_DIAG_TEXT, 12, &all) || all.count == 0) rc = fail("unfiltered run failed");
+
+  // One function, by exact name: callee events only.
+  const char* add[] = {"\"func\":\"add\""};
+  select_lines(&all, add, 1, &want);
+  if (!rc && (!run(calls, "add", NULL, SEM_DIAG_TEXT, 12, &got) || want.count == 0 || !same(&got, &want))) rc = fail("exact function filter");
+  // JSON diagnostics keep every function instrumented; the trace must not change.
+  if (!rc && (!run(calls, "add", NULL, SEM_DIAG_JSON, 12, &got) || !same(&got, &want))) rc = fail("function filter with json diagnostics");
+  // Globs and lists.
+  if (!rc && (!run(calls, "ma*,add", NULL, SEM_DIAG_TEXT, 12, &got) || !same(&got, &all))) rc = fail("function glob list");
+  if (!rc && (!run(calls, "?dd", NULL, SEM_DIAG_TEXT, 12, &got) || !same(&got, &want))) rc = fail("function glob");
+  if (!rc && (!run(calls, "nope*", NULL, SEM_DIAG_TEXT, 12, &got) || got.count != 0)) rc = fail("function filter matching nothing");
+
+  // Op classes and lists (step records only).
+  const char* term[] = {"\"op\":\"term."};
+  select_lines(&all, term, 1, &want);
+  if (!rc && (!run(calls, NULL, "@term", SEM_DIAG_TEXT, 12, &got) || want.count == 0 || !same(&got, &want))) rc = fail("op class");
+  const char* mixed[] = {"\"op\":\"i32.add\"", "\"op\":\"call."};
+  select_lines(&all, mixed, 2, &want);
+  if (!rc && (!run(calls, NULL, "i32.add,@call", SEM_DIAG_TEXT, 12, &got) || want.count < 2 || !same(&got, &want))) rc = fail("op list");
+  trace_t* add_all = &got;
+  select_lines(&all, add, 1, add_all);
+  select_lines(add_all, term, 1, &want);
+  if (!rc && (!run(calls, "add", "term.*", SEM_DIAG_TEXT, 12, &got) || want.count == 0 || !same(&got, &want))) rc = fail("function and op filters");
+
+  // The op filter only applies to step records; memory events stay.
+  const char* mem = EXAMPLES "mem_copy_fill.sir.jsonl";
+  if (!rc && (!run(mem, NULL, NULL, SEM_DIAG_TEXT, 42, &all) || all.count == 0)) rc = fail("unfiltered memory run failed");
+  const char* mem_lines[] = {"\"k\":\"trace_mem\""};
+  select_lines(&all, mem_lines, 1, &want);
+  if (!rc && (!run(mem, "*", "@const", SEM_DIAG_TEXT, 42, &got) || want.count == 0)) rc = fail("memory run failed");
+  trace_t* mem_got = &all;
+  if (!rc) {
+    select_lines(&got, mem_lines, 1, mem_got);
+    if (!same(mem_got, &want)) rc = fail("op filter dropped memory events");
+  }
+
+  unlink(trace_path);
+  return rc;
+}
@@ -26,8 +26,18 @@ int sircc_compile(const SirccOptions* opt) {
   arena_init(&p.arena);
   sir_idmaps_init(&p);
   char* owned_triple = NULL;
+  bool ok = false;
 
-  bool ok = parse_program(&p, opt, opt->input_path);
+  if (opt->profile_use_path && opt->emit == SIRCC_EMIT_ZASM_IR) {
+    err_codef(&p, "sircc.profile.emit_unsupported", "sircc: --profile-use requires an LLVM backend (not --emit-zasm)");
+    goto done;
+  }
+  if (opt->opt_level != SIRCC_OPT_DEFAULT && opt->emit == SIRCC_EMIT_ZASM_IR) {
+    err_codef(&p, "sircc.opt.emit_unsupported", "sircc: -O0..-O3/-Os require an LLVM backend (not --emit-zasm)");
+    goto done;
+  }
+
+  ok = parse_program(&p, opt, opt->input_path);
   if (!ok) goto done;
 
   ok = validate_program(&p);
@@ -136,6 +146,11 @@ int sircc_compile(const SirccOptions* opt) {
   p.cur_loc.line = 0;
   p.cur_loc.col = 0;
 
+  if (opt->profile_use_path && !load_profile(&p, opt->profile_use_path)) {
+    ok = false;
+    goto done;
+  }
+
   if (!use_triple) {
     owned_triple = LLVMGetDefaultTargetTriple();
     use_triple = owned_triple;
@@ -168,6 +183,13 @@ int sircc_compile(const SirccOptions* opt) {
     goto done;
   }
 
+  if (!optimize_module(&p, mod, use_triple)) {
+    LLVMDisposeModule(mod);
+    LLVMContextDispose(ctx);
+    ok = false;
+    goto done;
+  }
+
   if (opt->emit == SIRCC_EMIT_LLVM_IR) {
     ok = emit_module_ir(&p, mod, opt->output_path);
     LLVMDisposeModule(mod);
@@ -210,6 +232,7 @@ int sircc_compile(const SirccOptions* opt) {
 
 done:
   if (owned_triple) LLVMDisposeMessage(owned_triple);
+  free_profile(&p);
   free(p.srcs);
   free(p.syms);
   free(p.types);
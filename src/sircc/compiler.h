@@ -5,6 +5,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef enum SirccEmitKind {
   SIRCC_EMIT_EXE = 0,
@@ -37,6 +38,15 @@ typedef enum SirccRuntimeKind {
   SIRCC_RUNTIME_ZABI25 = 1,
 } SirccRuntimeKind;
 
+typedef enum SirccOptLevel {
+  SIRCC_OPT_DEFAULT = 0, // no -O flag: no IR pipeline, default codegen level
+  SIRCC_OPT_O0,
+  SIRCC_OPT_O1,
+  SIRCC_OPT_O2,
+  SIRCC_OPT_O3,
+  SIRCC_OPT_OS,
+} SirccOptLevel;
+
 typedef struct SirccOptions {
   const char* argv0; // optional; used for best-effort path inference
   const char* const* prelude_paths; // optional; JSONL files parsed before input_path
@@ -49,6 +59,8 @@ typedef struct SirccOptions {
   SirccRuntimeKind runtime;
   const char* zabi25_root; // optional; default probes repo and dist paths
   const char* zasm_map_path; // optional; when emitting zasm, write a sidecar id map JSONL
+  const char* profile_use_path; // optional; sem block profile (sem --profile-blocks-out) for branch weights
+  SirccOptLevel opt_level; // LLVM IR pipeline + codegen level (-O0..-O3, -Os)
   bool lower_hl;            // run SIR-HL→Core legalization and exit (no codegen)
   const char* emit_sir_core_path; // required when lower_hl=true
   bool lower_strict; // tighten lowering/verification rules (implies verify_strict)
@@ -66,4 +78,16 @@ typedef struct SirccOptions {
 } SirccOptions;
 
 int sircc_compile(const SirccOptions* opt);
+
+// Host function bound to an imported (`decl.fn`) name when JIT-compiling.
+typedef struct SirccJitSymbol {
+  const char* name;
+  uint64_t addr;
+} SirccJitSymbol;
+
+// Compiles opt->input_path in-process with ORC LLJIT and calls its entry fn
+// (`zir_main` or `main`, no params). No objects are written and no external
+// tools run. Only `imports` resolve: any other external symbol fails the link.
+// The entry's integer result (0 for void) is stored in *out_ret.
+int sircc_jit_run(const SirccOptions* opt, const SirccJitSymbol* imports, size_t import_count, int64_t* out_ret);
 bool sircc_print_target(const char* triple);
@@ -6,6 +6,7 @@
 #include <llvm-c/Analysis.h>
 #include <llvm-c/Target.h>
 #include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/PassBuilder.h>
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -33,6 +34,19 @@ static void llvm_init_targets_once(void) {
   inited = 1;
 }
 
+static LLVMCodeGenOptLevel codegen_level(const SirProgram* p) {
+  switch (p && p->opt ? p->opt->opt_level : SIRCC_OPT_DEFAULT) {
+    case SIRCC_OPT_O0:
+      return LLVMCodeGenLevelNone;
+    case SIRCC_OPT_O1:
+      return LLVMCodeGenLevelLess;
+    case SIRCC_OPT_O3:
+      return LLVMCodeGenLevelAggressive;
+    default:
+      return LLVMCodeGenLevelDefault;
+  }
+}
+
 bool emit_module_ir(SirProgram* p, LLVMModuleRef mod, const char* out_path) {
   char* err = NULL;
   if (LLVMPrintModuleToFile(mod, out_path, &err) != 0) {
@@ -269,7 +283,7 @@ bool emit_module_obj(SirProgram* p, LLVMModuleRef mod, const char* triple, const
   const char* cpu = (p && p->target_cpu && *p->target_cpu) ? p->target_cpu : "generic";
   const char* features = (p && p->target_features && *p->target_features) ? p->target_features : "";
   LLVMTargetMachineRef tm =
-      LLVMCreateTargetMachine(target, use_triple, cpu, features, LLVMCodeGenLevelDefault, LLVMRelocDefault, LLVMCodeModelDefault);
+      LLVMCreateTargetMachine(target, use_triple, cpu, features, codegen_level(p), LLVMRelocDefault, LLVMCodeModelDefault);
   if (!tm) {
     err_codef(p, "sircc.llvm.target_machine.create_failed", "sircc: failed to create target machine");
     if (!triple) LLVMDisposeMessage((char*)use_triple);
@@ -296,6 +310,69 @@ bool emit_module_obj(SirProgram* p, LLVMModuleRef mod, const char* triple, const
   return true;
 }
 
+bool optimize_module(SirProgram* p, LLVMModuleRef mod, const char* triple) {
+  if (!p || !mod || !triple) return false;
+  const char* pipeline = NULL;
+  switch (p->opt ? p->opt->opt_level : SIRCC_OPT_DEFAULT) {
+    case SIRCC_OPT_O0:
+      pipeline = "default<O0>";
+      break;
+    case SIRCC_OPT_O1:
+      pipeline = "default<O1>";
+      break;
+    case SIRCC_OPT_O2:
+      pipeline = "default<O2>";
+      break;
+    case SIRCC_OPT_O3:
+      pipeline = "default<O3>";
+      break;
+    case SIRCC_OPT_OS:
+      pipeline = "default<Os>";
+      break;
+    default:
+      return true;
+  }
+
+  llvm_init_targets_once();
+
+  // The pipeline's cost models come from the same target machine codegen uses, so a
+  // pinned triple/cpu/features (--deterministic) also pins what the optimizer does.
+  char* err = NULL;
+  LLVMTargetRef target = NULL;
+  if (LLVMGetTargetFromTriple(triple, &target, &err) != 0) {
+    err_codef(p, "sircc.llvm.triple.unsupported", "sircc: target triple '%s' unsupported: %s", triple, err ? err : "(unknown)");
+    LLVMDisposeMessage(err);
+    return false;
+  }
+  const char* cpu = (p->target_cpu && *p->target_cpu) ? p->target_cpu : "generic";
+  const char* features = (p->target_features && *p->target_features) ? p->target_features : "";
+  LLVMTargetMachineRef tm =
+      LLVMCreateTargetMachine(target, triple, cpu, features, codegen_level(p), LLVMRelocDefault, LLVMCodeModelDefault);
+  if (!tm) {
+    err_codef(p, "sircc.llvm.target_machine.create_failed", "sircc: failed to create target machine");
+    return false;
+  }
+
+  // Match clang: loop unrolling and vectorization start at -O2 (including -Os).
+  const bool loops = p->opt->opt_level >= SIRCC_OPT_O2;
+  LLVMPassBuilderOptionsRef opts = LLVMCreatePassBuilderOptions();
+  LLVMPassBuilderOptionsSetLoopUnrolling(opts, loops);
+  LLVMPassBuilderOptionsSetLoopInterleaving(opts, loops);
+  LLVMPassBuilderOptionsSetLoopVectorization(opts, loops);
+  LLVMPassBuilderOptionsSetSLPVectorization(opts, loops);
+
+  LLVMErrorRef perr = LLVMRunPasses(mod, pipeline, tm, opts);
+  LLVMDisposePassBuilderOptions(opts);
+  LLVMDisposeTargetMachine(tm);
+  if (perr) {
+    char* msg = LLVMGetErrorMessage(perr);
+    err_codef(p, "sircc.llvm.opt_failed", "sircc: LLVM %s pipeline failed: %s", pipeline, msg ? msg : "(unknown)");
+    LLVMDisposeErrorMessage(msg);
+    return false;
+  }
+  return true;
+}
+
 bool sircc_print_target(const char* triple) {
   llvm_init_targets_once();
 
@@ -120,6 +120,21 @@ static bool idmap_get_or_put(SirProgram* p, SirIdMap* m, bool is_str, int64_t ik
   }
 }
 
+static bool idmap_find(const SirIdMap* m, const char* s, size_t slen, int64_t* out) {
+  if (!m || !m->entries || m->cap == 0 || !out) return false;
+  uint64_t h = fnv1a64(s, slen);
+  if (h == 0) h = 1;
+  size_t mask = m->cap - 1;
+  for (size_t idx = (size_t)h & mask;; idx = (idx + 1) & mask) {
+    const SirIdMapEntry* e = &m->entries[idx];
+    if (!e->used) return false;
+    if (e->hash == h && key_eq(e, true, 0, s, slen)) {
+      *out = e->val;
+      return true;
+    }
+  }
+}
+
 static SirIdMap* map_for(SirProgram* p, SirIdKind kind) {
   if (!p) return NULL;
   switch (kind) {
@@ -199,6 +214,19 @@ bool sir_intern_id(SirProgram* p, SirIdKind kind, const JsonValue* v, int64_t* o
   return false;
 }
 
+bool sir_find_id(SirProgram* p, SirIdKind kind, const JsonValue* v, int64_t* out_id) {
+  if (!p || !v || !out_id) return false;
+  int64_t i = 0;
+  if (json_get_i64((JsonValue*)v, &i)) {
+    if (i < 0) return false;
+    *out_id = i;
+    return true;
+  }
+  const char* s = json_get_string((JsonValue*)v);
+  if (!s || !*s) return false;
+  return idmap_find(map_for(p, kind), s, strlen(s), out_id);
+}
+
 static bool parse_ref_id_kind(SirProgram* p, SirIdKind kind, const JsonValue* v, int64_t* out_id, const char* ctx) {
   if (!v || v->type != JSON_OBJECT) return false;
   const char* ts = json_get_string(json_obj_get((JsonValue*)v, "t"));
@@ -39,6 +39,9 @@ void sir_idmaps_free(struct SirProgram* p);
 
 bool sir_intern_id(struct SirProgram* p, SirIdKind kind, const JsonValue* v, int64_t* out_id, const char* ctx);
 
+// Like sir_intern_id, but never allocates: unknown string ids return false.
+bool sir_find_id(struct SirProgram* p, SirIdKind kind, const JsonValue* v, int64_t* out_id);
+
 // If `internal_id` originated from a string id, returns that string. Otherwise returns NULL.
 const char* sir_id_str_for_internal(struct SirProgram* p, SirIdKind kind, int64_t internal_id);
 
@@ -109,6 +109,21 @@ typedef struct NodeRec {
   bool resolving;
 } NodeRec;
 
+// Counts from a sem block profile (--profile-use), indexed by internal node id.
+typedef struct ProfileNode {
+  bool seen;
+  uint64_t count;    // block: entries; fn: entries of all its blocks
+  uint64_t in_edges; // block: entries through edges from the same function
+  uint64_t* arms;    // term.cbr: then, else; term.switch: default, then cases in order
+  size_t arm_len;
+} ProfileNode;
+
+typedef struct SirProfile {
+  ProfileNode* nodes;
+  size_t nodes_cap;
+  uint64_t hot_min; // fns with at least this many block entries are hot; 0 = none
+} SirProfile;
+
 typedef struct PendingFeatureUse {
   const char* path;
   size_t line;
@@ -185,6 +200,8 @@ typedef struct SirProgram {
   PendingFeatureUse* pending_features;
   size_t pending_features_len;
   size_t pending_features_cap;
+
+  SirProfile* profile; // NULL unless --profile-use
 } SirProgram;
 
 // Diagnostics
@@ -249,11 +266,19 @@ bool type_size_align(SirProgram* p, int64_t type_id, int64_t* out_size, int64_t*
 // Lowering
 bool lower_functions(SirProgram* p, LLVMContextRef ctx, LLVMModuleRef mod);
 
+// Profile-guided lowering (--profile-use)
+bool load_profile(SirProgram* p, const char* path);
+void free_profile(SirProgram* p);
+void profile_set_branch_weights(SirProgram* p, LLVMContextRef ctx, LLVMValueRef term, int64_t node_id);
+void profile_set_fn_entry(SirProgram* p, LLVMContextRef ctx, LLVMValueRef fn, int64_t fn_id, int64_t entry_id);
+
 // Emission
 bool emit_module_ir(SirProgram* p, LLVMModuleRef mod, const char* out_path);
 bool init_target_for_module(SirProgram* p, LLVMModuleRef mod, const char* triple);
 bool init_target_info(SirProgram* p, const char* triple);
 bool emit_module_obj(SirProgram* p, LLVMModuleRef mod, const char* triple, const char* out_path);
+// Runs LLVM's default pipeline for opt->opt_level (no-op without an -O flag).
+bool optimize_module(SirProgram* p, LLVMModuleRef mod, const char* triple);
 
 // ZASM (zir) emission (zasm-v1.1 JSONL).
 bool emit_zasm_v11(SirProgram* p, const char* out_path);
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2026 Frogfish
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "compiler_internal.h"
+#include "compiler_lower_hl.h"
+
+#include <llvm-c/Analysis.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/LLJIT.h>
+#include <llvm-c/Orc.h>
+#include <llvm-c/TargetMachine.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static void jit_err(SirProgram* p, const char* code, const char* what, LLVMErrorRef e) {
+  char* msg = LLVMGetErrorMessage(e);
+  err_codef(p, code, "sircc: jit: %s: %s", what, msg ? msg : "(unknown)");
+  LLVMDisposeErrorMessage(msg);
+}
+
+// Entry is `zir_main` (or `main`) with no params and an integer or void result.
+static const char* jit_find_entry(SirProgram* p, LLVMModuleRef mod, unsigned* out_ret_bits) {
+  const char* name = "zir_main";
+  LLVMValueRef fn = LLVMGetNamedFunction(mod, name);
+  if (!fn || LLVMIsDeclaration(fn)) {
+    name = "main";
+    fn = LLVMGetNamedFunction(mod, name);
+  }
+  if (!fn || LLVMIsDeclaration(fn)) {
+    err_codef(p, "sircc.jit.no_entry", "sircc: jit: no entry fn (expected fn name zir_main or main)");
+    return NULL;
+  }
+  LLVMTypeRef fty = LLVMGlobalGetValueType(fn);
+  LLVMTypeRef rty = LLVMGetReturnType(fty);
+  if (LLVMCountParamTypes(fty) != 0 || LLVMIsFunctionVarArg(fty)) {
+    err_codef(p, "sircc.jit.entry_sig", "sircc: jit: entry fn must take no params");
+    return NULL;
+  }
+  if (LLVMGetTypeKind(rty) == LLVMVoidTypeKind) {
+    *out_ret_bits = 0;
+  } else if (LLVMGetTypeKind(rty) == LLVMIntegerTypeKind && LLVMGetIntTypeWidth(rty) <= 64) {
+    *out_ret_bits = LLVMGetIntTypeWidth(rty);
+  } else {
+    err_codef(p, "sircc.jit.entry_sig", "sircc: jit: entry fn must return an integer or void");
+    return NULL;
+  }
+  return name;
+}
+
+static bool jit_define_imports(SirProgram* p, LLVMOrcLLJITRef jit, const SirccJitSymbol* imports, size_t import_count) {
+  if (!import_count) return true;
+  LLVMJITCSymbolMapPair* syms = (LLVMJITCSymbolMapPair*)calloc(import_count, sizeof(*syms));
+  if (!syms) {
+    bump_exit_code(p, SIRCC_EXIT_INTERNAL);
+    err_codef(p, "sircc.oom", "sircc: out of memory");
+    return false;
+  }
+  for (size_t i = 0; i < import_count; i++) {
+    syms[i].Name = LLVMOrcLLJITMangleAndIntern(jit, imports[i].name);
+    syms[i].Sym.Address = (LLVMOrcExecutorAddress)imports[i].addr;
+    syms[i].Sym.Flags.GenericFlags = LLVMJITSymbolGenericFlagsExported | LLVMJITSymbolGenericFlagsCallable;
+    syms[i].Sym.Flags.TargetFlags = 0;
+  }
+  // The materialization unit takes over the interned names.
+  LLVMOrcMaterializationUnitRef mu = LLVMOrcAbsoluteSymbols(syms, import_count);
+  free(syms);
+  LLVMErrorRef e = LLVMOrcJITDylibDefine(LLVMOrcLLJITGetMainJITDylib(jit), mu);
+  if (e) {
+    LLVMOrcDisposeMaterializationUnit(mu);
+    jit_err(p, "sircc.jit.define_failed", "failed to define imports", e);
+    return false;
+  }
+  return true;
+}
+
+int sircc_jit_run(const SirccOptions* opt, const SirccJitSymbol* imports, size_t import_count, int64_t* out_ret) {
+  if (!opt || !opt->input_path || !out_ret) return SIRCC_EXIT_USAGE;
+  *out_ret = 0;
+
+  SirProgram p = {0};
+  p.opt = opt;
+  p.exit_code = SIRCC_EXIT_ERROR;
+  arena_init(&p.arena);
+  sir_idmaps_init(&p);
+  char* triple = NULL;
+  LLVMOrcThreadSafeContextRef tsctx = NULL;
+  LLVMOrcLLJITRef jit = NULL;
+  LLVMModuleRef mod = NULL;
+  unsigned ret_bits = 0;
+
+  bool ok = parse_program(&p, opt, opt->input_path) && validate_program(&p);
+  if (ok && p.feat_sem_v1) ok = lower_hl_in_place(&p);
+  if (!ok) goto done;
+
+  p.cur_path = opt->input_path;
+  p.cur_line = 0;
+  p.cur_src_ref = -1;
+  p.cur_loc.unit = NULL;
+  p.cur_loc.line = 0;
+  p.cur_loc.col = 0;
+
+  // JIT code runs in this process, so only the host triple makes sense.
+  triple = LLVMGetDefaultTargetTriple();
+  tsctx = LLVMOrcCreateNewThreadSafeContext();
+  mod = LLVMModuleCreateWithNameInContext("sir", LLVMOrcThreadSafeContextGetContext(tsctx));
+  ok = init_target_for_module(&p, mod, triple) && lower_functions(&p, LLVMOrcThreadSafeContextGetContext(tsctx), mod);
+  if (!ok) goto done;
+
+  char* verr = NULL;
+  if (LLVMVerifyModule(mod, LLVMReturnStatusAction, &verr) != 0) {
+    err_codef(&p, "sircc.llvm.verify_failed", "sircc: LLVM verification failed: %s", verr ? verr : "(unknown)");
+    LLVMDisposeMessage(verr);
+    ok = false;
+    goto done;
+  }
+  LLVMDisposeMessage(verr);
+
+  const char* entry = jit_find_entry(&p, mod, &ret_bits);
+  if (!entry) {
+    ok = false;
+    goto done;
+  }
+
+  LLVMErrorRef e = LLVMOrcCreateLLJIT(&jit, NULL);
+  if (e) {
+    jit = NULL;
+    jit_err(&p, "sircc.jit.create_failed", "failed to create LLJIT", e);
+    ok = false;
+    goto done;
+  }
+  if (!jit_define_imports(&p, jit, imports, import_count)) {
+    ok = false;
+    goto done;
+  }
+
+  LLVMOrcThreadSafeModuleRef tsm = LLVMOrcCreateNewThreadSafeModule(mod, tsctx);
+  mod = NULL;
+  e = LLVMOrcLLJITAddLLVMIRModule(jit, LLVMOrcLLJITGetMainJITDylib(jit), tsm);
+  if (e) {
+    jit_err(&p, "sircc.jit.add_failed", "failed to add module", e);
+    ok = false;
+    goto done;
+  }
+
+  // Lookup materializes the module; unresolved imports fail here.
+  LLVMOrcExecutorAddress addr = 0;
+  e = LLVMOrcLLJITLookup(jit, &addr, entry);
+  if (e) {
+    jit_err(&p, "sircc.jit.link_failed", "failed to link module", e);
+    ok = false;
+    goto done;
+  }
+
+  if (ret_bits == 0) {
+    ((void (*)(void))(uintptr_t)addr)();
+  } else if (ret_bits <= 32) {
+    const int32_t r = ((int32_t(*)(void))(uintptr_t)addr)();
+    *out_ret = ret_bits == 32 ? (int64_t)r : (int64_t)((uint32_t)r & ((1u << ret_bits) - 1u));
+  } else {
+    *out_ret = ((int64_t(*)(void))(uintptr_t)addr)();
+  }
+
+done:
+  if (mod) LLVMDisposeModule(mod);
+  if (jit) {
+    LLVMErrorRef de = LLVMOrcDisposeLLJIT(jit);
+    if (de) LLVMConsumeError(de);
+  }
+  if (tsctx) LLVMOrcDisposeThreadSafeContext(tsctx);
+  if (triple) LLVMDisposeMessage(triple);
+  free(p.srcs);
+  free(p.syms);
+  free(p.types);
+  free(p.nodes);
+  free(p.pending_features);
+  sir_idmaps_free(&p);
+  arena_free(&p.arena);
+  return ok ? SIRCC_EXIT_OK : p.exit_code;
+}
@@ -617,7 +617,8 @@ bool lower_term_cfg(FunctionCtx* f, int64_t node_id) {
     if (!add_block_args(f, n, from_bb, then_id, then_args)) return false;
     if (!add_block_args(f, n, from_bb, else_id, else_args)) return false;
 
-    LLVMBuildCondBr(f->builder, cond, then_bb, else_bb);
+    LLVMValueRef br = LLVMBuildCondBr(f->builder, cond, then_bb, else_bb);
+    profile_set_branch_weights(f->p, f->ctx, br, node_id);
     return true;
   }
 
@@ -710,6 +711,7 @@ bool lower_term_cfg(FunctionCtx* f, int64_t node_id) {
 
       LLVMAddCase(sw, lit, to_bb);
     }
+    profile_set_branch_weights(f->p, f->ctx, sw, node_id);
     return true;
   }
 
@@ -1049,6 +1051,7 @@ bool lower_functions(SirProgram* p, LLVMContextRef ctx, LLVMModuleRef mod) {
         LLVMDisposeBuilder(builder);
       }
 
+      profile_set_fn_entry(p, ctx, fn, n->id, entry_id);
       free(f.blocks_by_node);
       free(f.binds);
       continue;
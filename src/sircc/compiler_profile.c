@@ -0,0 +1,295 @@
+// SPDX-FileCopyrightText: 2026 Frogfish
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "compiler_internal.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Functions that together account for this share of all block entries are hot.
+#define PROFILE_HOT_PERMILLE 900u
+
+static ProfileNode* prof_node(SirProfile* prof, int64_t id) {
+  if (!prof || id < 0 || (size_t)id >= prof->nodes_cap) return NULL;
+  return &prof->nodes[id];
+}
+
+static bool prof_count(SirProgram* p, JsonValue* v, const char* ctx, uint64_t* out) {
+  int64_t n = 0;
+  if (!json_get_i64(v, &n) || n < 0) {
+    err_codef(p, "sircc.profile.count.bad", "sircc: profile %s must be a non-negative integer", ctx);
+    return false;
+  }
+  *out = (uint64_t)n;
+  return true;
+}
+
+// Resolves a profile node id (as written by sem) to a node with one of the given tags.
+static NodeRec* prof_lookup(SirProgram* p, JsonValue* v, const char* ctx, const char* tag, const char* tag2) {
+  int64_t id = 0;
+  NodeRec* n = sir_find_id(p, SIR_ID_NODE, v, &id) ? get_node(p, id) : NULL;
+  if (!n) {
+    err_codef(p, "sircc.profile.node.unknown", "sircc: profile %s is not a node of the input (stale profile?)", ctx);
+    return NULL;
+  }
+  if (strcmp(n->tag, tag) != 0 && (!tag2 || strcmp(n->tag, tag2) != 0)) {
+    err_codef(p, "sircc.profile.node.kind_mismatch", "sircc: profile %s is node %lld, a %s, not a %s (stale profile?)", ctx,
+              (long long)n->id, n->tag, tag);
+    return NULL;
+  }
+  return n;
+}
+
+static bool prof_set_arms(SirProgram* p, ProfileNode* pn, size_t len) {
+  pn->arms = (uint64_t*)arena_alloc(&p->arena, len * sizeof(uint64_t));
+  if (!pn->arms) {
+    bump_exit_code(p, SIRCC_EXIT_INTERNAL);
+    err_codef(p, "sircc.oom", "sircc: out of memory");
+    return false;
+  }
+  pn->arm_len = len;
+  pn->seen = true;
+  return true;
+}
+
+static bool prof_record(SirProgram* p, SirProfile* prof, JsonValue* root, const char* k, NodeRec** fn_cache) {
+  if (strcmp(k, "bprof_block") == 0) {
+    const char* func = json_get_string(json_obj_get(root, "func"));
+    if (!func) {
+      err_codef(p, "sircc.profile.func.missing", "sircc: profile bprof_block missing func");
+      return false;
+    }
+    NodeRec* fn = *fn_cache;
+    const char* cur = fn ? json_get_string(json_obj_get(fn->fields, "name")) : NULL;
+    if (!cur || strcmp(cur, func) != 0) fn = *fn_cache = find_fn_node_by_name(p, func);
+    if (!fn) {
+      err_codef(p, "sircc.profile.func.unknown", "sircc: profile names unknown fn '%s' (stale profile?)", func);
+      return false;
+    }
+    NodeRec* b = prof_lookup(p, json_obj_get(root, "block"), "block", "block", NULL);
+    uint64_t count = 0;
+    if (!b || !prof_count(p, json_obj_get(root, "count"), "block count", &count)) return false;
+    ProfileNode* bn = prof_node(prof, b->id);
+    ProfileNode* fnn = prof_node(prof, fn->id);
+    bn->seen = true;
+    bn->count = count;
+    fnn->seen = true;
+    fnn->count += count;
+    return true;
+  }
+
+  if (strcmp(k, "bprof_edge") == 0) {
+    NodeRec* from = prof_lookup(p, json_obj_get(root, "from"), "edge from", "block", NULL);
+    NodeRec* to = from ? prof_lookup(p, json_obj_get(root, "to"), "edge to", "block", NULL) : NULL;
+    uint64_t count = 0;
+    if (!to || !prof_count(p, json_obj_get(root, "count"), "edge count", &count)) return false;
+    prof_node(prof, to->id)->in_edges += count;
+    return true;
+  }
+
+  if (strcmp(k, "bprof_branch") == 0) {
+    NodeRec* t = prof_lookup(p, json_obj_get(root, "node"), "branch node", "term.cbr", "term.condbr");
+    if (!t) return false;
+    ProfileNode* tn = prof_node(prof, t->id);
+    if (!prof_set_arms(p, tn, 2)) return false;
+    return prof_count(p, json_obj_get(root, "then"), "branch then", &tn->arms[0]) &&
+           prof_count(p, json_obj_get(root, "else"), "branch else", &tn->arms[1]);
+  }
+
+  if (strcmp(k, "bprof_switch") == 0) {
+    NodeRec* t = prof_lookup(p, json_obj_get(root, "node"), "switch node", "term.switch", NULL);
+    if (!t) return false;
+    JsonValue* cases = json_obj_get(root, "cases");
+    JsonValue* want = t->fields ? json_obj_get(t->fields, "cases") : NULL;
+    if (!cases || cases->type != JSON_ARRAY || !want || want->type != JSON_ARRAY || cases->v.arr.len != want->v.arr.len) {
+      err_codef(p, "sircc.profile.switch.cases_mismatch", "sircc: profile for term.switch node %lld does not match its cases (stale profile?)",
+                (long long)t->id);
+      return false;
+    }
+    ProfileNode* tn = prof_node(prof, t->id);
+    if (!prof_set_arms(p, tn, cases->v.arr.len + 1)) return false;
+    // LLVM orders switch weights as default first, then the cases.
+    if (!prof_count(p, json_obj_get(root, "default"), "switch default", &tn->arms[0])) return false;
+    for (size_t i = 0; i < cases->v.arr.len; i++) {
+      if (!prof_count(p, cases->v.arr.items[i], "switch case", &tn->arms[i + 1])) return false;
+    }
+    return true;
+  }
+
+  // bprof_summary and unknown kinds carry nothing lowering needs.
+  return true;
+}
+
+static int prof_u64_desc(const void* a, const void* b) {
+  const uint64_t x = *(const uint64_t*)a;
+  const uint64_t y = *(const uint64_t*)b;
+  return (x < y) - (x > y);
+}
+
+static bool prof_find_hot_min(SirProgram* p, SirProfile* prof) {
+  size_t n = 0;
+  uint64_t total = 0;
+  for (size_t i = 0; i < p->nodes_cap; i++) {
+    NodeRec* x = p->nodes[i];
+    if (!x || strcmp(x->tag, "fn") != 0 || !prof->nodes[i].count) continue;
+    n++;
+    total += prof->nodes[i].count;
+  }
+  if (n == 0) return true;
+  uint64_t* counts = (uint64_t*)malloc(n * sizeof(uint64_t));
+  if (!counts) {
+    bump_exit_code(p, SIRCC_EXIT_INTERNAL);
+    err_codef(p, "sircc.oom", "sircc: out of memory");
+    return false;
+  }
+  n = 0;
+  for (size_t i = 0; i < p->nodes_cap; i++) {
+    NodeRec* x = p->nodes[i];
+    if (x && strcmp(x->tag, "fn") == 0 && prof->nodes[i].count) counts[n++] = prof->nodes[i].count;
+  }
+  qsort(counts, n, sizeof(uint64_t), prof_u64_desc);
+  const uint64_t want = total / 1000u * PROFILE_HOT_PERMILLE + total % 1000u * PROFILE_HOT_PERMILLE / 1000u;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    sum += counts[i];
+    prof->hot_min = counts[i];
+    if (sum >= want) break;
+  }
+  free(counts);
+  return true;
+}
+
+bool load_profile(SirProgram* p, const char* path) {
+  if (!p || !path) return false;
+  SirProfile* prof = (SirProfile*)arena_alloc(&p->arena, sizeof(SirProfile));
+  ProfileNode* nodes = p->nodes_cap ? (ProfileNode*)calloc(p->nodes_cap, sizeof(ProfileNode)) : NULL;
+  if (!prof || (p->nodes_cap && !nodes)) {
+    free(nodes);
+    bump_exit_code(p, SIRCC_EXIT_INTERNAL);
+    err_codef(p, "sircc.oom", "sircc: out of memory");
+    return false;
+  }
+  memset(prof, 0, sizeof(*prof));
+  prof->nodes = nodes;
+  prof->nodes_cap = p->nodes_cap;
+  p->profile = prof;
+
+  // Errors point at the profile line, not at the last input record.
+  const char* saved_path = p->cur_path;
+  SirDiagSaved saved = sir_diag_push(p, NULL, -1, NULL);
+  p->cur_path = path;
+  p->cur_line = 0;
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    err_codef(p, "sircc.profile.open_failed", "sircc: failed to open profile: %s", strerror(errno));
+    p->cur_path = saved_path;
+    sir_diag_pop(p, saved);
+    return false;
+  }
+
+  char* line = NULL;
+  size_t cap = 0;
+  size_t len = 0;
+  size_t line_no = 0;
+  bool too_long = false;
+  bool header = false;
+  bool ok = true;
+  NodeRec* fn_cache = NULL;
+  while (ok && read_line(f, &line, &cap, &len, 16u * 1024u * 1024u, &too_long)) {
+    line_no++;
+    if (len == 0 || is_blank_line(line)) continue;
+    p->cur_line = line_no;
+
+    JsonError jerr = {0};
+    JsonValue* root = NULL;
+    if (!json_parse(&p->arena, line, &root, &jerr)) {
+      err_codef(p, "sircc.profile.json.parse_error", "sircc: profile JSON parse error at column %zu: %s", jerr.offset + 1,
+                jerr.msg ? jerr.msg : "unknown");
+      ok = false;
+      break;
+    }
+    const char* k = json_get_string(json_obj_get(root, "k"));
+    if (!header) {
+      int64_t version = 0;
+      const char* format = json_get_string(json_obj_get(root, "format"));
+      if (!k || strcmp(k, "block_profile") != 0 || !format || strcmp(format, "sir-cfg") != 0) {
+        err_codef(p, "sircc.profile.header.bad", "sircc: profile must start with a sem block_profile record (sem --profile-blocks-out)");
+        ok = false;
+      } else if (!json_get_i64(json_obj_get(root, "version"), &version) || version != 1) {
+        err_codef(p, "sircc.profile.version.unsupported", "sircc: unsupported block profile version (want 1)");
+        ok = false;
+      }
+      header = true;
+      continue;
+    }
+    if (k) ok = prof_record(p, prof, root, k, &fn_cache);
+  }
+  if (ok && too_long) {
+    p->cur_line = line_no + 1;
+    err_codef(p, "sircc.profile.line_too_long", "sircc: profile line is too long");
+    ok = false;
+  }
+  if (ok && !header) {
+    err_codef(p, "sircc.profile.header.bad", "sircc: profile is empty");
+    ok = false;
+  }
+  free(line);
+  fclose(f);
+
+  if (ok) ok = prof_find_hot_min(p, prof);
+  p->cur_path = saved_path;
+  p->cur_line = 0;
+  sir_diag_pop(p, saved);
+  return ok;
+}
+
+void free_profile(SirProgram* p) {
+  if (!p || !p->profile) return;
+  free(p->profile->nodes);
+  p->profile = NULL;
+}
+
+static unsigned prof_kind(LLVMContextRef ctx) { return LLVMGetMDKindIDInContext(ctx, "prof", 4); }
+
+void profile_set_branch_weights(SirProgram* p, LLVMContextRef ctx, LLVMValueRef term, int64_t node_id) {
+  ProfileNode* pn = p ? prof_node(p->profile, node_id) : NULL;
+  if (!pn || !pn->arms || pn->arm_len == 0) return;
+
+  // Weights are i32; scale hot counts down keeping their ratios.
+  uint64_t max = 0;
+  for (size_t i = 0; i < pn->arm_len; i++) max = pn->arms[i] > max ? pn->arms[i] : max;
+  if (max == 0) return; // never reached: no information about the arms
+  const uint64_t scale = max / UINT32_MAX + 1u;
+
+  LLVMMetadataRef* ops = (LLVMMetadataRef*)malloc((pn->arm_len + 1) * sizeof(LLVMMetadataRef));
+  if (!ops) return; // weights are only a hint
+  LLVMTypeRef i32 = LLVMInt32TypeInContext(ctx);
+  ops[0] = LLVMMDStringInContext2(ctx, "branch_weights", 14);
+  for (size_t i = 0; i < pn->arm_len; i++) ops[i + 1] = LLVMValueAsMetadata(LLVMConstInt(i32, pn->arms[i] / scale, 0));
+  LLVMMetadataRef md = LLVMMDNodeInContext2(ctx, ops, pn->arm_len + 1);
+  LLVMSetMetadata(term, prof_kind(ctx), LLVMMetadataAsValue(ctx, md));
+  free(ops);
+}
+
+static void prof_add_fn_attr(LLVMContextRef ctx, LLVMValueRef fn, const char* name) {
+  unsigned kind = LLVMGetEnumAttributeKindForName(name, strlen(name));
+  if (kind) LLVMAddAttributeAtIndex(fn, LLVMAttributeFunctionIndex, LLVMCreateEnumAttribute(ctx, kind, 0));
+}
+
+void profile_set_fn_entry(SirProgram* p, LLVMContextRef ctx, LLVMValueRef fn, int64_t fn_id, int64_t entry_id) {
+  ProfileNode* fnn = p ? prof_node(p->profile, fn_id) : NULL;
+  ProfileNode* en = p ? prof_node(p->profile, entry_id) : NULL;
+  if (!fnn || !fnn->seen || !en) return;
+
+  // Loops back to the entry block re-enter it without a call.
+  const uint64_t calls = en->count > en->in_edges ? en->count - en->in_edges : 0;
+  LLVMMetadataRef ops[2] = {
+      LLVMMDStringInContext2(ctx, "function_entry_count", 20),
+      LLVMValueAsMetadata(LLVMConstInt(LLVMInt64TypeInContext(ctx), calls, 0)),
+  };
+  LLVMGlobalSetMetadata(fn, prof_kind(ctx), LLVMMDNodeInContext2(ctx, ops, 2));
+
+  if (calls == 0) prof_add_fn_attr(ctx, fn, "cold");
+  else if (p->profile->hot_min && fnn->count >= p->profile->hot_min) prof_add_fn_attr(ctx, fn, "hot");
+}
@@ -13,6 +13,7 @@ typedef struct Parser {
   Arena* arena;
   const char* s;
   size_t i;
+  size_t n; // input length; bytes at or past n read as NUL
   JsonError* err;
 } Parser;
 
@@ -23,15 +24,22 @@ static void set_err(Parser* p, const char* msg) {
   }
 }
 
+static char peek(const Parser* p) {
+  return p->i < p->n ? p->s[p->i] : 0;
+}
+
+static char next(Parser* p) {
+  const char c = peek(p);
+  if (c) p->i++;
+  return c;
+}
+
 static void skip_ws(Parser* p) {
-  while (p->s[p->i] && (p->s[p->i] == ' ' || p->s[p->i] == '\n' || p->s[p->i] == '\r' ||
-                        p->s[p->i] == '\t')) {
-    p->i++;
-  }
+  for (char c = peek(p); c == ' ' || c == '\n' || c == '\r' || c == '\t'; c = peek(p)) p->i++;
 }
 
 static bool consume(Parser* p, char c) {
-  if (p->s[p->i] == c) {
+  if (peek(p) == c) {
     p->i++;
     return true;
   }
@@ -52,7 +60,7 @@ static bool parse_value(Parser* p, JsonValue** out);
 
 static bool parse_literal(Parser* p, const char* lit) {
   size_t n = strlen(lit);
-  if (strncmp(p->s + p->i, lit, n) == 0) {
+  if (n <= p->n - p->i && strncmp(p->s + p->i, lit, n) == 0) {
     p->i += n;
     return true;
   }
@@ -61,12 +69,12 @@ static bool parse_literal(Parser* p, const char* lit) {
 
 static bool parse_number(Parser* p, JsonValue** out) {
   size_t start = p->i;
-  if (p->s[p->i] == '-') p->i++;
-  if (!isdigit((unsigned char)p->s[p->i])) {
+  if (peek(p) == '-') p->i++;
+  if (!isdigit((unsigned char)peek(p))) {
     set_err(p, "expected digit");
     return false;
   }
-  while (isdigit((unsigned char)p->s[p->i])) p->i++;
+  while (isdigit((unsigned char)peek(p))) p->i++;
 
   // We only support integer numbers for now.
   size_t len = p->i - start;
@@ -98,17 +106,34 @@ static bool parse_string(Parser* p, JsonValue** out) {
     return false;
   }
 
+  // Fast path: no escapes, so the bytes up to the closing quote are the value.
+  size_t end = p->i;
+  while (end < p->n && p->s[end] && p->s[end] != '"' && p->s[end] != '\\') end++;
+  if (end < p->n && p->s[end] == '"') {
+    const size_t n = end - p->i;
+    char* s = (char*)arena_alloc(p->arena, n + 1);
+    if (!s) return false;
+    memcpy(s, p->s + p->i, n);
+    s[n] = 0;
+    p->i = end + 1;
+    JsonValue* str = make(p, JSON_STRING);
+    if (!str) return false;
+    str->v.s = s;
+    *out = str;
+    return true;
+  }
+
   // Decode into a temporary buffer and then arena-dup.
   size_t cap = 64;
   size_t len = 0;
   char* tmp = (char*)arena_alloc(p->arena, cap);
   if (!tmp) return false;
 
-  while (p->s[p->i]) {
-    char c = p->s[p->i++];
+  while (peek(p)) {
+    char c = next(p);
     if (c == '"') break;
     if (c == '\\') {
-      char e = p->s[p->i++];
+      char e = next(p);
       switch (e) {
         case '"': c = '"'; break;
         case '\\': c = '\\'; break;
@@ -122,7 +147,7 @@ static bool parse_string(Parser* p, JsonValue** out) {
           // Minimal \uXXXX support: accept it but only preserve ASCII codepoints.
           unsigned v = 0;
           for (int k = 0; k < 4; k++) {
-            char h = p->s[p->i++];
+            char h = next(p);
             if (!isxdigit((unsigned char)h)) {
               set_err(p, "invalid \\u escape");
               return false;
@@ -300,7 +325,7 @@ static bool parse_object(Parser* p, JsonValue** out) {
 
 static bool parse_value(Parser* p, JsonValue** out) {
   skip_ws(p);
-  char c = p->s[p->i];
+  char c = peek(p);
   if (!c) {
     set_err(p, "unexpected end of input");
     return false;
@@ -334,14 +359,18 @@ static bool parse_value(Parser* p, JsonValue** out) {
 }
 
 bool json_parse(Arena* arena, const char* input, JsonValue** out, JsonError* err) {
+  return json_parse_n(arena, input, SIZE_MAX, out, err);
+}
+
+bool json_parse_n(Arena* arena, const char* input, size_t len, JsonValue** out, JsonError* err) {
   if (err) {
     err->msg = NULL;
     err->offset = 0;
   }
-  Parser p = {.arena = arena, .s = input, .i = 0, .err = err};
+  Parser p = {.arena = arena, .s = input, .i = 0, .n = len, .err = err};
   if (!parse_value(&p, out)) return false;
   skip_ws(&p);
-  if (p.s[p.i] != 0) {
+  if (peek(&p) != 0) {
     set_err(&p, "trailing characters");
     return false;
   }
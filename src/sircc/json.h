@@ -53,6 +53,9 @@ typedef struct JsonError {
 } JsonError;
 
 bool json_parse(Arena* arena, const char* input, JsonValue** out, JsonError* err);
+// Parses input[0..len) (which need not be NUL-terminated). An embedded NUL
+// ends the input, as it does for json_parse.
+bool json_parse_n(Arena* arena, const char* input, size_t len, JsonValue** out, JsonError* err);
 
 JsonValue* json_obj_get(const JsonValue* obj, const char* key);
 bool json_obj_has_only_keys(const JsonValue* obj, const char* const* keys, size_t key_count, const char** out_bad);
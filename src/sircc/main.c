@@ -117,6 +117,7 @@ static void usage(FILE* out) {
           "Usage:\n"
           "  sircc <input.sir.jsonl> -o <output> [--emit-llvm|--emit-obj|--emit-zasm] [--clang <path>] [--target-triple <triple>]\n"
           "  sircc <input.sir.jsonl> -o <output.zasm.jsonl> --emit-zasm [--emit-zasm-map <map.jsonl>]\n"
+          "  sircc <input.sir.jsonl> -o <output> [-O0|-O1|-O2|-O3|-Os] [--profile-use <profile.jsonl>]\n"
           "  sircc [--prelude <prelude.sir.jsonl>]... <input.sir.jsonl> ...\n"
           "  sircc [--prelude-builtin data_v1|zabi25_min]... <input.sir.jsonl> ...\n"
           "  sircc --verify-only <input.sir.jsonl>\n"
@@ -139,6 +140,11 @@ static void usage(FILE* out) {
           "  --lower-strict     Tighten lowering/verification rules (implies --verify-strict)\n"
           "  --emit-sir-core P  Write lowered Core SIR JSONL to P (requires --lower-hl/--lower-only)\n"
           "\n"
+          "Optimization:\n"
+          "  -O0 .. -O3, -Os    Run LLVM's default pipeline for the level before codegen (default: none)\n"
+          "  --profile-use P    Use a sem block profile (sem --profile-blocks-out P) for branch weights,\n"
+          "                     function entry counts and hot/cold functions\n"
+          "\n"
           "License: GPLv3+\n"
           "© 2026 Frogfish — Author: Alexander Croft\n");
 }
@@ -175,6 +181,8 @@ int main(int argc, char** argv) {
       .runtime = SIRCC_RUNTIME_LIBC,
       .zabi25_root = NULL,
       .zasm_map_path = NULL,
+      .profile_use_path = NULL,
+      .opt_level = SIRCC_OPT_DEFAULT,
       .lower_hl = false,
       .emit_sir_core_path = NULL,
       .lower_strict = false,
@@ -364,6 +372,26 @@ int main(int argc, char** argv) {
       opt.zasm_map_path = argv[++i];
       continue;
     }
+    if (strncmp(a, "-O", 2) == 0) {
+      if (streq(a, "-O0")) opt.opt_level = SIRCC_OPT_O0;
+      else if (streq(a, "-O1")) opt.opt_level = SIRCC_OPT_O1;
+      else if (streq(a, "-O2")) opt.opt_level = SIRCC_OPT_O2;
+      else if (streq(a, "-O3")) opt.opt_level = SIRCC_OPT_O3;
+      else if (streq(a, "-Os")) opt.opt_level = SIRCC_OPT_OS;
+      else {
+        fprintf(stderr, "sircc: invalid optimization level: %s (use -O0, -O1, -O2, -O3 or -Os)\n", a);
+        return SIRCC_EXIT_USAGE;
+      }
+      continue;
+    }
+    if (strcmp(a, "--profile-use") == 0) {
+      if (i + 1 >= argc) {
+        usage(stderr);
+        return SIRCC_EXIT_USAGE;
+      }
+      opt.profile_use_path = argv[++i];
+      continue;
+    }
     if (strcmp(a, "-o") == 0) {
       if (i + 1 >= argc) {
         usage(stderr);
@@ -1,45 +1,111 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // MAP_ANONYMOUS under -std=c11
+#endif
+
 #include "guest_mem.h"
 
 #include <stdlib.h>
 #include <string.h>
 
-static uint32_t align_up_u32(uint32_t x, uint32_t a) {
-  if (a == 0) return x;
-  const uint32_t mask = a - 1u;
-  return (x + mask) & ~mask;
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define SEM_GUEST_MEM_MMAP 1
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+#endif
+
+static void heap_reset(sem_guest_mem_t* m) {
+  m->heap_top = 0;
+  m->fl_bitmap = 0;
+  for (uint32_t fl = 0; fl < SEM_GUEST_HEAP_FL; fl++) {
+    m->sl_bitmap[fl] = 0;
+    for (uint32_t sl = 0; sl < SEM_GUEST_HEAP_SL; sl++) m->free_head[fl][sl] = 0xFFFFFFFFu;
+  }
 }
 
-bool sem_guest_mem_init(sem_guest_mem_t* m, uint32_t cap, uint64_t base) {
+#ifdef SEM_GUEST_MEM_MMAP
+// Reserves cap bytes plus a PROT_NONE guard page on either side. The kernel
+// commits (and zero-fills) pages on first touch.
+static bool guest_map(sem_guest_mem_t* m, uint64_t cap) {
+  const long ps = sysconf(_SC_PAGESIZE);
+  const uint64_t page = ps > 0 ? (uint64_t)ps : 4096u;
+  const uint64_t body = (cap + page - 1u) & ~(page - 1u);
+  const uint64_t len = body + 2u * page;
+  if (len > (uint64_t)SIZE_MAX) return false;
+  void* p = mmap(NULL, (size_t)len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED) return false;
+  uint8_t* buf = (uint8_t*)p + page;
+  if (mprotect(buf, (size_t)body, PROT_READ | PROT_WRITE) != 0) {
+    (void)munmap(p, (size_t)len);
+    return false;
+  }
+  m->map = p;
+  m->map_len = len;
+  m->buf = buf;
+  return true;
+}
+#endif
+
+bool sem_guest_mem_init(sem_guest_mem_t* m, uint64_t cap, uint64_t base) {
   if (!m) return false;
-  if (cap == 0) return false;
+  if (cap == 0 || cap > SEM_GUEST_MEM_MAX_CAP) return false;
   if (base == 0) return false;
   memset(m, 0, sizeof(*m));
 
-  uint8_t* buf = (uint8_t*)calloc(1, cap);
-  if (!buf) return false;
+#ifdef SEM_GUEST_MEM_MMAP
+  if (!guest_map(m, cap)) return false;
+#else
+  if (cap > (uint64_t)SIZE_MAX) return false;
+  m->buf = (uint8_t*)calloc(1, (size_t)cap);
+  if (!m->buf) return false;
+#endif
 
-  m->buf = buf;
   m->cap = cap;
   m->brk = 0;
+  m->sp = cap;
   m->base = base;
+  m->heap_hw = 0;
+  m->stack_lw = cap;
+  heap_reset(m);
+  return true;
+}
+
+bool sem_guest_mem_init_native(sem_guest_mem_t* m, uint64_t cap) {
+  if (!sem_guest_mem_init(m, cap, 1u)) return false;
+  m->base = (uint64_t)(uintptr_t)m->buf;
   return true;
 }
 
 void sem_guest_mem_dispose(sem_guest_mem_t* m) {
   if (!m) return;
+  free(m->dirty);
+#ifdef SEM_GUEST_MEM_MMAP
+  if (m->map) (void)munmap(m->map, (size_t)m->map_len);
+#else
   free(m->buf);
+#endif
   memset(m, 0, sizeof(*m));
 }
 
-static bool sem_guest_bounds(const sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t len, uint32_t* out_off) {
+static void dirty_mark(sem_guest_mem_t* m, uint64_t off, uint64_t len) {
+  if (!m->dirty || len == 0) return;
+  const uint64_t last = (off + len - 1u) / SEM_GUEST_PAGE;
+  for (uint64_t p = off / SEM_GUEST_PAGE; p <= last; p++) m->dirty[p / 64u] |= UINT64_C(1) << (p % 64u);
+}
+
+static bool sem_guest_bounds(const sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t len, uint64_t* out_off) {
   if (!m || !m->buf) return false;
   if (ptr == 0) return false;
   if (ptr < m->base) return false;
-  const uint64_t off64 = ptr - m->base;
-  if (off64 > 0xFFFFFFFFull) return false;
-  const uint32_t off = (uint32_t)off64;
-  const uint64_t end = (uint64_t)off + (uint64_t)len;
-  if (end > (uint64_t)m->brk) return false;
+  const uint64_t off = ptr - m->base;
+  if (off >= m->cap) return false;
+  const uint64_t end = off + (uint64_t)len;
+  if (end > m->brk && (off < m->sp || end > m->cap)) return false;
   if (out_off) *out_off = off;
   return true;
 }
@@ -47,7 +113,7 @@ static bool sem_guest_bounds(const sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t
 bool sem_guest_mem_map_ro(const sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t len, const uint8_t** out) {
   if (!out) return false;
   *out = NULL;
-  uint32_t off = 0;
+  uint64_t off = 0;
   if (len == 0) {
     *out = (m && m->buf) ? m->buf : NULL;
     return *out != NULL;
@@ -60,32 +126,451 @@ bool sem_guest_mem_map_ro(const sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t le
 bool sem_guest_mem_map_rw(sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t len, uint8_t** out) {
   if (!out) return false;
   *out = NULL;
-  uint32_t off = 0;
+  uint64_t off = 0;
   if (len == 0) {
     *out = (m && m->buf) ? m->buf : NULL;
     return *out != NULL;
   }
   if (!sem_guest_bounds(m, ptr, len, &off)) return false;
+  dirty_mark(m, off, len);
   *out = m->buf + off;
   return true;
 }
 
+// Zeroes [lo, hi), skipping the never-written window [heap_hw, stack_lw) so
+// fresh pages are neither cleared nor committed.
+static void zero_touched(sem_guest_mem_t* m, uint64_t heap_hw, uint64_t lo, uint64_t hi) {
+  const uint64_t a = hi < heap_hw ? hi : heap_hw;
+  if (lo < a) {
+    memset(m->buf + lo, 0, (size_t)(a - lo));
+    dirty_mark(m, lo, a - lo);
+  }
+  const uint64_t b = lo > m->stack_lw ? lo : m->stack_lw;
+  if (b < hi) {
+    memset(m->buf + b, 0, (size_t)(hi - b));
+    dirty_mark(m, b, hi - b);
+  }
+}
+
+// ---- Heap allocator ----
+//
+// Two-level segregated fit (TLSF): free blocks are binned by size into
+// SEM_GUEST_HEAP_FL power-of-two ranges, each split into SEM_GUEST_HEAP_SL
+// linear classes, with bitmaps over non-empty lists, so both alloc and free
+// are O(1). Each block starts with a one-granule (16-byte) header in guest
+// memory; free blocks keep their list links in the payload. Physical
+// neighbours are found through size/prev_size, so free coalesces immediately,
+// and a free block that ends at brk is handed back to the bump region (and
+// thus to the stack). Offsets and sizes are in granules.
+//
+// Headers are guest-writable, so every header and link is validated before
+// use; a corrupted heap can fail allocations but never reaches outside `buf`.
+
+#define HEAP_GRAN 16u
+#define HEAP_MIN_BLOCK 2u // granules: header + links
+#define HEAP_SL_LOG2 4u
+#define HEAP_NIL 0xFFFFFFFFu
+#define HEAP_MAGIC 0x5A484230u
+#define HEAP_FREE 1u
+
+typedef struct heap_hdr {
+  uint32_t size;      // whole block including the header
+  uint32_t prev_size; // size of the physically preceding block (0 for the first)
+  uint32_t tag;       // HEAP_MAGIC | HEAP_FREE
+  uint32_t pad;
+} heap_hdr_t;
+
+typedef struct heap_links {
+  uint32_t next;
+  uint32_t prev;
+} heap_links_t;
+
+static uint32_t fls_u32(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 31u - (uint32_t)__builtin_clz(x);
+#else
+  uint32_t r = 0;
+  while (x >>= 1) r++;
+  return r;
+#endif
+}
+
+static uint32_t ffs_u32(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (uint32_t)__builtin_ctz(x);
+#else
+  uint32_t r = 0;
+  while (!(x & 1u)) {
+    x >>= 1;
+    r++;
+  }
+  return r;
+#endif
+}
+
+static uint32_t heap_brk(const sem_guest_mem_t* m) {
+  return (uint32_t)(m->brk / HEAP_GRAN);
+}
+
+static void* heap_at(const sem_guest_mem_t* m, uint32_t g) {
+  return m->buf + (uint64_t)g * HEAP_GRAN;
+}
+
+// Marks a block's header and link granules as written.
+static void heap_dirty(sem_guest_mem_t* m, uint32_t g) {
+  dirty_mark(m, (uint64_t)g * HEAP_GRAN, HEAP_MIN_BLOCK * HEAP_GRAN);
+}
+
+static void heap_mapping(uint32_t size, uint32_t* fl, uint32_t* sl) {
+  if (size < (1u << HEAP_SL_LOG2)) {
+    *fl = 0;
+    *sl = size;
+    return;
+  }
+  const uint32_t f = fls_u32(size);
+  *sl = (size >> (f - HEAP_SL_LOG2)) ^ (1u << HEAP_SL_LOG2);
+  *fl = f - HEAP_SL_LOG2 + 1u;
+}
+
+static heap_hdr_t* heap_hdr(const sem_guest_mem_t* m, uint32_t off) {
+  const uint32_t brk = heap_brk(m);
+  if (off >= brk || brk - off < HEAP_MIN_BLOCK) return NULL;
+  heap_hdr_t* h = (heap_hdr_t*)heap_at(m, off);
+  if ((h->tag & ~HEAP_FREE) != HEAP_MAGIC) return NULL;
+  if (h->size < HEAP_MIN_BLOCK || h->size > brk - off) return NULL;
+  return h;
+}
+
+static heap_hdr_t* heap_free_hdr(const sem_guest_mem_t* m, uint32_t off) {
+  heap_hdr_t* h = (off == HEAP_NIL) ? NULL : heap_hdr(m, off);
+  return (h && (h->tag & HEAP_FREE)) ? h : NULL;
+}
+
+static heap_links_t* heap_links(const sem_guest_mem_t* m, uint32_t off) {
+  return (heap_links_t*)heap_at(m, off + 1u);
+}
+
+// Records that the block at `off` now has `size` granules in its successor's
+// prev_size, or in heap_top when it is the last block.
+static void heap_link_next(sem_guest_mem_t* m, uint32_t off, uint32_t size) {
+  const uint32_t next = off + size;
+  if (next >= heap_brk(m)) {
+    m->heap_top = size;
+    return;
+  }
+  heap_hdr_t* nh = heap_hdr(m, next);
+  if (!nh) return;
+  nh->prev_size = size;
+  heap_dirty(m, next);
+}
+
+static void heap_insert(sem_guest_mem_t* m, uint32_t off, heap_hdr_t* h) {
+  uint32_t fl = 0, sl = 0;
+  heap_mapping(h->size, &fl, &sl);
+  const uint32_t head = m->free_head[fl][sl];
+  heap_links_t* l = heap_links(m, off);
+  l->next = head;
+  l->prev = HEAP_NIL;
+  heap_dirty(m, off);
+  if (heap_free_hdr(m, head)) {
+    heap_links(m, head)->prev = off;
+    heap_dirty(m, head);
+  }
+  m->free_head[fl][sl] = off;
+  m->fl_bitmap |= 1u << fl;
+  m->sl_bitmap[fl] |= 1u << sl;
+  h->tag = HEAP_MAGIC | HEAP_FREE;
+}
+
+static void heap_unlink(sem_guest_mem_t* m, uint32_t off, heap_hdr_t* h) {
+  uint32_t fl = 0, sl = 0;
+  heap_mapping(h->size, &fl, &sl);
+  const heap_links_t l = *heap_links(m, off);
+  if (heap_free_hdr(m, l.prev)) {
+    heap_links(m, l.prev)->next = l.next;
+    heap_dirty(m, l.prev);
+  } else if (m->free_head[fl][sl] == off) {
+    m->free_head[fl][sl] = heap_free_hdr(m, l.next) ? l.next : HEAP_NIL;
+  }
+  if (heap_free_hdr(m, l.next)) {
+    heap_links(m, l.next)->prev = l.prev;
+    heap_dirty(m, l.next);
+  }
+  if (m->free_head[fl][sl] == HEAP_NIL) {
+    m->sl_bitmap[fl] &= ~(1u << sl);
+    if (m->sl_bitmap[fl] == 0) m->fl_bitmap &= ~(1u << fl);
+  }
+  h->tag = HEAP_MAGIC;
+  heap_dirty(m, off);
+}
+
+// Returns the head of a free list whose blocks are all at least `size` granules.
+static uint32_t heap_find(const sem_guest_mem_t* m, uint32_t size) {
+  if (size >= (1u << HEAP_SL_LOG2)) {
+    const uint32_t round = (1u << (fls_u32(size) - HEAP_SL_LOG2)) - 1u;
+    if (size > 0xFFFFFFFFu - round) return HEAP_NIL;
+    size += round;
+  }
+  uint32_t fl = 0, sl = 0;
+  heap_mapping(size, &fl, &sl);
+  if (fl >= SEM_GUEST_HEAP_FL) return HEAP_NIL;
+  uint32_t sl_map = m->sl_bitmap[fl] & (~0u << sl);
+  if (!sl_map) {
+    const uint32_t fl_map = m->fl_bitmap & (~0u << (fl + 1u));
+    if (!fl_map) return HEAP_NIL;
+    fl = ffs_u32(fl_map);
+    sl_map = m->sl_bitmap[fl];
+    if (!sl_map) return HEAP_NIL;
+  }
+  return m->free_head[fl][ffs_u32(sl_map)];
+}
+
+// Frees the (not yet listed) block at `off`, merging it with free neighbours.
+static void heap_release(sem_guest_mem_t* m, uint32_t off, heap_hdr_t* h) {
+  uint64_t size = h->size;
+  heap_hdr_t* nh = heap_free_hdr(m, off + h->size);
+  if (nh) {
+    heap_unlink(m, off + h->size, nh);
+    size += nh->size;
+  }
+  if (h->prev_size && h->prev_size <= off) {
+    const uint32_t poff = off - h->prev_size;
+    heap_hdr_t* ph = heap_free_hdr(m, poff);
+    if (ph && ph->size == h->prev_size) {
+      heap_unlink(m, poff, ph);
+      size += ph->size;
+      off = poff;
+      h = ph;
+    }
+  }
+  if ((uint64_t)off + size >= heap_brk(m)) {
+    m->brk = (uint64_t)off * HEAP_GRAN;
+    m->heap_top = h->prev_size;
+    return;
+  }
+  h->size = (uint32_t)size;
+  heap_link_next(m, off, h->size);
+  heap_insert(m, off, h); // marks the header dirty
+}
+
+// Splits `h` so it keeps `size` granules; the remainder becomes a free block.
+static void heap_split(sem_guest_mem_t* m, uint32_t off, heap_hdr_t* h, uint32_t size) {
+  const uint32_t rest = h->size - size;
+  heap_hdr_t* t = (heap_hdr_t*)heap_at(m, off + size);
+  *t = (heap_hdr_t){.size = rest, .prev_size = size, .tag = HEAP_MAGIC};
+  h->size = size;
+  heap_dirty(m, off);
+  heap_dirty(m, off + size);
+  heap_link_next(m, off + size, rest);
+  heap_release(m, off + size, t);
+}
+
 zi_ptr_t sem_guest_alloc(sem_guest_mem_t* m, zi_size32_t size, zi_size32_t align) {
   if (!m || !m->buf) return 0;
   if (size == 0) return 0;
   uint32_t a = align ? align : 16u;
   if ((a & (a - 1u)) != 0) return 0;
+  if (a < HEAP_GRAN) a = HEAP_GRAN;
+  const uint64_t heap_hw = m->heap_hw; // before this call grows the heap
+
+  // Header plus payload, in granules.
+  uint32_t need = 1u + (uint32_t)(((uint64_t)size + HEAP_GRAN - 1u) / HEAP_GRAN);
+  if (need < HEAP_MIN_BLOCK) need = HEAP_MIN_BLOCK;
+  // Over-aligned requests take enough slack to split off a free front block.
+  const uint32_t ag = a / HEAP_GRAN;
+  const uint32_t want = need + (ag > 1u ? ag + HEAP_MIN_BLOCK : 0u);
 
-  const uint32_t start = align_up_u32(m->brk, a);
-  const uint64_t end = (uint64_t)start + (uint64_t)size;
-  if (end > (uint64_t)m->cap) return 0;
-  m->brk = (uint32_t)end;
-  return (zi_ptr_t)(m->base + (uint64_t)start);
+  uint32_t off = heap_find(m, want);
+  heap_hdr_t* h = heap_free_hdr(m, off);
+  if (h && h->size >= want) {
+    heap_unlink(m, off, h);
+  } else {
+    // Extend the heap at brk.
+    const uint64_t bytes = (uint64_t)want * HEAP_GRAN;
+    if (m->sp < m->brk || bytes > m->sp - m->brk) return 0;
+    off = heap_brk(m);
+    h = (heap_hdr_t*)heap_at(m, off);
+    *h = (heap_hdr_t){.size = want, .prev_size = m->heap_top, .tag = HEAP_MAGIC};
+    heap_dirty(m, off);
+    m->brk += bytes;
+    m->heap_top = want;
+    if (m->brk > m->heap_hw) m->heap_hw = m->brk;
+  }
+
+  if (ag > 1u) {
+    const uint64_t hdr = m->base + (uint64_t)off * HEAP_GRAN;
+    const uint64_t p = (hdr + HEAP_GRAN + (a - 1u)) & ~(uint64_t)(a - 1u);
+    uint32_t gap = (uint32_t)((p - HEAP_GRAN - hdr) / HEAP_GRAN);
+    if (gap && gap < HEAP_MIN_BLOCK) gap += ag;
+    if (gap) {
+      heap_hdr_t* nh = (heap_hdr_t*)heap_at(m, off + gap);
+      *nh = (heap_hdr_t){.size = h->size - gap, .prev_size = gap, .tag = HEAP_MAGIC};
+      heap_dirty(m, off + gap);
+      heap_link_next(m, off + gap, nh->size);
+      h->size = gap;
+      heap_dirty(m, off);
+      heap_release(m, off, h);
+      off += gap;
+      h = nh;
+    }
+  }
+  if (h->size - need >= HEAP_MIN_BLOCK) heap_split(m, off, h, need);
+
+  const uint64_t payload = ((uint64_t)off + 1u) * HEAP_GRAN;
+  zero_touched(m, heap_hw, payload, payload + ((uint64_t)h->size - 1u) * HEAP_GRAN);
+  return (zi_ptr_t)(m->base + payload);
 }
 
 int32_t sem_guest_free(sem_guest_mem_t* m, zi_ptr_t ptr) {
-  (void)m;
-  if (ptr == 0) return -1;
+  if (!m || !m->buf) return -1;
+  if (ptr == 0 || ptr < m->base + HEAP_GRAN) return -1;
+  const uint64_t off = ptr - m->base - HEAP_GRAN;
+  if (off >= m->brk || (off % HEAP_GRAN) != 0) return -1;
+  heap_hdr_t* h = heap_hdr(m, (uint32_t)(off / HEAP_GRAN));
+  if (!h || (h->tag & HEAP_FREE)) return -1;
+  heap_release(m, (uint32_t)(off / HEAP_GRAN), h);
   return 0;
 }
 
+uint64_t sem_guest_stack_save(const sem_guest_mem_t* m) {
+  return m ? m->sp : 0;
+}
+
+void sem_guest_stack_restore(sem_guest_mem_t* m, uint64_t sp) {
+  if (!m || !m->buf) return;
+  if (sp < m->sp || sp > m->cap) return;
+  m->sp = sp;
+}
+
+zi_ptr_t sem_guest_stack_alloc(sem_guest_mem_t* m, zi_size32_t size, zi_size32_t align) {
+  if (!m || !m->buf) return 0;
+  if (size == 0) return 0;
+  uint32_t a = align ? align : 16u;
+  if ((a & (a - 1u)) != 0) return 0;
+
+  if (size > m->sp) return 0;
+  const uint64_t start = (m->sp - size) & ~(uint64_t)(a - 1u);
+  if (start < m->brk) return 0;
+  zero_touched(m, m->heap_hw, start, m->sp);
+  m->sp = start;
+  if (start < m->stack_lw) m->stack_lw = start;
+  return (zi_ptr_t)(m->base + start);
+}
+
+// ---- Snapshots ----
+
+static bool dirty_arm(sem_guest_mem_t* m) {
+  const uint64_t words = (m->cap + (uint64_t)SEM_GUEST_PAGE * 64u - 1u) / ((uint64_t)SEM_GUEST_PAGE * 64u);
+  if (!m->dirty) {
+    if (words > SIZE_MAX / sizeof(uint64_t)) return false;
+    m->dirty = (uint64_t*)calloc((size_t)words, sizeof(uint64_t));
+    return m->dirty != NULL;
+  }
+  memset(m->dirty, 0, (size_t)words * sizeof(uint64_t));
+  return true;
+}
+
+// Copies the allocator and stack state (everything but the buffers).
+static void state_copy(sem_guest_mem_t* dst, const sem_guest_mem_t* src) {
+  dst->brk = src->brk;
+  dst->sp = src->sp;
+  dst->heap_hw = src->heap_hw;
+  dst->stack_lw = src->stack_lw;
+  dst->heap_top = src->heap_top;
+  dst->fl_bitmap = src->fl_bitmap;
+  memcpy(dst->sl_bitmap, src->sl_bitmap, sizeof(dst->sl_bitmap));
+  memcpy(dst->free_head, src->free_head, sizeof(dst->free_head));
+}
+
+// Rewrites [lo, hi) of `m` with the snapshot contents (zero where the
+// snapshot holds no data).
+static void snapshot_copy(sem_guest_mem_t* m, const sem_guest_snapshot_t* s, uint64_t lo, uint64_t hi) {
+  const uint64_t hw = s->state.heap_hw;
+  const uint64_t lw = s->state.stack_lw;
+  const uint64_t a = hi < hw ? hi : hw;
+  if (lo < a) memcpy(m->buf + lo, s->data + lo, (size_t)(a - lo));
+  const uint64_t z0 = lo > hw ? lo : hw;
+  const uint64_t z1 = hi < lw ? hi : lw;
+  if (z0 < z1) memset(m->buf + z0, 0, (size_t)(z1 - z0));
+  const uint64_t c = lo > lw ? lo : lw;
+  if (c < hi) memcpy(m->buf + c, s->data + hw + (c - lw), (size_t)(hi - c));
+}
+
+bool sem_guest_snapshot_take(sem_guest_mem_t* m, sem_guest_snapshot_t* out) {
+  if (!m || !m->buf || !out) return false;
+  memset(out, 0, sizeof(*out));
+  const uint64_t lo = m->heap_hw;
+  const uint64_t hi = m->cap - m->stack_lw;
+  if (lo + hi >= (uint64_t)SIZE_MAX) return false;
+  uint8_t* data = (uint8_t*)malloc((size_t)(lo + hi + 1u));
+  if (!data) return false;
+  memcpy(data, m->buf, (size_t)lo);
+  memcpy(data + lo, m->buf + m->stack_lw, (size_t)hi);
+  if (!dirty_arm(m)) {
+    free(data);
+    return false;
+  }
+  out->state.cap = m->cap;
+  out->state.base = m->base;
+  state_copy(&out->state, m);
+  out->data = data;
+  m->dirty_ref = data;
+  return true;
+}
+
+bool sem_guest_snapshot_restore(sem_guest_mem_t* m, const sem_guest_snapshot_t* s) {
+  if (!m || !m->buf || !s || !s->data) return false;
+  if (m->cap != s->state.cap || m->base != s->state.base) return false;
+
+  if (m->dirty && m->dirty_ref == s->data) {
+    const uint64_t words = (m->cap + (uint64_t)SEM_GUEST_PAGE * 64u - 1u) / ((uint64_t)SEM_GUEST_PAGE * 64u);
+    for (uint64_t w = 0; w < words; w++) {
+      uint64_t bits = m->dirty[w];
+      while (bits) {
+        const uint32_t lo32 = (uint32_t)bits;
+        const uint64_t p = w * 64u + (lo32 ? ffs_u32(lo32) : 32u + ffs_u32((uint32_t)(bits >> 32)));
+        bits &= bits - 1u;
+        const uint64_t lo = p * SEM_GUEST_PAGE;
+        const uint64_t hi = lo + SEM_GUEST_PAGE < m->cap ? lo + SEM_GUEST_PAGE : m->cap;
+        snapshot_copy(m, s, lo, hi);
+      }
+      m->dirty[w] = 0;
+    }
+  } else {
+    // Unknown history: rewrite everything either side may have written.
+    const uint64_t hw = m->heap_hw > s->state.heap_hw ? m->heap_hw : s->state.heap_hw;
+    const uint64_t lw = m->stack_lw < s->state.stack_lw ? m->stack_lw : s->state.stack_lw;
+    if (lw <= hw) {
+      snapshot_copy(m, s, 0, m->cap);
+    } else {
+      snapshot_copy(m, s, 0, hw);
+      snapshot_copy(m, s, lw, m->cap);
+    }
+    if (!dirty_arm(m)) return false;
+  }
+  state_copy(m, &s->state);
+  m->dirty_ref = s->data;
+  return true;
+}
+
+bool sem_guest_snapshot_fork(const sem_guest_snapshot_t* s, sem_guest_mem_t* out) {
+  if (!s || !s->data || !out) return false;
+  if (!sem_guest_mem_init(out, s->state.cap, s->state.base)) return false;
+  const uint64_t hw = s->state.heap_hw;
+  const uint64_t lw = s->state.stack_lw;
+  memcpy(out->buf, s->data, (size_t)hw);
+  memcpy(out->buf + lw, s->data + hw, (size_t)(out->cap - lw));
+  state_copy(out, &s->state);
+  if (!dirty_arm(out)) {
+    sem_guest_mem_dispose(out);
+    return false;
+  }
+  out->dirty_ref = s->data;
+  return true;
+}
+
+void sem_guest_snapshot_dispose(sem_guest_snapshot_t* s) {
+  if (!s) return;
+  free(s->data);
+  memset(s, 0, sizeof(*s));
+}
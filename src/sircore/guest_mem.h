@@ -6,23 +6,85 @@
 typedef uint64_t zi_ptr_t;
 typedef uint32_t zi_size32_t;
 
+// Heap free-list geometry (first level: power-of-two ranges, second level:
+// linear subdivisions of each range). See guest_mem.c.
+#define SEM_GUEST_HEAP_FL 29
+#define SEM_GUEST_HEAP_SL 16
+
+#define SEM_GUEST_PAGE 4096u
+
+// Largest supported guest capacity (just under 64 GiB): the heap addresses
+// blocks by 32-bit 16-byte granule index.
+#define SEM_GUEST_MEM_MAX_CAP (UINT64_C(0xFFFFFFFF) << 4)
+
 typedef struct sem_guest_mem {
   uint8_t* buf;
-  uint32_t cap;
-  uint32_t brk;
+  uint64_t cap;
+  uint64_t brk;
+  uint64_t sp; // guest stack pointer; the stack is [sp, cap) and grows down toward brk
   uint64_t base;
+
+  // Bytes below heap_hw and at or above stack_lw may have been written; the
+  // window between them is still untouched (zero, and uncommitted when mmap'd).
+  uint64_t heap_hw;
+  uint64_t stack_lw;
+  void* map;        // mmap reservation including guard pages (NULL when calloc'd)
+  uint64_t map_len;
+
+  // Pages (SEM_GUEST_PAGE bytes) written since the last snapshot take, fork or
+  // restore; NULL until a snapshot arms tracking. dirty_ref identifies the
+  // snapshot the bitmap is relative to.
+  uint64_t* dirty;
+  const uint8_t* dirty_ref;
+
+  // Heap allocator state, in granules. Block headers live in guest memory.
+  uint32_t heap_top; // size of the block ending at brk (0 when the heap is empty)
+  uint32_t fl_bitmap;
+  uint32_t sl_bitmap[SEM_GUEST_HEAP_FL];
+  uint32_t free_head[SEM_GUEST_HEAP_FL][SEM_GUEST_HEAP_SL];
 } sem_guest_mem_t;
 
-// Initializes guest memory to a zeroed heap of `cap` bytes.
-// Guest pointers are offsets from `base` (base != 0).
-bool sem_guest_mem_init(sem_guest_mem_t* m, uint32_t cap, uint64_t base);
+// Initializes guest memory to a zeroed heap of `cap` bytes (up to
+// SEM_GUEST_MEM_MAX_CAP). Guest pointers are offsets from `base` (base != 0).
+// On POSIX hosts the buffer is an mmap reservation: pages are committed on
+// first touch and a guard page sits on either side of it.
+// The heap grows up from offset 0 and the guest stack grows down from `cap`;
+// allocation fails when the two would meet.
+bool sem_guest_mem_init(sem_guest_mem_t* m, uint64_t cap, uint64_t base);
+
+// Like sem_guest_mem_init, but base is the buffer's host address, so guest
+// pointers are host pointers that native (JIT) code can dereference directly.
+bool sem_guest_mem_init_native(sem_guest_mem_t* m, uint64_t cap);
 void sem_guest_mem_dispose(sem_guest_mem_t* m);
 
 // Maps guest memory into host pointers for copying.
 bool sem_guest_mem_map_ro(const sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t len, const uint8_t** out);
 bool sem_guest_mem_map_rw(sem_guest_mem_t* m, zi_ptr_t ptr, zi_size32_t len, uint8_t** out);
 
-// Simple deterministic bump allocator (MVP). `free` does not reuse memory.
+// Deterministic heap allocator with O(1) alloc/free and coalescing. Returned
+// memory is zeroed. `free` returns 0, or -1 for a pointer that is not a live
+// allocation (including double frees).
 zi_ptr_t sem_guest_alloc(sem_guest_mem_t* m, zi_size32_t size, zi_size32_t align);
 int32_t sem_guest_free(sem_guest_mem_t* m, zi_ptr_t ptr);
 
+// Guest stack (ALLOCA). Callers save the stack pointer on function entry and
+// restore it on return, which releases everything allocated in between.
+// Stack memory is zeroed on allocation so reuse stays deterministic.
+uint64_t sem_guest_stack_save(const sem_guest_mem_t* m);
+void sem_guest_stack_restore(sem_guest_mem_t* m, uint64_t sp);
+zi_ptr_t sem_guest_stack_alloc(sem_guest_mem_t* m, zi_size32_t size, zi_size32_t align);
+
+// Snapshots. A snapshot holds the written parts of guest memory plus the
+// allocator and stack state. Taking one arms dirty-page tracking on `m`, so
+// restoring `m` (or a fork of the snapshot) rewrites only pages written since.
+// Forking creates a new memory that shares nothing with the original and
+// copies only the pages the snapshot holds.
+typedef struct sem_guest_snapshot {
+  sem_guest_mem_t state; // allocator/stack fields only; no buffers are owned
+  uint8_t* data;         // [0, state.heap_hw) then [state.stack_lw, state.cap)
+} sem_guest_snapshot_t;
+
+bool sem_guest_snapshot_take(sem_guest_mem_t* m, sem_guest_snapshot_t* out);
+bool sem_guest_snapshot_restore(sem_guest_mem_t* m, const sem_guest_snapshot_t* s);
+bool sem_guest_snapshot_fork(const sem_guest_snapshot_t* s, sem_guest_mem_t* out);
+void sem_guest_snapshot_dispose(sem_guest_snapshot_t* s);
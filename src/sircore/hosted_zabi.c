@@ -20,6 +20,8 @@
 #include "zi_sys_loop25.h"
 #include "zi_sysabi25.h"
 
+#include <pthread.h>
+
 static int sir_zi_mem_map_ro(void* ctx, zi_ptr_t ptr, zi_size32_t len, const uint8_t** out) {
   sir_hosted_zabi_t* rt = (sir_hosted_zabi_t*)ctx;
   if (!rt || !rt->mem || !out) return 0;
@@ -32,12 +34,120 @@ static int sir_zi_mem_map_rw(void* ctx, zi_ptr_t ptr, zi_size32_t len, uint8_t**
   return sem_guest_mem_map_rw(rt->mem, ptr, len, out) ? 1 : 0;
 }
 
-static void sir_zingcore_bind(sir_hosted_zabi_t* rt) {
-  if (!rt) return;
+// zingcore25 keeps one process-global runtime (guest memory, argv, env).
+// Every call into it holds this lock and binds the calling instance first, so
+// concurrent instances each see their own state.
+static pthread_mutex_t sir_zingcore_mu = PTHREAD_MUTEX_INITIALIZER;
+
+// The process's own ZI_FS_ROOT (NULL if unset), captured at init.
+static char* sir_zingcore_fs_root0 = NULL;
+
+static void sir_zingcore_enter(sir_hosted_zabi_t* rt) {
+  (void)pthread_mutex_lock(&sir_zingcore_mu);
   zi_runtime25_set_mem(&rt->zi_mem);
-  if (rt->zi_envp_owned) {
-    zi_runtime25_set_env((int)rt->zi_envc_owned, (const char* const*)rt->zi_envp_owned);
+  if (rt->ctl_host.cfg.argv_enabled) {
+    zi_runtime25_set_argv((int)rt->ctl_host.cfg.argv_count, rt->ctl_host.cfg.argv);
+  } else {
+    zi_runtime25_set_argv(0, NULL);
   }
+  zi_runtime25_set_env((int)rt->zi_envc_owned, rt->zi_envp_owned ? (const char* const*)rt->zi_envp_owned : NULL);
+}
+
+static void sir_zingcore_leave(void) {
+  (void)pthread_mutex_unlock(&sir_zingcore_mu);
+}
+
+// Initializes zingcore25 once per process; later instances share it.
+static bool sir_zingcore_init_once(void) {
+  static bool ready = false;
+  (void)pthread_mutex_lock(&sir_zingcore_mu);
+  if (!ready && zingcore25_init()) {
+    (void)zi_handles25_init();
+    const char* root = getenv("ZI_FS_ROOT");
+    if (root) {
+      const size_t n = strlen(root) + 1u;
+      sir_zingcore_fs_root0 = (char*)malloc(n);
+      if (sir_zingcore_fs_root0) memcpy(sir_zingcore_fs_root0, root, n);
+    }
+    ready = true;
+  }
+  const bool ok = ready;
+  (void)pthread_mutex_unlock(&sir_zingcore_mu);
+  return ok;
+}
+
+// zingcore25 takes the sandbox root from ZI_FS_ROOT when file/aio opens, so
+// the instance's root is put there for that call only and the process's own
+// value restored right after (lock held). Instances without a root open
+// against the process's value, as a standalone run would.
+static zi_handle_t sir_zingcore_open_file_aio(sir_hosted_zabi_t* rt, zi_ptr_t params_ptr, zi_size32_t params_len) {
+  if (rt->fs_root) (void)setenv("ZI_FS_ROOT", rt->fs_root, 1);
+  const zi_handle_t h = zi_file_aio25_open_from_params(params_ptr, params_len);
+  if (rt->fs_root) {
+    if (sir_zingcore_fs_root0) (void)setenv("ZI_FS_ROOT", sir_zingcore_fs_root0, 1);
+    else (void)unsetenv("ZI_FS_ROOT");
+  }
+  return h;
+}
+
+// Handles opened through zingcore25 are entered in the instance's table under
+// the same number, so other instances cannot reach them and dispose/restore
+// end them like any other handle.
+typedef struct sir_zingcore_handle {
+  sir_hosted_zabi_t* rt;
+  zi_handle_t h;
+} sir_zingcore_handle_t;
+
+static int32_t zingcore_read(void* ctx, sem_guest_mem_t* mem, zi_ptr_t dst_ptr, zi_size32_t cap) {
+  (void)mem;
+  sir_zingcore_handle_t* z = (sir_zingcore_handle_t*)ctx;
+  sir_zingcore_enter(z->rt);
+  const int32_t r = zi_read(z->h, dst_ptr, cap);
+  sir_zingcore_leave();
+  return r;
+}
+
+static int32_t zingcore_write(void* ctx, sem_guest_mem_t* mem, zi_ptr_t src_ptr, zi_size32_t len) {
+  (void)mem;
+  sir_zingcore_handle_t* z = (sir_zingcore_handle_t*)ctx;
+  sir_zingcore_enter(z->rt);
+  const int32_t r = zi_write(z->h, src_ptr, len);
+  sir_zingcore_leave();
+  return r;
+}
+
+static int32_t zingcore_end(void* ctx, sem_guest_mem_t* mem) {
+  (void)mem;
+  sir_zingcore_handle_t* z = (sir_zingcore_handle_t*)ctx;
+  sir_zingcore_enter(z->rt);
+  const int32_t r = zi_end(z->h);
+  sir_zingcore_leave();
+  free(z);
+  return r;
+}
+
+static const sem_handle_ops_t zingcore_ops = {
+    .read = zingcore_read,
+    .write = zingcore_write,
+    .end = zingcore_end,
+    .poll_fd = NULL,
+    .poll_ready = NULL,
+};
+
+// Takes ownership of a handle zingcore25 just opened for rt (lock held).
+static zi_handle_t sir_zingcore_adopt(sir_hosted_zabi_t* rt, zi_handle_t h) {
+  if (h < 0) return h;
+  sir_zingcore_handle_t* z = (sir_zingcore_handle_t*)calloc(1, sizeof(*z));
+  sem_handle_entry_t prev;
+  if (!z || h < 3 || sem_handle_lookup(&rt->handles, h, &prev) ||
+      !sem_handle_install(&rt->handles, h, (sem_handle_entry_t){.ops = &zingcore_ops, .ctx = z, .hflags = zi_handle_hflags(h)})) {
+    free(z);
+    (void)zi_end(h);
+    return (zi_handle_t)ZI_E_INTERNAL;
+  }
+  z->rt = rt;
+  z->h = h;
+  return h;
 }
 #endif
 
@@ -122,16 +232,7 @@ int32_t sir_zi_cap_get(sir_hosted_zabi_t* rt, int32_t index, zi_ptr_t out_ptr, z
 
 uint32_t sir_zi_handle_hflags(sir_hosted_zabi_t* rt, zi_handle_t h) {
   if (!rt) return 0;
-  const uint32_t f = sem_handle_hflags(&rt->handles, h);
-  if (f) return f;
-
-#ifdef SIR_HAVE_ZINGCORE25
-  if (h >= 3) {
-    sir_zingcore_bind(rt);
-    return zi_handle_hflags(h);
-  }
-#endif
-  return 0;
+  return sem_handle_hflags(&rt->handles, h);
 }
 
 typedef struct sir_stdio_stream {
@@ -241,6 +342,21 @@ void sir_hosted_zabi_dispose(sir_hosted_zabi_t* rt) {
   memset(rt, 0, sizeof(*rt));
 }
 
+bool sir_hosted_zabi_getenv(const char* name, char* buf, size_t cap) {
+  if (!name || !buf || cap == 0) return false;
+#ifdef SIR_HAVE_ZINGCORE25
+  (void)pthread_mutex_lock(&sir_zingcore_mu);
+#endif
+  const char* v = getenv(name);
+  const size_t n = v ? strlen(v) : 0;
+  const bool ok = v != NULL && n < cap;
+  if (ok) memcpy(buf, v, n + 1u);
+#ifdef SIR_HAVE_ZINGCORE25
+  (void)pthread_mutex_unlock(&sir_zingcore_mu);
+#endif
+  return ok;
+}
+
 uint32_t sir_zi_abi_version(const sir_hosted_zabi_t* rt) {
   return rt ? rt->abi_version : 0x00020005u;
 }
@@ -250,6 +366,45 @@ zi_ptr_t sir_zi_alloc(sir_hosted_zabi_t* rt, zi_size32_t size) {
   return sem_guest_alloc(rt->mem, size, 16);
 }
 
+bool sir_hosted_zabi_snapshot_take(sir_hosted_zabi_t* rt, sir_hosted_zabi_snapshot_t* out) {
+  if (!rt || !rt->mem || !out) return false;
+  memset(out, 0, sizeof(*out));
+  sem_handle_entry_t* handles = (sem_handle_entry_t*)malloc((size_t)rt->handles.cap * sizeof(*handles));
+  if (!handles) return false;
+  if (!sem_guest_snapshot_take(rt->mem, &out->mem)) {
+    free(handles);
+    return false;
+  }
+  memcpy(handles, rt->handles.entries, (size_t)rt->handles.cap * sizeof(*handles));
+  out->handles = handles;
+  out->handle_cap = rt->handles.cap;
+  out->handle_next = rt->handles.next;
+  return true;
+}
+
+bool sir_hosted_zabi_snapshot_restore(sir_hosted_zabi_t* rt, const sir_hosted_zabi_snapshot_t* s) {
+  if (!rt || !rt->mem || !s || !s->handles || s->handle_cap != rt->handles.cap) return false;
+
+  // End handles opened since the snapshot (while guest memory is still theirs).
+  for (zi_handle_t h = 3; h < (zi_handle_t)rt->handles.cap; h++) {
+    sem_handle_entry_t e;
+    if (!sem_handle_lookup(&rt->handles, h, &e)) continue;
+    const sem_handle_entry_t* was = &s->handles[h];
+    if (e.ops == was->ops && e.ctx == was->ctx) continue;
+    if (e.ops->end) (void)e.ops->end(e.ctx, rt->mem);
+    (void)sem_handle_release(&rt->handles, h);
+  }
+  rt->handles.next = s->handle_next;
+  return sem_guest_snapshot_restore(rt->mem, &s->mem);
+}
+
+void sir_hosted_zabi_snapshot_dispose(sir_hosted_zabi_snapshot_t* s) {
+  if (!s) return;
+  sem_guest_snapshot_dispose(&s->mem);
+  free(s->handles);
+  memset(s, 0, sizeof(*s));
+}
+
 int32_t sir_zi_free(sir_hosted_zabi_t* rt, zi_ptr_t ptr) {
   if (!rt) return ZI_E_INTERNAL;
   return sem_guest_free(rt->mem, ptr);
@@ -263,12 +418,6 @@ int32_t sir_zi_read(sir_hosted_zabi_t* rt, zi_handle_t h, zi_ptr_t dst_ptr, zi_s
     return e.ops->read(e.ctx, rt->mem, dst_ptr, cap);
   }
 
-#ifdef SIR_HAVE_ZINGCORE25
-  if (h >= 3) {
-    sir_zingcore_bind(rt);
-    return zi_read(h, dst_ptr, cap);
-  }
-#endif
   return ZI_E_NOSYS;
 }
 
@@ -280,12 +429,6 @@ int32_t sir_zi_write(sir_hosted_zabi_t* rt, zi_handle_t h, zi_ptr_t src_ptr, zi_
     return e.ops->write(e.ctx, rt->mem, src_ptr, len);
   }
 
-#ifdef SIR_HAVE_ZINGCORE25
-  if (h >= 3) {
-    sir_zingcore_bind(rt);
-    return zi_write(h, src_ptr, len);
-  }
-#endif
   return ZI_E_NOSYS;
 }
 
@@ -299,12 +442,6 @@ int32_t sir_zi_end(sir_hosted_zabi_t* rt, zi_handle_t h) {
     return r;
   }
 
-#ifdef SIR_HAVE_ZINGCORE25
-  if (h >= 3) {
-    sir_zingcore_bind(rt);
-    return zi_end(h);
-  }
-#endif
   return ZI_E_NOSYS;
 }
 
@@ -314,7 +451,7 @@ int32_t sir_zi_telemetry(sir_hosted_zabi_t* rt, zi_ptr_t topic_ptr, zi_size32_t
   const uint8_t* msg = NULL;
   if (topic_len && (!sem_guest_mem_map_ro(rt->mem, topic_ptr, topic_len, &topic) || !topic)) return ZI_E_BOUNDS;
   if (msg_len && (!sem_guest_mem_map_ro(rt->mem, msg_ptr, msg_len, &msg) || !msg)) return ZI_E_BOUNDS;
-  fprintf(stderr, "telemetry[%.*s]: %.*s\n", (int)topic_len, (const char*)topic, (int)msg_len, (const char*)msg);
+  fprintf(rt->std_err, "telemetry[%.*s]: %.*s\n", (int)topic_len, (const char*)topic, (int)msg_len, (const char*)msg);
   return 0;
 }
 
@@ -368,32 +505,38 @@ zi_handle_t sir_zi_cap_open(sir_hosted_zabi_t* rt, zi_ptr_t req_ptr) {
   if ((found->flags & SEM_ZI_CAP_CAN_OPEN) == 0) return (zi_handle_t)ZI_E_DENIED;
 
 #ifdef SIR_HAVE_ZINGCORE25
-  // Golden caps are implemented by zingcore25; open them here and return the
-  // zingcore-owned handle directly so sys/loop readiness integration works.
-  sir_zingcore_bind(rt);
-
-  if (strcmp(found->kind, "sys") == 0 && strcmp(found->name, "loop") == 0) {
-    return zi_sys_loop25_open_from_params((zi_ptr_t)params_ptr, (zi_size32_t)params_len);
-  }
-  if (strcmp(found->kind, "file") == 0 && strcmp(found->name, "aio") == 0) {
-    return zi_file_aio25_open_from_params((zi_ptr_t)params_ptr, (zi_size32_t)params_len);
-  }
-  if (strcmp(found->kind, "net") == 0 && strcmp(found->name, "tcp") == 0) {
-    return zi_net_tcp25_open_from_params((zi_ptr_t)params_ptr, (zi_size32_t)params_len);
-  }
+  // Golden caps are implemented by zingcore25; open them here and keep the
+  // zingcore handle number so sys/loop readiness integration works.
   if (strcmp(found->kind, "proc") == 0 && strcmp(found->name, "argv") == 0) {
     if (!rt->ctl_host.cfg.argv_enabled) return (zi_handle_t)ZI_E_DENIED;
     if (params_len != 0) return (zi_handle_t)ZI_E_INVALID;
-    return zi_proc_argv25_open();
   }
   if (strcmp(found->kind, "proc") == 0 && strcmp(found->name, "env") == 0) {
     if (!rt->ctl_host.cfg.env_enabled) return (zi_handle_t)ZI_E_DENIED;
     if (params_len != 0) return (zi_handle_t)ZI_E_INVALID;
-    return zi_proc_env25_open();
   }
-  if (strcmp(found->kind, "sys") == 0 && strcmp(found->name, "info") == 0) {
-    return zi_sys_info25_open_from_params((zi_ptr_t)params_ptr, (zi_size32_t)params_len);
+
+  bool golden = true;
+  zi_handle_t gh = (zi_handle_t)ZI_E_NOSYS;
+  sir_zingcore_enter(rt);
+  if (strcmp(found->kind, "sys") == 0 && strcmp(found->name, "loop") == 0) {
+    gh = zi_sys_loop25_open_from_params((zi_ptr_t)params_ptr, (zi_size32_t)params_len);
+  } else if (strcmp(found->kind, "file") == 0 && strcmp(found->name, "aio") == 0) {
+    gh = sir_zingcore_open_file_aio(rt, (zi_ptr_t)params_ptr, (zi_size32_t)params_len);
+  } else if (strcmp(found->kind, "net") == 0 && strcmp(found->name, "tcp") == 0) {
+    gh = zi_net_tcp25_open_from_params((zi_ptr_t)params_ptr, (zi_size32_t)params_len);
+  } else if (strcmp(found->kind, "proc") == 0 && strcmp(found->name, "argv") == 0) {
+    gh = zi_proc_argv25_open();
+  } else if (strcmp(found->kind, "proc") == 0 && strcmp(found->name, "env") == 0) {
+    gh = zi_proc_env25_open();
+  } else if (strcmp(found->kind, "sys") == 0 && strcmp(found->name, "info") == 0) {
+    gh = zi_sys_info25_open_from_params((zi_ptr_t)params_ptr, (zi_size32_t)params_len);
+  } else {
+    golden = false;
   }
+  if (golden) gh = sir_zingcore_adopt(rt, gh);
+  sir_zingcore_leave();
+  if (golden) return gh;
 #endif
 
   if (strcmp(found->kind, "file") == 0 && strcmp(found->name, "fs") == 0) return (zi_handle_t)ZI_E_NOSYS;
@@ -432,24 +575,17 @@ bool sir_hosted_zabi_init_with_mem(sir_hosted_zabi_t* rt, sem_guest_mem_t* mem,
   rt->fs_root = (cfg.fs_root && cfg.fs_root[0] != '\0') ? cfg.fs_root : NULL;
 
 #ifdef SIR_HAVE_ZINGCORE25
-  // Process-global zingcore runtime wiring.
-  if (!zingcore25_init()) {
+  // The zingcore runtime is process-global; this instance's memory, argv and
+  // env are bound on every call into it (sir_zingcore_enter).
+  if (!sir_zingcore_init_once()) {
     sem_handles_dispose(&rt->handles);
     return false;
   }
-  (void)zi_handles25_init();
 
   memset(&rt->zi_mem, 0, sizeof(rt->zi_mem));
   rt->zi_mem.ctx = rt;
   rt->zi_mem.map_ro = sir_zi_mem_map_ro;
   rt->zi_mem.map_rw = sir_zi_mem_map_rw;
-  zi_runtime25_set_mem(&rt->zi_mem);
-
-  if (cfg.argv_enabled) {
-    zi_runtime25_set_argv((int)cfg.argv_count, cfg.argv);
-  } else {
-    zi_runtime25_set_argv(0, NULL);
-  }
 
   if (cfg.env_enabled && cfg.env && cfg.env_count) {
     rt->zi_envc_owned = cfg.env_count;
@@ -479,13 +615,6 @@ bool sir_hosted_zabi_init_with_mem(sir_hosted_zabi_t* rt, sem_guest_mem_t* mem,
       memcpy(s + kl + 1u, v, vl);
       rt->zi_envp_owned[i] = s;
     }
-    zi_runtime25_set_env((int)rt->zi_envc_owned, (const char* const*)rt->zi_envp_owned);
-  } else {
-    zi_runtime25_set_env(0, NULL);
-  }
-
-  if (rt->fs_root && rt->fs_root[0] != '\0') {
-    (void)setenv("ZI_FS_ROOT", rt->fs_root, 1);
   }
 #endif
 
@@ -510,9 +639,10 @@ bool sir_hosted_zabi_init_with_mem(sir_hosted_zabi_t* rt, sem_guest_mem_t* mem,
     sem_handles_dispose(&rt->handles);
     return false;
   }
-  in->f = stdin;
-  out->f = stdout;
-  err->f = stderr;
+  in->f = cfg.std_in ? cfg.std_in : stdin;
+  out->f = cfg.std_out ? cfg.std_out : stdout;
+  err->f = cfg.std_err ? cfg.std_err : stderr;
+  rt->std_err = err->f;
 
   (void)sem_handle_install(&rt->handles, 0,
                            (sem_handle_entry_t){.ops = &stdio_ops, .ctx = in, .hflags = ZI_H_READABLE | ZI_H_ENDABLE});
@@ -2,6 +2,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "guest_mem.h"
 #include "handles.h"
@@ -20,6 +21,10 @@
 //
 // The intent is that `sircore` (the interpreter) can target this surface for
 // development, while AOT-lowered binaries target the same zABI names.
+//
+// All runtime state (memory, handles, caps, stdio bindings) lives in the
+// instance, so separate instances may run on separate threads. One instance
+// must not be entered from two threads at once.
 
 typedef struct sir_hosted_zabi {
   // Guest memory is owned by the embedding VM/tool.
@@ -31,10 +36,11 @@ typedef struct sir_hosted_zabi {
   sem_host_t ctl_host; // zi_ctl ops (e.g. CAPS_LIST)
   uint32_t abi_version;
   const char* fs_root;
+  FILE* std_err; // handle 2's stream; also receives telemetry
 
 #ifdef SIR_HAVE_ZINGCORE25
-  // Process-global zingcore25 wiring is driven from the hosted runtime.
-  // These snapshots are owned by the runtime instance.
+  // zingcore25 is process-global; these are bound into it on every call.
+  // The snapshots are owned by the runtime instance.
   zi_mem_v1 zi_mem;
   char** zi_envp_owned;
   uint32_t zi_envc_owned;
@@ -43,7 +49,7 @@ typedef struct sir_hosted_zabi {
 
 typedef struct sir_hosted_zabi_cfg {
   uint32_t abi_version;   // e.g. 0x00020005
-  uint32_t guest_mem_cap; // bytes
+  uint64_t guest_mem_cap; // bytes, up to SEM_GUEST_MEM_MAX_CAP
   uint64_t guest_mem_base;
 
   // Capability entries exposed by CAPS_LIST.
@@ -59,8 +65,15 @@ typedef struct sir_hosted_zabi_cfg {
   const sem_env_kv_t* env;
   uint32_t env_count;
 
-  // Optional: sandbox root for file/aio (propagated as ZI_FS_ROOT).
+  // Optional: sandbox root for file/aio (set as ZI_FS_ROOT while file/aio
+  // opens; other instances never see it).
   const char* fs_root;
+
+  // Optional: streams behind handles 0/1/2 (NULL: the process stdin/stdout/
+  // stderr). Not owned by the runtime.
+  FILE* std_in;
+  FILE* std_out;
+  FILE* std_err;
 } sir_hosted_zabi_cfg_t;
 
 bool sir_hosted_zabi_init(sir_hosted_zabi_t* rt, sir_hosted_zabi_cfg_t cfg);
@@ -69,6 +82,26 @@ void sir_hosted_zabi_dispose(sir_hosted_zabi_t* rt);
 // Initializes using an externally owned guest memory arena.
 bool sir_hosted_zabi_init_with_mem(sir_hosted_zabi_t* rt, sem_guest_mem_t* mem, sir_hosted_zabi_cfg_t cfg);
 
+// Checkpoint of the runtime: guest memory plus the handle table. Restoring
+// rewinds guest memory (see sem_guest_snapshot_t) and ends every handle opened
+// since the snapshot, including ones opened through zingcore25. Handles
+// ended since the snapshot stay closed.
+typedef struct sir_hosted_zabi_snapshot {
+  sem_guest_snapshot_t mem;
+  sem_handle_entry_t* handles;
+  uint32_t handle_cap;
+  zi_handle_t handle_next;
+} sir_hosted_zabi_snapshot_t;
+
+bool sir_hosted_zabi_snapshot_take(sir_hosted_zabi_t* rt, sir_hosted_zabi_snapshot_t* out);
+bool sir_hosted_zabi_snapshot_restore(sir_hosted_zabi_t* rt, const sir_hosted_zabi_snapshot_t* s);
+void sir_hosted_zabi_snapshot_dispose(sir_hosted_zabi_snapshot_t* s);
+
+// getenv() that is safe while hosted instances run on other threads: with
+// zingcore25 they rewrite ZI_FS_ROOT in the process environment. Copies the
+// value into buf; false when unset or longer than cap - 1.
+bool sir_hosted_zabi_getenv(const char* name, char* buf, size_t cap);
+
 // --- zABI core surface (hosted) ---
 uint32_t sir_zi_abi_version(const sir_hosted_zabi_t* rt);
 int32_t sir_zi_ctl(sir_hosted_zabi_t* rt, zi_ptr_t req_ptr, zi_size32_t req_len, zi_ptr_t resp_ptr, zi_size32_t resp_cap);
@@ -1,11 +1,35 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1 // MAP_ANONYMOUS under -std=c11
+#endif
+
 #include "sir_module.h"
 
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Native tier: x86-64 System V hosts that can map executable memory.
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/mman.h>
+#include <unistd.h>
+#define SIR_EXEC_NATIVE 1
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#else
+#define SIR_EXEC_NATIVE 0
+#endif
+
 static bool is_pow2_u32(uint32_t x);
 
 enum {
@@ -21,6 +45,53 @@ enum {
   ZI_E_INTERNAL = -10,
 };
 
+// zABI host calls understood by exec_call_extern. Extern syms are resolved to
+// one of these at sir_mb_finalize so dispatch is a switch, not a name compare.
+typedef enum sir_hostcall {
+  SIR_HC_UNKNOWN = 0,
+  SIR_HC_ZI_WRITE,
+  SIR_HC_ZI_END,
+  SIR_HC_ZI_READ,
+  SIR_HC_ZI_ALLOC,
+  SIR_HC_ZI_FREE,
+  SIR_HC_ZI_TELEMETRY,
+  SIR_HC_ZI_ABI_VERSION,
+  SIR_HC_ZI_CTL,
+  SIR_HC_ZI_CAP_COUNT,
+  SIR_HC_ZI_CAP_GET_SIZE,
+  SIR_HC_ZI_CAP_GET,
+  SIR_HC_ZI_CAP_OPEN,
+  SIR_HC_ZI_HANDLE_HFLAGS,
+  SIR_HC_COUNT,
+} sir_hostcall_t;
+
+static const struct {
+  const char* name;
+  uint32_t param_count;
+} sir_hostcalls[SIR_HC_COUNT] = {
+    [SIR_HC_ZI_WRITE] = {"zi_write", 3},
+    [SIR_HC_ZI_END] = {"zi_end", 1},
+    [SIR_HC_ZI_READ] = {"zi_read", 3},
+    [SIR_HC_ZI_ALLOC] = {"zi_alloc", 1},
+    [SIR_HC_ZI_FREE] = {"zi_free", 1},
+    [SIR_HC_ZI_TELEMETRY] = {"zi_telemetry", 4},
+    [SIR_HC_ZI_ABI_VERSION] = {"zi_abi_version", 0},
+    [SIR_HC_ZI_CTL] = {"zi_ctl", 4},
+    [SIR_HC_ZI_CAP_COUNT] = {"zi_cap_count", 0},
+    [SIR_HC_ZI_CAP_GET_SIZE] = {"zi_cap_get_size", 1},
+    [SIR_HC_ZI_CAP_GET] = {"zi_cap_get", 3},
+    [SIR_HC_ZI_CAP_OPEN] = {"zi_cap_open", 1},
+    [SIR_HC_ZI_HANDLE_HFLAGS] = {"zi_handle_hflags", 1},
+};
+
+static sir_hostcall_t hostcall_lookup(const char* name) {
+  if (!name) return SIR_HC_UNKNOWN;
+  for (uint32_t hc = 1; hc < SIR_HC_COUNT; hc++) {
+    if (strcmp(name, sir_hostcalls[hc].name) == 0) return (sir_hostcall_t)hc;
+  }
+  return SIR_HC_UNKNOWN;
+}
+
 typedef struct sir_dyn_bytes {
   struct sir_pool_block* head;
   struct sir_pool_block* cur;
@@ -77,11 +148,24 @@ struct sir_module_builder {
   uint32_t cur_src_line;
 };
 
+typedef struct sir_tinst sir_tinst_t;
+typedef struct sir_tfunc sir_tfunc_t;
+typedef struct sir_ncode sir_ncode_t;
+
 typedef struct sir_module_impl {
   sir_module_t pub;
   struct sir_pool_block* pool_head;
+  sir_tfunc_t* tfuncs;  // frame templates and threaded code (may be NULL)
+  uint8_t* sym_hostcall; // sir_hostcall_t per sym, indexed by sym id - 1 (may be NULL)
+  // Set for modules loaded from an image: pub's arrays point into it.
+  void* image;
+  size_t image_len;
+  void (*image_release)(void* image, size_t len);
 } sir_module_impl_t;
 
+static sir_tfunc_t* tx_build(const sir_module_t* m);
+static void tx_free(sir_tfunc_t* tfuncs, uint32_t count);
+
 static sir_module_impl_t* module_impl_from_pub(sir_module_t* m) {
   if (!m) return NULL;
   return (sir_module_impl_t*)((uint8_t*)m - offsetof(sir_module_impl_t, pub));
@@ -363,6 +447,22 @@ bool sir_mb_func_set_sig(sir_module_builder_t* b, sir_func_id_t f, sir_sig_t sig
   return true;
 }
 
+bool sir_mb_func_set_blocks(sir_module_builder_t* b, sir_func_id_t f, const sir_block_t* blocks, uint32_t block_count) {
+  if (!b) return false;
+  if (f == 0 || f > b->funcs.n) return false;
+  if (block_count && !blocks) return false;
+  if (block_count > UINT32_MAX / (uint32_t)sizeof(sir_block_t)) return false;
+  const uint32_t inst_count = b->func_insts[f - 1].n;
+  for (uint32_t i = 0; i < block_count; i++) {
+    if (blocks[i].ip >= inst_count || (i && blocks[i].ip <= blocks[i - 1].ip)) return false;
+  }
+  const uint8_t* p = pool_copy_bytes(b, (const uint8_t*)blocks, block_count * (uint32_t)sizeof(sir_block_t));
+  if (block_count && !p) return false;
+  b->funcs.p[f - 1].blocks = (const sir_block_t*)p;
+  b->funcs.p[f - 1].block_count = block_count;
+  return true;
+}
+
 void sir_mb_set_src(sir_module_builder_t* b, uint32_t node_id, uint32_t line) {
   if (!b) return;
   b->cur_src_node_id = node_id;
@@ -630,6 +730,148 @@ bool sir_mb_emit_i32_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_i
   return emit_i32_cmp(b, f, SIR_INST_I32_CMP_UGE, dst, a, b_);
 }
 
+static bool emit_i64_bin(sir_module_builder_t* b, sir_func_id_t f, sir_inst_kind_t k, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  sir_inst_t i = {0};
+  i.k = k;
+  i.result_count = 1;
+  i.results[0] = dst;
+  i.u.i64_bin.a = a;
+  i.u.i64_bin.b = b_;
+  i.u.i64_bin.dst = dst;
+  return emit_inst(b, f, i);
+}
+
+static bool emit_f_bin(sir_module_builder_t* b, sir_func_id_t f, sir_inst_kind_t k, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  sir_inst_t i = {0};
+  i.k = k;
+  i.result_count = 1;
+  i.results[0] = dst;
+  i.u.f_bin.a = a;
+  i.u.f_bin.b = b_;
+  i.u.f_bin.dst = dst;
+  return emit_inst(b, f, i);
+}
+
+static bool emit_num_un(sir_module_builder_t* b, sir_func_id_t f, sir_inst_kind_t k, sir_val_id_t dst, sir_val_id_t x) {
+  sir_inst_t i = {0};
+  i.k = k;
+  i.result_count = 1;
+  i.results[0] = dst;
+  i.u.num_un.x = x;
+  i.u.num_un.dst = dst;
+  return emit_inst(b, f, i);
+}
+
+bool sir_mb_emit_i64_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_ADD, dst, a, b_);
+}
+bool sir_mb_emit_i64_sub(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_SUB, dst, a, b_);
+}
+bool sir_mb_emit_i64_mul(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_MUL, dst, a, b_);
+}
+bool sir_mb_emit_i64_and(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_AND, dst, a, b_);
+}
+bool sir_mb_emit_i64_or(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_OR, dst, a, b_);
+}
+bool sir_mb_emit_i64_xor(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_XOR, dst, a, b_);
+}
+bool sir_mb_emit_i64_not(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I64_NOT, dst, x);
+}
+bool sir_mb_emit_i64_neg(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I64_NEG, dst, x);
+}
+bool sir_mb_emit_i64_shl(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, sir_val_id_t shift) {
+  return emit_i64_bin(b, f, SIR_INST_I64_SHL, dst, x, shift);
+}
+bool sir_mb_emit_i64_shr_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, sir_val_id_t shift) {
+  return emit_i64_bin(b, f, SIR_INST_I64_SHR_S, dst, x, shift);
+}
+bool sir_mb_emit_i64_shr_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, sir_val_id_t shift) {
+  return emit_i64_bin(b, f, SIR_INST_I64_SHR_U, dst, x, shift);
+}
+bool sir_mb_emit_i64_div_s_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_DIV_S_SAT, dst, a, b_);
+}
+bool sir_mb_emit_i64_div_s_trap(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_DIV_S_TRAP, dst, a, b_);
+}
+bool sir_mb_emit_i64_div_u_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_DIV_U_SAT, dst, a, b_);
+}
+bool sir_mb_emit_i64_rem_s_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_REM_S_SAT, dst, a, b_);
+}
+bool sir_mb_emit_i64_rem_u_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_REM_U_SAT, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_eq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_EQ, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_ne(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_NE, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_slt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_SLT, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_sle(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_SLE, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_sgt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_SGT, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_sge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_SGE, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_ult(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_ULT, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_ule(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_ULE, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_ugt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_UGT, dst, a, b_);
+}
+bool sir_mb_emit_i64_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_i64_bin(b, f, SIR_INST_I64_CMP_UGE, dst, a, b_);
+}
+
+bool sir_mb_emit_f32_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F32_ADD, dst, a, b_);
+}
+bool sir_mb_emit_f32_sub(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F32_SUB, dst, a, b_);
+}
+bool sir_mb_emit_f32_mul(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F32_MUL, dst, a, b_);
+}
+bool sir_mb_emit_f32_div(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F32_DIV, dst, a, b_);
+}
+bool sir_mb_emit_f32_neg(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F32_NEG, dst, x);
+}
+bool sir_mb_emit_f64_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F64_ADD, dst, a, b_);
+}
+bool sir_mb_emit_f64_sub(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F64_SUB, dst, a, b_);
+}
+bool sir_mb_emit_f64_mul(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F64_MUL, dst, a, b_);
+}
+bool sir_mb_emit_f64_div(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_bin(b, f, SIR_INST_F64_DIV, dst, a, b_);
+}
+bool sir_mb_emit_f64_neg(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F64_NEG, dst, x);
+}
+
 static bool emit_f_cmp(sir_module_builder_t* b, sir_func_id_t f, sir_inst_kind_t k, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
   sir_inst_t i = {0};
   i.k = k;
@@ -641,13 +883,78 @@ static bool emit_f_cmp(sir_module_builder_t* b, sir_func_id_t f, sir_inst_kind_t
   return emit_inst(b, f, i);
 }
 
+bool sir_mb_emit_f32_cmp_oeq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_OEQ, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_one(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_ONE, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_olt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_OLT, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_ole(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_OLE, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_ogt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_OGT, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_oge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_OGE, dst, a, b_);
+}
 bool sir_mb_emit_f32_cmp_ueq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
   return emit_f_cmp(b, f, SIR_INST_F32_CMP_UEQ, dst, a, b_);
 }
-
+bool sir_mb_emit_f32_cmp_une(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_UNE, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_ult(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_ULT, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_ule(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_ULE, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_ugt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_UGT, dst, a, b_);
+}
+bool sir_mb_emit_f32_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F32_CMP_UGE, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_oeq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_OEQ, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_one(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_ONE, dst, a, b_);
+}
 bool sir_mb_emit_f64_cmp_olt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
   return emit_f_cmp(b, f, SIR_INST_F64_CMP_OLT, dst, a, b_);
 }
+bool sir_mb_emit_f64_cmp_ole(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_OLE, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_ogt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_OGT, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_oge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_OGE, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_ueq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_UEQ, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_une(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_UNE, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_ult(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_ULT, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_ule(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_ULE, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_ugt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_UGT, dst, a, b_);
+}
+bool sir_mb_emit_f64_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_) {
+  return emit_f_cmp(b, f, SIR_INST_F64_CMP_UGE, dst, a, b_);
+}
 
 bool sir_mb_emit_i32_trunc_i64(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
   sir_inst_t i = {0};
@@ -659,6 +966,64 @@ bool sir_mb_emit_i32_trunc_i64(sir_module_builder_t* b, sir_func_id_t f, sir_val
   return emit_inst(b, f, i);
 }
 
+bool sir_mb_emit_i64_sext_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I64_SEXT_I32, dst, x);
+}
+bool sir_mb_emit_f32_from_i32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F32_FROM_I32_S, dst, x);
+}
+bool sir_mb_emit_f32_from_i32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F32_FROM_I32_U, dst, x);
+}
+bool sir_mb_emit_f32_from_i64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F32_FROM_I64_S, dst, x);
+}
+bool sir_mb_emit_f32_from_i64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F32_FROM_I64_U, dst, x);
+}
+bool sir_mb_emit_f64_from_i32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F64_FROM_I32_S, dst, x);
+}
+bool sir_mb_emit_f64_from_i32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F64_FROM_I32_U, dst, x);
+}
+bool sir_mb_emit_f64_from_i64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F64_FROM_I64_S, dst, x);
+}
+bool sir_mb_emit_f64_from_i64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F64_FROM_I64_U, dst, x);
+}
+bool sir_mb_emit_i32_trunc_sat_f32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I32_TRUNC_SAT_F32_S, dst, x);
+}
+bool sir_mb_emit_i32_trunc_sat_f32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I32_TRUNC_SAT_F32_U, dst, x);
+}
+bool sir_mb_emit_i32_trunc_sat_f64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I32_TRUNC_SAT_F64_S, dst, x);
+}
+bool sir_mb_emit_i32_trunc_sat_f64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I32_TRUNC_SAT_F64_U, dst, x);
+}
+bool sir_mb_emit_i64_trunc_sat_f32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I64_TRUNC_SAT_F32_S, dst, x);
+}
+bool sir_mb_emit_i64_trunc_sat_f32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I64_TRUNC_SAT_F32_U, dst, x);
+}
+bool sir_mb_emit_i64_trunc_sat_f64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I64_TRUNC_SAT_F64_S, dst, x);
+}
+bool sir_mb_emit_i64_trunc_sat_f64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_I64_TRUNC_SAT_F64_U, dst, x);
+}
+bool sir_mb_emit_f64_promote_f32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F64_PROMOTE_F32, dst, x);
+}
+bool sir_mb_emit_f32_demote_f64(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
+  return emit_num_un(b, f, SIR_INST_F32_DEMOTE_F64, dst, x);
+}
+
 bool sir_mb_emit_i32_zext_i8(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x) {
   sir_inst_t i = {0};
   i.k = SIR_INST_I32_ZEXT_I8;
@@ -921,6 +1286,45 @@ bool sir_mb_emit_mem_fill(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t
   return emit_inst(b, f, i);
 }
 
+static bool emit_vec(sir_module_builder_t* b, sir_func_id_t f, sir_inst_kind_t k, sir_val_id_t dst, sir_val_id_t mask, sir_val_id_t a, sir_val_id_t b_,
+                     uint32_t lanes) {
+  if (!b) return false;
+  sir_inst_t i = {0};
+  i.k = k;
+  i.result_count = 0;
+  i.u.vec.dst = dst;
+  i.u.vec.a = a;
+  i.u.vec.b = b_;
+  i.u.vec.mask = mask;
+  i.u.vec.lanes = lanes;
+  return emit_inst(b, f, i);
+}
+
+bool sir_mb_emit_vec_splat_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, uint32_t lanes) {
+  return emit_vec(b, f, SIR_INST_VEC_SPLAT_I32, dst, 0, x, 0, lanes);
+}
+
+bool sir_mb_emit_vec_splat_bool(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, uint32_t lanes) {
+  return emit_vec(b, f, SIR_INST_VEC_SPLAT_BOOL, dst, 0, x, 0, lanes);
+}
+
+bool sir_mb_emit_vec_i32_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_, uint32_t lanes) {
+  return emit_vec(b, f, SIR_INST_VEC_I32_ADD, dst, 0, a, b_, lanes);
+}
+
+bool sir_mb_emit_vec_i32_cmp_eq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_, uint32_t lanes) {
+  return emit_vec(b, f, SIR_INST_VEC_I32_CMP_EQ, dst, 0, a, b_, lanes);
+}
+
+bool sir_mb_emit_vec_i32_cmp_slt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_, uint32_t lanes) {
+  return emit_vec(b, f, SIR_INST_VEC_I32_CMP_SLT, dst, 0, a, b_, lanes);
+}
+
+bool sir_mb_emit_vec_select_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t mask, sir_val_id_t a, sir_val_id_t b_,
+                                uint32_t lanes) {
+  return emit_vec(b, f, SIR_INST_VEC_SELECT_I32, dst, mask, a, b_, lanes);
+}
+
 static bool emit_atomic_rmw(sir_module_builder_t* b, sir_func_id_t f, sir_inst_kind_t k, sir_val_id_t dst_old, sir_val_id_t addr, sir_val_id_t value,
                             sir_atomic_rmw_op_t op, uint32_t align) {
   if (!b) return false;
@@ -1194,6 +1598,19 @@ static void* dup_mem(const void* p, size_t n) {
   return r;
 }
 
+// Per-module execution data derived from pub (best-effort; engines rebuild
+// what is missing).
+static void module_impl_prepare(sir_module_impl_t* impl) {
+  const sir_module_t* m = &impl->pub;
+  impl->tfuncs = tx_build(m);
+  if (m->sym_count) {
+    impl->sym_hostcall = (uint8_t*)malloc(m->sym_count);
+    if (impl->sym_hostcall) {
+      for (uint32_t si = 0; si < m->sym_count; si++) impl->sym_hostcall[si] = (uint8_t)hostcall_lookup(m->syms[si].name);
+    }
+  }
+}
+
 sir_module_t* sir_mb_finalize(sir_module_builder_t* b) {
   if (!b) return NULL;
   if (b->funcs.n == 0) return NULL;
@@ -1279,6 +1696,7 @@ sir_module_t* sir_mb_finalize(sir_module_builder_t* b) {
       .func_count = b->funcs.n,
       .entry = b->entry,
   };
+  module_impl_prepare(impl);
 
   // free builder now? caller owns builder lifetime; leave it as-is.
   return &impl->pub;
@@ -1290,6 +1708,13 @@ void sir_module_free(sir_module_t* m) {
   if (!impl) return;
 
   const sir_module_t* pub = &impl->pub;
+  tx_free(impl->tfuncs, pub->func_count);
+  free(impl->sym_hostcall);
+  if (impl->image) {
+    if (impl->image_release) impl->image_release(impl->image, impl->image_len);
+    free(impl);
+    return;
+  }
   if (pub->funcs) {
     for (uint32_t fi = 0; fi < pub->func_count; fi++) {
       free((void*)pub->funcs[fi].insts);
@@ -1308,6 +1733,318 @@ void sir_module_free(sir_module_t* m) {
   free(impl);
 }
 
+// Module images. Layout: header, then 8-byte aligned sections; every pointer
+// field holds the offset of its target (0 = NULL) until load relocates it.
+typedef struct sir_image_hdr {
+  uint8_t magic[8];
+  uint32_t version;
+  uint16_t ptr_size;
+  uint16_t byte_order; // 0x0102 in the writer's byte order
+  uint32_t inst_size;  // sizeof(sir_inst_t), to catch layout changes
+  uint32_t entry;
+  uint64_t len;        // whole image
+  uint64_t sum;        // image_sum_all
+  uint32_t type_count;
+  uint32_t sym_count;
+  uint32_t global_count;
+  uint32_t func_count;
+  uint64_t types;
+  uint64_t syms;
+  uint64_t globals;
+  uint64_t funcs;
+} sir_image_hdr_t;
+
+static const uint8_t sir_image_magic[8] = {'S', 'I', 'R', 'M', 'O', 'D', 'I', 0};
+
+static uint64_t image_sum(const uint8_t* p, size_t n) {
+  uint64_t h = 1469598103934665603ull;
+  size_t i = 0;
+  for (; i + 8u <= n; i += 8u) {
+    uint64_t w;
+    memcpy(&w, p + i, sizeof(w));
+    h = (h ^ w) * 1099511628211ull;
+    h ^= h >> 29;
+  }
+  for (; i < n; i++) h = (h ^ p[i]) * 1099511628211ull;
+  return h;
+}
+
+// Checksum over the whole image, with the header's own sum field as zero.
+static uint64_t image_sum_all(const uint8_t* base, size_t len) {
+  sir_image_hdr_t h;
+  memcpy(&h, base, sizeof(h));
+  h.sum = 0;
+  return image_sum((const uint8_t*)&h, sizeof(h)) ^ (image_sum(base + sizeof(h), len - sizeof(h)) * 0x9e3779b97f4a7c15ull);
+}
+
+typedef struct sir_image_buf {
+  uint8_t* p;
+  size_t n;
+  size_t cap;
+  bool oom;
+} sir_image_buf_t;
+
+// Appends n bytes (zeros when src is NULL) at the next 8-byte boundary and
+// returns their offset, or 0 for an empty or failed append.
+static uint64_t img_put(sir_image_buf_t* w, const void* src, size_t n) {
+  if (w->oom || n == 0) return 0;
+  const size_t at = (w->n + 7u) & ~(size_t)7u;
+  if (n > SIZE_MAX - at) {
+    w->oom = true;
+    return 0;
+  }
+  if (at + n > w->cap) {
+    size_t cap = w->cap ? w->cap : 4096u;
+    while (cap < at + n) {
+      if (cap > SIZE_MAX / 2u) {
+        w->oom = true;
+        return 0;
+      }
+      cap *= 2u;
+    }
+    uint8_t* np = (uint8_t*)realloc(w->p, cap);
+    if (!np) {
+      w->oom = true;
+      return 0;
+    }
+    w->p = np;
+    w->cap = cap;
+  }
+  memset(w->p + w->n, 0, at - w->n);
+  if (src) memcpy(w->p + at, src, n);
+  else memset(w->p + at, 0, n);
+  w->n = at + n;
+  return (uint64_t)at;
+}
+
+static const void* img_off(uint64_t off) { return (const void*)(uintptr_t)off; }
+
+static uint64_t img_put_str(sir_image_buf_t* w, const char* s) { return s ? img_put(w, s, strlen(s) + 1u) : 0; }
+
+static uint64_t img_put_u32s(sir_image_buf_t* w, const uint32_t* p, uint32_t n) {
+  return (p && n) ? img_put(w, p, (size_t)n * sizeof(uint32_t)) : 0;
+}
+
+static sir_sig_t img_put_sig(sir_image_buf_t* w, sir_sig_t sig) {
+  sig.params = (const sir_type_id_t*)img_off(img_put_u32s(w, sig.params, sig.param_count));
+  sig.results = (const sir_type_id_t*)img_off(img_put_u32s(w, sig.results, sig.result_count));
+  return sig;
+}
+
+// Copies the arrays an instruction points at and rewrites the pointers as offsets.
+static void img_put_inst_arrays(sir_image_buf_t* w, sir_inst_t* in) {
+  switch (in->k) {
+    case SIR_INST_CONST_BYTES:
+      in->u.const_bytes.bytes = (const uint8_t*)img_off(in->u.const_bytes.len ? img_put(w, in->u.const_bytes.bytes, in->u.const_bytes.len) : 0);
+      break;
+    case SIR_INST_BR:
+      in->u.br.src_slots = (const sir_val_id_t*)img_off(img_put_u32s(w, in->u.br.src_slots, in->u.br.arg_count));
+      in->u.br.dst_slots = (const sir_val_id_t*)img_off(img_put_u32s(w, in->u.br.dst_slots, in->u.br.arg_count));
+      break;
+    case SIR_INST_SWITCH:
+      in->u.sw.case_lits = (const int32_t*)img_off(
+          (in->u.sw.case_lits && in->u.sw.case_count) ? img_put(w, in->u.sw.case_lits, (size_t)in->u.sw.case_count * sizeof(int32_t)) : 0);
+      in->u.sw.case_target = (const uint32_t*)img_off(img_put_u32s(w, in->u.sw.case_target, in->u.sw.case_count));
+      break;
+    case SIR_INST_CALL_EXTERN:
+      in->u.call_extern.args = (const sir_val_id_t*)img_off(img_put_u32s(w, in->u.call_extern.args, in->u.call_extern.arg_count));
+      break;
+    case SIR_INST_CALL_FUNC:
+      in->u.call_func.args = (const sir_val_id_t*)img_off(img_put_u32s(w, in->u.call_func.args, in->u.call_func.arg_count));
+      break;
+    case SIR_INST_CALL_FUNC_PTR:
+      in->u.call_func_ptr.args = (const sir_val_id_t*)img_off(img_put_u32s(w, in->u.call_func_ptr.args, in->u.call_func_ptr.arg_count));
+      break;
+    default:
+      break;
+  }
+}
+
+bool sir_module_image_build(const sir_module_t* m, uint8_t** out, size_t* out_len) {
+  if (!m || !out || !out_len) return false;
+  *out = NULL;
+  *out_len = 0;
+  sir_image_buf_t w = {0};
+  sir_image_hdr_t h;
+  memset(&h, 0, sizeof(h));
+  (void)img_put(&w, NULL, sizeof(h));
+
+  // Tables are reserved first and filled through offsets: w.p moves as the
+  // arrays they point at are appended.
+  if (m->type_count) h.types = img_put(&w, m->types, (size_t)m->type_count * sizeof(sir_type_t));
+  if (m->sym_count) h.syms = img_put(&w, NULL, (size_t)m->sym_count * sizeof(sir_sym_t));
+  for (uint32_t i = 0; i < m->sym_count && !w.oom; i++) {
+    sir_sym_t s = m->syms[i];
+    s.name = (const char*)img_off(img_put_str(&w, s.name));
+    s.sig = img_put_sig(&w, s.sig);
+    if (!w.oom) memcpy(w.p + h.syms + (size_t)i * sizeof(s), &s, sizeof(s));
+  }
+  if (m->global_count) h.globals = img_put(&w, NULL, (size_t)m->global_count * sizeof(sir_global_t));
+  for (uint32_t i = 0; i < m->global_count && !w.oom; i++) {
+    sir_global_t g = m->globals[i];
+    g.name = (const char*)img_off(img_put_str(&w, g.name));
+    g.init_bytes = (const uint8_t*)img_off((g.init_bytes && g.init_len) ? img_put(&w, g.init_bytes, g.init_len) : 0);
+    if (!w.oom) memcpy(w.p + h.globals + (size_t)i * sizeof(g), &g, sizeof(g));
+  }
+  if (m->func_count) h.funcs = img_put(&w, NULL, (size_t)m->func_count * sizeof(sir_func_t));
+  for (uint32_t i = 0; i < m->func_count && !w.oom; i++) {
+    sir_func_t f = m->funcs[i];
+    f.name = (const char*)img_off(img_put_str(&w, f.name));
+    f.sig = img_put_sig(&w, f.sig);
+    const uint64_t insts = (f.insts && f.inst_count) ? img_put(&w, f.insts, (size_t)f.inst_count * sizeof(sir_inst_t)) : 0;
+    for (uint32_t ip = 0; insts && ip < f.inst_count && !w.oom; ip++) {
+      sir_inst_t in;
+      memcpy(&in, w.p + insts + (size_t)ip * sizeof(in), sizeof(in));
+      img_put_inst_arrays(&w, &in);
+      if (!w.oom) memcpy(w.p + insts + (size_t)ip * sizeof(in), &in, sizeof(in));
+    }
+    f.insts = (const sir_inst_t*)img_off(insts);
+    f.blocks = (const sir_block_t*)img_off((f.blocks && f.block_count) ? img_put(&w, f.blocks, (size_t)f.block_count * sizeof(sir_block_t)) : 0);
+    if (!w.oom) memcpy(w.p + h.funcs + (size_t)i * sizeof(f), &f, sizeof(f));
+  }
+  if (w.oom) {
+    free(w.p);
+    return false;
+  }
+
+  memcpy(h.magic, sir_image_magic, sizeof(h.magic));
+  h.version = SIR_MODULE_IMAGE_VERSION;
+  h.ptr_size = (uint16_t)sizeof(void*);
+  h.byte_order = 0x0102u;
+  h.inst_size = (uint32_t)sizeof(sir_inst_t);
+  h.entry = m->entry;
+  h.len = (uint64_t)w.n;
+  h.type_count = m->type_count;
+  h.sym_count = m->sym_count;
+  h.global_count = m->global_count;
+  h.func_count = m->func_count;
+  memcpy(w.p, &h, sizeof(h));
+  h.sum = image_sum_all(w.p, w.n);
+  memcpy(w.p, &h, sizeof(h));
+  *out = w.p;
+  *out_len = w.n;
+  return true;
+}
+
+// Relocates an offset field to a pointer at count elements of elem bytes.
+static bool img_fix(uint8_t* base, size_t len, const void** field, size_t elem, uint64_t count) {
+  const uint64_t off = (uint64_t)(uintptr_t)*field;
+  if (off == 0) return true;
+  if (off < sizeof(sir_image_hdr_t) || off > len || (off & 7u) != 0) return false;
+  if (count > (uint64_t)(len - off) / elem) return false;
+  *field = base + off;
+  return true;
+}
+
+static bool img_fix_str(uint8_t* base, size_t len, const char** field) {
+  const uint64_t off = (uint64_t)(uintptr_t)*field;
+  if (off == 0) return true;
+  if (off < sizeof(sir_image_hdr_t) || off >= len || !memchr(base + off, 0, len - off)) return false;
+  *field = (const char*)(base + off);
+  return true;
+}
+
+#define IMG_FIX(field, elem, count) img_fix(base, len, (const void**)(void*)&(field), (elem), (count))
+
+static bool img_fix_sig(uint8_t* base, size_t len, sir_sig_t* sig) {
+  return IMG_FIX(sig->params, sizeof(sir_type_id_t), sig->param_count) && IMG_FIX(sig->results, sizeof(sir_type_id_t), sig->result_count);
+}
+
+static bool img_fix_inst(uint8_t* base, size_t len, sir_inst_t* in) {
+  switch (in->k) {
+    case SIR_INST_CONST_BYTES:
+      return IMG_FIX(in->u.const_bytes.bytes, 1u, in->u.const_bytes.len);
+    case SIR_INST_BR:
+      return IMG_FIX(in->u.br.src_slots, sizeof(sir_val_id_t), in->u.br.arg_count) &&
+             IMG_FIX(in->u.br.dst_slots, sizeof(sir_val_id_t), in->u.br.arg_count);
+    case SIR_INST_SWITCH:
+      return IMG_FIX(in->u.sw.case_lits, sizeof(int32_t), in->u.sw.case_count) &&
+             IMG_FIX(in->u.sw.case_target, sizeof(uint32_t), in->u.sw.case_count);
+    case SIR_INST_CALL_EXTERN:
+      return IMG_FIX(in->u.call_extern.args, sizeof(sir_val_id_t), in->u.call_extern.arg_count);
+    case SIR_INST_CALL_FUNC:
+      return IMG_FIX(in->u.call_func.args, sizeof(sir_val_id_t), in->u.call_func.arg_count);
+    case SIR_INST_CALL_FUNC_PTR:
+      return IMG_FIX(in->u.call_func_ptr.args, sizeof(sir_val_id_t), in->u.call_func_ptr.arg_count);
+    default:
+      return true;
+  }
+}
+
+static bool img_fix_all(uint8_t* base, size_t len, const sir_image_hdr_t* h) {
+  const void* types = img_off(h->types);
+  const void* syms = img_off(h->syms);
+  const void* globals = img_off(h->globals);
+  const void* funcs = img_off(h->funcs);
+  if (!IMG_FIX(types, sizeof(sir_type_t), h->type_count) || !IMG_FIX(syms, sizeof(sir_sym_t), h->sym_count) ||
+      !IMG_FIX(globals, sizeof(sir_global_t), h->global_count) || !IMG_FIX(funcs, sizeof(sir_func_t), h->func_count)) {
+    return false;
+  }
+  if ((h->sym_count && !syms) || (h->global_count && !globals) || (h->func_count && !funcs) || (h->type_count && !types)) return false;
+  for (uint32_t i = 0; i < h->sym_count; i++) {
+    sir_sym_t* s = (sir_sym_t*)(uintptr_t)syms + i;
+    if (!img_fix_str(base, len, &s->name) || !img_fix_sig(base, len, &s->sig)) return false;
+  }
+  for (uint32_t i = 0; i < h->global_count; i++) {
+    sir_global_t* g = (sir_global_t*)(uintptr_t)globals + i;
+    if (!img_fix_str(base, len, &g->name) || !IMG_FIX(g->init_bytes, 1u, g->init_len)) return false;
+  }
+  for (uint32_t i = 0; i < h->func_count; i++) {
+    sir_func_t* f = (sir_func_t*)(uintptr_t)funcs + i;
+    if (!img_fix_str(base, len, &f->name) || !img_fix_sig(base, len, &f->sig) || !IMG_FIX(f->insts, sizeof(sir_inst_t), f->inst_count) ||
+        !IMG_FIX(f->blocks, sizeof(sir_block_t), f->block_count)) {
+      return false;
+    }
+    if ((f->inst_count && !f->insts) || (f->block_count && !f->blocks)) return false;
+    for (uint32_t bi = 0; bi < f->block_count; bi++) {
+      if (f->blocks[bi].ip >= f->inst_count || (bi && f->blocks[bi].ip <= f->blocks[bi - 1].ip)) return false;
+    }
+    sir_inst_t* insts = (sir_inst_t*)(uintptr_t)f->insts;
+    for (uint32_t ip = 0; ip < f->inst_count; ip++) {
+      if (!img_fix_inst(base, len, &insts[ip])) return false;
+    }
+  }
+  return true;
+}
+
+#undef IMG_FIX
+
+sir_module_t* sir_module_image_load(void* image, size_t len, void (*release)(void* image, size_t len)) {
+  uint8_t* base = (uint8_t*)image;
+  if (!base || ((uintptr_t)base & 7u) != 0 || len < sizeof(sir_image_hdr_t)) return NULL;
+  sir_image_hdr_t h;
+  memcpy(&h, base, sizeof(h));
+  if (memcmp(h.magic, sir_image_magic, sizeof(h.magic)) != 0 || h.version != SIR_MODULE_IMAGE_VERSION || h.ptr_size != sizeof(void*) ||
+      h.byte_order != 0x0102u || h.inst_size != sizeof(sir_inst_t) || h.len != (uint64_t)len) {
+    return NULL;
+  }
+  if (h.func_count == 0 || h.entry == 0 || h.entry > h.func_count) return NULL;
+  if (image_sum_all(base, len) != h.sum) return NULL;
+
+  sir_module_impl_t* impl = (sir_module_impl_t*)calloc(1, sizeof(*impl));
+  if (!impl) return NULL;
+  if (!img_fix_all(base, len, &h)) {
+    free(impl);
+    return NULL;
+  }
+  impl->pub = (sir_module_t){
+      .types = (const sir_type_t*)(h.types ? base + h.types : NULL),
+      .type_count = h.type_count,
+      .syms = (const sir_sym_t*)(h.syms ? base + h.syms : NULL),
+      .sym_count = h.sym_count,
+      .globals = (const sir_global_t*)(h.globals ? base + h.globals : NULL),
+      .global_count = h.global_count,
+      .funcs = (const sir_func_t*)(base + h.funcs),
+      .func_count = h.func_count,
+      .entry = h.entry,
+  };
+  impl->image = image;
+  impl->image_len = len;
+  impl->image_release = release;
+  module_impl_prepare(impl);
+  return &impl->pub;
+}
+
 // Validator context for filling sir_module_validate_ex diagnostics.
 typedef struct sir__validate_ctx {
   const char* code;
@@ -1316,8 +2053,9 @@ typedef struct sir__validate_ctx {
   const sir_inst_t* inst;
 } sir__validate_ctx_t;
 
-static sir_validate_diag_t* sir__validate_out_diag = NULL;
-static sir__validate_ctx_t sir__validate_ctx = {0};
+// Per thread, so independent modules can be validated concurrently.
+static _Thread_local sir_validate_diag_t* sir__validate_out_diag = NULL;
+static _Thread_local sir__validate_ctx_t sir__validate_ctx = {0};
 
 static void sir__validate_note(const char* code, sir_func_id_t fid, uint32_t ip, const sir_inst_t* inst) {
   sir__validate_ctx.code = code;
@@ -1617,13 +2355,105 @@ bool sir_module_validate(const sir_module_t* m, char* err, size_t err_cap) {
             return false;
           }
           break;
+        case SIR_INST_I64_ADD:
+        case SIR_INST_I64_SUB:
+        case SIR_INST_I64_MUL:
+        case SIR_INST_I64_AND:
+        case SIR_INST_I64_OR:
+        case SIR_INST_I64_XOR:
+        case SIR_INST_I64_SHL:
+        case SIR_INST_I64_SHR_S:
+        case SIR_INST_I64_SHR_U:
+        case SIR_INST_I64_DIV_S_SAT:
+        case SIR_INST_I64_DIV_S_TRAP:
+        case SIR_INST_I64_DIV_U_SAT:
+        case SIR_INST_I64_REM_S_SAT:
+        case SIR_INST_I64_REM_U_SAT:
+        case SIR_INST_I64_CMP_EQ:
+        case SIR_INST_I64_CMP_NE:
+        case SIR_INST_I64_CMP_SLT:
+        case SIR_INST_I64_CMP_SLE:
+        case SIR_INST_I64_CMP_SGT:
+        case SIR_INST_I64_CMP_SGE:
+        case SIR_INST_I64_CMP_ULT:
+        case SIR_INST_I64_CMP_ULE:
+        case SIR_INST_I64_CMP_UGT:
+        case SIR_INST_I64_CMP_UGE:
+          if (inst->u.i64_bin.dst >= vc || inst->u.i64_bin.a >= vc || inst->u.i64_bin.b >= vc) {
+            set_err(err, err_cap, "i64_bin operand out of range");
+            return false;
+          }
+          break;
+        case SIR_INST_F32_ADD:
+        case SIR_INST_F32_SUB:
+        case SIR_INST_F32_MUL:
+        case SIR_INST_F32_DIV:
+        case SIR_INST_F64_ADD:
+        case SIR_INST_F64_SUB:
+        case SIR_INST_F64_MUL:
+        case SIR_INST_F64_DIV:
+          if (inst->u.f_bin.dst >= vc || inst->u.f_bin.a >= vc || inst->u.f_bin.b >= vc) {
+            set_err(err, err_cap, "f_bin operand out of range");
+            return false;
+          }
+          break;
+        case SIR_INST_F32_CMP_OEQ:
+        case SIR_INST_F32_CMP_ONE:
+        case SIR_INST_F32_CMP_OLT:
+        case SIR_INST_F32_CMP_OLE:
+        case SIR_INST_F32_CMP_OGT:
+        case SIR_INST_F32_CMP_OGE:
         case SIR_INST_F32_CMP_UEQ:
+        case SIR_INST_F32_CMP_UNE:
+        case SIR_INST_F32_CMP_ULT:
+        case SIR_INST_F32_CMP_ULE:
+        case SIR_INST_F32_CMP_UGT:
+        case SIR_INST_F32_CMP_UGE:
+        case SIR_INST_F64_CMP_OEQ:
+        case SIR_INST_F64_CMP_ONE:
         case SIR_INST_F64_CMP_OLT:
+        case SIR_INST_F64_CMP_OLE:
+        case SIR_INST_F64_CMP_OGT:
+        case SIR_INST_F64_CMP_OGE:
+        case SIR_INST_F64_CMP_UEQ:
+        case SIR_INST_F64_CMP_UNE:
+        case SIR_INST_F64_CMP_ULT:
+        case SIR_INST_F64_CMP_ULE:
+        case SIR_INST_F64_CMP_UGT:
+        case SIR_INST_F64_CMP_UGE:
           if (inst->u.f_cmp.dst >= vc || inst->u.f_cmp.a >= vc || inst->u.f_cmp.b >= vc) {
             set_err(err, err_cap, "f_cmp operand out of range");
             return false;
           }
           break;
+        case SIR_INST_I64_NOT:
+        case SIR_INST_I64_NEG:
+        case SIR_INST_F32_NEG:
+        case SIR_INST_F64_NEG:
+        case SIR_INST_I64_SEXT_I32:
+        case SIR_INST_F32_FROM_I32_S:
+        case SIR_INST_F32_FROM_I32_U:
+        case SIR_INST_F32_FROM_I64_S:
+        case SIR_INST_F32_FROM_I64_U:
+        case SIR_INST_F64_FROM_I32_S:
+        case SIR_INST_F64_FROM_I32_U:
+        case SIR_INST_F64_FROM_I64_S:
+        case SIR_INST_F64_FROM_I64_U:
+        case SIR_INST_I32_TRUNC_SAT_F32_S:
+        case SIR_INST_I32_TRUNC_SAT_F32_U:
+        case SIR_INST_I32_TRUNC_SAT_F64_S:
+        case SIR_INST_I32_TRUNC_SAT_F64_U:
+        case SIR_INST_I64_TRUNC_SAT_F32_S:
+        case SIR_INST_I64_TRUNC_SAT_F32_U:
+        case SIR_INST_I64_TRUNC_SAT_F64_S:
+        case SIR_INST_I64_TRUNC_SAT_F64_U:
+        case SIR_INST_F64_PROMOTE_F32:
+        case SIR_INST_F32_DEMOTE_F64:
+          if (inst->u.num_un.dst >= vc || inst->u.num_un.x >= vc) {
+            set_err(err, err_cap, "num_un operand out of range");
+            return false;
+          }
+          break;
         case SIR_INST_GLOBAL_ADDR:
           if (inst->u.global_addr.dst >= vc) {
             set_err(err, err_cap, "global_addr dst out of range");
@@ -1781,6 +2611,24 @@ bool sir_module_validate(const sir_module_t* m, char* err, size_t err_cap) {
             return false;
           }
           break;
+        case SIR_INST_VEC_SPLAT_I32:
+        case SIR_INST_VEC_SPLAT_BOOL:
+        case SIR_INST_VEC_I32_ADD:
+        case SIR_INST_VEC_I32_CMP_EQ:
+        case SIR_INST_VEC_I32_CMP_SLT:
+        case SIR_INST_VEC_SELECT_I32: {
+          const bool splat = inst->k == SIR_INST_VEC_SPLAT_I32 || inst->k == SIR_INST_VEC_SPLAT_BOOL;
+          if (inst->u.vec.dst >= vc || inst->u.vec.a >= vc || (!splat && inst->u.vec.b >= vc) ||
+              (inst->k == SIR_INST_VEC_SELECT_I32 && inst->u.vec.mask >= vc)) {
+            set_err(err, err_cap, "vec operand out of range");
+            return false;
+          }
+          if (inst->u.vec.lanes == 0 || inst->u.vec.lanes > 0x1FFFFFFFu) {
+            set_err(err, err_cap, "vec lane count out of range");
+            return false;
+          }
+          break;
+        }
         case SIR_INST_ATOMIC_RMW_I8:
         case SIR_INST_ATOMIC_RMW_I16:
         case SIR_INST_ATOMIC_RMW_I32:
@@ -1871,6 +2719,17 @@ bool sir_module_validate(const sir_module_t* m, char* err, size_t err_cap) {
             set_err(err, err_cap, "call_extern result_count does not match signature");
             return false;
           }
+          const sir_hostcall_t hc = hostcall_lookup(s->name);
+          if (hc == SIR_HC_UNKNOWN) {
+            char msg[160];
+            (void)snprintf(msg, sizeof(msg), "call_extern to unknown import '%s'", s->name);
+            set_err(err, err_cap, msg);
+            return false;
+          }
+          if (s->sig.param_count != sir_hostcalls[hc].param_count) {
+            set_err(err, err_cap, "call_extern signature does not match host call arity");
+            return false;
+          }
           for (uint32_t ai = 0; ai < inst->u.call_extern.arg_count; ai++) {
             if (inst->u.call_extern.args[ai] >= vc) {
               set_err(err, err_cap, "call_extern arg out of range");
@@ -1984,14 +2843,15 @@ static const sir_sym_t* sym_at(const sir_module_t* m, sir_sym_id_t id) {
   return &m->syms[id - 1];
 }
 
-static int32_t exec_call_extern(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, sir_func_id_t fid, uint32_t ip,
-                                const sir_exec_event_sink_t* sink, const sir_inst_t* inst, sir_value_t* vals, uint32_t val_count) {
+static int32_t exec_call_extern(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, sir_hostcall_t hc, sir_func_id_t fid,
+                                uint32_t ip, const sir_exec_event_sink_t* sink, const sir_inst_t* inst, sir_value_t* vals,
+                                uint32_t val_count) {
   (void)mem;
   if (!m || !inst || !vals) return ZI_E_INTERNAL;
   const sir_sym_t* s = sym_at(m, inst->u.call_extern.callee);
   if (!s || s->kind != SIR_SYM_EXTERN_FN || !s->name) return ZI_E_NOENT;
 
-  // MVP: dispatch by name to zABI primitives.
+  // Dispatch by host-call id (resolved at finalize) to zABI primitives.
   const char* nm = s->name;
   const sir_val_id_t* args = inst->u.call_extern.args;
   const uint32_t n = inst->u.call_extern.arg_count;
@@ -2002,246 +2862,245 @@ static int32_t exec_call_extern(const sir_module_t* m, sem_guest_mem_t* mem, sir
     if (r0 >= val_count) return ZI_E_BOUNDS;
   }
 
-  if (strcmp(nm, "zi_write") == 0) {
-    if (!host.v.zi_write) return ZI_E_NOSYS;
-    if (n != 3) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2];
-    if (a0 >= val_count || a1 >= val_count || a2 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t h = vals[a0];
-    const sir_value_t p = vals[a1];
-    const sir_value_t l = vals[a2];
-    if (h.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const zi_ptr_t pp = (p.kind == SIR_VAL_PTR) ? p.u.ptr : (p.kind == SIR_VAL_I64) ? (zi_ptr_t)p.u.i64 : (zi_ptr_t)0;
-    if (p.kind != SIR_VAL_PTR && p.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    const int64_t ll = (l.kind == SIR_VAL_I64) ? l.u.i64 : (l.kind == SIR_VAL_I32) ? (int64_t)l.u.i32 : (int64_t)-1;
-    if (l.kind != SIR_VAL_I64 && l.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    if (ll < 0 || ll > 0x7FFFFFFFll) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_write(host.user, (zi_handle_t)h.u.i32, pp, (zi_size32_t)ll);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+  switch (hc) {
+    case SIR_HC_ZI_WRITE: {
+      if (!host.v.zi_write) return ZI_E_NOSYS;
+      if (n != 3) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2];
+      if (a0 >= val_count || a1 >= val_count || a2 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t h = vals[a0];
+      const sir_value_t p = vals[a1];
+      const sir_value_t l = vals[a2];
+      if (h.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const zi_ptr_t pp = (p.kind == SIR_VAL_PTR) ? p.u.ptr : (p.kind == SIR_VAL_I64) ? (zi_ptr_t)p.u.i64 : (zi_ptr_t)0;
+      if (p.kind != SIR_VAL_PTR && p.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      const int64_t ll = (l.kind == SIR_VAL_I64) ? l.u.i64 : (l.kind == SIR_VAL_I32) ? (int64_t)l.u.i32 : (int64_t)-1;
+      if (l.kind != SIR_VAL_I64 && l.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      if (ll < 0 || ll > 0x7FFFFFFFll) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_write(host.user, (zi_handle_t)h.u.i32, pp, (zi_size32_t)ll);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_end") == 0) {
-    if (!host.v.zi_end) return ZI_E_NOSYS;
-    if (n != 1) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0];
-    if (a0 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t h = vals[a0];
-    if (h.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_end(host.user, (zi_handle_t)h.u.i32);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_END: {
+      if (!host.v.zi_end) return ZI_E_NOSYS;
+      if (n != 1) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0];
+      if (a0 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t h = vals[a0];
+      if (h.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_end(host.user, (zi_handle_t)h.u.i32);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_read") == 0) {
-    if (!host.v.zi_read) return ZI_E_NOSYS;
-    if (n != 3) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2];
-    if (a0 >= val_count || a1 >= val_count || a2 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t h = vals[a0];
-    const sir_value_t p = vals[a1];
-    const sir_value_t l = vals[a2];
-    if (h.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const zi_ptr_t pp = (p.kind == SIR_VAL_PTR) ? p.u.ptr : (p.kind == SIR_VAL_I64) ? (zi_ptr_t)p.u.i64 : (zi_ptr_t)0;
-    if (p.kind != SIR_VAL_PTR && p.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    const int64_t ll = (l.kind == SIR_VAL_I64) ? l.u.i64 : (l.kind == SIR_VAL_I32) ? (int64_t)l.u.i32 : (int64_t)-1;
-    if (l.kind != SIR_VAL_I64 && l.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    if (ll < 0 || ll > 0x7FFFFFFFll) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_read(host.user, (zi_handle_t)h.u.i32, pp, (zi_size32_t)ll);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_READ: {
+      if (!host.v.zi_read) return ZI_E_NOSYS;
+      if (n != 3) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2];
+      if (a0 >= val_count || a1 >= val_count || a2 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t h = vals[a0];
+      const sir_value_t p = vals[a1];
+      const sir_value_t l = vals[a2];
+      if (h.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const zi_ptr_t pp = (p.kind == SIR_VAL_PTR) ? p.u.ptr : (p.kind == SIR_VAL_I64) ? (zi_ptr_t)p.u.i64 : (zi_ptr_t)0;
+      if (p.kind != SIR_VAL_PTR && p.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      const int64_t ll = (l.kind == SIR_VAL_I64) ? l.u.i64 : (l.kind == SIR_VAL_I32) ? (int64_t)l.u.i32 : (int64_t)-1;
+      if (l.kind != SIR_VAL_I64 && l.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      if (ll < 0 || ll > 0x7FFFFFFFll) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_read(host.user, (zi_handle_t)h.u.i32, pp, (zi_size32_t)ll);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_alloc") == 0) {
-    if (!host.v.zi_alloc) return ZI_E_NOSYS;
-    if (n != 1) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0];
-    if (a0 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t sz = vals[a0];
-    if (sz.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const zi_ptr_t p = host.v.zi_alloc(host.user, (zi_size32_t)sz.u.i32);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, p ? 0 : ZI_E_OOM);
-    if (!p && sz.u.i32 != 0) return ZI_E_OOM;
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = p};
+    case SIR_HC_ZI_ALLOC: {
+      if (!host.v.zi_alloc) return ZI_E_NOSYS;
+      if (n != 1) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0];
+      if (a0 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t sz = vals[a0];
+      if (sz.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const zi_ptr_t p = host.v.zi_alloc(host.user, (zi_size32_t)sz.u.i32);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, p ? 0 : ZI_E_OOM);
+      if (!p && sz.u.i32 != 0) return ZI_E_OOM;
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = p};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_free") == 0) {
-    if (!host.v.zi_free) return ZI_E_NOSYS;
-    if (n != 1) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0];
-    if (a0 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t p = vals[a0];
-    if (p.kind != SIR_VAL_PTR) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_free(host.user, p.u.ptr);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_FREE: {
+      if (!host.v.zi_free) return ZI_E_NOSYS;
+      if (n != 1) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0];
+      if (a0 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t p = vals[a0];
+      if (p.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_free(host.user, p.u.ptr);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_telemetry") == 0) {
-    if (!host.v.zi_telemetry) return ZI_E_NOSYS;
-    if (n != 4) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2], a3 = args[3];
-    if (a0 >= val_count || a1 >= val_count || a2 >= val_count || a3 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t tp = vals[a0];
-    const sir_value_t tl = vals[a1];
-    const sir_value_t mp = vals[a2];
-    const sir_value_t ml = vals[a3];
-    const zi_ptr_t tpp = (tp.kind == SIR_VAL_PTR) ? tp.u.ptr : (tp.kind == SIR_VAL_I64) ? (zi_ptr_t)tp.u.i64 : (zi_ptr_t)0;
-    const zi_ptr_t mpp = (mp.kind == SIR_VAL_PTR) ? mp.u.ptr : (mp.kind == SIR_VAL_I64) ? (zi_ptr_t)mp.u.i64 : (zi_ptr_t)0;
-    if (tp.kind != SIR_VAL_PTR && tp.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    if (mp.kind != SIR_VAL_PTR && mp.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    if (tl.kind != SIR_VAL_I32 || ml.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_telemetry(host.user, tpp, (zi_size32_t)tl.u.i32, mpp, (zi_size32_t)ml.u.i32);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_TELEMETRY: {
+      if (!host.v.zi_telemetry) return ZI_E_NOSYS;
+      if (n != 4) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2], a3 = args[3];
+      if (a0 >= val_count || a1 >= val_count || a2 >= val_count || a3 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t tp = vals[a0];
+      const sir_value_t tl = vals[a1];
+      const sir_value_t mp = vals[a2];
+      const sir_value_t ml = vals[a3];
+      const zi_ptr_t tpp = (tp.kind == SIR_VAL_PTR) ? tp.u.ptr : (tp.kind == SIR_VAL_I64) ? (zi_ptr_t)tp.u.i64 : (zi_ptr_t)0;
+      const zi_ptr_t mpp = (mp.kind == SIR_VAL_PTR) ? mp.u.ptr : (mp.kind == SIR_VAL_I64) ? (zi_ptr_t)mp.u.i64 : (zi_ptr_t)0;
+      if (tp.kind != SIR_VAL_PTR && tp.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      if (mp.kind != SIR_VAL_PTR && mp.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      if (tl.kind != SIR_VAL_I32 || ml.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_telemetry(host.user, tpp, (zi_size32_t)tl.u.i32, mpp, (zi_size32_t)ml.u.i32);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_abi_version") == 0) {
-    if (!host.v.zi_abi_version) return ZI_E_NOSYS;
-    if (n != 0) return ZI_E_INVALID;
-    const uint32_t v = host.v.zi_abi_version(host.user);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, (int32_t)v);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)v};
+    case SIR_HC_ZI_ABI_VERSION: {
+      if (!host.v.zi_abi_version) return ZI_E_NOSYS;
+      if (n != 0) return ZI_E_INVALID;
+      const uint32_t v = host.v.zi_abi_version(host.user);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, (int32_t)v);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)v};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_ctl") == 0) {
-    if (!host.v.zi_ctl) return ZI_E_NOSYS;
-    if (n != 4) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2], a3 = args[3];
-    if (a0 >= val_count || a1 >= val_count || a2 >= val_count || a3 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t rp = vals[a0];
-    const sir_value_t rl = vals[a1];
-    const sir_value_t sp = vals[a2];
-    const sir_value_t sl = vals[a3];
-
-    const zi_ptr_t req_ptr = (rp.kind == SIR_VAL_PTR) ? rp.u.ptr : (rp.kind == SIR_VAL_I64) ? (zi_ptr_t)rp.u.i64 : (zi_ptr_t)0;
-    const zi_ptr_t resp_ptr = (sp.kind == SIR_VAL_PTR) ? sp.u.ptr : (sp.kind == SIR_VAL_I64) ? (zi_ptr_t)sp.u.i64 : (zi_ptr_t)0;
-    if (rp.kind != SIR_VAL_PTR && rp.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    if (sp.kind != SIR_VAL_PTR && sp.kind != SIR_VAL_I64) return ZI_E_INVALID;
-
-    const int64_t req_len64 = (rl.kind == SIR_VAL_I32) ? (int64_t)rl.u.i32 : (rl.kind == SIR_VAL_I64) ? rl.u.i64 : (int64_t)-1;
-    const int64_t resp_cap64 = (sl.kind == SIR_VAL_I32) ? (int64_t)sl.u.i32 : (sl.kind == SIR_VAL_I64) ? sl.u.i64 : (int64_t)-1;
-    if (rl.kind != SIR_VAL_I32 && rl.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    if (sl.kind != SIR_VAL_I32 && sl.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    if (req_len64 < 0 || req_len64 > 0x7FFFFFFFll) return ZI_E_INVALID;
-    if (resp_cap64 < 0 || resp_cap64 > 0x7FFFFFFFll) return ZI_E_INVALID;
-
-    const int32_t rc = host.v.zi_ctl(host.user, req_ptr, (zi_size32_t)req_len64, resp_ptr, (zi_size32_t)resp_cap64);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_CTL: {
+      if (!host.v.zi_ctl) return ZI_E_NOSYS;
+      if (n != 4) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2], a3 = args[3];
+      if (a0 >= val_count || a1 >= val_count || a2 >= val_count || a3 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t rp = vals[a0];
+      const sir_value_t rl = vals[a1];
+      const sir_value_t sp = vals[a2];
+      const sir_value_t sl = vals[a3];
+
+      const zi_ptr_t req_ptr = (rp.kind == SIR_VAL_PTR) ? rp.u.ptr : (rp.kind == SIR_VAL_I64) ? (zi_ptr_t)rp.u.i64 : (zi_ptr_t)0;
+      const zi_ptr_t resp_ptr = (sp.kind == SIR_VAL_PTR) ? sp.u.ptr : (sp.kind == SIR_VAL_I64) ? (zi_ptr_t)sp.u.i64 : (zi_ptr_t)0;
+      if (rp.kind != SIR_VAL_PTR && rp.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      if (sp.kind != SIR_VAL_PTR && sp.kind != SIR_VAL_I64) return ZI_E_INVALID;
+
+      const int64_t req_len64 = (rl.kind == SIR_VAL_I32) ? (int64_t)rl.u.i32 : (rl.kind == SIR_VAL_I64) ? rl.u.i64 : (int64_t)-1;
+      const int64_t resp_cap64 = (sl.kind == SIR_VAL_I32) ? (int64_t)sl.u.i32 : (sl.kind == SIR_VAL_I64) ? sl.u.i64 : (int64_t)-1;
+      if (rl.kind != SIR_VAL_I32 && rl.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      if (sl.kind != SIR_VAL_I32 && sl.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      if (req_len64 < 0 || req_len64 > 0x7FFFFFFFll) return ZI_E_INVALID;
+      if (resp_cap64 < 0 || resp_cap64 > 0x7FFFFFFFll) return ZI_E_INVALID;
+
+      const int32_t rc = host.v.zi_ctl(host.user, req_ptr, (zi_size32_t)req_len64, resp_ptr, (zi_size32_t)resp_cap64);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_cap_count") == 0) {
-    if (!host.v.zi_cap_count) return ZI_E_NOSYS;
-    if (n != 0) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_cap_count(host.user);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_CAP_COUNT: {
+      if (!host.v.zi_cap_count) return ZI_E_NOSYS;
+      if (n != 0) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_cap_count(host.user);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_cap_get_size") == 0) {
-    if (!host.v.zi_cap_get_size) return ZI_E_NOSYS;
-    if (n != 1) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0];
-    if (a0 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t idx = vals[a0];
-    if (idx.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_cap_get_size(host.user, idx.u.i32);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_CAP_GET_SIZE: {
+      if (!host.v.zi_cap_get_size) return ZI_E_NOSYS;
+      if (n != 1) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0];
+      if (a0 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t idx = vals[a0];
+      if (idx.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_cap_get_size(host.user, idx.u.i32);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_cap_get") == 0) {
-    if (!host.v.zi_cap_get) return ZI_E_NOSYS;
-    if (n != 3) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2];
-    if (a0 >= val_count || a1 >= val_count || a2 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t idx = vals[a0];
-    const sir_value_t outp = vals[a1];
-    const sir_value_t capv = vals[a2];
-    if (idx.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const zi_ptr_t out_ptr = (outp.kind == SIR_VAL_PTR) ? outp.u.ptr : (outp.kind == SIR_VAL_I64) ? (zi_ptr_t)outp.u.i64 : (zi_ptr_t)0;
-    if (outp.kind != SIR_VAL_PTR && outp.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    const int64_t out_cap64 = (capv.kind == SIR_VAL_I32) ? (int64_t)capv.u.i32 : (capv.kind == SIR_VAL_I64) ? capv.u.i64 : (int64_t)-1;
-    if (capv.kind != SIR_VAL_I32 && capv.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    if (out_cap64 < 0 || out_cap64 > 0x7FFFFFFFll) return ZI_E_INVALID;
-    const int32_t rc = host.v.zi_cap_get(host.user, idx.u.i32, out_ptr, (zi_size32_t)out_cap64);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+    case SIR_HC_ZI_CAP_GET: {
+      if (!host.v.zi_cap_get) return ZI_E_NOSYS;
+      if (n != 3) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0], a1 = args[1], a2 = args[2];
+      if (a0 >= val_count || a1 >= val_count || a2 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t idx = vals[a0];
+      const sir_value_t outp = vals[a1];
+      const sir_value_t capv = vals[a2];
+      if (idx.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const zi_ptr_t out_ptr = (outp.kind == SIR_VAL_PTR) ? outp.u.ptr : (outp.kind == SIR_VAL_I64) ? (zi_ptr_t)outp.u.i64 : (zi_ptr_t)0;
+      if (outp.kind != SIR_VAL_PTR && outp.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      const int64_t out_cap64 = (capv.kind == SIR_VAL_I32) ? (int64_t)capv.u.i32 : (capv.kind == SIR_VAL_I64) ? capv.u.i64 : (int64_t)-1;
+      if (capv.kind != SIR_VAL_I32 && capv.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      if (out_cap64 < 0 || out_cap64 > 0x7FFFFFFFll) return ZI_E_INVALID;
+      const int32_t rc = host.v.zi_cap_get(host.user, idx.u.i32, out_ptr, (zi_size32_t)out_cap64);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, rc);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = rc};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_cap_open") == 0) {
-    if (!host.v.zi_cap_open) return ZI_E_NOSYS;
-    if (n != 1) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0];
-    if (a0 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t rp = vals[a0];
-    const zi_ptr_t req_ptr = (rp.kind == SIR_VAL_PTR) ? rp.u.ptr : (rp.kind == SIR_VAL_I64) ? (zi_ptr_t)rp.u.i64 : (zi_ptr_t)0;
-    if (rp.kind != SIR_VAL_PTR && rp.kind != SIR_VAL_I64) return ZI_E_INVALID;
-    const zi_handle_t h = host.v.zi_cap_open(host.user, req_ptr);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, (int32_t)h);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)h};
+    case SIR_HC_ZI_CAP_OPEN: {
+      if (!host.v.zi_cap_open) return ZI_E_NOSYS;
+      if (n != 1) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0];
+      if (a0 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t rp = vals[a0];
+      const zi_ptr_t req_ptr = (rp.kind == SIR_VAL_PTR) ? rp.u.ptr : (rp.kind == SIR_VAL_I64) ? (zi_ptr_t)rp.u.i64 : (zi_ptr_t)0;
+      if (rp.kind != SIR_VAL_PTR && rp.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      const zi_handle_t h = host.v.zi_cap_open(host.user, req_ptr);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, (int32_t)h);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)h};
+      }
+      return 0;
     }
-    return 0;
-  }
 
-  if (strcmp(nm, "zi_handle_hflags") == 0) {
-    if (!host.v.zi_handle_hflags) return ZI_E_NOSYS;
-    if (n != 1) return ZI_E_INVALID;
-    const sir_val_id_t a0 = args[0];
-    if (a0 >= val_count) return ZI_E_BOUNDS;
-    const sir_value_t hv = vals[a0];
-    if (hv.kind != SIR_VAL_I32) return ZI_E_INVALID;
-    const uint32_t hf = host.v.zi_handle_hflags(host.user, (zi_handle_t)hv.u.i32);
-    if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, (int32_t)hf);
-    if (inst->result_count == 1) {
-      vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)hf};
+    case SIR_HC_ZI_HANDLE_HFLAGS: {
+      if (!host.v.zi_handle_hflags) return ZI_E_NOSYS;
+      if (n != 1) return ZI_E_INVALID;
+      const sir_val_id_t a0 = args[0];
+      if (a0 >= val_count) return ZI_E_BOUNDS;
+      const sir_value_t hv = vals[a0];
+      if (hv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const uint32_t hf = host.v.zi_handle_hflags(host.user, (zi_handle_t)hv.u.i32);
+      if (sink && sink->on_hostcall) sink->on_hostcall(sink->user, m, fid, ip, nm, (int32_t)hf);
+      if (inst->result_count == 1) {
+        vals[r0] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)hf};
+      }
+      return 0;
     }
-    return 0;
+    default:
+      break;
   }
 
   return ZI_E_NOSYS;
 }
 
-typedef struct sir_frame {
-  const sir_func_t* f;
-  sir_value_t* vals;
-} sir_frame_t;
-
 static bool f32_is_nan_bits(uint32_t bits) {
   const uint32_t exp = bits & 0x7F800000u;
   const uint32_t frac = bits & 0x007FFFFFu;
@@ -2262,16 +3121,529 @@ static uint64_t f64_canon_bits(uint64_t bits) {
   return f64_is_nan_bits(bits) ? 0x7FF8000000000000ull : bits;
 }
 
+static float f32_from_bits(uint32_t bits) {
+  float v = 0.0f;
+  memcpy(&v, &bits, 4);
+  return v;
+}
+
+static double f64_from_bits(uint64_t bits) {
+  double v = 0.0;
+  memcpy(&v, &bits, 8);
+  return v;
+}
+
+static uint32_t f32_bits(float v) {
+  uint32_t bits = 0;
+  memcpy(&bits, &v, 4);
+  return f32_canon_bits(bits);
+}
+
+static uint64_t f64_bits(double v) {
+  uint64_t bits = 0;
+  memcpy(&bits, &v, 8);
+  return f64_canon_bits(bits);
+}
+
+// Numeric op kernels shared by the engines; operand kinds are the caller's
+// job. I64_DIV_S_TRAP sets *out_trap on /0 and INT64_MIN / -1.
+static int64_t num_i64_bin(sir_inst_kind_t k, int64_t x, int64_t y, bool* out_trap) {
+  const uint64_t p = (uint64_t)x;
+  const uint64_t q = (uint64_t)y;
+  *out_trap = false;
+  switch (k) {
+    case SIR_INST_I64_ADD:
+      return (int64_t)(p + q);
+    case SIR_INST_I64_SUB:
+      return (int64_t)(p - q);
+    case SIR_INST_I64_MUL:
+      return (int64_t)(p * q);
+    case SIR_INST_I64_AND:
+      return (int64_t)(p & q);
+    case SIR_INST_I64_OR:
+      return (int64_t)(p | q);
+    case SIR_INST_I64_XOR:
+      return (int64_t)(p ^ q);
+    case SIR_INST_I64_SHL:
+      return (int64_t)(p << (q & 63u));
+    case SIR_INST_I64_SHR_S:
+      return x >> (q & 63u);
+    case SIR_INST_I64_SHR_U:
+      return (int64_t)(p >> (q & 63u));
+    case SIR_INST_I64_DIV_S_SAT:
+      if (y == 0) return 0;
+      if (x == INT64_MIN && y == -1) return INT64_MIN;
+      return x / y;
+    case SIR_INST_I64_DIV_S_TRAP:
+      if (y == 0 || (x == INT64_MIN && y == -1)) {
+        *out_trap = true;
+        return 0;
+      }
+      return x / y;
+    case SIR_INST_I64_DIV_U_SAT:
+      return q ? (int64_t)(p / q) : 0;
+    case SIR_INST_I64_REM_S_SAT:
+      if (y == 0 || (x == INT64_MIN && y == -1)) return 0;
+      return x % y;
+    case SIR_INST_I64_REM_U_SAT:
+      return q ? (int64_t)(p % q) : 0;
+    default:
+      return 0;
+  }
+}
+
+static bool num_i64_cmp(sir_inst_kind_t k, int64_t x, int64_t y) {
+  switch (k) {
+    case SIR_INST_I64_CMP_EQ:
+      return x == y;
+    case SIR_INST_I64_CMP_NE:
+      return x != y;
+    case SIR_INST_I64_CMP_SLT:
+      return x < y;
+    case SIR_INST_I64_CMP_SLE:
+      return x <= y;
+    case SIR_INST_I64_CMP_SGT:
+      return x > y;
+    case SIR_INST_I64_CMP_SGE:
+      return x >= y;
+    case SIR_INST_I64_CMP_ULT:
+      return (uint64_t)x < (uint64_t)y;
+    case SIR_INST_I64_CMP_ULE:
+      return (uint64_t)x <= (uint64_t)y;
+    case SIR_INST_I64_CMP_UGT:
+      return (uint64_t)x > (uint64_t)y;
+    case SIR_INST_I64_CMP_UGE:
+      return (uint64_t)x >= (uint64_t)y;
+    default:
+      return false;
+  }
+}
+
+static uint32_t num_f32_bin(sir_inst_kind_t k, uint32_t a, uint32_t b) {
+  const float x = f32_from_bits(a);
+  const float y = f32_from_bits(b);
+  switch (k) {
+    case SIR_INST_F32_ADD:
+      return f32_bits(x + y);
+    case SIR_INST_F32_SUB:
+      return f32_bits(x - y);
+    case SIR_INST_F32_MUL:
+      return f32_bits(x * y);
+    default:
+      return f32_bits(x / y);
+  }
+}
+
+static uint64_t num_f64_bin(sir_inst_kind_t k, uint64_t a, uint64_t b) {
+  const double x = f64_from_bits(a);
+  const double y = f64_from_bits(b);
+  switch (k) {
+    case SIR_INST_F64_ADD:
+      return f64_bits(x + y);
+    case SIR_INST_F64_SUB:
+      return f64_bits(x - y);
+    case SIR_INST_F64_MUL:
+      return f64_bits(x * y);
+    default:
+      return f64_bits(x / y);
+  }
+}
+
+// F32 operands are widened exactly, so one predicate table serves both.
+static bool num_f_cmp(sir_inst_kind_t k, double x, double y) {
+  const bool uno = x != x || y != y;
+  switch (k) {
+    case SIR_INST_F32_CMP_OEQ:
+    case SIR_INST_F64_CMP_OEQ:
+      return !uno && x == y;
+    case SIR_INST_F32_CMP_ONE:
+    case SIR_INST_F64_CMP_ONE:
+      return !uno && x != y;
+    case SIR_INST_F32_CMP_OLT:
+    case SIR_INST_F64_CMP_OLT:
+      return !uno && x < y;
+    case SIR_INST_F32_CMP_OLE:
+    case SIR_INST_F64_CMP_OLE:
+      return !uno && x <= y;
+    case SIR_INST_F32_CMP_OGT:
+    case SIR_INST_F64_CMP_OGT:
+      return !uno && x > y;
+    case SIR_INST_F32_CMP_OGE:
+    case SIR_INST_F64_CMP_OGE:
+      return !uno && x >= y;
+    case SIR_INST_F32_CMP_UEQ:
+    case SIR_INST_F64_CMP_UEQ:
+      return uno || x == y;
+    case SIR_INST_F32_CMP_UNE:
+    case SIR_INST_F64_CMP_UNE:
+      return uno || x != y;
+    case SIR_INST_F32_CMP_ULT:
+    case SIR_INST_F64_CMP_ULT:
+      return uno || x < y;
+    case SIR_INST_F32_CMP_ULE:
+    case SIR_INST_F64_CMP_ULE:
+      return uno || x <= y;
+    case SIR_INST_F32_CMP_UGT:
+    case SIR_INST_F64_CMP_UGT:
+      return uno || x > y;
+    case SIR_INST_F32_CMP_UGE:
+    case SIR_INST_F64_CMP_UGE:
+      return uno || x >= y;
+    default:
+      return false;
+  }
+}
+
+// Same clamping as sircc's iN.trunc_sat_fM lowering.
+static int64_t num_trunc_sat_s(double v, bool wide) {
+  const double lim = wide ? 9223372036854775808.0 : 2147483648.0;
+  if (v != v) return 0;
+  if (v < -lim) return wide ? INT64_MIN : INT32_MIN;
+  if (v >= lim) return wide ? INT64_MAX : INT32_MAX;
+  return (int64_t)v;
+}
+
+static uint64_t num_trunc_sat_u(double v, bool wide) {
+  const double lim = wide ? 18446744073709551616.0 : 4294967296.0;
+  if (v != v || v <= 0.0) return 0;
+  if (v >= lim) return wide ? UINT64_MAX : UINT32_MAX;
+  return (uint64_t)v;
+}
+
+static bool num_is_f32_cmp(sir_inst_kind_t k) {
+  return k >= SIR_INST_F32_CMP_OEQ && k <= SIR_INST_F32_CMP_UGE;
+}
+
+// Applies a num_un op. Returns false when xv has the wrong kind.
+static bool num_un_eval(sir_inst_kind_t k, sir_value_t xv, sir_value_t* out) {
+  sir_val_kind_t in = SIR_VAL_I64;
+  switch (k) {
+    case SIR_INST_I64_SEXT_I32:
+    case SIR_INST_F32_FROM_I32_S:
+    case SIR_INST_F32_FROM_I32_U:
+    case SIR_INST_F64_FROM_I32_S:
+    case SIR_INST_F64_FROM_I32_U:
+      in = SIR_VAL_I32;
+      break;
+    case SIR_INST_F32_NEG:
+    case SIR_INST_I32_TRUNC_SAT_F32_S:
+    case SIR_INST_I32_TRUNC_SAT_F32_U:
+    case SIR_INST_I64_TRUNC_SAT_F32_S:
+    case SIR_INST_I64_TRUNC_SAT_F32_U:
+    case SIR_INST_F64_PROMOTE_F32:
+      in = SIR_VAL_F32;
+      break;
+    case SIR_INST_F64_NEG:
+    case SIR_INST_I32_TRUNC_SAT_F64_S:
+    case SIR_INST_I32_TRUNC_SAT_F64_U:
+    case SIR_INST_I64_TRUNC_SAT_F64_S:
+    case SIR_INST_I64_TRUNC_SAT_F64_U:
+    case SIR_INST_F32_DEMOTE_F64:
+      in = SIR_VAL_F64;
+      break;
+    default:
+      break;
+  }
+  if (xv.kind != in) return false;
+  const double fv = in == SIR_VAL_F32 ? (double)f32_from_bits(xv.u.f32_bits) : in == SIR_VAL_F64 ? f64_from_bits(xv.u.f64_bits) : 0.0;
+  switch (k) {
+    case SIR_INST_I64_NOT:
+      *out = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)~(uint64_t)xv.u.i64};
+      return true;
+    case SIR_INST_I64_NEG:
+      *out = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)(0u - (uint64_t)xv.u.i64)};
+      return true;
+    case SIR_INST_F32_NEG:
+      *out = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_canon_bits(xv.u.f32_bits ^ 0x80000000u)};
+      return true;
+    case SIR_INST_F64_NEG:
+      *out = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_canon_bits(xv.u.f64_bits ^ 0x8000000000000000ull)};
+      return true;
+    case SIR_INST_I64_SEXT_I32:
+      *out = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)xv.u.i32};
+      return true;
+    case SIR_INST_F32_FROM_I32_S:
+      *out = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_bits((float)xv.u.i32)};
+      return true;
+    case SIR_INST_F32_FROM_I32_U:
+      *out = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_bits((float)(uint32_t)xv.u.i32)};
+      return true;
+    case SIR_INST_F32_FROM_I64_S:
+      *out = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_bits((float)xv.u.i64)};
+      return true;
+    case SIR_INST_F32_FROM_I64_U:
+      *out = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_bits((float)(uint64_t)xv.u.i64)};
+      return true;
+    case SIR_INST_F64_FROM_I32_S:
+      *out = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_bits((double)xv.u.i32)};
+      return true;
+    case SIR_INST_F64_FROM_I32_U:
+      *out = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_bits((double)(uint32_t)xv.u.i32)};
+      return true;
+    case SIR_INST_F64_FROM_I64_S:
+      *out = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_bits((double)xv.u.i64)};
+      return true;
+    case SIR_INST_F64_FROM_I64_U:
+      *out = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_bits((double)(uint64_t)xv.u.i64)};
+      return true;
+    case SIR_INST_I32_TRUNC_SAT_F32_S:
+    case SIR_INST_I32_TRUNC_SAT_F64_S:
+      *out = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)num_trunc_sat_s(fv, false)};
+      return true;
+    case SIR_INST_I32_TRUNC_SAT_F32_U:
+    case SIR_INST_I32_TRUNC_SAT_F64_U:
+      *out = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(uint32_t)num_trunc_sat_u(fv, false)};
+      return true;
+    case SIR_INST_I64_TRUNC_SAT_F32_S:
+    case SIR_INST_I64_TRUNC_SAT_F64_S:
+      *out = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = num_trunc_sat_s(fv, true)};
+      return true;
+    case SIR_INST_I64_TRUNC_SAT_F32_U:
+    case SIR_INST_I64_TRUNC_SAT_F64_U:
+      *out = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)num_trunc_sat_u(fv, true)};
+      return true;
+    case SIR_INST_F64_PROMOTE_F32:
+      *out = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_bits(fv)};
+      return true;
+    case SIR_INST_F32_DEMOTE_F64:
+      *out = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_bits((float)fv)};
+      return true;
+    default:
+      return false;
+  }
+}
+
 static bool is_pow2_u32(uint32_t x) {
   return x != 0u && (x & (x - 1u)) == 0u;
 }
 
-static int32_t exec_func(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const zi_ptr_t* globals, uint32_t global_count,
-                         sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results, uint32_t out_result_count,
-                         uint32_t depth, const sir_exec_event_sink_t* sink);
+// Per-function engine state. sir_mb_finalize (tx_build) fills in the initial
+// register file and the inline-cache tables; the decoded stream and machine
+// code are built lazily on the first call and published with a CAS, so
+// concurrent runs of one module may race to decode but all share the winner.
+// Inline cache of one call.func_ptr site: tagged pointers that already
+// passed the decode, range and signature checks there (which depend only on
+// the module and the site). Entries are only ever replaced by other checked
+// values, so concurrent runs share them through relaxed atomics.
+#define SIR_IC_WAYS 4u
+
+typedef struct sir_icache {
+  _Atomic(uint64_t) ptr[SIR_IC_WAYS]; // 0 = empty (never a valid tagged pointer)
+  _Atomic(uint32_t) victim;           // round-robin replacement on a miss
+} sir_icache_t;
+
+struct sir_tfunc {
+  _Atomic(sir_tinst_t*) code; // inst_count entries plus the END sentinel; decoded on first use (tx_code)
+  _Atomic(sir_ncode_t*) native; // machine code; compiled on first use (nx_code)
+  uint32_t count;
+  sir_value_t* frame0;        // initial register file (value_count entries)
+  sir_icache_t* ic;           // one per call.func_ptr site, in ip order
+  uint32_t* ic_ip;            // ip of each site
+  uint32_t ic_count;
+};
+
+// Call frames for one run. Frames are pushed and popped in LIFO order from a
+// list of chunks, so a call costs a bump plus a template copy rather than a
+// calloc/free pair. Chunks past `cur` are kept for reuse until the run ends.
+#define SIR_FRAME_CHUNK_SLOTS 16384u
+
+typedef struct sir_frame_chunk {
+  struct sir_frame_chunk* next;
+  uint32_t cap;
+  uint32_t top;
+  sir_value_t slots[];
+} sir_frame_chunk_t;
+
+typedef struct sir_frame_arena {
+  sir_frame_chunk_t* head;
+  sir_frame_chunk_t* cur;
+} sir_frame_arena_t;
+
+typedef struct sir_frame_mark {
+  sir_frame_chunk_t* chunk;
+  uint32_t top;
+  uint64_t guest_sp; // guest stack pointer on entry (see exec_frame_enter)
+} sir_frame_mark_t;
+
+static sir_value_t* frame_push(sir_frame_arena_t* a, uint32_t n, sir_frame_mark_t* out_mark) {
+  sir_frame_chunk_t* c = a->cur;
+  *out_mark = (sir_frame_mark_t){.chunk = c, .top = c ? c->top : 0};
+  if (!c || c->cap - c->top < n) {
+    sir_frame_chunk_t* next = c ? c->next : a->head;
+    if (!next || next->cap < n) {
+      const uint32_t cap = n > SIR_FRAME_CHUNK_SLOTS ? n : SIR_FRAME_CHUNK_SLOTS;
+      sir_frame_chunk_t* nc = (sir_frame_chunk_t*)malloc(sizeof(*nc) + (size_t)cap * sizeof(sir_value_t));
+      if (!nc) return NULL;
+      nc->cap = cap;
+      nc->next = next;
+      if (c) c->next = nc;
+      else a->head = nc;
+      next = nc;
+    }
+    next->top = 0;
+    a->cur = c = next;
+  }
+  sir_value_t* v = c->slots + c->top;
+  c->top += n;
+  return v;
+}
+
+static void frame_pop(sir_frame_arena_t* a, sir_frame_mark_t mark) {
+  if (mark.chunk) mark.chunk->top = mark.top;
+  a->cur = mark.chunk;
+}
+
+static void frame_arena_dispose(sir_frame_arena_t* a) {
+  sir_frame_chunk_t* c = a->head;
+  while (c) {
+    sir_frame_chunk_t* next = c->next;
+    free(c);
+    c = next;
+  }
+  a->head = NULL;
+  a->cur = NULL;
+}
+
+// Shadow call stack for opts->sampler. Calls nest at most 1025 deep (see the
+// depth checks); deeper entries would only be counted.
+#define SIR_PROF_MAX_DEPTH 1040u
+
+typedef struct sir_exec_prof {
+  const sir_exec_sampler_t* s;
+  uint32_t left; // instructions until the next sample
+  uint32_t depth;
+  sir_func_id_t stack[SIR_PROF_MAX_DEPTH];
+} sir_exec_prof_t;
+
+// Per-run execution state shared by the interpreter engines.
+typedef struct sir_exec {
+  const sir_module_t* m;
+  sem_guest_mem_t* mem;
+  sir_host_t host;
+  const zi_ptr_t* globals;
+  uint32_t global_count;
+  const sir_exec_event_sink_t* sink;
+  sir_tfunc_t* tfuncs; // sir_module_impl_t::tfuncs (may be NULL)
+  const uint8_t* sym_hostcall; // sir_module_impl_t::sym_hostcall (may be NULL)
+  sir_frame_arena_t* frames;
+  // Tiered and native engines only (tier is NULL otherwise): counters per
+  // function, and whether promoted functions may run native code.
+  sir_tier_stats_t* tier;
+  uint32_t hot_calls;
+  uint32_t hot_loops;
+  bool native;
+  sir_exec_prof_t* prof; // NULL unless sampling
+} sir_exec_t;
+
+static sir_hostcall_t exec_hostcall(const sir_exec_t* x, sir_sym_id_t callee) {
+  if (x->sym_hostcall && callee != 0 && callee <= x->m->sym_count) return (sir_hostcall_t)x->sym_hostcall[callee - 1];
+  const sir_sym_t* s = sym_at(x->m, callee);
+  return s ? hostcall_lookup(s->name) : SIR_HC_UNKNOWN;
+}
+
+static sir_val_kind_t val_kind_for_prim(sir_prim_type_t prim) {
+  switch (prim) {
+    case SIR_PRIM_I1:
+      return SIR_VAL_I1;
+    case SIR_PRIM_I8:
+      return SIR_VAL_I8;
+    case SIR_PRIM_I16:
+      return SIR_VAL_I16;
+    case SIR_PRIM_I32:
+      return SIR_VAL_I32;
+    case SIR_PRIM_I64:
+      return SIR_VAL_I64;
+    case SIR_PRIM_PTR:
+      return SIR_VAL_PTR;
+    case SIR_PRIM_BOOL:
+      return SIR_VAL_BOOL;
+    case SIR_PRIM_F32:
+      return SIR_VAL_F32;
+    case SIR_PRIM_F64:
+      return SIR_VAL_F64;
+    default:
+      return SIR_VAL_INVALID;
+  }
+}
+
+static int32_t exec_frame_seed(const sir_module_t* m, const sir_func_t* f, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count,
+                               sir_value_t* vals) {
+  if (args == NULL && arg_count == 0 && fid == m->entry) {
+    // Default-initialize entry params to zero (DX convenience).
+    for (uint32_t i = 0; i < f->sig.param_count; i++) {
+      if (i >= f->value_count) return ZI_E_BOUNDS;
+      const sir_type_id_t tid = f->sig.params ? f->sig.params[i] : 0;
+      if (tid == 0 || tid > m->type_count) return ZI_E_INVALID;
+      const sir_val_kind_t k = val_kind_for_prim(m->types[tid - 1].prim);
+      if (k == SIR_VAL_INVALID) return ZI_E_INVALID;
+      vals[i] = (sir_value_t){.kind = k};
+    }
+    return 0;
+  }
+  for (uint32_t i = 0; i < arg_count; i++) {
+    if (i >= f->value_count) return ZI_E_BOUNDS;
+    vals[i] = args[i];
+  }
+  return 0;
+}
+
+// Pushes a frame for `fid` and seeds it with the call arguments. Slots start
+// from the function's frame template: statically typed slots already carry
+// their kind (see tx_infer_kinds), everything else starts zeroed. On success
+// the caller leaves the frame with exec_frame_leave(x, *out_mark), which also
+// releases the frame's ALLOCA memory.
+static int32_t exec_frame_enter(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, const sir_value_t* args, uint32_t arg_count,
+                                sir_frame_mark_t* out_mark, sir_value_t** out_vals) {
+  sir_value_t* vals = frame_push(x->frames, f->value_count, out_mark);
+  if (!vals) return ZI_E_OOM;
+  out_mark->guest_sp = sem_guest_stack_save(x->mem);
+  if (x->tfuncs && x->tfuncs[fid - 1].frame0) memcpy(vals, x->tfuncs[fid - 1].frame0, (size_t)f->value_count * sizeof(*vals));
+  else memset(vals, 0, (size_t)f->value_count * sizeof(*vals));
+  const int32_t rc = exec_frame_seed(x->m, f, fid, args, arg_count, vals);
+  if (rc != 0) {
+    frame_pop(x->frames, *out_mark);
+    return rc;
+  }
+  sir_exec_prof_t* p = x->prof;
+  if (p) {
+    if (p->depth < SIR_PROF_MAX_DEPTH) p->stack[p->depth] = fid;
+    p->depth++;
+  }
+  *out_vals = vals;
+  return 0;
+}
+
+static void exec_frame_leave(const sir_exec_t* x, sir_frame_mark_t mark) {
+  sem_guest_stack_restore(x->mem, mark.guest_sp);
+  frame_pop(x->frames, mark);
+  if (x->prof && x->prof->depth) x->prof->depth--;
+}
+
+// Per-instruction hooks of instrumented runs: the sink's on_step and the
+// sampler's countdown.
+static inline void exec_step_hooks(const sir_exec_t* x, const sir_exec_event_sink_t* sink, sir_func_id_t fid, uint32_t ip,
+                                   sir_inst_kind_t k) {
+  if (sink && sink->on_step) sink->on_step(sink->user, x->m, fid, ip, k);
+  sir_exec_prof_t* p = x->prof;
+  if (p && --p->left == 0) {
+    p->left = p->s->period;
+    p->s->on_sample(p->s->user, x->m, p->stack, p->depth < SIR_PROF_MAX_DEPTH ? p->depth : SIR_PROF_MAX_DEPTH, ip);
+  }
+}
+
+static int32_t exec_func(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results,
+                         uint32_t out_result_count, uint32_t depth);
+static int32_t tier_call(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results,
+                         uint32_t out_result_count, uint32_t depth);
+static const sir_tinst_t* tx_code(sir_tfunc_t* tf, const sir_func_t* f);
+static bool tier_osr(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, uint32_t ip, sir_value_t* vals, sir_value_t* out_results,
+                     uint32_t out_result_count, uint32_t depth, int32_t* out_rc);
+static int32_t tx_loop(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, const sir_tinst_t* code, uint32_t ip0,
+                       sir_value_t* vals, sir_value_t* out_results, uint32_t out_result_count, uint32_t depth,
+                       const void* const** out_labels);
 
-static int32_t exec_call_func(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const zi_ptr_t* globals, uint32_t global_count,
-                              const sir_inst_t* inst, sir_value_t* vals, uint32_t val_count, uint32_t depth, const sir_exec_event_sink_t* sink) {
+static int32_t exec_call_func(const sir_exec_t* x, const sir_inst_t* inst, sir_value_t* vals, uint32_t val_count, uint32_t depth) {
+  const sir_module_t* m = x->m;
   if (!m || !inst || !vals) return ZI_E_INTERNAL;
   const sir_func_id_t fid = inst->u.call_func.callee;
   if (fid == 0 || fid > m->func_count) return ZI_E_NOENT;
@@ -2290,8 +3662,8 @@ static int32_t exec_call_func(const sir_module_t* m, sem_guest_mem_t* mem, sir_h
 
   sir_value_t resv[2];
   memset(resv, 0, sizeof(resv));
-  const int32_t rc =
-      exec_func(m, mem, host, globals, global_count, fid, argv, inst->u.call_func.arg_count, resv, inst->result_count, depth + 1, sink);
+  const int32_t rc = x->tier ? tier_call(x, fid, argv, inst->u.call_func.arg_count, resv, inst->result_count, depth + 1)
+                             : exec_func(x, fid, argv, inst->u.call_func.arg_count, resv, inst->result_count, depth + 1);
   // Propagate errors and process-exit requests.
   if (rc != 0) return rc;
   for (uint8_t ri = 0; ri < inst->result_count; ri++) {
@@ -2302,6 +3674,20 @@ static int32_t exec_call_func(const sir_module_t* m, sem_guest_mem_t* mem, sir_h
   return 0;
 }
 
+// Inline cache of the call.func_ptr at `ip`, or NULL.
+static sir_icache_t* exec_icache(const sir_exec_t* x, sir_func_id_t fid, uint32_t ip) {
+  if (!x->tfuncs) return NULL;
+  const sir_tfunc_t* tf = &x->tfuncs[fid - 1];
+  uint32_t lo = 0;
+  uint32_t hi = tf->ic_count;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2u;
+    if (tf->ic_ip[mid] < ip) lo = mid + 1u;
+    else hi = mid;
+  }
+  return lo < tf->ic_count && tf->ic_ip[lo] == ip ? &tf->ic[lo] : NULL;
+}
+
 static bool decode_tagged_fid(zi_ptr_t p, sir_func_id_t* out_fid) {
   if (!out_fid) return false;
   // Encoding contract: ptr = 0xF000... | fid
@@ -2314,8 +3700,37 @@ static bool decode_tagged_fid(zi_ptr_t p, sir_func_id_t* out_fid) {
   return true;
 }
 
-static int32_t exec_call_func_ptr(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const zi_ptr_t* globals, uint32_t global_count,
-                                  const sir_inst_t* inst, sir_value_t* vals, uint32_t val_count, uint32_t depth, const sir_exec_event_sink_t* sink) {
+// Callee of a call.func_ptr through pointer `p`, checked against the call's
+// arity. A hit in the site's inline cache (`ic`, may be NULL) skips the checks.
+// Only tagged pointers are probed: empty ways hold 0, which must not match a
+// null callee.
+static int32_t exec_resolve_func_ptr(const sir_module_t* m, sir_icache_t* ic, const sir_inst_t* inst, zi_ptr_t p, sir_func_id_t* out_fid) {
+  const uint64_t tag = UINT64_C(0xF000000000000000);
+  if (ic && ((uint64_t)p & tag) == tag) {
+    for (uint32_t w = 0; w < SIR_IC_WAYS; w++) {
+      if (atomic_load_explicit(&ic->ptr[w], memory_order_relaxed) == (uint64_t)p) {
+        *out_fid = (sir_func_id_t)((uint64_t)p & UINT64_C(0x0FFFFFFFFFFFFFFF));
+        return 0;
+      }
+    }
+  }
+  sir_func_id_t fid = 0;
+  if (!decode_tagged_fid(p, &fid)) return ZI_E_INVALID;
+  if (fid == 0 || fid > m->func_count) return ZI_E_NOENT;
+  const sir_func_t* cf = &m->funcs[fid - 1];
+  if (inst->u.call_func_ptr.arg_count != cf->sig.param_count) return ZI_E_INVALID;
+  if (inst->result_count != cf->sig.result_count) return ZI_E_INVALID;
+  if (ic) {
+    const uint32_t w = atomic_fetch_add_explicit(&ic->victim, 1u, memory_order_relaxed) % SIR_IC_WAYS;
+    atomic_store_explicit(&ic->ptr[w], (uint64_t)p, memory_order_relaxed);
+  }
+  *out_fid = fid;
+  return 0;
+}
+
+static int32_t exec_call_func_ptr(const sir_exec_t* x, sir_icache_t* ic, const sir_inst_t* inst, sir_value_t* vals, uint32_t val_count,
+                                  uint32_t depth) {
+  const sir_module_t* m = x->m;
   if (!m || !inst || !vals) return ZI_E_INTERNAL;
   const sir_val_id_t callee_slot = inst->u.call_func_ptr.callee_ptr;
   if (callee_slot >= val_count) return ZI_E_BOUNDS;
@@ -2323,12 +3738,8 @@ static int32_t exec_call_func_ptr(const sir_module_t* m, sem_guest_mem_t* mem, s
   if (cv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
 
   sir_func_id_t fid = 0;
-  if (!decode_tagged_fid(cv.u.ptr, &fid)) return ZI_E_INVALID;
-  if (fid == 0 || fid > m->func_count) return ZI_E_NOENT;
-
-  const sir_func_t* cf = &m->funcs[fid - 1];
-  if (inst->u.call_func_ptr.arg_count != cf->sig.param_count) return ZI_E_INVALID;
-  if (inst->result_count != cf->sig.result_count) return ZI_E_INVALID;
+  const int32_t resolve_rc = exec_resolve_func_ptr(m, ic, inst, cv.u.ptr, &fid);
+  if (resolve_rc != 0) return resolve_rc;
 
   if (inst->u.call_func_ptr.arg_count > 16) return ZI_E_INVALID;
   sir_value_t argv[16];
@@ -2340,8 +3751,8 @@ static int32_t exec_call_func_ptr(const sir_module_t* m, sem_guest_mem_t* mem, s
 
   sir_value_t resv[2];
   memset(resv, 0, sizeof(resv));
-  const int32_t rc =
-      exec_func(m, mem, host, globals, global_count, fid, argv, inst->u.call_func_ptr.arg_count, resv, inst->result_count, depth + 1, sink);
+  const int32_t rc = x->tier ? tier_call(x, fid, argv, inst->u.call_func_ptr.arg_count, resv, inst->result_count, depth + 1)
+                             : exec_func(x, fid, argv, inst->u.call_func_ptr.arg_count, resv, inst->result_count, depth + 1);
   if (rc != 0) return rc;
   for (uint8_t ri = 0; ri < inst->result_count; ri++) {
     const sir_val_id_t dst = inst->results[ri];
@@ -2351,1459 +3762,3990 @@ static int32_t exec_call_func_ptr(const sir_module_t* m, sem_guest_mem_t* mem, s
   return 0;
 }
 
-static int32_t exec_func(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const zi_ptr_t* globals, uint32_t global_count,
-                         sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results, uint32_t out_result_count,
-                         uint32_t depth, const sir_exec_event_sink_t* sink) {
-  if (!m) return ZI_E_INTERNAL;
-  if (depth > 1024) return ZI_E_INTERNAL;
-  if (fid == 0 || fid > m->func_count) return ZI_E_NOENT;
+// ---- Vector kernels (SIR_INST_VEC_*) ----
+// Buffers are host views of guest memory and may be unaligned. Each kernel
+// has an SSE2 (and AVX2, when compiled in) body plus a scalar tail/fallback.
 
-  const sir_func_t* f = &m->funcs[fid - 1];
-  if (!(args == NULL && arg_count == 0 && fid == m->entry) && arg_count != f->sig.param_count) return ZI_E_INVALID;
-  if (out_result_count != f->sig.result_count) return ZI_E_INVALID;
+static void vec_i32_add(uint8_t* out, const uint8_t* a, const uint8_t* b, uint32_t n) {
+  uint32_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 8u <= n; i += 8u) {
+    const __m256i va = _mm256_loadu_si256((const __m256i*)(const void*)(a + i * 4u));
+    const __m256i vb = _mm256_loadu_si256((const __m256i*)(const void*)(b + i * 4u));
+    _mm256_storeu_si256((__m256i*)(void*)(out + i * 4u), _mm256_add_epi32(va, vb));
+  }
+#endif
+#if defined(__SSE2__)
+  for (; i + 4u <= n; i += 4u) {
+    const __m128i va = _mm_loadu_si128((const __m128i*)(const void*)(a + i * 4u));
+    const __m128i vb = _mm_loadu_si128((const __m128i*)(const void*)(b + i * 4u));
+    _mm_storeu_si128((__m128i*)(void*)(out + i * 4u), _mm_add_epi32(va, vb));
+  }
+#endif
+  for (; i < n; i++) {
+    uint32_t p = 0, q = 0;
+    memcpy(&p, a + i * 4u, 4);
+    memcpy(&q, b + i * 4u, 4);
+    p += q;
+    memcpy(out + i * 4u, &p, 4);
+  }
+}
 
-  if (f->value_count > 1u << 20) return ZI_E_INVALID;
-  sir_value_t* vals = (sir_value_t*)calloc(f->value_count, sizeof(*vals));
-  if (!vals) return ZI_E_OOM;
+// Writes 0/1 bytes; `lt` selects signed less-than instead of equality.
+static void vec_i32_cmp(uint8_t* out, const uint8_t* a, const uint8_t* b, uint32_t n, bool lt) {
+  uint32_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 4u <= n; i += 4u) {
+    const __m128i va = _mm_loadu_si128((const __m128i*)(const void*)(a + i * 4u));
+    const __m128i vb = _mm_loadu_si128((const __m128i*)(const void*)(b + i * 4u));
+    const __m128i c = lt ? _mm_cmplt_epi32(va, vb) : _mm_cmpeq_epi32(va, vb);
+    const int bits = _mm_movemask_ps(_mm_castsi128_ps(c));
+    out[i] = (uint8_t)(bits & 1);
+    out[i + 1u] = (uint8_t)((bits >> 1) & 1);
+    out[i + 2u] = (uint8_t)((bits >> 2) & 1);
+    out[i + 3u] = (uint8_t)((bits >> 3) & 1);
+  }
+#endif
+  for (; i < n; i++) {
+    int32_t p = 0, q = 0;
+    memcpy(&p, a + i * 4u, 4);
+    memcpy(&q, b + i * 4u, 4);
+    out[i] = (uint8_t)((lt ? p < q : p == q) ? 1 : 0);
+  }
+}
 
-  if (args == NULL && arg_count == 0 && fid == m->entry) {
-    // Default-initialize entry params to zero (DX convenience).
-    for (uint32_t i = 0; i < f->sig.param_count; i++) {
-      if (i >= f->value_count) {
-        free(vals);
-        return ZI_E_BOUNDS;
+static void vec_select_i32(uint8_t* out, const uint8_t* mask, const uint8_t* a, const uint8_t* b, uint32_t n) {
+  uint32_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 4u <= n; i += 4u) {
+    int32_t m4 = 0;
+    memcpy(&m4, mask + i, 4);
+    // Widen the four mask bytes to 32-bit lanes, then to all-ones/all-zeros.
+    __m128i mv = _mm_cvtsi32_si128(m4);
+    mv = _mm_unpacklo_epi16(_mm_unpacklo_epi8(mv, zero), zero);
+    const __m128i pick_b = _mm_cmpeq_epi32(mv, zero);
+    const __m128i va = _mm_loadu_si128((const __m128i*)(const void*)(a + i * 4u));
+    const __m128i vb = _mm_loadu_si128((const __m128i*)(const void*)(b + i * 4u));
+    const __m128i r = _mm_or_si128(_mm_and_si128(pick_b, vb), _mm_andnot_si128(pick_b, va));
+    _mm_storeu_si128((__m128i*)(void*)(out + i * 4u), r);
+  }
+#endif
+  for (; i < n; i++) memmove(out + i * 4u, mask[i] ? a + i * 4u : b + i * 4u, 4);
+}
+
+// dst may alias an input exactly when both have the same lane width.
+static bool vec_overlap_bad(zi_ptr_t d, zi_ptr_t s, uint64_t d_len, uint64_t s_len) {
+  if (d == s && d_len == s_len) return false;
+  return d < s + s_len && s < d + d_len;
+}
+
+// The run's sink for events raised in fid; NULL when its func_mask leaves fid out.
+static inline const sir_exec_event_sink_t* exec_sink(const sir_exec_t* x, sir_func_id_t fid) {
+  const sir_exec_event_sink_t* sink = x->sink;
+  if (sink && sink->func_mask && fid && fid <= x->m->func_count && !sink->func_mask[fid - 1]) return NULL;
+  return sink;
+}
+
+// Runs one SIR_INST_VEC_* instruction. Returns 0, 256 for a trap or ZI_E_*.
+// Memory events: one read per input vector, then one write for dst.
+static int32_t exec_vec(const sir_exec_t* x, sir_func_id_t fid, uint32_t ip, const sir_inst_t* inst, sir_value_t* vals, uint32_t val_count) {
+  const sir_exec_event_sink_t* sink = exec_sink(x, fid);
+  const sir_val_id_t dst_id = inst->u.vec.dst;
+  const sir_val_id_t a_id = inst->u.vec.a;
+  const sir_val_id_t b_id = inst->u.vec.b;
+  const sir_val_id_t m_id = inst->u.vec.mask;
+  const uint32_t n = inst->u.vec.lanes;
+  if (n == 0 || n > 0x1FFFFFFFu) return ZI_E_INVALID;
+  if (dst_id >= val_count || a_id >= val_count) return ZI_E_BOUNDS;
+
+  const bool splat = inst->k == SIR_INST_VEC_SPLAT_I32 || inst->k == SIR_INST_VEC_SPLAT_BOOL;
+  const bool select = inst->k == SIR_INST_VEC_SELECT_I32;
+  const bool bool_out = inst->k == SIR_INST_VEC_SPLAT_BOOL || inst->k == SIR_INST_VEC_I32_CMP_EQ || inst->k == SIR_INST_VEC_I32_CMP_SLT;
+  const uint64_t in_len = (uint64_t)n * 4u;
+  const uint64_t out_len = bool_out ? n : in_len;
+
+  const sir_value_t dv = vals[dst_id];
+  if (dv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+  if (!bool_out && (dv.u.ptr & 3u) != 0) return 256;
+
+  if (splat) {
+    const sir_value_t av = vals[a_id];
+    uint8_t* w = NULL;
+    if (inst->k == SIR_INST_VEC_SPLAT_I32) {
+      if (av.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      if (!sem_guest_mem_map_rw(x->mem, dv.u.ptr, (zi_size32_t)out_len, &w) || !w) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, x->m, fid, ip, SIR_MEM_WRITE, dv.u.ptr, (uint32_t)out_len);
+      for (uint32_t li = 0; li < n; li++) memcpy(w + li * 4u, &av.u.i32, 4);
+    } else {
+      if (av.kind != SIR_VAL_BOOL) return ZI_E_INVALID;
+      if (!sem_guest_mem_map_rw(x->mem, dv.u.ptr, (zi_size32_t)out_len, &w) || !w) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, x->m, fid, ip, SIR_MEM_WRITE, dv.u.ptr, (uint32_t)out_len);
+      memset(w, av.u.b ? 1 : 0, n);
+    }
+    return 0;
+  }
+
+  if (b_id >= val_count || (select && m_id >= val_count)) return ZI_E_BOUNDS;
+  const sir_value_t av = vals[a_id];
+  const sir_value_t bv = vals[b_id];
+  const sir_value_t mv = select ? vals[m_id] : (sir_value_t){.kind = SIR_VAL_PTR};
+  if (av.kind != SIR_VAL_PTR || bv.kind != SIR_VAL_PTR || mv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+  if ((av.u.ptr & 3u) != 0 || (bv.u.ptr & 3u) != 0) return 256;
+  if (vec_overlap_bad(dv.u.ptr, av.u.ptr, out_len, in_len) || vec_overlap_bad(dv.u.ptr, bv.u.ptr, out_len, in_len)) return 256;
+  if (select && vec_overlap_bad(dv.u.ptr, mv.u.ptr, out_len, n)) return 256;
+
+  const uint8_t* ra = NULL;
+  const uint8_t* rb = NULL;
+  const uint8_t* rm = NULL;
+  uint8_t* w = NULL;
+  if (select && (!sem_guest_mem_map_ro(x->mem, mv.u.ptr, (zi_size32_t)n, &rm) || !rm)) return ZI_E_BOUNDS;
+  if (!sem_guest_mem_map_ro(x->mem, av.u.ptr, (zi_size32_t)in_len, &ra) || !ra) return ZI_E_BOUNDS;
+  if (!sem_guest_mem_map_ro(x->mem, bv.u.ptr, (zi_size32_t)in_len, &rb) || !rb) return ZI_E_BOUNDS;
+  if (!sem_guest_mem_map_rw(x->mem, dv.u.ptr, (zi_size32_t)out_len, &w) || !w) return ZI_E_BOUNDS;
+  if (sink && sink->on_mem) {
+    if (select) sink->on_mem(sink->user, x->m, fid, ip, SIR_MEM_READ, mv.u.ptr, n);
+    sink->on_mem(sink->user, x->m, fid, ip, SIR_MEM_READ, av.u.ptr, (uint32_t)in_len);
+    sink->on_mem(sink->user, x->m, fid, ip, SIR_MEM_READ, bv.u.ptr, (uint32_t)in_len);
+    sink->on_mem(sink->user, x->m, fid, ip, SIR_MEM_WRITE, dv.u.ptr, (uint32_t)out_len);
+  }
+  switch (inst->k) {
+    case SIR_INST_VEC_I32_ADD:
+      vec_i32_add(w, ra, rb, n);
+      break;
+    case SIR_INST_VEC_I32_CMP_EQ:
+      vec_i32_cmp(w, ra, rb, n, false);
+      break;
+    case SIR_INST_VEC_I32_CMP_SLT:
+      vec_i32_cmp(w, ra, rb, n, true);
+      break;
+    default:
+      vec_select_i32(w, rm, ra, rb, n);
+      break;
+  }
+  return 0;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIR_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define SIR_ALWAYS_INLINE inline
+#endif
+
+// Executes the instruction at *io_ip with full operand checking. On return
+// either *out_done is false and *io_ip names the next instruction, or
+// *out_done is true and the result is the function's outcome: 0 for RET,
+// >0 for exit/trap requests (code+1), <0 for ZI_E_* errors.
+// `sink` is x->sink or a literal NULL; instances with NULL compile without
+// any event hooks.
+static SIR_ALWAYS_INLINE int32_t exec_inst_impl(const sir_exec_t* x, const sir_exec_event_sink_t* sink, sir_func_id_t fid,
+                                                const sir_func_t* f, sir_value_t* vals, sir_value_t* out_results,
+                                                uint32_t out_result_count, uint32_t depth, uint32_t* io_ip, bool* out_done) {
+  const sir_module_t* m = x->m;
+  sem_guest_mem_t* mem = x->mem;
+  const sir_host_t host = x->host;
+  const zi_ptr_t* globals = x->globals;
+  const uint32_t global_count = x->global_count;
+  uint32_t ip = *io_ip;
+  const sir_inst_t* i = &f->insts[ip];
+  *out_done = true;
+  switch (i->k) {
+    case SIR_INST_CONST_I1:
+      if (i->u.const_i1.dst >= f->value_count) return ZI_E_BOUNDS;
+      if (i->u.const_i1.v > 1) return ZI_E_INVALID;
+      vals[i->u.const_i1.dst] = (sir_value_t){.kind = SIR_VAL_I1, .u.u1 = i->u.const_i1.v};
+      ip++;
+      break;
+    case SIR_INST_CONST_I8:
+      if (i->u.const_i8.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_i8.dst] = (sir_value_t){.kind = SIR_VAL_I8, .u.u8 = i->u.const_i8.v};
+      ip++;
+      break;
+    case SIR_INST_CONST_I16:
+      if (i->u.const_i16.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_i16.dst] = (sir_value_t){.kind = SIR_VAL_I16, .u.u16 = i->u.const_i16.v};
+      ip++;
+      break;
+    case SIR_INST_CONST_I32:
+      if (i->u.const_i32.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_i32.dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = i->u.const_i32.v};
+      ip++;
+      break;
+    case SIR_INST_CONST_I64:
+      if (i->u.const_i64.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_i64.dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = i->u.const_i64.v};
+      ip++;
+      break;
+    case SIR_INST_CONST_BOOL:
+      if (i->u.const_bool.dst >= f->value_count) return ZI_E_BOUNDS;
+      if (i->u.const_bool.v > 1) return ZI_E_INVALID;
+      vals[i->u.const_bool.dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = i->u.const_bool.v};
+      ip++;
+      break;
+    case SIR_INST_CONST_F32:
+      if (i->u.const_f32.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_f32.dst] = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_canon_bits(i->u.const_f32.bits)};
+      ip++;
+      break;
+    case SIR_INST_CONST_F64:
+      if (i->u.const_f64.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_f64.dst] = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_canon_bits(i->u.const_f64.bits)};
+      ip++;
+      break;
+    case SIR_INST_CONST_PTR:
+      if (i->u.const_ptr.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_ptr.dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = i->u.const_ptr.v};
+      ip++;
+      break;
+    case SIR_INST_CONST_PTR_NULL:
+      if (i->u.const_null.dst >= f->value_count) return ZI_E_BOUNDS;
+      vals[i->u.const_null.dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = 0};
+      ip++;
+      break;
+    case SIR_INST_CONST_BYTES: {
+      if (!host.v.zi_alloc) return ZI_E_NOSYS;
+      if (i->u.const_bytes.dst_ptr >= f->value_count || i->u.const_bytes.dst_len >= f->value_count) return ZI_E_BOUNDS;
+      const zi_ptr_t p = host.v.zi_alloc(host.user, (zi_size32_t)i->u.const_bytes.len);
+      if (!p && i->u.const_bytes.len) return ZI_E_OOM;
+      if (i->u.const_bytes.len) {
+        uint8_t* w = NULL;
+        if (!sem_guest_mem_map_rw(mem, p, (zi_size32_t)i->u.const_bytes.len, &w) || !w) return ZI_E_BOUNDS;
+        memcpy(w, i->u.const_bytes.bytes, i->u.const_bytes.len);
       }
-      const sir_type_id_t tid = f->sig.params ? f->sig.params[i] : 0;
-      if (tid == 0 || tid > m->type_count) {
-        free(vals);
-        return ZI_E_INVALID;
+      vals[i->u.const_bytes.dst_ptr] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = p};
+      vals[i->u.const_bytes.dst_len] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)i->u.const_bytes.len};
+      ip++;
+      break;
+    }
+    case SIR_INST_I32_ADD: {
+      const sir_val_id_t a = i->u.i32_add.a;
+      const sir_val_id_t b = i->u.i32_add.b;
+      const sir_val_id_t dst = i->u.i32_add.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(av.u.i32 + bv.u.i32)};
+      ip++;
+      break;
+    }
+    case SIR_INST_I32_SUB:
+    case SIR_INST_I32_MUL:
+    case SIR_INST_I32_AND:
+    case SIR_INST_I32_OR:
+    case SIR_INST_I32_XOR:
+    case SIR_INST_I32_NOT:
+    case SIR_INST_I32_NEG:
+    case SIR_INST_I32_SHL:
+    case SIR_INST_I32_SHR_S:
+    case SIR_INST_I32_SHR_U:
+    case SIR_INST_I32_DIV_S_SAT:
+    case SIR_INST_I32_DIV_S_TRAP:
+    case SIR_INST_I32_DIV_U_SAT:
+    case SIR_INST_I32_REM_S_SAT:
+    case SIR_INST_I32_REM_U_SAT: {
+      sir_val_id_t dst = 0;
+      int32_t x = 0;
+      int32_t y = 0;
+      if (i->k == SIR_INST_I32_NOT || i->k == SIR_INST_I32_NEG) {
+        const sir_val_id_t xv = i->u.i32_un.x;
+        dst = i->u.i32_un.dst;
+        if (xv >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+        const sir_value_t av = vals[xv];
+        if (av.kind != SIR_VAL_I32) return ZI_E_INVALID;
+        x = av.u.i32;
+        y = 0;
+      } else {
+        const sir_val_id_t a = i->u.i32_add.a;
+        const sir_val_id_t b = i->u.i32_add.b;
+        dst = i->u.i32_add.dst;
+        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+        const sir_value_t av = vals[a];
+        const sir_value_t bv = vals[b];
+        if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+        x = av.u.i32;
+        y = bv.u.i32;
       }
-      const sir_prim_type_t prim = m->types[tid - 1].prim;
-      switch (prim) {
-        case SIR_PRIM_VOID:
-          free(vals);
-          return ZI_E_INVALID;
-        case SIR_PRIM_I1:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_I1, .u.u1 = 0};
+      int32_t r = 0;
+      switch (i->k) {
+        case SIR_INST_I32_SUB:
+          r = (int32_t)(x - y);
+          break;
+        case SIR_INST_I32_MUL:
+          r = (int32_t)((int64_t)x * (int64_t)y);
+          break;
+        case SIR_INST_I32_AND:
+          r = (int32_t)((uint32_t)x & (uint32_t)y);
           break;
-        case SIR_PRIM_I8:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_I8, .u.u8 = 0};
+        case SIR_INST_I32_OR:
+          r = (int32_t)((uint32_t)x | (uint32_t)y);
+          break;
+        case SIR_INST_I32_XOR:
+          r = (int32_t)((uint32_t)x ^ (uint32_t)y);
+          break;
+        case SIR_INST_I32_NOT:
+          r = (int32_t)(~(uint32_t)x);
+          break;
+        case SIR_INST_I32_NEG:
+          r = (int32_t)(0 - x);
+          break;
+        case SIR_INST_I32_SHL: {
+          const uint32_t sh = ((uint32_t)y) & 31u;
+          r = (int32_t)((uint32_t)x << sh);
           break;
-        case SIR_PRIM_I16:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_I16, .u.u16 = 0};
+        }
+        case SIR_INST_I32_SHR_S: {
+          const uint32_t sh = ((uint32_t)y) & 31u;
+          r = (int32_t)(x >> sh);
           break;
-        case SIR_PRIM_I32:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = 0};
+        }
+        case SIR_INST_I32_SHR_U: {
+          const uint32_t sh = ((uint32_t)y) & 31u;
+          r = (int32_t)((uint32_t)x >> sh);
           break;
-        case SIR_PRIM_I64:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = 0};
+        }
+        case SIR_INST_I32_DIV_S_SAT:
+          if (y == 0) r = 0;
+          else if (x == INT32_MIN && y == -1) r = INT32_MIN;
+          else r = (int32_t)(x / y);
           break;
-        case SIR_PRIM_PTR:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = 0};
+        case SIR_INST_I32_DIV_S_TRAP:
+          if (y == 0 || (x == INT32_MIN && y == -1)) return 255 + 1;
+          r = (int32_t)(x / y);
           break;
-        case SIR_PRIM_BOOL:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = 0};
+        case SIR_INST_I32_DIV_U_SAT:
+          if (y == 0) r = 0;
+          else r = (int32_t)((uint32_t)x / (uint32_t)y);
           break;
-        case SIR_PRIM_F32:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = 0};
+        case SIR_INST_I32_REM_S_SAT:
+          if (y == 0) r = 0;
+          else if (x == INT32_MIN && y == -1) r = 0;
+          else r = (int32_t)(x % y);
           break;
-        case SIR_PRIM_F64:
-          vals[i] = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = 0};
+        case SIR_INST_I32_REM_U_SAT:
+          if (y == 0) r = 0;
+          else r = (int32_t)((uint32_t)x % (uint32_t)y);
           break;
         default:
-          free(vals);
-          return ZI_E_INVALID;
+          return ZI_E_INTERNAL;
       }
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = r};
+      ip++;
+      break;
     }
-  } else {
-    for (uint32_t i = 0; i < arg_count; i++) {
-      if (i >= f->value_count) {
-        free(vals);
-        return ZI_E_BOUNDS;
+    case SIR_INST_I32_CMP_EQ: {
+      const sir_val_id_t a = i->u.i32_cmp_eq.a;
+      const sir_val_id_t b = i->u.i32_cmp_eq.b;
+      const sir_val_id_t dst = i->u.i32_cmp_eq.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(av.u.i32 == bv.u.i32)};
+      ip++;
+      break;
+    }
+    case SIR_INST_I32_CMP_NE:
+    case SIR_INST_I32_CMP_SLT:
+    case SIR_INST_I32_CMP_SLE:
+    case SIR_INST_I32_CMP_SGT:
+    case SIR_INST_I32_CMP_SGE:
+    case SIR_INST_I32_CMP_ULT:
+    case SIR_INST_I32_CMP_ULE:
+    case SIR_INST_I32_CMP_UGT:
+    case SIR_INST_I32_CMP_UGE: {
+      const sir_val_id_t a = i->u.i32_cmp_eq.a;
+      const sir_val_id_t b = i->u.i32_cmp_eq.b;
+      const sir_val_id_t dst = i->u.i32_cmp_eq.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const int32_t x = av.u.i32;
+      const int32_t y = bv.u.i32;
+      bool r = false;
+      switch (i->k) {
+        case SIR_INST_I32_CMP_NE:
+          r = (x != y);
+          break;
+        case SIR_INST_I32_CMP_SLT:
+          r = (x < y);
+          break;
+        case SIR_INST_I32_CMP_SLE:
+          r = (x <= y);
+          break;
+        case SIR_INST_I32_CMP_SGT:
+          r = (x > y);
+          break;
+        case SIR_INST_I32_CMP_SGE:
+          r = (x >= y);
+          break;
+        case SIR_INST_I32_CMP_ULT:
+          r = ((uint32_t)x < (uint32_t)y);
+          break;
+        case SIR_INST_I32_CMP_ULE:
+          r = ((uint32_t)x <= (uint32_t)y);
+          break;
+        case SIR_INST_I32_CMP_UGT:
+          r = ((uint32_t)x > (uint32_t)y);
+          break;
+        case SIR_INST_I32_CMP_UGE:
+          r = ((uint32_t)x >= (uint32_t)y);
+          break;
+        default:
+          return ZI_E_INTERNAL;
       }
-      vals[i] = args[i];
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
+      ip++;
+      break;
     }
-  }
-
-  for (uint32_t ip = 0; ip < f->inst_count;) {
-    const sir_inst_t* i = &f->insts[ip];
-    if (sink && sink->on_step) sink->on_step(sink->user, m, fid, ip, i->k);
-    switch (i->k) {
-      case SIR_INST_CONST_I1:
-        if (i->u.const_i1.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (i->u.const_i1.v > 1) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[i->u.const_i1.dst] = (sir_value_t){.kind = SIR_VAL_I1, .u.u1 = i->u.const_i1.v};
-        ip++;
-        break;
-      case SIR_INST_CONST_I8:
-        if (i->u.const_i8.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_i8.dst] = (sir_value_t){.kind = SIR_VAL_I8, .u.u8 = i->u.const_i8.v};
-        ip++;
-        break;
-      case SIR_INST_CONST_I16:
-        if (i->u.const_i16.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_i16.dst] = (sir_value_t){.kind = SIR_VAL_I16, .u.u16 = i->u.const_i16.v};
-        ip++;
-        break;
-      case SIR_INST_CONST_I32:
-        if (i->u.const_i32.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_i32.dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = i->u.const_i32.v};
-        ip++;
-        break;
-      case SIR_INST_CONST_I64:
-        if (i->u.const_i64.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_i64.dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = i->u.const_i64.v};
-        ip++;
-        break;
-      case SIR_INST_CONST_BOOL:
-        if (i->u.const_bool.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (i->u.const_bool.v > 1) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[i->u.const_bool.dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = i->u.const_bool.v};
-        ip++;
-        break;
-      case SIR_INST_CONST_F32:
-        if (i->u.const_f32.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_f32.dst] = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_canon_bits(i->u.const_f32.bits)};
-        ip++;
-        break;
-      case SIR_INST_CONST_F64:
-        if (i->u.const_f64.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_f64.dst] = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_canon_bits(i->u.const_f64.bits)};
-        ip++;
-        break;
-      case SIR_INST_CONST_PTR:
-        if (i->u.const_ptr.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_ptr.dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = i->u.const_ptr.v};
-        ip++;
-        break;
-      case SIR_INST_CONST_PTR_NULL:
-        if (i->u.const_null.dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        vals[i->u.const_null.dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = 0};
-        ip++;
-        break;
-      case SIR_INST_CONST_BYTES: {
-        if (!host.v.zi_alloc) {
-          free(vals);
-          return ZI_E_NOSYS;
-        }
-        if (i->u.const_bytes.dst_ptr >= f->value_count || i->u.const_bytes.dst_len >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const zi_ptr_t p = host.v.zi_alloc(host.user, (zi_size32_t)i->u.const_bytes.len);
-        if (!p && i->u.const_bytes.len) {
-          free(vals);
-          return ZI_E_OOM;
-        }
-        if (i->u.const_bytes.len) {
-          uint8_t* w = NULL;
-          if (!sem_guest_mem_map_rw(mem, p, (zi_size32_t)i->u.const_bytes.len, &w) || !w) {
-            free(vals);
-            return ZI_E_BOUNDS;
-          }
-          memcpy(w, i->u.const_bytes.bytes, i->u.const_bytes.len);
-        }
-        vals[i->u.const_bytes.dst_ptr] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = p};
-        vals[i->u.const_bytes.dst_len] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)i->u.const_bytes.len};
-        ip++;
-        break;
+    case SIR_INST_I64_ADD:
+    case SIR_INST_I64_SUB:
+    case SIR_INST_I64_MUL:
+    case SIR_INST_I64_AND:
+    case SIR_INST_I64_OR:
+    case SIR_INST_I64_XOR:
+    case SIR_INST_I64_SHL:
+    case SIR_INST_I64_SHR_S:
+    case SIR_INST_I64_SHR_U:
+    case SIR_INST_I64_DIV_S_SAT:
+    case SIR_INST_I64_DIV_S_TRAP:
+    case SIR_INST_I64_DIV_U_SAT:
+    case SIR_INST_I64_REM_S_SAT:
+    case SIR_INST_I64_REM_U_SAT: {
+      const sir_val_id_t a = i->u.i64_bin.a;
+      const sir_val_id_t b = i->u.i64_bin.b;
+      const sir_val_id_t dst = i->u.i64_bin.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_I64 || bv.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      bool trap = false;
+      const int64_t r = num_i64_bin(i->k, av.u.i64, bv.u.i64, &trap);
+      if (trap) return 255 + 1;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = r};
+      ip++;
+      break;
+    }
+    case SIR_INST_I64_CMP_EQ:
+    case SIR_INST_I64_CMP_NE:
+    case SIR_INST_I64_CMP_SLT:
+    case SIR_INST_I64_CMP_SLE:
+    case SIR_INST_I64_CMP_SGT:
+    case SIR_INST_I64_CMP_SGE:
+    case SIR_INST_I64_CMP_ULT:
+    case SIR_INST_I64_CMP_ULE:
+    case SIR_INST_I64_CMP_UGT:
+    case SIR_INST_I64_CMP_UGE: {
+      const sir_val_id_t a = i->u.i64_bin.a;
+      const sir_val_id_t b = i->u.i64_bin.b;
+      const sir_val_id_t dst = i->u.i64_bin.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_I64 || bv.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      const bool r = num_i64_cmp(i->k, av.u.i64, bv.u.i64);
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
+      ip++;
+      break;
+    }
+    case SIR_INST_F32_ADD:
+    case SIR_INST_F32_SUB:
+    case SIR_INST_F32_MUL:
+    case SIR_INST_F32_DIV: {
+      const sir_val_id_t a = i->u.f_bin.a;
+      const sir_val_id_t b = i->u.f_bin.b;
+      const sir_val_id_t dst = i->u.f_bin.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_F32 || bv.kind != SIR_VAL_F32) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = num_f32_bin(i->k, av.u.f32_bits, bv.u.f32_bits)};
+      ip++;
+      break;
+    }
+    case SIR_INST_F64_ADD:
+    case SIR_INST_F64_SUB:
+    case SIR_INST_F64_MUL:
+    case SIR_INST_F64_DIV: {
+      const sir_val_id_t a = i->u.f_bin.a;
+      const sir_val_id_t b = i->u.f_bin.b;
+      const sir_val_id_t dst = i->u.f_bin.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_F64 || bv.kind != SIR_VAL_F64) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = num_f64_bin(i->k, av.u.f64_bits, bv.u.f64_bits)};
+      ip++;
+      break;
+    }
+    case SIR_INST_F32_CMP_OEQ:
+    case SIR_INST_F32_CMP_ONE:
+    case SIR_INST_F32_CMP_OLT:
+    case SIR_INST_F32_CMP_OLE:
+    case SIR_INST_F32_CMP_OGT:
+    case SIR_INST_F32_CMP_OGE:
+    case SIR_INST_F32_CMP_UEQ:
+    case SIR_INST_F32_CMP_UNE:
+    case SIR_INST_F32_CMP_ULT:
+    case SIR_INST_F32_CMP_ULE:
+    case SIR_INST_F32_CMP_UGT:
+    case SIR_INST_F32_CMP_UGE:
+    case SIR_INST_F64_CMP_OEQ:
+    case SIR_INST_F64_CMP_ONE:
+    case SIR_INST_F64_CMP_OLT:
+    case SIR_INST_F64_CMP_OLE:
+    case SIR_INST_F64_CMP_OGT:
+    case SIR_INST_F64_CMP_OGE:
+    case SIR_INST_F64_CMP_UEQ:
+    case SIR_INST_F64_CMP_UNE:
+    case SIR_INST_F64_CMP_ULT:
+    case SIR_INST_F64_CMP_ULE:
+    case SIR_INST_F64_CMP_UGT:
+    case SIR_INST_F64_CMP_UGE: {
+      const sir_val_id_t a = i->u.f_cmp.a;
+      const sir_val_id_t b = i->u.f_cmp.b;
+      const sir_val_id_t dst = i->u.f_cmp.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      bool r = false;
+      if (num_is_f32_cmp(i->k)) {
+        if (av.kind != SIR_VAL_F32 || bv.kind != SIR_VAL_F32) return ZI_E_INVALID;
+        r = num_f_cmp(i->k, (double)f32_from_bits(av.u.f32_bits), (double)f32_from_bits(bv.u.f32_bits));
+      } else {
+        if (av.kind != SIR_VAL_F64 || bv.kind != SIR_VAL_F64) return ZI_E_INVALID;
+        r = num_f_cmp(i->k, f64_from_bits(av.u.f64_bits), f64_from_bits(bv.u.f64_bits));
       }
-      case SIR_INST_I32_ADD: {
-        const sir_val_id_t a = i->u.i32_add.a;
-        const sir_val_id_t b = i->u.i32_add.b;
-        const sir_val_id_t dst = i->u.i32_add.dst;
-        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t bv = vals[b];
-        if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(av.u.i32 + bv.u.i32)};
-        ip++;
-        break;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
+      ip++;
+      break;
+    }
+    case SIR_INST_I64_NOT:
+    case SIR_INST_I64_NEG:
+    case SIR_INST_F32_NEG:
+    case SIR_INST_F64_NEG:
+    case SIR_INST_I64_SEXT_I32:
+    case SIR_INST_F32_FROM_I32_S:
+    case SIR_INST_F32_FROM_I32_U:
+    case SIR_INST_F32_FROM_I64_S:
+    case SIR_INST_F32_FROM_I64_U:
+    case SIR_INST_F64_FROM_I32_S:
+    case SIR_INST_F64_FROM_I32_U:
+    case SIR_INST_F64_FROM_I64_S:
+    case SIR_INST_F64_FROM_I64_U:
+    case SIR_INST_I32_TRUNC_SAT_F32_S:
+    case SIR_INST_I32_TRUNC_SAT_F32_U:
+    case SIR_INST_I32_TRUNC_SAT_F64_S:
+    case SIR_INST_I32_TRUNC_SAT_F64_U:
+    case SIR_INST_I64_TRUNC_SAT_F32_S:
+    case SIR_INST_I64_TRUNC_SAT_F32_U:
+    case SIR_INST_I64_TRUNC_SAT_F64_S:
+    case SIR_INST_I64_TRUNC_SAT_F64_U:
+    case SIR_INST_F64_PROMOTE_F32:
+    case SIR_INST_F32_DEMOTE_F64: {
+      const sir_val_id_t xs = i->u.num_un.x;
+      const sir_val_id_t dst = i->u.num_un.dst;
+      if (xs >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      if (!num_un_eval(i->k, vals[xs], &vals[dst])) return ZI_E_INVALID;
+      ip++;
+      break;
+    }
+    case SIR_INST_GLOBAL_ADDR: {
+      const sir_global_id_t gid = i->u.global_addr.gid;
+      const sir_val_id_t dst = i->u.global_addr.dst;
+      if (dst >= f->value_count) return ZI_E_BOUNDS;
+      if (!globals || gid == 0 || gid > global_count) return ZI_E_NOENT;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = globals[gid - 1]};
+      ip++;
+      break;
+    }
+    case SIR_INST_PTR_OFFSET: {
+      const sir_val_id_t base_id = i->u.ptr_offset.base;
+      const sir_val_id_t index_id = i->u.ptr_offset.index;
+      const sir_val_id_t dst = i->u.ptr_offset.dst;
+      if (base_id >= f->value_count || index_id >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t bv = vals[base_id];
+      const sir_value_t iv = vals[index_id];
+      if (bv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      int64_t idx = 0;
+      if (iv.kind == SIR_VAL_I64) idx = iv.u.i64;
+      else if (iv.kind == SIR_VAL_I32) idx = iv.u.i32;
+      else {
+        return ZI_E_INVALID;
       }
-      case SIR_INST_I32_SUB:
-      case SIR_INST_I32_MUL:
-      case SIR_INST_I32_AND:
-      case SIR_INST_I32_OR:
-      case SIR_INST_I32_XOR:
-      case SIR_INST_I32_NOT:
-      case SIR_INST_I32_NEG:
-      case SIR_INST_I32_SHL:
-      case SIR_INST_I32_SHR_S:
-      case SIR_INST_I32_SHR_U:
-      case SIR_INST_I32_DIV_S_SAT:
-      case SIR_INST_I32_DIV_S_TRAP:
-      case SIR_INST_I32_DIV_U_SAT:
-      case SIR_INST_I32_REM_S_SAT:
-      case SIR_INST_I32_REM_U_SAT: {
-        sir_val_id_t dst = 0;
-        int32_t x = 0;
-        int32_t y = 0;
-        if (i->k == SIR_INST_I32_NOT || i->k == SIR_INST_I32_NEG) {
-          const sir_val_id_t xv = i->u.i32_un.x;
-          dst = i->u.i32_un.dst;
-          if (xv >= f->value_count || dst >= f->value_count) {
-            free(vals);
+      const uint64_t base = (uint64_t)bv.u.ptr;
+      const uint64_t off = (uint64_t)idx * (uint64_t)i->u.ptr_offset.scale;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)(base + off)};
+      ip++;
+      break;
+    }
+    case SIR_INST_PTR_ADD: {
+      const sir_val_id_t base_id = i->u.ptr_add.base;
+      const sir_val_id_t off_id = i->u.ptr_add.off;
+      const sir_val_id_t dst = i->u.ptr_add.dst;
+      if (base_id >= f->value_count || off_id >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t bv = vals[base_id];
+      const sir_value_t ov = vals[off_id];
+      if (bv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      int64_t off = 0;
+      if (ov.kind == SIR_VAL_I64) off = ov.u.i64;
+      else if (ov.kind == SIR_VAL_I32) off = ov.u.i32;
+      else {
+        return ZI_E_INVALID;
+      }
+      const uint64_t base = (uint64_t)bv.u.ptr;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)(base + (uint64_t)off)};
+      ip++;
+      break;
+    }
+    case SIR_INST_PTR_SUB: {
+      const sir_val_id_t base_id = i->u.ptr_sub.base;
+      const sir_val_id_t off_id = i->u.ptr_sub.off;
+      const sir_val_id_t dst = i->u.ptr_sub.dst;
+      if (base_id >= f->value_count || off_id >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t bv = vals[base_id];
+      const sir_value_t ov = vals[off_id];
+      if (bv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      int64_t off = 0;
+      if (ov.kind == SIR_VAL_I64) off = ov.u.i64;
+      else if (ov.kind == SIR_VAL_I32) off = ov.u.i32;
+      else {
+        return ZI_E_INVALID;
+      }
+      const uint64_t base = (uint64_t)bv.u.ptr;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)(base - (uint64_t)off)};
+      ip++;
+      break;
+    }
+    case SIR_INST_PTR_CMP_EQ:
+    case SIR_INST_PTR_CMP_NE: {
+      const sir_val_id_t a = i->u.ptr_cmp.a;
+      const sir_val_id_t b = i->u.ptr_cmp.b;
+      const sir_val_id_t dst = i->u.ptr_cmp.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_PTR || bv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      const bool eq = (av.u.ptr == bv.u.ptr);
+      const uint8_t r = (i->k == SIR_INST_PTR_CMP_EQ) ? (uint8_t)eq : (uint8_t)(!eq);
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = r};
+      ip++;
+      break;
+    }
+    case SIR_INST_PTR_TO_I64: {
+      const sir_val_id_t x = i->u.ptr_to_i64.x;
+      const sir_val_id_t dst = i->u.ptr_to_i64.dst;
+      if (x >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t xv = vals[x];
+      if (xv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)(uint64_t)xv.u.ptr};
+      ip++;
+      break;
+    }
+    case SIR_INST_PTR_FROM_I64: {
+      const sir_val_id_t x = i->u.ptr_from_i64.x;
+      const sir_val_id_t dst = i->u.ptr_from_i64.dst;
+      if (x >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t xv = vals[x];
+      uint64_t bits = 0;
+      if (xv.kind == SIR_VAL_I64) bits = (uint64_t)xv.u.i64;
+      else if (xv.kind == SIR_VAL_I32) bits = (uint64_t)(uint32_t)xv.u.i32;
+      else {
+        return ZI_E_INVALID;
+      }
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)bits};
+      ip++;
+      break;
+    }
+    case SIR_INST_BOOL_NOT: {
+      const sir_val_id_t x = i->u.bool_not.x;
+      const sir_val_id_t dst = i->u.bool_not.dst;
+      if (x >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t xv = vals[x];
+      if (xv.kind != SIR_VAL_BOOL) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(xv.u.b ? 0 : 1)};
+      ip++;
+      break;
+    }
+    case SIR_INST_BOOL_AND:
+    case SIR_INST_BOOL_OR:
+    case SIR_INST_BOOL_XOR: {
+      const sir_val_id_t a = i->u.bool_bin.a;
+      const sir_val_id_t b = i->u.bool_bin.b;
+      const sir_val_id_t dst = i->u.bool_bin.dst;
+      if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t bv = vals[b];
+      if (av.kind != SIR_VAL_BOOL || bv.kind != SIR_VAL_BOOL) return ZI_E_INVALID;
+      const uint8_t ax = (uint8_t)(av.u.b ? 1 : 0);
+      const uint8_t bx = (uint8_t)(bv.u.b ? 1 : 0);
+      uint8_t r = 0;
+      if (i->k == SIR_INST_BOOL_AND) r = (uint8_t)(ax & bx);
+      else if (i->k == SIR_INST_BOOL_OR) r = (uint8_t)(ax | bx);
+      else r = (uint8_t)(ax ^ bx);
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = r};
+      ip++;
+      break;
+    }
+    case SIR_INST_I32_TRUNC_I64: {
+      const sir_val_id_t x = i->u.i32_trunc_i64.x;
+      const sir_val_id_t dst = i->u.i32_trunc_i64.dst;
+      if (x >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t xv = vals[x];
+      if (xv.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(uint32_t)xv.u.i64};
+      ip++;
+      break;
+    }
+    case SIR_INST_I32_ZEXT_I8: {
+      const sir_val_id_t x = i->u.i32_zext_i8.x;
+      const sir_val_id_t dst = i->u.i32_zext_i8.dst;
+      if (x >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t xv = vals[x];
+      if (xv.kind != SIR_VAL_I8) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(uint32_t)xv.u.u8};
+      ip++;
+      break;
+    }
+    case SIR_INST_I32_ZEXT_I16: {
+      const sir_val_id_t x = i->u.i32_zext_i16.x;
+      const sir_val_id_t dst = i->u.i32_zext_i16.dst;
+      if (x >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t xv = vals[x];
+      if (xv.kind != SIR_VAL_I16) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(uint32_t)xv.u.u16};
+      ip++;
+      break;
+    }
+    case SIR_INST_I64_ZEXT_I32: {
+      const sir_val_id_t x = i->u.i64_zext_i32.x;
+      const sir_val_id_t dst = i->u.i64_zext_i32.dst;
+      if (x >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t xv = vals[x];
+      if (xv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)(uint64_t)(uint32_t)xv.u.i32};
+      ip++;
+      break;
+    }
+    case SIR_INST_SELECT: {
+      const sir_val_id_t cond = i->u.select.cond;
+      const sir_val_id_t a = i->u.select.a;
+      const sir_val_id_t b = i->u.select.b;
+      const sir_val_id_t dst = i->u.select.dst;
+      if (cond >= f->value_count || a >= f->value_count || b >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t cv = vals[cond];
+      if (cv.kind != SIR_VAL_BOOL) return ZI_E_INVALID;
+      vals[dst] = cv.u.b ? vals[a] : vals[b];
+      ip++;
+      break;
+    }
+    case SIR_INST_BR:
+      if (i->u.br.arg_count) {
+        const uint32_t n = i->u.br.arg_count;
+        const sir_val_id_t* src = i->u.br.src_slots;
+        const sir_val_id_t* dst = i->u.br.dst_slots;
+        if (!src || !dst) return ZI_E_INVALID;
+
+        sir_value_t tmp_small[16];
+        sir_value_t* tmp = tmp_small;
+        if (n > (uint32_t)(sizeof(tmp_small) / sizeof(tmp_small[0]))) {
+          tmp = (sir_value_t*)malloc((size_t)n * sizeof(*tmp));
+          if (!tmp) return ZI_E_OOM;
+        }
+
+        for (uint32_t ai = 0; ai < n; ai++) {
+          const sir_val_id_t s = src[ai];
+          if (s >= f->value_count) {
+            if (tmp != tmp_small) free(tmp);
             return ZI_E_BOUNDS;
           }
-          const sir_value_t av = vals[xv];
-          if (av.kind != SIR_VAL_I32) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          x = av.u.i32;
-          y = 0;
-        } else {
-          const sir_val_id_t a = i->u.i32_add.a;
-          const sir_val_id_t b = i->u.i32_add.b;
-          dst = i->u.i32_add.dst;
-          if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-            free(vals);
+          tmp[ai] = vals[s];
+        }
+        for (uint32_t ai = 0; ai < n; ai++) {
+          const sir_val_id_t d = dst[ai];
+          if (d >= f->value_count) {
+            if (tmp != tmp_small) free(tmp);
             return ZI_E_BOUNDS;
           }
-          const sir_value_t av = vals[a];
-          const sir_value_t bv = vals[b];
-          if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          x = av.u.i32;
-          y = bv.u.i32;
-        }
-        int32_t r = 0;
-        switch (i->k) {
-          case SIR_INST_I32_SUB:
-            r = (int32_t)(x - y);
-            break;
-          case SIR_INST_I32_MUL:
-            r = (int32_t)((int64_t)x * (int64_t)y);
-            break;
-          case SIR_INST_I32_AND:
-            r = (int32_t)((uint32_t)x & (uint32_t)y);
-            break;
-          case SIR_INST_I32_OR:
-            r = (int32_t)((uint32_t)x | (uint32_t)y);
-            break;
-          case SIR_INST_I32_XOR:
-            r = (int32_t)((uint32_t)x ^ (uint32_t)y);
-            break;
-          case SIR_INST_I32_NOT:
-            r = (int32_t)(~(uint32_t)x);
-            break;
-          case SIR_INST_I32_NEG:
-            r = (int32_t)(0 - x);
-            break;
-          case SIR_INST_I32_SHL: {
-            const uint32_t sh = ((uint32_t)y) & 31u;
-            r = (int32_t)((uint32_t)x << sh);
-            break;
-          }
-          case SIR_INST_I32_SHR_S: {
-            const uint32_t sh = ((uint32_t)y) & 31u;
-            r = (int32_t)(x >> sh);
-            break;
-          }
-          case SIR_INST_I32_SHR_U: {
-            const uint32_t sh = ((uint32_t)y) & 31u;
-            r = (int32_t)((uint32_t)x >> sh);
-            break;
-          }
-          case SIR_INST_I32_DIV_S_SAT:
-            if (y == 0) r = 0;
-            else if (x == INT32_MIN && y == -1) r = INT32_MIN;
-            else r = (int32_t)(x / y);
-            break;
-          case SIR_INST_I32_DIV_S_TRAP:
-            if (y == 0 || (x == INT32_MIN && y == -1)) {
-              free(vals);
-              return 255 + 1;
-            }
-            r = (int32_t)(x / y);
-            break;
-          case SIR_INST_I32_DIV_U_SAT:
-            if (y == 0) r = 0;
-            else r = (int32_t)((uint32_t)x / (uint32_t)y);
-            break;
-          case SIR_INST_I32_REM_S_SAT:
-            if (y == 0) r = 0;
-            else if (x == INT32_MIN && y == -1) r = 0;
-            else r = (int32_t)(x % y);
-            break;
-          case SIR_INST_I32_REM_U_SAT:
-            if (y == 0) r = 0;
-            else r = (int32_t)((uint32_t)x % (uint32_t)y);
-            break;
-          default:
-            free(vals);
-            return ZI_E_INTERNAL;
+          vals[d] = tmp[ai];
         }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = r};
-        ip++;
-        break;
+
+        if (tmp != tmp_small) free(tmp);
       }
-      case SIR_INST_I32_CMP_EQ: {
-        const sir_val_id_t a = i->u.i32_cmp_eq.a;
-        const sir_val_id_t b = i->u.i32_cmp_eq.b;
-        const sir_val_id_t dst = i->u.i32_cmp_eq.dst;
-        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t bv = vals[b];
-        if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) {
-          free(vals);
-          return ZI_E_INVALID;
+      ip = i->u.br.target_ip;
+      break;
+    case SIR_INST_CBR: {
+      const sir_val_id_t cvid = i->u.cbr.cond;
+      if (cvid >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t cv = vals[cvid];
+      if (cv.kind != SIR_VAL_BOOL) return ZI_E_INVALID;
+      ip = cv.u.b ? i->u.cbr.then_ip : i->u.cbr.else_ip;
+      break;
+    }
+    case SIR_INST_SWITCH: {
+      const sir_val_id_t sid = i->u.sw.scrut;
+      if (sid >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t sv = vals[sid];
+      if (sv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+      const uint32_t n = i->u.sw.case_count;
+      const int32_t* lits = i->u.sw.case_lits;
+      const uint32_t* tgt = i->u.sw.case_target;
+      if (n && (!lits || !tgt)) return ZI_E_INVALID;
+      uint32_t next_ip = i->u.sw.default_ip;
+      for (uint32_t ci = 0; ci < n; ci++) {
+        if (sv.u.i32 == lits[ci]) {
+          next_ip = tgt[ci];
+          break;
         }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(av.u.i32 == bv.u.i32)};
-        ip++;
-        break;
       }
-      case SIR_INST_I32_CMP_NE:
-      case SIR_INST_I32_CMP_SLT:
-      case SIR_INST_I32_CMP_SLE:
-      case SIR_INST_I32_CMP_SGT:
-      case SIR_INST_I32_CMP_SGE:
-      case SIR_INST_I32_CMP_ULT:
-      case SIR_INST_I32_CMP_ULE:
-      case SIR_INST_I32_CMP_UGT:
-      case SIR_INST_I32_CMP_UGE: {
-        const sir_val_id_t a = i->u.i32_cmp_eq.a;
-        const sir_val_id_t b = i->u.i32_cmp_eq.b;
-        const sir_val_id_t dst = i->u.i32_cmp_eq.dst;
-        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t bv = vals[b];
-        if (av.kind != SIR_VAL_I32 || bv.kind != SIR_VAL_I32) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const int32_t x = av.u.i32;
-        const int32_t y = bv.u.i32;
-        bool r = false;
-        switch (i->k) {
-          case SIR_INST_I32_CMP_NE:
-            r = (x != y);
-            break;
-          case SIR_INST_I32_CMP_SLT:
-            r = (x < y);
-            break;
-          case SIR_INST_I32_CMP_SLE:
-            r = (x <= y);
-            break;
-          case SIR_INST_I32_CMP_SGT:
-            r = (x > y);
-            break;
-          case SIR_INST_I32_CMP_SGE:
-            r = (x >= y);
-            break;
-          case SIR_INST_I32_CMP_ULT:
-            r = ((uint32_t)x < (uint32_t)y);
-            break;
-          case SIR_INST_I32_CMP_ULE:
-            r = ((uint32_t)x <= (uint32_t)y);
-            break;
-          case SIR_INST_I32_CMP_UGT:
-            r = ((uint32_t)x > (uint32_t)y);
-            break;
-          case SIR_INST_I32_CMP_UGE:
-            r = ((uint32_t)x >= (uint32_t)y);
-            break;
-          default:
-            free(vals);
-            return ZI_E_INTERNAL;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
-        ip++;
-        break;
+      ip = next_ip;
+      break;
+    }
+    case SIR_INST_MEM_COPY: {
+      const sir_val_id_t dst_id = i->u.mem_copy.dst;
+      const sir_val_id_t src_id = i->u.mem_copy.src;
+      const sir_val_id_t len_id = i->u.mem_copy.len;
+      if (dst_id >= f->value_count || src_id >= f->value_count || len_id >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t dv = vals[dst_id];
+      const sir_value_t sv = vals[src_id];
+      const sir_value_t lv = vals[len_id];
+      if (dv.kind != SIR_VAL_PTR || sv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      int64_t ll = 0;
+      if (lv.kind == SIR_VAL_I64) ll = lv.u.i64;
+      else if (lv.kind == SIR_VAL_I32) ll = lv.u.i32;
+      else {
+        return ZI_E_INVALID;
       }
-      case SIR_INST_F32_CMP_UEQ: {
-        const sir_val_id_t a = i->u.f_cmp.a;
-        const sir_val_id_t b = i->u.f_cmp.b;
-        const sir_val_id_t dst = i->u.f_cmp.dst;
-        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t bv = vals[b];
-        if (av.kind != SIR_VAL_F32 || bv.kind != SIR_VAL_F32) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const bool nan_a = f32_is_nan_bits(av.u.f32_bits);
-        const bool nan_b = f32_is_nan_bits(bv.u.f32_bits);
-        float af = 0.0f, bf = 0.0f;
-        memcpy(&af, &av.u.f32_bits, 4);
-        memcpy(&bf, &bv.u.f32_bits, 4);
-        const bool r = nan_a || nan_b || (af == bf);
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
+      if (ll < 0 || ll > 0x7FFFFFFFll) return ZI_E_INVALID;
+      const uint32_t n = (uint32_t)ll;
+      if (n == 0) {
         ip++;
         break;
       }
-      case SIR_INST_F64_CMP_OLT: {
-        const sir_val_id_t a = i->u.f_cmp.a;
-        const sir_val_id_t b = i->u.f_cmp.b;
-        const sir_val_id_t dst = i->u.f_cmp.dst;
-        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t bv = vals[b];
-        if (av.kind != SIR_VAL_F64 || bv.kind != SIR_VAL_F64) {
-          free(vals);
-          return ZI_E_INVALID;
+
+      if (!i->u.mem_copy.overlap_allow) {
+        const zi_ptr_t da = dv.u.ptr;
+        const zi_ptr_t sa = sv.u.ptr;
+        const zi_ptr_t da_end = (zi_ptr_t)(da + (zi_ptr_t)n);
+        const zi_ptr_t sa_end = (zi_ptr_t)(sa + (zi_ptr_t)n);
+        const bool overlap = (da < sa_end) && (sa < da_end);
+        if (overlap) {
+          // deterministic trap (align with term.trap in SEM: exit code 255)
+          return 256;
         }
-        const bool nan_a = f64_is_nan_bits(av.u.f64_bits);
-        const bool nan_b = f64_is_nan_bits(bv.u.f64_bits);
-        double ad = 0.0, bd = 0.0;
-        memcpy(&ad, &av.u.f64_bits, 8);
-        memcpy(&bd, &bv.u.f64_bits, 8);
-        const bool r = (!nan_a && !nan_b) && (ad < bd);
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
-        ip++;
-        break;
       }
-      case SIR_INST_GLOBAL_ADDR: {
-        const sir_global_id_t gid = i->u.global_addr.gid;
-        const sir_val_id_t dst = i->u.global_addr.dst;
-        if (dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (!globals || gid == 0 || gid > global_count) {
-          free(vals);
-          return ZI_E_NOENT;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = globals[gid - 1]};
-        ip++;
-        break;
+
+      const uint8_t* r = NULL;
+      uint8_t* w = NULL;
+      if (!sem_guest_mem_map_ro(mem, sv.u.ptr, (zi_size32_t)n, &r) || !r) return ZI_E_BOUNDS;
+      if (!sem_guest_mem_map_rw(mem, dv.u.ptr, (zi_size32_t)n, &w) || !w) return ZI_E_BOUNDS;
+      memmove(w, r, n);
+      ip++;
+      break;
+    }
+    case SIR_INST_MEM_FILL: {
+      const sir_val_id_t dst_id = i->u.mem_fill.dst;
+      const sir_val_id_t byte_id = i->u.mem_fill.byte;
+      const sir_val_id_t len_id = i->u.mem_fill.len;
+      if (dst_id >= f->value_count || byte_id >= f->value_count || len_id >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t dv = vals[dst_id];
+      const sir_value_t bv = vals[byte_id];
+      const sir_value_t lv = vals[len_id];
+      if (dv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      uint8_t byte = 0;
+      if (bv.kind == SIR_VAL_I8) byte = bv.u.u8;
+      else if (bv.kind == SIR_VAL_I32) byte = (uint8_t)bv.u.i32;
+      else {
+        return ZI_E_INVALID;
       }
-      case SIR_INST_PTR_OFFSET: {
-        const sir_val_id_t base_id = i->u.ptr_offset.base;
-        const sir_val_id_t index_id = i->u.ptr_offset.index;
-        const sir_val_id_t dst = i->u.ptr_offset.dst;
-        if (base_id >= f->value_count || index_id >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t bv = vals[base_id];
-        const sir_value_t iv = vals[index_id];
-        if (bv.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        int64_t idx = 0;
-        if (iv.kind == SIR_VAL_I64) idx = iv.u.i64;
-        else if (iv.kind == SIR_VAL_I32) idx = iv.u.i32;
-        else {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint64_t base = (uint64_t)bv.u.ptr;
-        const uint64_t off = (uint64_t)idx * (uint64_t)i->u.ptr_offset.scale;
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)(base + off)};
-        ip++;
-        break;
+      int64_t ll = 0;
+      if (lv.kind == SIR_VAL_I64) ll = lv.u.i64;
+      else if (lv.kind == SIR_VAL_I32) ll = lv.u.i32;
+      else {
+        return ZI_E_INVALID;
       }
-      case SIR_INST_PTR_ADD: {
-        const sir_val_id_t base_id = i->u.ptr_add.base;
-        const sir_val_id_t off_id = i->u.ptr_add.off;
-        const sir_val_id_t dst = i->u.ptr_add.dst;
-        if (base_id >= f->value_count || off_id >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t bv = vals[base_id];
-        const sir_value_t ov = vals[off_id];
-        if (bv.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        int64_t off = 0;
-        if (ov.kind == SIR_VAL_I64) off = ov.u.i64;
-        else if (ov.kind == SIR_VAL_I32) off = ov.u.i32;
-        else {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint64_t base = (uint64_t)bv.u.ptr;
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)(base + (uint64_t)off)};
+      if (ll < 0 || ll > 0x7FFFFFFFll) return ZI_E_INVALID;
+      const uint32_t n = (uint32_t)ll;
+      if (n == 0) {
         ip++;
         break;
       }
-      case SIR_INST_PTR_SUB: {
-        const sir_val_id_t base_id = i->u.ptr_sub.base;
-        const sir_val_id_t off_id = i->u.ptr_sub.off;
-        const sir_val_id_t dst = i->u.ptr_sub.dst;
-        if (base_id >= f->value_count || off_id >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t bv = vals[base_id];
-        const sir_value_t ov = vals[off_id];
-        if (bv.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        int64_t off = 0;
-        if (ov.kind == SIR_VAL_I64) off = ov.u.i64;
-        else if (ov.kind == SIR_VAL_I32) off = ov.u.i32;
-        else {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint64_t base = (uint64_t)bv.u.ptr;
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)(base - (uint64_t)off)};
-        ip++;
-        break;
+      uint8_t* w = NULL;
+      if (!sem_guest_mem_map_rw(mem, dv.u.ptr, (zi_size32_t)n, &w) || !w) return ZI_E_BOUNDS;
+      memset(w, (int)byte, n);
+      ip++;
+      break;
+    }
+    case SIR_INST_VEC_SPLAT_I32:
+    case SIR_INST_VEC_SPLAT_BOOL:
+    case SIR_INST_VEC_I32_ADD:
+    case SIR_INST_VEC_I32_CMP_EQ:
+    case SIR_INST_VEC_I32_CMP_SLT:
+    case SIR_INST_VEC_SELECT_I32: {
+      const int32_t rc = exec_vec(x, fid, ip, i, vals, f->value_count);
+      if (rc != 0) return rc;
+      ip++;
+      break;
+    }
+    case SIR_INST_ATOMIC_RMW_I8:
+    case SIR_INST_ATOMIC_RMW_I16:
+    case SIR_INST_ATOMIC_RMW_I32:
+    case SIR_INST_ATOMIC_RMW_I64: {
+      const sir_val_id_t a = i->u.atomic_rmw.addr;
+      const sir_val_id_t v = i->u.atomic_rmw.value;
+      const sir_val_id_t dst = i->u.atomic_rmw.dst_old;
+      if (a >= f->value_count || v >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      if (av.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      const uint32_t align = i->u.atomic_rmw.align ? i->u.atomic_rmw.align : 1u;
+      if (!is_pow2_u32(align)) return ZI_E_INVALID;
+      if (align > 1u) {
+        const uint64_t addr = (uint64_t)av.u.ptr;
+        if ((addr & (uint64_t)(align - 1u)) != 0ull) return 256;
       }
-      case SIR_INST_PTR_CMP_EQ:
-      case SIR_INST_PTR_CMP_NE: {
-        const sir_val_id_t a = i->u.ptr_cmp.a;
-        const sir_val_id_t b = i->u.ptr_cmp.b;
-        const sir_val_id_t dst = i->u.ptr_cmp.dst;
-        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t bv = vals[b];
-        if (av.kind != SIR_VAL_PTR || bv.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const bool eq = (av.u.ptr == bv.u.ptr);
-        const uint8_t r = (i->k == SIR_INST_PTR_CMP_EQ) ? (uint8_t)eq : (uint8_t)(!eq);
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = r};
-        ip++;
-        break;
+
+      uint32_t size = 0;
+      sir_val_kind_t want = SIR_VAL_INVALID;
+      if (i->k == SIR_INST_ATOMIC_RMW_I8) {
+        size = 1;
+        want = SIR_VAL_I8;
+      } else if (i->k == SIR_INST_ATOMIC_RMW_I16) {
+        size = 2;
+        want = SIR_VAL_I16;
+      } else if (i->k == SIR_INST_ATOMIC_RMW_I32) {
+        size = 4;
+        want = SIR_VAL_I32;
+      } else {
+        size = 8;
+        want = SIR_VAL_I64;
       }
-      case SIR_INST_PTR_TO_I64: {
-        const sir_val_id_t x = i->u.ptr_to_i64.x;
-        const sir_val_id_t dst = i->u.ptr_to_i64.dst;
-        if (x >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
+      const sir_value_t vv = vals[v];
+      if (vv.kind != want) return ZI_E_INVALID;
+
+      uint8_t* w = NULL;
+      if (!sem_guest_mem_map_rw(mem, av.u.ptr, (zi_size32_t)size, &w) || !w) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, size);
+
+      sir_value_t old = {0};
+      old.kind = want;
+      if (size == 1) {
+        uint8_t x = 0;
+        memcpy(&x, w, 1);
+        old.u.u8 = x;
+        uint8_t nv = x;
+        switch (i->u.atomic_rmw.op) {
+          case SIR_ATOMIC_RMW_ADD: nv = (uint8_t)(x + vv.u.u8); break;
+          case SIR_ATOMIC_RMW_AND: nv = (uint8_t)(x & vv.u.u8); break;
+          case SIR_ATOMIC_RMW_OR: nv = (uint8_t)(x | vv.u.u8); break;
+          case SIR_ATOMIC_RMW_XOR: nv = (uint8_t)(x ^ vv.u.u8); break;
+          case SIR_ATOMIC_RMW_XCHG: nv = vv.u.u8; break;
+          default:
+            return ZI_E_INVALID;
         }
-        const sir_value_t xv = vals[x];
-        if (xv.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
+        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 1);
+        memcpy(w, &nv, 1);
+      } else if (size == 2) {
+        uint16_t x = 0;
+        memcpy(&x, w, 2);
+        old.u.u16 = x;
+        uint16_t nv = x;
+        switch (i->u.atomic_rmw.op) {
+          case SIR_ATOMIC_RMW_ADD: nv = (uint16_t)(x + vv.u.u16); break;
+          case SIR_ATOMIC_RMW_AND: nv = (uint16_t)(x & vv.u.u16); break;
+          case SIR_ATOMIC_RMW_OR: nv = (uint16_t)(x | vv.u.u16); break;
+          case SIR_ATOMIC_RMW_XOR: nv = (uint16_t)(x ^ vv.u.u16); break;
+          case SIR_ATOMIC_RMW_XCHG: nv = vv.u.u16; break;
+          default:
+            return ZI_E_INVALID;
         }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)(uint64_t)xv.u.ptr};
-        ip++;
-        break;
-      }
-      case SIR_INST_PTR_FROM_I64: {
-        const sir_val_id_t x = i->u.ptr_from_i64.x;
-        const sir_val_id_t dst = i->u.ptr_from_i64.dst;
-        if (x >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
+        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 2);
+        memcpy(w, &nv, 2);
+      } else if (size == 4) {
+        int32_t x = 0;
+        memcpy(&x, w, 4);
+        old.u.i32 = x;
+        uint32_t xo = (uint32_t)x;
+        uint32_t xv = (uint32_t)vv.u.i32;
+        uint32_t nv = xo;
+        switch (i->u.atomic_rmw.op) {
+          case SIR_ATOMIC_RMW_ADD: nv = xo + xv; break;
+          case SIR_ATOMIC_RMW_AND: nv = xo & xv; break;
+          case SIR_ATOMIC_RMW_OR: nv = xo | xv; break;
+          case SIR_ATOMIC_RMW_XOR: nv = xo ^ xv; break;
+          case SIR_ATOMIC_RMW_XCHG: nv = xv; break;
+          default:
+            return ZI_E_INVALID;
         }
-        const sir_value_t xv = vals[x];
-        uint64_t bits = 0;
-        if (xv.kind == SIR_VAL_I64) bits = (uint64_t)xv.u.i64;
-        else if (xv.kind == SIR_VAL_I32) bits = (uint64_t)(uint32_t)xv.u.i32;
-        else {
-          free(vals);
-          return ZI_E_INVALID;
+        const int32_t out = (int32_t)nv;
+        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 4);
+        memcpy(w, &out, 4);
+      } else {
+        int64_t x = 0;
+        memcpy(&x, w, 8);
+        old.u.i64 = x;
+        uint64_t xo = (uint64_t)x;
+        uint64_t xv = (uint64_t)vv.u.i64;
+        uint64_t nv = xo;
+        switch (i->u.atomic_rmw.op) {
+          case SIR_ATOMIC_RMW_ADD: nv = xo + xv; break;
+          case SIR_ATOMIC_RMW_AND: nv = xo & xv; break;
+          case SIR_ATOMIC_RMW_OR: nv = xo | xv; break;
+          case SIR_ATOMIC_RMW_XOR: nv = xo ^ xv; break;
+          case SIR_ATOMIC_RMW_XCHG: nv = xv; break;
+          default:
+            return ZI_E_INVALID;
         }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)bits};
-        ip++;
-        break;
+        const int64_t out = (int64_t)nv;
+        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 8);
+        memcpy(w, &out, 8);
       }
-      case SIR_INST_BOOL_NOT: {
-        const sir_val_id_t x = i->u.bool_not.x;
-        const sir_val_id_t dst = i->u.bool_not.dst;
-        if (x >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t xv = vals[x];
-        if (xv.kind != SIR_VAL_BOOL) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(xv.u.b ? 0 : 1)};
-        ip++;
-        break;
+
+      vals[dst] = old;
+      ip++;
+      break;
+    }
+    case SIR_INST_ATOMIC_CMPXCHG_I64: {
+      const sir_val_id_t a = i->u.atomic_cmpxchg_i64.addr;
+      const sir_val_id_t e = i->u.atomic_cmpxchg_i64.expected;
+      const sir_val_id_t d = i->u.atomic_cmpxchg_i64.desired;
+      const sir_val_id_t dst = i->u.atomic_cmpxchg_i64.dst_old;
+      if (a >= f->value_count || e >= f->value_count || d >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      const sir_value_t ev = vals[e];
+      const sir_value_t dv = vals[d];
+      if (av.kind != SIR_VAL_PTR || ev.kind != SIR_VAL_I64 || dv.kind != SIR_VAL_I64) return ZI_E_INVALID;
+      const uint32_t align = i->u.atomic_cmpxchg_i64.align ? i->u.atomic_cmpxchg_i64.align : 1u;
+      if (!is_pow2_u32(align)) return ZI_E_INVALID;
+      if (align > 1u) {
+        const uint64_t addr = (uint64_t)av.u.ptr;
+        if ((addr & (uint64_t)(align - 1u)) != 0ull) return 256;
       }
-      case SIR_INST_BOOL_AND:
-      case SIR_INST_BOOL_OR:
-      case SIR_INST_BOOL_XOR: {
-        const sir_val_id_t a = i->u.bool_bin.a;
-        const sir_val_id_t b = i->u.bool_bin.b;
-        const sir_val_id_t dst = i->u.bool_bin.dst;
-        if (a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t bv = vals[b];
-        if (av.kind != SIR_VAL_BOOL || bv.kind != SIR_VAL_BOOL) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint8_t ax = (uint8_t)(av.u.b ? 1 : 0);
-        const uint8_t bx = (uint8_t)(bv.u.b ? 1 : 0);
-        uint8_t r = 0;
-        if (i->k == SIR_INST_BOOL_AND) r = (uint8_t)(ax & bx);
-        else if (i->k == SIR_INST_BOOL_OR) r = (uint8_t)(ax | bx);
-        else r = (uint8_t)(ax ^ bx);
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = r};
-        ip++;
-        break;
+      uint8_t* w = NULL;
+      if (!sem_guest_mem_map_rw(mem, av.u.ptr, 8, &w) || !w) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, 8);
+      int64_t old = 0;
+      memcpy(&old, w, 8);
+      if (old == ev.u.i64) {
+        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 8);
+        memcpy(w, &dv.u.i64, 8);
       }
-      case SIR_INST_I32_TRUNC_I64: {
-        const sir_val_id_t x = i->u.i32_trunc_i64.x;
-        const sir_val_id_t dst = i->u.i32_trunc_i64.dst;
-        if (x >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t xv = vals[x];
-        if (xv.kind != SIR_VAL_I64) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(uint32_t)xv.u.i64};
-        ip++;
-        break;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = old};
+      ip++;
+      break;
+    }
+    case SIR_INST_ALLOCA: {
+      const sir_val_id_t dst = i->u.alloca_.dst;
+      if (dst >= f->value_count) return ZI_E_BOUNDS;
+      const zi_ptr_t p = sem_guest_stack_alloc(mem, (zi_size32_t)i->u.alloca_.size, (zi_size32_t)i->u.alloca_.align);
+      if (!p) return ZI_E_OOM;
+      vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = p};
+      ip++;
+      break;
+    }
+    case SIR_INST_STORE_I8:
+    case SIR_INST_STORE_I16:
+    case SIR_INST_STORE_I32:
+    case SIR_INST_STORE_I64:
+    case SIR_INST_STORE_PTR: {
+      const sir_val_id_t a = i->u.store.addr;
+      const sir_val_id_t v = i->u.store.value;
+      if (a >= f->value_count || v >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      if (av.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      const uint32_t align = i->u.store.align ? i->u.store.align : 1u;
+      if (!is_pow2_u32(align)) return ZI_E_INVALID;
+      if (align > 1u) {
+        const uint64_t addr = (uint64_t)av.u.ptr;
+        if ((addr & (uint64_t)(align - 1u)) != 0ull) return 256;
       }
-      case SIR_INST_I32_ZEXT_I8: {
-        const sir_val_id_t x = i->u.i32_zext_i8.x;
-        const sir_val_id_t dst = i->u.i32_zext_i8.dst;
-        if (x >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t xv = vals[x];
-        if (xv.kind != SIR_VAL_I8) {
-          free(vals);
+      uint32_t size = 0;
+      if (i->k == SIR_INST_STORE_I8) size = 1;
+      else if (i->k == SIR_INST_STORE_I16) size = 2;
+      else if (i->k == SIR_INST_STORE_I32) size = 4;
+      else if (i->k == SIR_INST_STORE_I64) size = 8;
+      else size = (uint32_t)sizeof(zi_ptr_t);
+      uint8_t* w = NULL;
+      if (!sem_guest_mem_map_rw(mem, av.u.ptr, (zi_size32_t)size, &w) || !w) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, size);
+      if (i->k == SIR_INST_STORE_I8) {
+        const sir_value_t vv = vals[v];
+        const uint8_t b = (vv.kind == SIR_VAL_I8) ? vv.u.u8 : (vv.kind == SIR_VAL_I32) ? (uint8_t)vv.u.i32 : 0;
+        if (vv.kind != SIR_VAL_I8 && vv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+        memcpy(w, &b, 1);
+      } else if (i->k == SIR_INST_STORE_I16) {
+        const sir_value_t vv = vals[v];
+        uint16_t x = 0;
+        if (vv.kind == SIR_VAL_I16) x = vv.u.u16;
+        else if (vv.kind == SIR_VAL_I8) x = (uint16_t)vv.u.u8;
+        else if (vv.kind == SIR_VAL_I32) x = (uint16_t)(uint32_t)vv.u.i32;
+        else if (vv.kind == SIR_VAL_I64) x = (uint16_t)(uint64_t)vv.u.i64;
+        else {
           return ZI_E_INVALID;
         }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(uint32_t)xv.u.u8};
-        ip++;
-        break;
+        memcpy(w, &x, 2);
+      } else if (i->k == SIR_INST_STORE_I32) {
+        const sir_value_t vv = vals[v];
+        if (vv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+        memcpy(w, &vv.u.i32, 4);
+      } else if (i->k == SIR_INST_STORE_I64) {
+        const sir_value_t vv = vals[v];
+        if (vv.kind != SIR_VAL_I64) return ZI_E_INVALID;
+        memcpy(w, &vv.u.i64, 8);
+      } else {
+        const sir_value_t vv = vals[v];
+        if (vv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+        memcpy(w, &vv.u.ptr, sizeof(vv.u.ptr));
       }
-      case SIR_INST_I32_ZEXT_I16: {
-        const sir_val_id_t x = i->u.i32_zext_i16.x;
-        const sir_val_id_t dst = i->u.i32_zext_i16.dst;
-        if (x >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t xv = vals[x];
-        if (xv.kind != SIR_VAL_I16) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = (int32_t)(uint32_t)xv.u.u16};
-        ip++;
-        break;
+      ip++;
+      break;
+    }
+    case SIR_INST_STORE_F32:
+    case SIR_INST_STORE_F64: {
+      const sir_val_id_t a = i->u.store.addr;
+      const sir_val_id_t v = i->u.store.value;
+      if (a >= f->value_count || v >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      if (av.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      const uint32_t align = i->u.store.align ? i->u.store.align : 1u;
+      if (!is_pow2_u32(align)) return ZI_E_INVALID;
+      if (align > 1u) {
+        const uint64_t addr = (uint64_t)av.u.ptr;
+        if ((addr & (uint64_t)(align - 1u)) != 0ull) return 256;
       }
-      case SIR_INST_I64_ZEXT_I32: {
-        const sir_val_id_t x = i->u.i64_zext_i32.x;
-        const sir_val_id_t dst = i->u.i64_zext_i32.dst;
-        if (x >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t xv = vals[x];
-        if (xv.kind != SIR_VAL_I32) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = (int64_t)(uint64_t)(uint32_t)xv.u.i32};
-        ip++;
-        break;
+      const uint32_t size = (i->k == SIR_INST_STORE_F32) ? 4u : 8u;
+      uint8_t* w = NULL;
+      if (!sem_guest_mem_map_rw(mem, av.u.ptr, (zi_size32_t)size, &w) || !w) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, size);
+      const sir_value_t vv = vals[v];
+      if (i->k == SIR_INST_STORE_F32) {
+        if (vv.kind != SIR_VAL_F32) return ZI_E_INVALID;
+        const uint32_t bits = f32_canon_bits(vv.u.f32_bits);
+        memcpy(w, &bits, 4);
+      } else {
+        if (vv.kind != SIR_VAL_F64) return ZI_E_INVALID;
+        const uint64_t bits = f64_canon_bits(vv.u.f64_bits);
+        memcpy(w, &bits, 8);
       }
-      case SIR_INST_SELECT: {
-        const sir_val_id_t cond = i->u.select.cond;
-        const sir_val_id_t a = i->u.select.a;
-        const sir_val_id_t b = i->u.select.b;
-        const sir_val_id_t dst = i->u.select.dst;
-        if (cond >= f->value_count || a >= f->value_count || b >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t cv = vals[cond];
-        if (cv.kind != SIR_VAL_BOOL) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        vals[dst] = cv.u.b ? vals[a] : vals[b];
-        ip++;
-        break;
+      ip++;
+      break;
+    }
+    case SIR_INST_LOAD_I8:
+    case SIR_INST_LOAD_I16:
+    case SIR_INST_LOAD_I32:
+    case SIR_INST_LOAD_I64:
+    case SIR_INST_LOAD_PTR: {
+      const sir_val_id_t a = i->u.load.addr;
+      const sir_val_id_t dst = i->u.load.dst;
+      if (a >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      if (av.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      const uint32_t align = i->u.load.align ? i->u.load.align : 1u;
+      if (!is_pow2_u32(align)) return ZI_E_INVALID;
+      if (align > 1u) {
+        const uint64_t addr = (uint64_t)av.u.ptr;
+        if ((addr & (uint64_t)(align - 1u)) != 0ull) return 256;
       }
-      case SIR_INST_BR:
-        if (i->u.br.arg_count) {
-          const uint32_t n = i->u.br.arg_count;
-          const sir_val_id_t* src = i->u.br.src_slots;
-          const sir_val_id_t* dst = i->u.br.dst_slots;
-          if (!src || !dst) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-
-          sir_value_t tmp_small[16];
-          sir_value_t* tmp = tmp_small;
-          if (n > (uint32_t)(sizeof(tmp_small) / sizeof(tmp_small[0]))) {
-            tmp = (sir_value_t*)malloc((size_t)n * sizeof(*tmp));
-            if (!tmp) {
-              free(vals);
-              return ZI_E_OOM;
-            }
-          }
+      uint32_t size = 0;
+      if (i->k == SIR_INST_LOAD_I8) size = 1;
+      else if (i->k == SIR_INST_LOAD_I16) size = 2;
+      else if (i->k == SIR_INST_LOAD_I32) size = 4;
+      else if (i->k == SIR_INST_LOAD_I64) size = 8;
+      else size = (uint32_t)sizeof(zi_ptr_t);
+      const uint8_t* r = NULL;
+      if (!sem_guest_mem_map_ro(mem, av.u.ptr, (zi_size32_t)size, &r) || !r) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, size);
+      if (i->k == SIR_INST_LOAD_I8) {
+        uint8_t b = 0;
+        memcpy(&b, r, 1);
+        vals[dst] = (sir_value_t){.kind = SIR_VAL_I8, .u.u8 = b};
+      } else if (i->k == SIR_INST_LOAD_I16) {
+        uint16_t x = 0;
+        memcpy(&x, r, 2);
+        vals[dst] = (sir_value_t){.kind = SIR_VAL_I16, .u.u16 = x};
+      } else if (i->k == SIR_INST_LOAD_I32) {
+        int32_t x = 0;
+        memcpy(&x, r, 4);
+        vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = x};
+      } else if (i->k == SIR_INST_LOAD_I64) {
+        int64_t x = 0;
+        memcpy(&x, r, 8);
+        vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = x};
+      } else {
+        zi_ptr_t x = 0;
+        memcpy(&x, r, sizeof(x));
+        vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = x};
+      }
+      ip++;
+      break;
+    }
+    case SIR_INST_LOAD_F32:
+    case SIR_INST_LOAD_F64: {
+      const sir_val_id_t a = i->u.load.addr;
+      const sir_val_id_t dst = i->u.load.dst;
+      if (a >= f->value_count || dst >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t av = vals[a];
+      if (av.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+      const uint32_t align = i->u.load.align ? i->u.load.align : 1u;
+      if (!is_pow2_u32(align)) return ZI_E_INVALID;
+      if (align > 1u) {
+        const uint64_t addr = (uint64_t)av.u.ptr;
+        if ((addr & (uint64_t)(align - 1u)) != 0ull) return 256;
+      }
+      const uint32_t size = (i->k == SIR_INST_LOAD_F32) ? 4u : 8u;
+      const uint8_t* r = NULL;
+      if (!sem_guest_mem_map_ro(mem, av.u.ptr, (zi_size32_t)size, &r) || !r) return ZI_E_BOUNDS;
+      if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, size);
+      if (i->k == SIR_INST_LOAD_F32) {
+        uint32_t bits = 0;
+        memcpy(&bits, r, 4);
+        vals[dst] = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_canon_bits(bits)};
+      } else {
+        uint64_t bits = 0;
+        memcpy(&bits, r, 8);
+        vals[dst] = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_canon_bits(bits)};
+      }
+      ip++;
+      break;
+    }
+    case SIR_INST_CALL_EXTERN: {
+      const int32_t r = exec_call_extern(m, mem, host, exec_hostcall(x, i->u.call_extern.callee), fid, ip, sink, i, vals, f->value_count);
+      if (r < 0) return r;
+      ip++;
+      break;
+    }
+    case SIR_INST_CALL_FUNC: {
+      const int32_t r = exec_call_func(x, i, vals, f->value_count, depth);
+      if (r < 0) return r;
+      ip++;
+      break;
+    }
+    case SIR_INST_CALL_FUNC_PTR: {
+      const int32_t r = exec_call_func_ptr(x, exec_icache(x, fid, ip), i, vals, f->value_count, depth);
+      if (r < 0) return r;
+      ip++;
+      break;
+    }
+    case SIR_INST_RET:
+      if (out_results && out_result_count) return ZI_E_INVALID;
+      return 0;
+    case SIR_INST_RET_VAL:
+      if (out_result_count != 1 || !out_results) return ZI_E_INVALID;
+      if (i->u.ret_val.value >= f->value_count) return ZI_E_BOUNDS;
+      out_results[0] = vals[i->u.ret_val.value];
+      return 0;
+    case SIR_INST_EXIT:
+      if (i->u.exit_.code < 0) return ZI_E_INVALID;
+      if (i->u.exit_.code == INT32_MAX) return ZI_E_INVALID;
+      // Encode "process exit requested" as rc+1 so callers can distinguish from
+      // a normal `RET` (which returns 0).
+      return i->u.exit_.code + 1;
+    case SIR_INST_EXIT_VAL: {
+      const sir_val_id_t cv = i->u.exit_val.code;
+      if (cv >= f->value_count) return ZI_E_BOUNDS;
+      const sir_value_t v = vals[cv];
+      if (v.kind == SIR_VAL_I32) {
+        if (v.u.i32 < 0) return ZI_E_INVALID;
+        if (v.u.i32 == INT32_MAX) return ZI_E_INVALID;
+        return v.u.i32 + 1;
+      }
+      if (v.kind == SIR_VAL_I64) {
+        if (v.u.i64 < INT32_MIN || v.u.i64 > INT32_MAX) return ZI_E_INVALID;
+        if (v.u.i64 < 0 || v.u.i64 == INT32_MAX) return ZI_E_INVALID;
+        return (int32_t)v.u.i64 + 1;
+      }
+      return ZI_E_INVALID;
+    }
+    default:
+      return ZI_E_INVALID;
+  }
+  *io_ip = ip;
+  *out_done = false;
+  return 0;
+}
 
-          for (uint32_t ai = 0; ai < n; ai++) {
-            const sir_val_id_t s = src[ai];
-            if (s >= f->value_count) {
-              if (tmp != tmp_small) free(tmp);
-              free(vals);
-              return ZI_E_BOUNDS;
-            }
-            tmp[ai] = vals[s];
-          }
-          for (uint32_t ai = 0; ai < n; ai++) {
-            const sir_val_id_t d = dst[ai];
-            if (d >= f->value_count) {
-              if (tmp != tmp_small) free(tmp);
-              free(vals);
-              return ZI_E_BOUNDS;
-            }
-            vals[d] = tmp[ai];
-          }
+static int32_t exec_inst(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, sir_value_t* vals, sir_value_t* out_results,
+                         uint32_t out_result_count, uint32_t depth, uint32_t* io_ip, bool* out_done) {
+  return exec_inst_impl(x, exec_sink(x, fid), fid, f, vals, out_results, out_result_count, depth, io_ip, out_done);
+}
 
-          if (tmp != tmp_small) free(tmp);
-        }
-        ip = i->u.br.target_ip;
-        break;
-      case SIR_INST_CBR: {
-        const sir_val_id_t cvid = i->u.cbr.cond;
-        if (cvid >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t cv = vals[cvid];
-        if (cv.kind != SIR_VAL_BOOL) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        ip = cv.u.b ? i->u.cbr.then_ip : i->u.cbr.else_ip;
-        break;
-      }
-      case SIR_INST_SWITCH: {
-        const sir_val_id_t sid = i->u.sw.scrut;
-        if (sid >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t sv = vals[sid];
-        if (sv.kind != SIR_VAL_I32) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t n = i->u.sw.case_count;
-        const int32_t* lits = i->u.sw.case_lits;
-        const uint32_t* tgt = i->u.sw.case_target;
-        if (n && (!lits || !tgt)) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        uint32_t next_ip = i->u.sw.default_ip;
-        for (uint32_t ci = 0; ci < n; ci++) {
-          if (sv.u.i32 == lits[ci]) {
-            next_ip = tgt[ci];
-            break;
-          }
-        }
-        ip = next_ip;
+// Reference engine: a switch over sir_inst_t that re-checks every operand.
+// Like exec_inst, instantiated with and without hooks (`hooks` is a literal).
+static SIR_ALWAYS_INLINE int32_t exec_func_impl(const sir_exec_t* x, bool hooks, sir_func_id_t fid, const sir_value_t* args,
+                                                uint32_t arg_count, sir_value_t* out_results, uint32_t out_result_count, uint32_t depth) {
+  const sir_module_t* m = x->m;
+  if (!m) return ZI_E_INTERNAL;
+  if (depth > 1024) return ZI_E_INTERNAL;
+  if (fid == 0 || fid > m->func_count) return ZI_E_NOENT;
+
+  const sir_func_t* f = &m->funcs[fid - 1];
+  if (!(args == NULL && arg_count == 0 && fid == m->entry) && arg_count != f->sig.param_count) return ZI_E_INVALID;
+  if (out_result_count != f->sig.result_count) return ZI_E_INVALID;
+
+  if (f->value_count > 1u << 20) return ZI_E_INVALID;
+  sir_frame_mark_t mark;
+  sir_value_t* vals = NULL;
+  const int32_t init_rc = exec_frame_enter(x, fid, f, args, arg_count, &mark, &vals);
+  if (init_rc != 0) return init_rc;
+
+  sir_tier_stats_t* st = x->tier ? &x->tier[fid - 1] : NULL;
+  int32_t rc = 0;
+  const sir_exec_event_sink_t* sink = hooks ? exec_sink(x, fid) : NULL;
+  for (uint32_t ip = 0; ip < f->inst_count;) {
+    if (hooks) exec_step_hooks(x, sink, fid, ip, f->insts[ip].k);
+    bool done = false;
+    const uint32_t from = ip;
+    rc = hooks ? exec_inst(x, fid, f, vals, out_results, out_result_count, depth, &ip, &done)
+               : exec_inst_impl(x, NULL, fid, f, vals, out_results, out_result_count, depth, &ip, &done);
+    if (done) break;
+    rc = 0;
+    if (st && ip <= from) {
+      // Back-edge: once hot, the rest of this frame runs in threaded code
+      // (the frame layout is shared, so vals carries over as is).
+      if (st->back_edges < UINT32_MAX) st->back_edges++;
+      if (st->back_edges >= x->hot_loops) st->promoted = true;
+      if (st->promoted && tier_osr(x, fid, f, ip, vals, out_results, out_result_count, depth, &rc)) break;
+    }
+  }
+
+  exec_frame_leave(x, mark);
+  return rc;
+}
+
+static int32_t exec_func_traced(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count,
+                                sir_value_t* out_results, uint32_t out_result_count, uint32_t depth) {
+  return exec_func_impl(x, true, fid, args, arg_count, out_results, out_result_count, depth);
+}
+
+static int32_t exec_func_plain(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count,
+                               sir_value_t* out_results, uint32_t out_result_count, uint32_t depth) {
+  return exec_func_impl(x, false, fid, args, arg_count, out_results, out_result_count, depth);
+}
+
+// x->sink and x->prof are fixed for the whole run (module_exec drops sinks
+// without hooks), so a function's frames always take the same instance;
+// functions masked out of the sink take the plain one unless sampling.
+static int32_t exec_func(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results,
+                         uint32_t out_result_count, uint32_t depth) {
+  if (x->prof || exec_sink(x, fid)) return exec_func_traced(x, fid, args, arg_count, out_results, out_result_count, depth);
+  return exec_func_plain(x, fid, args, arg_count, out_results, out_result_count, depth);
+}
+
+// ---- Threaded engine ----
+//
+// Each function is decoded on its first call (tx_code) into a flat sir_tinst_t
+// stream. The stream is published with a compare-and-swap: threads running
+// the same module keep whichever decode lands first and free their own.
+// Operands are lifted out of the sir_inst_t union, constants are pre-built,
+// branch targets become pointers and every entry carries the address of its
+// handler. Execution always follows sir_module_validate, so
+// slot ranges, branch targets, alignment and call arity are not re-checked
+// here. Operand kinds still are (the validator doesn't track them).
+// Instructions without a dedicated handler run through exec_inst.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIR_EXEC_THREADED 1
+#else
+#define SIR_EXEC_THREADED 0
+#endif
+
+// Opcodes with a *_T form have a typed variant right after the checked one,
+// selected when tx_infer_kinds proves the kinds of all its operands.
+#define SIR_TOP_LIST(X) \
+  X(GENERIC)            \
+  X(END)                \
+  X(CONST)              \
+  X(I32_ADD)            \
+  X(I32_ADD_T)          \
+  X(I32_SUB)            \
+  X(I32_SUB_T)          \
+  X(I32_MUL)            \
+  X(I32_MUL_T)          \
+  X(I32_AND)            \
+  X(I32_AND_T)          \
+  X(I32_OR)             \
+  X(I32_OR_T)           \
+  X(I32_XOR)            \
+  X(I32_XOR_T)          \
+  X(I32_SHL)            \
+  X(I32_SHL_T)          \
+  X(I32_SHR_S)          \
+  X(I32_SHR_S_T)        \
+  X(I32_SHR_U)          \
+  X(I32_SHR_U_T)        \
+  X(I32_NOT)            \
+  X(I32_NOT_T)          \
+  X(I32_NEG)            \
+  X(I32_NEG_T)          \
+  X(I32_CMP_EQ)         \
+  X(I32_CMP_EQ_T)       \
+  X(I32_CMP_NE)         \
+  X(I32_CMP_NE_T)       \
+  X(I32_CMP_SLT)        \
+  X(I32_CMP_SLT_T)      \
+  X(I32_CMP_SLE)        \
+  X(I32_CMP_SLE_T)      \
+  X(I32_CMP_SGT)        \
+  X(I32_CMP_SGT_T)      \
+  X(I32_CMP_SGE)        \
+  X(I32_CMP_SGE_T)      \
+  X(I32_CMP_ULT)        \
+  X(I32_CMP_ULT_T)      \
+  X(I32_CMP_ULE)        \
+  X(I32_CMP_ULE_T)      \
+  X(I32_CMP_UGT)        \
+  X(I32_CMP_UGT_T)      \
+  X(I32_CMP_UGE)        \
+  X(I32_CMP_UGE_T)      \
+  X(I64_ADD)            \
+  X(I64_ADD_T)          \
+  X(I64_SUB)            \
+  X(I64_SUB_T)          \
+  X(I64_MUL)            \
+  X(I64_MUL_T)          \
+  X(I64_AND)            \
+  X(I64_AND_T)          \
+  X(I64_OR)             \
+  X(I64_OR_T)           \
+  X(I64_XOR)            \
+  X(I64_XOR_T)          \
+  X(I64_SHL)            \
+  X(I64_SHL_T)          \
+  X(I64_SHR_S)          \
+  X(I64_SHR_S_T)        \
+  X(I64_SHR_U)          \
+  X(I64_SHR_U_T)        \
+  X(I64_DIV)            \
+  X(I64_NOT)            \
+  X(I64_NOT_T)          \
+  X(I64_NEG)            \
+  X(I64_NEG_T)          \
+  X(I64_CMP_EQ)         \
+  X(I64_CMP_EQ_T)       \
+  X(I64_CMP_NE)         \
+  X(I64_CMP_NE_T)       \
+  X(I64_CMP_SLT)        \
+  X(I64_CMP_SLT_T)      \
+  X(I64_CMP_SLE)        \
+  X(I64_CMP_SLE_T)      \
+  X(I64_CMP_SGT)        \
+  X(I64_CMP_SGT_T)      \
+  X(I64_CMP_SGE)        \
+  X(I64_CMP_SGE_T)      \
+  X(I64_CMP_ULT)        \
+  X(I64_CMP_ULT_T)      \
+  X(I64_CMP_ULE)        \
+  X(I64_CMP_ULE_T)      \
+  X(I64_CMP_UGT)        \
+  X(I64_CMP_UGT_T)      \
+  X(I64_CMP_UGE)        \
+  X(I64_CMP_UGE_T)      \
+  X(F32_ADD)            \
+  X(F32_ADD_T)          \
+  X(F32_SUB)            \
+  X(F32_SUB_T)          \
+  X(F32_MUL)            \
+  X(F32_MUL_T)          \
+  X(F32_DIV)            \
+  X(F32_DIV_T)          \
+  X(F64_ADD)            \
+  X(F64_ADD_T)          \
+  X(F64_SUB)            \
+  X(F64_SUB_T)          \
+  X(F64_MUL)            \
+  X(F64_MUL_T)          \
+  X(F64_DIV)            \
+  X(F64_DIV_T)          \
+  X(F32_CMP)            \
+  X(F64_CMP)            \
+  X(NUM_UN)             \
+  X(BOOL_NOT)           \
+  X(SELECT)             \
+  X(GLOBAL_ADDR)        \
+  X(PTR_OFFSET)         \
+  X(PTR_ADD)            \
+  X(PTR_SUB)            \
+  X(I32_TRUNC_I64)      \
+  X(I32_ZEXT_I8)        \
+  X(I32_ZEXT_I16)       \
+  X(I64_ZEXT_I32)       \
+  X(LOAD_I8)            \
+  X(LOAD_I16)           \
+  X(LOAD_I32)           \
+  X(LOAD_I32_T)         \
+  X(LOAD_I64)           \
+  X(LOAD_I64_T)         \
+  X(LOAD_PTR)           \
+  X(LOAD_PTR_T)         \
+  X(STORE_I8)           \
+  X(STORE_I32)          \
+  X(STORE_I32_T)        \
+  X(STORE_I64)          \
+  X(STORE_I64_T)        \
+  X(STORE_PTR)          \
+  X(STORE_PTR_T)        \
+  X(BR)                 \
+  X(BR_ARGS)            \
+  X(CBR)                \
+  X(CBR_T)              \
+  X(SWITCH)             \
+  X(CALL_EXTERN)        \
+  X(CALL_FUNC)          \
+  X(CALL_FUNC_PTR)      \
+  X(RET)                \
+  X(RET_VAL)            \
+  SIR_TOP_FUSED_LIST(X)
+
+// Fused pairs (see tx_fuse), named after the instructions they cover.
+#define SIR_TOP_FUSED_LIST(X)   \
+  X(I32_CMP_EQ_CBR)             \
+  X(I32_CMP_NE_CBR)             \
+  X(I32_CMP_SLT_CBR)            \
+  X(I32_CMP_SLE_CBR)            \
+  X(I32_CMP_SGT_CBR)            \
+  X(I32_CMP_SGE_CBR)            \
+  X(I32_CMP_ULT_CBR)            \
+  X(I32_CMP_ULE_CBR)            \
+  X(I32_CMP_UGT_CBR)            \
+  X(I32_CMP_UGE_CBR)            \
+  X(CONST_I32_ADD_T)            \
+  X(CONST_I32_SUB_T)            \
+  X(CONST_I32_CMP_EQ_CBR)       \
+  X(CONST_I32_CMP_NE_CBR)       \
+  X(CONST_I32_CMP_SLT_CBR)      \
+  X(CONST_I32_CMP_ULT_CBR)      \
+  X(PTR_OFFSET_LOAD_I8)         \
+  X(PTR_OFFSET_LOAD_I32)        \
+  X(PTR_OFFSET_LOAD_I32_T)      \
+  X(PTR_OFFSET_LOAD_I64)        \
+  X(PTR_OFFSET_LOAD_I64_T)      \
+  X(PTR_OFFSET_LOAD_PTR)        \
+  X(PTR_OFFSET_LOAD_PTR_T)      \
+  X(LOAD_I32_STORE_I32)         \
+  X(LOAD_I32_T_STORE_I32_T)     \
+  X(LOAD_I64_STORE_I64)         \
+  X(LOAD_I64_T_STORE_I64_T)     \
+  X(LOAD_PTR_STORE_PTR)         \
+  X(LOAD_PTR_T_STORE_PTR_T)
+
+#define SIR_TOP_ENUM(n) SIR_TOP_##n,
+typedef enum sir_top { SIR_TOP_LIST(SIR_TOP_ENUM) SIR_TOP__COUNT } sir_top_t;
+#undef SIR_TOP_ENUM
+
+struct sir_tinst {
+  const void* op;       // handler label (SIR_EXEC_THREADED only)
+  sir_top_t top;
+  uint32_t ip;          // index into sir_func_t::insts
+  const sir_inst_t* i;  // NULL for the end-of-function sentinel
+  sir_val_id_t a;
+  sir_val_id_t b;
+  sir_val_id_t c;
+  sir_val_id_t d;
+  union {
+    sir_value_t v;                 // CONST
+    const struct sir_tinst* t[2];  // BR/BR_ARGS target, CBR then/else
+    uint64_t align_mask;           // LOAD_*/STORE_*
+    uint64_t scale;                // PTR_OFFSET
+    sir_icache_t* ic;              // CALL_FUNC_PTR (may be NULL)
+  } x;
+};
+
+static int32_t tx_func(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results,
+                       uint32_t out_result_count, uint32_t depth);
+
+#if SIR_EXEC_THREADED
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+// Runs one decoded frame from instruction ip0. Called with out_labels set (and
+// everything else NULL/0) it only reports the handler address table used by
+// tx_decode.
+static int32_t tx_loop(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, const sir_tinst_t* code, uint32_t ip0,
+                       sir_value_t* vals, sir_value_t* out_results, uint32_t out_result_count, uint32_t depth,
+                       const void* const** out_labels) {
+#if SIR_EXEC_THREADED
+#define SIR_TOP_LABEL(n) &&tx_##n,
+  static const void* const labels[SIR_TOP__COUNT] = {SIR_TOP_LIST(SIR_TOP_LABEL)};
+#undef SIR_TOP_LABEL
+  if (out_labels) {
+    *out_labels = labels;
+    return 0;
+  }
+#else
+  if (out_labels) {
+    *out_labels = NULL;
+    return 0;
+  }
+#endif
+  const sir_module_t* m = x->m;
+  sem_guest_mem_t* mem = x->mem;
+  const sir_exec_event_sink_t* sink = exec_sink(x, fid);
+  // Handlers are shared by traced and untraced runs (the decoded code bakes
+  // in one label table), so the hooks are at least hoisted out of them.
+  const bool step_hook = (sink && sink->on_step) || x->prof;
+  const bool mem_hook = sink && sink->on_mem;
+  const sir_tinst_t* t = code + ip0;
+
+#define TX_STEP() \
+  if (step_hook && t->i) exec_step_hooks(x, sink, fid, t->ip, t->i->k)
+#if SIR_EXEC_THREADED
+#define TX_OP(n) tx_##n:
+#define TX_DISPATCH() \
+  {                   \
+    TX_STEP();        \
+    goto* t->op;      \
+  }
+// Fused handlers continue straight into the second instruction's handler.
+#define TX_CHAIN(n) \
+  {                 \
+    t++;            \
+    TX_STEP();      \
+    goto tx_##n;    \
+  }
+#else
+#define TX_OP(n) case SIR_TOP_##n:
+#define TX_DISPATCH() goto tx_dispatch
+#define TX_CHAIN(n) TX_NEXT()
+#endif
+#define TX_NEXT() \
+  {               \
+    t++;          \
+    TX_DISPATCH(); \
+  }
+#define TX_JUMP(dst) \
+  {                  \
+    t = (dst);       \
+    TX_DISPATCH();   \
+  }
+
+// Handler bodies take a literal `typed` flag: typed variants skip the kind
+// checks and, since their destination slot is pre-tagged by the frame
+// template, store only the payload.
+#define TX_I32_BIN_BODY(typed, expr)                                                            \
+  {                                                                                             \
+    if (!(typed) && (vals[t->a].kind != SIR_VAL_I32 || vals[t->b].kind != SIR_VAL_I32)) {       \
+      return ZI_E_INVALID;                                                                      \
+    }                                                                                           \
+    const uint32_t p = (uint32_t)vals[t->a].u.i32;                                              \
+    const uint32_t q = (uint32_t)vals[t->b].u.i32;                                              \
+    const int32_t r = (int32_t)(uint32_t)(expr);                                                \
+    if (typed) vals[t->c].u.i32 = r;                                                            \
+    else vals[t->c] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = r};                           \
+    TX_NEXT();                                                                                  \
+  }
+#define TX_I32_BIN(n, expr) TX_OP(n) TX_I32_BIN_BODY(0, expr) TX_OP(n##_T) TX_I32_BIN_BODY(1, expr)
+#define TX_I32_CMP_BODY(typed, expr)                                                            \
+  {                                                                                             \
+    if (!(typed) && (vals[t->a].kind != SIR_VAL_I32 || vals[t->b].kind != SIR_VAL_I32)) {       \
+      return ZI_E_INVALID;                                                                      \
+    }                                                                                           \
+    const int32_t p = vals[t->a].u.i32;                                                         \
+    const int32_t q = vals[t->b].u.i32;                                                         \
+    const uint8_t r = (uint8_t)((expr) ? 1 : 0);                                                \
+    if (typed) vals[t->c].u.b = r;                                                              \
+    else vals[t->c] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = r};                            \
+    TX_NEXT();                                                                                  \
+  }
+#define TX_I32_CMP(n, expr) TX_OP(n) TX_I32_CMP_BODY(0, expr) TX_OP(n##_T) TX_I32_CMP_BODY(1, expr)
+// Typed compare followed by a cbr on its result: branch on the value just
+// computed.
+#define TX_I32_CMP_CBR(n, expr)                                                                 \
+  TX_OP(n##_CBR) {                                                                              \
+    const int32_t p = vals[t->a].u.i32;                                                         \
+    const int32_t q = vals[t->b].u.i32;                                                         \
+    const uint8_t r = (uint8_t)((expr) ? 1 : 0);                                                \
+    vals[t->c].u.b = r;                                                                         \
+    t++;                                                                                        \
+    TX_STEP();                                                                                  \
+    TX_JUMP(r ? t->x.t[0] : t->x.t[1]);                                                         \
+  }
+#define TX_I64_BIN_BODY(typed, expr)                                                            \
+  {                                                                                             \
+    if (!(typed) && (vals[t->a].kind != SIR_VAL_I64 || vals[t->b].kind != SIR_VAL_I64)) {       \
+      return ZI_E_INVALID;                                                                      \
+    }                                                                                           \
+    const uint64_t p = (uint64_t)vals[t->a].u.i64;                                              \
+    const uint64_t q = (uint64_t)vals[t->b].u.i64;                                              \
+    const int64_t r = (int64_t)(uint64_t)(expr);                                                \
+    if (typed) vals[t->c].u.i64 = r;                                                            \
+    else vals[t->c] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = r};                           \
+    TX_NEXT();                                                                                  \
+  }
+#define TX_I64_BIN(n, expr) TX_OP(n) TX_I64_BIN_BODY(0, expr) TX_OP(n##_T) TX_I64_BIN_BODY(1, expr)
+#define TX_I64_CMP_BODY(typed, expr)                                                            \
+  {                                                                                             \
+    if (!(typed) && (vals[t->a].kind != SIR_VAL_I64 || vals[t->b].kind != SIR_VAL_I64)) {       \
+      return ZI_E_INVALID;                                                                      \
+    }                                                                                           \
+    const int64_t p = vals[t->a].u.i64;                                                         \
+    const int64_t q = vals[t->b].u.i64;                                                         \
+    const uint8_t r = (uint8_t)((expr) ? 1 : 0);                                                \
+    if (typed) vals[t->c].u.b = r;                                                              \
+    else vals[t->c] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = r};                            \
+    TX_NEXT();                                                                                  \
+  }
+#define TX_I64_CMP(n, expr) TX_OP(n) TX_I64_CMP_BODY(0, expr) TX_OP(n##_T) TX_I64_CMP_BODY(1, expr)
+#define TX_F_BIN_BODY(typed, val_kind, c_t, field, from_bits, to_bits, op)                      \
+  {                                                                                             \
+    if (!(typed) && (vals[t->a].kind != val_kind || vals[t->b].kind != val_kind)) {             \
+      return ZI_E_INVALID;                                                                      \
+    }                                                                                           \
+    const c_t p = from_bits(vals[t->a].u.field);                                                \
+    const c_t q = from_bits(vals[t->b].u.field);                                                \
+    if (typed) vals[t->c].u.field = to_bits(p op q);                                            \
+    else vals[t->c] = (sir_value_t){.kind = val_kind, .u.field = to_bits(p op q)};              \
+    TX_NEXT();                                                                                  \
+  }
+#define TX_F32_BIN(n, op)                                                                       \
+  TX_OP(n) TX_F_BIN_BODY(0, SIR_VAL_F32, float, f32_bits, f32_from_bits, f32_bits, op)          \
+  TX_OP(n##_T) TX_F_BIN_BODY(1, SIR_VAL_F32, float, f32_bits, f32_from_bits, f32_bits, op)
+#define TX_F64_BIN(n, op)                                                                       \
+  TX_OP(n) TX_F_BIN_BODY(0, SIR_VAL_F64, double, f64_bits, f64_from_bits, f64_bits, op)         \
+  TX_OP(n##_T) TX_F_BIN_BODY(1, SIR_VAL_F64, double, f64_bits, f64_from_bits, f64_bits, op)
+#define TX_UNARY_BODY(typed, in_kind, out_kind, out_field, expr)                                \
+  {                                                                                             \
+    const sir_value_t xv = vals[t->a];                                                          \
+    if (!(typed) && xv.kind != in_kind) return ZI_E_INVALID;                                    \
+    if (typed) vals[t->b].u.out_field = (expr);                                                 \
+    else vals[t->b] = (sir_value_t){.kind = out_kind, .u.out_field = (expr)};                   \
+    TX_NEXT();                                                                                  \
+  }
+#define TX_UNARY(n, in_kind, out_kind, out_field, expr) TX_OP(n) TX_UNARY_BODY(0, in_kind, out_kind, out_field, expr)
+#define TX_UNARY_TYPED(n, in_kind, out_kind, out_field, expr) \
+  TX_UNARY(n, in_kind, out_kind, out_field, expr) TX_OP(n##_T) TX_UNARY_BODY(1, in_kind, out_kind, out_field, expr)
+// Address checks shared by loads and stores, in the same order (and with the
+// same events) as exec_inst.
+#define TX_MAP(typed, buf_t, map_fn, dir, size)                                                 \
+  const zi_ptr_t addr = vals[t->a].u.ptr;                                                       \
+  if (!(typed) && vals[t->a].kind != SIR_VAL_PTR) return ZI_E_INVALID;                          \
+  if (((uint64_t)addr & t->x.align_mask) != 0ull) return 256;                                   \
+  buf_t* buf = NULL;                                                                            \
+  if (!map_fn(mem, addr, (zi_size32_t)(size), &buf) || !buf) return ZI_E_BOUNDS;                \
+  if (mem_hook) sink->on_mem(sink->user, m, fid, t->ip, dir, addr, (uint32_t)(size))
+#define TX_LOAD_BODY(typed, c_t, val_kind, field, next)                                         \
+  {                                                                                             \
+    TX_MAP(typed, const uint8_t, sem_guest_mem_map_ro, SIR_MEM_READ, sizeof(c_t));              \
+    c_t v = 0;                                                                                  \
+    memcpy(&v, buf, sizeof(v));                                                                 \
+    if (typed) vals[t->b].u.field = v;                                                          \
+    else vals[t->b] = (sir_value_t){.kind = val_kind, .u.field = v};                            \
+    next;                                                                                       \
+  }
+#define TX_LOAD(n, c_t, val_kind, field) TX_OP(n) TX_LOAD_BODY(0, c_t, val_kind, field, TX_NEXT())
+#define TX_LOAD_TYPED(n, c_t, val_kind, field) \
+  TX_LOAD(n, c_t, val_kind, field) TX_OP(n##_T) TX_LOAD_BODY(1, c_t, val_kind, field, TX_NEXT())
+// Load then store of the same width (field copies).
+#define TX_LOAD_STORE(n, c_t, val_kind, field)                                                  \
+  TX_OP(LOAD_##n##_STORE_##n) TX_LOAD_BODY(0, c_t, val_kind, field, TX_CHAIN(STORE_##n))         \
+  TX_OP(LOAD_##n##_T_STORE_##n##_T) TX_LOAD_BODY(1, c_t, val_kind, field, TX_CHAIN(STORE_##n##_T))
+#define TX_STORE_BODY(typed, val_kind, field)                                                   \
+  {                                                                                             \
+    TX_MAP(typed, uint8_t, sem_guest_mem_map_rw, SIR_MEM_WRITE, sizeof(vals[t->b].u.field));    \
+    if (!(typed) && vals[t->b].kind != val_kind) return ZI_E_INVALID;                           \
+    memcpy(buf, &vals[t->b].u.field, sizeof(vals[t->b].u.field));                               \
+    TX_NEXT();                                                                                  \
+  }
+#define TX_STORE_TYPED(n, val_kind, field) TX_OP(n) TX_STORE_BODY(0, val_kind, field) TX_OP(n##_T) TX_STORE_BODY(1, val_kind, field)
+#define TX_PTR_OFFSET_BODY(next)                                                                \
+  {                                                                                             \
+    const sir_value_t bv = vals[t->a];                                                          \
+    const sir_value_t iv = vals[t->b];                                                          \
+    if (bv.kind != SIR_VAL_PTR) return ZI_E_INVALID;                                            \
+    int64_t idx = 0;                                                                            \
+    if (iv.kind == SIR_VAL_I64) idx = iv.u.i64;                                                 \
+    else if (iv.kind == SIR_VAL_I32) idx = iv.u.i32;                                            \
+    else return ZI_E_INVALID;                                                                   \
+    vals[t->c] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)((uint64_t)bv.u.ptr + (uint64_t)idx * t->x.scale)}; \
+    next;                                                                                       \
+  }
+#define TX_PTR_OFFSET_LOAD(n) TX_OP(PTR_OFFSET_##n) TX_PTR_OFFSET_BODY(TX_CHAIN(n))
+#define TX_CONST_THEN(n)    \
+  TX_OP(CONST_##n) {        \
+    vals[t->a] = t->x.v;    \
+    TX_CHAIN(n);            \
+  }
+
+#if SIR_EXEC_THREADED
+  TX_DISPATCH();
+#else
+tx_dispatch:
+  if (step_hook && t->i) exec_step_hooks(x, sink, fid, t->ip, t->i->k);
+  switch (t->top) {
+#endif
+
+  TX_OP(GENERIC) {
+    uint32_t ip = t->ip;
+    bool done = false;
+    const int32_t rc = exec_inst(x, fid, f, vals, out_results, out_result_count, depth, &ip, &done);
+    if (done) return rc;
+    TX_JUMP(code + ip);
+  }
+  TX_OP(END) {
+    // Fell off the end of the function.
+    return 0;
+  }
+  TX_OP(CONST) {
+    vals[t->a] = t->x.v;
+    TX_NEXT();
+  }
+
+  TX_I32_BIN(I32_ADD, p + q)
+  TX_I32_BIN(I32_SUB, p - q)
+  TX_I32_BIN(I32_MUL, p * q)
+  TX_I32_BIN(I32_AND, p & q)
+  TX_I32_BIN(I32_OR, p | q)
+  TX_I32_BIN(I32_XOR, p ^ q)
+  TX_I32_BIN(I32_SHL, p << (q & 31u))
+  TX_I32_BIN(I32_SHR_S, (int32_t)p >> (q & 31u))
+  TX_I32_BIN(I32_SHR_U, p >> (q & 31u))
+  TX_UNARY_TYPED(I32_NOT, SIR_VAL_I32, SIR_VAL_I32, i32, (int32_t)~(uint32_t)xv.u.i32)
+  TX_UNARY_TYPED(I32_NEG, SIR_VAL_I32, SIR_VAL_I32, i32, (int32_t)(0u - (uint32_t)xv.u.i32))
+
+  TX_I32_CMP(I32_CMP_EQ, p == q)
+  TX_I32_CMP(I32_CMP_NE, p != q)
+  TX_I32_CMP(I32_CMP_SLT, p < q)
+  TX_I32_CMP(I32_CMP_SLE, p <= q)
+  TX_I32_CMP(I32_CMP_SGT, p > q)
+  TX_I32_CMP(I32_CMP_SGE, p >= q)
+  TX_I32_CMP(I32_CMP_ULT, (uint32_t)p < (uint32_t)q)
+  TX_I32_CMP(I32_CMP_ULE, (uint32_t)p <= (uint32_t)q)
+  TX_I32_CMP(I32_CMP_UGT, (uint32_t)p > (uint32_t)q)
+  TX_I32_CMP(I32_CMP_UGE, (uint32_t)p >= (uint32_t)q)
+  TX_I32_CMP_CBR(I32_CMP_EQ, p == q)
+  TX_I32_CMP_CBR(I32_CMP_NE, p != q)
+  TX_I32_CMP_CBR(I32_CMP_SLT, p < q)
+  TX_I32_CMP_CBR(I32_CMP_SLE, p <= q)
+  TX_I32_CMP_CBR(I32_CMP_SGT, p > q)
+  TX_I32_CMP_CBR(I32_CMP_SGE, p >= q)
+  TX_I32_CMP_CBR(I32_CMP_ULT, (uint32_t)p < (uint32_t)q)
+  TX_I32_CMP_CBR(I32_CMP_ULE, (uint32_t)p <= (uint32_t)q)
+  TX_I32_CMP_CBR(I32_CMP_UGT, (uint32_t)p > (uint32_t)q)
+  TX_I32_CMP_CBR(I32_CMP_UGE, (uint32_t)p >= (uint32_t)q)
+  TX_CONST_THEN(I32_ADD_T)
+  TX_CONST_THEN(I32_SUB_T)
+  TX_CONST_THEN(I32_CMP_EQ_CBR)
+  TX_CONST_THEN(I32_CMP_NE_CBR)
+  TX_CONST_THEN(I32_CMP_SLT_CBR)
+  TX_CONST_THEN(I32_CMP_ULT_CBR)
+
+  TX_I64_BIN(I64_ADD, p + q)
+  TX_I64_BIN(I64_SUB, p - q)
+  TX_I64_BIN(I64_MUL, p * q)
+  TX_I64_BIN(I64_AND, p & q)
+  TX_I64_BIN(I64_OR, p | q)
+  TX_I64_BIN(I64_XOR, p ^ q)
+  TX_I64_BIN(I64_SHL, p << (q & 63u))
+  TX_I64_BIN(I64_SHR_S, (int64_t)p >> (q & 63u))
+  TX_I64_BIN(I64_SHR_U, p >> (q & 63u))
+  TX_UNARY_TYPED(I64_NOT, SIR_VAL_I64, SIR_VAL_I64, i64, (int64_t)~(uint64_t)xv.u.i64)
+  TX_UNARY_TYPED(I64_NEG, SIR_VAL_I64, SIR_VAL_I64, i64, (int64_t)(0u - (uint64_t)xv.u.i64))
+  TX_OP(I64_DIV) {
+    if (vals[t->a].kind != SIR_VAL_I64 || vals[t->b].kind != SIR_VAL_I64) return ZI_E_INVALID;
+    bool trap = false;
+    const int64_t r = num_i64_bin(t->i->k, vals[t->a].u.i64, vals[t->b].u.i64, &trap);
+    if (trap) return 256;
+    vals[t->c] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = r};
+    TX_NEXT();
+  }
+  TX_I64_CMP(I64_CMP_EQ, p == q)
+  TX_I64_CMP(I64_CMP_NE, p != q)
+  TX_I64_CMP(I64_CMP_SLT, p < q)
+  TX_I64_CMP(I64_CMP_SLE, p <= q)
+  TX_I64_CMP(I64_CMP_SGT, p > q)
+  TX_I64_CMP(I64_CMP_SGE, p >= q)
+  TX_I64_CMP(I64_CMP_ULT, (uint64_t)p < (uint64_t)q)
+  TX_I64_CMP(I64_CMP_ULE, (uint64_t)p <= (uint64_t)q)
+  TX_I64_CMP(I64_CMP_UGT, (uint64_t)p > (uint64_t)q)
+  TX_I64_CMP(I64_CMP_UGE, (uint64_t)p >= (uint64_t)q)
+
+  TX_F32_BIN(F32_ADD, +)
+  TX_F32_BIN(F32_SUB, -)
+  TX_F32_BIN(F32_MUL, *)
+  TX_F32_BIN(F32_DIV, /)
+  TX_F64_BIN(F64_ADD, +)
+  TX_F64_BIN(F64_SUB, -)
+  TX_F64_BIN(F64_MUL, *)
+  TX_F64_BIN(F64_DIV, /)
+  TX_OP(F32_CMP) {
+    if (vals[t->a].kind != SIR_VAL_F32 || vals[t->b].kind != SIR_VAL_F32) return ZI_E_INVALID;
+    const bool r = num_f_cmp(t->i->k, (double)f32_from_bits(vals[t->a].u.f32_bits), (double)f32_from_bits(vals[t->b].u.f32_bits));
+    vals[t->c] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
+    TX_NEXT();
+  }
+  TX_OP(F64_CMP) {
+    if (vals[t->a].kind != SIR_VAL_F64 || vals[t->b].kind != SIR_VAL_F64) return ZI_E_INVALID;
+    const bool r = num_f_cmp(t->i->k, f64_from_bits(vals[t->a].u.f64_bits), f64_from_bits(vals[t->b].u.f64_bits));
+    vals[t->c] = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = (uint8_t)(r ? 1 : 0)};
+    TX_NEXT();
+  }
+  TX_OP(NUM_UN) {
+    if (!num_un_eval(t->i->k, vals[t->a], &vals[t->b])) return ZI_E_INVALID;
+    TX_NEXT();
+  }
+
+  TX_UNARY(BOOL_NOT, SIR_VAL_BOOL, SIR_VAL_BOOL, b, (uint8_t)(xv.u.b ? 0 : 1))
+  TX_UNARY(I32_TRUNC_I64, SIR_VAL_I64, SIR_VAL_I32, i32, (int32_t)(uint32_t)xv.u.i64)
+  TX_UNARY(I32_ZEXT_I8, SIR_VAL_I8, SIR_VAL_I32, i32, (int32_t)(uint32_t)xv.u.u8)
+  TX_UNARY(I32_ZEXT_I16, SIR_VAL_I16, SIR_VAL_I32, i32, (int32_t)(uint32_t)xv.u.u16)
+  TX_UNARY(I64_ZEXT_I32, SIR_VAL_I32, SIR_VAL_I64, i64, (int64_t)(uint64_t)(uint32_t)xv.u.i32)
+
+  TX_OP(SELECT) {
+    const sir_value_t cv = vals[t->a];
+    if (cv.kind != SIR_VAL_BOOL) return ZI_E_INVALID;
+    vals[t->d] = cv.u.b ? vals[t->b] : vals[t->c];
+    TX_NEXT();
+  }
+  TX_OP(GLOBAL_ADDR) {
+    vals[t->a] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = x->globals[t->b - 1]};
+    TX_NEXT();
+  }
+  TX_OP(PTR_OFFSET) TX_PTR_OFFSET_BODY(TX_NEXT())
+  TX_PTR_OFFSET_LOAD(LOAD_I8)
+  TX_PTR_OFFSET_LOAD(LOAD_I32)
+  TX_PTR_OFFSET_LOAD(LOAD_I32_T)
+  TX_PTR_OFFSET_LOAD(LOAD_I64)
+  TX_PTR_OFFSET_LOAD(LOAD_I64_T)
+  TX_PTR_OFFSET_LOAD(LOAD_PTR)
+  TX_PTR_OFFSET_LOAD(LOAD_PTR_T)
+  TX_OP(PTR_ADD) {
+    const sir_value_t bv = vals[t->a];
+    const sir_value_t ov = vals[t->b];
+    if (bv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+    int64_t off = 0;
+    if (ov.kind == SIR_VAL_I64) off = ov.u.i64;
+    else if (ov.kind == SIR_VAL_I32) off = ov.u.i32;
+    else return ZI_E_INVALID;
+    vals[t->c] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)((uint64_t)bv.u.ptr + (uint64_t)off)};
+    TX_NEXT();
+  }
+  TX_OP(PTR_SUB) {
+    const sir_value_t bv = vals[t->a];
+    const sir_value_t ov = vals[t->b];
+    if (bv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+    int64_t off = 0;
+    if (ov.kind == SIR_VAL_I64) off = ov.u.i64;
+    else if (ov.kind == SIR_VAL_I32) off = ov.u.i32;
+    else return ZI_E_INVALID;
+    vals[t->c] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = (zi_ptr_t)((uint64_t)bv.u.ptr - (uint64_t)off)};
+    TX_NEXT();
+  }
+
+  TX_LOAD(LOAD_I8, uint8_t, SIR_VAL_I8, u8)
+  TX_LOAD(LOAD_I16, uint16_t, SIR_VAL_I16, u16)
+  TX_LOAD_TYPED(LOAD_I32, int32_t, SIR_VAL_I32, i32)
+  TX_LOAD_TYPED(LOAD_I64, int64_t, SIR_VAL_I64, i64)
+  TX_LOAD_TYPED(LOAD_PTR, zi_ptr_t, SIR_VAL_PTR, ptr)
+  TX_LOAD_STORE(I32, int32_t, SIR_VAL_I32, i32)
+  TX_LOAD_STORE(I64, int64_t, SIR_VAL_I64, i64)
+  TX_LOAD_STORE(PTR, zi_ptr_t, SIR_VAL_PTR, ptr)
+  TX_OP(STORE_I8) {
+    TX_MAP(0, uint8_t, sem_guest_mem_map_rw, SIR_MEM_WRITE, 1u);
+    const sir_value_t vv = vals[t->b];
+    if (vv.kind != SIR_VAL_I8 && vv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+    const uint8_t v = (vv.kind == SIR_VAL_I8) ? vv.u.u8 : (uint8_t)vv.u.i32;
+    memcpy(buf, &v, 1);
+    TX_NEXT();
+  }
+  TX_STORE_TYPED(STORE_I32, SIR_VAL_I32, i32)
+  TX_STORE_TYPED(STORE_I64, SIR_VAL_I64, i64)
+  TX_STORE_TYPED(STORE_PTR, SIR_VAL_PTR, ptr)
+
+  TX_OP(BR) {
+    TX_JUMP(t->x.t[0]);
+  }
+  TX_OP(BR_ARGS) {
+    // Parallel move: read every source before writing any destination.
+    const uint32_t n = t->i->u.br.arg_count;
+    const sir_val_id_t* src = t->i->u.br.src_slots;
+    const sir_val_id_t* dst = t->i->u.br.dst_slots;
+    sir_value_t tmp_small[16];
+    sir_value_t* tmp = tmp_small;
+    if (n > (uint32_t)(sizeof(tmp_small) / sizeof(tmp_small[0]))) {
+      tmp = (sir_value_t*)malloc((size_t)n * sizeof(*tmp));
+      if (!tmp) return ZI_E_OOM;
+    }
+    for (uint32_t ai = 0; ai < n; ai++) tmp[ai] = vals[src[ai]];
+    for (uint32_t ai = 0; ai < n; ai++) vals[dst[ai]] = tmp[ai];
+    if (tmp != tmp_small) free(tmp);
+    TX_JUMP(t->x.t[0]);
+  }
+  TX_OP(CBR) {
+    const sir_value_t cv = vals[t->a];
+    if (cv.kind != SIR_VAL_BOOL) return ZI_E_INVALID;
+    TX_JUMP(cv.u.b ? t->x.t[0] : t->x.t[1]);
+  }
+  TX_OP(CBR_T) {
+    TX_JUMP(vals[t->a].u.b ? t->x.t[0] : t->x.t[1]);
+  }
+  TX_OP(SWITCH) {
+    const sir_value_t sv = vals[t->a];
+    if (sv.kind != SIR_VAL_I32) return ZI_E_INVALID;
+    const uint32_t n = t->i->u.sw.case_count;
+    const int32_t* lits = t->i->u.sw.case_lits;
+    uint32_t next_ip = t->i->u.sw.default_ip;
+    for (uint32_t ci = 0; ci < n; ci++) {
+      if (sv.u.i32 == lits[ci]) {
+        next_ip = t->i->u.sw.case_target[ci];
         break;
       }
-      case SIR_INST_MEM_COPY: {
-        const sir_val_id_t dst_id = i->u.mem_copy.dst;
-        const sir_val_id_t src_id = i->u.mem_copy.src;
-        const sir_val_id_t len_id = i->u.mem_copy.len;
-        if (dst_id >= f->value_count || src_id >= f->value_count || len_id >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t dv = vals[dst_id];
-        const sir_value_t sv = vals[src_id];
-        const sir_value_t lv = vals[len_id];
-        if (dv.kind != SIR_VAL_PTR || sv.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        int64_t ll = 0;
-        if (lv.kind == SIR_VAL_I64) ll = lv.u.i64;
-        else if (lv.kind == SIR_VAL_I32) ll = lv.u.i32;
-        else {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (ll < 0 || ll > 0x7FFFFFFFll) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t n = (uint32_t)ll;
-        if (n == 0) {
-          ip++;
-          break;
-        }
+    }
+    TX_JUMP(code + next_ip);
+  }
 
-        if (!i->u.mem_copy.overlap_allow) {
-          const zi_ptr_t da = dv.u.ptr;
-          const zi_ptr_t sa = sv.u.ptr;
-          const zi_ptr_t da_end = (zi_ptr_t)(da + (zi_ptr_t)n);
-          const zi_ptr_t sa_end = (zi_ptr_t)(sa + (zi_ptr_t)n);
-          const bool overlap = (da < sa_end) && (sa < da_end);
-          if (overlap) {
-            free(vals);
-            // deterministic trap (align with term.trap in SEM: exit code 255)
-            return 256;
-          }
-        }
+  TX_OP(CALL_EXTERN) {
+    const int32_t r = exec_call_extern(m, mem, x->host, exec_hostcall(x, t->i->u.call_extern.callee), fid, t->ip, sink, t->i, vals, f->value_count);
+    if (r < 0) return r;
+    TX_NEXT();
+  }
+  TX_OP(CALL_FUNC) {
+    const sir_inst_t* i = t->i;
+    sir_value_t argv[16];
+    for (uint32_t ai = 0; ai < i->u.call_func.arg_count; ai++) argv[ai] = vals[i->u.call_func.args[ai]];
+    sir_value_t resv[2];
+    memset(resv, 0, sizeof(resv));
+    const int32_t r = x->tier ? tier_call(x, i->u.call_func.callee, argv, i->u.call_func.arg_count, resv, i->result_count, depth + 1)
+                              : tx_func(x, i->u.call_func.callee, argv, i->u.call_func.arg_count, resv, i->result_count, depth + 1);
+    if (r < 0) return r;
+    if (r == 0) {
+      for (uint8_t ri = 0; ri < i->result_count; ri++) vals[i->results[ri]] = resv[ri];
+    }
+    TX_NEXT();
+  }
+  TX_OP(CALL_FUNC_PTR) {
+    const sir_inst_t* i = t->i;
+    const sir_value_t cv = vals[i->u.call_func_ptr.callee_ptr];
+    if (cv.kind != SIR_VAL_PTR) return ZI_E_INVALID;
+    // The target is only known now, so its signature is checked here (once
+    // per target and site, through the inline cache).
+    sir_func_id_t callee = 0;
+    const int32_t resolve_rc = exec_resolve_func_ptr(m, t->x.ic, i, cv.u.ptr, &callee);
+    if (resolve_rc != 0) return resolve_rc;
+    sir_value_t argv[16];
+    for (uint32_t ai = 0; ai < i->u.call_func_ptr.arg_count; ai++) argv[ai] = vals[i->u.call_func_ptr.args[ai]];
+    sir_value_t resv[2];
+    memset(resv, 0, sizeof(resv));
+    const int32_t r = x->tier ? tier_call(x, callee, argv, i->u.call_func_ptr.arg_count, resv, i->result_count, depth + 1)
+                              : tx_func(x, callee, argv, i->u.call_func_ptr.arg_count, resv, i->result_count, depth + 1);
+    if (r < 0) return r;
+    if (r == 0) {
+      for (uint8_t ri = 0; ri < i->result_count; ri++) vals[i->results[ri]] = resv[ri];
+    }
+    TX_NEXT();
+  }
+  TX_OP(RET) {
+    if (out_results && out_result_count) return ZI_E_INVALID;
+    return 0;
+  }
+  TX_OP(RET_VAL) {
+    if (out_result_count != 1 || !out_results) return ZI_E_INVALID;
+    out_results[0] = vals[t->a];
+    return 0;
+  }
 
-        const uint8_t* r = NULL;
-        uint8_t* w = NULL;
-        if (!sem_guest_mem_map_ro(mem, sv.u.ptr, (zi_size32_t)n, &r) || !r) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (!sem_guest_mem_map_rw(mem, dv.u.ptr, (zi_size32_t)n, &w) || !w) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        memmove(w, r, n);
-        ip++;
-        break;
+#if !SIR_EXEC_THREADED
+    default:
+      break;
+  }
+#endif
+  return ZI_E_INTERNAL;
+
+#undef TX_CONST_THEN
+#undef TX_PTR_OFFSET_LOAD
+#undef TX_PTR_OFFSET_BODY
+#undef TX_STORE_TYPED
+#undef TX_STORE_BODY
+#undef TX_LOAD_STORE
+#undef TX_LOAD_TYPED
+#undef TX_LOAD
+#undef TX_LOAD_BODY
+#undef TX_MAP
+#undef TX_UNARY_TYPED
+#undef TX_UNARY
+#undef TX_UNARY_BODY
+#undef TX_F64_BIN
+#undef TX_F32_BIN
+#undef TX_F_BIN_BODY
+#undef TX_I64_CMP
+#undef TX_I64_CMP_BODY
+#undef TX_I64_BIN
+#undef TX_I64_BIN_BODY
+#undef TX_I32_CMP_CBR
+#undef TX_I32_CMP
+#undef TX_I32_CMP_BODY
+#undef TX_I32_BIN
+#undef TX_I32_BIN_BODY
+#undef TX_JUMP
+#undef TX_NEXT
+#undef TX_CHAIN
+#undef TX_DISPATCH
+#undef TX_STEP
+#undef TX_OP
+}
+
+#if SIR_EXEC_THREADED
+#pragma GCC diagnostic pop
+#endif
+
+static uint64_t tx_align_mask(uint32_t align) {
+  return align > 1u ? (uint64_t)align - 1u : 0u;
+}
+
+// Static slot kinds. Each slot starts UNSET and joins the kind of every
+// value written to it; a slot written with two different kinds (or with
+// something whose kind isn't known statically: params, call results) becomes
+// MIXED. A slot that ends with a single kind holds that kind for the whole
+// frame, so its tag can be stamped once by the frame template and handlers
+// that only touch such slots need neither kind checks nor tag stores.
+#define SIR_SLOT_UNSET 0u
+#define SIR_SLOT_MIXED 0xFFu
+
+static bool tx_kind_join(uint8_t* kinds, uint32_t vc, sir_val_id_t slot, uint8_t k) {
+  if (slot >= vc) return false;
+  const uint8_t cur = kinds[slot];
+  const uint8_t next = (cur == SIR_SLOT_UNSET || cur == k) ? k : (uint8_t)SIR_SLOT_MIXED;
+  if (next == cur) return false;
+  kinds[slot] = next;
+  return true;
+}
+
+// Slot-to-slot copies (select, branch args). Sources that nothing ever writes
+// hold an untagged zero, so they poison the destination; sources still UNSET
+// mid-fixpoint contribute nothing yet.
+static bool tx_kind_copy(uint8_t* kinds, const uint8_t* written, uint32_t vc, sir_val_id_t dst, sir_val_id_t src) {
+  if (src >= vc) return tx_kind_join(kinds, vc, dst, SIR_SLOT_MIXED);
+  if (!written[src]) return tx_kind_join(kinds, vc, dst, SIR_SLOT_MIXED);
+  if (kinds[src] == SIR_SLOT_UNSET) return false;
+  return tx_kind_join(kinds, vc, dst, kinds[src]);
+}
+
+// Applies the writes of one instruction. With `written` == NULL nothing is
+// joined yet: every destination is only recorded in `out_written`.
+static bool tx_kind_step(const sir_inst_t* i, uint8_t* kinds, const uint8_t* written, uint8_t* out_written, uint32_t vc) {
+  bool changed = false;
+#define TX_DEF(slot, k)                                         \
+  do {                                                          \
+    const sir_val_id_t s_ = (slot);                             \
+    if (!written) {                                             \
+      if (s_ < vc) out_written[s_] = 1;                         \
+    } else {                                                    \
+      changed |= tx_kind_join(kinds, vc, s_, (uint8_t)(k));     \
+    }                                                           \
+  } while (0)
+#define TX_COPY(dst, src)                                               \
+  do {                                                                  \
+    if (!written) {                                                     \
+      if ((dst) < vc) out_written[(dst)] = 1;                           \
+    } else {                                                            \
+      changed |= tx_kind_copy(kinds, written, vc, (dst), (src));        \
+    }                                                                   \
+  } while (0)
+  switch (i->k) {
+    case SIR_INST_CONST_I1:
+      TX_DEF(i->u.const_i1.dst, SIR_VAL_I1);
+      break;
+    case SIR_INST_CONST_I8:
+      TX_DEF(i->u.const_i8.dst, SIR_VAL_I8);
+      break;
+    case SIR_INST_CONST_I16:
+      TX_DEF(i->u.const_i16.dst, SIR_VAL_I16);
+      break;
+    case SIR_INST_CONST_I32:
+      TX_DEF(i->u.const_i32.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_CONST_I64:
+      TX_DEF(i->u.const_i64.dst, SIR_VAL_I64);
+      break;
+    case SIR_INST_CONST_BOOL:
+      TX_DEF(i->u.const_bool.dst, SIR_VAL_BOOL);
+      break;
+    case SIR_INST_CONST_F32:
+      TX_DEF(i->u.const_f32.dst, SIR_VAL_F32);
+      break;
+    case SIR_INST_CONST_F64:
+      TX_DEF(i->u.const_f64.dst, SIR_VAL_F64);
+      break;
+    case SIR_INST_CONST_PTR:
+      TX_DEF(i->u.const_ptr.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_CONST_PTR_NULL:
+      TX_DEF(i->u.const_null.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_CONST_BYTES:
+      TX_DEF(i->u.const_bytes.dst_ptr, SIR_VAL_PTR);
+      TX_DEF(i->u.const_bytes.dst_len, SIR_VAL_I64);
+      break;
+    case SIR_INST_I32_ADD:
+    case SIR_INST_I32_SUB:
+    case SIR_INST_I32_MUL:
+    case SIR_INST_I32_AND:
+    case SIR_INST_I32_OR:
+    case SIR_INST_I32_XOR:
+    case SIR_INST_I32_SHL:
+    case SIR_INST_I32_SHR_S:
+    case SIR_INST_I32_SHR_U:
+    case SIR_INST_I32_DIV_S_SAT:
+    case SIR_INST_I32_DIV_S_TRAP:
+    case SIR_INST_I32_DIV_U_SAT:
+    case SIR_INST_I32_REM_S_SAT:
+    case SIR_INST_I32_REM_U_SAT:
+      TX_DEF(i->u.i32_add.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_I32_NOT:
+    case SIR_INST_I32_NEG:
+      TX_DEF(i->u.i32_un.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_I32_CMP_EQ:
+    case SIR_INST_I32_CMP_NE:
+    case SIR_INST_I32_CMP_SLT:
+    case SIR_INST_I32_CMP_SLE:
+    case SIR_INST_I32_CMP_SGT:
+    case SIR_INST_I32_CMP_SGE:
+    case SIR_INST_I32_CMP_ULT:
+    case SIR_INST_I32_CMP_ULE:
+    case SIR_INST_I32_CMP_UGT:
+    case SIR_INST_I32_CMP_UGE:
+      TX_DEF(i->u.i32_cmp_eq.dst, SIR_VAL_BOOL);
+      break;
+    case SIR_INST_I64_ADD:
+    case SIR_INST_I64_SUB:
+    case SIR_INST_I64_MUL:
+    case SIR_INST_I64_AND:
+    case SIR_INST_I64_OR:
+    case SIR_INST_I64_XOR:
+    case SIR_INST_I64_SHL:
+    case SIR_INST_I64_SHR_S:
+    case SIR_INST_I64_SHR_U:
+    case SIR_INST_I64_DIV_S_SAT:
+    case SIR_INST_I64_DIV_S_TRAP:
+    case SIR_INST_I64_DIV_U_SAT:
+    case SIR_INST_I64_REM_S_SAT:
+    case SIR_INST_I64_REM_U_SAT:
+      TX_DEF(i->u.i64_bin.dst, SIR_VAL_I64);
+      break;
+    case SIR_INST_I64_CMP_EQ:
+    case SIR_INST_I64_CMP_NE:
+    case SIR_INST_I64_CMP_SLT:
+    case SIR_INST_I64_CMP_SLE:
+    case SIR_INST_I64_CMP_SGT:
+    case SIR_INST_I64_CMP_SGE:
+    case SIR_INST_I64_CMP_ULT:
+    case SIR_INST_I64_CMP_ULE:
+    case SIR_INST_I64_CMP_UGT:
+    case SIR_INST_I64_CMP_UGE:
+      TX_DEF(i->u.i64_bin.dst, SIR_VAL_BOOL);
+      break;
+    case SIR_INST_F32_ADD:
+    case SIR_INST_F32_SUB:
+    case SIR_INST_F32_MUL:
+    case SIR_INST_F32_DIV:
+      TX_DEF(i->u.f_bin.dst, SIR_VAL_F32);
+      break;
+    case SIR_INST_F64_ADD:
+    case SIR_INST_F64_SUB:
+    case SIR_INST_F64_MUL:
+    case SIR_INST_F64_DIV:
+      TX_DEF(i->u.f_bin.dst, SIR_VAL_F64);
+      break;
+    case SIR_INST_F32_CMP_OEQ:
+    case SIR_INST_F32_CMP_ONE:
+    case SIR_INST_F32_CMP_OLT:
+    case SIR_INST_F32_CMP_OLE:
+    case SIR_INST_F32_CMP_OGT:
+    case SIR_INST_F32_CMP_OGE:
+    case SIR_INST_F32_CMP_UEQ:
+    case SIR_INST_F32_CMP_UNE:
+    case SIR_INST_F32_CMP_ULT:
+    case SIR_INST_F32_CMP_ULE:
+    case SIR_INST_F32_CMP_UGT:
+    case SIR_INST_F32_CMP_UGE:
+    case SIR_INST_F64_CMP_OEQ:
+    case SIR_INST_F64_CMP_ONE:
+    case SIR_INST_F64_CMP_OLT:
+    case SIR_INST_F64_CMP_OLE:
+    case SIR_INST_F64_CMP_OGT:
+    case SIR_INST_F64_CMP_OGE:
+    case SIR_INST_F64_CMP_UEQ:
+    case SIR_INST_F64_CMP_UNE:
+    case SIR_INST_F64_CMP_ULT:
+    case SIR_INST_F64_CMP_ULE:
+    case SIR_INST_F64_CMP_UGT:
+    case SIR_INST_F64_CMP_UGE:
+      TX_DEF(i->u.f_cmp.dst, SIR_VAL_BOOL);
+      break;
+    case SIR_INST_I32_TRUNC_SAT_F32_S:
+    case SIR_INST_I32_TRUNC_SAT_F32_U:
+    case SIR_INST_I32_TRUNC_SAT_F64_S:
+    case SIR_INST_I32_TRUNC_SAT_F64_U:
+      TX_DEF(i->u.num_un.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_I64_NOT:
+    case SIR_INST_I64_NEG:
+    case SIR_INST_I64_SEXT_I32:
+    case SIR_INST_I64_TRUNC_SAT_F32_S:
+    case SIR_INST_I64_TRUNC_SAT_F32_U:
+    case SIR_INST_I64_TRUNC_SAT_F64_S:
+    case SIR_INST_I64_TRUNC_SAT_F64_U:
+      TX_DEF(i->u.num_un.dst, SIR_VAL_I64);
+      break;
+    case SIR_INST_F32_NEG:
+    case SIR_INST_F32_FROM_I32_S:
+    case SIR_INST_F32_FROM_I32_U:
+    case SIR_INST_F32_FROM_I64_S:
+    case SIR_INST_F32_FROM_I64_U:
+    case SIR_INST_F32_DEMOTE_F64:
+      TX_DEF(i->u.num_un.dst, SIR_VAL_F32);
+      break;
+    case SIR_INST_F64_NEG:
+    case SIR_INST_F64_FROM_I32_S:
+    case SIR_INST_F64_FROM_I32_U:
+    case SIR_INST_F64_FROM_I64_S:
+    case SIR_INST_F64_FROM_I64_U:
+    case SIR_INST_F64_PROMOTE_F32:
+      TX_DEF(i->u.num_un.dst, SIR_VAL_F64);
+      break;
+    case SIR_INST_GLOBAL_ADDR:
+      TX_DEF(i->u.global_addr.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_PTR_OFFSET:
+      TX_DEF(i->u.ptr_offset.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_PTR_ADD:
+      TX_DEF(i->u.ptr_add.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_PTR_SUB:
+      TX_DEF(i->u.ptr_sub.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_PTR_CMP_EQ:
+    case SIR_INST_PTR_CMP_NE:
+      TX_DEF(i->u.ptr_cmp.dst, SIR_VAL_BOOL);
+      break;
+    case SIR_INST_PTR_TO_I64:
+      TX_DEF(i->u.ptr_to_i64.dst, SIR_VAL_I64);
+      break;
+    case SIR_INST_PTR_FROM_I64:
+      TX_DEF(i->u.ptr_from_i64.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_BOOL_NOT:
+      TX_DEF(i->u.bool_not.dst, SIR_VAL_BOOL);
+      break;
+    case SIR_INST_BOOL_AND:
+    case SIR_INST_BOOL_OR:
+    case SIR_INST_BOOL_XOR:
+      TX_DEF(i->u.bool_bin.dst, SIR_VAL_BOOL);
+      break;
+    case SIR_INST_I32_ZEXT_I8:
+      TX_DEF(i->u.i32_zext_i8.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_I32_ZEXT_I16:
+      TX_DEF(i->u.i32_zext_i16.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_I64_ZEXT_I32:
+      TX_DEF(i->u.i64_zext_i32.dst, SIR_VAL_I64);
+      break;
+    case SIR_INST_I32_TRUNC_I64:
+      TX_DEF(i->u.i32_trunc_i64.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_SELECT:
+      TX_COPY(i->u.select.dst, i->u.select.a);
+      TX_COPY(i->u.select.dst, i->u.select.b);
+      break;
+    case SIR_INST_BR:
+      if (i->u.br.src_slots && i->u.br.dst_slots) {
+        for (uint32_t ai = 0; ai < i->u.br.arg_count; ai++) TX_COPY(i->u.br.dst_slots[ai], i->u.br.src_slots[ai]);
       }
-      case SIR_INST_MEM_FILL: {
-        const sir_val_id_t dst_id = i->u.mem_fill.dst;
-        const sir_val_id_t byte_id = i->u.mem_fill.byte;
-        const sir_val_id_t len_id = i->u.mem_fill.len;
-        if (dst_id >= f->value_count || byte_id >= f->value_count || len_id >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t dv = vals[dst_id];
-        const sir_value_t bv = vals[byte_id];
-        const sir_value_t lv = vals[len_id];
-        if (dv.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        uint8_t byte = 0;
-        if (bv.kind == SIR_VAL_I8) byte = bv.u.u8;
-        else if (bv.kind == SIR_VAL_I32) byte = (uint8_t)bv.u.i32;
-        else {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        int64_t ll = 0;
-        if (lv.kind == SIR_VAL_I64) ll = lv.u.i64;
-        else if (lv.kind == SIR_VAL_I32) ll = lv.u.i32;
-        else {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (ll < 0 || ll > 0x7FFFFFFFll) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t n = (uint32_t)ll;
-        if (n == 0) {
-          ip++;
-          break;
-        }
-        uint8_t* w = NULL;
-        if (!sem_guest_mem_map_rw(mem, dv.u.ptr, (zi_size32_t)n, &w) || !w) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        memset(w, (int)byte, n);
-        ip++;
-        break;
+      break;
+    case SIR_INST_ATOMIC_RMW_I8:
+    case SIR_INST_ATOMIC_RMW_I16:
+    case SIR_INST_ATOMIC_RMW_I32:
+    case SIR_INST_ATOMIC_RMW_I64:
+      TX_DEF(i->u.atomic_rmw.dst_old, SIR_SLOT_MIXED);
+      break;
+    case SIR_INST_ATOMIC_CMPXCHG_I64:
+      TX_DEF(i->u.atomic_cmpxchg_i64.dst_old, SIR_VAL_I64);
+      break;
+    case SIR_INST_ALLOCA:
+      TX_DEF(i->u.alloca_.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_LOAD_I8:
+      TX_DEF(i->u.load.dst, SIR_VAL_I8);
+      break;
+    case SIR_INST_LOAD_I16:
+      TX_DEF(i->u.load.dst, SIR_VAL_I16);
+      break;
+    case SIR_INST_LOAD_I32:
+      TX_DEF(i->u.load.dst, SIR_VAL_I32);
+      break;
+    case SIR_INST_LOAD_I64:
+      TX_DEF(i->u.load.dst, SIR_VAL_I64);
+      break;
+    case SIR_INST_LOAD_PTR:
+      TX_DEF(i->u.load.dst, SIR_VAL_PTR);
+      break;
+    case SIR_INST_LOAD_F32:
+      TX_DEF(i->u.load.dst, SIR_VAL_F32);
+      break;
+    case SIR_INST_LOAD_F64:
+      TX_DEF(i->u.load.dst, SIR_VAL_F64);
+      break;
+    case SIR_INST_CALL_EXTERN:
+    case SIR_INST_CALL_FUNC:
+    case SIR_INST_CALL_FUNC_PTR:
+      for (uint8_t ri = 0; ri < i->result_count && ri < 2; ri++) TX_DEF(i->results[ri], SIR_SLOT_MIXED);
+      break;
+    case SIR_INST_CBR:
+    case SIR_INST_SWITCH:
+    case SIR_INST_MEM_COPY:
+    case SIR_INST_MEM_FILL:
+    case SIR_INST_VEC_SPLAT_I32:
+    case SIR_INST_VEC_SPLAT_BOOL:
+    case SIR_INST_VEC_I32_ADD:
+    case SIR_INST_VEC_I32_CMP_EQ:
+    case SIR_INST_VEC_I32_CMP_SLT:
+    case SIR_INST_VEC_SELECT_I32:
+    case SIR_INST_STORE_I8:
+    case SIR_INST_STORE_I16:
+    case SIR_INST_STORE_I32:
+    case SIR_INST_STORE_I64:
+    case SIR_INST_STORE_PTR:
+    case SIR_INST_STORE_F32:
+    case SIR_INST_STORE_F64:
+    case SIR_INST_RET:
+    case SIR_INST_RET_VAL:
+    case SIR_INST_EXIT:
+    case SIR_INST_EXIT_VAL:
+      break;
+    default:
+      // Unknown writes: trust nothing.
+      if (written) {
+        for (uint32_t si = 0; si < vc; si++) changed |= tx_kind_join(kinds, vc, si, SIR_SLOT_MIXED);
       }
-      case SIR_INST_ATOMIC_RMW_I8:
-      case SIR_INST_ATOMIC_RMW_I16:
-      case SIR_INST_ATOMIC_RMW_I32:
-      case SIR_INST_ATOMIC_RMW_I64: {
-        const sir_val_id_t a = i->u.atomic_rmw.addr;
-        const sir_val_id_t v = i->u.atomic_rmw.value;
-        const sir_val_id_t dst = i->u.atomic_rmw.dst_old;
-        if (a >= f->value_count || v >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        if (av.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t align = i->u.atomic_rmw.align ? i->u.atomic_rmw.align : 1u;
-        if (!is_pow2_u32(align)) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (align > 1u) {
-          const uint64_t addr = (uint64_t)av.u.ptr;
-          if ((addr & (uint64_t)(align - 1u)) != 0ull) {
-            free(vals);
-            return 256;
-          }
-        }
+      break;
+  }
+#undef TX_COPY
+#undef TX_DEF
+  return changed;
+}
+
+// Fills kinds[0..value_count) with a sir_val_kind_t per slot, or UNSET/MIXED.
+static bool tx_infer_kinds(const sir_func_t* f, uint8_t* kinds) {
+  const uint32_t vc = f->value_count;
+  uint8_t* written = (uint8_t*)calloc(vc ? vc : 1u, 1);
+  if (!written) return false;
+  memset(kinds, SIR_SLOT_UNSET, vc);
+  // Params take whatever kinds the caller passes.
+  for (uint32_t pi = 0; pi < f->sig.param_count && pi < vc; pi++) {
+    written[pi] = 1;
+    kinds[pi] = SIR_SLOT_MIXED;
+  }
+  for (uint32_t ip = 0; ip < f->inst_count; ip++) (void)tx_kind_step(&f->insts[ip], kinds, NULL, written, vc);
+  for (;;) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (uint32_t ip = 0; ip < f->inst_count; ip++) changed |= tx_kind_step(&f->insts[ip], kinds, written, NULL, vc);
+    }
+    // Slots only ever fed by copy cycles never get a real value.
+    bool fixed = false;
+    for (uint32_t si = 0; si < vc; si++) {
+      if (written[si] && kinds[si] == SIR_SLOT_UNSET) {
+        kinds[si] = SIR_SLOT_MIXED;
+        fixed = true;
+      }
+    }
+    if (!fixed) break;
+  }
+  free(written);
+  return true;
+}
+
+static bool tx_slot_is(const uint8_t* kinds, uint32_t vc, sir_val_id_t slot, sir_val_kind_t k) {
+  return kinds && slot < vc && kinds[slot] == (uint8_t)k;
+}
+
+// Switches a decoded instruction to its typed variant when the frame layout
+// proves the kinds its checked form would test.
+static void tx_select_typed(sir_tinst_t* t, const uint8_t* kinds, uint32_t vc) {
+  bool typed = false;
+  switch (t->top) {
+    case SIR_TOP_I32_ADD:
+    case SIR_TOP_I32_SUB:
+    case SIR_TOP_I32_MUL:
+    case SIR_TOP_I32_AND:
+    case SIR_TOP_I32_OR:
+    case SIR_TOP_I32_XOR:
+    case SIR_TOP_I32_SHL:
+    case SIR_TOP_I32_SHR_S:
+    case SIR_TOP_I32_SHR_U:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_I32) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I32) && tx_slot_is(kinds, vc, t->c, SIR_VAL_I32);
+      break;
+    case SIR_TOP_I32_NOT:
+    case SIR_TOP_I32_NEG:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_I32) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I32);
+      break;
+    case SIR_TOP_I32_CMP_EQ:
+    case SIR_TOP_I32_CMP_NE:
+    case SIR_TOP_I32_CMP_SLT:
+    case SIR_TOP_I32_CMP_SLE:
+    case SIR_TOP_I32_CMP_SGT:
+    case SIR_TOP_I32_CMP_SGE:
+    case SIR_TOP_I32_CMP_ULT:
+    case SIR_TOP_I32_CMP_ULE:
+    case SIR_TOP_I32_CMP_UGT:
+    case SIR_TOP_I32_CMP_UGE:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_I32) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I32) && tx_slot_is(kinds, vc, t->c, SIR_VAL_BOOL);
+      break;
+    case SIR_TOP_I64_ADD:
+    case SIR_TOP_I64_SUB:
+    case SIR_TOP_I64_MUL:
+    case SIR_TOP_I64_AND:
+    case SIR_TOP_I64_OR:
+    case SIR_TOP_I64_XOR:
+    case SIR_TOP_I64_SHL:
+    case SIR_TOP_I64_SHR_S:
+    case SIR_TOP_I64_SHR_U:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_I64) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I64) && tx_slot_is(kinds, vc, t->c, SIR_VAL_I64);
+      break;
+    case SIR_TOP_I64_NOT:
+    case SIR_TOP_I64_NEG:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_I64) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I64);
+      break;
+    case SIR_TOP_I64_CMP_EQ:
+    case SIR_TOP_I64_CMP_NE:
+    case SIR_TOP_I64_CMP_SLT:
+    case SIR_TOP_I64_CMP_SLE:
+    case SIR_TOP_I64_CMP_SGT:
+    case SIR_TOP_I64_CMP_SGE:
+    case SIR_TOP_I64_CMP_ULT:
+    case SIR_TOP_I64_CMP_ULE:
+    case SIR_TOP_I64_CMP_UGT:
+    case SIR_TOP_I64_CMP_UGE:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_I64) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I64) && tx_slot_is(kinds, vc, t->c, SIR_VAL_BOOL);
+      break;
+    case SIR_TOP_F32_ADD:
+    case SIR_TOP_F32_SUB:
+    case SIR_TOP_F32_MUL:
+    case SIR_TOP_F32_DIV:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_F32) && tx_slot_is(kinds, vc, t->b, SIR_VAL_F32) && tx_slot_is(kinds, vc, t->c, SIR_VAL_F32);
+      break;
+    case SIR_TOP_F64_ADD:
+    case SIR_TOP_F64_SUB:
+    case SIR_TOP_F64_MUL:
+    case SIR_TOP_F64_DIV:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_F64) && tx_slot_is(kinds, vc, t->b, SIR_VAL_F64) && tx_slot_is(kinds, vc, t->c, SIR_VAL_F64);
+      break;
+    case SIR_TOP_LOAD_I32:
+    case SIR_TOP_STORE_I32:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_PTR) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I32);
+      break;
+    case SIR_TOP_LOAD_I64:
+    case SIR_TOP_STORE_I64:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_PTR) && tx_slot_is(kinds, vc, t->b, SIR_VAL_I64);
+      break;
+    case SIR_TOP_LOAD_PTR:
+    case SIR_TOP_STORE_PTR:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_PTR) && tx_slot_is(kinds, vc, t->b, SIR_VAL_PTR);
+      break;
+    case SIR_TOP_CBR:
+      typed = tx_slot_is(kinds, vc, t->a, SIR_VAL_BOOL);
+      break;
+    default:
+      break;
+  }
+  // Typed variants directly follow their checked form in SIR_TOP_LIST.
+  if (typed) t->top = (sir_top_t)(t->top + 1);
+}
+
+// Fused handler for `t` followed by `u`, or t->top. The pairs are the ones
+// sir_pair_profile_* reports hottest on lowered code: compare + branch,
+// constant + use, address + load, and load + store field copies.
+static sir_top_t tx_fused_top(const sir_tinst_t* t, const sir_tinst_t* u) {
+  const bool cbr_on_t = (u->top == SIR_TOP_CBR || u->top == SIR_TOP_CBR_T) && u->a == t->c;
+#define TX_FUSE_CMP(n) \
+  case SIR_TOP_##n##_T: \
+    return cbr_on_t ? SIR_TOP_##n##_CBR : t->top;
+#define TX_FUSE_NEXT(next, fused) \
+  if (u->top == SIR_TOP_##next) return SIR_TOP_##fused
+  switch (t->top) {
+    TX_FUSE_CMP(I32_CMP_EQ)
+    TX_FUSE_CMP(I32_CMP_NE)
+    TX_FUSE_CMP(I32_CMP_SLT)
+    TX_FUSE_CMP(I32_CMP_SLE)
+    TX_FUSE_CMP(I32_CMP_SGT)
+    TX_FUSE_CMP(I32_CMP_SGE)
+    TX_FUSE_CMP(I32_CMP_ULT)
+    TX_FUSE_CMP(I32_CMP_ULE)
+    TX_FUSE_CMP(I32_CMP_UGT)
+    TX_FUSE_CMP(I32_CMP_UGE)
+    case SIR_TOP_CONST:
+      TX_FUSE_NEXT(I32_ADD_T, CONST_I32_ADD_T);
+      TX_FUSE_NEXT(I32_SUB_T, CONST_I32_SUB_T);
+      TX_FUSE_NEXT(I32_CMP_EQ_CBR, CONST_I32_CMP_EQ_CBR);
+      TX_FUSE_NEXT(I32_CMP_NE_CBR, CONST_I32_CMP_NE_CBR);
+      TX_FUSE_NEXT(I32_CMP_SLT_CBR, CONST_I32_CMP_SLT_CBR);
+      TX_FUSE_NEXT(I32_CMP_ULT_CBR, CONST_I32_CMP_ULT_CBR);
+      break;
+    case SIR_TOP_PTR_OFFSET:
+      TX_FUSE_NEXT(LOAD_I8, PTR_OFFSET_LOAD_I8);
+      TX_FUSE_NEXT(LOAD_I32, PTR_OFFSET_LOAD_I32);
+      TX_FUSE_NEXT(LOAD_I32_T, PTR_OFFSET_LOAD_I32_T);
+      TX_FUSE_NEXT(LOAD_I64, PTR_OFFSET_LOAD_I64);
+      TX_FUSE_NEXT(LOAD_I64_T, PTR_OFFSET_LOAD_I64_T);
+      TX_FUSE_NEXT(LOAD_PTR, PTR_OFFSET_LOAD_PTR);
+      TX_FUSE_NEXT(LOAD_PTR_T, PTR_OFFSET_LOAD_PTR_T);
+      break;
+    case SIR_TOP_LOAD_I32:
+      TX_FUSE_NEXT(STORE_I32, LOAD_I32_STORE_I32);
+      break;
+    case SIR_TOP_LOAD_I32_T:
+      TX_FUSE_NEXT(STORE_I32_T, LOAD_I32_T_STORE_I32_T);
+      break;
+    case SIR_TOP_LOAD_I64:
+      TX_FUSE_NEXT(STORE_I64, LOAD_I64_STORE_I64);
+      break;
+    case SIR_TOP_LOAD_I64_T:
+      TX_FUSE_NEXT(STORE_I64_T, LOAD_I64_T_STORE_I64_T);
+      break;
+    case SIR_TOP_LOAD_PTR:
+      TX_FUSE_NEXT(STORE_PTR, LOAD_PTR_STORE_PTR);
+      break;
+    case SIR_TOP_LOAD_PTR_T:
+      TX_FUSE_NEXT(STORE_PTR_T, LOAD_PTR_T_STORE_PTR_T);
+      break;
+    default:
+      break;
+  }
+#undef TX_FUSE_NEXT
+#undef TX_FUSE_CMP
+  return t->top;
+}
+
+// Replaces instruction pairs with fused handlers: the first half's handler
+// continues straight into the second's instead of dispatching, halving the
+// dispatches for the pair. The second entry keeps its own handler, so
+// branches into it are unaffected. Runs back to front so that a fused second
+// half can itself be chained to (const + compare + branch).
+static void tx_fuse(sir_tinst_t* code, uint32_t n) {
+  for (uint32_t ip = n; ip-- > 0;) code[ip].top = tx_fused_top(&code[ip], &code[ip + 1u]);
+}
+
+static void tx_decode_inst(const sir_inst_t* i, const sir_tinst_t* code, uint32_t count, sir_tinst_t* t) {
+  // Targets are validated to be < inst_count before anything runs; clamping
+  // just keeps the decoded stream self-contained for unvalidated modules.
+#define TX_TARGET(ip) (&code[(ip) < count ? (ip) : count])
+  t->top = SIR_TOP_GENERIC;
+  switch (i->k) {
+    case SIR_INST_CONST_I1:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_i1.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_I1, .u.u1 = i->u.const_i1.v};
+      break;
+    case SIR_INST_CONST_I8:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_i8.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_I8, .u.u8 = i->u.const_i8.v};
+      break;
+    case SIR_INST_CONST_I16:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_i16.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_I16, .u.u16 = i->u.const_i16.v};
+      break;
+    case SIR_INST_CONST_I32:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_i32.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = i->u.const_i32.v};
+      break;
+    case SIR_INST_CONST_I64:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_i64.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = i->u.const_i64.v};
+      break;
+    case SIR_INST_CONST_BOOL:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_bool.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_BOOL, .u.b = i->u.const_bool.v};
+      break;
+    case SIR_INST_CONST_F32:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_f32.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_canon_bits(i->u.const_f32.bits)};
+      break;
+    case SIR_INST_CONST_F64:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_f64.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_canon_bits(i->u.const_f64.bits)};
+      break;
+    case SIR_INST_CONST_PTR:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_ptr.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = i->u.const_ptr.v};
+      break;
+    case SIR_INST_CONST_PTR_NULL:
+      t->top = SIR_TOP_CONST;
+      t->a = i->u.const_null.dst;
+      t->x.v = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = 0};
+      break;
+    case SIR_INST_I32_ADD:
+    case SIR_INST_I32_SUB:
+    case SIR_INST_I32_MUL:
+    case SIR_INST_I32_AND:
+    case SIR_INST_I32_OR:
+    case SIR_INST_I32_XOR:
+    case SIR_INST_I32_SHL:
+    case SIR_INST_I32_SHR_S:
+    case SIR_INST_I32_SHR_U:
+      t->top = i->k == SIR_INST_I32_ADD   ? SIR_TOP_I32_ADD
+               : i->k == SIR_INST_I32_SUB ? SIR_TOP_I32_SUB
+               : i->k == SIR_INST_I32_MUL ? SIR_TOP_I32_MUL
+               : i->k == SIR_INST_I32_AND ? SIR_TOP_I32_AND
+               : i->k == SIR_INST_I32_OR  ? SIR_TOP_I32_OR
+               : i->k == SIR_INST_I32_XOR ? SIR_TOP_I32_XOR
+               : i->k == SIR_INST_I32_SHL ? SIR_TOP_I32_SHL
+               : i->k == SIR_INST_I32_SHR_S ? SIR_TOP_I32_SHR_S
+                                            : SIR_TOP_I32_SHR_U;
+      t->a = i->u.i32_add.a;
+      t->b = i->u.i32_add.b;
+      t->c = i->u.i32_add.dst;
+      break;
+    case SIR_INST_I32_NOT:
+    case SIR_INST_I32_NEG:
+      t->top = i->k == SIR_INST_I32_NOT ? SIR_TOP_I32_NOT : SIR_TOP_I32_NEG;
+      t->a = i->u.i32_un.x;
+      t->b = i->u.i32_un.dst;
+      break;
+    case SIR_INST_I32_CMP_EQ:
+    case SIR_INST_I32_CMP_NE:
+    case SIR_INST_I32_CMP_SLT:
+    case SIR_INST_I32_CMP_SLE:
+    case SIR_INST_I32_CMP_SGT:
+    case SIR_INST_I32_CMP_SGE:
+    case SIR_INST_I32_CMP_ULT:
+    case SIR_INST_I32_CMP_ULE:
+    case SIR_INST_I32_CMP_UGT:
+    case SIR_INST_I32_CMP_UGE:
+      t->top = i->k == SIR_INST_I32_CMP_EQ    ? SIR_TOP_I32_CMP_EQ
+               : i->k == SIR_INST_I32_CMP_NE  ? SIR_TOP_I32_CMP_NE
+               : i->k == SIR_INST_I32_CMP_SLT ? SIR_TOP_I32_CMP_SLT
+               : i->k == SIR_INST_I32_CMP_SLE ? SIR_TOP_I32_CMP_SLE
+               : i->k == SIR_INST_I32_CMP_SGT ? SIR_TOP_I32_CMP_SGT
+               : i->k == SIR_INST_I32_CMP_SGE ? SIR_TOP_I32_CMP_SGE
+               : i->k == SIR_INST_I32_CMP_ULT ? SIR_TOP_I32_CMP_ULT
+               : i->k == SIR_INST_I32_CMP_ULE ? SIR_TOP_I32_CMP_ULE
+               : i->k == SIR_INST_I32_CMP_UGT ? SIR_TOP_I32_CMP_UGT
+                                              : SIR_TOP_I32_CMP_UGE;
+      t->a = i->u.i32_cmp_eq.a;
+      t->b = i->u.i32_cmp_eq.b;
+      t->c = i->u.i32_cmp_eq.dst;
+      break;
+    case SIR_INST_I64_ADD:
+    case SIR_INST_I64_SUB:
+    case SIR_INST_I64_MUL:
+    case SIR_INST_I64_AND:
+    case SIR_INST_I64_OR:
+    case SIR_INST_I64_XOR:
+    case SIR_INST_I64_SHL:
+    case SIR_INST_I64_SHR_S:
+    case SIR_INST_I64_SHR_U:
+      t->top = i->k == SIR_INST_I64_ADD ? SIR_TOP_I64_ADD
+               : i->k == SIR_INST_I64_SUB ? SIR_TOP_I64_SUB
+               : i->k == SIR_INST_I64_MUL ? SIR_TOP_I64_MUL
+               : i->k == SIR_INST_I64_AND ? SIR_TOP_I64_AND
+               : i->k == SIR_INST_I64_OR ? SIR_TOP_I64_OR
+               : i->k == SIR_INST_I64_XOR ? SIR_TOP_I64_XOR
+               : i->k == SIR_INST_I64_SHL ? SIR_TOP_I64_SHL
+               : i->k == SIR_INST_I64_SHR_S ? SIR_TOP_I64_SHR_S
+               : SIR_TOP_I64_SHR_U;
+      t->a = i->u.i64_bin.a;
+      t->b = i->u.i64_bin.b;
+      t->c = i->u.i64_bin.dst;
+      break;
+    case SIR_INST_I64_DIV_S_SAT:
+    case SIR_INST_I64_DIV_S_TRAP:
+    case SIR_INST_I64_DIV_U_SAT:
+    case SIR_INST_I64_REM_S_SAT:
+    case SIR_INST_I64_REM_U_SAT:
+      t->top = SIR_TOP_I64_DIV;
+      t->a = i->u.i64_bin.a;
+      t->b = i->u.i64_bin.b;
+      t->c = i->u.i64_bin.dst;
+      break;
+    case SIR_INST_I64_CMP_EQ:
+    case SIR_INST_I64_CMP_NE:
+    case SIR_INST_I64_CMP_SLT:
+    case SIR_INST_I64_CMP_SLE:
+    case SIR_INST_I64_CMP_SGT:
+    case SIR_INST_I64_CMP_SGE:
+    case SIR_INST_I64_CMP_ULT:
+    case SIR_INST_I64_CMP_ULE:
+    case SIR_INST_I64_CMP_UGT:
+    case SIR_INST_I64_CMP_UGE:
+      t->top = i->k == SIR_INST_I64_CMP_EQ ? SIR_TOP_I64_CMP_EQ
+               : i->k == SIR_INST_I64_CMP_NE ? SIR_TOP_I64_CMP_NE
+               : i->k == SIR_INST_I64_CMP_SLT ? SIR_TOP_I64_CMP_SLT
+               : i->k == SIR_INST_I64_CMP_SLE ? SIR_TOP_I64_CMP_SLE
+               : i->k == SIR_INST_I64_CMP_SGT ? SIR_TOP_I64_CMP_SGT
+               : i->k == SIR_INST_I64_CMP_SGE ? SIR_TOP_I64_CMP_SGE
+               : i->k == SIR_INST_I64_CMP_ULT ? SIR_TOP_I64_CMP_ULT
+               : i->k == SIR_INST_I64_CMP_ULE ? SIR_TOP_I64_CMP_ULE
+               : i->k == SIR_INST_I64_CMP_UGT ? SIR_TOP_I64_CMP_UGT
+               : SIR_TOP_I64_CMP_UGE;
+      t->a = i->u.i64_bin.a;
+      t->b = i->u.i64_bin.b;
+      t->c = i->u.i64_bin.dst;
+      break;
+    case SIR_INST_F32_ADD:
+    case SIR_INST_F32_SUB:
+    case SIR_INST_F32_MUL:
+    case SIR_INST_F32_DIV:
+      t->top = i->k == SIR_INST_F32_ADD ? SIR_TOP_F32_ADD
+               : i->k == SIR_INST_F32_SUB ? SIR_TOP_F32_SUB
+               : i->k == SIR_INST_F32_MUL ? SIR_TOP_F32_MUL
+               : SIR_TOP_F32_DIV;
+      t->a = i->u.f_bin.a;
+      t->b = i->u.f_bin.b;
+      t->c = i->u.f_bin.dst;
+      break;
+    case SIR_INST_F64_ADD:
+    case SIR_INST_F64_SUB:
+    case SIR_INST_F64_MUL:
+    case SIR_INST_F64_DIV:
+      t->top = i->k == SIR_INST_F64_ADD ? SIR_TOP_F64_ADD
+               : i->k == SIR_INST_F64_SUB ? SIR_TOP_F64_SUB
+               : i->k == SIR_INST_F64_MUL ? SIR_TOP_F64_MUL
+               : SIR_TOP_F64_DIV;
+      t->a = i->u.f_bin.a;
+      t->b = i->u.f_bin.b;
+      t->c = i->u.f_bin.dst;
+      break;
+    case SIR_INST_F32_CMP_OEQ:
+    case SIR_INST_F32_CMP_ONE:
+    case SIR_INST_F32_CMP_OLT:
+    case SIR_INST_F32_CMP_OLE:
+    case SIR_INST_F32_CMP_OGT:
+    case SIR_INST_F32_CMP_OGE:
+    case SIR_INST_F32_CMP_UEQ:
+    case SIR_INST_F32_CMP_UNE:
+    case SIR_INST_F32_CMP_ULT:
+    case SIR_INST_F32_CMP_ULE:
+    case SIR_INST_F32_CMP_UGT:
+    case SIR_INST_F32_CMP_UGE:
+    case SIR_INST_F64_CMP_OEQ:
+    case SIR_INST_F64_CMP_ONE:
+    case SIR_INST_F64_CMP_OLT:
+    case SIR_INST_F64_CMP_OLE:
+    case SIR_INST_F64_CMP_OGT:
+    case SIR_INST_F64_CMP_OGE:
+    case SIR_INST_F64_CMP_UEQ:
+    case SIR_INST_F64_CMP_UNE:
+    case SIR_INST_F64_CMP_ULT:
+    case SIR_INST_F64_CMP_ULE:
+    case SIR_INST_F64_CMP_UGT:
+    case SIR_INST_F64_CMP_UGE:
+      t->top = num_is_f32_cmp(i->k) ? SIR_TOP_F32_CMP : SIR_TOP_F64_CMP;
+      t->a = i->u.f_cmp.a;
+      t->b = i->u.f_cmp.b;
+      t->c = i->u.f_cmp.dst;
+      break;
+    case SIR_INST_I64_NOT:
+    case SIR_INST_I64_NEG:
+      t->top = i->k == SIR_INST_I64_NOT ? SIR_TOP_I64_NOT : SIR_TOP_I64_NEG;
+      t->a = i->u.num_un.x;
+      t->b = i->u.num_un.dst;
+      break;
+    case SIR_INST_F32_NEG:
+    case SIR_INST_F64_NEG:
+    case SIR_INST_I64_SEXT_I32:
+    case SIR_INST_F32_FROM_I32_S:
+    case SIR_INST_F32_FROM_I32_U:
+    case SIR_INST_F32_FROM_I64_S:
+    case SIR_INST_F32_FROM_I64_U:
+    case SIR_INST_F64_FROM_I32_S:
+    case SIR_INST_F64_FROM_I32_U:
+    case SIR_INST_F64_FROM_I64_S:
+    case SIR_INST_F64_FROM_I64_U:
+    case SIR_INST_I32_TRUNC_SAT_F32_S:
+    case SIR_INST_I32_TRUNC_SAT_F32_U:
+    case SIR_INST_I32_TRUNC_SAT_F64_S:
+    case SIR_INST_I32_TRUNC_SAT_F64_U:
+    case SIR_INST_I64_TRUNC_SAT_F32_S:
+    case SIR_INST_I64_TRUNC_SAT_F32_U:
+    case SIR_INST_I64_TRUNC_SAT_F64_S:
+    case SIR_INST_I64_TRUNC_SAT_F64_U:
+    case SIR_INST_F64_PROMOTE_F32:
+    case SIR_INST_F32_DEMOTE_F64:
+      t->top = SIR_TOP_NUM_UN;
+      t->a = i->u.num_un.x;
+      t->b = i->u.num_un.dst;
+      break;
+    case SIR_INST_BOOL_NOT:
+      t->top = SIR_TOP_BOOL_NOT;
+      t->a = i->u.bool_not.x;
+      t->b = i->u.bool_not.dst;
+      break;
+    case SIR_INST_I32_TRUNC_I64:
+      t->top = SIR_TOP_I32_TRUNC_I64;
+      t->a = i->u.i32_trunc_i64.x;
+      t->b = i->u.i32_trunc_i64.dst;
+      break;
+    case SIR_INST_I32_ZEXT_I8:
+      t->top = SIR_TOP_I32_ZEXT_I8;
+      t->a = i->u.i32_zext_i8.x;
+      t->b = i->u.i32_zext_i8.dst;
+      break;
+    case SIR_INST_I32_ZEXT_I16:
+      t->top = SIR_TOP_I32_ZEXT_I16;
+      t->a = i->u.i32_zext_i16.x;
+      t->b = i->u.i32_zext_i16.dst;
+      break;
+    case SIR_INST_I64_ZEXT_I32:
+      t->top = SIR_TOP_I64_ZEXT_I32;
+      t->a = i->u.i64_zext_i32.x;
+      t->b = i->u.i64_zext_i32.dst;
+      break;
+    case SIR_INST_SELECT:
+      t->top = SIR_TOP_SELECT;
+      t->a = i->u.select.cond;
+      t->b = i->u.select.a;
+      t->c = i->u.select.b;
+      t->d = i->u.select.dst;
+      break;
+    case SIR_INST_GLOBAL_ADDR:
+      t->top = SIR_TOP_GLOBAL_ADDR;
+      t->a = i->u.global_addr.dst;
+      t->b = i->u.global_addr.gid;
+      break;
+    case SIR_INST_PTR_OFFSET:
+      t->top = SIR_TOP_PTR_OFFSET;
+      t->a = i->u.ptr_offset.base;
+      t->b = i->u.ptr_offset.index;
+      t->c = i->u.ptr_offset.dst;
+      t->x.scale = (uint64_t)i->u.ptr_offset.scale;
+      break;
+    case SIR_INST_PTR_ADD:
+      t->top = SIR_TOP_PTR_ADD;
+      t->a = i->u.ptr_add.base;
+      t->b = i->u.ptr_add.off;
+      t->c = i->u.ptr_add.dst;
+      break;
+    case SIR_INST_PTR_SUB:
+      t->top = SIR_TOP_PTR_SUB;
+      t->a = i->u.ptr_sub.base;
+      t->b = i->u.ptr_sub.off;
+      t->c = i->u.ptr_sub.dst;
+      break;
+    case SIR_INST_LOAD_I8:
+    case SIR_INST_LOAD_I16:
+    case SIR_INST_LOAD_I32:
+    case SIR_INST_LOAD_I64:
+    case SIR_INST_LOAD_PTR:
+      t->top = i->k == SIR_INST_LOAD_I8    ? SIR_TOP_LOAD_I8
+               : i->k == SIR_INST_LOAD_I16 ? SIR_TOP_LOAD_I16
+               : i->k == SIR_INST_LOAD_I32 ? SIR_TOP_LOAD_I32
+               : i->k == SIR_INST_LOAD_I64 ? SIR_TOP_LOAD_I64
+                                           : SIR_TOP_LOAD_PTR;
+      t->a = i->u.load.addr;
+      t->b = i->u.load.dst;
+      t->x.align_mask = tx_align_mask(i->u.load.align);
+      break;
+    case SIR_INST_STORE_I8:
+    case SIR_INST_STORE_I32:
+    case SIR_INST_STORE_I64:
+    case SIR_INST_STORE_PTR:
+      t->top = i->k == SIR_INST_STORE_I8    ? SIR_TOP_STORE_I8
+               : i->k == SIR_INST_STORE_I32 ? SIR_TOP_STORE_I32
+               : i->k == SIR_INST_STORE_I64 ? SIR_TOP_STORE_I64
+                                            : SIR_TOP_STORE_PTR;
+      t->a = i->u.store.addr;
+      t->b = i->u.store.value;
+      t->x.align_mask = tx_align_mask(i->u.store.align);
+      break;
+    case SIR_INST_BR:
+      t->top = i->u.br.arg_count ? SIR_TOP_BR_ARGS : SIR_TOP_BR;
+      t->x.t[0] = TX_TARGET(i->u.br.target_ip);
+      break;
+    case SIR_INST_CBR:
+      t->top = SIR_TOP_CBR;
+      t->a = i->u.cbr.cond;
+      t->x.t[0] = TX_TARGET(i->u.cbr.then_ip);
+      t->x.t[1] = TX_TARGET(i->u.cbr.else_ip);
+      break;
+    case SIR_INST_SWITCH:
+      t->top = SIR_TOP_SWITCH;
+      t->a = i->u.sw.scrut;
+      break;
+    case SIR_INST_CALL_EXTERN:
+      t->top = SIR_TOP_CALL_EXTERN;
+      break;
+    case SIR_INST_CALL_FUNC:
+      // Oversized calls keep exec_inst's error path.
+      if (i->u.call_func.arg_count <= 16) t->top = SIR_TOP_CALL_FUNC;
+      break;
+    case SIR_INST_CALL_FUNC_PTR:
+      if (i->u.call_func_ptr.arg_count <= 16) t->top = SIR_TOP_CALL_FUNC_PTR;
+      break;
+    case SIR_INST_RET:
+      t->top = SIR_TOP_RET;
+      break;
+    case SIR_INST_RET_VAL:
+      t->top = SIR_TOP_RET_VAL;
+      t->a = i->u.ret_val.value;
+      break;
+    default:
+      break;
+  }
+#undef TX_TARGET
+}
+
+static void nx_free(sir_ncode_t* nc);
+
+static void tx_free(sir_tfunc_t* tfuncs, uint32_t count) {
+  if (!tfuncs) return;
+  for (uint32_t fi = 0; fi < count; fi++) {
+    free(atomic_load_explicit(&tfuncs[fi].code, memory_order_relaxed));
+    nx_free(atomic_load_explicit(&tfuncs[fi].native, memory_order_relaxed));
+    free(tfuncs[fi].frame0);
+    free(tfuncs[fi].ic);
+    free(tfuncs[fi].ic_ip);
+  }
+  free(tfuncs);
+}
+
+static bool tx_build_icaches(sir_tfunc_t* tf, const sir_func_t* f) {
+  uint32_t n = 0;
+  for (uint32_t ip = 0; ip < f->inst_count; ip++) n += f->insts[ip].k == SIR_INST_CALL_FUNC_PTR;
+  if (!n) return true;
+  tf->ic = (sir_icache_t*)malloc((size_t)n * sizeof(*tf->ic));
+  tf->ic_ip = (uint32_t*)malloc((size_t)n * sizeof(*tf->ic_ip));
+  if (!tf->ic || !tf->ic_ip) return false;
+  for (uint32_t ip = 0; ip < f->inst_count; ip++) {
+    if (f->insts[ip].k != SIR_INST_CALL_FUNC_PTR) continue;
+    sir_icache_t* ic = &tf->ic[tf->ic_count];
+    for (uint32_t w = 0; w < SIR_IC_WAYS; w++) atomic_init(&ic->ptr[w], 0);
+    atomic_init(&ic->victim, 0);
+    tf->ic_ip[tf->ic_count++] = ip;
+  }
+  return true;
+}
+
+// Builds the frame template of every function of a finalized module; code is
+// decoded later, on first use (tx_code). Returns NULL on OOM, in which case
+// runs fall back to the switch engine.
+static sir_tfunc_t* tx_build(const sir_module_t* m) {
+  if (!m || m->func_count == 0) return NULL;
+  sir_tfunc_t* tfuncs = (sir_tfunc_t*)calloc(m->func_count, sizeof(*tfuncs));
+  if (!tfuncs) return NULL;
+  for (uint32_t fi = 0; fi < m->func_count; fi++) {
+    const sir_func_t* f = &m->funcs[fi];
+    atomic_init(&tfuncs[fi].code, NULL);
+    atomic_init(&tfuncs[fi].native, NULL);
+    tfuncs[fi].count = f->inst_count;
+    if (!tx_build_icaches(&tfuncs[fi], f)) {
+      tx_free(tfuncs, m->func_count);
+      return NULL;
+    }
+
+    // Oversized frames are rejected at call time, so they get no template and
+    // no typed handlers.
+    const uint32_t vc = f->value_count;
+    if (vc > 1u << 20) continue;
+    uint8_t* kinds = (uint8_t*)malloc(vc ? vc : 1u);
+    tfuncs[fi].frame0 = (sir_value_t*)calloc(vc ? vc : 1u, sizeof(sir_value_t));
+    if (!kinds || !tfuncs[fi].frame0 || !tx_infer_kinds(f, kinds)) {
+      free(kinds);
+      tx_free(tfuncs, m->func_count);
+      return NULL;
+    }
+    for (uint32_t si = 0; si < vc; si++) {
+      if (kinds[si] != SIR_SLOT_UNSET && kinds[si] != SIR_SLOT_MIXED) tfuncs[fi].frame0[si].kind = (sir_val_kind_t)kinds[si];
+    }
+    free(kinds);
+  }
+  return tfuncs;
+}
+
+// Decodes one function. The frame template already records every slot with a
+// single static kind, so typed variants are selected from it.
+static sir_tinst_t* tx_decode_func(const sir_func_t* f, sir_tfunc_t* tf) {
+  const sir_value_t* frame0 = tf->frame0;
+  const void* const* labels = NULL;
+  (void)tx_loop(NULL, 0, NULL, NULL, 0, NULL, NULL, 0, 0, &labels);
+
+  const uint32_t n = f->inst_count;
+  const uint32_t vc = frame0 ? f->value_count : 0;
+  sir_tinst_t* code = (sir_tinst_t*)calloc((size_t)n + 1u, sizeof(*code));
+  uint8_t* kinds = (uint8_t*)malloc(vc ? vc : 1u);
+  if (!code || !kinds) {
+    free(code);
+    free(kinds);
+    return NULL;
+  }
+  for (uint32_t si = 0; si < vc; si++) kinds[si] = frame0[si].kind ? (uint8_t)frame0[si].kind : (uint8_t)SIR_SLOT_UNSET;
+
+  for (uint32_t ip = 0; ip < n; ip++) {
+    code[ip].ip = ip;
+    code[ip].i = &f->insts[ip];
+    tx_decode_inst(&f->insts[ip], code, n, &code[ip]);
+    tx_select_typed(&code[ip], frame0 ? kinds : NULL, vc);
+  }
+  for (uint32_t k = 0; k < tf->ic_count; k++) code[tf->ic_ip[k]].x.ic = &tf->ic[k];
+  free(kinds);
+  code[n].top = SIR_TOP_END;
+  code[n].ip = n;
+  code[n].i = NULL;
+  tx_fuse(code, n);
+  for (uint32_t ip = 0; ip <= n; ip++) code[ip].op = labels ? labels[code[ip].top] : NULL;
+  return code;
+}
+
+// Decoded code of `f`, decoding it on first use. Modules may be run from
+// several threads at once: the first decode to publish wins. NULL on OOM.
+static const sir_tinst_t* tx_code(sir_tfunc_t* tf, const sir_func_t* f) {
+  sir_tinst_t* code = atomic_load_explicit(&tf->code, memory_order_acquire);
+  if (code) return code;
+  sir_tinst_t* fresh = tx_decode_func(f, tf);
+  if (!fresh) return NULL;
+  if (atomic_compare_exchange_strong_explicit(&tf->code, &code, fresh, memory_order_acq_rel, memory_order_acquire)) return fresh;
+  free(fresh);
+  return code;
+}
+
+static int32_t tx_func(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results,
+                       uint32_t out_result_count, uint32_t depth) {
+  const sir_module_t* m = x->m;
+  if (depth > 1024) return ZI_E_INTERNAL;
+  if (fid == 0 || fid > m->func_count) return ZI_E_NOENT;
+
+  const sir_func_t* f = &m->funcs[fid - 1];
+  const sir_tinst_t* code = tx_code(&x->tfuncs[fid - 1], f);
+  if (!code) return exec_func(x, fid, args, arg_count, out_results, out_result_count, depth);
+  if (!(args == NULL && arg_count == 0 && fid == m->entry) && arg_count != f->sig.param_count) return ZI_E_INVALID;
+  if (out_result_count != f->sig.result_count) return ZI_E_INVALID;
+
+  if (f->value_count > 1u << 20) return ZI_E_INVALID;
+  sir_frame_mark_t mark;
+  sir_value_t* vals = NULL;
+  const int32_t init_rc = exec_frame_enter(x, fid, f, args, arg_count, &mark, &vals);
+  if (init_rc != 0) return init_rc;
+  const int32_t rc = tx_loop(x, fid, f, code, 0, vals, out_results, out_result_count, depth, NULL);
+  exec_frame_leave(x, mark);
+  return rc;
+}
+
+// ---- Native tier (x86-64) ----
+//
+// A baseline compiler: every instruction becomes a fixed machine-code
+// template over the frame the interpreters use (rbx = vals, r12 = context,
+// r13 = ip -> code table). i32/i64 arithmetic and compares, constants,
+// branches and returns are emitted inline, with kind checks only on slots the
+// frame template leaves untyped; so is pointer arithmetic whose index kind the
+// template fixes. Integer and pointer loads and stores get a fast path that
+// does the kind, alignment and bounds checks in place; anything it doesn't
+// cover (a failed check, dirty-page tracking armed by a snapshot) falls back
+// to exec_inst for that instruction, so faults come out exactly as on the
+// interpreters. Direct calls go straight to exec_call_func. Everything else
+// (calls through pointers, hosted zABI calls, exits, float ops, i64 division)
+// calls nx_generic, which runs the instruction through exec_inst. Native code
+// reports no step events, so traced runs stay on threaded code.
+
+struct sir_ncode {
+  void* mem;                // mmap'd: code, then the table
+  size_t size;
+  const void* const* table; // inst_count + 1 entries
+};
+
+typedef struct sir_nx_ctx {
+  const sir_exec_t* x;
+  sem_guest_mem_t* mem; // x->mem, for the inline load/store templates
+  sir_func_id_t fid;
+  const sir_func_t* f;
+  sir_value_t* vals;
+  sir_value_t* out_results;
+  uint32_t out_result_count;
+  uint32_t depth;
+  int32_t rc; // set by nx_generic when the frame finishes
+} sir_nx_ctx_t;
+
+// Published for functions that can't be compiled, so nobody retries.
+static sir_ncode_t nx_unavailable;
+
+#if SIR_EXEC_NATIVE
+
+_Static_assert(sizeof(sir_val_kind_t) == 4 && sizeof(sir_value_t) == 16, "native tier assumes 16-byte values");
+
+typedef int32_t (*sir_nx_entry_t)(sir_nx_ctx_t* c, sir_value_t* vals, const void* const* table, uint32_t ip);
+
+static int32_t exec_inst_plain(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, sir_value_t* vals,
+                               sir_value_t* out_results, uint32_t out_result_count, uint32_t depth, uint32_t* io_ip,
+                               bool* out_done) {
+  return exec_inst_impl(x, NULL, fid, f, vals, out_results, out_result_count, depth, io_ip, out_done);
+}
+
+// Runs instruction `ip`. Returns the next ip, or UINT32_MAX once the frame
+// is done (c->rc then holds its result). Native code never runs with a sink.
+static uint32_t nx_generic(sir_nx_ctx_t* c, uint32_t ip) {
+  bool done = false;
+  const int32_t rc = exec_inst_plain(c->x, c->fid, c->f, c->vals, c->out_results, c->out_result_count, c->depth, &ip, &done);
+  if (done) {
+    c->rc = rc;
+    return UINT32_MAX;
+  }
+  return ip;
+}
+
+// Direct call at `ip`. Returns 0, or the (negative) error ending the frame.
+static int32_t nx_call(sir_nx_ctx_t* c, uint32_t ip) {
+  const int32_t r = exec_call_func(c->x, &c->f->insts[ip], c->vals, c->f->value_count, c->depth);
+  return r < 0 ? r : 0;
+}
+
+// Shared stubs, addressed as label ids after the inst_count + 1 ip labels.
+enum { NX_L_DISPATCH, NX_L_INVALID, NX_L_EXIT_RC, NX_L_RET, NX_L__COUNT };
+
+enum {
+  NX_CC_B = 0x2,
+  NX_CC_AE = 0x3,
+  NX_CC_E = 0x4,
+  NX_CC_NE = 0x5,
+  NX_CC_BE = 0x6,
+  NX_CC_A = 0x7,
+  NX_CC_L = 0xC,
+  NX_CC_GE = 0xD,
+  NX_CC_LE = 0xE,
+  NX_CC_G = 0xF,
+};
+
+typedef struct nx_fixup {
+  uint32_t at;    // offset of a rel32 field
+  uint32_t label; // ip, or inst_count + 1 + NX_L_*
+} nx_fixup_t;
+
+typedef struct nx_buf {
+  uint8_t* p;
+  size_t len;
+  size_t cap;
+  nx_fixup_t* fix;
+  size_t fix_len;
+  size_t fix_cap;
+  uint32_t n; // inst_count
+  bool oom;
+} nx_buf_t;
+
+static void nx_emit(nx_buf_t* b, const uint8_t* bytes, size_t n) {
+  if (b->oom) return;
+  if (b->len + n > b->cap) {
+    size_t cap = b->cap ? b->cap : 1024u;
+    while (cap < b->len + n) cap *= 2u;
+    uint8_t* p = (uint8_t*)realloc(b->p, cap);
+    if (!p) {
+      b->oom = true;
+      return;
+    }
+    b->p = p;
+    b->cap = cap;
+  }
+  memcpy(b->p + b->len, bytes, n);
+  b->len += n;
+}
+
+static void nx_u8(nx_buf_t* b, uint8_t v) { nx_emit(b, &v, 1); }
+
+static void nx_u32(nx_buf_t* b, uint32_t v) {
+  const uint8_t t[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+  nx_emit(b, t, sizeof(t));
+}
+
+static void nx_u64(nx_buf_t* b, uint64_t v) {
+  nx_u32(b, (uint32_t)v);
+  nx_u32(b, (uint32_t)(v >> 32));
+}
+
+static uint32_t nx_stub(const nx_buf_t* b, uint32_t stub) { return b->n + 1u + stub; }
+
+static void nx_rel32(nx_buf_t* b, uint32_t label) {
+  if (b->oom) return;
+  if (b->fix_len == b->fix_cap) {
+    const size_t cap = b->fix_cap ? b->fix_cap * 2u : 64u;
+    nx_fixup_t* fix = (nx_fixup_t*)realloc(b->fix, cap * sizeof(*fix));
+    if (!fix) {
+      b->oom = true;
+      return;
+    }
+    b->fix = fix;
+    b->fix_cap = cap;
+  }
+  b->fix[b->fix_len++] = (nx_fixup_t){.at = (uint32_t)b->len, .label = label};
+  nx_u32(b, 0);
+}
+
+static void nx_jmp(nx_buf_t* b, uint32_t label) {
+  nx_u8(b, 0xE9);
+  nx_rel32(b, label);
+}
 
-        uint32_t size = 0;
-        sir_val_kind_t want = SIR_VAL_INVALID;
-        if (i->k == SIR_INST_ATOMIC_RMW_I8) {
-          size = 1;
-          want = SIR_VAL_I8;
-        } else if (i->k == SIR_INST_ATOMIC_RMW_I16) {
-          size = 2;
-          want = SIR_VAL_I16;
-        } else if (i->k == SIR_INST_ATOMIC_RMW_I32) {
-          size = 4;
-          want = SIR_VAL_I32;
-        } else {
-          size = 8;
-          want = SIR_VAL_I64;
-        }
-        const sir_value_t vv = vals[v];
-        if (vv.kind != want) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
+static void nx_jcc(nx_buf_t* b, uint8_t cc, uint32_t label) {
+  nx_u8(b, 0x0F);
+  nx_u8(b, (uint8_t)(0x80u | cc));
+  nx_rel32(b, label);
+}
 
-        uint8_t* w = NULL;
-        if (!sem_guest_mem_map_rw(mem, av.u.ptr, (zi_size32_t)size, &w) || !w) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, size);
-
-        sir_value_t old = {0};
-        old.kind = want;
-        if (size == 1) {
-          uint8_t x = 0;
-          memcpy(&x, w, 1);
-          old.u.u8 = x;
-          uint8_t nv = x;
-          switch (i->u.atomic_rmw.op) {
-            case SIR_ATOMIC_RMW_ADD: nv = (uint8_t)(x + vv.u.u8); break;
-            case SIR_ATOMIC_RMW_AND: nv = (uint8_t)(x & vv.u.u8); break;
-            case SIR_ATOMIC_RMW_OR: nv = (uint8_t)(x | vv.u.u8); break;
-            case SIR_ATOMIC_RMW_XOR: nv = (uint8_t)(x ^ vv.u.u8); break;
-            case SIR_ATOMIC_RMW_XCHG: nv = vv.u.u8; break;
-            default:
-              free(vals);
-              return ZI_E_INVALID;
-          }
-          if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 1);
-          memcpy(w, &nv, 1);
-        } else if (size == 2) {
-          uint16_t x = 0;
-          memcpy(&x, w, 2);
-          old.u.u16 = x;
-          uint16_t nv = x;
-          switch (i->u.atomic_rmw.op) {
-            case SIR_ATOMIC_RMW_ADD: nv = (uint16_t)(x + vv.u.u16); break;
-            case SIR_ATOMIC_RMW_AND: nv = (uint16_t)(x & vv.u.u16); break;
-            case SIR_ATOMIC_RMW_OR: nv = (uint16_t)(x | vv.u.u16); break;
-            case SIR_ATOMIC_RMW_XOR: nv = (uint16_t)(x ^ vv.u.u16); break;
-            case SIR_ATOMIC_RMW_XCHG: nv = vv.u.u16; break;
-            default:
-              free(vals);
-              return ZI_E_INVALID;
-          }
-          if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 2);
-          memcpy(w, &nv, 2);
-        } else if (size == 4) {
-          int32_t x = 0;
-          memcpy(&x, w, 4);
-          old.u.i32 = x;
-          uint32_t xo = (uint32_t)x;
-          uint32_t xv = (uint32_t)vv.u.i32;
-          uint32_t nv = xo;
-          switch (i->u.atomic_rmw.op) {
-            case SIR_ATOMIC_RMW_ADD: nv = xo + xv; break;
-            case SIR_ATOMIC_RMW_AND: nv = xo & xv; break;
-            case SIR_ATOMIC_RMW_OR: nv = xo | xv; break;
-            case SIR_ATOMIC_RMW_XOR: nv = xo ^ xv; break;
-            case SIR_ATOMIC_RMW_XCHG: nv = xv; break;
-            default:
-              free(vals);
-              return ZI_E_INVALID;
-          }
-          const int32_t out = (int32_t)nv;
-          if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 4);
-          memcpy(w, &out, 4);
-        } else {
-          int64_t x = 0;
-          memcpy(&x, w, 8);
-          old.u.i64 = x;
-          uint64_t xo = (uint64_t)x;
-          uint64_t xv = (uint64_t)vv.u.i64;
-          uint64_t nv = xo;
-          switch (i->u.atomic_rmw.op) {
-            case SIR_ATOMIC_RMW_ADD: nv = xo + xv; break;
-            case SIR_ATOMIC_RMW_AND: nv = xo & xv; break;
-            case SIR_ATOMIC_RMW_OR: nv = xo | xv; break;
-            case SIR_ATOMIC_RMW_XOR: nv = xo ^ xv; break;
-            case SIR_ATOMIC_RMW_XCHG: nv = xv; break;
-            default:
-              free(vals);
-              return ZI_E_INVALID;
-          }
-          const int64_t out = (int64_t)nv;
-          if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 8);
-          memcpy(w, &out, 8);
-        }
+// ModRM + disp32 for [rbx + slot*16 + off] with `reg` in the reg field.
+static void nx_slot(nx_buf_t* b, uint8_t reg, sir_val_id_t slot, size_t off) {
+  nx_u8(b, (uint8_t)(0x80u | (uint8_t)(reg << 3) | 3u));
+  nx_u32(b, (uint32_t)(slot * sizeof(sir_value_t) + off));
+}
 
-        vals[dst] = old;
-        ip++;
-        break;
-      }
-      case SIR_INST_ATOMIC_CMPXCHG_I64: {
-        const sir_val_id_t a = i->u.atomic_cmpxchg_i64.addr;
-        const sir_val_id_t e = i->u.atomic_cmpxchg_i64.expected;
-        const sir_val_id_t d = i->u.atomic_cmpxchg_i64.desired;
-        const sir_val_id_t dst = i->u.atomic_cmpxchg_i64.dst_old;
-        if (a >= f->value_count || e >= f->value_count || d >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        const sir_value_t ev = vals[e];
-        const sir_value_t dv = vals[d];
-        if (av.kind != SIR_VAL_PTR || ev.kind != SIR_VAL_I64 || dv.kind != SIR_VAL_I64) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t align = i->u.atomic_cmpxchg_i64.align ? i->u.atomic_cmpxchg_i64.align : 1u;
-        if (!is_pow2_u32(align)) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (align > 1u) {
-          const uint64_t addr = (uint64_t)av.u.ptr;
-          if ((addr & (uint64_t)(align - 1u)) != 0ull) {
-            free(vals);
-            return 256;
-          }
-        }
-        uint8_t* w = NULL;
-        if (!sem_guest_mem_map_rw(mem, av.u.ptr, 8, &w) || !w) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, 8);
-        int64_t old = 0;
-        memcpy(&old, w, 8);
-        if (old == ev.u.i64) {
-          if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, 8);
-          memcpy(w, &dv.u.i64, 8);
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = old};
-        ip++;
-        break;
-      }
-      case SIR_INST_ALLOCA: {
-        const sir_val_id_t dst = i->u.alloca_.dst;
-        if (dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const zi_ptr_t p = sem_guest_alloc(mem, (zi_size32_t)i->u.alloca_.size, (zi_size32_t)i->u.alloca_.align);
-        if (!p) {
-          free(vals);
-          return ZI_E_OOM;
-        }
-        vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = p};
-        ip++;
-        break;
-      }
-      case SIR_INST_STORE_I8:
-      case SIR_INST_STORE_I16:
-      case SIR_INST_STORE_I32:
-      case SIR_INST_STORE_I64:
-      case SIR_INST_STORE_PTR: {
-        const sir_val_id_t a = i->u.store.addr;
-        const sir_val_id_t v = i->u.store.value;
-        if (a >= f->value_count || v >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        if (av.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t align = i->u.store.align ? i->u.store.align : 1u;
-        if (!is_pow2_u32(align)) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (align > 1u) {
-          const uint64_t addr = (uint64_t)av.u.ptr;
-          if ((addr & (uint64_t)(align - 1u)) != 0ull) {
-            free(vals);
-            return 256;
-          }
-        }
-        uint32_t size = 0;
-        if (i->k == SIR_INST_STORE_I8) size = 1;
-        else if (i->k == SIR_INST_STORE_I16) size = 2;
-        else if (i->k == SIR_INST_STORE_I32) size = 4;
-        else if (i->k == SIR_INST_STORE_I64) size = 8;
-        else size = (uint32_t)sizeof(zi_ptr_t);
-        uint8_t* w = NULL;
-        if (!sem_guest_mem_map_rw(mem, av.u.ptr, (zi_size32_t)size, &w) || !w) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, size);
-        if (i->k == SIR_INST_STORE_I8) {
-          const sir_value_t vv = vals[v];
-          const uint8_t b = (vv.kind == SIR_VAL_I8) ? vv.u.u8 : (vv.kind == SIR_VAL_I32) ? (uint8_t)vv.u.i32 : 0;
-          if (vv.kind != SIR_VAL_I8 && vv.kind != SIR_VAL_I32) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          memcpy(w, &b, 1);
-        } else if (i->k == SIR_INST_STORE_I16) {
-          const sir_value_t vv = vals[v];
-          uint16_t x = 0;
-          if (vv.kind == SIR_VAL_I16) x = vv.u.u16;
-          else if (vv.kind == SIR_VAL_I8) x = (uint16_t)vv.u.u8;
-          else if (vv.kind == SIR_VAL_I32) x = (uint16_t)(uint32_t)vv.u.i32;
-          else if (vv.kind == SIR_VAL_I64) x = (uint16_t)(uint64_t)vv.u.i64;
-          else {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          memcpy(w, &x, 2);
-        } else if (i->k == SIR_INST_STORE_I32) {
-          const sir_value_t vv = vals[v];
-          if (vv.kind != SIR_VAL_I32) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          memcpy(w, &vv.u.i32, 4);
-        } else if (i->k == SIR_INST_STORE_I64) {
-          const sir_value_t vv = vals[v];
-          if (vv.kind != SIR_VAL_I64) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          memcpy(w, &vv.u.i64, 8);
-        } else {
-          const sir_value_t vv = vals[v];
-          if (vv.kind != SIR_VAL_PTR) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          memcpy(w, &vv.u.ptr, sizeof(vv.u.ptr));
-        }
-        ip++;
-        break;
-      }
-      case SIR_INST_STORE_F32:
-      case SIR_INST_STORE_F64: {
-        const sir_val_id_t a = i->u.store.addr;
-        const sir_val_id_t v = i->u.store.value;
-        if (a >= f->value_count || v >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        if (av.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t align = i->u.store.align ? i->u.store.align : 1u;
-        if (!is_pow2_u32(align)) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (align > 1u) {
-          const uint64_t addr = (uint64_t)av.u.ptr;
-          if ((addr & (uint64_t)(align - 1u)) != 0ull) {
-            free(vals);
-            return 256;
-          }
-        }
-        const uint32_t size = (i->k == SIR_INST_STORE_F32) ? 4u : 8u;
-        uint8_t* w = NULL;
-        if (!sem_guest_mem_map_rw(mem, av.u.ptr, (zi_size32_t)size, &w) || !w) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_WRITE, av.u.ptr, size);
-        const sir_value_t vv = vals[v];
-        if (i->k == SIR_INST_STORE_F32) {
-          if (vv.kind != SIR_VAL_F32) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          const uint32_t bits = f32_canon_bits(vv.u.f32_bits);
-          memcpy(w, &bits, 4);
-        } else {
-          if (vv.kind != SIR_VAL_F64) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          const uint64_t bits = f64_canon_bits(vv.u.f64_bits);
-          memcpy(w, &bits, 8);
-        }
-        ip++;
-        break;
-      }
-      case SIR_INST_LOAD_I8:
-      case SIR_INST_LOAD_I16:
-      case SIR_INST_LOAD_I32:
-      case SIR_INST_LOAD_I64:
-      case SIR_INST_LOAD_PTR: {
-        const sir_val_id_t a = i->u.load.addr;
-        const sir_val_id_t dst = i->u.load.dst;
-        if (a >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        if (av.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t align = i->u.load.align ? i->u.load.align : 1u;
-        if (!is_pow2_u32(align)) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (align > 1u) {
-          const uint64_t addr = (uint64_t)av.u.ptr;
-          if ((addr & (uint64_t)(align - 1u)) != 0ull) {
-            free(vals);
-            return 256;
-          }
-        }
-        uint32_t size = 0;
-        if (i->k == SIR_INST_LOAD_I8) size = 1;
-        else if (i->k == SIR_INST_LOAD_I16) size = 2;
-        else if (i->k == SIR_INST_LOAD_I32) size = 4;
-        else if (i->k == SIR_INST_LOAD_I64) size = 8;
-        else size = (uint32_t)sizeof(zi_ptr_t);
-        const uint8_t* r = NULL;
-        if (!sem_guest_mem_map_ro(mem, av.u.ptr, (zi_size32_t)size, &r) || !r) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, size);
-        if (i->k == SIR_INST_LOAD_I8) {
-          uint8_t b = 0;
-          memcpy(&b, r, 1);
-          vals[dst] = (sir_value_t){.kind = SIR_VAL_I8, .u.u8 = b};
-        } else if (i->k == SIR_INST_LOAD_I16) {
-          uint16_t x = 0;
-          memcpy(&x, r, 2);
-          vals[dst] = (sir_value_t){.kind = SIR_VAL_I16, .u.u16 = x};
-        } else if (i->k == SIR_INST_LOAD_I32) {
-          int32_t x = 0;
-          memcpy(&x, r, 4);
-          vals[dst] = (sir_value_t){.kind = SIR_VAL_I32, .u.i32 = x};
-        } else if (i->k == SIR_INST_LOAD_I64) {
-          int64_t x = 0;
-          memcpy(&x, r, 8);
-          vals[dst] = (sir_value_t){.kind = SIR_VAL_I64, .u.i64 = x};
-        } else {
-          zi_ptr_t x = 0;
-          memcpy(&x, r, sizeof(x));
-          vals[dst] = (sir_value_t){.kind = SIR_VAL_PTR, .u.ptr = x};
-        }
-        ip++;
-        break;
+// cmp dword [slot.kind], k; jne invalid -- unless the frame template fixes it.
+static void nx_check_kind(nx_buf_t* b, const sir_value_t* frame0, sir_val_id_t slot, sir_val_kind_t k) {
+  if (frame0[slot].kind == k) return;
+  nx_u8(b, 0x83);
+  nx_slot(b, 7, slot, offsetof(sir_value_t, kind));
+  nx_u8(b, (uint8_t)k);
+  nx_jcc(b, NX_CC_NE, nx_stub(b, NX_L_INVALID));
+}
+
+// mov eax/ecx (reg 0/1), [slot.u.i32]
+static void nx_load_i32(nx_buf_t* b, const sir_value_t* frame0, sir_val_id_t slot, uint8_t reg) {
+  nx_check_kind(b, frame0, slot, SIR_VAL_I32);
+  nx_u8(b, 0x8B);
+  nx_slot(b, reg, slot, offsetof(sir_value_t, u));
+}
+
+static void nx_load_i64(nx_buf_t* b, const sir_value_t* frame0, sir_val_id_t slot, uint8_t reg) {
+  nx_check_kind(b, frame0, slot, SIR_VAL_I64);
+  nx_u8(b, 0x48); // REX.W
+  nx_u8(b, 0x8B);
+  nx_slot(b, reg, slot, offsetof(sir_value_t, u));
+}
+
+// Stores rax (a 64-bit or zero-extended 32-bit result) into slot as kind k.
+static void nx_store(nx_buf_t* b, const sir_value_t* frame0, sir_val_id_t slot, sir_val_kind_t k) {
+  if (frame0[slot].kind != k) {
+    nx_u8(b, 0xC7);
+    nx_slot(b, 0, slot, offsetof(sir_value_t, kind));
+    nx_u32(b, (uint32_t)k);
+  }
+  nx_u8(b, 0x48);
+  nx_u8(b, 0x89);
+  nx_slot(b, 0, slot, offsetof(sir_value_t, u));
+}
+
+// Forward branches inside one instruction's template. nx_jcc_local emits a
+// jcc with a placeholder rel32 and returns where it sits; nx_bind points it
+// at the current position.
+static size_t nx_jcc_local(nx_buf_t* b, uint8_t cc) {
+  nx_u8(b, 0x0F);
+  nx_u8(b, (uint8_t)(0x80u | cc));
+  const size_t at = b->len;
+  nx_u32(b, 0);
+  return at;
+}
+
+static void nx_bind(nx_buf_t* b, size_t at) {
+  if (b->oom) return;
+  const uint32_t rel = (uint32_t)(b->len - (at + 4u));
+  memcpy(b->p + at, (const uint8_t[]){(uint8_t)rel, (uint8_t)(rel >> 8), (uint8_t)(rel >> 16), (uint8_t)(rel >> 24)}, 4);
+}
+
+// ModRM + disp32 for [rdx + off] with `reg` in the reg field (rdx = mem).
+static void nx_mem_field(nx_buf_t* b, uint8_t reg, size_t off) {
+  nx_u8(b, (uint8_t)(0x80u | (uint8_t)(reg << 3) | 2u));
+  nx_u32(b, (uint32_t)off);
+}
+
+// Up to this many fast-path exits per template, all bound to its slow path.
+#define NX_SLOW_MAX 8u
+
+typedef struct nx_slow {
+  size_t at[NX_SLOW_MAX];
+  uint32_t n;
+} nx_slow_t;
+
+static void nx_slow_jcc(nx_buf_t* b, nx_slow_t* s, uint8_t cc) {
+  if (s->n < NX_SLOW_MAX) s->at[s->n++] = nx_jcc_local(b, cc);
+}
+
+// cmp dword [slot.kind], k; jne slow -- unless the frame template fixes it.
+static void nx_guard_kind(nx_buf_t* b, nx_slow_t* s, const sir_value_t* frame0, sir_val_id_t slot, sir_val_kind_t k) {
+  if (frame0[slot].kind == k) return;
+  nx_u8(b, 0x83);
+  nx_slot(b, 7, slot, offsetof(sir_value_t, kind));
+  nx_u8(b, (uint8_t)k);
+  nx_slow_jcc(b, s, NX_CC_NE);
+}
+
+// Fast-path address check of a `size`-byte access through the pointer in
+// slot `addr`: on success rax = offset into guest memory and rdx = mem->buf.
+// Mirrors sem_guest_bounds plus the alignment trap; `store` also leaves
+// accesses to the slow path while dirty-page tracking is armed.
+static void nx_guest_addr(nx_buf_t* b, nx_slow_t* s, const sir_value_t* frame0, sir_val_id_t addr, uint32_t size, uint32_t align,
+                          bool store) {
+  nx_guard_kind(b, s, frame0, addr, SIR_VAL_PTR);
+  nx_u8(b, 0x48); // mov rax, [addr.u.ptr]
+  nx_u8(b, 0x8B);
+  nx_slot(b, 0, addr, offsetof(sir_value_t, u));
+  if (align > 1u) {
+    nx_u8(b, 0xA9); // test eax, align - 1
+    nx_u32(b, align - 1u);
+    nx_slow_jcc(b, s, NX_CC_NE);
+  }
+  nx_emit(b, (const uint8_t[]){0x49, 0x8B, 0x94, 0x24}, 4); // mov rdx, [r12 + mem]
+  nx_u32(b, (uint32_t)offsetof(sir_nx_ctx_t, mem));
+  nx_emit(b, (const uint8_t[]){0x48, 0x2B}, 2); // sub rax, [rdx + base]
+  nx_mem_field(b, 0, offsetof(sem_guest_mem_t, base));
+  nx_emit(b, (const uint8_t[]){0x48, 0x3B}, 2); // cmp rax, [rdx + cap]
+  nx_mem_field(b, 0, offsetof(sem_guest_mem_t, cap));
+  nx_slow_jcc(b, s, NX_CC_AE);
+  nx_emit(b, (const uint8_t[]){0x48, 0x8D, 0x48, (uint8_t)size}, 4); // lea rcx, [rax + size]
+  nx_emit(b, (const uint8_t[]){0x48, 0x3B}, 2);                      // cmp rcx, [rdx + brk]
+  nx_mem_field(b, 1, offsetof(sem_guest_mem_t, brk));
+  const size_t in_heap = nx_jcc_local(b, NX_CC_BE);
+  nx_emit(b, (const uint8_t[]){0x48, 0x3B}, 2); // cmp rax, [rdx + sp]
+  nx_mem_field(b, 0, offsetof(sem_guest_mem_t, sp));
+  nx_slow_jcc(b, s, NX_CC_B);
+  nx_emit(b, (const uint8_t[]){0x48, 0x3B}, 2); // cmp rcx, [rdx + cap]
+  nx_mem_field(b, 1, offsetof(sem_guest_mem_t, cap));
+  nx_slow_jcc(b, s, NX_CC_A);
+  nx_bind(b, in_heap);
+  if (store) {
+    nx_emit(b, (const uint8_t[]){0x48, 0x83}, 2); // cmp qword [rdx + dirty], 0
+    nx_mem_field(b, 7, offsetof(sem_guest_mem_t, dirty));
+    nx_u8(b, 0);
+    nx_slow_jcc(b, s, NX_CC_NE);
+  }
+  nx_emit(b, (const uint8_t[]){0x48, 0x8B}, 2); // mov rdx, [rdx + buf]
+  nx_mem_field(b, 2, offsetof(sem_guest_mem_t, buf));
+}
+
+// Integer/pointer load or store. Returns false for forms without a fast
+// path; otherwise the fast path ends by jumping to ip + 1 and its exits are
+// left in `s` for the caller to bind to the nx_generic fallback.
+static bool nx_emit_mem(nx_buf_t* b, nx_slow_t* s, const sir_inst_t* i, const sir_value_t* frame0, uint32_t ip) {
+  uint32_t size = 0;
+  sir_val_kind_t k = SIR_VAL_I32;
+  bool store = false;
+  switch (i->k) {
+    case SIR_INST_LOAD_I8: size = 1; k = SIR_VAL_I8; break;
+    case SIR_INST_LOAD_I16: size = 2; k = SIR_VAL_I16; break;
+    case SIR_INST_LOAD_I32: size = 4; k = SIR_VAL_I32; break;
+    case SIR_INST_LOAD_I64: size = 8; k = SIR_VAL_I64; break;
+    case SIR_INST_LOAD_PTR: size = 8; k = SIR_VAL_PTR; break;
+    case SIR_INST_STORE_I8: size = 1; k = SIR_VAL_I8; store = true; break;
+    case SIR_INST_STORE_I16: size = 2; k = SIR_VAL_I16; store = true; break;
+    case SIR_INST_STORE_I32: size = 4; k = SIR_VAL_I32; store = true; break;
+    case SIR_INST_STORE_I64: size = 8; k = SIR_VAL_I64; store = true; break;
+    case SIR_INST_STORE_PTR: size = 8; k = SIR_VAL_PTR; store = true; break;
+    default:
+      return false;
+  }
+  const uint32_t align = store ? (i->u.store.align ? i->u.store.align : 1u) : (i->u.load.align ? i->u.load.align : 1u);
+  if (!is_pow2_u32(align)) return false;
+
+  if (store) {
+    // Only the value's own kind takes the fast path; widening stores (an i32
+    // into an i8 slot and the like) go through exec_inst.
+    nx_guard_kind(b, s, frame0, i->u.store.value, k);
+    nx_guest_addr(b, s, frame0, i->u.store.addr, size, align, true);
+    nx_u8(b, 0x48); // mov rcx, [value.u]
+    nx_u8(b, 0x8B);
+    nx_slot(b, 1, i->u.store.value, offsetof(sir_value_t, u));
+    if (size == 1) nx_emit(b, (const uint8_t[]){0x88, 0x0C, 0x02}, 3);       // mov [rdx + rax], cl
+    else if (size == 2) nx_emit(b, (const uint8_t[]){0x66, 0x89, 0x0C, 0x02}, 4); // mov [rdx + rax], cx
+    else if (size == 4) nx_emit(b, (const uint8_t[]){0x89, 0x0C, 0x02}, 3);  // mov [rdx + rax], ecx
+    else nx_emit(b, (const uint8_t[]){0x48, 0x89, 0x0C, 0x02}, 4);           // mov [rdx + rax], rcx
+  } else {
+    nx_guest_addr(b, s, frame0, i->u.load.addr, size, align, false);
+    if (size == 1) nx_emit(b, (const uint8_t[]){0x0F, 0xB6, 0x04, 0x02}, 4);      // movzx eax, byte [rdx + rax]
+    else if (size == 2) nx_emit(b, (const uint8_t[]){0x0F, 0xB7, 0x04, 0x02}, 4); // movzx eax, word [rdx + rax]
+    else if (size == 4) nx_emit(b, (const uint8_t[]){0x8B, 0x04, 0x02}, 3);       // mov eax, [rdx + rax]
+    else nx_emit(b, (const uint8_t[]){0x48, 0x8B, 0x04, 0x02}, 4);                // mov rax, [rdx + rax]
+    nx_store(b, frame0, i->u.load.dst, k);
+  }
+  nx_jmp(b, ip + 1u);
+  return true;
+}
+
+// mov rdi, r12; mov esi, ip; mov rax, fn; call rax
+static void nx_call_helper(nx_buf_t* b, uint64_t fn, uint32_t ip) {
+  nx_emit(b, (const uint8_t[]){0x4C, 0x89, 0xE7}, 3);
+  nx_u8(b, 0xBE);
+  nx_u32(b, ip);
+  nx_u8(b, 0x48);
+  nx_u8(b, 0xB8);
+  nx_u64(b, fn);
+  nx_emit(b, (const uint8_t[]){0xFF, 0xD0}, 2);
+}
+
+static void nx_emit_inst(nx_buf_t* b, const sir_func_t* f, const sir_value_t* frame0, uint32_t ip) {
+  const sir_inst_t* i = &f->insts[ip];
+  uint8_t op = 0;
+  uint8_t cc = 0;
+  switch (i->k) {
+    case SIR_INST_CONST_I32:
+      nx_u8(b, 0xB8); // mov eax, imm32
+      nx_u32(b, (uint32_t)i->u.const_i32.v);
+      nx_store(b, frame0, i->u.const_i32.dst, SIR_VAL_I32);
+      return;
+    case SIR_INST_CONST_BOOL:
+      if (i->u.const_bool.v > 1) break;
+      nx_u8(b, 0xB8);
+      nx_u32(b, i->u.const_bool.v);
+      nx_store(b, frame0, i->u.const_bool.dst, SIR_VAL_BOOL);
+      return;
+    case SIR_INST_I32_ADD:
+      op = 0x01;
+      goto bin;
+    case SIR_INST_I32_SUB:
+      op = 0x29;
+      goto bin;
+    case SIR_INST_I32_AND:
+      op = 0x21;
+      goto bin;
+    case SIR_INST_I32_OR:
+      op = 0x09;
+      goto bin;
+    case SIR_INST_I32_XOR:
+      op = 0x31;
+      goto bin;
+    case SIR_INST_I32_MUL:
+    case SIR_INST_I32_SHL:
+    case SIR_INST_I32_SHR_S:
+    case SIR_INST_I32_SHR_U:
+    bin:
+      nx_load_i32(b, frame0, i->u.i32_add.a, 0);
+      nx_load_i32(b, frame0, i->u.i32_add.b, 1);
+      if (op) {
+        nx_u8(b, op); // op eax, ecx
+        nx_u8(b, 0xC8);
+      } else if (i->k == SIR_INST_I32_MUL) {
+        nx_emit(b, (const uint8_t[]){0x0F, 0xAF, 0xC1}, 3); // imul eax, ecx
+      } else {
+        // shl/sar/shr eax, cl; x86 masks the count to 5 bits, as SIR does.
+        nx_u8(b, 0xD3);
+        nx_u8(b, i->k == SIR_INST_I32_SHL ? 0xE0 : i->k == SIR_INST_I32_SHR_S ? 0xF8 : 0xE8);
       }
-      case SIR_INST_LOAD_F32:
-      case SIR_INST_LOAD_F64: {
-        const sir_val_id_t a = i->u.load.addr;
-        const sir_val_id_t dst = i->u.load.dst;
-        if (a >= f->value_count || dst >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t av = vals[a];
-        if (av.kind != SIR_VAL_PTR) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        const uint32_t align = i->u.load.align ? i->u.load.align : 1u;
-        if (!is_pow2_u32(align)) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (align > 1u) {
-          const uint64_t addr = (uint64_t)av.u.ptr;
-          if ((addr & (uint64_t)(align - 1u)) != 0ull) {
-            free(vals);
-            return 256;
-          }
-        }
-        const uint32_t size = (i->k == SIR_INST_LOAD_F32) ? 4u : 8u;
-        const uint8_t* r = NULL;
-        if (!sem_guest_mem_map_ro(mem, av.u.ptr, (zi_size32_t)size, &r) || !r) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        if (sink && sink->on_mem) sink->on_mem(sink->user, m, fid, ip, SIR_MEM_READ, av.u.ptr, size);
-        if (i->k == SIR_INST_LOAD_F32) {
-          uint32_t bits = 0;
-          memcpy(&bits, r, 4);
-          vals[dst] = (sir_value_t){.kind = SIR_VAL_F32, .u.f32_bits = f32_canon_bits(bits)};
-        } else {
-          uint64_t bits = 0;
-          memcpy(&bits, r, 8);
-          vals[dst] = (sir_value_t){.kind = SIR_VAL_F64, .u.f64_bits = f64_canon_bits(bits)};
-        }
-        ip++;
-        break;
+      nx_store(b, frame0, i->u.i32_add.dst, SIR_VAL_I32);
+      return;
+    case SIR_INST_I32_NOT:
+    case SIR_INST_I32_NEG:
+      nx_load_i32(b, frame0, i->u.i32_un.x, 0);
+      nx_u8(b, 0xF7); // not/neg eax
+      nx_u8(b, i->k == SIR_INST_I32_NOT ? 0xD0 : 0xD8);
+      nx_store(b, frame0, i->u.i32_un.dst, SIR_VAL_I32);
+      return;
+    case SIR_INST_I32_CMP_EQ:
+      cc = NX_CC_E;
+      goto cmp;
+    case SIR_INST_I32_CMP_NE:
+      cc = NX_CC_NE;
+      goto cmp;
+    case SIR_INST_I32_CMP_SLT:
+      cc = NX_CC_L;
+      goto cmp;
+    case SIR_INST_I32_CMP_SLE:
+      cc = NX_CC_LE;
+      goto cmp;
+    case SIR_INST_I32_CMP_SGT:
+      cc = NX_CC_G;
+      goto cmp;
+    case SIR_INST_I32_CMP_SGE:
+      cc = NX_CC_GE;
+      goto cmp;
+    case SIR_INST_I32_CMP_ULT:
+      cc = NX_CC_B;
+      goto cmp;
+    case SIR_INST_I32_CMP_ULE:
+      cc = NX_CC_BE;
+      goto cmp;
+    case SIR_INST_I32_CMP_UGT:
+      cc = NX_CC_A;
+      goto cmp;
+    case SIR_INST_I32_CMP_UGE:
+      cc = NX_CC_AE;
+    cmp:
+      nx_load_i32(b, frame0, i->u.i32_cmp_eq.a, 0);
+      nx_load_i32(b, frame0, i->u.i32_cmp_eq.b, 1);
+      nx_emit(b, (const uint8_t[]){0x39, 0xC8, 0x0F, (uint8_t)(0x90u | cc), 0xC0, 0x0F, 0xB6, 0xC0}, 8); // cmp; setcc al; movzx
+      nx_store(b, frame0, i->u.i32_cmp_eq.dst, SIR_VAL_BOOL);
+      return;
+    case SIR_INST_I64_ADD:
+      op = 0x01;
+      goto bin64;
+    case SIR_INST_I64_SUB:
+      op = 0x29;
+      goto bin64;
+    case SIR_INST_I64_AND:
+      op = 0x21;
+      goto bin64;
+    case SIR_INST_I64_OR:
+      op = 0x09;
+      goto bin64;
+    case SIR_INST_I64_XOR:
+      op = 0x31;
+      goto bin64;
+    case SIR_INST_I64_MUL:
+    case SIR_INST_I64_SHL:
+    case SIR_INST_I64_SHR_S:
+    case SIR_INST_I64_SHR_U:
+    bin64:
+      nx_load_i64(b, frame0, i->u.i64_bin.a, 0);
+      nx_load_i64(b, frame0, i->u.i64_bin.b, 1);
+      nx_u8(b, 0x48); // REX.W
+      if (op) {
+        nx_u8(b, op); // op rax, rcx
+        nx_u8(b, 0xC8);
+      } else if (i->k == SIR_INST_I64_MUL) {
+        nx_emit(b, (const uint8_t[]){0x0F, 0xAF, 0xC1}, 3); // imul rax, rcx
+      } else {
+        // 64-bit shifts mask the count to 6 bits, as SIR does.
+        nx_u8(b, 0xD3);
+        nx_u8(b, i->k == SIR_INST_I64_SHL ? 0xE0 : i->k == SIR_INST_I64_SHR_S ? 0xF8 : 0xE8);
       }
-      case SIR_INST_CALL_EXTERN: {
-        const int32_t r = exec_call_extern(m, mem, host, fid, ip, sink, i, vals, f->value_count);
-        if (r < 0) {
-          free(vals);
-          return r;
-        }
-        ip++;
-        break;
+      nx_store(b, frame0, i->u.i64_bin.dst, SIR_VAL_I64);
+      return;
+    case SIR_INST_I64_NOT:
+    case SIR_INST_I64_NEG:
+      nx_load_i64(b, frame0, i->u.num_un.x, 0);
+      nx_emit(b, (const uint8_t[]){0x48, 0xF7, i->k == SIR_INST_I64_NOT ? 0xD0 : 0xD8}, 3); // not/neg rax
+      nx_store(b, frame0, i->u.num_un.dst, SIR_VAL_I64);
+      return;
+    case SIR_INST_I64_CMP_EQ:
+      cc = NX_CC_E;
+      goto cmp64;
+    case SIR_INST_I64_CMP_NE:
+      cc = NX_CC_NE;
+      goto cmp64;
+    case SIR_INST_I64_CMP_SLT:
+      cc = NX_CC_L;
+      goto cmp64;
+    case SIR_INST_I64_CMP_SLE:
+      cc = NX_CC_LE;
+      goto cmp64;
+    case SIR_INST_I64_CMP_SGT:
+      cc = NX_CC_G;
+      goto cmp64;
+    case SIR_INST_I64_CMP_SGE:
+      cc = NX_CC_GE;
+      goto cmp64;
+    case SIR_INST_I64_CMP_ULT:
+      cc = NX_CC_B;
+      goto cmp64;
+    case SIR_INST_I64_CMP_ULE:
+      cc = NX_CC_BE;
+      goto cmp64;
+    case SIR_INST_I64_CMP_UGT:
+      cc = NX_CC_A;
+      goto cmp64;
+    case SIR_INST_I64_CMP_UGE:
+      cc = NX_CC_AE;
+    cmp64:
+      nx_load_i64(b, frame0, i->u.i64_bin.a, 0);
+      nx_load_i64(b, frame0, i->u.i64_bin.b, 1);
+      nx_emit(b, (const uint8_t[]){0x48, 0x39, 0xC8, 0x0F, (uint8_t)(0x90u | cc), 0xC0, 0x0F, 0xB6, 0xC0}, 9); // cmp; setcc al; movzx
+      nx_store(b, frame0, i->u.i64_bin.dst, SIR_VAL_BOOL);
+      return;
+    case SIR_INST_BR: {
+      // Block args are a parallel copy: all sources go through xmm0-7 first.
+      const uint32_t n = i->u.br.arg_count;
+      if (n > 8 || (n && (!i->u.br.src_slots || !i->u.br.dst_slots))) break;
+      for (uint32_t ai = 0; ai < n; ai++) {
+        nx_emit(b, (const uint8_t[]){0xF3, 0x0F, 0x6F}, 3); // movdqu xmm, [src]
+        nx_slot(b, (uint8_t)ai, i->u.br.src_slots[ai], 0);
       }
-      case SIR_INST_CALL_FUNC: {
-        const int32_t r = exec_call_func(m, mem, host, globals, global_count, i, vals, f->value_count, depth, sink);
-        if (r < 0) {
-          free(vals);
-          return r;
-        }
-        ip++;
-        break;
+      for (uint32_t ai = 0; ai < n; ai++) {
+        nx_emit(b, (const uint8_t[]){0xF3, 0x0F, 0x7F}, 3); // movdqu [dst], xmm
+        nx_slot(b, (uint8_t)ai, i->u.br.dst_slots[ai], 0);
       }
-      case SIR_INST_CALL_FUNC_PTR: {
-        const int32_t r = exec_call_func_ptr(m, mem, host, globals, global_count, i, vals, f->value_count, depth, sink);
-        if (r < 0) {
-          free(vals);
-          return r;
-        }
-        ip++;
-        break;
+      if (i->u.br.target_ip != ip + 1u) nx_jmp(b, i->u.br.target_ip);
+      return;
+    }
+    case SIR_INST_CBR:
+      nx_check_kind(b, frame0, i->u.cbr.cond, SIR_VAL_BOOL);
+      nx_u8(b, 0x80); // cmp byte [cond.u.b], 0
+      nx_slot(b, 7, i->u.cbr.cond, offsetof(sir_value_t, u));
+      nx_u8(b, 0);
+      nx_jcc(b, NX_CC_NE, i->u.cbr.then_ip);
+      if (i->u.cbr.else_ip != ip + 1u) nx_jmp(b, i->u.cbr.else_ip);
+      return;
+    case SIR_INST_PTR_OFFSET:
+    case SIR_INST_PTR_ADD:
+    case SIR_INST_PTR_SUB: {
+      // Inline only when the frame template fixes the index kind; the three
+      // forms share their operand layout up to ptr_offset's scale.
+      const sir_val_id_t base = i->k == SIR_INST_PTR_OFFSET ? i->u.ptr_offset.base : i->k == SIR_INST_PTR_ADD ? i->u.ptr_add.base : i->u.ptr_sub.base;
+      const sir_val_id_t idx = i->k == SIR_INST_PTR_OFFSET ? i->u.ptr_offset.index : i->k == SIR_INST_PTR_ADD ? i->u.ptr_add.off : i->u.ptr_sub.off;
+      const sir_val_id_t dst = i->k == SIR_INST_PTR_OFFSET ? i->u.ptr_offset.dst : i->k == SIR_INST_PTR_ADD ? i->u.ptr_add.dst : i->u.ptr_sub.dst;
+      const sir_val_kind_t ik = frame0[idx].kind;
+      if (ik != SIR_VAL_I32 && ik != SIR_VAL_I64) break;
+      if (i->k == SIR_INST_PTR_OFFSET && i->u.ptr_offset.scale > INT32_MAX) break;
+      nx_check_kind(b, frame0, base, SIR_VAL_PTR);
+      nx_u8(b, 0x48); // mov rax, [base.u.ptr]
+      nx_u8(b, 0x8B);
+      nx_slot(b, 0, base, offsetof(sir_value_t, u));
+      nx_u8(b, 0x48); // mov rcx, [idx.u.i64] / movsxd rcx, [idx.u.i32]
+      nx_u8(b, ik == SIR_VAL_I64 ? 0x8B : 0x63);
+      nx_slot(b, 1, idx, offsetof(sir_value_t, u));
+      if (i->k == SIR_INST_PTR_OFFSET && i->u.ptr_offset.scale != 1u) {
+        nx_emit(b, (const uint8_t[]){0x48, 0x69, 0xC9}, 3); // imul rcx, rcx, scale
+        nx_u32(b, i->u.ptr_offset.scale);
       }
-      case SIR_INST_RET:
-        if (out_results && out_result_count) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        free(vals);
-        return 0;
-      case SIR_INST_RET_VAL:
-        if (out_result_count != 1 || !out_results) {
-          free(vals);
-          return ZI_E_INVALID;
-        }
-        if (i->u.ret_val.value >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        out_results[0] = vals[i->u.ret_val.value];
-        free(vals);
-        return 0;
-      case SIR_INST_EXIT:
-        free(vals);
-        if (i->u.exit_.code < 0) return ZI_E_INVALID;
-        if (i->u.exit_.code == INT32_MAX) return ZI_E_INVALID;
-        // Encode "process exit requested" as rc+1 so callers can distinguish from
-        // a normal `RET` (which returns 0).
-        return i->u.exit_.code + 1;
-      case SIR_INST_EXIT_VAL: {
-        const sir_val_id_t cv = i->u.exit_val.code;
-        if (cv >= f->value_count) {
-          free(vals);
-          return ZI_E_BOUNDS;
-        }
-        const sir_value_t v = vals[cv];
-        if (v.kind == SIR_VAL_I32) {
-          free(vals);
-          if (v.u.i32 < 0) return ZI_E_INVALID;
-          if (v.u.i32 == INT32_MAX) return ZI_E_INVALID;
-          return v.u.i32 + 1;
-        }
-        if (v.kind == SIR_VAL_I64) {
-          if (v.u.i64 < INT32_MIN || v.u.i64 > INT32_MAX) {
-            free(vals);
-            return ZI_E_INVALID;
-          }
-          free(vals);
-          if (v.u.i64 < 0 || v.u.i64 == INT32_MAX) return ZI_E_INVALID;
-          return (int32_t)v.u.i64 + 1;
-        }
-        {
-          free(vals);
-          return ZI_E_INVALID;
-        }
+      nx_emit(b, (const uint8_t[]){0x48, i->k == SIR_INST_PTR_SUB ? 0x29 : 0x01, 0xC8}, 3); // add/sub rax, rcx
+      nx_store(b, frame0, dst, SIR_VAL_PTR);
+      return;
+    }
+    case SIR_INST_RET:
+    case SIR_INST_RET_VAL: {
+      nx_emit(b, (const uint8_t[]){0x49, 0x8B, 0x84, 0x24}, 4); // mov rax, [r12 + out_results]
+      nx_u32(b, (uint32_t)offsetof(sir_nx_ctx_t, out_results));
+      nx_emit(b, (const uint8_t[]){0x48, 0x85, 0xC0}, 3); // test rax, rax
+      if (i->k == SIR_INST_RET) {
+        const size_t none = nx_jcc_local(b, NX_CC_E);
+        nx_emit(b, (const uint8_t[]){0x41, 0x83, 0xBC, 0x24}, 4); // cmp dword [r12 + out_result_count], 0
+        nx_u32(b, (uint32_t)offsetof(sir_nx_ctx_t, out_result_count));
+        nx_u8(b, 0);
+        nx_jcc(b, NX_CC_NE, nx_stub(b, NX_L_INVALID));
+        nx_bind(b, none);
+      } else {
+        nx_jcc(b, NX_CC_E, nx_stub(b, NX_L_INVALID));
+        nx_emit(b, (const uint8_t[]){0x41, 0x83, 0xBC, 0x24}, 4); // cmp dword [r12 + out_result_count], 1
+        nx_u32(b, (uint32_t)offsetof(sir_nx_ctx_t, out_result_count));
+        nx_u8(b, 1);
+        nx_jcc(b, NX_CC_NE, nx_stub(b, NX_L_INVALID));
+        nx_emit(b, (const uint8_t[]){0xF3, 0x0F, 0x6F}, 3); // movdqu xmm0, [value]
+        nx_slot(b, 0, i->u.ret_val.value, 0);
+        nx_emit(b, (const uint8_t[]){0xF3, 0x0F, 0x7F, 0x00}, 4); // movdqu [rax], xmm0
       }
-      default:
-        free(vals);
-        return ZI_E_INVALID;
+      nx_emit(b, (const uint8_t[]){0x31, 0xC0}, 2); // xor eax, eax
+      nx_jmp(b, nx_stub(b, NX_L_RET));
+      return;
     }
+    case SIR_INST_CALL_FUNC: {
+      // nx_call(c, ip); a negative result is the frame's result.
+      uint64_t helper = 0;
+      int32_t (*fn)(sir_nx_ctx_t*, uint32_t) = nx_call;
+      memcpy(&helper, &fn, sizeof(fn));
+      nx_call_helper(b, helper, ip);
+      nx_emit(b, (const uint8_t[]){0x85, 0xC0}, 2); // test eax, eax
+      nx_jcc(b, NX_CC_L, nx_stub(b, NX_L_RET));
+      return;
+    }
+    default:
+      break;
   }
 
-  free(vals);
-  return 0;
+  // Loads and stores with a fast path fall back to nx_generic below.
+  nx_slow_t slow = {.n = 0};
+  if (nx_emit_mem(b, &slow, i, frame0, ip)) {
+    for (uint32_t k = 0; k < slow.n; k++) nx_bind(b, slow.at[k]);
+  }
+
+  // nx_generic(c, ip); fall through when it returns ip + 1.
+  uint64_t helper = 0;
+  uint32_t (*fn)(sir_nx_ctx_t*, uint32_t) = nx_generic;
+  memcpy(&helper, &fn, sizeof(fn));
+  nx_call_helper(b, helper, ip);
+  nx_u8(b, 0x3D); // cmp eax, imm32
+  nx_u32(b, ip + 1u);
+  nx_jcc(b, NX_CC_NE, nx_stub(b, NX_L_DISPATCH));
+}
+
+static void nx_free(sir_ncode_t* nc) {
+  if (!nc || nc == &nx_unavailable) return;
+  munmap(nc->mem, nc->size);
+  free(nc);
+}
+
+// Compiles one function. NULL when it has no frame template (oversized
+// frames) or on OOM.
+static sir_ncode_t* nx_compile(const sir_func_t* f, const sir_value_t* frame0) {
+  if (!frame0 || f->inst_count > (1u << 24)) return NULL;
+  const uint32_t n = f->inst_count;
+  uint32_t* at = (uint32_t*)malloc(((size_t)n + 1u + NX_L__COUNT) * sizeof(*at));
+  if (!at) return NULL;
+  nx_buf_t b = {.n = n};
+
+  // push rbx, r12, r13 (keeps rsp 16-byte aligned for calls); load the
+  // context registers; jump to the entry ip.
+  nx_emit(&b, (const uint8_t[]){0x53, 0x41, 0x54, 0x41, 0x55}, 5);
+  nx_emit(&b, (const uint8_t[]){0x49, 0x89, 0xFC, 0x48, 0x89, 0xF3, 0x49, 0x89, 0xD5}, 9);
+  nx_emit(&b, (const uint8_t[]){0x89, 0xC9, 0x41, 0xFF, 0x64, 0xCD, 0x00}, 7); // mov ecx, ecx; jmp [r13+rcx*8]
+  for (uint32_t ip = 0; ip < n; ip++) {
+    at[ip] = (uint32_t)b.len;
+    nx_emit_inst(&b, f, frame0, ip);
+  }
+  at[n] = (uint32_t)b.len; // falling off the end returns 0
+  nx_u8(&b, 0x31);
+  nx_u8(&b, 0xC0);
+  nx_jmp(&b, nx_stub(&b, NX_L_RET));
+  at[nx_stub(&b, NX_L_DISPATCH)] = (uint32_t)b.len; // eax = next ip, or UINT32_MAX when done
+  nx_emit(&b, (const uint8_t[]){0x83, 0xF8, 0xFF}, 3);
+  nx_jcc(&b, NX_CC_E, nx_stub(&b, NX_L_EXIT_RC));
+  nx_emit(&b, (const uint8_t[]){0x89, 0xC0, 0x41, 0xFF, 0x64, 0xC5, 0x00}, 7); // mov eax, eax; jmp [r13+rax*8]
+  at[nx_stub(&b, NX_L_INVALID)] = (uint32_t)b.len;
+  nx_u8(&b, 0xB8);
+  nx_u32(&b, (uint32_t)ZI_E_INVALID);
+  nx_jmp(&b, nx_stub(&b, NX_L_RET));
+  at[nx_stub(&b, NX_L_EXIT_RC)] = (uint32_t)b.len;
+  nx_emit(&b, (const uint8_t[]){0x41, 0x8B, 0x84, 0x24}, 4); // mov eax, [r12 + rc]
+  nx_u32(&b, (uint32_t)offsetof(sir_nx_ctx_t, rc));
+  at[nx_stub(&b, NX_L_RET)] = (uint32_t)b.len;
+  nx_emit(&b, (const uint8_t[]){0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3}, 6);
+
+  sir_ncode_t* nc = NULL;
+  if (b.oom || b.len > INT32_MAX) goto done;
+  for (size_t k = 0; k < b.fix_len; k++) {
+    const nx_fixup_t* fx = &b.fix[k];
+    const uint32_t rel = (uint32_t)((int64_t)at[fx->label] - (int64_t)(fx->at + 4u));
+    memcpy(b.p + fx->at, (const uint8_t[]){(uint8_t)rel, (uint8_t)(rel >> 8), (uint8_t)(rel >> 16), (uint8_t)(rel >> 24)}, 4);
+  }
+
+  // Code, then the table, in one mapping that is never writable and
+  // executable at once.
+  const long ps = sysconf(_SC_PAGESIZE);
+  const size_t page = ps > 0 ? (size_t)ps : 4096u;
+  const size_t code_len = (b.len + 7u) & ~(size_t)7u;
+  const size_t size = (code_len + ((size_t)n + 1u) * sizeof(void*) + page - 1u) & ~(page - 1u);
+  nc = (sir_ncode_t*)malloc(sizeof(*nc));
+  void* mem = nc ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+  if (mem == MAP_FAILED) {
+    free(nc);
+    nc = NULL;
+    goto done;
+  }
+  memcpy(mem, b.p, b.len);
+  const void** table = (const void**)(void*)((uint8_t*)mem + code_len);
+  for (uint32_t ip = 0; ip <= n; ip++) table[ip] = (const uint8_t*)mem + at[ip];
+  if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+    munmap(mem, size);
+    free(nc);
+    nc = NULL;
+    goto done;
+  }
+  nc->mem = mem;
+  nc->size = size;
+  nc->table = table;
+
+done:
+  free(at);
+  free(b.p);
+  free(b.fix);
+  return nc;
+}
+
+static int32_t nx_run(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, const sir_ncode_t* nc, uint32_t ip, sir_value_t* vals,
+                      sir_value_t* out_results, uint32_t out_result_count, uint32_t depth) {
+  sir_nx_ctx_t c = {
+      .x = x,
+      .mem = x->mem,
+      .fid = fid,
+      .f = f,
+      .vals = vals,
+      .out_results = out_results,
+      .out_result_count = out_result_count,
+      .depth = depth,
+  };
+  sir_nx_entry_t entry;
+  memcpy(&entry, &nc->mem, sizeof(entry));
+  return entry(&c, vals, nc->table, ip);
+}
+
+#else
+
+static void nx_free(sir_ncode_t* nc) { (void)nc; }
+
+static sir_ncode_t* nx_compile(const sir_func_t* f, const sir_value_t* frame0) {
+  (void)f;
+  (void)frame0;
+  return NULL;
+}
+
+static int32_t nx_run(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, const sir_ncode_t* nc, uint32_t ip, sir_value_t* vals,
+                      sir_value_t* out_results, uint32_t out_result_count, uint32_t depth) {
+  (void)x;
+  (void)fid;
+  (void)f;
+  (void)nc;
+  (void)ip;
+  (void)vals;
+  (void)out_results;
+  (void)out_result_count;
+  (void)depth;
+  return ZI_E_INTERNAL;
+}
+
+#endif
+
+// Machine code of `f`, compiled on first use; published like tx_code. NULL
+// when the function can't be compiled.
+static const sir_ncode_t* nx_code(sir_tfunc_t* tf, const sir_func_t* f) {
+  sir_ncode_t* nc = atomic_load_explicit(&tf->native, memory_order_acquire);
+  if (!nc) {
+    sir_ncode_t* fresh = nx_compile(f, tf->frame0);
+    if (!fresh) fresh = &nx_unavailable;
+    if (atomic_compare_exchange_strong_explicit(&tf->native, &nc, fresh, memory_order_acq_rel, memory_order_acquire)) {
+      nc = fresh;
+    } else {
+      nx_free(fresh);
+    }
+  }
+  return nc == &nx_unavailable ? NULL : nc;
+}
+
+static int32_t nx_func(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results,
+                       uint32_t out_result_count, uint32_t depth) {
+  const sir_module_t* m = x->m;
+  if (depth > 1024) return ZI_E_INTERNAL;
+  if (fid == 0 || fid > m->func_count) return ZI_E_NOENT;
+
+  const sir_func_t* f = &m->funcs[fid - 1];
+  const sir_ncode_t* nc = nx_code(&x->tfuncs[fid - 1], f);
+  if (!nc) return tx_func(x, fid, args, arg_count, out_results, out_result_count, depth);
+  if (!(args == NULL && arg_count == 0 && fid == m->entry) && arg_count != f->sig.param_count) return ZI_E_INVALID;
+  if (out_result_count != f->sig.result_count) return ZI_E_INVALID;
+
+  if (f->value_count > 1u << 20) return ZI_E_INVALID;
+  sir_frame_mark_t mark;
+  sir_value_t* vals = NULL;
+  const int32_t init_rc = exec_frame_enter(x, fid, f, args, arg_count, &mark, &vals);
+  if (init_rc != 0) return init_rc;
+  const int32_t rc = nx_run(x, fid, f, nc, 0, vals, out_results, out_result_count, depth);
+  exec_frame_leave(x, mark);
+  return rc;
+}
+
+// ---- Tiered engine ----
+//
+// Functions start on the switch engine, which needs no decoding, and move to
+// the native tier (threaded code where that is unavailable) once hot: after
+// hot_calls calls, or in the middle of a call once its back-edges reach
+// hot_loops (the running frame then continues at the current instruction;
+// see exec_func). The native engine is this with hot_calls = 1.
+
+static int32_t tier_call(const sir_exec_t* x, sir_func_id_t fid, const sir_value_t* args, uint32_t arg_count, sir_value_t* out_results,
+                         uint32_t out_result_count, uint32_t depth) {
+  if (fid == 0 || fid > x->m->func_count) return ZI_E_NOENT;
+  sir_tier_stats_t* st = &x->tier[fid - 1];
+  if (!st->promoted && st->calls < UINT32_MAX) {
+    st->calls++;
+    if (st->calls >= x->hot_calls) st->promoted = true;
+  }
+  if (st->promoted && x->native) return nx_func(x, fid, args, arg_count, out_results, out_result_count, depth);
+  if (st->promoted) return tx_func(x, fid, args, arg_count, out_results, out_result_count, depth);
+  return exec_func(x, fid, args, arg_count, out_results, out_result_count, depth);
+}
+
+// On-stack promotion of a running switch-engine frame at `ip`. Returns false
+// (leaving the frame to the switch engine) if no compiled code is available.
+static bool tier_osr(const sir_exec_t* x, sir_func_id_t fid, const sir_func_t* f, uint32_t ip, sir_value_t* vals, sir_value_t* out_results,
+                     uint32_t out_result_count, uint32_t depth, int32_t* out_rc) {
+  const sir_ncode_t* nc = x->native ? nx_code(&x->tfuncs[fid - 1], f) : NULL;
+  if (nc) {
+    *out_rc = nx_run(x, fid, f, nc, ip, vals, out_results, out_result_count, depth);
+    return true;
+  }
+  const sir_tinst_t* code = tx_code(&x->tfuncs[fid - 1], f);
+  if (!code) return false;
+  *out_rc = tx_loop(x, fid, f, code, ip, vals, out_results, out_result_count, depth, NULL);
+  return true;
 }
 
 const char* sir_inst_kind_name(sir_inst_kind_t k) {
@@ -3884,10 +7826,126 @@ const char* sir_inst_kind_name(sir_inst_kind_t k) {
       return "i32.cmp.ugt";
     case SIR_INST_I32_CMP_UGE:
       return "i32.cmp.uge";
+    case SIR_INST_I64_ADD:
+      return "i64.add";
+    case SIR_INST_I64_SUB:
+      return "i64.sub";
+    case SIR_INST_I64_MUL:
+      return "i64.mul";
+    case SIR_INST_I64_AND:
+      return "i64.and";
+    case SIR_INST_I64_OR:
+      return "i64.or";
+    case SIR_INST_I64_XOR:
+      return "i64.xor";
+    case SIR_INST_I64_NOT:
+      return "i64.not";
+    case SIR_INST_I64_NEG:
+      return "i64.neg";
+    case SIR_INST_I64_SHL:
+      return "i64.shl";
+    case SIR_INST_I64_SHR_S:
+      return "i64.shr.s";
+    case SIR_INST_I64_SHR_U:
+      return "i64.shr.u";
+    case SIR_INST_I64_DIV_S_SAT:
+      return "i64.div.s.sat";
+    case SIR_INST_I64_DIV_S_TRAP:
+      return "i64.div.s.trap";
+    case SIR_INST_I64_DIV_U_SAT:
+      return "i64.div.u.sat";
+    case SIR_INST_I64_REM_S_SAT:
+      return "i64.rem.s.sat";
+    case SIR_INST_I64_REM_U_SAT:
+      return "i64.rem.u.sat";
+    case SIR_INST_I64_CMP_EQ:
+      return "i64.cmp.eq";
+    case SIR_INST_I64_CMP_NE:
+      return "i64.cmp.ne";
+    case SIR_INST_I64_CMP_SLT:
+      return "i64.cmp.slt";
+    case SIR_INST_I64_CMP_SLE:
+      return "i64.cmp.sle";
+    case SIR_INST_I64_CMP_SGT:
+      return "i64.cmp.sgt";
+    case SIR_INST_I64_CMP_SGE:
+      return "i64.cmp.sge";
+    case SIR_INST_I64_CMP_ULT:
+      return "i64.cmp.ult";
+    case SIR_INST_I64_CMP_ULE:
+      return "i64.cmp.ule";
+    case SIR_INST_I64_CMP_UGT:
+      return "i64.cmp.ugt";
+    case SIR_INST_I64_CMP_UGE:
+      return "i64.cmp.uge";
+    case SIR_INST_F32_ADD:
+      return "f32.add";
+    case SIR_INST_F32_SUB:
+      return "f32.sub";
+    case SIR_INST_F32_MUL:
+      return "f32.mul";
+    case SIR_INST_F32_DIV:
+      return "f32.div";
+    case SIR_INST_F32_NEG:
+      return "f32.neg";
+    case SIR_INST_F64_ADD:
+      return "f64.add";
+    case SIR_INST_F64_SUB:
+      return "f64.sub";
+    case SIR_INST_F64_MUL:
+      return "f64.mul";
+    case SIR_INST_F64_DIV:
+      return "f64.div";
+    case SIR_INST_F64_NEG:
+      return "f64.neg";
+    case SIR_INST_F32_CMP_OEQ:
+      return "f32.cmp.oeq";
+    case SIR_INST_F32_CMP_ONE:
+      return "f32.cmp.one";
+    case SIR_INST_F32_CMP_OLT:
+      return "f32.cmp.olt";
+    case SIR_INST_F32_CMP_OLE:
+      return "f32.cmp.ole";
+    case SIR_INST_F32_CMP_OGT:
+      return "f32.cmp.ogt";
+    case SIR_INST_F32_CMP_OGE:
+      return "f32.cmp.oge";
     case SIR_INST_F32_CMP_UEQ:
       return "f32.cmp.ueq";
+    case SIR_INST_F32_CMP_UNE:
+      return "f32.cmp.une";
+    case SIR_INST_F32_CMP_ULT:
+      return "f32.cmp.ult";
+    case SIR_INST_F32_CMP_ULE:
+      return "f32.cmp.ule";
+    case SIR_INST_F32_CMP_UGT:
+      return "f32.cmp.ugt";
+    case SIR_INST_F32_CMP_UGE:
+      return "f32.cmp.uge";
+    case SIR_INST_F64_CMP_OEQ:
+      return "f64.cmp.oeq";
+    case SIR_INST_F64_CMP_ONE:
+      return "f64.cmp.one";
     case SIR_INST_F64_CMP_OLT:
       return "f64.cmp.olt";
+    case SIR_INST_F64_CMP_OLE:
+      return "f64.cmp.ole";
+    case SIR_INST_F64_CMP_OGT:
+      return "f64.cmp.ogt";
+    case SIR_INST_F64_CMP_OGE:
+      return "f64.cmp.oge";
+    case SIR_INST_F64_CMP_UEQ:
+      return "f64.cmp.ueq";
+    case SIR_INST_F64_CMP_UNE:
+      return "f64.cmp.une";
+    case SIR_INST_F64_CMP_ULT:
+      return "f64.cmp.ult";
+    case SIR_INST_F64_CMP_ULE:
+      return "f64.cmp.ule";
+    case SIR_INST_F64_CMP_UGT:
+      return "f64.cmp.ugt";
+    case SIR_INST_F64_CMP_UGE:
+      return "f64.cmp.uge";
     case SIR_INST_GLOBAL_ADDR:
       return "global.addr";
     case SIR_INST_PTR_OFFSET:
@@ -3920,6 +7978,44 @@ const char* sir_inst_kind_name(sir_inst_kind_t k) {
       return "i64.zext.i32";
     case SIR_INST_I32_TRUNC_I64:
       return "i32.trunc.i64";
+    case SIR_INST_I64_SEXT_I32:
+      return "i64.sext.i32";
+    case SIR_INST_F32_FROM_I32_S:
+      return "f32.from_i32.s";
+    case SIR_INST_F32_FROM_I32_U:
+      return "f32.from_i32.u";
+    case SIR_INST_F32_FROM_I64_S:
+      return "f32.from_i64.s";
+    case SIR_INST_F32_FROM_I64_U:
+      return "f32.from_i64.u";
+    case SIR_INST_F64_FROM_I32_S:
+      return "f64.from_i32.s";
+    case SIR_INST_F64_FROM_I32_U:
+      return "f64.from_i32.u";
+    case SIR_INST_F64_FROM_I64_S:
+      return "f64.from_i64.s";
+    case SIR_INST_F64_FROM_I64_U:
+      return "f64.from_i64.u";
+    case SIR_INST_I32_TRUNC_SAT_F32_S:
+      return "i32.trunc_sat_f32.s";
+    case SIR_INST_I32_TRUNC_SAT_F32_U:
+      return "i32.trunc_sat_f32.u";
+    case SIR_INST_I32_TRUNC_SAT_F64_S:
+      return "i32.trunc_sat_f64.s";
+    case SIR_INST_I32_TRUNC_SAT_F64_U:
+      return "i32.trunc_sat_f64.u";
+    case SIR_INST_I64_TRUNC_SAT_F32_S:
+      return "i64.trunc_sat_f32.s";
+    case SIR_INST_I64_TRUNC_SAT_F32_U:
+      return "i64.trunc_sat_f32.u";
+    case SIR_INST_I64_TRUNC_SAT_F64_S:
+      return "i64.trunc_sat_f64.s";
+    case SIR_INST_I64_TRUNC_SAT_F64_U:
+      return "i64.trunc_sat_f64.u";
+    case SIR_INST_F64_PROMOTE_F32:
+      return "f64.promote_f32";
+    case SIR_INST_F32_DEMOTE_F64:
+      return "f32.demote_f64";
     case SIR_INST_SELECT:
       return "select";
     case SIR_INST_BR:
@@ -3932,6 +8028,18 @@ const char* sir_inst_kind_name(sir_inst_kind_t k) {
       return "mem.copy";
     case SIR_INST_MEM_FILL:
       return "mem.fill";
+    case SIR_INST_VEC_SPLAT_I32:
+      return "vec.splat.i32";
+    case SIR_INST_VEC_SPLAT_BOOL:
+      return "vec.splat.bool";
+    case SIR_INST_VEC_I32_ADD:
+      return "vec.add.i32";
+    case SIR_INST_VEC_I32_CMP_EQ:
+      return "vec.cmp.eq.i32";
+    case SIR_INST_VEC_I32_CMP_SLT:
+      return "vec.cmp.lt.i32";
+    case SIR_INST_VEC_SELECT_I32:
+      return "vec.select.i32";
     case SIR_INST_ATOMIC_RMW_I8:
       return "atomic.rmw.i8";
     case SIR_INST_ATOMIC_RMW_I16:
@@ -3996,37 +8104,205 @@ int32_t sir_module_run(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t h
 }
 
 int32_t sir_module_run_ex(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const sir_exec_event_sink_t* sink) {
+  return sir_module_run_opts(m, mem, host, sink, NULL);
+}
+
+struct sir_module_state {
+  const sir_module_t* m;
+  zi_ptr_t* globals;
+};
+
+static bool exec_engine_ok(const sir_exec_opts_t* opts) {
+  const sir_exec_engine_t engine = opts ? opts->engine : SIR_EXEC_ENGINE_DEFAULT;
+  return engine == SIR_EXEC_ENGINE_DEFAULT || engine == SIR_EXEC_ENGINE_SWITCH || engine == SIR_EXEC_ENGINE_THREADED ||
+         engine == SIR_EXEC_ENGINE_TIERED || engine == SIR_EXEC_ENGINE_NATIVE;
+}
+
+// Allocates and initializes every global in `mem`.
+static int32_t module_globals_init(const sir_module_t* m, sem_guest_mem_t* mem, zi_ptr_t** out) {
+  *out = NULL;
+  if (!m->global_count) return 0;
+  zi_ptr_t* globals = (zi_ptr_t*)calloc(m->global_count, sizeof(*globals));
+  if (!globals) return ZI_E_OOM;
+  for (uint32_t i = 0; i < m->global_count; i++) {
+    const sir_global_t* g = &m->globals[i];
+    const zi_ptr_t p = sem_guest_alloc(mem, (zi_size32_t)g->size, (zi_size32_t)g->align);
+    if (!p) {
+      free(globals);
+      return ZI_E_OOM;
+    }
+    globals[i] = p;
+
+    uint8_t* w = NULL;
+    if (!sem_guest_mem_map_rw(mem, p, (zi_size32_t)g->size, &w) || !w) {
+      free(globals);
+      return ZI_E_BOUNDS;
+    }
+    memset(w, 0, g->size);
+    if (g->init_len) {
+      memcpy(w, g->init_bytes, g->init_len);
+    }
+  }
+  *out = globals;
+  return 0;
+}
+
+static int32_t module_exec(const sir_module_t* m, const zi_ptr_t* globals, sem_guest_mem_t* mem, sir_host_t host,
+                           const sir_exec_event_sink_t* sink, const sir_exec_opts_t* opts) {
+  const sir_exec_engine_t engine = opts ? opts->engine : SIR_EXEC_ENGINE_DEFAULT;
+  const sir_module_impl_t* impl = module_impl_from_pub((sir_module_t*)m);
+  sir_tfunc_t* tfuncs = impl->tfuncs;
+  sir_frame_arena_t frames = {0};
+  const bool native = engine == SIR_EXEC_ENGINE_NATIVE;
+  // A sink without hooks is no sink: the run takes the uninstrumented paths.
+  if (sink && !sink->on_step && !sink->on_mem && !sink->on_hostcall) sink = NULL;
+  // Nor is one whose func_mask leaves every function out.
+  if (sink && sink->func_mask) {
+    uint32_t on = 0;
+    for (uint32_t i = 0; i < m->func_count && !on; i++) on = sink->func_mask[i];
+    if (!on) sink = NULL;
+  }
+  sir_tier_stats_t* tier = NULL;
+  if ((engine == SIR_EXEC_ENGINE_TIERED || native) && tfuncs) {
+    tier = opts->tier_stats ? opts->tier_stats : (sir_tier_stats_t*)calloc(m->func_count, sizeof(*tier));
+    if (!tier) return ZI_E_OOM;
+    memset(tier, 0, m->func_count * sizeof(*tier));
+  }
+  const sir_exec_sampler_t* sampler = opts && opts->sampler && opts->sampler->on_sample && opts->sampler->period ? opts->sampler : NULL;
+  sir_exec_prof_t* prof = sampler ? (sir_exec_prof_t*)calloc(1, sizeof(*prof)) : NULL;
+  if (sampler && !prof) {
+    if (tier && tier != opts->tier_stats) free(tier);
+    return ZI_E_OOM;
+  }
+  if (prof) {
+    prof->s = sampler;
+    prof->left = sampler->period;
+  }
+  const sir_exec_t x = {
+      .m = m,
+      .mem = mem,
+      .host = host,
+      .globals = globals,
+      .global_count = m->global_count,
+      .sink = sink,
+      .tfuncs = tfuncs,
+      .sym_hostcall = impl->sym_hostcall,
+      .frames = &frames,
+      .tier = tier,
+      .hot_calls = native ? 1u : tier && opts->hot_calls ? opts->hot_calls : SIR_TIER_HOT_CALLS,
+      .hot_loops = tier && opts->hot_loops ? opts->hot_loops : SIR_TIER_HOT_LOOPS,
+      .native = SIR_EXEC_NATIVE && tier && !sink && !prof,
+      .prof = prof,
+  };
+  // The threaded engine needs frame templates; without them (OOM at finalize)
+  // the switch engine runs instead.
+  int32_t r = 0;
+  if (tier) r = tier_call(&x, m->entry, NULL, 0, NULL, 0, 0);
+  else if (engine != SIR_EXEC_ENGINE_SWITCH && tfuncs) r = tx_func(&x, m->entry, NULL, 0, NULL, 0, 0);
+  else r = exec_func(&x, m->entry, NULL, 0, NULL, 0, 0);
+  frame_arena_dispose(&frames);
+  free(prof);
+  if (tier && tier != opts->tier_stats) free(tier);
+  if (r > 0) return r - 1;
+  return r;
+}
+
+int32_t sir_module_run_opts(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const sir_exec_event_sink_t* sink,
+                            const sir_exec_opts_t* opts) {
   if (!m || !mem) return ZI_E_INTERNAL;
+  if (!exec_engine_ok(opts)) return ZI_E_INVALID;
   char err[160];
   if (!sir_module_validate(m, err, sizeof(err))) return ZI_E_INVALID;
-
   zi_ptr_t* globals = NULL;
-  if (m->global_count) {
-    globals = (zi_ptr_t*)calloc(m->global_count, sizeof(*globals));
-    if (!globals) return ZI_E_OOM;
-    for (uint32_t i = 0; i < m->global_count; i++) {
-      const sir_global_t* g = &m->globals[i];
-      const zi_ptr_t p = sem_guest_alloc(mem, (zi_size32_t)g->size, (zi_size32_t)g->align);
-      if (!p) {
-        free(globals);
-        return ZI_E_OOM;
-      }
-      globals[i] = p;
+  const int32_t rc = module_globals_init(m, mem, &globals);
+  if (rc < 0) return rc;
+  const int32_t r = module_exec(m, globals, mem, host, sink, opts);
+  free(globals);
+  return r;
+}
 
-      uint8_t* w = NULL;
-      if (!sem_guest_mem_map_rw(mem, p, (zi_size32_t)g->size, &w) || !w) {
-        free(globals);
-        return ZI_E_BOUNDS;
-      }
-      memset(w, 0, g->size);
-      if (g->init_len) {
-        memcpy(w, g->init_bytes, g->init_len);
+int32_t sir_module_state_init(const sir_module_t* m, sem_guest_mem_t* mem, sir_module_state_t** out) {
+  if (!out) return ZI_E_INVALID;
+  *out = NULL;
+  if (!m || !mem) return ZI_E_INTERNAL;
+  char err[160];
+  if (!sir_module_validate(m, err, sizeof(err))) return ZI_E_INVALID;
+  sir_module_state_t* st = (sir_module_state_t*)calloc(1, sizeof(*st));
+  if (!st) return ZI_E_OOM;
+  st->m = m;
+  const int32_t rc = module_globals_init(m, mem, &st->globals);
+  if (rc < 0) {
+    free(st);
+    return rc;
+  }
+  *out = st;
+  return 0;
+}
+
+int32_t sir_module_state_run(const sir_module_state_t* st, sem_guest_mem_t* mem, sir_host_t host, const sir_exec_event_sink_t* sink,
+                             const sir_exec_opts_t* opts) {
+  if (!st || !mem) return ZI_E_INTERNAL;
+  if (!exec_engine_ok(opts)) return ZI_E_INVALID;
+  return module_exec(st->m, st->globals, mem, host, sink, opts);
+}
+
+void sir_module_state_free(sir_module_state_t* st) {
+  if (!st) return;
+  free(st->globals);
+  free(st);
+}
+
+struct sir_pair_profile {
+  uint64_t steps;
+  sir_func_id_t last_fid; // 0 before the first step
+  uint32_t last_ip;
+  sir_inst_kind_t last_k;
+  uint64_t counts[SIR_INST_KIND_COUNT][SIR_INST_KIND_COUNT];
+};
+
+sir_pair_profile_t* sir_pair_profile_new(void) { return (sir_pair_profile_t*)calloc(1, sizeof(sir_pair_profile_t)); }
+
+void sir_pair_profile_free(sir_pair_profile_t* p) { free(p); }
+
+static void pair_profile_on_step(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_inst_kind_t k) {
+  (void)m;
+  sir_pair_profile_t* p = (sir_pair_profile_t*)user;
+  p->steps++;
+  // Returning from a call resumes the caller right after the call, but the
+  // last step seen was in the callee, so calls never pair with what follows.
+  if (p->last_fid == fid && ip == p->last_ip + 1u && (uint32_t)p->last_k < SIR_INST_KIND_COUNT && (uint32_t)k < SIR_INST_KIND_COUNT) {
+    p->counts[p->last_k][k]++;
+  }
+  p->last_fid = fid;
+  p->last_ip = ip;
+  p->last_k = k;
+}
+
+sir_exec_event_sink_t sir_pair_profile_sink(sir_pair_profile_t* p) {
+  sir_exec_event_sink_t s;
+  memset(&s, 0, sizeof(s));
+  s.user = p;
+  s.on_step = p ? pair_profile_on_step : NULL;
+  return s;
+}
+
+uint64_t sir_pair_profile_steps(const sir_pair_profile_t* p) { return p ? p->steps : 0; }
+
+uint32_t sir_pair_profile_top(const sir_pair_profile_t* p, sir_pair_count_t* out, uint32_t max) {
+  if (!p || !out) return 0;
+  // Insertion into a sorted array of at most `max` entries.
+  uint32_t n = 0;
+  for (uint32_t a = 0; a < SIR_INST_KIND_COUNT; a++) {
+    for (uint32_t b = 0; b < SIR_INST_KIND_COUNT; b++) {
+      const uint64_t c = p->counts[a][b];
+      if (!c || (n == max && (max == 0 || out[max - 1].count >= c))) continue;
+      uint32_t at = n < max ? n++ : max - 1u;
+      while (at > 0 && out[at - 1].count < c) {
+        out[at] = out[at - 1];
+        at--;
       }
+      out[at] = (sir_pair_count_t){.first = (sir_inst_kind_t)a, .second = (sir_inst_kind_t)b, .count = c};
     }
   }
-
-  const int32_t r = exec_func(m, mem, host, globals, m->global_count, m->entry, NULL, 0, NULL, 0, 0, sink);
-  free(globals);
-  if (r > 0) return r - 1;
-  return r;
+  return n;
 }
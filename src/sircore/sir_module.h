@@ -135,8 +135,68 @@ typedef enum sir_inst_kind {
   SIR_INST_I32_CMP_ULE,
   SIR_INST_I32_CMP_UGT,
   SIR_INST_I32_CMP_UGE,
+  // I64 ops mirror the I32 ones (shift counts are masked to 63). Float
+  // results are NaN-canonical; float compares follow LLVM fcmp predicates.
+  SIR_INST_I64_ADD,
+  SIR_INST_I64_SUB,
+  SIR_INST_I64_MUL,
+  SIR_INST_I64_AND,
+  SIR_INST_I64_OR,
+  SIR_INST_I64_XOR,
+  SIR_INST_I64_NOT,
+  SIR_INST_I64_NEG,
+  SIR_INST_I64_SHL,
+  SIR_INST_I64_SHR_S,
+  SIR_INST_I64_SHR_U,
+  SIR_INST_I64_DIV_S_SAT,
+  SIR_INST_I64_DIV_S_TRAP,
+  SIR_INST_I64_DIV_U_SAT,
+  SIR_INST_I64_REM_S_SAT,
+  SIR_INST_I64_REM_U_SAT,
+  SIR_INST_I64_CMP_EQ,
+  SIR_INST_I64_CMP_NE,
+  SIR_INST_I64_CMP_SLT,
+  SIR_INST_I64_CMP_SLE,
+  SIR_INST_I64_CMP_SGT,
+  SIR_INST_I64_CMP_SGE,
+  SIR_INST_I64_CMP_ULT,
+  SIR_INST_I64_CMP_ULE,
+  SIR_INST_I64_CMP_UGT,
+  SIR_INST_I64_CMP_UGE,
+  SIR_INST_F32_ADD,
+  SIR_INST_F32_SUB,
+  SIR_INST_F32_MUL,
+  SIR_INST_F32_DIV,
+  SIR_INST_F32_NEG,
+  SIR_INST_F64_ADD,
+  SIR_INST_F64_SUB,
+  SIR_INST_F64_MUL,
+  SIR_INST_F64_DIV,
+  SIR_INST_F64_NEG,
+  SIR_INST_F32_CMP_OEQ,
+  SIR_INST_F32_CMP_ONE,
+  SIR_INST_F32_CMP_OLT,
+  SIR_INST_F32_CMP_OLE,
+  SIR_INST_F32_CMP_OGT,
+  SIR_INST_F32_CMP_OGE,
   SIR_INST_F32_CMP_UEQ,
+  SIR_INST_F32_CMP_UNE,
+  SIR_INST_F32_CMP_ULT,
+  SIR_INST_F32_CMP_ULE,
+  SIR_INST_F32_CMP_UGT,
+  SIR_INST_F32_CMP_UGE,
+  SIR_INST_F64_CMP_OEQ,
+  SIR_INST_F64_CMP_ONE,
   SIR_INST_F64_CMP_OLT,
+  SIR_INST_F64_CMP_OLE,
+  SIR_INST_F64_CMP_OGT,
+  SIR_INST_F64_CMP_OGE,
+  SIR_INST_F64_CMP_UEQ,
+  SIR_INST_F64_CMP_UNE,
+  SIR_INST_F64_CMP_ULT,
+  SIR_INST_F64_CMP_ULE,
+  SIR_INST_F64_CMP_UGT,
+  SIR_INST_F64_CMP_UGE,
   SIR_INST_GLOBAL_ADDR, // yields ptr to module global
   SIR_INST_PTR_OFFSET,  // yields ptr = base + index*scale
   SIR_INST_PTR_ADD,     // yields ptr = base + off (bytes)
@@ -153,12 +213,42 @@ typedef enum sir_inst_kind {
   SIR_INST_I32_ZEXT_I16,
   SIR_INST_I64_ZEXT_I32,
   SIR_INST_I32_TRUNC_I64,
+  SIR_INST_I64_SEXT_I32,
+  // int->float rounds to nearest; TRUNC_SAT clamps to the target range (NaN -> 0).
+  SIR_INST_F32_FROM_I32_S,
+  SIR_INST_F32_FROM_I32_U,
+  SIR_INST_F32_FROM_I64_S,
+  SIR_INST_F32_FROM_I64_U,
+  SIR_INST_F64_FROM_I32_S,
+  SIR_INST_F64_FROM_I32_U,
+  SIR_INST_F64_FROM_I64_S,
+  SIR_INST_F64_FROM_I64_U,
+  SIR_INST_I32_TRUNC_SAT_F32_S,
+  SIR_INST_I32_TRUNC_SAT_F32_U,
+  SIR_INST_I32_TRUNC_SAT_F64_S,
+  SIR_INST_I32_TRUNC_SAT_F64_U,
+  SIR_INST_I64_TRUNC_SAT_F32_S,
+  SIR_INST_I64_TRUNC_SAT_F32_U,
+  SIR_INST_I64_TRUNC_SAT_F64_S,
+  SIR_INST_I64_TRUNC_SAT_F64_U,
+  SIR_INST_F64_PROMOTE_F32,
+  SIR_INST_F32_DEMOTE_F64,
   SIR_INST_SELECT,      // yields value: cond ? a : b
   SIR_INST_BR,
   SIR_INST_CBR,
   SIR_INST_SWITCH,
   SIR_INST_MEM_COPY,
   SIR_INST_MEM_FILL,
+  // Whole-vector ops on vectors stored in guest memory (simd:v1). Operands are
+  // ptrs to `lanes` contiguous lanes: i32 lanes are 4 bytes (4-aligned), bool
+  // lanes 1 byte (0/1 on write, nonzero = true on read). dst may equal an
+  // input of the same lane width but must not otherwise overlap one.
+  SIR_INST_VEC_SPLAT_I32,   // dst[i] = a (i32 value)
+  SIR_INST_VEC_SPLAT_BOOL,  // dst[i] = a (bool value)
+  SIR_INST_VEC_I32_ADD,     // i32 dst[i] = a[i] + b[i]
+  SIR_INST_VEC_I32_CMP_EQ,  // bool dst[i] = a[i] == b[i]
+  SIR_INST_VEC_I32_CMP_SLT, // bool dst[i] = a[i] < b[i] (signed)
+  SIR_INST_VEC_SELECT_I32,  // i32 dst[i] = mask[i] ? a[i] : b[i]
   // Atomics (single-thread semantics; used by sem lowering)
   SIR_INST_ATOMIC_RMW_I8,
   SIR_INST_ATOMIC_RMW_I16,
@@ -268,11 +358,25 @@ typedef struct sir_inst {
       sir_val_id_t b;
       sir_val_id_t dst;
     } i32_cmp_eq;
+    struct {
+      sir_val_id_t a;
+      sir_val_id_t b;
+      sir_val_id_t dst;
+    } i64_bin; // I64 arithmetic and compares
+    struct {
+      sir_val_id_t a;
+      sir_val_id_t b;
+      sir_val_id_t dst;
+    } f_bin;
     struct {
       sir_val_id_t a;
       sir_val_id_t b;
       sir_val_id_t dst;
     } f_cmp;
+    struct {
+      sir_val_id_t x;
+      sir_val_id_t dst;
+    } num_un; // I64_NOT/NEG, F32/F64_NEG and the numeric conversions
     struct {
       sir_global_id_t gid;
       sir_val_id_t dst;
@@ -366,6 +470,13 @@ typedef struct sir_inst {
       sir_val_id_t byte;
       sir_val_id_t len;
     } mem_fill;
+    struct {
+      sir_val_id_t dst;
+      sir_val_id_t a;
+      sir_val_id_t b;    // unused by splat
+      sir_val_id_t mask; // select only
+      uint32_t lanes;
+    } vec;
     struct {
       sir_val_id_t addr;
       sir_val_id_t value;
@@ -426,12 +537,21 @@ typedef struct sir_inst {
   } u;
 } sir_inst_t;
 
+// A source CFG block: its instructions start at `ip` and run up to the next
+// block's start. Frontends key block/edge profiles by `node_id`.
+typedef struct sir_block {
+  uint32_t ip;
+  uint32_t node_id; // frontend node id (SEM: interned SIR node id)
+} sir_block_t;
+
 typedef struct sir_func {
   const char* name;           // owned by module
   const sir_inst_t* insts;    // module-owned
   uint32_t inst_count;
   uint32_t value_count;       // number of value slots (0..N-1), for executor table sizing
   sir_sig_t sig;              // points into module-owned arrays (0 or 1 result for MVP)
+  const sir_block_t* blocks;  // module-owned, ascending ip; NULL when the frontend has no CFG blocks
+  uint32_t block_count;
 } sir_func_t;
 
 typedef struct sir_module {
@@ -462,6 +582,9 @@ typedef struct sir_exec_event_sink {
   void (*on_step)(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_inst_kind_t k);
   void (*on_mem)(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_mem_event_kind_t k, zi_ptr_t addr, uint32_t size);
   void (*on_hostcall)(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, const char* callee, int32_t rc);
+  // Optional, indexed by fid - 1 (func_count entries). Functions whose entry
+  // is 0 raise no events and run on the uninstrumented paths.
+  const uint8_t* func_mask;
 } sir_exec_event_sink_t;
 
 // Returns a stable short name for an instruction kind (for trace output).
@@ -488,6 +611,8 @@ sir_func_id_t sir_mb_func_begin(sir_module_builder_t* b, const char* name);
 bool sir_mb_func_set_entry(sir_module_builder_t* b, sir_func_id_t f);
 bool sir_mb_func_set_value_count(sir_module_builder_t* b, sir_func_id_t f, uint32_t value_count);
 bool sir_mb_func_set_sig(sir_module_builder_t* b, sir_func_id_t f, sir_sig_t sig);
+// Records f's source CFG blocks (copied; ips strictly ascending).
+bool sir_mb_func_set_blocks(sir_module_builder_t* b, sir_func_id_t f, const sir_block_t* blocks, uint32_t block_count);
 
 bool sir_mb_emit_const_i1(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, bool v);
 bool sir_mb_emit_const_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, int32_t v);
@@ -527,8 +652,66 @@ bool sir_mb_emit_i32_cmp_ult(sir_module_builder_t* b, sir_func_id_t f, sir_val_i
 bool sir_mb_emit_i32_cmp_ule(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
 bool sir_mb_emit_i32_cmp_ugt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
 bool sir_mb_emit_i32_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_sub(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_mul(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_and(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_or(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_xor(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_not(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i64_neg(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i64_shl(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, sir_val_id_t shift);
+bool sir_mb_emit_i64_shr_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, sir_val_id_t shift);
+bool sir_mb_emit_i64_shr_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, sir_val_id_t shift);
+bool sir_mb_emit_i64_div_s_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_div_s_trap(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_div_u_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_rem_s_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_rem_u_sat(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_eq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_ne(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_slt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_sle(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_sgt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_sge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_ult(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_ule(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_ugt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_i64_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_sub(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_mul(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_div(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_neg(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f64_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_sub(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_mul(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_div(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_neg(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f32_cmp_oeq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_one(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_olt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_ole(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_ogt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_oge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
 bool sir_mb_emit_f32_cmp_ueq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_une(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_ult(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_ule(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_ugt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f32_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_oeq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_one(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
 bool sir_mb_emit_f64_cmp_olt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_ole(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_ogt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_oge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_ueq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_une(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_ult(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_ule(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_ugt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
+bool sir_mb_emit_f64_cmp_uge(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_);
 bool sir_mb_emit_global_addr(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_global_id_t gid);
 bool sir_mb_emit_ptr_offset(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t base, sir_val_id_t index, uint32_t scale);
 bool sir_mb_emit_ptr_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t base, sir_val_id_t off);
@@ -545,6 +728,25 @@ bool sir_mb_emit_i32_zext_i8(sir_module_builder_t* b, sir_func_id_t f, sir_val_i
 bool sir_mb_emit_i32_zext_i16(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
 bool sir_mb_emit_i64_zext_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
 bool sir_mb_emit_i32_trunc_i64(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i64_sext_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f32_from_i32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f32_from_i32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f32_from_i64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f32_from_i64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f64_from_i32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f64_from_i32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f64_from_i64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f64_from_i64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i32_trunc_sat_f32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i32_trunc_sat_f32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i32_trunc_sat_f64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i32_trunc_sat_f64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i64_trunc_sat_f32_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i64_trunc_sat_f32_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i64_trunc_sat_f64_s(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_i64_trunc_sat_f64_u(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f64_promote_f32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
+bool sir_mb_emit_f32_demote_f64(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x);
 bool sir_mb_emit_select(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t cond, sir_val_id_t a, sir_val_id_t b_);
 bool sir_mb_emit_br_args(sir_module_builder_t* b, sir_func_id_t f, uint32_t target_ip, const sir_val_id_t* src_slots, const sir_val_id_t* dst_slots,
                          uint32_t arg_count, uint32_t* out_ip);
@@ -554,6 +756,13 @@ bool sir_mb_emit_switch(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t s
                         uint32_t case_count, uint32_t default_ip, uint32_t* out_ip);
 bool sir_mb_emit_mem_copy(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t src, sir_val_id_t len, bool overlap_allow);
 bool sir_mb_emit_mem_fill(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t byte, sir_val_id_t len);
+bool sir_mb_emit_vec_splat_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, uint32_t lanes);
+bool sir_mb_emit_vec_splat_bool(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t x, uint32_t lanes);
+bool sir_mb_emit_vec_i32_add(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_, uint32_t lanes);
+bool sir_mb_emit_vec_i32_cmp_eq(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_, uint32_t lanes);
+bool sir_mb_emit_vec_i32_cmp_slt(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t a, sir_val_id_t b_, uint32_t lanes);
+bool sir_mb_emit_vec_select_i32(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst, sir_val_id_t mask, sir_val_id_t a, sir_val_id_t b_,
+                                uint32_t lanes);
 bool sir_mb_emit_atomic_rmw_i8(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst_old, sir_val_id_t addr, sir_val_id_t value,
                                sir_atomic_rmw_op_t op, uint32_t align);
 bool sir_mb_emit_atomic_rmw_i16(sir_module_builder_t* b, sir_func_id_t f, sir_val_id_t dst_old, sir_val_id_t addr, sir_val_id_t value,
@@ -602,9 +811,29 @@ bool sir_mb_patch_switch(sir_module_builder_t* b, sir_func_id_t f, uint32_t ip,
 // Returns NULL on OOM or malformed builder state.
 sir_module_t* sir_mb_finalize(sir_module_builder_t* b);
 
-// Free a finalized module (returned by sir_mb_finalize). Safe to pass NULL.
+// Free a finalized module (returned by sir_mb_finalize or
+// sir_module_image_load). Safe to pass NULL.
 void sir_module_free(sir_module_t* m);
 
+// Module images: a finalized module flattened into one relocatable blob
+// (types, syms, globals, funcs and their instruction arrays), so frontends can
+// cache a validated module and load it back without rebuilding it.
+// An image is tied to the sircore build that wrote it (layout version, pointer
+// size, byte order) and carries a checksum; anything else fails to load.
+#define SIR_MODULE_IMAGE_VERSION 2u
+
+// Serializes `m` into a malloc'd image. Returns false on OOM.
+bool sir_module_image_build(const sir_module_t* m, uint8_t** out, size_t* out_len);
+
+// Loads an image in place: pointer fields are relocated inside `image`, which
+// must be writable, 8-byte aligned and live until the module is freed.
+// sir_module_free then calls release(image, len) when release is non-NULL.
+// The module is not re-validated; images should only come from modules that
+// passed sir_module_validate. Returns NULL when the image is malformed or was
+// written by a different build; `image` then stays with the caller, possibly
+// partly relocated.
+sir_module_t* sir_module_image_load(void* image, size_t len, void (*release)(void* image, size_t len));
+
 // Validate a module for basic semantic/structural invariants.
 // Returns true if valid; on failure, writes a short message into `err` when provided.
 bool sir_module_validate(const sir_module_t* m, char* err, size_t err_cap);
@@ -632,3 +861,99 @@ int32_t sir_module_run(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t h
 // Execution with an optional event sink.
 // The sink callbacks are best-effort and must not affect execution.
 int32_t sir_module_run_ex(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const sir_exec_event_sink_t* sink);
+
+// Interpreter selection.
+// The threaded engine runs code decoded once per function (on its first call)
+// and skips the operand checks that sir_module_validate already proved; the
+// switch engine walks sir_inst_t directly and re-checks everything. The tiered
+// engine starts every function on the switch engine and promotes hot ones to
+// the native tier; calls cross freely between tiers. The native engine
+// compiles every function to x86-64 machine code on its first call.
+// Native code is used only on x86-64 hosts and for runs without an event
+// sink; elsewhere the threaded engine stands in for it. All engines observe
+// the same semantics and emit the same events.
+typedef enum sir_exec_engine {
+  SIR_EXEC_ENGINE_DEFAULT = 0, // threaded
+  SIR_EXEC_ENGINE_SWITCH = 1,
+  SIR_EXEC_ENGINE_THREADED = 2,
+  SIR_EXEC_ENGINE_TIERED = 3,
+  SIR_EXEC_ENGINE_NATIVE = 4,
+} sir_exec_engine_t;
+
+// Default promotion thresholds for the tiered engine.
+#define SIR_TIER_HOT_CALLS 16u
+#define SIR_TIER_HOT_LOOPS 256u
+
+// Per-function tiering counters for one run.
+typedef struct sir_tier_stats {
+  uint32_t calls;      // entries, including ones after promotion
+  uint32_t back_edges; // backward branches taken while interpreted
+  bool promoted;       // runs on the native tier from now on
+} sir_tier_stats_t;
+
+// Call-stack sampling. The VM keeps a shadow stack of the active function
+// ids (every engine's calls and returns update it) and, every `period`
+// instructions (the ones on_step would see), passes it to on_sample,
+// outermost frame first, with the ip of the instruction about to run.
+// Sampled runs skip the native tier.
+typedef struct sir_exec_sampler {
+  void* user;
+  uint32_t period; // > 0
+  void (*on_sample)(void* user, const sir_module_t* m, const sir_func_id_t* stack, uint32_t depth, uint32_t ip);
+} sir_exec_sampler_t;
+
+typedef struct sir_exec_opts {
+  sir_exec_engine_t engine;
+
+  // SIR_EXEC_ENGINE_TIERED only. A function is promoted once it has been
+  // entered hot_calls times or has taken hot_loops back-edges (0 selects the
+  // SIR_TIER_* defaults). Promotion on a back-edge happens on-stack: the
+  // running frame continues on the native tier at the branch target.
+  uint32_t hot_calls;
+  uint32_t hot_loops;
+  // Optional: receives the counters, indexed by func id - 1 (func_count
+  // entries). Reset at the start of each run.
+  sir_tier_stats_t* tier_stats;
+  // Optional call-stack sampler (on any engine).
+  const sir_exec_sampler_t* sampler;
+} sir_exec_opts_t;
+
+// Execution with explicit options (`opts` may be NULL for defaults).
+int32_t sir_module_run_opts(const sir_module_t* m, sem_guest_mem_t* mem, sir_host_t host, const sir_exec_event_sink_t* sink,
+                            const sir_exec_opts_t* opts);
+
+// Prepared execution state: the module validated once and its globals
+// allocated and initialized in `mem`. Re-running from a clean state is then
+// sir_module_state_init, sem_guest_snapshot_take, and per run
+// sem_guest_snapshot_restore + sir_module_state_run (on `mem` or on a
+// sem_guest_snapshot_fork of it, which keeps the same global addresses).
+typedef struct sir_module_state sir_module_state_t;
+
+// Returns 0 or negative ZI_E_*; `*out` is set on success.
+int32_t sir_module_state_init(const sir_module_t* m, sem_guest_mem_t* mem, sir_module_state_t** out);
+int32_t sir_module_state_run(const sir_module_state_t* st, sem_guest_mem_t* mem, sir_host_t host, const sir_exec_event_sink_t* sink,
+                             const sir_exec_opts_t* opts);
+void sir_module_state_free(sir_module_state_t* st);
+
+// Dispatch-pair profiler: counts straight-line instruction pairs (the kind at
+// ip, then the kind at ip + 1 of the same function) seen through on_step.
+// The most frequent pairs are the candidates for the threaded engine's fused
+// handlers (see tx_fuse in sir_module.c).
+#define SIR_INST_KIND_COUNT ((uint32_t)SIR_INST_EXIT_VAL + 1u)
+
+typedef struct sir_pair_profile sir_pair_profile_t;
+
+typedef struct sir_pair_count {
+  sir_inst_kind_t first;
+  sir_inst_kind_t second;
+  uint64_t count;
+} sir_pair_count_t;
+
+sir_pair_profile_t* sir_pair_profile_new(void);
+void sir_pair_profile_free(sir_pair_profile_t* p);
+// Event sink feeding `p`; pass it to sir_module_run_ex/sir_module_run_opts.
+sir_exec_event_sink_t sir_pair_profile_sink(sir_pair_profile_t* p);
+// Total steps seen.
+uint64_t sir_pair_profile_steps(const sir_pair_profile_t* p);
+// Writes up to `max` pairs into `out`, most frequent first; returns how many.
+uint32_t sir_pair_profile_top(const sir_pair_profile_t* p, sir_pair_count_t* out, uint32_t max);
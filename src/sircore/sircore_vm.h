@@ -68,7 +68,7 @@ typedef struct sir_vm {
 } sir_vm_t;
 
 typedef struct sir_vm_cfg {
-  uint32_t guest_mem_cap;
+  uint64_t guest_mem_cap;
   uint64_t guest_mem_base;
   sir_host_t host;
 } sir_vm_cfg_t;
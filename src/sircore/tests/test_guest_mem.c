@@ -0,0 +1,191 @@
+#include "guest_mem.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sircore_unit: %s\n", msg);
+  return 1;
+}
+
+static bool is_zero(sem_guest_mem_t* m, zi_ptr_t p, uint32_t n) {
+  uint8_t* w = NULL;
+  if (!sem_guest_mem_map_rw(m, p, n, &w) || !w) return false;
+  for (uint32_t i = 0; i < n; i++) {
+    if (w[i] != 0) return false;
+  }
+  return true;
+}
+
+static bool fill(sem_guest_mem_t* m, zi_ptr_t p, uint32_t n, uint8_t v) {
+  uint8_t* w = NULL;
+  if (!sem_guest_mem_map_rw(m, p, n, &w) || !w) return false;
+  memset(w, v, n);
+  return true;
+}
+
+int main(void) {
+  sem_guest_mem_t mem;
+
+  // Reuse, zeroing and invalid frees.
+  {
+    if (!sem_guest_mem_init(&mem, 64 * 1024, 0x10000ull)) return fail("sem_guest_mem_init failed");
+    const zi_ptr_t a = sem_guest_alloc(&mem, 100, 16);
+    if (!a || (a & 15u) != 0) return fail("alloc returned unaligned pointer");
+    if (!fill(&mem, a, 100, 0xAB)) return fail("alloc not mapped");
+    if (sem_guest_free(&mem, a) != 0) return fail("free failed");
+    if (sem_guest_free(&mem, a) != -1) return fail("double free not rejected");
+    if (sem_guest_free(&mem, 0) != -1) return fail("free(0) not rejected");
+    if (sem_guest_free(&mem, a + 8) != -1) return fail("interior pointer free not rejected");
+    const zi_ptr_t b = sem_guest_alloc(&mem, 100, 16);
+    if (b != a) return fail("freed block was not reused");
+    if (!is_zero(&mem, b, 100)) return fail("reused block not zeroed");
+    sem_guest_mem_dispose(&mem);
+  }
+
+  // Neighbouring free blocks coalesce; freeing the top block shrinks brk.
+  {
+    if (!sem_guest_mem_init(&mem, 64 * 1024, 0x10000ull)) return fail("sem_guest_mem_init failed");
+    const zi_ptr_t a = sem_guest_alloc(&mem, 112, 16);
+    const zi_ptr_t b = sem_guest_alloc(&mem, 112, 16);
+    const zi_ptr_t c = sem_guest_alloc(&mem, 112, 16);
+    const zi_ptr_t guard = sem_guest_alloc(&mem, 16, 16);
+    if (!a || !b || !c || !guard) return fail("alloc failed");
+    const uint64_t brk = mem.brk;
+    if (sem_guest_free(&mem, a) != 0 || sem_guest_free(&mem, c) != 0 || sem_guest_free(&mem, b) != 0) return fail("free failed");
+    const zi_ptr_t big = sem_guest_alloc(&mem, 3 * 112 + 2 * 16, 16);
+    if (big != a) return fail("adjacent free blocks did not coalesce");
+    if (mem.brk != brk) return fail("coalesced alloc grew the heap");
+    if (sem_guest_free(&mem, guard) != 0 || sem_guest_free(&mem, big) != 0) return fail("free failed");
+    if (mem.brk != 0) return fail("freeing every block did not release the heap");
+    sem_guest_mem_dispose(&mem);
+  }
+
+  // Over-aligned allocations.
+  {
+    if (!sem_guest_mem_init(&mem, 64 * 1024, 0x10000ull)) return fail("sem_guest_mem_init failed");
+    const zi_ptr_t s = sem_guest_alloc(&mem, 24, 16);
+    const zi_ptr_t p = sem_guest_alloc(&mem, 100, 256);
+    const zi_ptr_t q = sem_guest_alloc(&mem, 40, 16);
+    if (!s || !p || !q || (p & 255u) != 0) return fail("over-aligned alloc failed");
+    if (!fill(&mem, p, 100, 0xCD) || !fill(&mem, s, 24, 0xCD) || !fill(&mem, q, 40, 0xCD)) return fail("alloc not mapped");
+    if (sem_guest_alloc(&mem, 3, 3) != 0) return fail("non power-of-two align accepted");
+    if (sem_guest_free(&mem, p) != 0 || sem_guest_free(&mem, s) != 0 || sem_guest_free(&mem, q) != 0) return fail("free failed");
+    if (mem.brk != 0) return fail("aligned blocks leaked");
+    sem_guest_mem_dispose(&mem);
+  }
+
+  // Churn far beyond the cap: a bump allocator runs out, a reusing one does not.
+  {
+    if (!sem_guest_mem_init(&mem, 64 * 1024, 0x10000ull)) return fail("sem_guest_mem_init failed");
+    zi_ptr_t live[32];
+    memset(live, 0, sizeof(live));
+    uint32_t seed = 12345u;
+    for (uint32_t it = 0; it < 100000u; it++) {
+      seed = seed * 1103515245u + 12345u;
+      const uint32_t slot = (seed >> 8) % 32u;
+      if (live[slot]) {
+        if (sem_guest_free(&mem, live[slot]) != 0) return fail("churn free failed");
+        live[slot] = 0;
+        continue;
+      }
+      const uint32_t n = 1u + ((seed >> 16) % 1024u);
+      const zi_ptr_t p = sem_guest_alloc(&mem, n, 16);
+      if (!p) return fail("churn alloc failed");
+      if (!is_zero(&mem, p, n)) return fail("churn alloc not zeroed");
+      if (!fill(&mem, p, n, (uint8_t)it)) return fail("churn alloc not mapped");
+      live[slot] = p;
+    }
+    for (uint32_t i = 0; i < 32u; i++) {
+      if (live[i] && sem_guest_free(&mem, live[i]) != 0) return fail("churn final free failed");
+    }
+    if (mem.brk != 0) return fail("churn leaked heap memory");
+    sem_guest_mem_dispose(&mem);
+  }
+
+  // Heap and stack share the buffer and may not overlap.
+  {
+    if (!sem_guest_mem_init(&mem, 4096, 0x10000ull)) return fail("sem_guest_mem_init failed");
+    const uint64_t sp = sem_guest_stack_save(&mem);
+    if (!sem_guest_stack_alloc(&mem, 2048, 16)) return fail("stack alloc failed");
+    if (sem_guest_alloc(&mem, 3000, 16) != 0) return fail("heap grew into the stack");
+    sem_guest_stack_restore(&mem, sp);
+    const zi_ptr_t p = sem_guest_alloc(&mem, 3000, 16);
+    if (!p) return fail("heap alloc failed after stack release");
+    if (sem_guest_stack_alloc(&mem, 2048, 16) != 0) return fail("stack grew into the heap");
+    sem_guest_mem_dispose(&mem);
+  }
+
+  // Capacities above 4 GiB: the reservation is sparse, so only touched pages cost memory.
+  {
+    const uint64_t cap = UINT64_C(6) << 30;
+    if (!sem_guest_mem_init(&mem, cap, 0x10000ull)) return fail("sem_guest_mem_init (6 GiB) failed");
+    const zi_ptr_t top = sem_guest_stack_alloc(&mem, 64, 16);
+    if (!top || top - 0x10000ull < (UINT64_C(4) << 30)) return fail("stack not placed above 4 GiB");
+    if (!fill(&mem, top, 64, 0x5A)) return fail("high stack not mapped");
+    const zi_ptr_t a = sem_guest_alloc(&mem, 0xF0000000u, 16);
+    const zi_ptr_t b = sem_guest_alloc(&mem, 0x40000000u, 16);
+    if (!a || !b || b - 0x10000ull < (UINT64_C(4) << 30) - 0x40000000u) return fail("large heap allocs failed");
+    if (!fill(&mem, b + 0x40000000u - 16u, 16, 0x7E)) return fail("high heap not mapped");
+    if (sem_guest_free(&mem, a) != 0 || sem_guest_free(&mem, b) != 0) return fail("large free failed");
+    if (mem.brk != 0) return fail("large blocks leaked");
+    sem_guest_mem_dispose(&mem);
+  }
+  if (sem_guest_mem_init(&mem, SEM_GUEST_MEM_MAX_CAP + 16u, 0x10000ull)) return fail("oversized cap accepted");
+
+  // Snapshots: restore rewinds contents and allocator state, however many
+  // times it runs; a fork is an independent copy of the snapshot.
+  {
+    if (!sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) return fail("sem_guest_mem_init failed");
+    const zi_ptr_t a = sem_guest_alloc(&mem, 5000, 16);
+    const zi_ptr_t b = sem_guest_alloc(&mem, 100, 16);
+    if (!a || !b || !fill(&mem, a, 5000, 0x11) || !fill(&mem, b, 100, 0x22)) return fail("alloc failed");
+    if (sem_guest_free(&mem, a) != 0) return fail("free failed");
+    const uint64_t sp = sem_guest_stack_save(&mem);
+    const zi_ptr_t s = sem_guest_stack_alloc(&mem, 256, 16);
+    if (!s || !fill(&mem, s, 256, 0x33)) return fail("stack alloc failed");
+    const uint64_t brk = mem.brk;
+    const uint64_t sp_snap = sem_guest_stack_save(&mem);
+
+    sem_guest_snapshot_t snap;
+    if (!sem_guest_snapshot_take(&mem, &snap)) return fail("sem_guest_snapshot_take failed");
+    for (uint32_t round = 0; round < 3; round++) {
+      if (!fill(&mem, b, 100, 0x44)) return fail("write failed");
+      const zi_ptr_t c = sem_guest_alloc(&mem, 9000, 16);
+      const zi_ptr_t d = sem_guest_alloc(&mem, 4000, 16);
+      if (!c || !d || !fill(&mem, c, 9000, 0x55) || !fill(&mem, d, 4000, 0x66)) return fail("alloc after snapshot failed");
+      if (sem_guest_free(&mem, b) != 0) return fail("free after snapshot failed");
+      sem_guest_stack_restore(&mem, sp);
+      if (!sem_guest_stack_alloc(&mem, 8192, 16)) return fail("stack alloc after snapshot failed");
+
+      if (!sem_guest_snapshot_restore(&mem, &snap)) return fail("sem_guest_snapshot_restore failed");
+      if (mem.brk != brk || sem_guest_stack_save(&mem) != sp_snap) return fail("restore did not rewind brk/sp");
+      const uint8_t* r = NULL;
+      if (!sem_guest_mem_map_ro(&mem, b, 100, &r) || r[0] != 0x22 || r[99] != 0x22) return fail("restore did not rewind heap bytes");
+      if (!sem_guest_mem_map_ro(&mem, s, 256, &r) || r[0] != 0x33 || r[255] != 0x33) return fail("restore did not rewind stack bytes");
+      for (uint64_t i = brk; i < brk + 16000u; i++) {
+        if (mem.buf[i] != 0) return fail("restore left bytes past the old brk");
+      }
+      const zi_ptr_t e = sem_guest_alloc(&mem, 4000, 16);
+      if (e != a) return fail("restore did not rewind the free lists");
+      if (sem_guest_free(&mem, e) != 0) return fail("free of reused block failed");
+    }
+
+    sem_guest_mem_t fork;
+    if (!sem_guest_snapshot_fork(&snap, &fork)) return fail("sem_guest_snapshot_fork failed");
+    if (fork.buf == mem.buf || fork.brk != brk) return fail("fork state mismatch");
+    if (!fill(&fork, b, 100, 0x77)) return fail("fork write failed");
+    const uint8_t* r = NULL;
+    if (!sem_guest_mem_map_ro(&mem, b, 100, &r) || r[0] != 0x22) return fail("fork write leaked into the original");
+    if (sem_guest_free(&fork, b) != 0 || sem_guest_alloc(&fork, 4000, 16) != a) return fail("fork allocator state mismatch");
+    if (!sem_guest_snapshot_restore(&fork, &snap)) return fail("fork restore failed");
+    if (!sem_guest_mem_map_ro(&fork, b, 100, &r) || r[0] != 0x22) return fail("fork restore did not rewind");
+    sem_guest_mem_dispose(&fork);
+
+    sem_guest_snapshot_dispose(&snap);
+    sem_guest_mem_dispose(&mem);
+  }
+
+  return 0;
+}
@@ -0,0 +1,251 @@
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE 1
+#endif
+
+#include "hosted_zabi.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Runs hosted runtimes on several threads at once and checks that stdio,
+// handles, caps and the file/aio sandbox root never leak between instances.
+
+enum { THREADS = 8, WRITES = 400, OPENS = 200 };
+
+typedef struct counter {
+  uint32_t bytes;
+} counter_t;
+
+static int32_t counter_write(void* ctx, sem_guest_mem_t* mem, zi_ptr_t src_ptr, zi_size32_t len) {
+  (void)mem;
+  (void)src_ptr;
+  ((counter_t*)ctx)->bytes += len;
+  return (int32_t)len;
+}
+
+static const sem_handle_ops_t counter_ops = {
+    .read = NULL,
+    .write = counter_write,
+    .end = NULL,
+};
+
+typedef struct worker {
+  uint32_t id;
+  char name[16];
+  const char* err;
+} worker_t;
+
+static bool put(sir_hosted_zabi_t* rt, const char* s, zi_ptr_t* out_ptr, zi_size32_t* out_len) {
+  const zi_size32_t n = (zi_size32_t)strlen(s);
+  const zi_ptr_t p = sir_zi_alloc(rt, n);
+  uint8_t* dst = NULL;
+  if (!p || !sem_guest_mem_map_rw(rt->mem, p, n, &dst) || !dst) return false;
+  memcpy(dst, s, n);
+  *out_ptr = p;
+  *out_len = n;
+  return true;
+}
+
+static const char* run_worker(worker_t* w, FILE* out, FILE* err) {
+  (void)snprintf(w->name, sizeof(w->name), "w%u", (unsigned)w->id);
+  const sem_cap_t caps[2] = {
+      {.kind = "test", .name = "shared", .flags = 0},
+      {.kind = "test", .name = w->name, .flags = 0},
+  };
+  sir_hosted_zabi_t rt;
+  if (!sir_hosted_zabi_init(&rt, (sir_hosted_zabi_cfg_t){.caps = caps,
+                                                        .cap_count = 1u + (w->id & 1u),
+                                                        .std_out = out,
+                                                        .std_err = err})) {
+    return "init failed";
+  }
+
+  const char* bad = NULL;
+  counter_t sink = {0};
+  const zi_handle_t h = sem_handle_alloc(&rt.handles, (sem_handle_entry_t){.ops = &counter_ops, .ctx = &sink, .hflags = ZI_H_WRITABLE});
+  char line[32];
+  (void)snprintf(line, sizeof(line), "%s\n", w->name);
+  zi_ptr_t p = 0;
+  zi_size32_t n = 0;
+  if (h < 3 || !put(&rt, line, &p, &n)) bad = "setup failed";
+
+  for (uint32_t i = 0; !bad && i < WRITES; i++) {
+    if (sir_zi_write(&rt, 1, p, n) != (int32_t)n) bad = "stdout write failed";
+    if (sir_zi_write(&rt, h, p, n) != (int32_t)n) bad = "handle write failed";
+  }
+  if (!bad && sink.bytes != WRITES * n) bad = "handle writes went to another instance";
+  if (!bad && sir_zi_cap_count(&rt) != (int32_t)(1u + (w->id & 1u))) bad = "cap count leaked between instances";
+  if (!bad && (w->id & 1u)) {
+    const int32_t size = sir_zi_cap_get_size(&rt, 1);
+    const zi_ptr_t cp = sir_zi_alloc(&rt, 64);
+    const uint8_t* got = NULL;
+    if (size <= 0 || !cp || sir_zi_cap_get(&rt, 1, cp, 64) != size || !sem_guest_mem_map_ro(rt.mem, cp, (zi_size32_t)size, &got) ||
+        memcmp(got + 4 + 4 + 4, w->name, strlen(w->name)) != 0) {
+      bad = "cap entry leaked between instances";
+    }
+  }
+  zi_ptr_t tp = 0;
+  zi_size32_t tn = 0;
+  if (!bad && (!put(&rt, w->name, &tp, &tn) || sir_zi_telemetry(&rt, tp, tn, tp, tn) != 0)) bad = "telemetry failed";
+
+  sir_hosted_zabi_dispose(&rt);
+  return bad;
+}
+
+typedef struct job {
+  worker_t w;
+  FILE* out;
+  FILE* err;
+} job_t;
+
+static void* job_main(void* arg) {
+  job_t* j = (job_t*)arg;
+  j->w.err = run_worker(&j->w, j->out, j->err);
+  return NULL;
+}
+
+static void put_u32le(uint8_t* p, uint32_t v) {
+  for (uint32_t i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8u * i));
+}
+
+// Opens file/aio OPENS times from an instance with or without a sandbox root.
+// The root is only in the process environment while the instance's own open
+// runs, so the other instance and environment readers never see it.
+typedef struct fs_job {
+  const char* root;
+  zi_handle_t first;
+  const char* err;
+} fs_job_t;
+
+static void* fs_job_main(void* arg) {
+  fs_job_t* j = (fs_job_t*)arg;
+  const sem_cap_t caps[] = {{.kind = "file", .name = "aio", .flags = SEM_ZI_CAP_CAN_OPEN}};
+  sir_hosted_zabi_t rt;
+  if (!sir_hosted_zabi_init(&rt, (sir_hosted_zabi_cfg_t){.caps = caps, .cap_count = 1, .fs_root = j->root})) {
+    j->err = "init failed";
+    return NULL;
+  }
+  zi_ptr_t kp = 0;
+  zi_ptr_t np = 0;
+  zi_size32_t kn = 0;
+  zi_size32_t nn = 0;
+  const zi_ptr_t req = sir_zi_alloc(&rt, 40);
+  uint8_t* r = NULL;
+  if (!put(&rt, "file", &kp, &kn) || !put(&rt, "aio", &np, &nn) || !req || !sem_guest_mem_map_rw(rt.mem, req, 40, &r) || !r) {
+    j->err = "setup failed";
+  } else {
+    memset(r, 0, 40);
+    put_u32le(r + 0, (uint32_t)kp);
+    put_u32le(r + 8, kn);
+    put_u32le(r + 12, (uint32_t)np);
+    put_u32le(r + 20, nn);
+  }
+  for (uint32_t i = 0; !j->err && i < OPENS; i++) {
+    const zi_handle_t h = sir_zi_cap_open(&rt, req);
+    if (i == 0) j->first = h;
+    else if ((h >= 0) != (j->first >= 0)) j->err = "file/aio open result changed between opens";
+    if (h >= 0 && sir_zi_end(&rt, h) != 0) j->err = "file/aio end failed";
+  }
+  sir_hosted_zabi_dispose(&rt);
+  return NULL;
+}
+
+static int check_fs_root(void) {
+  (void)unsetenv("ZI_FS_ROOT");
+  char root[] = "/tmp/sircore_fs_root_XXXXXX";
+  if (!mkdtemp(root)) {
+    fprintf(stderr, "sircore_unit: mkdtemp failed\n");
+    return 1;
+  }
+  fs_job_t jobs[2] = {{.root = root}, {.root = NULL}};
+  pthread_t tids[2];
+  bool started[2] = {false, false};
+  for (uint32_t i = 0; i < 2; i++) started[i] = pthread_create(&tids[i], NULL, fs_job_main, &jobs[i]) == 0;
+  int rc = 0;
+  char buf[256];
+  for (uint32_t i = 0; i < OPENS * 4u; i++) {
+    if (sir_hosted_zabi_getenv("ZI_FS_ROOT", buf, sizeof(buf))) {
+      fprintf(stderr, "sircore_unit: ZI_FS_ROOT visible outside the rooted instance's open\n");
+      rc = 1;
+      break;
+    }
+  }
+  for (uint32_t i = 0; i < 2; i++) {
+    if (!started[i]) {
+      fprintf(stderr, "sircore_unit: pthread_create failed\n");
+      rc = 1;
+      continue;
+    }
+    (void)pthread_join(tids[i], NULL);
+    if (jobs[i].err) {
+      fprintf(stderr, "sircore_unit: fs_root %s: %s\n", jobs[i].root ? "rooted" : "unrooted", jobs[i].err);
+      rc = 1;
+    }
+  }
+  if (getenv("ZI_FS_ROOT")) {
+    fprintf(stderr, "sircore_unit: ZI_FS_ROOT left set after the runs\n");
+    rc = 1;
+  }
+  (void)rmdir(root);
+  return rc;
+}
+
+static bool file_is(FILE* f, const char* want_line, uint32_t times) {
+  rewind(f);
+  char buf[64];
+  uint32_t n = 0;
+  while (fgets(buf, sizeof(buf), f)) {
+    if (strcmp(buf, want_line) != 0) return false;
+    n++;
+  }
+  return n == times;
+}
+
+int main(void) {
+  job_t jobs[THREADS];
+  pthread_t tids[THREADS];
+  memset(jobs, 0, sizeof(jobs));
+  for (uint32_t i = 0; i < THREADS; i++) {
+    jobs[i].w.id = i;
+    jobs[i].out = tmpfile();
+    jobs[i].err = tmpfile();
+    if (!jobs[i].out || !jobs[i].err) {
+      fprintf(stderr, "sircore_unit: tmpfile failed\n");
+      return 1;
+    }
+  }
+  for (uint32_t i = 0; i < THREADS; i++) {
+    if (pthread_create(&tids[i], NULL, job_main, &jobs[i]) != 0) {
+      fprintf(stderr, "sircore_unit: pthread_create failed\n");
+      return 1;
+    }
+  }
+  for (uint32_t i = 0; i < THREADS; i++) (void)pthread_join(tids[i], NULL);
+
+  int rc = 0;
+  for (uint32_t i = 0; i < THREADS; i++) {
+    job_t* j = &jobs[i];
+    char line[64];
+    (void)snprintf(line, sizeof(line), "%s\n", j->w.name);
+    char tele[64];
+    (void)snprintf(tele, sizeof(tele), "telemetry[%s]: %s\n", j->w.name, j->w.name);
+    if (j->w.err) {
+      fprintf(stderr, "sircore_unit: %s: %s\n", j->w.name, j->w.err);
+      rc = 1;
+    } else if (!file_is(j->out, line, WRITES)) {
+      fprintf(stderr, "sircore_unit: %s: stdout mixed with another instance\n", j->w.name);
+      rc = 1;
+    } else if (!file_is(j->err, tele, 1)) {
+      fprintf(stderr, "sircore_unit: %s: telemetry not on the instance's stderr\n", j->w.name);
+      rc = 1;
+    }
+    fclose(j->out);
+    fclose(j->err);
+  }
+  if (check_fs_root()) rc = 1;
+  return rc;
+}
@@ -192,6 +192,33 @@ int main(void) {
     return fail("sink contents mismatch");
   }
 
+  // Restoring a runtime snapshot rewinds guest memory and closes handles
+  // opened after it, but keeps the ones that were already open.
+  sir_hosted_zabi_snapshot_t snap;
+  if (!sir_hosted_zabi_snapshot_take(&hz, &snap)) {
+    sir_module_free(m);
+    sir_hosted_zabi_dispose(&hz);
+    sem_guest_mem_dispose(&mem);
+    return fail("sir_hosted_zabi_snapshot_take failed");
+  }
+  const uint64_t brk = mem.brk;
+  sink_t sink2 = {0};
+  const zi_handle_t h2 = sem_handle_alloc(&hz.handles, (sem_handle_entry_t){.ops = &sink_ops, .ctx = &sink2, .hflags = ZI_H_WRITABLE});
+  const int32_t rc2 = sir_module_run(m, &mem, host);
+  const zi_ptr_t p = sir_zi_alloc(&hz, 64);
+  bool ok = h2 > sink_h && rc2 == rc && p != 0 && mem.brk != brk;
+  ok = ok && sir_hosted_zabi_snapshot_restore(&hz, &snap);
+  sem_handle_entry_t e;
+  ok = ok && !sem_handle_lookup(&hz.handles, h2, &e) && sem_handle_lookup(&hz.handles, sink_h, &e) && mem.brk == brk;
+  ok = ok && sem_handle_alloc(&hz.handles, (sem_handle_entry_t){.ops = &sink_ops, .ctx = &sink2, .hflags = ZI_H_WRITABLE}) == h2;
+  sir_hosted_zabi_snapshot_dispose(&snap);
+  if (!ok) {
+    sir_module_free(m);
+    sir_hosted_zabi_dispose(&hz);
+    sem_guest_mem_dispose(&mem);
+    return fail("runtime snapshot restore mismatch");
+  }
+
   sir_module_free(m);
   sir_hosted_zabi_dispose(&hz);
   sem_guest_mem_dispose(&mem);
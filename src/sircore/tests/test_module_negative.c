@@ -79,5 +79,93 @@ int main(void) {
     if (rc) return rc;
   }
 
+  // Case 2: call_extern to an import the runtime does not provide.
+  {
+    sir_module_builder_t* b = sir_mb_new();
+    if (!b) return fail("sir_mb_new failed");
+
+    const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+    if (!ty_i32) {
+      sir_mb_free(b);
+      return fail("sir_mb_type_prim failed");
+    }
+
+    const sir_type_id_t p[] = {ty_i32};
+    sir_sig_t sig = {.params = p, .param_count = 1, .results = NULL, .result_count = 0};
+    const sir_sym_id_t sym = sir_mb_sym_extern_fn(b, "puts", sig);
+    if (!sym) {
+      sir_mb_free(b);
+      return fail("sir_mb_sym_extern_fn failed");
+    }
+
+    const sir_func_id_t f = sir_mb_func_begin(b, "main");
+    if (!f || !sir_mb_func_set_entry(b, f) || !sir_mb_func_set_value_count(b, f, 1)) {
+      sir_mb_free(b);
+      return fail("sir_mb_func_begin failed");
+    }
+
+    (void)sir_mb_emit_const_i32(b, f, 0, 1);
+    const sir_val_id_t args[] = {0};
+    if (!sir_mb_emit_call_extern(b, f, sym, args, 1)) {
+      sir_mb_free(b);
+      return fail("sir_mb_emit_call_extern failed");
+    }
+    (void)sir_mb_emit_exit(b, f, 0);
+
+    sir_module_t* m = sir_mb_finalize(b);
+    sir_mb_free(b);
+    if (!m) return fail("sir_mb_finalize failed");
+    char err[160];
+    memset(err, 0, sizeof(err));
+    if (sir_module_validate(m, err, sizeof(err)) || strstr(err, "unknown import 'puts'") == NULL) {
+      sir_module_free(m);
+      return fail("expected unknown import to be rejected at validate");
+    }
+    const int rc = expect_invalid(m);
+    sir_module_free(m);
+    if (rc) return rc;
+  }
+
+  // Case 3: known host call declared with the wrong arity.
+  {
+    sir_module_builder_t* b = sir_mb_new();
+    if (!b) return fail("sir_mb_new failed");
+
+    const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+    if (!ty_i32) {
+      sir_mb_free(b);
+      return fail("sir_mb_type_prim failed");
+    }
+
+    const sir_type_id_t p[] = {ty_i32, ty_i32};
+    sir_sig_t sig = {.params = p, .param_count = 2, .results = NULL, .result_count = 0};
+    const sir_sym_id_t sym = sir_mb_sym_extern_fn(b, "zi_end", sig);
+    if (!sym) {
+      sir_mb_free(b);
+      return fail("sir_mb_sym_extern_fn failed");
+    }
+
+    const sir_func_id_t f = sir_mb_func_begin(b, "main");
+    if (!f || !sir_mb_func_set_entry(b, f) || !sir_mb_func_set_value_count(b, f, 1)) {
+      sir_mb_free(b);
+      return fail("sir_mb_func_begin failed");
+    }
+
+    (void)sir_mb_emit_const_i32(b, f, 0, 1);
+    const sir_val_id_t args[] = {0, 0};
+    if (!sir_mb_emit_call_extern(b, f, sym, args, 2)) {
+      sir_mb_free(b);
+      return fail("sir_mb_emit_call_extern failed");
+    }
+    (void)sir_mb_emit_exit(b, f, 0);
+
+    sir_module_t* m = sir_mb_finalize(b);
+    sir_mb_free(b);
+    if (!m) return fail("sir_mb_finalize failed");
+    const int rc = expect_invalid(m);
+    sir_module_free(m);
+    if (rc) return rc;
+  }
+
   return 0;
 }
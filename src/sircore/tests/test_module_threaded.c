@@ -0,0 +1,1121 @@
+#include "sir_module.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Runs the same modules on every engine and checks that all produce the same
+// exit code and the same step/memory event stream. Untraced tiered and native
+// runs take the native tier where the host has one.
+
+static int fail(const char* msg) {
+  fprintf(stderr, "sircore_unit: %s\n", msg);
+  return 1;
+}
+
+typedef struct {
+  uint64_t steps;
+  uint64_t mems;
+  uint64_t hash;
+  const uint8_t* keep; // by fid - 1: events of other functions are dropped (and counted)
+  uint64_t dropped;
+} trace_t;
+
+static bool dropped(trace_t* t, sir_func_id_t fid) {
+  if (!t->keep || t->keep[fid - 1]) return false;
+  t->dropped++;
+  return true;
+}
+
+static void on_step(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_inst_kind_t k) {
+  (void)m;
+  trace_t* t = (trace_t*)user;
+  if (dropped(t, fid)) return;
+  t->steps++;
+  t->hash = (t->hash ^ ((uint64_t)fid << 40) ^ ((uint64_t)ip << 8) ^ (uint64_t)k) * 1099511628211ull;
+}
+
+static void on_mem(void* user, const sir_module_t* m, sir_func_id_t fid, uint32_t ip, sir_mem_event_kind_t k, zi_ptr_t addr, uint32_t size) {
+  (void)m;
+  trace_t* t = (trace_t*)user;
+  if (dropped(t, fid)) return;
+  t->mems++;
+  t->hash = (t->hash ^ (uint64_t)addr ^ ((uint64_t)size << 32) ^ ((uint64_t)k << 48) ^ ip) * 1099511628211ull;
+}
+
+// With keep set, events outside it are filtered in on_step/on_mem; with
+// func_mask too, the sink masks them in the VM.
+static int run_masked(const sir_module_t* m, const sir_exec_opts_t* opts, bool traced, const uint8_t* keep, const uint8_t* func_mask,
+                      int32_t* out_rc, trace_t* out_trace) {
+  sem_guest_mem_t mem;
+  if (!sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) return fail("sem_guest_mem_init failed");
+  memset(out_trace, 0, sizeof(*out_trace));
+  out_trace->hash = 1469598103934665603ull;
+  out_trace->keep = keep;
+  const sir_exec_event_sink_t sink = {.user = out_trace, .on_step = on_step, .on_mem = on_mem, .on_hostcall = NULL, .func_mask = func_mask};
+  sir_host_t host;
+  memset(&host, 0, sizeof(host));
+  *out_rc = sir_module_run_opts(m, &mem, host, traced ? &sink : NULL, opts);
+  sem_guest_mem_dispose(&mem);
+  return 0;
+}
+
+static int run_engine(const sir_module_t* m, const sir_exec_opts_t* opts, bool traced, int32_t* out_rc, trace_t* out_trace) {
+  return run_masked(m, opts, traced, NULL, NULL, out_rc, out_trace);
+}
+
+typedef struct {
+  uint64_t samples;
+  uint64_t hash;
+  uint32_t max_depth;
+  bool bad_leaf;
+} samples_t;
+
+static void on_sample(void* user, const sir_module_t* m, const sir_func_id_t* stack, uint32_t depth, uint32_t ip) {
+  samples_t* s = (samples_t*)user;
+  s->samples++;
+  if (depth > s->max_depth) s->max_depth = depth;
+  if (depth == 0 || stack[0] != m->entry || ip >= m->funcs[stack[depth - 1] - 1].inst_count) s->bad_leaf = true;
+  for (uint32_t i = 0; i < depth; i++) s->hash = (s->hash ^ stack[i]) * 1099511628211ull;
+  s->hash = (s->hash ^ ((uint64_t)ip << 32) ^ depth) * 1099511628211ull;
+}
+
+// Sampling counts the instructions on_step sees, so every engine must take
+// the same samples at the same stacks, with or without a sink.
+static int check_sampled(const char* name, const sir_module_t* m, const sir_exec_opts_t* opts, const char* const* names, size_t count,
+                         int32_t want, uint64_t steps) {
+  const uint32_t period = 7;
+  samples_t first = {0};
+  for (size_t i = 0; i < count * 2; i++) {
+    samples_t got = {.hash = 1469598103934665603ull};
+    const sir_exec_sampler_t sampler = {.user = &got, .period = period, .on_sample = on_sample};
+    sir_exec_opts_t o = opts[i % count];
+    o.sampler = &sampler;
+    int32_t rc = 0;
+    trace_t tr;
+    if (run_engine(m, &o, i >= count, &rc, &tr)) return 1;
+    if (rc != want || got.samples != steps / period || got.bad_leaf || (i && (got.hash != first.hash || got.max_depth != first.max_depth))) {
+      fprintf(stderr, "sircore_unit: %s: sampled run on %s%s differs (rc=%d samples=%llu want %llu)\n", name, names[i % count],
+              i >= count ? " (traced)" : "", rc, (unsigned long long)got.samples, (unsigned long long)(steps / period));
+      return 1;
+    }
+    if (i == 0) first = got;
+  }
+  return 0;
+}
+
+// Masking functions out of the sink must drop exactly their events on every
+// engine, without the sink ever seeing them.
+static int check_masked(const char* name, const sir_module_t* m, const sir_exec_opts_t* opts, const char* const* names, size_t count,
+                        int32_t want) {
+  uint8_t mask[64];
+  if (m->func_count > sizeof(mask)) return 0;
+  for (uint32_t variant = 0; variant < 3; variant++) {
+    // Entry only, everything but the entry, nothing.
+    for (uint32_t i = 0; i < m->func_count; i++) mask[i] = variant == 2 ? 0 : (uint8_t)((i + 1 == m->entry) == (variant == 0));
+    int32_t rc_want = 0;
+    trace_t tr_want;
+    if (run_masked(m, &opts[0], true, mask, NULL, &rc_want, &tr_want)) return 1;
+    for (size_t i = 0; i < count; i++) {
+      int32_t rc = 0;
+      trace_t tr;
+      if (run_masked(m, &opts[i], true, mask, mask, &rc, &tr)) return 1;
+      if (rc != want || tr.dropped || tr.steps != tr_want.steps || tr.mems != tr_want.mems || tr.hash != tr_want.hash) {
+        fprintf(stderr, "sircore_unit: %s: masked run %u on %s differs (rc=%d leaked=%llu)\n", name, (unsigned)variant, names[i], rc,
+                (unsigned long long)tr.dropped);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static void image_release(void* image, size_t len) {
+  (void)len;
+  free(image);
+}
+
+// Round-trips m through a module image.
+static sir_module_t* image_copy(const sir_module_t* m) {
+  uint8_t* img = NULL;
+  size_t len = 0;
+  if (!sir_module_image_build(m, &img, &len)) return NULL;
+  sir_module_t* r = sir_module_image_load(img, len, image_release);
+  if (!r) free(img);
+  return r;
+}
+
+static int check(const char* name, sir_module_t* m, int32_t want) {
+  if (!m) {
+    fprintf(stderr, "sircore_unit: %s: build failed\n", name);
+    return 1;
+  }
+  // Tiered runs use the default thresholds and tiny ones, so that functions
+  // switch tiers both between calls and mid-loop.
+  const sir_exec_opts_t opts[] = {
+      {.engine = SIR_EXEC_ENGINE_SWITCH},
+      {.engine = SIR_EXEC_ENGINE_THREADED},
+      {.engine = SIR_EXEC_ENGINE_TIERED},
+      {.engine = SIR_EXEC_ENGINE_TIERED, .hot_calls = 2, .hot_loops = 3},
+      {.engine = SIR_EXEC_ENGINE_NATIVE},
+  };
+  const char* names[] = {"switch", "threaded", "tiered", "tiered(hot)", "native"};
+  const size_t count = sizeof(opts) / sizeof(opts[0]);
+  int32_t rc[5] = {0};
+  trace_t tr[5];
+  for (size_t i = 0; i < count; i++) {
+    if (run_engine(m, &opts[i], true, &rc[i], &tr[i])) {
+      sir_module_free(m);
+      return 1;
+    }
+  }
+  const sir_exec_opts_t* fast[] = {NULL, &opts[0], &opts[3], &opts[4]};
+  const char* fast_names[] = {"default", "switch", "tiered(hot)", "native"};
+  for (size_t i = 0; i < 4; i++) {
+    int32_t rc_fast = 0;
+    trace_t tr_fast;
+    if (run_engine(m, fast[i], false, &rc_fast, &tr_fast)) {
+      sir_module_free(m);
+      return 1;
+    }
+    if (rc_fast != want) {
+      fprintf(stderr, "sircore_unit: %s: rc %s (untraced)=%d want=%d\n", name, fast_names[i], rc_fast, want);
+      sir_module_free(m);
+      return 1;
+    }
+  }
+  if (check_masked(name, m, opts, names, count, want) || check_sampled(name, m, opts, names, count, want, tr[0].steps)) {
+    sir_module_free(m);
+    return 1;
+  }
+  // The image of m must behave exactly like m on every engine.
+  sir_module_t* img = image_copy(m);
+  sir_module_free(m);
+  if (!img) {
+    fprintf(stderr, "sircore_unit: %s: image round trip failed\n", name);
+    return 1;
+  }
+  for (size_t i = 0; i < count; i++) {
+    int32_t rc_img = 0;
+    trace_t tr_img;
+    if (run_engine(img, &opts[i], true, &rc_img, &tr_img)) {
+      sir_module_free(img);
+      return 1;
+    }
+    if (rc_img != want || tr_img.hash != tr[0].hash || tr_img.steps != tr[0].steps) {
+      fprintf(stderr, "sircore_unit: %s: image run on %s differs (rc=%d)\n", name, names[i], rc_img);
+      sir_module_free(img);
+      return 1;
+    }
+  }
+  sir_module_free(img);
+  for (size_t i = 0; i < count; i++) {
+    if (rc[i] != want) {
+      fprintf(stderr, "sircore_unit: %s: rc %s=%d want=%d\n", name, names[i], rc[i], want);
+      return 1;
+    }
+    if (tr[0].steps != tr[i].steps || tr[0].mems != tr[i].mems || tr[0].hash != tr[i].hash) {
+      fprintf(stderr, "sircore_unit: %s: %s event stream differs (steps %llu/%llu mems %llu/%llu)\n", name, names[i],
+              (unsigned long long)tr[0].steps, (unsigned long long)tr[i].steps, (unsigned long long)tr[0].mems,
+              (unsigned long long)tr[i].mems);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Counted loop with block args: acc += (i*3) ^ i for i in [0, 1000).
+static sir_module_t* build_loop(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 9);
+  ok = ok && sir_mb_emit_const_i32(b, f, 0, 0);
+  ok = ok && sir_mb_emit_const_i32(b, f, 1, 0);
+  ok = ok && sir_mb_emit_const_i32(b, f, 2, 1000);
+  ok = ok && sir_mb_emit_const_i32(b, f, 3, 1);
+  ok = ok && sir_mb_emit_const_i32(b, f, 8, 3);
+  const uint32_t head = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, f, 4, 0, 2);
+  uint32_t cbr_ip = 0;
+  ok = ok && sir_mb_emit_cbr(b, f, 4, 0, 0, &cbr_ip);
+  const uint32_t body = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_i32_mul(b, f, 5, 0, 8);
+  ok = ok && sir_mb_emit_i32_xor(b, f, 5, 5, 0);
+  ok = ok && sir_mb_emit_i32_add(b, f, 6, 1, 5);
+  ok = ok && sir_mb_emit_i32_add(b, f, 7, 0, 3);
+  const sir_val_id_t src[] = {7, 6};
+  const sir_val_id_t dst[] = {0, 1};
+  ok = ok && sir_mb_emit_br_args(b, f, head, src, dst, 2, NULL);
+  const uint32_t done = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_exit_val(b, f, 1);
+  ok = ok && sir_mb_patch_cbr(b, f, cbr_ip, body, done);
+  const sir_block_t blocks[] = {{0, 100}, {head, 101}, {body, 102}, {done, 103}};
+  ok = ok && sir_mb_func_set_blocks(b, f, blocks, 4);
+  // Block starts must ascend.
+  const sir_block_t bad[] = {{head, 101}, {0, 100}};
+  ok = ok && !sir_mb_func_set_blocks(b, f, bad, 2);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// Recursive fib(20), called once directly and once through a function pointer.
+static sir_module_t* build_calls(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+  const sir_type_id_t params[] = {ty_i32};
+  const sir_type_id_t results[] = {ty_i32};
+  const sir_sig_t sig = {.params = params, .param_count = 1, .results = results, .result_count = 1};
+
+  const sir_func_id_t fm = sir_mb_func_begin(b, "main");
+  const sir_func_id_t ff = sir_mb_func_begin(b, "fib");
+  bool ok = ty_i32 && fm && ff && sir_mb_func_set_entry(b, fm) && sir_mb_func_set_value_count(b, fm, 5);
+  ok = ok && sir_mb_func_set_sig(b, ff, sig) && sir_mb_func_set_value_count(b, ff, 9);
+
+  const sir_val_id_t a0[] = {0};
+  const sir_val_id_t r1[] = {1};
+  const sir_val_id_t r3[] = {3};
+  ok = ok && sir_mb_emit_const_i32(b, fm, 0, 20);
+  ok = ok && sir_mb_emit_call_func_res(b, fm, ff, a0, 1, r1, 1);
+  ok = ok && sir_mb_emit_const_ptr(b, fm, 2, (zi_ptr_t)(UINT64_C(0xF000000000000000) | ff));
+  ok = ok && sir_mb_emit_call_func_ptr_res(b, fm, 2, a0, 1, r3, 1);
+  ok = ok && sir_mb_emit_i32_add(b, fm, 4, 1, 3);
+  ok = ok && sir_mb_emit_exit_val(b, fm, 4);
+
+  const sir_val_id_t a4[] = {4};
+  const sir_val_id_t a6[] = {6};
+  const sir_val_id_t r5[] = {5};
+  const sir_val_id_t r7[] = {7};
+  ok = ok && sir_mb_emit_const_i32(b, ff, 1, 2);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, ff, 2, 0, 1);
+  ok = ok && sir_mb_emit_cbr(b, ff, 2, 3, 4, NULL);
+  ok = ok && sir_mb_emit_ret_val(b, ff, 0);
+  ok = ok && sir_mb_emit_const_i32(b, ff, 3, 1);
+  ok = ok && sir_mb_emit_i32_sub(b, ff, 4, 0, 3);
+  ok = ok && sir_mb_emit_call_func_res(b, ff, ff, a4, 1, r5, 1);
+  ok = ok && sir_mb_emit_i32_sub(b, ff, 6, 4, 3);
+  ok = ok && sir_mb_emit_call_func_res(b, ff, ff, a6, 1, r7, 1);
+  ok = ok && sir_mb_emit_i32_add(b, ff, 8, 5, 7);
+  ok = ok && sir_mb_emit_ret_val(b, ff, 8);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// Stores i*i into a global i32 array, then sums it back; plus an i8 round trip.
+static sir_module_t* build_memory(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_global_id_t g = sir_mb_global(b, "buf", 64, 8, NULL, 0);
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = g && f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 16);
+  ok = ok && sir_mb_emit_global_addr(b, f, 0, g);
+  ok = ok && sir_mb_emit_const_i32(b, f, 1, 0);
+  ok = ok && sir_mb_emit_const_i32(b, f, 2, 16);
+  ok = ok && sir_mb_emit_const_i32(b, f, 3, 1);
+  // store loop
+  const uint32_t st_head = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_i32_cmp_ult(b, f, 4, 1, 2);
+  uint32_t st_cbr = 0;
+  ok = ok && sir_mb_emit_cbr(b, f, 4, 0, 0, &st_cbr);
+  const uint32_t st_body = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_ptr_offset(b, f, 5, 0, 1, 4);
+  ok = ok && sir_mb_emit_i32_mul(b, f, 6, 1, 1);
+  ok = ok && sir_mb_emit_store_i32(b, f, 5, 6, 4);
+  ok = ok && sir_mb_emit_i32_add(b, f, 1, 1, 3);
+  ok = ok && sir_mb_emit_br(b, f, st_head, NULL);
+  // load loop
+  const uint32_t ld_init = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_const_i32(b, f, 1, 0);
+  ok = ok && sir_mb_emit_const_i32(b, f, 7, 0);
+  const uint32_t ld_head = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_i32_cmp_ne(b, f, 4, 1, 2);
+  uint32_t ld_cbr = 0;
+  ok = ok && sir_mb_emit_cbr(b, f, 4, 0, 0, &ld_cbr);
+  const uint32_t ld_body = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_ptr_offset(b, f, 5, 0, 1, 4);
+  ok = ok && sir_mb_emit_load_i32(b, f, 6, 5, 4);
+  ok = ok && sir_mb_emit_i32_add(b, f, 7, 7, 6);
+  ok = ok && sir_mb_emit_i32_add(b, f, 1, 1, 3);
+  ok = ok && sir_mb_emit_br(b, f, ld_head, NULL);
+  // byte round trip: buf[0] = 0x1ff (truncated to 0xff), acc += zext(buf[0])
+  const uint32_t tail = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_const_i32(b, f, 8, 0x1ff);
+  ok = ok && sir_mb_emit_store_i8(b, f, 0, 8, 1);
+  ok = ok && sir_mb_emit_load_i8(b, f, 9, 0, 1);
+  ok = ok && sir_mb_emit_i32_zext_i8(b, f, 10, 9);
+  ok = ok && sir_mb_emit_i32_add(b, f, 7, 7, 10);
+  ok = ok && sir_mb_emit_exit_val(b, f, 7);
+  ok = ok && sir_mb_patch_cbr(b, f, st_cbr, st_body, ld_init);
+  ok = ok && sir_mb_patch_cbr(b, f, ld_cbr, ld_body, tail);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+static sir_module_t* build_switch(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 1);
+  const int32_t lits[] = {1, 2};
+  const uint32_t targets[] = {3, 4};
+  ok = ok && sir_mb_emit_const_i32(b, f, 0, 2);
+  ok = ok && sir_mb_emit_switch(b, f, 0, lits, targets, 2, 2, NULL);
+  ok = ok && sir_mb_emit_exit(b, f, 9);
+  ok = ok && sir_mb_emit_exit(b, f, 1);
+  ok = ok && sir_mb_emit_exit(b, f, 42);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+static sir_module_t* build_div_trap(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 3);
+  ok = ok && sir_mb_emit_const_i32(b, f, 0, 7);
+  ok = ok && sir_mb_emit_const_i32(b, f, 1, 0);
+  ok = ok && sir_mb_emit_i32_div_s_trap(b, f, 2, 0, 1);
+  ok = ok && sir_mb_emit_exit(b, f, 0);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+static sir_module_t* build_misaligned(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_global_id_t g = sir_mb_global(b, "buf", 16, 8, NULL, 0);
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = g && f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 4);
+  ok = ok && sir_mb_emit_global_addr(b, f, 0, g);
+  ok = ok && sir_mb_emit_const_i64(b, f, 1, 1);
+  ok = ok && sir_mb_emit_ptr_add(b, f, 2, 0, 1);
+  ok = ok && sir_mb_emit_load_i32(b, f, 3, 2, 4);
+  ok = ok && sir_mb_emit_exit(b, f, 0);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// Kinds are not proven by the validator, so mismatches must still fail at runtime.
+static sir_module_t* build_kind_mismatch(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 3);
+  ok = ok && sir_mb_emit_const_i64(b, f, 0, 1);
+  ok = ok && sir_mb_emit_const_i32(b, f, 1, 2);
+  ok = ok && sir_mb_emit_i32_add(b, f, 2, 0, 1);
+  ok = ok && sir_mb_emit_exit(b, f, 0);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// sum(n) = n + sum(n - 1) with wide frames, deep enough to span several
+// frame arena chunks.
+static sir_module_t* build_deep_recursion(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+  const sir_type_id_t params[] = {ty_i32};
+  const sir_type_id_t results[] = {ty_i32};
+  const sir_sig_t sig = {.params = params, .param_count = 1, .results = results, .result_count = 1};
+
+  const sir_func_id_t fm = sir_mb_func_begin(b, "main");
+  const sir_func_id_t fs = sir_mb_func_begin(b, "sum");
+  bool ok = ty_i32 && fm && fs && sir_mb_func_set_entry(b, fm) && sir_mb_func_set_value_count(b, fm, 2);
+  ok = ok && sir_mb_func_set_sig(b, fs, sig) && sir_mb_func_set_value_count(b, fs, 200);
+
+  const sir_val_id_t a0[] = {0};
+  const sir_val_id_t r1[] = {1};
+  ok = ok && sir_mb_emit_const_i32(b, fm, 0, 1000);
+  ok = ok && sir_mb_emit_call_func_res(b, fm, fs, a0, 1, r1, 1);
+  ok = ok && sir_mb_emit_exit_val(b, fm, 1);
+
+  const sir_val_id_t a3[] = {3};
+  const sir_val_id_t r4[] = {4};
+  ok = ok && sir_mb_emit_const_i32(b, fs, 1, 0);
+  ok = ok && sir_mb_emit_i32_cmp_eq(b, fs, 2, 0, 1);
+  ok = ok && sir_mb_emit_cbr(b, fs, 2, 3, 4, NULL);
+  ok = ok && sir_mb_emit_ret_val(b, fs, 1);
+  ok = ok && sir_mb_emit_const_i32(b, fs, 5, 1);
+  ok = ok && sir_mb_emit_i32_sub(b, fs, 3, 0, 5);
+  ok = ok && sir_mb_emit_call_func_res(b, fs, fs, a3, 1, r4, 1);
+  ok = ok && sir_mb_emit_i32_add(b, fs, 199, 0, 4);
+  ok = ok && sir_mb_emit_ret_val(b, fs, 199);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// main calls slot(i) for i in [0, 2000); each call allocas 4 KiB, reads the
+// (zeroed) slot, stores i and returns the sum. 8 MiB of allocas in total only
+// fits the 1 MiB guest memory because each return releases its frame's stack.
+static sir_module_t* build_alloca_reclaim(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+  const sir_type_id_t params[] = {ty_i32};
+  const sir_type_id_t results[] = {ty_i32};
+  const sir_sig_t sig = {.params = params, .param_count = 1, .results = results, .result_count = 1};
+
+  const sir_func_id_t fm = sir_mb_func_begin(b, "main");
+  const sir_func_id_t fs = sir_mb_func_begin(b, "slot");
+  bool ok = ty_i32 && fm && fs && sir_mb_func_set_entry(b, fm) && sir_mb_func_set_value_count(b, fm, 6);
+  ok = ok && sir_mb_func_set_sig(b, fs, sig) && sir_mb_func_set_value_count(b, fs, 5);
+
+  const sir_val_id_t a0[] = {0};
+  const sir_val_id_t r4[] = {4};
+  ok = ok && sir_mb_emit_const_i32(b, fm, 0, 0);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 1, 0);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 2, 2000);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 3, 1);
+  const uint32_t head = sir_mb_func_ip(b, fm);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, fm, 5, 0, 2);
+  uint32_t cbr_ip = 0;
+  ok = ok && sir_mb_emit_cbr(b, fm, 5, 0, 0, &cbr_ip);
+  const uint32_t body = sir_mb_func_ip(b, fm);
+  ok = ok && sir_mb_emit_call_func_res(b, fm, fs, a0, 1, r4, 1);
+  ok = ok && sir_mb_emit_i32_add(b, fm, 1, 1, 4);
+  ok = ok && sir_mb_emit_i32_add(b, fm, 0, 0, 3);
+  ok = ok && sir_mb_emit_br(b, fm, head, NULL);
+  const uint32_t done = sir_mb_func_ip(b, fm);
+  ok = ok && sir_mb_emit_exit_val(b, fm, 1);
+  ok = ok && sir_mb_patch_cbr(b, fm, cbr_ip, body, done);
+
+  ok = ok && sir_mb_emit_alloca(b, fs, 1, 4096, 16);
+  ok = ok && sir_mb_emit_load_i32(b, fs, 2, 1, 4);
+  ok = ok && sir_mb_emit_store_i32(b, fs, 1, 0, 4);
+  ok = ok && sir_mb_emit_load_i32(b, fs, 3, 1, 4);
+  ok = ok && sir_mb_emit_i32_add(b, fs, 4, 2, 3);
+  ok = ok && sir_mb_emit_ret_val(b, fs, 4);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// Slot 0 holds an i32 on one path and an i64 on the other, so it has no static
+// kind and the add must still be checked at runtime.
+static sir_module_t* build_mixed_slot(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 4);
+  ok = ok && sir_mb_emit_const_bool(b, f, 3, false);
+  ok = ok && sir_mb_emit_cbr(b, f, 3, 2, 4, NULL);
+  ok = ok && sir_mb_emit_const_i32(b, f, 0, 1);
+  ok = ok && sir_mb_emit_br(b, f, 5, NULL);
+  ok = ok && sir_mb_emit_const_i64(b, f, 0, 1);
+  ok = ok && sir_mb_emit_const_i32(b, f, 1, 2);
+  ok = ok && sir_mb_emit_i32_add(b, f, 2, 0, 1);
+  ok = ok && sir_mb_emit_exit_val(b, f, 2);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// Vector ops over 7-lane (SIMD body + scalar tail) i32 vectors in guest memory:
+// a = splat(5), b[i] = i*3 (lane stores), s = a + b, m = b < a, t = m ? s : b,
+// e = s == t; returns sum(t) + 100 * sum(e).
+static sir_module_t* build_vec(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 24);
+  // 0..5: vector ptrs (a, b, s, m, t, e)
+  ok = ok && sir_mb_emit_alloca(b, f, 0, 28, 16);
+  ok = ok && sir_mb_emit_alloca(b, f, 1, 28, 16);
+  ok = ok && sir_mb_emit_alloca(b, f, 2, 28, 16);
+  ok = ok && sir_mb_emit_alloca(b, f, 3, 7, 1);
+  ok = ok && sir_mb_emit_alloca(b, f, 4, 28, 16);
+  ok = ok && sir_mb_emit_alloca(b, f, 5, 7, 1);
+  ok = ok && sir_mb_emit_const_i32(b, f, 6, 5);
+  ok = ok && sir_mb_emit_vec_splat_i32(b, f, 0, 6, 7);
+  for (int32_t i = 0; i < 7; i++) {
+    ok = ok && sir_mb_emit_const_i32(b, f, 7, i);
+    ok = ok && sir_mb_emit_const_i32(b, f, 8, i * 3);
+    ok = ok && sir_mb_emit_ptr_offset(b, f, 9, 1, 7, 4);
+    ok = ok && sir_mb_emit_store_i32(b, f, 9, 8, 4);
+  }
+  ok = ok && sir_mb_emit_vec_i32_add(b, f, 2, 0, 1, 7);
+  ok = ok && sir_mb_emit_vec_i32_cmp_slt(b, f, 3, 1, 0, 7);
+  ok = ok && sir_mb_emit_vec_select_i32(b, f, 4, 3, 2, 1, 7);
+  ok = ok && sir_mb_emit_vec_i32_cmp_eq(b, f, 5, 2, 4, 7);
+  ok = ok && sir_mb_emit_const_i32(b, f, 10, 0);
+  ok = ok && sir_mb_emit_const_i32(b, f, 11, 100);
+  for (int32_t i = 0; i < 7; i++) {
+    ok = ok && sir_mb_emit_const_i32(b, f, 7, i);
+    ok = ok && sir_mb_emit_ptr_offset(b, f, 9, 4, 7, 4);
+    ok = ok && sir_mb_emit_load_i32(b, f, 12, 9, 4);
+    ok = ok && sir_mb_emit_i32_add(b, f, 10, 10, 12);
+    ok = ok && sir_mb_emit_ptr_offset(b, f, 9, 5, 7, 1);
+    ok = ok && sir_mb_emit_load_i8(b, f, 13, 9, 1);
+    ok = ok && sir_mb_emit_i32_zext_i8(b, f, 14, 13);
+    ok = ok && sir_mb_emit_i32_mul(b, f, 14, 14, 11);
+    ok = ok && sir_mb_emit_i32_add(b, f, 10, 10, 14);
+  }
+  ok = ok && sir_mb_emit_exit_val(b, f, 10);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// A splat into a misaligned i32 vector traps like the lane stores would.
+static sir_module_t* build_vec_misaligned(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 4);
+  ok = ok && sir_mb_emit_alloca(b, f, 0, 32, 16);
+  ok = ok && sir_mb_emit_const_i64(b, f, 1, 2);
+  ok = ok && sir_mb_emit_ptr_add(b, f, 2, 0, 1);
+  ok = ok && sir_mb_emit_const_i32(b, f, 3, 1);
+  ok = ok && sir_mb_emit_vec_splat_i32(b, f, 2, 3, 4);
+  ok = ok && sir_mb_emit_exit(b, f, 0);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// Copies src[i] into dst[i] for i in [0, 8) and sums dst back. Laid out so
+// that every fused pair of the threaded engine shows up: load + store,
+// ptr_offset + load, const + add and const + cmp + cbr.
+static sir_module_t* build_fields(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const uint8_t init[32] = {1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0, 4, 0, 0, 0, 5, 0, 0, 0, 6, 0, 0, 0, 7, 0, 0, 0, 8, 0, 0, 0};
+  const sir_global_id_t gs = sir_mb_global(b, "src", 32, 4, init, sizeof(init));
+  const sir_global_id_t gd = sir_mb_global(b, "dst", 32, 4, NULL, 0);
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = gs && gd && f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 14);
+  ok = ok && sir_mb_emit_global_addr(b, f, 2, gs);
+  ok = ok && sir_mb_emit_global_addr(b, f, 3, gd);
+  ok = ok && sir_mb_emit_const_i32(b, f, 0, 0);
+  ok = ok && sir_mb_emit_const_i32(b, f, 1, 0);
+  const uint32_t head = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_ptr_offset(b, f, 6, 2, 0, 4);
+  ok = ok && sir_mb_emit_ptr_offset(b, f, 7, 3, 0, 4);
+  ok = ok && sir_mb_emit_load_i32(b, f, 8, 6, 4);
+  ok = ok && sir_mb_emit_store_i32(b, f, 7, 8, 4);
+  ok = ok && sir_mb_emit_ptr_offset(b, f, 13, 3, 0, 4);
+  ok = ok && sir_mb_emit_load_i32(b, f, 12, 13, 4);
+  ok = ok && sir_mb_emit_i32_add(b, f, 10, 1, 12);
+  ok = ok && sir_mb_emit_const_i32(b, f, 4, 1);
+  ok = ok && sir_mb_emit_i32_add(b, f, 9, 0, 4);
+  ok = ok && sir_mb_emit_const_i32(b, f, 11, 8);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, f, 5, 9, 11);
+  const uint32_t cbr_ip = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_cbr(b, f, 5, cbr_ip + 1, cbr_ip + 2, NULL);
+  const sir_val_id_t src[] = {9, 10};
+  const sir_val_id_t dst[] = {0, 1};
+  ok = ok && sir_mb_emit_br_args(b, f, head, src, dst, 2, NULL);
+  ok = ok && sir_mb_emit_exit_val(b, f, 10);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// One call.func_ptr site cycling through six targets (more than the inline
+// cache holds): sum of f_{i%6}(i) = i + i%6 for i in [0, 60).
+static sir_module_t* build_dispatch(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+  const sir_type_id_t params[] = {ty_i32};
+  const sir_type_id_t results[] = {ty_i32};
+  const sir_sig_t sig = {.params = params, .param_count = 1, .results = results, .result_count = 1};
+  const sir_global_id_t tbl = sir_mb_global(b, "tbl", 48, 8, NULL, 0);
+  const sir_func_id_t fm = sir_mb_func_begin(b, "main");
+  bool ok = ty_i32 && tbl && fm && sir_mb_func_set_entry(b, fm) && sir_mb_func_set_value_count(b, fm, 16);
+  ok = ok && sir_mb_emit_global_addr(b, fm, 0, tbl);
+  for (int32_t k = 0; ok && k < 6; k++) {
+    const sir_func_id_t fk = sir_mb_func_begin(b, "f");
+    ok = fk && sir_mb_func_set_sig(b, fk, sig) && sir_mb_func_set_value_count(b, fk, 3);
+    ok = ok && sir_mb_emit_const_i32(b, fk, 1, k);
+    ok = ok && sir_mb_emit_i32_add(b, fk, 2, 0, 1);
+    ok = ok && sir_mb_emit_ret_val(b, fk, 2);
+    ok = ok && sir_mb_emit_const_ptr(b, fm, 1, (zi_ptr_t)(UINT64_C(0xF000000000000000) | fk));
+    ok = ok && sir_mb_emit_const_i32(b, fm, 2, k);
+    ok = ok && sir_mb_emit_ptr_offset(b, fm, 3, 0, 2, 8);
+    ok = ok && sir_mb_emit_store_ptr(b, fm, 3, 1, 8);
+  }
+  ok = ok && sir_mb_emit_const_i32(b, fm, 4, 0);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 5, 0);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 6, 6);
+  const uint32_t head = sir_mb_func_ip(b, fm);
+  const sir_val_id_t a4[] = {4};
+  const sir_val_id_t r10[] = {10};
+  ok = ok && sir_mb_emit_i32_rem_u_sat(b, fm, 7, 4, 6);
+  ok = ok && sir_mb_emit_ptr_offset(b, fm, 8, 0, 7, 8);
+  ok = ok && sir_mb_emit_load_ptr(b, fm, 9, 8, 8);
+  ok = ok && sir_mb_emit_call_func_ptr_res(b, fm, 9, a4, 1, r10, 1);
+  ok = ok && sir_mb_emit_i32_add(b, fm, 11, 5, 10);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 12, 1);
+  ok = ok && sir_mb_emit_i32_add(b, fm, 13, 4, 12);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 14, 60);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, fm, 15, 13, 14);
+  const uint32_t cbr_ip = sir_mb_func_ip(b, fm);
+  ok = ok && sir_mb_emit_cbr(b, fm, 15, cbr_ip + 1, cbr_ip + 2, NULL);
+  const sir_val_id_t src[] = {13, 11};
+  const sir_val_id_t dst[] = {4, 5};
+  ok = ok && sir_mb_emit_br_args(b, fm, head, src, dst, 2, NULL);
+  ok = ok && sir_mb_emit_exit_val(b, fm, 11);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// The same call.func_ptr site first calls a matching target, then one with
+// the wrong arity: the cached first target must not let the second through.
+static sir_module_t* build_dispatch_arity(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+  const sir_type_id_t params[] = {ty_i32, ty_i32};
+  const sir_type_id_t results[] = {ty_i32};
+  const sir_sig_t sig1 = {.params = params, .param_count = 1, .results = results, .result_count = 1};
+  const sir_sig_t sig2 = {.params = params, .param_count = 2, .results = results, .result_count = 1};
+  const sir_func_id_t fm = sir_mb_func_begin(b, "main");
+  const sir_func_id_t f1 = sir_mb_func_begin(b, "one");
+  const sir_func_id_t f2 = sir_mb_func_begin(b, "two");
+  bool ok = ty_i32 && fm && f1 && f2 && sir_mb_func_set_entry(b, fm) && sir_mb_func_set_value_count(b, fm, 10);
+  ok = ok && sir_mb_func_set_sig(b, f1, sig1) && sir_mb_func_set_value_count(b, f1, 1) && sir_mb_emit_ret_val(b, f1, 0);
+  ok = ok && sir_mb_func_set_sig(b, f2, sig2) && sir_mb_func_set_value_count(b, f2, 2) && sir_mb_emit_ret_val(b, f2, 0);
+  ok = ok && sir_mb_emit_const_ptr(b, fm, 0, (zi_ptr_t)(UINT64_C(0xF000000000000000) | f1));
+  ok = ok && sir_mb_emit_const_ptr(b, fm, 1, (zi_ptr_t)(UINT64_C(0xF000000000000000) | f2));
+  ok = ok && sir_mb_emit_const_i32(b, fm, 2, 0);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 3, 0);
+  const uint32_t head = sir_mb_func_ip(b, fm);
+  const sir_val_id_t a2[] = {2};
+  const sir_val_id_t r6[] = {6};
+  ok = ok && sir_mb_emit_i32_cmp_eq(b, fm, 4, 2, 3);
+  ok = ok && sir_mb_emit_select(b, fm, 5, 4, 0, 1);
+  ok = ok && sir_mb_emit_call_func_ptr_res(b, fm, 5, a2, 1, r6, 1);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 7, 1);
+  ok = ok && sir_mb_emit_i32_add(b, fm, 8, 2, 7);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, fm, 9, 8, 7);
+  const uint32_t cbr_ip = sir_mb_func_ip(b, fm);
+  ok = ok && sir_mb_emit_cbr(b, fm, 9, cbr_ip + 2, cbr_ip + 1, NULL);
+  const sir_val_id_t src[] = {8};
+  const sir_val_id_t dst[] = {2};
+  ok = ok && sir_mb_emit_br_args(b, fm, head, src, dst, 1, NULL);
+  ok = ok && sir_mb_emit_exit_val(b, fm, 7);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// The same call.func_ptr site first calls a valid target, then through `bad`
+// (null or untagged): that must fail the decode, not hit an empty cache way.
+static sir_module_t* build_dispatch_bad_ptr(zi_ptr_t bad) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_type_id_t ty_i32 = sir_mb_type_prim(b, SIR_PRIM_I32);
+  const sir_type_id_t params[] = {ty_i32};
+  const sir_type_id_t results[] = {ty_i32};
+  const sir_sig_t sig = {.params = params, .param_count = 1, .results = results, .result_count = 1};
+  const sir_func_id_t fm = sir_mb_func_begin(b, "main");
+  const sir_func_id_t f1 = sir_mb_func_begin(b, "one");
+  bool ok = ty_i32 && fm && f1 && sir_mb_func_set_entry(b, fm) && sir_mb_func_set_value_count(b, fm, 10);
+  ok = ok && sir_mb_func_set_sig(b, f1, sig) && sir_mb_func_set_value_count(b, f1, 1) && sir_mb_emit_ret_val(b, f1, 0);
+  ok = ok && sir_mb_emit_const_ptr(b, fm, 0, (zi_ptr_t)(UINT64_C(0xF000000000000000) | f1));
+  ok = ok && sir_mb_emit_const_ptr(b, fm, 1, bad);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 2, 0);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 3, 0);
+  const uint32_t head = sir_mb_func_ip(b, fm);
+  const sir_val_id_t a2[] = {2};
+  const sir_val_id_t r6[] = {6};
+  ok = ok && sir_mb_emit_i32_cmp_eq(b, fm, 4, 2, 3);
+  ok = ok && sir_mb_emit_select(b, fm, 5, 4, 0, 1);
+  ok = ok && sir_mb_emit_call_func_ptr_res(b, fm, 5, a2, 1, r6, 1);
+  ok = ok && sir_mb_emit_const_i32(b, fm, 7, 1);
+  ok = ok && sir_mb_emit_i32_add(b, fm, 8, 2, 7);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, fm, 9, 8, 7);
+  const uint32_t cbr_ip = sir_mb_func_ip(b, fm);
+  ok = ok && sir_mb_emit_cbr(b, fm, 9, cbr_ip + 2, cbr_ip + 1, NULL);
+  const sir_val_id_t src[] = {8};
+  const sir_val_id_t dst[] = {2};
+  ok = ok && sir_mb_emit_br_args(b, fm, head, src, dst, 1, NULL);
+  ok = ok && sir_mb_emit_exit_val(b, fm, 7);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// i64/f64/f32 arithmetic and conversions: a counted i64 loop accumulating
+// ((i*7) ^ i) << 2 >> 1 and i * 0.5, then a few float edge cases.
+static sir_module_t* build_numeric(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 26);
+  ok = ok && sir_mb_emit_const_i64(b, f, 0, 0);
+  ok = ok && sir_mb_emit_const_i64(b, f, 1, 0);
+  ok = ok && sir_mb_emit_const_i64(b, f, 2, 100);
+  ok = ok && sir_mb_emit_const_i64(b, f, 3, 1);
+  ok = ok && sir_mb_emit_const_i64(b, f, 4, 7);
+  ok = ok && sir_mb_emit_const_f64_bits(b, f, 5, 0x0000000000000000ull);  // 0.0
+  ok = ok && sir_mb_emit_const_f64_bits(b, f, 11, 0x3FE0000000000000ull); // 0.5
+  ok = ok && sir_mb_emit_const_i64(b, f, 15, 2);
+  const uint32_t head = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_i64_cmp_slt(b, f, 6, 0, 2);
+  uint32_t cbr_ip = 0;
+  ok = ok && sir_mb_emit_cbr(b, f, 6, 0, 0, &cbr_ip);
+  const uint32_t body = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_i64_mul(b, f, 7, 0, 4);
+  ok = ok && sir_mb_emit_i64_xor(b, f, 7, 7, 0);
+  ok = ok && sir_mb_emit_i64_shl(b, f, 7, 7, 15);
+  ok = ok && sir_mb_emit_i64_shr_s(b, f, 7, 7, 3);
+  ok = ok && sir_mb_emit_i64_add(b, f, 8, 1, 7);
+  ok = ok && sir_mb_emit_f64_from_i64_s(b, f, 10, 0);
+  ok = ok && sir_mb_emit_f64_mul(b, f, 12, 10, 11);
+  ok = ok && sir_mb_emit_f64_add(b, f, 13, 5, 12);
+  ok = ok && sir_mb_emit_i64_add(b, f, 14, 0, 3);
+  const sir_val_id_t src[] = {14, 8, 13};
+  const sir_val_id_t dst[] = {0, 1, 5};
+  ok = ok && sir_mb_emit_br_args(b, f, head, src, dst, 3, NULL);
+  const uint32_t done = sir_mb_func_ip(b, f);
+  // r = (acc + (i64)fsum) / 7 - (i64)(f32)-2.75 + (u32)-2.75
+  ok = ok && sir_mb_emit_i64_trunc_sat_f64_s(b, f, 16, 5);
+  ok = ok && sir_mb_emit_i64_add(b, f, 16, 1, 16);
+  ok = ok && sir_mb_emit_i64_div_s_sat(b, f, 16, 16, 4);
+  ok = ok && sir_mb_emit_const_f64_bits(b, f, 17, 0x4006000000000000ull); // 2.75
+  ok = ok && sir_mb_emit_f64_neg(b, f, 17, 17);
+  ok = ok && sir_mb_emit_f32_demote_f64(b, f, 18, 17);
+  ok = ok && sir_mb_emit_i64_trunc_sat_f32_s(b, f, 19, 18);
+  ok = ok && sir_mb_emit_i64_sub(b, f, 16, 16, 19);
+  ok = ok && sir_mb_emit_i32_trunc_sat_f64_u(b, f, 20, 17);
+  ok = ok && sir_mb_emit_i64_zext_i32(b, f, 20, 20);
+  ok = ok && sir_mb_emit_i64_add(b, f, 16, 16, 20);
+  ok = ok && sir_mb_emit_i32_trunc_i64(b, f, 21, 16);
+  // NaN: 0/0 is unordered, so une holds and oeq does not.
+  ok = ok && sir_mb_emit_const_f32_bits(b, f, 22, 0);
+  ok = ok && sir_mb_emit_f32_div(b, f, 23, 22, 22);
+  ok = ok && sir_mb_emit_f32_cmp_une(b, f, 24, 23, 23);
+  ok = ok && sir_mb_emit_f32_cmp_oeq(b, f, 25, 23, 23);
+  ok = ok && sir_mb_emit_bool_not(b, f, 25, 25);
+  ok = ok && sir_mb_emit_bool_and(b, f, 24, 24, 25);
+  uint32_t nan_ip = 0;
+  ok = ok && sir_mb_emit_cbr(b, f, 24, 0, 0, &nan_ip);
+  const uint32_t good = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_exit_val(b, f, 21);
+  const uint32_t bad = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_exit(b, f, 1);
+  ok = ok && sir_mb_patch_cbr(b, f, cbr_ip, body, done);
+  ok = ok && sir_mb_patch_cbr(b, f, nan_ip, good, bad);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+static sir_module_t* build_i64_div_trap(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 3);
+  ok = ok && sir_mb_emit_const_i64(b, f, 0, INT64_MIN);
+  ok = ok && sir_mb_emit_const_i64(b, f, 1, -1);
+  ok = ok && sir_mb_emit_i64_div_s_trap(b, f, 2, 0, 1);
+  ok = ok && sir_mb_emit_exit(b, f, 0);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// counter += 1 on a global initialized to 7; returns the new value, so only a
+// fresh (or restored) global yields 8.
+static sir_module_t* build_counter(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const uint8_t init[4] = {7, 0, 0, 0};
+  const sir_global_id_t g = sir_mb_global(b, "counter", 4, 4, init, sizeof(init));
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = g && f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 4);
+  ok = ok && sir_mb_emit_global_addr(b, f, 0, g);
+  ok = ok && sir_mb_emit_load_i32(b, f, 1, 0, 4);
+  ok = ok && sir_mb_emit_const_i32(b, f, 2, 1);
+  ok = ok && sir_mb_emit_i32_add(b, f, 3, 1, 2);
+  ok = ok && sir_mb_emit_store_i32(b, f, 0, 3, 4);
+  ok = ok && sir_mb_emit_exit_val(b, f, 3);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// Round trips every integer width and a pointer through a global and an
+// alloca, in a loop so tiered runs promote mid-way. Returns
+// 300 * (0x34 + 0x1234 + 5 + 1) & 0xffff.
+static sir_module_t* build_mem_widths(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_global_id_t g = sir_mb_global(b, "buf", 32, 8, NULL, 0);
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = g && f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 24);
+  ok = ok && sir_mb_emit_global_addr(b, f, 0, g);
+  ok = ok && sir_mb_emit_alloca(b, f, 1, 16, 8);
+  ok = ok && sir_mb_emit_const_i64(b, f, 2, 8);
+  ok = ok && sir_mb_emit_ptr_add(b, f, 3, 0, 2); // buf + 8
+  ok = ok && sir_mb_emit_const_i64(b, f, 2, 16);
+  ok = ok && sir_mb_emit_ptr_add(b, f, 4, 0, 2); // buf + 16
+  ok = ok && sir_mb_emit_const_i32(b, f, 5, 0);  // i
+  ok = ok && sir_mb_emit_const_i32(b, f, 6, 300);
+  ok = ok && sir_mb_emit_const_i32(b, f, 7, 1);
+  ok = ok && sir_mb_emit_const_i32(b, f, 8, 0); // acc
+  ok = ok && sir_mb_emit_const_i8(b, f, 9, 0x34);
+  ok = ok && sir_mb_emit_const_i16(b, f, 10, 0x1234);
+  ok = ok && sir_mb_emit_const_i64(b, f, 11, 5);
+  const uint32_t head = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_i32_cmp_slt(b, f, 12, 5, 6);
+  uint32_t cbr_ip = 0;
+  ok = ok && sir_mb_emit_cbr(b, f, 12, 0, 0, &cbr_ip);
+  const uint32_t body = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_store_i8(b, f, 0, 9, 1);
+  ok = ok && sir_mb_emit_store_i16(b, f, 1, 10, 2);
+  ok = ok && sir_mb_emit_store_i64(b, f, 3, 11, 8);
+  ok = ok && sir_mb_emit_store_ptr(b, f, 4, 1, 8);
+  ok = ok && sir_mb_emit_store_i32(b, f, 1, 7, 4); // overwrites the low half of the i16 slot's word
+  ok = ok && sir_mb_emit_store_i16(b, f, 1, 10, 2);
+  ok = ok && sir_mb_emit_load_i8(b, f, 13, 0, 1);
+  ok = ok && sir_mb_emit_i32_zext_i8(b, f, 14, 13);
+  ok = ok && sir_mb_emit_load_ptr(b, f, 15, 4, 8);
+  ok = ok && sir_mb_emit_load_i16(b, f, 16, 15, 2);
+  ok = ok && sir_mb_emit_i32_zext_i16(b, f, 17, 16);
+  ok = ok && sir_mb_emit_load_i64(b, f, 18, 3, 8);
+  ok = ok && sir_mb_emit_i32_trunc_i64(b, f, 19, 18);
+  ok = ok && sir_mb_emit_i32_add(b, f, 20, 14, 17);
+  ok = ok && sir_mb_emit_i32_add(b, f, 20, 20, 19);
+  ok = ok && sir_mb_emit_i32_add(b, f, 20, 20, 7);
+  ok = ok && sir_mb_emit_i32_add(b, f, 8, 8, 20);
+  ok = ok && sir_mb_emit_i32_add(b, f, 5, 5, 7);
+  ok = ok && sir_mb_emit_br(b, f, head, NULL);
+  const uint32_t done = sir_mb_func_ip(b, f);
+  ok = ok && sir_mb_emit_const_i32(b, f, 21, 0xffff);
+  ok = ok && sir_mb_emit_i32_and(b, f, 8, 8, 21);
+  ok = ok && sir_mb_emit_exit_val(b, f, 8);
+  ok = ok && sir_mb_patch_cbr(b, f, cbr_ip, body, done);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+// An i32 load that straddles the end of the heap must fail with ZI_E_BOUNDS
+// (native code takes its slow path there), after an in-bounds one succeeds.
+static sir_module_t* build_mem_oob(void) {
+  sir_module_builder_t* b = sir_mb_new();
+  if (!b) return NULL;
+  const sir_global_id_t g = sir_mb_global(b, "buf", 8, 8, NULL, 0);
+  const sir_func_id_t f = sir_mb_func_begin(b, "main");
+  bool ok = g && f && sir_mb_func_set_entry(b, f) && sir_mb_func_set_value_count(b, f, 6);
+  ok = ok && sir_mb_emit_global_addr(b, f, 0, g);
+  ok = ok && sir_mb_emit_load_i32(b, f, 1, 0, 4);
+  ok = ok && sir_mb_emit_const_i64(b, f, 2, 1 << 16);
+  ok = ok && sir_mb_emit_ptr_add(b, f, 3, 0, 2);
+  ok = ok && sir_mb_emit_load_i32(b, f, 4, 3, 4);
+  ok = ok && sir_mb_emit_exit(b, f, 0);
+  sir_module_t* m = ok ? sir_mb_finalize(b) : NULL;
+  sir_mb_free(b);
+  return m;
+}
+
+int main(void) {
+  int32_t want_loop = 0;
+  for (int32_t i = 0; i < 1000; i++) want_loop += (i * 3) ^ i;
+  int32_t want_mem = 0xff;
+  for (int32_t i = 0; i < 16; i++) want_mem += i * i;
+
+  if (check("loop", build_loop(), want_loop)) return 1;
+  if (check("calls", build_calls(), 2 * 6765)) return 1;
+  if (check("memory", build_memory(), want_mem)) return 1;
+  if (check("switch", build_switch(), 42)) return 1;
+  if (check("div_trap", build_div_trap(), 255)) return 1;
+  if (check("misaligned", build_misaligned(), 255)) return 1;
+  if (check("kind_mismatch", build_kind_mismatch(), -1)) return 1; // ZI_E_INVALID
+  if (check("deep_recursion", build_deep_recursion(), 1000 * 1001 / 2)) return 1;
+  if (check("mixed_slot", build_mixed_slot(), -1)) return 1; // ZI_E_INVALID
+  if (check("alloca_reclaim", build_alloca_reclaim(), 2000 * 1999 / 2)) return 1;
+  int32_t want_vec = 0;
+  for (int32_t i = 0; i < 7; i++) {
+    const int32_t t = i * 3 < 5 ? 5 + i * 3 : i * 3;
+    want_vec += t + (t == 5 + i * 3 ? 100 : 0);
+  }
+  if (check("vec", build_vec(), want_vec)) return 1;
+  if (check("vec_misaligned", build_vec_misaligned(), 255)) return 1;
+  if (check("fields", build_fields(), 36)) return 1;
+  if (check("dispatch", build_dispatch(), 1770 + 10 * 15)) return 1;
+  if (check("dispatch_arity", build_dispatch_arity(), -1)) return 1; // ZI_E_INVALID
+  if (check("dispatch_null", build_dispatch_bad_ptr(0), -1)) return 1; // ZI_E_INVALID
+  if (check("dispatch_untagged", build_dispatch_bad_ptr((zi_ptr_t)1), -1)) return 1; // ZI_E_INVALID
+  int64_t want_num = 0;
+  for (int64_t i = 0; i < 100; i++) want_num += (((i * 7) ^ i) << 2) >> 1;
+  want_num = (want_num + 2475) / 7 + 2; // trunc_sat(-2.75) is -2 signed, 0 unsigned
+  if (check("numeric", build_numeric(), (int32_t)want_num)) return 1;
+  if (check("i64_div_trap", build_i64_div_trap(), 255)) return 1;
+  if (check("mem_widths", build_mem_widths(), (300 * (0x34 + 0x1234 + 5 + 1)) & 0xffff)) return 1;
+  if (check("mem_oob", build_mem_oob(), -2)) return 1; // ZI_E_BOUNDS
+
+  // Block tables survive the image round trip.
+  sir_module_t* m = build_loop();
+  sir_module_t* copy = m ? image_copy(m) : NULL;
+  const bool same_blocks = copy && copy->funcs[0].block_count == 4 && m->funcs[0].block_count == 4 &&
+                           memcmp(copy->funcs[0].blocks, m->funcs[0].blocks, 4 * sizeof(sir_block_t)) == 0;
+  sir_module_free(copy);
+  sir_module_free(m);
+  if (!same_blocks) return fail("block table lost in the image round trip");
+
+  // Unknown engines are rejected.
+  m = build_switch();
+  if (!m) return fail("build_switch failed");
+  sem_guest_mem_t mem;
+  if (!sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) {
+    sir_module_free(m);
+    return fail("sem_guest_mem_init failed");
+  }
+  sir_host_t host;
+  memset(&host, 0, sizeof(host));
+  const sir_exec_opts_t bad = {.engine = (sir_exec_engine_t)99};
+  const int32_t rc = sir_module_run_opts(m, &mem, host, NULL, &bad);
+  sem_guest_mem_dispose(&mem);
+  sir_module_free(m);
+  if (rc != -1) return fail("expected unknown engine to be rejected");
+
+  // Pair profile of the loop: the compare + branch at its head is the hottest
+  // straight-line pair (1000 iterations plus the exit test).
+  m = build_loop();
+  if (!m) return fail("build_loop failed");
+  sir_pair_profile_t* prof = sir_pair_profile_new();
+  if (!prof || !sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) {
+    sir_pair_profile_free(prof);
+    sir_module_free(m);
+    return fail("sir_pair_profile_new/sem_guest_mem_init failed");
+  }
+  const sir_exec_event_sink_t prof_sink = sir_pair_profile_sink(prof);
+  const int32_t rc_prof = sir_module_run_ex(m, &mem, host, &prof_sink);
+  sem_guest_mem_dispose(&mem);
+  sir_module_free(m);
+  sir_pair_count_t top[4];
+  const uint32_t ntop = sir_pair_profile_top(prof, top, 4);
+  const uint64_t steps = sir_pair_profile_steps(prof);
+  sir_pair_profile_free(prof);
+  if (rc_prof != want_loop) return fail("profiled loop: wrong result");
+  if (steps != 5 + 1001 * 2 + 1000 * 5 + 1) return fail("profiled loop: wrong step count");
+  if (ntop != 4 || top[0].first != SIR_INST_I32_CMP_SLT || top[0].second != SIR_INST_CBR || top[0].count != 1001 || top[1].count != 1000 ||
+      top[3].count > top[2].count) {
+    return fail("profiled loop: unexpected top pairs");
+  }
+
+  // Tier-up: fib is promoted by its call count, the loop by its back-edges.
+  m = build_calls();
+  if (!m) return fail("build_calls failed");
+  sir_tier_stats_t stats[2];
+  const sir_exec_opts_t tiered = {.engine = SIR_EXEC_ENGINE_TIERED, .tier_stats = stats};
+  if (!sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) {
+    sir_module_free(m);
+    return fail("sem_guest_mem_init failed");
+  }
+  const int32_t rc_calls = sir_module_run_opts(m, &mem, host, NULL, &tiered);
+  sem_guest_mem_dispose(&mem);
+  sir_module_free(m);
+  if (rc_calls != 2 * 6765) return fail("tiered calls: wrong result");
+  if (stats[0].promoted || stats[0].calls != 1) return fail("tiered calls: main should stay on the switch engine");
+  if (!stats[1].promoted || stats[1].calls != SIR_TIER_HOT_CALLS) return fail("tiered calls: fib should be promoted by calls");
+
+  m = build_loop();
+  if (!m) return fail("build_loop failed");
+  if (!sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) {
+    sir_module_free(m);
+    return fail("sem_guest_mem_init failed");
+  }
+  const int32_t rc_loop = sir_module_run_opts(m, &mem, host, NULL, &tiered);
+  sem_guest_mem_dispose(&mem);
+  sir_module_free(m);
+  if (rc_loop != want_loop) return fail("tiered loop: wrong result");
+  if (!stats[0].promoted || stats[0].calls != 1 || stats[0].back_edges != SIR_TIER_HOT_LOOPS) {
+    return fail("tiered loop: main should be promoted at a back-edge");
+  }
+
+  // Guest memory above 4 GiB: the stack, and so every alloca, sits past 4 GiB.
+  m = build_alloca_reclaim();
+  if (!m) return fail("build_alloca_reclaim failed");
+  if (!sem_guest_mem_init(&mem, UINT64_C(6) << 30, 0x10000ull)) {
+    sir_module_free(m);
+    return fail("sem_guest_mem_init (6 GiB) failed");
+  }
+  const int32_t rc_big = sir_module_run_ex(m, &mem, host, NULL);
+  sem_guest_mem_dispose(&mem);
+  sir_module_free(m);
+  if (rc_big != 2000 * 1999 / 2) return fail("alloca above 4 GiB failed");
+
+  // Prepared state + snapshot: every run starts from the same globals.
+  m = build_counter();
+  if (!m) return fail("build_counter failed");
+  if (!sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) {
+    sir_module_free(m);
+    return fail("sem_guest_mem_init failed");
+  }
+  sir_module_state_t* st = NULL;
+  sem_guest_snapshot_t snap;
+  if (sir_module_state_init(m, &mem, &st) != 0 || !sem_guest_snapshot_take(&mem, &snap)) {
+    sir_module_state_free(st);
+    sem_guest_mem_dispose(&mem);
+    sir_module_free(m);
+    return fail("sir_module_state_init/snapshot failed");
+  }
+  bool ok = true;
+  // Native stores must keep marking dirty pages, or a restore would miss them.
+  const sir_exec_opts_t nat = {.engine = SIR_EXEC_ENGINE_NATIVE};
+  for (uint32_t i = 0; ok && i < 100; i++) {
+    ok = sem_guest_snapshot_restore(&mem, &snap) && sir_module_state_run(st, &mem, host, NULL, (i & 1u) ? &nat : NULL) == 8;
+  }
+  sem_guest_mem_t fork;
+  ok = ok && sem_guest_snapshot_fork(&snap, &fork);
+  if (ok) {
+    const sir_exec_opts_t sw = {.engine = SIR_EXEC_ENGINE_SWITCH};
+    ok = sir_module_state_run(st, &fork, host, NULL, &sw) == 8;
+    sem_guest_mem_dispose(&fork);
+  }
+  sem_guest_snapshot_dispose(&snap);
+  sir_module_state_free(st);
+  sem_guest_mem_dispose(&mem);
+  sir_module_free(m);
+  if (!ok) return fail("snapshot re-run mismatch");
+
+  // Damaged or foreign images are rejected rather than run.
+  m = build_counter();
+  if (!m) return fail("build_counter failed");
+  uint8_t* img = NULL;
+  size_t img_len = 0;
+  ok = sir_module_image_build(m, &img, &img_len);
+  sir_module_free(m);
+  if (!ok) return fail("sir_module_image_build failed");
+  uint8_t* bad_img = (uint8_t*)malloc(img_len);
+  if (!bad_img) {
+    free(img);
+    return fail("out of memory");
+  }
+  for (size_t at = 0; ok && at < img_len; at += 61) {
+    memcpy(bad_img, img, img_len);
+    bad_img[at] ^= 0x40u;
+    ok = sir_module_image_load(bad_img, img_len, NULL) == NULL;
+  }
+  memcpy(bad_img, img, img_len);
+  ok = ok && sir_module_image_load(bad_img, img_len - 8u, NULL) == NULL;
+  memcpy(bad_img, img, img_len);
+  sir_module_t* good = ok ? sir_module_image_load(bad_img, img_len, NULL) : NULL;
+  ok = good != NULL;
+  if (ok && sem_guest_mem_init(&mem, 1024 * 1024, 0x10000ull)) {
+    ok = sir_module_run_ex(good, &mem, host, NULL) == 8;
+    sem_guest_mem_dispose(&mem);
+  }
+  sir_module_free(good);
+  free(bad_img);
+  free(img);
+  if (!ok) return fail("image corruption not detected");
+  return 0;
+}